@@ -28,6 +28,7 @@ namespace ns3
 {
 
 uint32_t PhasedArrayModel::m_idCounter = 0;
+std::atomic<uint64_t> PhasedArrayModel::m_bfVectorUidCounter = 0;
 
 NS_LOG_COMPONENT_DEFINE("PhasedArrayModel");
 
@@ -89,6 +90,7 @@ PhasedArrayModel::SetBeamformingVector(const ComplexVector& beamformingVector)
                   beamformingVector.size() << " != " << GetNumberOfElements());
     m_beamformingVector = beamformingVector;
     m_isBfVectorValid = true;
+    m_bfVectorUid = ++m_bfVectorUidCounter;
 }
 
 PhasedArrayModel::ComplexVector
@@ -101,6 +103,25 @@ PhasedArrayModel::GetBeamformingVector() const
     return m_beamformingVector;
 }
 
+const PhasedArrayModel::ComplexVector&
+PhasedArrayModel::GetBeamformingVectorRef() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT_MSG(m_isBfVectorValid,
+                  "The beamforming vector should be Set before it's Get, and should refer to the "
+                  "current array configuration");
+    return m_beamformingVector;
+}
+
+uint64_t
+PhasedArrayModel::GetBeamformingVectorUid() const
+{
+    NS_ASSERT_MSG(m_isBfVectorValid,
+                  "The beamforming vector should be Set before it's Get, and should refer to the "
+                  "current array configuration");
+    return m_bfVectorUid;
+}
+
 double
 PhasedArrayModel::ComputeNorm(const ComplexVector& vector)
 {
@@ -147,6 +168,34 @@ PhasedArrayModel::GetSteeringVector(Angles a) const
     return steeringVector;
 }
 
+PhasedArrayModel::ComplexVector
+PhasedArrayModel::GetSteeringVectors(const std::vector<Angles>& angles) const
+{
+    uint64_t numElements = GetNumberOfElements();
+    ComplexVector steeringVectors(numElements * angles.size());
+    for (std::size_t j = 0; j < angles.size(); j++)
+    {
+        ComplexVector steeringVector = GetSteeringVector(angles[j]);
+        for (uint64_t i = 0; i < numElements; i++)
+        {
+            steeringVectors[i * angles.size() + j] = steeringVector[i];
+        }
+    }
+    return steeringVectors;
+}
+
+std::vector<std::pair<double, double>>
+PhasedArrayModel::GetElementFieldPatterns(const std::vector<Angles>& angles) const
+{
+    std::vector<std::pair<double, double>> fieldPatterns;
+    fieldPatterns.reserve(angles.size());
+    for (const auto& a : angles)
+    {
+        fieldPatterns.push_back(GetElementFieldPattern(a));
+    }
+    return fieldPatterns;
+}
+
 void
 PhasedArrayModel::SetAntennaElement(Ptr<AntennaModel> antennaElement)
 {
@@ -22,7 +22,9 @@
 #include <ns3/antenna-model.h>
 #include <ns3/object.h>
 
+#include <atomic>
 #include <complex>
+#include <vector>
 
 namespace ns3
 {
@@ -90,6 +92,21 @@ class PhasedArrayModel : public Object
      */
     ComplexVector GetBeamformingVector() const;
 
+    /**
+     * Returns a reference to the beamforming vector that is currently being used
+     * \return the current beamforming vector
+     */
+    const ComplexVector& GetBeamformingVectorRef() const;
+
+    /**
+     * Returns the identifier of the beamforming vector that is currently being used,
+     * which is unique among all the arrays and changes every time a beamforming vector
+     * is set, so that users can detect a new beamforming vector without comparing it
+     * with the previous one
+     * \return the identifier of the current beamforming vector
+     */
+    uint64_t GetBeamformingVectorUid() const;
+
     /**
      * Returns the beamforming vector that points towards the specified position
      * \param a the beamforming angle
@@ -102,7 +119,26 @@ class PhasedArrayModel : public Object
      * \param a the steering angle
      * \return the steering vector
      */
-    ComplexVector GetSteeringVector(Angles a) const;
+    virtual ComplexVector GetSteeringVector(Angles a) const;
+
+    /**
+     * Returns the steering vectors that point toward the specified positions.
+     * Subclasses may compute them for all the angles at once.
+     * \param angles the steering angles
+     * \return the steering vectors, where the element i of the steering vector
+     *         toward angles[j] has index i * angles.size() + j
+     */
+    virtual ComplexVector GetSteeringVectors(const std::vector<Angles>& angles) const;
+
+    /**
+     * Returns the horizontal and vertical components of the antenna element field
+     * pattern at the specified directions, as GetElementFieldPattern does for each
+     * of them. Subclasses may compute them for all the angles at once.
+     * \param angles the angles indicating the interested directions
+     * \return the field patterns at each of the directions
+     */
+    virtual std::vector<std::pair<double, double>> GetElementFieldPatterns(
+        const std::vector<Angles>& angles) const;
 
     /**
      * Sets the antenna model to be used
@@ -133,9 +169,13 @@ class PhasedArrayModel : public Object
     ComplexVector m_beamformingVector;  //!< the beamforming vector in use
     Ptr<AntennaModel> m_antennaElement; //!< the model of the antenna element in use
     bool m_isBfVectorValid;             //!< ensures the validity of the beamforming vector
+    uint64_t m_bfVectorUid{0};          //!< the identifier of the beamforming vector
     static uint32_t
         m_idCounter;  //!< the ID counter that is used to determine the unique antenna array ID
     uint32_t m_id{0}; //!< the ID of this antenna array instance
+    static std::atomic<uint64_t>
+        m_bfVectorUidCounter; //!< the counter of the beamforming vector identifiers, shared by
+                              //!< the arrays of all the threads
 };
 
 /**
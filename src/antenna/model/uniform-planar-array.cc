@@ -189,7 +189,25 @@ std::pair<double, double>
 UniformPlanarArray::GetElementFieldPattern(Angles a) const
 {
     NS_LOG_FUNCTION(this << a);
+    return ComputeElementFieldPattern(a);
+}
+
+std::vector<std::pair<double, double>>
+UniformPlanarArray::GetElementFieldPatterns(const std::vector<Angles>& angles) const
+{
+    NS_LOG_FUNCTION(this << angles.size());
+    std::vector<std::pair<double, double>> fieldPatterns;
+    fieldPatterns.reserve(angles.size());
+    for (const auto& a : angles)
+    {
+        fieldPatterns.push_back(ComputeElementFieldPattern(a));
+    }
+    return fieldPatterns;
+}
 
+std::pair<double, double>
+UniformPlanarArray::ComputeElementFieldPattern(Angles a) const
+{
     // convert the theta and phi angles from GCS to LCS using eq. 7.1-7 and 7.1-8 in 3GPP TR 38.901
     // NOTE we assume a fixed slant angle of 0 degrees
     double cosIncl = cos(a.GetInclination());
@@ -208,19 +226,24 @@ UniformPlanarArray::GetElementFieldPattern(Angles a) const
     // NOTE: the slant angle (assumed to be 0) differs from the polarization slant angle
     // (m_polSlant, given by the attribute), in 3GPP TR 38.901
     double aPrimeDb = m_antennaElement->GetGainDb(aPrime);
-    double fieldThetaPrime = pow(10, aPrimeDb / 20) * m_cosPolSlant; // convert to linear magnitude
-    double fieldPhiPrime = pow(10, aPrimeDb / 20) * m_sinPolSlant;   // convert to linear magnitude
+    double fieldPrime = pow(10, aPrimeDb / 20); // convert to linear magnitude
+    double fieldThetaPrime = fieldPrime * m_cosPolSlant;
+    double fieldPhiPrime = fieldPrime * m_sinPolSlant;
 
     // compute psi using eq. 7.1-15 in 3GPP TR 38.901, assuming that the slant
-    // angle (gamma) is 0
-    double psi = std::arg(std::complex<double>(m_cosBeta * sinIncl - m_sinBeta * cosIncl * cosAzim,
-                                               m_sinBeta * sinAzim));
-    NS_LOG_DEBUG("psi " << psi);
+    // angle (gamma) is 0; only its cosine and sine are needed, which are those
+    // of the argument of psiRe + j psiIm
+    double psiRe = m_cosBeta * sinIncl - m_sinBeta * cosIncl * cosAzim;
+    double psiIm = m_sinBeta * sinAzim;
+    double psiAbs = std::hypot(psiRe, psiIm);
+    double cosPsi = (psiAbs > 0) ? psiRe / psiAbs : 1;
+    double sinPsi = (psiAbs > 0) ? psiIm / psiAbs : 0;
+    NS_LOG_DEBUG("psi " << std::atan2(psiIm, psiRe));
 
     // convert the antenna element field pattern to GCS using eq. 7.1-11
     // in 3GPP TR 38.901
-    double fieldTheta = cos(psi) * fieldThetaPrime - sin(psi) * fieldPhiPrime;
-    double fieldPhi = sin(psi) * fieldThetaPrime + cos(psi) * fieldPhiPrime;
+    double fieldTheta = cosPsi * fieldThetaPrime - sinPsi * fieldPhiPrime;
+    double fieldPhi = sinPsi * fieldThetaPrime + cosPsi * fieldPhiPrime;
     NS_LOG_DEBUG(RadiansToDegrees(a.GetAzimuth())
                  << " " << RadiansToDegrees(a.GetInclination()) << " "
                  << fieldTheta * fieldTheta + fieldPhi * fieldPhi);
@@ -228,6 +251,79 @@ UniformPlanarArray::GetElementFieldPattern(Angles a) const
     return std::make_pair(fieldPhi, fieldTheta);
 }
 
+void
+UniformPlanarArray::ComputeSteeringTerms(Angles a,
+                                         ComplexVector& columnTerms,
+                                         ComplexVector& rowTerms) const
+{
+    // The phase of an element is -2 * pi times the dot product of the direction and of its
+    // location (see GetElementLocation), which is the sum of the column index times the
+    // projection of the direction on the horizontal axis of the array, and of the row index
+    // times the projection of the direction on its vertical axis
+    double sinIncl = sin(a.GetInclination());
+    double cosIncl = cos(a.GetInclination());
+    double cosAzim = cos(a.GetAzimuth());
+    double sinAzim = sin(a.GetAzimuth());
+    double horizontal = sinIncl * (sinAzim * m_cosAlpha - cosAzim * m_sinAlpha);
+    double vertical =
+        sinIncl * m_sinBeta * (cosAzim * m_cosAlpha + sinAzim * m_sinAlpha) + cosIncl * m_cosBeta;
+
+    columnTerms.resize(m_numColumns);
+    for (uint32_t c = 0; c < m_numColumns; c++)
+    {
+        columnTerms[c] = std::polar<double>(1.0, -2 * M_PI * m_disH * c * horizontal);
+    }
+    rowTerms.resize(m_numRows);
+    for (uint32_t r = 0; r < m_numRows; r++)
+    {
+        rowTerms[r] = std::polar<double>(1.0, -2 * M_PI * m_disV * r * vertical);
+    }
+}
+
+PhasedArrayModel::ComplexVector
+UniformPlanarArray::GetSteeringVector(Angles a) const
+{
+    ComplexVector columnTerms;
+    ComplexVector rowTerms;
+    ComputeSteeringTerms(a, columnTerms, rowTerms);
+
+    ComplexVector steeringVector(GetNumberOfElements());
+    for (uint32_t r = 0; r < m_numRows; r++)
+    {
+        for (uint32_t c = 0; c < m_numColumns; c++)
+        {
+            steeringVector[r * m_numColumns + c] = rowTerms[r] * columnTerms[c];
+        }
+    }
+    return steeringVector;
+}
+
+PhasedArrayModel::ComplexVector
+UniformPlanarArray::GetSteeringVectors(const std::vector<Angles>& angles) const
+{
+    std::size_t numAngles = angles.size();
+    std::vector<ComplexVector> columnTerms(numAngles);
+    std::vector<ComplexVector> rowTerms(numAngles);
+    for (std::size_t j = 0; j < numAngles; j++)
+    {
+        ComputeSteeringTerms(angles[j], columnTerms[j], rowTerms[j]);
+    }
+
+    ComplexVector steeringVectors(GetNumberOfElements() * numAngles);
+    auto it = steeringVectors.begin();
+    for (uint32_t r = 0; r < m_numRows; r++)
+    {
+        for (uint32_t c = 0; c < m_numColumns; c++)
+        {
+            for (std::size_t j = 0; j < numAngles; j++)
+            {
+                *it++ = rowTerms[j][r] * columnTerms[j][c];
+            }
+        }
+    }
+    return steeringVectors;
+}
+
 Vector
 UniformPlanarArray::GetElementLocation(uint64_t index) const
 {
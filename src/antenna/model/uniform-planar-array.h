@@ -61,6 +61,33 @@ class UniformPlanarArray : public PhasedArrayModel
      */
     std::pair<double, double> GetElementFieldPattern(Angles a) const override;
 
+    /**
+     * Returns the horizontal and vertical components of the antenna element field
+     * pattern at the specified directions, as GetElementFieldPattern does for each
+     * of them.
+     * \param angles the angles indicating the interested directions
+     * \return the field patterns at each of the directions
+     */
+    std::vector<std::pair<double, double>> GetElementFieldPatterns(
+        const std::vector<Angles>& angles) const override;
+
+    /**
+     * Returns the steering vector that points toward the specified position.
+     * The phase of an element being linear in its row and column, the steering vector
+     * is the product of a phase term per row and a phase term per column.
+     * \param a the steering angle
+     * \return the steering vector
+     */
+    ComplexVector GetSteeringVector(Angles a) const override;
+
+    /**
+     * Returns the steering vectors that point toward the specified positions.
+     * \param angles the steering angles
+     * \return the steering vectors, where the element i of the steering vector
+     *         toward angles[j] has index i * angles.size() + j
+     */
+    ComplexVector GetSteeringVectors(const std::vector<Angles>& angles) const override;
+
     /**
      * Returns the location of the antenna element with the specified
      * index assuming the left bottom corner is (0,0,0), normalized
@@ -164,6 +191,22 @@ class UniformPlanarArray : public PhasedArrayModel
      */
     double GetAntennaVerticalSpacing() const;
 
+    /**
+     * Computes the field pattern of the antenna element at the specified direction
+     * \param a the angle indicating the interested direction
+     * \return the field pattern, as returned by GetElementFieldPattern
+     */
+    std::pair<double, double> ComputeElementFieldPattern(Angles a) const;
+
+    /**
+     * Computes the phase terms of the steering vector toward the specified direction,
+     * whose element of row r and column c is rowTerms[r] * columnTerms[c]
+     * \param a the steering angle
+     * \param columnTerms the phase term of each column
+     * \param rowTerms the phase term of each row
+     */
+    void ComputeSteeringTerms(Angles a, ComplexVector& columnTerms, ComplexVector& rowTerms) const;
+
     uint32_t m_numColumns{1}; //!< number of columns
     uint32_t m_numRows{1};    //!< number of rows
     double m_disV{0.5}; //!< antenna spacing in the vertical direction in multiples of wave length
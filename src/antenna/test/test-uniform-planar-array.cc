@@ -19,6 +19,7 @@
 #include "iostream"
 #include "sstream"
 #include "string"
+#include "tuple"
 
 #include "ns3/double.h"
 #include "ns3/isotropic-antenna-model.h"
@@ -203,6 +204,90 @@ UniformPlanarArrayTestCase::DoRun()
                               "wrong value of the radiation pattern");
 }
 
+/**
+ * \ingroup antenna-tests
+ *
+ * \brief Test that the steering vectors and field patterns of a UniformPlanarArray
+ * computed for several angles at once, or from the phase terms of its rows and
+ * columns, are those computed per angle and per element by PhasedArrayModel
+ */
+class UniformPlanarArrayBatchTestCase : public TestCase
+{
+  public:
+    UniformPlanarArrayBatchTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+UniformPlanarArrayBatchTestCase::UniformPlanarArrayBatchTestCase()
+    : TestCase("Check the steering vectors and field patterns computed for several angles")
+{
+}
+
+void
+UniformPlanarArrayBatchTestCase::DoRun()
+{
+    std::vector<Angles> angles;
+    for (double azimuth = -180; azimuth < 180; azimuth += 37)
+    {
+        for (double inclination = 0; inclination <= 180; inclination += 22.5)
+        {
+            angles.emplace_back(DegreesToRadians(azimuth), DegreesToRadians(inclination));
+        }
+    }
+
+    Ptr<UniformPlanarArray> a = CreateObject<UniformPlanarArray>();
+    a->SetAttribute("AntennaElement", PointerValue(CreateObject<ThreeGppAntennaModel>()));
+    for (auto [rows, cols, alpha, beta] : {std::make_tuple(1U, 1U, 0.0, 0.0),
+                                           std::make_tuple(4U, 8U, 0.0, 0.0),
+                                           std::make_tuple(8U, 4U, 30.0, 0.0),
+                                           std::make_tuple(16U, 16U, -120.0, 45.0)})
+    {
+        a->SetAttribute("NumRows", UintegerValue(rows));
+        a->SetAttribute("NumColumns", UintegerValue(cols));
+        a->SetAttribute("AntennaVerticalSpacing", DoubleValue(0.5));
+        a->SetAttribute("AntennaHorizontalSpacing", DoubleValue(0.7));
+        a->SetAttribute("BearingAngle", DoubleValue(DegreesToRadians(alpha)));
+        a->SetAttribute("DowntiltAngle", DoubleValue(DegreesToRadians(beta)));
+        uint64_t numElements = a->GetNumberOfElements();
+
+        PhasedArrayModel::ComplexVector steeringVectors = a->GetSteeringVectors(angles);
+        NS_TEST_ASSERT_MSG_EQ(steeringVectors.size(),
+                              numElements * angles.size(),
+                              "steering vectors of wrong size");
+        std::vector<std::pair<double, double>> fieldPatterns = a->GetElementFieldPatterns(angles);
+        NS_TEST_ASSERT_MSG_EQ(fieldPatterns.size(), angles.size(), "wrong number of patterns");
+        for (std::size_t j = 0; j < angles.size(); j++)
+        {
+            PhasedArrayModel::ComplexVector expected =
+                a->PhasedArrayModel::GetSteeringVector(angles[j]);
+            PhasedArrayModel::ComplexVector sv = a->GetSteeringVector(angles[j]);
+            for (uint64_t i = 0; i < numElements; i++)
+            {
+                NS_TEST_EXPECT_MSG_LT(std::abs(sv[i] - expected[i]),
+                                      1e-12,
+                                      "wrong steering vector element " << i << " toward "
+                                                                       << angles[j]);
+                NS_TEST_EXPECT_MSG_LT(std::abs(steeringVectors[i * angles.size() + j] -
+                                               expected[i]),
+                                      1e-12,
+                                      "wrong steering vectors element " << i << " toward "
+                                                                        << angles[j]);
+            }
+            std::pair<double, double> fp = a->GetElementFieldPattern(angles[j]);
+            NS_TEST_EXPECT_MSG_EQ_TOL(fieldPatterns[j].first, fp.first, 1e-12, "wrong pattern");
+            NS_TEST_EXPECT_MSG_EQ_TOL(fieldPatterns[j].second, fp.second, 1e-12, "wrong pattern");
+        }
+
+        // each beamforming vector that is set has a new identifier
+        a->SetBeamformingVector(a->GetBeamformingVector(angles[0]));
+        uint64_t uid = a->GetBeamformingVectorUid();
+        a->SetBeamformingVector(a->GetBeamformingVectorRef());
+        NS_TEST_EXPECT_MSG_NE(a->GetBeamformingVectorUid(), uid, "beamforming vector not new");
+    }
+}
+
 /**
  * \ingroup antenna-tests
  *
@@ -217,6 +302,8 @@ class UniformPlanarArrayTestSuite : public TestSuite
 UniformPlanarArrayTestSuite::UniformPlanarArrayTestSuite()
     : TestSuite("uniform-planar-array-test", UNIT)
 {
+    AddTestCase(new UniformPlanarArrayBatchTestCase, TestCase::QUICK);
+
     Ptr<AntennaModel> isotropic = CreateObject<IsotropicAntennaModel>();
     Ptr<AntennaModel> tgpp = CreateObject<ThreeGppAntennaModel>();
 
@@ -42,6 +42,17 @@ NS_LOG_COMPONENT_DEFINE("DefaultSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED(DefaultSimulatorImpl);
 
+namespace
+{
+
+/**
+ * \ingroup simulator
+ * Capacity of the lock-free queue of events from a different context.
+ */
+constexpr std::size_t EVENTS_WITH_CONTEXT_CAPACITY = 4096;
+
+} // unnamed namespace
+
 TypeId
 DefaultSimulatorImpl::GetTypeId()
 {
@@ -53,6 +64,8 @@ DefaultSimulatorImpl::GetTypeId()
 }
 
 DefaultSimulatorImpl::DefaultSimulatorImpl()
+    : m_eventsWithContext(EVENTS_WITH_CONTEXT_CAPACITY),
+      m_eventsWithContextOverflowed(false)
 {
     NS_LOG_FUNCTION(this);
     m_stop = false;
@@ -62,7 +75,6 @@ DefaultSimulatorImpl::DefaultSimulatorImpl()
     m_currentContext = Simulator::NO_CONTEXT;
     m_unscheduledEvents = 0;
     m_eventCount = 0;
-    m_eventsWithContextEmpty = true;
     m_mainThreadId = std::this_thread::get_id();
 }
 
@@ -156,33 +168,46 @@ DefaultSimulatorImpl::IsFinished() const
 void
 DefaultSimulatorImpl::ProcessEventsWithContext()
 {
-    if (m_eventsWithContextEmpty)
+    if (m_eventsWithContext.IsEmpty() &&
+        !m_eventsWithContextOverflowed.load(std::memory_order_acquire))
     {
         return;
     }
 
-    // swap queues
-    EventsWithContext eventsWithContext;
+    EventWithContext event;
+    while (m_eventsWithContext.Pop(event))
     {
-        std::unique_lock lock{m_eventsWithContextMutex};
-        m_eventsWithContext.swap(eventsWithContext);
-        m_eventsWithContextEmpty = true;
+        InsertEventWithContext(event);
     }
-    while (!eventsWithContext.empty())
+    // the overflow list holds events pushed after those of the queue
+    if (m_eventsWithContextOverflowed.load(std::memory_order_acquire))
     {
-        EventWithContext event = eventsWithContext.front();
-        eventsWithContext.pop_front();
-        Scheduler::Event ev;
-        ev.impl = event.event;
-        ev.key.m_ts = m_currentTs + event.timestamp;
-        ev.key.m_context = event.context;
-        ev.key.m_uid = m_uid;
-        m_uid++;
-        m_unscheduledEvents++;
-        m_events->Insert(ev);
+        EventsWithContext eventsWithContext;
+        {
+            std::unique_lock lock{m_eventsWithContextMutex};
+            m_eventsWithContextOverflow.swap(eventsWithContext);
+            m_eventsWithContextOverflowed.store(false, std::memory_order_release);
+        }
+        for (const auto& overflowEvent : eventsWithContext)
+        {
+            InsertEventWithContext(overflowEvent);
+        }
     }
 }
 
+void
+DefaultSimulatorImpl::InsertEventWithContext(const EventWithContext& event)
+{
+    Scheduler::Event ev;
+    ev.impl = event.event;
+    ev.key.m_ts = m_currentTs + event.timestamp;
+    ev.key.m_context = event.context;
+    ev.key.m_uid = m_uid;
+    m_uid++;
+    m_unscheduledEvents++;
+    m_events->Insert(ev);
+}
+
 void
 DefaultSimulatorImpl::Run()
 {
@@ -266,10 +291,14 @@ DefaultSimulatorImpl::ScheduleWithContext(uint32_t context, const Time& delay, E
         // Current time added in ProcessEventsWithContext()
         ev.timestamp = delay.GetTimeStep();
         ev.event = event;
+        // once an event overflowed, the next ones follow it until the
+        // main thread drains the overflow list, to keep them in order
+        if (m_eventsWithContextOverflowed.load(std::memory_order_acquire) ||
+            !m_eventsWithContext.Push(ev))
         {
             std::unique_lock lock{m_eventsWithContextMutex};
-            m_eventsWithContext.push_back(ev);
-            m_eventsWithContextEmpty = false;
+            m_eventsWithContextOverflow.push_back(ev);
+            m_eventsWithContextOverflowed.store(true, std::memory_order_release);
         }
     }
 }
@@ -401,6 +430,18 @@ DefaultSimulatorImpl::GetContext() const
     return m_currentContext;
 }
 
+void
+DefaultSimulatorImpl::SetContext(uint32_t context)
+{
+    m_currentContext = context;
+}
+
+bool
+DefaultSimulatorImpl::IsLocalContext(uint32_t context) const
+{
+    return true;
+}
+
 uint64_t
 DefaultSimulatorImpl::GetEventCount() const
 {
@@ -20,8 +20,10 @@
 #ifndef DEFAULT_SIMULATOR_IMPL_H
 #define DEFAULT_SIMULATOR_IMPL_H
 
+#include "mpsc-queue.h"
 #include "simulator-impl.h"
 
+#include <atomic>
 #include <list>
 #include <mutex>
 #include <thread>
@@ -76,6 +78,8 @@ class DefaultSimulatorImpl : public SimulatorImpl
     void SetScheduler(ObjectFactory schedulerFactory) override;
     uint32_t GetSystemId() const override;
     uint32_t GetContext() const override;
+    void SetContext(uint32_t context) override;
+    bool IsLocalContext(uint32_t context) const override;
     uint64_t GetEventCount() const override;
 
   private:
@@ -96,16 +100,28 @@ class DefaultSimulatorImpl : public SimulatorImpl
         /** The event implementation. */
         EventImpl* event;
     };
-    /** Container type for the events from a different context. */
-    typedef std::list<struct EventWithContext> EventsWithContext;
-    /** The container of events from a different context. */
-    EventsWithContext m_eventsWithContext;
     /**
-     * Flag \c true if all events with context have been moved to the
-     * primary event queue.
+     * Insert an event from a different context in the main event queue.
+     *
+     * \param [in] event The event, with its delay from the current time.
      */
-    bool m_eventsWithContextEmpty;
-    /** Mutex to control access to the list of events with context. */
+    void InsertEventWithContext(const EventWithContext& event);
+
+    /**
+     * The events from a different context, pushed without locking by the
+     * other threads and popped by the main thread.
+     */
+    MpscQueue<EventWithContext> m_eventsWithContext;
+    /** Container type for the events which did not fit in m_eventsWithContext. */
+    typedef std::list<EventWithContext> EventsWithContext;
+    /**
+     * The events from a different context pushed while m_eventsWithContext
+     * was full, or while this list was not empty to preserve their order.
+     */
+    EventsWithContext m_eventsWithContextOverflow;
+    /** Flag \c true if m_eventsWithContextOverflow is not empty. */
+    std::atomic<bool> m_eventsWithContextOverflowed;
+    /** Mutex to control access to m_eventsWithContextOverflow. */
     std::mutex m_eventsWithContextMutex;
 
     /** Container type for the events to run at Simulator::Destroy() */
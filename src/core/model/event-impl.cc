@@ -21,6 +21,10 @@
 
 #include "log.h"
 
+#include <atomic>
+#include <new>
+#include <type_traits>
+
 /**
  * \file
  * \ingroup events
@@ -32,6 +36,203 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("EventImpl");
 
+namespace
+{
+
+/**
+ * \ingroup events
+ * Free lists of event memory, per size class.
+ *
+ * The pool is trivially destructible, so that it can still be used by the
+ * events released after the exit hook of its thread has run.
+ */
+class EventMemoryPool
+{
+  public:
+    /** Size class granularity, in bytes. */
+    static constexpr std::size_t GRANULARITY = 16;
+    /** Number of size classes; bigger events bypass the pool. */
+    static constexpr std::size_t N_CLASSES = 8;
+    /** Maximum number of free blocks kept per size class. */
+    static constexpr std::size_t MAX_FREE = 1 << 16;
+
+    /**
+     * Release the free blocks to the system, and stop keeping the blocks
+     * released afterwards.  Called at thread exit.
+     */
+    void Release();
+
+    /**
+     * Get the size class of an event.
+     * \param [in] size The size of the event.
+     * \return The size class, or \c N_CLASSES if too big.
+     */
+    static std::size_t GetClass(std::size_t size);
+
+    /**
+     * Get a free block.
+     * \param [in] sizeClass The size class.
+     * \return The block, or \c nullptr if none is available.
+     */
+    void* Pop(std::size_t sizeClass);
+    /**
+     * Store a free block.
+     * \param [in] p The block.
+     * \param [in] sizeClass The size class.
+     * \return \c false if the block was not kept.
+     */
+    bool Push(void* p, std::size_t sizeClass);
+
+  private:
+    /** A free block, linked to the next one. */
+    struct Block
+    {
+        Block* next; //!< The next free block.
+    };
+
+    Block* m_free[N_CLASSES];        //!< Free lists.
+    std::size_t m_nFree[N_CLASSES];  //!< Lengths of the free lists.
+    bool m_hooked;                   //!< Whether the exit hook is registered.
+    bool m_released;                 //!< Set at thread exit.
+};
+
+/**
+ * \ingroup events
+ * The event memory pool of each thread.  Events scheduled from another
+ * thread than the one executing them simply migrate between the pools.
+ * Zero-initialized and trivially destructible.
+ */
+thread_local EventMemoryPool g_eventMemoryPool;
+
+static_assert(std::is_trivially_destructible_v<EventMemoryPool>,
+              "The event memory pool must stay usable after its thread exit hook");
+
+/**
+ * \ingroup events
+ * Releases the event memory pool of its thread at thread exit.
+ */
+struct EventMemoryPoolExitHook
+{
+    /**
+     * Register the hook of the current thread: the first use of the
+     * thread_local constructs it, and its destructor then runs at thread exit.
+     */
+    void Register()
+    {
+    }
+
+    /** Destructor: release the pool of the thread. */
+    ~EventMemoryPoolExitHook()
+    {
+        g_eventMemoryPool.Release();
+    }
+};
+
+/**
+ * \ingroup events
+ * The exit hook of each thread, constructed when the pool of the thread
+ * first keeps a block.
+ */
+thread_local EventMemoryPoolExitHook g_eventMemoryPoolExitHook;
+
+void
+EventMemoryPool::Release()
+{
+    for (std::size_t i = 0; i < N_CLASSES; ++i)
+    {
+        while (m_free[i] != nullptr)
+        {
+            Block* block = m_free[i];
+            m_free[i] = block->next;
+            ::operator delete(block);
+        }
+    }
+    // Events released later, e.g. by static destructors, bypass the pool.
+    m_released = true;
+}
+
+std::size_t
+EventMemoryPool::GetClass(std::size_t size)
+{
+    std::size_t sizeClass = (size + GRANULARITY - 1) / GRANULARITY - 1;
+    return sizeClass < N_CLASSES ? sizeClass : N_CLASSES;
+}
+
+void*
+EventMemoryPool::Pop(std::size_t sizeClass)
+{
+    Block* block = m_free[sizeClass];
+    if (block == nullptr)
+    {
+        return nullptr;
+    }
+    m_free[sizeClass] = block->next;
+    m_nFree[sizeClass]--;
+    return block;
+}
+
+bool
+EventMemoryPool::Push(void* p, std::size_t sizeClass)
+{
+    if (m_released || m_nFree[sizeClass] >= MAX_FREE)
+    {
+        return false;
+    }
+    if (!m_hooked)
+    {
+        m_hooked = true;
+        g_eventMemoryPoolExitHook.Register();
+    }
+    Block* block = static_cast<Block*>(p);
+    block->next = m_free[sizeClass];
+    m_free[sizeClass] = block;
+    m_nFree[sizeClass]++;
+    return true;
+}
+
+/**
+ * \ingroup events
+ * Number of events allocated with the global operator new.
+ */
+std::atomic<uint64_t> g_eventHeapAllocations(0);
+
+} // unnamed namespace
+
+void*
+EventImpl::operator new(std::size_t size)
+{
+    std::size_t sizeClass = EventMemoryPool::GetClass(size);
+    if (sizeClass < EventMemoryPool::N_CLASSES)
+    {
+        void* p = g_eventMemoryPool.Pop(sizeClass);
+        if (p != nullptr)
+        {
+            return p;
+        }
+        // allocate the whole size class, for the next events of this class
+        size = (sizeClass + 1) * EventMemoryPool::GRANULARITY;
+    }
+    g_eventHeapAllocations.fetch_add(1, std::memory_order_relaxed);
+    return ::operator new(size);
+}
+
+void
+EventImpl::operator delete(void* p, std::size_t size)
+{
+    std::size_t sizeClass = EventMemoryPool::GetClass(size);
+    if (sizeClass < EventMemoryPool::N_CLASSES && g_eventMemoryPool.Push(p, sizeClass))
+    {
+        return;
+    }
+    ::operator delete(p);
+}
+
+uint64_t
+EventImpl::GetHeapAllocations()
+{
+    return g_eventHeapAllocations.load(std::memory_order_relaxed);
+}
+
 EventImpl::~EventImpl()
 {
     NS_LOG_FUNCTION(this);
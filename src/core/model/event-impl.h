@@ -21,6 +21,7 @@
 
 #include "simple-ref-count.h"
 
+#include <cstddef>
 #include <stdint.h>
 
 /**
@@ -67,6 +68,40 @@ class EventImpl : public SimpleRefCount<EventImpl>
      */
     bool IsCancelled();
 
+    /**
+     * \name Event memory pool
+     *
+     * The events are allocated and released at a high rate, with a small
+     * number of distinct sizes (one per MakeEvent() closure type).  The
+     * memory of the released events is kept in free lists, one per size
+     * class of 16 bytes up to 128 bytes and per thread, and reused for the
+     * next events of the same size class, so that scheduling events in
+     * steady state does not call the global operator new.
+     * @{
+     */
+    /**
+     * Allocate the memory of an event.
+     *
+     * \param [in] size The size of the event.
+     * \return The memory, from the free lists of the calling thread if possible.
+     */
+    static void* operator new(std::size_t size);
+    /**
+     * Release the memory of an event.
+     *
+     * \param [in] p The memory.
+     * \param [in] size The size of the event.
+     */
+    static void operator delete(void* p, std::size_t size);
+    /**
+     * Get the number of event allocations which could not be served by the
+     * free lists, in all threads.
+     *
+     * \return The number of calls to the global operator new for events.
+     */
+    static uint64_t GetHeapAllocations();
+    /**@}*/
+
   protected:
     /**
      * Implementation for Invoke().
@@ -0,0 +1,341 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ladder-scheduler.h"
+
+#include "assert.h"
+#include "event-impl.h"
+#include "log.h"
+#include "type-id.h"
+#include "uinteger.h"
+
+#include <algorithm>
+#include <limits>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class implementation.
+ */
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("LadderScheduler");
+
+NS_OBJECT_ENSURE_REGISTERED(LadderScheduler);
+
+TypeId
+LadderScheduler::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::LadderScheduler")
+            .SetParent<Scheduler>()
+            .SetGroupName("Core")
+            .AddConstructor<LadderScheduler>()
+            .AddAttribute("MaxBucketSize",
+                          "Buckets with more events are split in a new rung, "
+                          "instead of being sorted in the bottom",
+                          UintegerValue(50),
+                          MakeUintegerAccessor(&LadderScheduler::m_maxBucketSize),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("MaxRungs",
+                          "The maximum number of rungs of the ladder",
+                          UintegerValue(8),
+                          MakeUintegerAccessor(&LadderScheduler::m_maxRungs),
+                          MakeUintegerChecker<uint32_t>(1));
+    return tid;
+}
+
+uint64_t
+LadderScheduler::Rung::CurrentStart() const
+{
+    return start + current * width;
+}
+
+LadderScheduler::LadderScheduler()
+    : m_topMin(std::numeric_limits<uint64_t>::max()),
+      m_topMax(0),
+      m_topStart(0),
+      m_nRungs(0),
+      m_bottomHead(0),
+      m_qSize(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+LadderScheduler::~LadderScheduler()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+LadderScheduler::InitRung(Rung& rung, uint64_t start, uint64_t end, uint32_t nEvents)
+{
+    NS_LOG_FUNCTION(this << start << end << nEvents);
+    NS_ASSERT(end > start);
+    uint64_t span = end - start;
+    uint64_t n = std::max<uint64_t>(nEvents, 1);
+    rung.start = start;
+    rung.width = (span + n - 1) / n;
+    rung.nBuckets = (span + rung.width - 1) / rung.width;
+    rung.current = 0;
+    rung.nEvents = 0;
+    if (rung.buckets.size() < rung.nBuckets)
+    {
+        rung.buckets.resize(rung.nBuckets);
+    }
+    NS_LOG_LOGIC("rung: width=" << rung.width << ", nBuckets=" << rung.nBuckets);
+}
+
+uint32_t
+LadderScheduler::FindRung(uint64_t ts) const
+{
+    // Each rung covers the span of the current bucket of the previous one.
+    for (uint32_t i = 0; i < m_nRungs; i++)
+    {
+        if (ts >= m_rungs[i].CurrentStart())
+        {
+            return i;
+        }
+    }
+    return m_nRungs;
+}
+
+void
+LadderScheduler::InsertBottom(const Scheduler::Event& ev)
+{
+    auto begin = m_bottom.begin() + m_bottomHead;
+    auto it = std::upper_bound(begin, m_bottom.end(), ev);
+    if (it == begin && m_bottomHead > 0)
+    {
+        // Reuse the slot of the last dequeued event.
+        m_bottomHead--;
+        m_bottom[m_bottomHead] = ev;
+    }
+    else
+    {
+        m_bottom.insert(it, ev);
+    }
+}
+
+void
+LadderScheduler::Insert(const Scheduler::Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    m_qSize++;
+    uint64_t ts = ev.key.m_ts;
+    if (ts >= m_topStart)
+    {
+        m_top.push_back(ev);
+        m_topMin = std::min(m_topMin, ts);
+        m_topMax = std::max(m_topMax, ts);
+    }
+    else
+    {
+        uint32_t i = FindRung(ts);
+        if (i < m_nRungs)
+        {
+            Rung& rung = m_rungs[i];
+            rung.buckets[(ts - rung.start) / rung.width].push_back(ev);
+            rung.nEvents++;
+        }
+        else
+        {
+            InsertBottom(ev);
+        }
+    }
+    if (m_bottomHead == m_bottom.size())
+    {
+        // The queue was empty
+        Refill();
+    }
+}
+
+bool
+LadderScheduler::IsEmpty() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_qSize == 0;
+}
+
+Scheduler::Event
+LadderScheduler::PeekNext() const
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    return m_bottom[m_bottomHead];
+}
+
+Scheduler::Event
+LadderScheduler::RemoveNext()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(!IsEmpty());
+    Scheduler::Event ev = m_bottom[m_bottomHead];
+    m_bottomHead++;
+    m_qSize--;
+    if (m_bottomHead == m_bottom.size() && m_qSize > 0)
+    {
+        Refill();
+    }
+    NS_LOG_DEBUG("remove " << ev.impl << " at " << ev.key.m_ts);
+    return ev;
+}
+
+void
+LadderScheduler::Remove(const Scheduler::Event& ev)
+{
+    NS_LOG_FUNCTION(this << ev.impl << ev.key.m_ts << ev.key.m_uid);
+    NS_ASSERT(!IsEmpty());
+    uint64_t ts = ev.key.m_ts;
+    uint32_t i = m_nRungs;
+    Bucket* bucket = nullptr;
+    if (ts >= m_topStart)
+    {
+        bucket = &m_top;
+    }
+    else
+    {
+        i = FindRung(ts);
+        if (i < m_nRungs)
+        {
+            Rung& rung = m_rungs[i];
+            bucket = &rung.buckets[(ts - rung.start) / rung.width];
+        }
+    }
+
+    if (bucket != nullptr)
+    {
+        // Buckets are not sorted: replace the event by the last one.
+        auto it = std::find_if(bucket->begin(), bucket->end(), [&ev](const Event& e) {
+            return e.key.m_uid == ev.key.m_uid;
+        });
+        NS_ASSERT_MSG(it != bucket->end(), "Event not found");
+        *it = bucket->back();
+        bucket->pop_back();
+        if (i < m_nRungs)
+        {
+            m_rungs[i].nEvents--;
+        }
+    }
+    else
+    {
+        auto begin = m_bottom.begin() + m_bottomHead;
+        auto it = std::lower_bound(begin, m_bottom.end(), ev);
+        NS_ASSERT_MSG(it != m_bottom.end() && it->key.m_uid == ev.key.m_uid, "Event not found");
+        if (it == begin)
+        {
+            m_bottomHead++;
+        }
+        else
+        {
+            m_bottom.erase(it);
+        }
+    }
+    m_qSize--;
+    if (m_bottomHead == m_bottom.size() && m_qSize > 0)
+    {
+        Refill();
+    }
+}
+
+void
+LadderScheduler::TransferTop()
+{
+    NS_LOG_FUNCTION(this << m_top.size());
+    NS_ASSERT(m_nRungs == 0 && !m_top.empty());
+    if (m_rungs.empty())
+    {
+        m_rungs.emplace_back();
+    }
+    Rung& rung = m_rungs[0];
+    InitRung(rung, m_topMin, m_topMax + 1, m_top.size());
+    for (const auto& ev : m_top)
+    {
+        rung.buckets[(ev.key.m_ts - rung.start) / rung.width].push_back(ev);
+    }
+    rung.nEvents = m_top.size();
+    m_nRungs = 1;
+    m_topStart = rung.start + rung.nBuckets * rung.width;
+    m_top.clear();
+    m_topMin = std::numeric_limits<uint64_t>::max();
+    m_topMax = 0;
+}
+
+void
+LadderScheduler::Refill()
+{
+    NS_LOG_FUNCTION(this);
+    m_bottom.clear();
+    m_bottomHead = 0;
+    while (true)
+    {
+        if (m_nRungs == 0)
+        {
+            if (m_top.empty())
+            {
+                return;
+            }
+            TransferTop();
+        }
+        uint32_t last = m_nRungs - 1;
+        Rung* rung = &m_rungs[last];
+        while (rung->current < rung->nBuckets && rung->buckets[rung->current].empty())
+        {
+            rung->current++;
+        }
+        if (rung->current == rung->nBuckets)
+        {
+            NS_ASSERT(rung->nEvents == 0);
+            m_nRungs--;
+            continue;
+        }
+
+        uint32_t size = rung->buckets[rung->current].size();
+        if (size <= m_maxBucketSize || m_nRungs == m_maxRungs || rung->width == 1)
+        {
+            // Sort the bucket in the bottom, exchanging their storage.
+            m_bottom.swap(rung->buckets[rung->current]);
+            rung->current++;
+            rung->nEvents -= size;
+            std::sort(m_bottom.begin(), m_bottom.end());
+            return;
+        }
+
+        // Split the bucket in a new rung, spanning from its earliest event.
+        if (m_rungs.size() == m_nRungs)
+        {
+            m_rungs.emplace_back();
+            rung = &m_rungs[last];
+        }
+        Bucket& bucket = rung->buckets[rung->current];
+        uint64_t end = rung->CurrentStart() + rung->width;
+        uint64_t start = std::min_element(bucket.begin(), bucket.end())->key.m_ts;
+        rung->current++;
+        rung->nEvents -= size;
+        Rung& child = m_rungs[m_nRungs];
+        InitRung(child, start, end, size);
+        for (const auto& ev : bucket)
+        {
+            child.buckets[(ev.key.m_ts - child.start) / child.width].push_back(ev);
+        }
+        child.nEvents = size;
+        bucket.clear();
+        m_nRungs++;
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,177 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LADDER_SCHEDULER_H
+#define LADDER_SCHEDULER_H
+
+#include "scheduler.h"
+
+#include <stdint.h>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup scheduler
+ * ns3::LadderScheduler class declaration.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup scheduler
+ * \brief a ladder queue event scheduler
+ *
+ * This event scheduler implements the ladder queue described in
+ * ["Ladder Queue: An O(1) Priority Queue Structure for Large-Scale
+ * Discrete Event Simulation" by Wai Teng Tang, Rick Siow Mong Goh
+ * and Ian Li-Jin Thng][Tang].
+ *
+ * [Tang]: https://doi.org/10.1145/1103323.1103324 "Tang"
+ *
+ * The events are kept in three tiers:
+ *
+ * - _top_: an unsorted array holding the events of the far future,
+ *   at or after \c m_topStart;
+ * - _ladder_: a stack of _rungs_, each an array of buckets of uniform
+ *   width.  The first rung is created from the top when the ladder is
+ *   empty, with a bucket width chosen from the span and number of the
+ *   events.  Each following rung subdivides a single bucket of the
+ *   previous rung which held more than \c MaxBucketSize events;
+ * - _bottom_: a sorted array of the earliest events, from which
+ *   events are dequeued.  It is refilled with the next non-empty bucket
+ *   of the last rung.
+ *
+ * Events are only sorted once they reach the bottom, which is kept
+ * small; the bucket width adapts to the event distribution each time
+ * the top is transferred to the ladder.  All the tiers are contiguous
+ * arrays whose storage is reused, so that in steady state
+ * inserting and removing events does not allocate memory.
+ *
+ * \par Time Complexity
+ *
+ * Operation    | Amortized %Time | Reason
+ * :----------- | :-------------- | :-----
+ * Insert()     | ~Constant       | Append to top or bucket; insertion in small bottom
+ * IsEmpty()    | Constant        | Explicit queue size
+ * PeekNext()   | Constant        | Bottom is kept non-empty
+ * Remove()     | ~Constant       | Search within bucket
+ * RemoveNext() | ~Constant       | Refill of bottom from the ladder
+ *
+ * \par Memory Complexity
+ *
+ * Category  | Memory                           | Reason
+ * :-------- | :------------------------------- | :-----
+ * Overhead  | 3 x `std::vector` + 1 per rung   | Top, bottom and rungs
+ * Per Event | `std::vector` (24 bytes)         | About one bucket per event in the ladder
+ */
+class LadderScheduler : public Scheduler
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    LadderScheduler();
+    /** Destructor. */
+    ~LadderScheduler() override;
+
+    // Inherited
+    void Insert(const Scheduler::Event& ev) override;
+    bool IsEmpty() const override;
+    Scheduler::Event PeekNext() const override;
+    Scheduler::Event RemoveNext() override;
+    void Remove(const Scheduler::Event& ev) override;
+
+  private:
+    /** Array of unsorted events. */
+    typedef std::vector<Scheduler::Event> Bucket;
+
+    /** A rung of the ladder. */
+    struct Rung
+    {
+        uint64_t start;              //!< Timestamp at the start of the first bucket.
+        uint64_t width;              //!< Duration of a bucket.
+        uint32_t nBuckets;           //!< Number of buckets in use.
+        uint32_t current;            //!< Index of the first bucket not yet dequeued.
+        uint32_t nEvents;            //!< Number of events in the buckets.
+        std::vector<Bucket> buckets; //!< The buckets; may be larger than nBuckets.
+
+        /** \return The timestamp at the start of the current bucket. */
+        uint64_t CurrentStart() const;
+    };
+
+    /**
+     * Initialize a rung covering an interval.
+     *
+     * \param [in] rung The rung to initialize.
+     * \param [in] start The start of the interval.
+     * \param [in] end The exclusive end of the interval.
+     * \param [in] nEvents The number of events expected in the interval.
+     */
+    void InitRung(Rung& rung, uint64_t start, uint64_t end, uint32_t nEvents);
+    /**
+     * Find the rung holding a timestamp.
+     *
+     * \param [in] ts The timestamp.
+     * \return The index of the rung, or \c m_nRungs if the timestamp
+     * belongs to the bottom.
+     */
+    uint32_t FindRung(uint64_t ts) const;
+    /**
+     * Insert an event in the sorted bottom.
+     *
+     * \param [in] ev The event.
+     */
+    void InsertBottom(const Scheduler::Event& ev);
+    /** Move the earliest events to the bottom, which must be empty. */
+    void Refill();
+    /** Move all the top events to the first rung, which must be empty. */
+    void TransferTop();
+
+    /** The top: events at or after \c m_topStart. */
+    Bucket m_top;
+    /** Smallest timestamp in the top. */
+    uint64_t m_topMin;
+    /** Largest timestamp in the top. */
+    uint64_t m_topMax;
+    /** Events at or after this timestamp are inserted in the top. */
+    uint64_t m_topStart;
+
+    /** The rungs; only the first \c m_nRungs ones are in use. */
+    std::vector<Rung> m_rungs;
+    /** Number of rungs in use. */
+    uint32_t m_nRungs;
+
+    /** The bottom, sorted; events before \c m_bottomHead are already dequeued. */
+    Bucket m_bottom;
+    /** Index of the first event of the bottom. */
+    uint32_t m_bottomHead;
+
+    /** Number of events in queue. */
+    uint32_t m_qSize;
+
+    /** Buckets with more events are split in a new rung. */
+    uint32_t m_maxBucketSize;
+    /** Maximum number of rungs. */
+    uint32_t m_maxRungs;
+};
+
+} // namespace ns3
+
+#endif /* LADDER_SCHEDULER_H */
@@ -0,0 +1,212 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::MpscQueue class declaration and template implementation.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup core
+ * \brief A bounded, lock-free, multiple producer single consumer queue.
+ *
+ * The items are stored in a ring of cells, each with a sequence number
+ * telling whether the cell is free for the producer of a given position
+ * or holds the item of the consumer of that position, following the
+ * bounded queue of [Dmitry Vyukov][Vyukov].
+ *
+ * [Vyukov]: https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue
+ *
+ * Any thread can Push() items, concurrently; a single thread, the
+ * consumer, can Pop() them and check IsEmpty().  Neither call takes a
+ * lock nor allocates memory; IsEmpty() is a single atomic load.  When
+ * the ring is full, Push() fails, and the caller is responsible for
+ * storing the item elsewhere.
+ *
+ * \tparam T \explicit The type of the items, which must be default
+ *           constructible and copy assignable.
+ */
+template <typename T>
+class MpscQueue
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param [in] capacity The maximum number of items, rounded up to a
+     *             power of two.
+     */
+    explicit MpscQueue(std::size_t capacity);
+
+    /**
+     * Add an item at the tail of the queue, from any thread.
+     *
+     * \param [in] item The item.
+     * \return \c false if the queue is full.
+     */
+    bool Push(const T& item);
+
+    /**
+     * Remove the item at the head of the queue, from the consumer thread.
+     *
+     * \param [out] item The item removed.
+     * \return \c false if the queue is empty.
+     */
+    bool Pop(T& item);
+
+    /**
+     * Check if the queue is empty, from the consumer thread.
+     *
+     * An item being pushed concurrently may not be seen yet.
+     *
+     * \return \c true if there is no item to Pop().
+     */
+    bool IsEmpty() const;
+
+    /**
+     * Get the maximum number of items.
+     *
+     * \return The capacity of the queue.
+     */
+    std::size_t GetCapacity() const;
+
+  private:
+    /** A cell of the ring. */
+    struct Cell
+    {
+        /**
+         * The position of the producer which can use the cell, or
+         * this position plus one once the item is stored.
+         */
+        std::atomic<std::size_t> sequence;
+        T item; //!< The item.
+    };
+
+    /** Size of a cache line, to avoid false sharing. */
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    std::unique_ptr<Cell[]> m_cells; //!< The ring.
+    std::size_t m_mask;              //!< The capacity minus one.
+    /** The position of the next Push(). */
+    alignas(CACHE_LINE) std::atomic<std::size_t> m_tail;
+    /** The position of the next Pop(), only used by the consumer. */
+    alignas(CACHE_LINE) std::size_t m_head;
+};
+
+} // namespace ns3
+
+/********************************************************************
+ *  Implementation of the templates declared above.
+ ********************************************************************/
+
+namespace ns3
+{
+
+template <typename T>
+MpscQueue<T>::MpscQueue(std::size_t capacity)
+    : m_tail(0),
+      m_head(0)
+{
+    std::size_t size = 2;
+    while (size < capacity)
+    {
+        size *= 2;
+    }
+    m_cells = std::make_unique<Cell[]>(size);
+    m_mask = size - 1;
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+template <typename T>
+bool
+MpscQueue<T>::Push(const T& item)
+{
+    std::size_t pos = m_tail.load(std::memory_order_relaxed);
+    Cell* cell;
+    while (true)
+    {
+        cell = &m_cells[pos & m_mask];
+        std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        if (sequence == pos)
+        {
+            // the cell is free, try to claim it
+            if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                break;
+            }
+        }
+        else if (sequence < pos)
+        {
+            // the cell still holds the item of the previous lap
+            return false;
+        }
+        else
+        {
+            // another producer claimed the cell
+            pos = m_tail.load(std::memory_order_relaxed);
+        }
+    }
+    cell->item = item;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::Pop(T& item)
+{
+    Cell* cell = &m_cells[m_head & m_mask];
+    if (cell->sequence.load(std::memory_order_acquire) != m_head + 1)
+    {
+        return false;
+    }
+    item = cell->item;
+    // free the cell for the producer of the next lap
+    cell->sequence.store(m_head + m_mask + 1, std::memory_order_release);
+    m_head++;
+    return true;
+}
+
+template <typename T>
+bool
+MpscQueue<T>::IsEmpty() const
+{
+    return m_cells[m_head & m_mask].sequence.load(std::memory_order_acquire) != m_head + 1;
+}
+
+template <typename T>
+std::size_t
+MpscQueue<T>::GetCapacity() const
+{
+    return m_mask + 1;
+}
+
+} // namespace ns3
+
+#endif /* MPSC_QUEUE_H */
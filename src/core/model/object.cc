@@ -96,11 +96,9 @@ Object::Object()
     : m_tid(Object::GetTypeId()),
       m_disposed(false),
       m_initialized(false),
-      m_aggregates((struct Aggregates*)std::malloc(sizeof(struct Aggregates))),
-      m_getObjectCount(0)
+      m_aggregates(AllocateAggregates(1))
 {
     NS_LOG_FUNCTION(this);
-    m_aggregates->n = 1;
     m_aggregates->buffer[0] = this;
 }
 
@@ -120,6 +118,15 @@ Object::~Object()
             m_aggregates->n--;
         }
     }
+    // forget the lookups which found this object
+    for (uint32_t i = 0; i < CACHE_SIZE; i++)
+    {
+        if (m_aggregates->cacheObject[i] == this)
+        {
+            m_aggregates->cacheUid[i] = 0;
+            m_aggregates->cacheObject[i] = nullptr;
+        }
+    }
     // finally, if all objects have been removed from the list,
     // delete the aggregate list
     if (m_aggregates->n == 0)
@@ -133,10 +140,8 @@ Object::Object(const Object& o)
     : m_tid(o.m_tid),
       m_disposed(false),
       m_initialized(false),
-      m_aggregates((struct Aggregates*)std::malloc(sizeof(struct Aggregates))),
-      m_getObjectCount(0)
+      m_aggregates(AllocateAggregates(1))
 {
-    m_aggregates->n = 1;
     m_aggregates->buffer[0] = this;
 }
 
@@ -147,7 +152,20 @@ Object::Construct(const AttributeConstructionList& attributes)
     ConstructSelf(attributes);
 }
 
-Ptr<Object>
+struct Object::Aggregates*
+Object::AllocateAggregates(uint32_t n)
+{
+    NS_LOG_FUNCTION(n);
+    NS_ASSERT(n > 0);
+    auto aggregates =
+        (struct Aggregates*)std::malloc(sizeof(struct Aggregates) + (n - 1) * sizeof(Object*));
+    aggregates->n = n;
+    std::memset(aggregates->cacheUid, 0, sizeof(aggregates->cacheUid));
+    std::memset(aggregates->cacheObject, 0, sizeof(aggregates->cacheObject));
+    return aggregates;
+}
+
+Object*
 Object::DoGetObject(TypeId tid) const
 {
     NS_LOG_FUNCTION(this << tid);
@@ -155,6 +173,7 @@ Object::DoGetObject(TypeId tid) const
 
     uint32_t n = m_aggregates->n;
     TypeId objectTid = Object::GetTypeId();
+    Object* found = nullptr;
     for (uint32_t i = 0; i < n; i++)
     {
         Object* current = m_aggregates->buffer[i];
@@ -165,21 +184,39 @@ Object::DoGetObject(TypeId tid) const
         }
         if (cur == tid)
         {
-            // This is an attempt to 'cache' the result of this lookup.
-            // the idea is that if we perform a lookup for a TypeId on this object,
-            // we are likely to perform the same lookup later so, we make sure
-            // that the aggregate array is sorted by the number of accesses
-            // to each object.
-
-            // first, increment the access count
-            current->m_getObjectCount++;
-            // then, update the sort
-            UpdateSortedArray(m_aggregates, i);
-            // finally, return the match
-            return const_cast<Object*>(current);
+            found = current;
+            break;
         }
     }
-    return nullptr;
+    // We are likely to perform the same lookup later, so remember its result:
+    // the list of aggregates is replaced whenever an Object is aggregated to it.
+    // The lookups which find nothing are only cached by GetObject(), which
+    // then also tries to cast the Object.
+#ifndef NS3_MTP
+    if (found != nullptr)
+    {
+        uint32_t slot = tid.GetUid() & (CACHE_SIZE - 1);
+        m_aggregates->cacheUid[slot] = tid.GetUid();
+        m_aggregates->cacheObject[slot] = found;
+    }
+#endif
+    return found;
+}
+
+void
+Object::CacheMissingObject(TypeId tid) const
+{
+    NS_LOG_FUNCTION(this << tid);
+    // The cast made by GetObject() may fail in a constructor and succeed once
+    // the Object is constructed, which is when its TypeId is set.
+#ifndef NS3_MTP
+    if (m_tid != Object::GetTypeId())
+    {
+        uint32_t slot = tid.GetUid() & (CACHE_SIZE - 1);
+        m_aggregates->cacheUid[slot] = tid.GetUid();
+        m_aggregates->cacheObject[slot] = nullptr;
+    }
+#endif
 }
 
 void
@@ -188,9 +225,8 @@ Object::Initialize()
     /**
      * Note: the code here is a bit tricky because we need to protect ourselves from
      * modifications in the aggregate array while DoInitialize is called. The user's
-     * implementation of the DoInitialize method could call GetObject (which could
-     * reorder the array) and it could call AggregateObject which would add an
-     * object at the end of the array. To be safe, we restart iteration over the
+     * implementation of the DoInitialize method could call AggregateObject which
+     * would add an object at the end of the array. To be safe, we restart iteration over the
      * array whenever we call some user code, just in case.
      */
     NS_LOG_FUNCTION(this);
@@ -221,9 +257,8 @@ Object::Dispose()
     /**
      * Note: the code here is a bit tricky because we need to protect ourselves from
      * modifications in the aggregate array while DoDispose is called. The user's
-     * DoDispose implementation could call GetObject (which could reorder the array)
-     * and it could call AggregateObject which would add an object at the end of the array.
-     * So, to be safe, we restart the iteration over the array whenever we call some
+     * DoDispose implementation could call AggregateObject which would add an object
+     * at the end of the array. So, to be safe, we restart the iteration over the array whenever we call some
      * user code.
      */
     NS_LOG_FUNCTION(this);
@@ -241,20 +276,6 @@ restart:
     }
 }
 
-void
-Object::UpdateSortedArray(struct Aggregates* aggregates, uint32_t j) const
-{
-    NS_LOG_FUNCTION(this << aggregates << j);
-    while (j > 0 &&
-           aggregates->buffer[j]->m_getObjectCount > aggregates->buffer[j - 1]->m_getObjectCount)
-    {
-        Object* tmp = aggregates->buffer[j - 1];
-        aggregates->buffer[j - 1] = aggregates->buffer[j];
-        aggregates->buffer[j] = tmp;
-        j--;
-    }
-}
-
 void
 Object::AggregateObject(Ptr<Object> o)
 {
@@ -267,9 +288,7 @@ Object::AggregateObject(Ptr<Object> o)
     Object* other = PeekPointer(o);
     // first create the new aggregate buffer.
     uint32_t total = m_aggregates->n + other->m_aggregates->n;
-    struct Aggregates* aggregates =
-        (struct Aggregates*)std::malloc(sizeof(struct Aggregates) + (total - 1) * sizeof(Object*));
-    aggregates->n = total;
+    struct Aggregates* aggregates = AllocateAggregates(total);
 
     // copy our buffer to the new buffer
     std::memcpy(&aggregates->buffer[0],
@@ -287,7 +306,6 @@ Object::AggregateObject(Ptr<Object> o)
                            "Multiple aggregation of objects of type "
                            << other->GetInstanceTypeId() << " on objects of type " << typeId);
         }
-        UpdateSortedArray(aggregates, m_aggregates->n + i);
     }
 
     // keep track of the old aggregate buffers for the iteration
@@ -347,6 +365,9 @@ Object::SetTypeId(TypeId tid)
     NS_LOG_FUNCTION(this << tid);
     NS_ASSERT(Check());
     m_tid = tid;
+    // the lookups made so far did not know the type of this object
+    std::memset(m_aggregates->cacheUid, 0, sizeof(m_aggregates->cacheUid));
+    std::memset(m_aggregates->cacheObject, 0, sizeof(m_aggregates->cacheObject));
 }
 
 void
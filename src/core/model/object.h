@@ -84,6 +84,11 @@ struct ObjectDeleter
  * all its aggregates. The DoDispose() method is always automatically
  * invoked from the Unref() method before destroying the Object,
  * even if the user did not call Dispose() directly.
+ *
+ * The Objects aggregated together share a small cache of the results of
+ * GetObject(), indexed by the uid of the TypeId looked up, so that the
+ * Objects which are fetched for each packet are found in constant time
+ * rather than by walking the TypeId hierarchy of each aggregated Object.
  */
 class Object : public SimpleRefCount<Object, ObjectBase, ObjectDeleter>
 {
@@ -331,6 +336,17 @@ class Object : public SimpleRefCount<Object, ObjectBase, ObjectDeleter>
 
     /**@}*/
 
+    /**
+     * The number of lookups cached by a list of aggregates, a power of two.
+     *
+     * The cache is written by the lookups without synchronization, hence it
+     * is not used with multithreaded simulation, where the logical processes
+     * may look up the aggregates of a shared Object (e.g., a channel)
+     * concurrently, and could read the uid written by one lookup along with
+     * the Object written by another.
+     */
+    static constexpr uint32_t CACHE_SIZE = 8;
+
     /**
      * The list of Objects aggregated to this one.
      *
@@ -347,17 +363,44 @@ class Object : public SimpleRefCount<Object, ObjectBase, ObjectDeleter>
     {
         /** The number of entries in \c buffer. */
         uint32_t n;
+        /** The TypeId uids of the cached lookups, or 0 for an empty slot. */
+        uint16_t cacheUid[CACHE_SIZE];
+        /** The Objects found by the cached lookups, or nullptr if none was found. */
+        Object* cacheObject[CACHE_SIZE];
         /** The array of Objects. */
         Object* buffer[1];
     };
 
     /**
-     * Find an Object of TypeId tid in the aggregates of this Object.
+     * Allocate a list of aggregates, with an empty cache.
+     *
+     * \param [in] n The number of Objects in the list.
+     * \return The list, to be filled by the caller and released with std::free.
+     */
+    static struct Aggregates* AllocateAggregates(uint32_t n);
+    /**
+     * Find an Object of TypeId tid in the aggregates of this Object,
+     * looking first in the cache of the aggregates.
      *
      * \param [in] tid The TypeId we're looking for
-     * \return The matching Object, if it is found
+     * \return The matching Object, or nullptr if it is not found
      */
-    Ptr<Object> DoGetObject(TypeId tid) const;
+    inline Object* FindObject(TypeId tid) const;
+    /**
+     * Find an Object of TypeId tid in the aggregates of this Object,
+     * and cache it if it is found.
+     *
+     * \param [in] tid The TypeId we're looking for
+     * \return The matching Object, or nullptr if it is not found
+     */
+    Object* DoGetObject(TypeId tid) const;
+    /**
+     * Remember that GetObject() found no Object of TypeId tid in the
+     * aggregates of this Object, unless this Object is being constructed.
+     *
+     * \param [in] tid The TypeId looked up
+     */
+    void CacheMissingObject(TypeId tid) const;
     /**
      * Verify that this Object is still live, by checking it's reference count.
      * \return \c true if the reference count is non zero.
@@ -398,13 +441,6 @@ class Object : public SimpleRefCount<Object, ObjectBase, ObjectDeleter>
      */
     void Construct(const AttributeConstructionList& attributes);
 
-    /**
-     * Keep the list of aggregates in most-recently-used order
-     *
-     * \param [in,out] aggregates The list of aggregated Objects.
-     * \param [in] i The most recently used entry in the list.
-     */
-    void UpdateSortedArray(struct Aggregates* aggregates, uint32_t i) const;
     /**
      * Attempt to delete this Object.
      *
@@ -436,14 +472,6 @@ class Object : public SimpleRefCount<Object, ObjectBase, ObjectDeleter>
      * so the size of the array is indirectly a reference count.
      */
     struct Aggregates* m_aggregates;
-    /**
-     * The number of times the Object was accessed with a
-     * call to GetObject().
-     *
-     * This integer is used to implement a heuristic to sort
-     * the array of aggregates in most-frequently accessed order.
-     */
-    uint32_t m_getObjectCount;
 };
 
 template <typename T>
@@ -466,24 +494,46 @@ ObjectDeleter::Delete(Object* object)
     object->DoDelete();
 }
 
+Object*
+Object::FindObject(TypeId tid) const
+{
+#ifndef NS3_MTP
+    uint16_t uid = tid.GetUid();
+    uint32_t slot = uid & (CACHE_SIZE - 1);
+    if (m_aggregates->cacheUid[slot] == uid)
+    {
+        return m_aggregates->cacheObject[slot];
+    }
+#endif
+    return DoGetObject(tid);
+}
+
 template <typename T>
 Ptr<T>
 Object::GetObject() const
 {
-    // This is an optimization: if the cast works (which is likely),
-    // things will be pretty fast.
-    T* result = dynamic_cast<T*>(m_aggregates->buffer[0]);
-    if (result != nullptr)
+    TypeId tid = T::GetTypeId();
+#ifndef NS3_MTP
+    uint32_t slot = tid.GetUid() & (CACHE_SIZE - 1);
+    if (m_aggregates->cacheUid[slot] == tid.GetUid())
     {
-        return Ptr<T>(result);
+        return Ptr<T>(static_cast<T*>(m_aggregates->cacheObject[slot]));
     }
-    // if the cast does not work, we try to do a full type check.
-    Ptr<Object> found = DoGetObject(T::GetTypeId());
-    if (found)
+#endif
+    Object* found = DoGetObject(tid);
+    if (found != nullptr)
     {
-        return Ptr<T>(static_cast<T*>(PeekPointer(found)));
+        return Ptr<T>(static_cast<T*>(found));
     }
-    return nullptr;
+    // Fall back on a cast, for the classes which do not declare all their
+    // base classes as parents of their TypeId, and for the lookups made
+    // from a constructor, before the TypeId of the Object is set.
+    T* result = dynamic_cast<T*>(m_aggregates->buffer[0]);
+    if (result == nullptr)
+    {
+        CacheMissingObject(tid);
+    }
+    return Ptr<T>(result);
 }
 
 /**
@@ -503,10 +553,10 @@ template <typename T>
 Ptr<T>
 Object::GetObject(TypeId tid) const
 {
-    Ptr<Object> found = DoGetObject(tid);
-    if (found)
+    Object* found = FindObject(tid);
+    if (found != nullptr)
     {
-        return Ptr<T>(static_cast<T*>(PeekPointer(found)));
+        return Ptr<T>(static_cast<T*>(found));
     }
     return nullptr;
 }
@@ -528,7 +578,7 @@ Object::GetObject(TypeId tid) const
     }
     else
     {
-        return DoGetObject(tid);
+        return FindObject(tid);
     }
 }
 
@@ -24,6 +24,7 @@
  */
 #include "random-variable-stream.h"
 
+#include "abort.h"
 #include "assert.h"
 #include "boolean.h"
 #include "double.h"
@@ -116,6 +117,7 @@ RandomVariableStream::SetStream(int64_t stream)
         uint64_t nextStream = RngSeedManager::GetNextStreamIndex();
         NS_ASSERT(nextStream <= ((1ULL) << 63));
         m_rng = new RngStream(RngSeedManager::GetSeed(), nextStream, RngSeedManager::GetRun());
+        m_rngStream = nextStream;
     }
     else
     {
@@ -124,10 +126,30 @@ RandomVariableStream::SetStream(int64_t stream)
         uint64_t base = ((1ULL) << 63);
         uint64_t target = base + stream;
         m_rng = new RngStream(RngSeedManager::GetSeed(), target, RngSeedManager::GetRun());
+        m_rngStream = target;
     }
     m_stream = stream;
 }
 
+void
+RandomVariableStream::SetSubstream(Ptr<const RandomVariableStream> rv, uint64_t substream)
+{
+    NS_LOG_FUNCTION(this << rv << substream);
+    // The plain variables of a stream use the substream of their run number,
+    // so the last 2^50 substreams of the stream are reserved here, and the
+    // substreams of a run follow the 2^32 substreams of each previous run.
+    uint64_t run = RngSeedManager::GetRun();
+    NS_ABORT_MSG_IF(substream >= (1ULL << 32), "Substream " << substream << " out of range");
+    NS_ABORT_MSG_IF(run >= (1ULL << 18), "Run " << run << " too large to use substreams");
+    uint64_t base = (1ULL << 50);
+    delete m_rng;
+    m_rng = new RngStream(RngSeedManager::GetSeed(),
+                          rv->m_rngStream,
+                          base + (run << 32) + substream);
+    m_rngStream = rv->m_rngStream;
+    m_stream = rv->m_stream;
+}
+
 int64_t
 RandomVariableStream::GetStream() const
 {
@@ -130,6 +130,25 @@ class RandomVariableStream : public Object
      */
     int64_t GetStream() const;
 
+    /**
+     * \brief Draw from a substream of the stream of another random variable.
+     *
+     * The RngStream of a stream number is split into 2^51 independent
+     * substreams of 2^76 values, and the run number selects the substream
+     * which is drawn from. This lets a model give each of its parts, such
+     * as the links of a channel, a sequence of values of its own from the
+     * stream of one of its random variables, so that the values drawn by a
+     * part do not depend on the order in which the parts draw them. The
+     * substreams of a run differ from those of the other runs, and from
+     * the values drawn by the plain random variables of any run lower
+     * than 2^50, which use the first substreams of their stream. The run
+     * number must be lower than 2^18.
+     *
+     * \param [in] rv The random variable whose stream to draw from.
+     * \param [in] substream The index of the substream, lower than 2^32.
+     */
+    void SetSubstream(Ptr<const RandomVariableStream> rv, uint64_t substream);
+
     /**
      * \brief Specify whether antithetic values should be generated.
      * \param [in] isAntithetic If \c true antithetic value will be generated.
@@ -171,6 +190,9 @@ class RandomVariableStream : public Object
     /** The stream number for the RngStream. */
     int64_t m_stream;
 
+    /** The index of the RngStream, among both the automatic and the fixed streams. */
+    uint64_t m_rngStream;
+
 }; // class RandomVariableStream
 
 /**
@@ -22,18 +22,26 @@
 #include "enum.h"
 #include "event-impl.h"
 #include "fatal-error.h"
+#include "integer.h"
 #include "log.h"
 #include "pointer.h"
 #include "ptr.h"
 #include "scheduler.h"
 #include "simulator.h"
 #include "synchronizer.h"
+#include "trace-source-accessor.h"
 #include "wall-clock-synchronizer.h"
 
+#include <algorithm>
 #include <cmath>
 #include <mutex>
 #include <thread>
 
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
 /**
  * \file
  * \ingroup realtime
@@ -50,6 +58,50 @@ NS_LOG_COMPONENT_DEFINE("RealtimeSimulatorImpl");
 
 NS_OBJECT_ENSURE_REGISTERED(RealtimeSimulatorImpl);
 
+namespace
+{
+
+/**
+ * \ingroup realtime
+ * Capacity of the lock-free queue of events scheduled from other threads.
+ */
+constexpr std::size_t INGESTED_EVENTS_CAPACITY = 4096;
+
+} // unnamed namespace
+
+RealtimeSimulatorImpl::LatenessHistogram::LatenessHistogram()
+    : start(0),
+      count(0),
+      total(0),
+      max(0),
+      buckets(N_BUCKETS, 0)
+{
+}
+
+void
+RealtimeSimulatorImpl::LatenessHistogram::Add(uint64_t lateness)
+{
+    count++;
+    total += TimeStep(lateness);
+    max = std::max(max, TimeStep(lateness));
+    std::size_t bucket = 0;
+    for (uint64_t us = lateness / 1000; us > 0 && bucket < N_BUCKETS - 1; us /= 2)
+    {
+        bucket++;
+    }
+    buckets[bucket]++;
+}
+
+Time
+RealtimeSimulatorImpl::LatenessHistogram::GetBucketLimit(std::size_t bucket)
+{
+    if (bucket >= N_BUCKETS - 1)
+    {
+        return Time::Max();
+    }
+    return MicroSeconds(uint64_t(1) << bucket);
+}
+
 TypeId
 RealtimeSimulatorImpl::GetTypeId()
 {
@@ -69,11 +121,36 @@ RealtimeSimulatorImpl::GetTypeId()
                           "SynchronizationMode=HardLimit)",
                           TimeValue(Seconds(0.1)),
                           MakeTimeAccessor(&RealtimeSimulatorImpl::m_hardLimit),
-                          MakeTimeChecker());
+                          MakeTimeChecker())
+            .AddAttribute("BusyPollWindow",
+                          "Real time to busy-wait before each event instead of sleeping, "
+                          "trading CPU time for a lower lateness of the events",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&RealtimeSimulatorImpl::SetBusyPollWindow),
+                          MakeTimeChecker(Seconds(0)))
+            .AddAttribute("CpuAffinity",
+                          "Index of the processor to pin the thread running the simulation "
+                          "to, or -1 to let the operating system schedule it (only "
+                          "supported on Linux)",
+                          IntegerValue(-1),
+                          MakeIntegerAccessor(&RealtimeSimulatorImpl::m_cpuAffinity),
+                          MakeIntegerChecker<int32_t>(-1))
+            .AddTraceSource("Lateness",
+                            "The real time elapsed between the time an event was due "
+                            "and its execution",
+                            MakeTraceSourceAccessor(&RealtimeSimulatorImpl::m_latenessTrace),
+                            "ns3::RealtimeSimulatorImpl::LatenessTracedCallback")
+            .AddTraceSource("LatenessHistogram",
+                            "The histogram of the lateness of the events of each second "
+                            "of simulation time",
+                            MakeTraceSourceAccessor(
+                                &RealtimeSimulatorImpl::m_latenessHistogramTrace),
+                            "ns3::RealtimeSimulatorImpl::LatenessHistogramTracedCallback");
     return tid;
 }
 
 RealtimeSimulatorImpl::RealtimeSimulatorImpl()
+    : m_ingestedEvents(INGESTED_EVENTS_CAPACITY)
 {
     NS_LOG_FUNCTION(this);
 
@@ -102,6 +179,10 @@ void
 RealtimeSimulatorImpl::DoDispose()
 {
     NS_LOG_FUNCTION(this);
+    {
+        std::unique_lock lock{m_mutex};
+        ProcessIngestedEvents();
+    }
     while (!m_events->IsEmpty())
     {
         Scheduler::Event next = m_events->RemoveNext();
@@ -204,6 +285,13 @@ RealtimeSimulatorImpl::ProcessOneEvent()
         {
             std::unique_lock lock{m_mutex};
             //
+            // Reset the synchronizer before looking for the events scheduled
+            // by other threads, so that an event pushed after this point
+            // interrupts the wait below (see the comment further on).
+            //
+            m_synchronizer->SetCondition(false);
+            ProcessIngestedEvents();
+            //
             // Since we are in realtime mode, the time to delay has got to be the
             // difference between the current realtime and the timestamp of the next
             // event.  Since m_currentTs is actually the timestamp of the last event we
@@ -245,14 +333,6 @@ RealtimeSimulatorImpl::ProcessOneEvent()
                 tsDelay = tsNext - tsNow;
             }
 
-            //
-            // We've figured out how long we need to delay in order to pace the
-            // simulation time with the real time.  We're going to sleep, but need
-            // to work with the synchronizer to make sure we're awakened if something
-            // external happens (like a packet is received).  This next line resets
-            // the synchronizer so that any future event will cause it to interrupt.
-            //
-            m_synchronizer->SetCondition(false);
         }
 
         //
@@ -322,6 +402,7 @@ RealtimeSimulatorImpl::ProcessOneEvent()
         // event we're working on won't be on the list and so subsequent operations won't
         // mess with us.
         //
+        ProcessIngestedEvents();
         NS_ASSERT_MSG(m_events->IsEmpty() == false,
                       "RealtimeSimulatorImpl::ProcessOneEvent(): event queue is empty");
         next = m_events->RemoveNext();
@@ -359,9 +440,11 @@ RealtimeSimulatorImpl::ProcessOneEvent()
         // We check the simulation time against the current real time to make this
         // judgement.
         //
+        uint64_t tsFinal = m_synchronizer->GetCurrentRealtime();
+        RecordLateness(tsFinal);
+
         if (m_synchronizationMode == SYNC_HARD_LIMIT)
         {
-            uint64_t tsFinal = m_synchronizer->GetCurrentRealtime();
             uint64_t tsJitter;
 
             if (tsFinal >= m_currentTs)
@@ -394,6 +477,108 @@ RealtimeSimulatorImpl::ProcessOneEvent()
     event->Unref();
 }
 
+void
+RealtimeSimulatorImpl::RecordLateness(uint64_t tsRealtime)
+{
+    //
+    // Events are never early by more than the wall clock resolution, so only
+    // the lateness is of interest.
+    //
+    uint64_t lateness = tsRealtime > m_currentTs ? tsRealtime - m_currentTs : 0;
+    m_latenessTrace(TimeStep(lateness));
+    m_latenessHistogram.Add(lateness);
+
+    Time second = Seconds(std::floor(TimeStep(m_currentTs).GetSeconds()));
+    if (second != m_latenessHistogramPerSecond.start)
+    {
+        if (m_latenessHistogramPerSecond.count > 0)
+        {
+            m_latenessHistogramTrace(m_latenessHistogramPerSecond);
+        }
+        m_latenessHistogramPerSecond = LatenessHistogram();
+        m_latenessHistogramPerSecond.start = second;
+    }
+    m_latenessHistogramPerSecond.Add(lateness);
+}
+
+Scheduler::Event
+RealtimeSimulatorImpl::InsertEvent(uint32_t context, uint64_t ts, EventImpl* impl)
+{
+    Scheduler::Event ev;
+    ev.impl = impl;
+    ev.key.m_ts = ts;
+    ev.key.m_context = context;
+    ev.key.m_uid = m_uid;
+    m_uid++;
+    m_unscheduledEvents++;
+    m_events->Insert(ev);
+    return ev;
+}
+
+void
+RealtimeSimulatorImpl::IngestEvent(uint32_t context, uint64_t ts, EventImpl* impl)
+{
+    if (!m_ingestedEvents.Push({context, ts, impl}))
+    {
+        std::unique_lock lock{m_mutex};
+        // the main thread may have moved past ts meanwhile
+        InsertEvent(context, std::max(ts, m_currentTs), impl);
+    }
+    m_synchronizer->Signal();
+}
+
+void
+RealtimeSimulatorImpl::ProcessIngestedEvents()
+{
+    IngestedEvent event;
+    while (m_ingestedEvents.Pop(event))
+    {
+        //
+        // The timestamp was computed from the real time when the event was
+        // pushed, but an event due later may have been executed since then;
+        // time must not move backward.
+        //
+        InsertEvent(event.context, std::max(event.ts, m_currentTs), event.impl);
+    }
+}
+
+void
+RealtimeSimulatorImpl::SetBusyPollWindow(Time window)
+{
+    NS_LOG_FUNCTION(this << window);
+    m_busyPollWindow = window;
+    Ptr<WallClockSynchronizer> synchronizer = DynamicCast<WallClockSynchronizer>(m_synchronizer);
+    NS_ASSERT_MSG(synchronizer, "RealtimeSimulatorImpl::SetBusyPollWindow(): no wall clock");
+    synchronizer->SetBusyPollWindow(window.GetTimeStep());
+}
+
+void
+RealtimeSimulatorImpl::SetThreadAffinity() const
+{
+    NS_LOG_FUNCTION(this << m_cpuAffinity);
+    if (m_cpuAffinity < 0)
+    {
+        return;
+    }
+#ifdef __linux__
+    cpu_set_t cpuSet;
+    CPU_ZERO(&cpuSet);
+    CPU_SET(m_cpuAffinity, &cpuSet);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(cpuSet), &cpuSet) != 0)
+    {
+        NS_LOG_WARN("Cannot pin the simulation thread to processor " << m_cpuAffinity);
+    }
+#else
+    NS_LOG_WARN("Pinning the simulation thread to a processor is not supported");
+#endif
+}
+
+RealtimeSimulatorImpl::LatenessHistogram
+RealtimeSimulatorImpl::GetLatenessHistogram() const
+{
+    return m_latenessHistogram;
+}
+
 bool
 RealtimeSimulatorImpl::IsFinished() const
 {
@@ -430,6 +615,7 @@ RealtimeSimulatorImpl::Run()
 
     m_stop = false;
     m_running = true;
+    SetThreadAffinity();
     m_synchronizer->SetOrigin(m_currentTs);
 
     // Sleep until signalled
@@ -441,6 +627,7 @@ RealtimeSimulatorImpl::Run()
         bool process = false;
         {
             std::unique_lock lock{m_mutex};
+            ProcessIngestedEvents();
 
             if (!m_events->IsEmpty())
             {
@@ -476,6 +663,13 @@ RealtimeSimulatorImpl::Run()
                       "RealtimeSimulatorImpl::Run(): Empty queue and unprocessed events");
     }
 
+    // report the histogram of the last second
+    if (m_latenessHistogramPerSecond.count > 0)
+    {
+        m_latenessHistogramTrace(m_latenessHistogramPerSecond);
+        m_latenessHistogramPerSecond = LatenessHistogram();
+    }
+
     m_running = false;
 }
 
@@ -524,13 +718,7 @@ RealtimeSimulatorImpl::Schedule(const Time& delay, EventImpl* impl)
         //
         Time tAbsolute = Simulator::Now() + delay;
         NS_ASSERT_MSG(delay.IsPositive(), "RealtimeSimulatorImpl::Schedule(): Negative delay");
-        ev.impl = impl;
-        ev.key.m_ts = (uint64_t)tAbsolute.GetTimeStep();
-        ev.key.m_context = GetContext();
-        ev.key.m_uid = m_uid;
-        m_uid++;
-        m_unscheduledEvents++;
-        m_events->Insert(ev);
+        ev = InsertEvent(GetContext(), (uint64_t)tAbsolute.GetTimeStep(), impl);
         m_synchronizer->Signal();
     }
 
@@ -542,35 +730,30 @@ RealtimeSimulatorImpl::ScheduleWithContext(uint32_t context, const Time& delay,
 {
     NS_LOG_FUNCTION(this << context << delay << impl);
 
+    if (m_main == std::this_thread::get_id())
     {
         std::unique_lock lock{m_mutex};
+        InsertEvent(context, m_currentTs + delay.GetTimeStep(), impl);
+        m_synchronizer->Signal();
+    }
+    else
+    {
+        //
+        // If the simulator is running, we're pacing and have a meaningful
+        // realtime clock.  If we're not, then m_currentTs is where we stopped,
+        // which is read under the lock since the main thread may advance it.
+        //
         uint64_t ts;
-
-        if (m_main == std::this_thread::get_id())
+        if (m_running)
         {
-            ts = m_currentTs + delay.GetTimeStep();
+            ts = m_synchronizer->GetCurrentRealtime();
         }
         else
         {
-            //
-            // If the simulator is running, we're pacing and have a meaningful
-            // realtime clock.  If we're not, then m_currentTs is where we stopped.
-            //
-            ts = m_running ? m_synchronizer->GetCurrentRealtime() : m_currentTs;
-            ts += delay.GetTimeStep();
+            std::unique_lock lock{m_mutex};
+            ts = m_currentTs;
         }
-
-        NS_ASSERT_MSG(ts >= m_currentTs,
-                      "RealtimeSimulatorImpl::ScheduleRealtime(): schedule for time < m_currentTs");
-        Scheduler::Event ev;
-        ev.impl = impl;
-        ev.key.m_ts = ts;
-        ev.key.m_context = context;
-        ev.key.m_uid = m_uid;
-        m_uid++;
-        m_unscheduledEvents++;
-        m_events->Insert(ev);
-        m_synchronizer->Signal();
+        IngestEvent(context, ts + delay.GetTimeStep(), impl);
     }
 }
 
@@ -597,21 +780,19 @@ RealtimeSimulatorImpl::ScheduleRealtimeWithContext(uint32_t context,
 {
     NS_LOG_FUNCTION(this << context << time << impl);
 
+    uint64_t ts = m_synchronizer->GetCurrentRealtime() + time.GetTimeStep();
+    if (m_main == std::this_thread::get_id())
     {
         std::unique_lock lock{m_mutex};
-
-        uint64_t ts = m_synchronizer->GetCurrentRealtime() + time.GetTimeStep();
         NS_ASSERT_MSG(ts >= m_currentTs,
                       "RealtimeSimulatorImpl::ScheduleRealtime(): schedule for time < m_currentTs");
-        Scheduler::Event ev;
-        ev.impl = impl;
-        ev.key.m_ts = ts;
-        ev.key.m_uid = m_uid;
-        m_uid++;
-        m_unscheduledEvents++;
-        m_events->Insert(ev);
+        InsertEvent(context, ts, impl);
         m_synchronizer->Signal();
     }
+    else
+    {
+        IngestEvent(context, ts, impl);
+    }
 }
 
 void
@@ -625,27 +806,37 @@ void
 RealtimeSimulatorImpl::ScheduleRealtimeNowWithContext(uint32_t context, EventImpl* impl)
 {
     NS_LOG_FUNCTION(this << context << impl);
-    {
-        std::unique_lock lock{m_mutex};
 
-        //
-        // If the simulator is running, we're pacing and have a meaningful
-        // realtime clock.  If we're not, then m_currentTs is were we stopped.
-        //
+    //
+    // If the simulator is running, we're pacing and have a meaningful
+    // realtime clock.  If we're not, then m_currentTs is were we stopped,
+    // which another thread reads under the lock since the main thread may
+    // advance it.
+    //
+    if (m_main == std::this_thread::get_id())
+    {
         uint64_t ts = m_running ? m_synchronizer->GetCurrentRealtime() : m_currentTs;
+        std::unique_lock lock{m_mutex};
         NS_ASSERT_MSG(ts >= m_currentTs,
                       "RealtimeSimulatorImpl::ScheduleRealtimeNowWithContext(): schedule for time "
                       "< m_currentTs");
-        Scheduler::Event ev;
-        ev.impl = impl;
-        ev.key.m_ts = ts;
-        ev.key.m_uid = m_uid;
-        ev.key.m_context = context;
-        m_uid++;
-        m_unscheduledEvents++;
-        m_events->Insert(ev);
+        InsertEvent(context, ts, impl);
         m_synchronizer->Signal();
     }
+    else
+    {
+        uint64_t ts;
+        if (m_running)
+        {
+            ts = m_synchronizer->GetCurrentRealtime();
+        }
+        else
+        {
+            std::unique_lock lock{m_mutex};
+            ts = m_currentTs;
+        }
+        IngestEvent(context, ts, impl);
+    }
 }
 
 void
@@ -804,6 +995,18 @@ RealtimeSimulatorImpl::GetContext() const
     return m_currentContext;
 }
 
+void
+RealtimeSimulatorImpl::SetContext(uint32_t context)
+{
+    m_currentContext = context;
+}
+
+bool
+RealtimeSimulatorImpl::IsLocalContext(uint32_t context) const
+{
+    return true;
+}
+
 uint64_t
 RealtimeSimulatorImpl::GetEventCount() const
 {
@@ -21,14 +21,19 @@
 #include "assert.h"
 #include "event-impl.h"
 #include "log.h"
+#include "mpsc-queue.h"
+#include "nstime.h"
 #include "ptr.h"
 #include "scheduler.h"
 #include "simulator-impl.h"
 #include "synchronizer.h"
+#include "traced-callback.h"
 
+#include <atomic>
 #include <list>
 #include <mutex>
 #include <thread>
+#include <vector>
 
 /**
  * \file
@@ -82,6 +87,54 @@ class RealtimeSimulatorImpl : public SimulatorImpl
         SYNC_HARD_LIMIT,
     };
 
+    /**
+     * Histogram of the lateness of the events, that is the real time
+     * elapsed between the simulation time of an event and its execution.
+     *
+     * Bucket 0 counts the events late by less than one microsecond, and
+     * bucket \f$i > 0\f$ those late by \f$[2^{i-1}, 2^i)\f$ microseconds;
+     * the last bucket also counts the later events.
+     */
+    struct LatenessHistogram
+    {
+        /** Number of buckets. */
+        static constexpr std::size_t N_BUCKETS = 24;
+
+        /** Constructor. */
+        LatenessHistogram();
+        /**
+         * Add the lateness of an event.
+         * \param [in] lateness The lateness, in nanoseconds.
+         */
+        void Add(uint64_t lateness);
+        /**
+         * Get the upper bound of a bucket.
+         * \param [in] bucket The bucket index.
+         * \return The lateness above which events are counted in the next bucket.
+         */
+        static Time GetBucketLimit(std::size_t bucket);
+
+        Time start;                    //!< Simulation time of the first event counted.
+        uint64_t count;                //!< Number of events.
+        Time total;                    //!< Total lateness.
+        Time max;                      //!< Maximum lateness.
+        std::vector<uint64_t> buckets; //!< Number of events per bucket.
+    };
+
+    /**
+     * TracedCallback signature for the lateness of each event.
+     *
+     * \param [in] lateness The real time elapsed since the event was due.
+     */
+    typedef void (*LatenessTracedCallback)(Time lateness);
+
+    /**
+     * TracedCallback signature for the histogram of the lateness.
+     *
+     * \param [in] histogram The lateness histogram.
+     */
+    typedef void (*LatenessHistogramTracedCallback)(const LatenessHistogram& histogram);
+
     /** Constructor. */
     RealtimeSimulatorImpl();
     /** Destructor. */
@@ -106,6 +159,8 @@ class RealtimeSimulatorImpl : public SimulatorImpl
     void SetScheduler(ObjectFactory schedulerFactory) override;
     uint32_t GetSystemId() const override;
     uint32_t GetContext() const override;
+    void SetContext(uint32_t context) override;
+    bool IsLocalContext(uint32_t context) const override;
     uint64_t GetEventCount() const override;
 
     /** \copydoc ScheduleWithContext(uint32_t,const Time&,EventImpl*) */
@@ -163,6 +218,13 @@ class RealtimeSimulatorImpl : public SimulatorImpl
      */
     Time GetHardLimit() const;
 
+    /**
+     * Get the histogram of the lateness of all the events executed.
+     *
+     * \returns The lateness histogram since the simulation started.
+     */
+    LatenessHistogram GetLatenessHistogram() const;
+
   private:
     /**
      * Is the simulator running?
@@ -181,6 +243,46 @@ class RealtimeSimulatorImpl : public SimulatorImpl
     uint64_t NextTs() const;
     /** Process the next event. */
     void ProcessOneEvent();
+    /**
+     * Record the lateness of the event about to be executed.
+     *
+     * \param [in] tsRealtime The current real time.
+     */
+    void RecordLateness(uint64_t tsRealtime);
+    /**
+     * Insert an event in the event list.  Should be called with the
+     * critical section locked.
+     *
+     * \param [in] context The event context.
+     * \param [in] ts The event timestamp.
+     * \param [in] impl The event implementation.
+     * \returns The event inserted.
+     */
+    Scheduler::Event InsertEvent(uint32_t context, uint64_t ts, EventImpl* impl);
+    /**
+     * Schedule an event from a thread other than the main one.
+     *
+     * The event is pushed in the lock-free ingest queue if possible, or
+     * inserted in the event list.
+     *
+     * \param [in] context The event context.
+     * \param [in] ts The event timestamp.
+     * \param [in] impl The event implementation.
+     */
+    void IngestEvent(uint32_t context, uint64_t ts, EventImpl* impl);
+    /**
+     * Move the events from the ingest queue to the event list.  Should be
+     * called by the main thread with the critical section locked.
+     */
+    void ProcessIngestedEvents();
+    /**
+     * Set the real time to busy-wait before an event, instead of sleeping.
+     *
+     * \param [in] window The busy-poll window.
+     */
+    void SetBusyPollWindow(Time window);
+    /** Pin the calling thread to the processor set with m_cpuAffinity. */
+    void SetThreadAffinity() const;
     /** Destructor implementation. */
     void DoDispose() override;
 
@@ -191,7 +293,24 @@ class RealtimeSimulatorImpl : public SimulatorImpl
     /** Has the stopping condition been reached? */
     bool m_stop;
     /** Is the simulator currently running. */
-    bool m_running;
+    std::atomic<bool> m_running;
+
+    /** An event scheduled from another thread. */
+    struct IngestedEvent
+    {
+        /** The event context. */
+        uint32_t context;
+        /** The event timestamp. */
+        uint64_t ts;
+        /** The event implementation. */
+        EventImpl* impl;
+    };
+
+    /**
+     * The events scheduled from other threads, pushed without locking and
+     * moved to the event list by the main thread.
+     */
+    MpscQueue<IngestedEvent> m_ingestedEvents;
 
     /**
      * \name Mutex-protected variables.
@@ -227,6 +346,22 @@ class RealtimeSimulatorImpl : public SimulatorImpl
     /** The maximum allowable drift from real-time in SYNC_HARD_LIMIT mode. */
     Time m_hardLimit;
 
+    /** Real time to busy-wait before an event. */
+    Time m_busyPollWindow;
+
+    /** Processor to pin the main thread to, or -1. */
+    int32_t m_cpuAffinity;
+
+    /** Lateness of all the events. */
+    LatenessHistogram m_latenessHistogram;
+    /** Lateness of the events of the current second. */
+    LatenessHistogram m_latenessHistogramPerSecond;
+
+    /** Trace of the lateness of each event. */
+    TracedCallback<Time> m_latenessTrace;
+    /** Trace of the histogram of the lateness, per second. */
+    TracedCallback<const LatenessHistogram&> m_latenessHistogramTrace;
+
     /** Main thread. */
     std::thread::id m_main;
 };
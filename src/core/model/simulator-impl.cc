@@ -18,6 +18,7 @@
 
 #include "simulator-impl.h"
 
+#include "assert.h"
 #include "log.h"
 
 /**
@@ -40,4 +41,18 @@ SimulatorImpl::GetTypeId()
     return tid;
 }
 
+void
+SimulatorImpl::SetContext(uint32_t context)
+{
+    NS_LOG_FUNCTION(this << context);
+    NS_ASSERT_MSG(IsLocalContext(context),
+                  "Context " << context << " is not local to context " << GetContext());
+}
+
+bool
+SimulatorImpl::IsLocalContext(uint32_t context) const
+{
+    return context == GetContext();
+}
+
 } // namespace ns3
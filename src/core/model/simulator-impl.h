@@ -98,6 +98,20 @@ class SimulatorImpl : public Object
     virtual uint32_t GetSystemId() const = 0;
     /** \copydoc Simulator::GetContext */
     virtual uint32_t GetContext() const = 0;
+    /**
+     * \copydoc Simulator::SetContext
+     *
+     * By default, only the current context is local, so that the context
+     * can only be set to itself.
+     */
+    virtual void SetContext(uint32_t context);
+    /**
+     * \copydoc Simulator::IsLocalContext
+     *
+     * By default, only the current context is local, so that the
+     * deliveries to the other contexts are scheduled as separate events.
+     */
+    virtual bool IsLocalContext(uint32_t context) const;
     /** \copydoc Simulator::GetEventCount */
     virtual uint64_t GetEventCount() const = 0;
 
@@ -311,6 +311,18 @@ Simulator::GetContext()
     return GetImpl()->GetContext();
 }
 
+void
+Simulator::SetContext(uint32_t context)
+{
+    GetImpl()->SetContext(context);
+}
+
+bool
+Simulator::IsLocalContext(uint32_t context)
+{
+    return GetImpl()->IsLocalContext(context);
+}
+
 uint64_t
 Simulator::GetEventCount()
 {
@@ -187,6 +187,35 @@ class Simulator
      */
     static uint32_t GetContext();
 
+    /**
+     * Set the context of the event being run.
+     *
+     * An event which delivers something to several nodes at the same
+     * time, such as a DeliveryBatch, sets the context of each node before
+     * delivering to it, as if each delivery was an event scheduled with
+     * ScheduleWithContext(). The nodes must be local to the context of
+     * the event, as told by IsLocalContext().
+     *
+     * \param [in] context The new context of the event being run.
+     */
+    static void SetContext(uint32_t context);
+
+    /**
+     * Check whether the events of a context run along with the events of
+     * the current context, such that an event may switch between the two
+     * with SetContext().
+     *
+     * This is always true with the default and realtime simulators, and
+     * true for the nodes of the same partition with the parallel ones,
+     * which run the events of the other nodes on other threads or
+     * processes. A SimulatorImpl which does not override it only considers
+     * the current context local.
+     *
+     * \param [in] context The context to check.
+     * \return \c true if the context is local to the current context.
+     */
+    static bool IsLocalContext(uint32_t context);
+
     /**
      * Context enum values.
      *
@@ -0,0 +1,224 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef VAL_ARRAY_H
+#define VAL_ARRAY_H
+
+#include "assert.h"
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core
+ * ns3::ValArray class template declaration and implementation.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup core
+ * \brief A 3D array of values stored contiguously, such as a stack of
+ * matrices.
+ *
+ * The element at row r, column c and page p is stored at index
+ * r + c * numRows + p * numRows * numCols: the elements of a column are
+ * contiguous, and so are the columns of a page. Iterating over the rows in
+ * the innermost loop, then over the columns and then over the pages, hence
+ * runs through the memory sequentially, rather than following a pointer per
+ * row and column as a vector of vectors of vectors does.
+ *
+ * \tparam T \explicit The type of the values.
+ */
+template <class T>
+class ValArray
+{
+  public:
+    /** Create an empty array. */
+    ValArray() = default;
+
+    /**
+     * Create an array of value-initialized elements.
+     *
+     * \param [in] numRows The number of rows.
+     * \param [in] numCols The number of columns.
+     * \param [in] numPages The number of pages.
+     */
+    ValArray(std::size_t numRows, std::size_t numCols = 1, std::size_t numPages = 1);
+
+    /** \return The number of rows. */
+    std::size_t GetNumRows() const;
+    /** \return The number of columns. */
+    std::size_t GetNumCols() const;
+    /** \return The number of pages. */
+    std::size_t GetNumPages() const;
+    /** \return The number of elements. */
+    std::size_t GetSize() const;
+
+    /**
+     * Access an element.
+     *
+     * \param [in] rowIndex The row of the element.
+     * \param [in] colIndex The column of the element.
+     * \param [in] pageIndex The page of the element.
+     * \return A reference to the element.
+     */
+    T& operator()(std::size_t rowIndex, std::size_t colIndex, std::size_t pageIndex);
+    /**
+     * Access an element.
+     *
+     * \param [in] rowIndex The row of the element.
+     * \param [in] colIndex The column of the element.
+     * \param [in] pageIndex The page of the element.
+     * \return A const reference to the element.
+     */
+    const T& operator()(std::size_t rowIndex, std::size_t colIndex, std::size_t pageIndex) const;
+
+    /**
+     * Get the elements of a page, the element at row r and column c being at
+     * index r + c * GetNumRows().
+     *
+     * \param [in] pageIndex The page.
+     * \return A pointer to the first element of the page.
+     */
+    T* GetPagePtr(std::size_t pageIndex);
+    /**
+     * Get the elements of a page, the element at row r and column c being at
+     * index r + c * GetNumRows().
+     *
+     * \param [in] pageIndex The page.
+     * \return A const pointer to the first element of the page.
+     */
+    const T* GetPagePtr(std::size_t pageIndex) const;
+
+    /**
+     * Compare two arrays.
+     *
+     * \param [in] rhs The other array.
+     * \return Whether the arrays have the same dimensions and elements.
+     */
+    bool operator==(const ValArray<T>& rhs) const;
+    /**
+     * Compare two arrays.
+     *
+     * \param [in] rhs The other array.
+     * \return Whether the arrays differ in dimensions or elements.
+     */
+    bool operator!=(const ValArray<T>& rhs) const;
+
+  private:
+    std::size_t m_numRows{0};  //!< The number of rows
+    std::size_t m_numCols{0};  //!< The number of columns
+    std::size_t m_numPages{0}; //!< The number of pages
+    std::vector<T> m_values;   //!< The elements, column by column and page by page
+};
+
+/*************************************************
+ **  Implementation
+ *************************************************/
+
+template <class T>
+ValArray<T>::ValArray(std::size_t numRows, std::size_t numCols, std::size_t numPages)
+    : m_numRows(numRows),
+      m_numCols(numCols),
+      m_numPages(numPages),
+      m_values(numRows * numCols * numPages)
+{
+}
+
+template <class T>
+inline std::size_t
+ValArray<T>::GetNumRows() const
+{
+    return m_numRows;
+}
+
+template <class T>
+inline std::size_t
+ValArray<T>::GetNumCols() const
+{
+    return m_numCols;
+}
+
+template <class T>
+inline std::size_t
+ValArray<T>::GetNumPages() const
+{
+    return m_numPages;
+}
+
+template <class T>
+inline std::size_t
+ValArray<T>::GetSize() const
+{
+    return m_values.size();
+}
+
+template <class T>
+inline T&
+ValArray<T>::operator()(std::size_t rowIndex, std::size_t colIndex, std::size_t pageIndex)
+{
+    NS_ASSERT_MSG(rowIndex < m_numRows, "Row index out of bounds");
+    NS_ASSERT_MSG(colIndex < m_numCols, "Column index out of bounds");
+    NS_ASSERT_MSG(pageIndex < m_numPages, "Page index out of bounds");
+    return m_values[rowIndex + m_numRows * (colIndex + m_numCols * pageIndex)];
+}
+
+template <class T>
+inline const T&
+ValArray<T>::operator()(std::size_t rowIndex, std::size_t colIndex, std::size_t pageIndex) const
+{
+    NS_ASSERT_MSG(rowIndex < m_numRows, "Row index out of bounds");
+    NS_ASSERT_MSG(colIndex < m_numCols, "Column index out of bounds");
+    NS_ASSERT_MSG(pageIndex < m_numPages, "Page index out of bounds");
+    return m_values[rowIndex + m_numRows * (colIndex + m_numCols * pageIndex)];
+}
+
+template <class T>
+inline T*
+ValArray<T>::GetPagePtr(std::size_t pageIndex)
+{
+    NS_ASSERT_MSG(pageIndex < m_numPages, "Page index out of bounds");
+    return m_values.data() + m_numRows * m_numCols * pageIndex;
+}
+
+template <class T>
+inline const T*
+ValArray<T>::GetPagePtr(std::size_t pageIndex) const
+{
+    NS_ASSERT_MSG(pageIndex < m_numPages, "Page index out of bounds");
+    return m_values.data() + m_numRows * m_numCols * pageIndex;
+}
+
+template <class T>
+bool
+ValArray<T>::operator==(const ValArray<T>& rhs) const
+{
+    return m_numRows == rhs.m_numRows && m_numCols == rhs.m_numCols &&
+           m_numPages == rhs.m_numPages && m_values == rhs.m_values;
+}
+
+template <class T>
+bool
+ValArray<T>::operator!=(const ValArray<T>& rhs) const
+{
+    return !(*this == rhs);
+}
+
+} // namespace ns3
+
+#endif /* VAL_ARRAY_H */
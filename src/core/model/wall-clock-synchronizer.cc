@@ -19,6 +19,7 @@
 
 #include "log.h"
 
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
 #include <ctime> // clock_t
@@ -46,6 +47,8 @@ WallClockSynchronizer::GetTypeId()
 }
 
 WallClockSynchronizer::WallClockSynchronizer()
+    : m_busyPollWindow(0),
+      m_condition(false)
 {
     NS_LOG_FUNCTION(this);
     //
@@ -85,6 +88,13 @@ WallClockSynchronizer::~WallClockSynchronizer()
     NS_LOG_FUNCTION(this);
 }
 
+void
+WallClockSynchronizer::SetBusyPollWindow(uint64_t ns)
+{
+    NS_LOG_FUNCTION(this << ns);
+    m_busyPollWindow = ns;
+}
+
 bool
 WallClockSynchronizer::DoRealtime()
 {
@@ -215,19 +225,22 @@ WallClockSynchronizer::DoSynchronize(uint64_t nsCurrent, uint64_t nsDelay)
     // I'm not really sure about this number -- a boss of mine once said, "pick
     // a number and it'll be wrong."  But this works for now.
     //
-    // \todo Hardcoded tunable parameter below.
+    // The busy-poll window, if set, widens the final busy-wait beyond these
+    // three jiffies.
     //
-    if (numberJiffies > 3)
+    uint64_t nsSleep = numberJiffies > 3 ? (numberJiffies - 3) * m_jiffy : 0;
+    nsSleep = ns > m_busyPollWindow ? std::min(nsSleep, ns - m_busyPollWindow) : 0;
+    if (nsSleep > 0)
     {
-        NS_LOG_INFO("SleepWait for " << numberJiffies * m_jiffy << " ns");
-        NS_LOG_INFO("SleepWait until " << nsCurrent + numberJiffies * m_jiffy << " ns");
+        NS_LOG_INFO("SleepWait for " << nsSleep << " ns");
+        NS_LOG_INFO("SleepWait until " << nsCurrent + nsSleep << " ns");
         //
         // SleepWait is interruptible.  If it returns true it meant that the sleep
         // went until the end.  If it returns false, it means that the sleep was
         // interrupted by a Signal.  In this case, we need to return and let the
         // simulator re-evaluate what to do.
         //
-        if (SleepWait((numberJiffies - 3) * m_jiffy) == false)
+        if (SleepWait(nsSleep) == false)
         {
             NS_LOG_INFO("SleepWait interrupted");
             return false;
@@ -337,8 +350,8 @@ WallClockSynchronizer::SleepWait(uint64_t ns)
     std::unique_lock<std::mutex> lock(m_mutex);
     bool finishedWaiting =
         m_conditionVariable.wait_for(lock,
-                                     std::chrono::nanoseconds(ns),      // Timeout
-                                     [this]() { return m_condition; }); // Wait condition
+                                     std::chrono::nanoseconds(ns),             // Timeout
+                                     [this]() { return m_condition.load(); }); // Wait condition
 
     return finishedWaiting;
 }
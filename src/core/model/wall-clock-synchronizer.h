@@ -20,6 +20,7 @@
 
 #include "synchronizer.h"
 
+#include <atomic>
 #include <condition_variable>
 #include <mutex>
 
@@ -86,6 +87,18 @@ class WallClockSynchronizer : public Synchronizer
     /** Conversion constant between ns and s. */
     static const uint64_t NS_PER_SEC = (uint64_t)1000000000;
 
+    /**
+     * @brief Set the real time to busy-wait before each event.
+     *
+     * DoSynchronize() sleeps until this much time before the event is due,
+     * then busy-waits: waking up from a sleep takes tens of microseconds,
+     * which the busy-wait absorbs at the cost of CPU time.  With the default
+     * of zero, only the time below the clock resolution is busy-waited.
+     *
+     * @param [in] ns The busy-poll window, in ns.
+     */
+    void SetBusyPollWindow(uint64_t ns);
+
   protected:
     /**
      * @brief Do a busy-wait until the normalized realtime equals the argument
@@ -163,6 +176,8 @@ class WallClockSynchronizer : public Synchronizer
 
     /** Size of the system clock tick, as reported by @c clock_getres, in ns. */
     uint64_t m_jiffy;
+    /** Real time to busy-wait before each event, in ns. */
+    uint64_t m_busyPollWindow;
     /** Time recorded by DoEventStart. */
     uint64_t m_nsEventStart;
 
@@ -170,8 +185,8 @@ class WallClockSynchronizer : public Synchronizer
     std::condition_variable m_conditionVariable;
     /** Mutex controlling access to the condition variable. */
     std::mutex m_mutex;
-    /** The condition state. */
-    bool m_condition;
+    /** The condition state, polled by SpinWait(). */
+    std::atomic<bool> m_condition;
 };
 
 } // namespace ns3
@@ -0,0 +1,196 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/mpsc-queue.h"
+#include "ns3/test.h"
+
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup mpsc-queue-tests
+ * MpscQueue test suite.
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup mpsc-queue-tests MpscQueue test suite
+ */
+
+namespace ns3
+{
+
+namespace tests
+{
+
+/**
+ * \ingroup mpsc-queue-tests
+ * Check the order and the capacity of the queue with a single thread.
+ */
+class MpscQueueSingleThreadTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    MpscQueueSingleThreadTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+MpscQueueSingleThreadTestCase::MpscQueueSingleThreadTestCase()
+    : TestCase("Check the order and the capacity of the queue")
+{
+}
+
+void
+MpscQueueSingleThreadTestCase::DoRun()
+{
+    MpscQueue<int> queue(5);
+    NS_TEST_ASSERT_MSG_EQ(queue.GetCapacity(), 8, "Capacity not rounded up to a power of two");
+    NS_TEST_ASSERT_MSG_EQ(queue.IsEmpty(), true, "New queue not empty");
+
+    int item = -1;
+    NS_TEST_ASSERT_MSG_EQ(queue.Pop(item), false, "Pop from an empty queue");
+
+    // fill the queue over several laps of the ring
+    int next = 0;
+    for (int lap = 0; lap < 3; ++lap)
+    {
+        for (int i = 0; i < 8; ++i)
+        {
+            NS_TEST_ASSERT_MSG_EQ(queue.Push(lap * 8 + i), true, "Push to a non-full queue");
+        }
+        NS_TEST_ASSERT_MSG_EQ(queue.Push(-1), false, "Push to a full queue");
+        NS_TEST_ASSERT_MSG_EQ(queue.IsEmpty(), false, "Full queue empty");
+        while (queue.Pop(item))
+        {
+            NS_TEST_ASSERT_MSG_EQ(item, next, "Items not popped in order");
+            next++;
+        }
+        NS_TEST_ASSERT_MSG_EQ(queue.IsEmpty(), true, "Drained queue not empty");
+    }
+    NS_TEST_ASSERT_MSG_EQ(next, 24, "Items lost");
+}
+
+/**
+ * \ingroup mpsc-queue-tests
+ * Check that the items pushed by concurrent producers are all popped,
+ * in the order of each producer.
+ */
+class MpscQueueThreadsTestCase : public TestCase
+{
+  public:
+    /** Constructor. */
+    MpscQueueThreadsTestCase();
+
+  private:
+    void DoRun() override;
+
+    /** Item: the producer and its sequence number. */
+    typedef std::pair<uint32_t, uint32_t> Item;
+
+    /**
+     * Push items from a producer thread, retrying while the queue is full.
+     * \param producer The producer.
+     */
+    void Produce(uint32_t producer);
+
+    /** Number of producer threads. */
+    static constexpr uint32_t N_PRODUCERS = 4;
+    /** Number of items per producer. */
+    static constexpr uint32_t N_ITEMS = 100000;
+
+    MpscQueue<Item> m_queue; //!< The queue under test.
+};
+
+MpscQueueThreadsTestCase::MpscQueueThreadsTestCase()
+    : TestCase("Check the queue with concurrent producers"),
+      m_queue(64)
+{
+}
+
+void
+MpscQueueThreadsTestCase::Produce(uint32_t producer)
+{
+    for (uint32_t i = 0; i < N_ITEMS; ++i)
+    {
+        while (!m_queue.Push(Item(producer, i)))
+        {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void
+MpscQueueThreadsTestCase::DoRun()
+{
+    std::vector<std::thread> producers;
+    for (uint32_t producer = 0; producer < N_PRODUCERS; ++producer)
+    {
+        producers.emplace_back(&MpscQueueThreadsTestCase::Produce, this, producer);
+    }
+
+    std::vector<uint32_t> next(N_PRODUCERS, 0);
+    uint32_t received = 0;
+    bool ordered = true;
+    while (received < N_PRODUCERS * N_ITEMS)
+    {
+        Item item;
+        if (!m_queue.Pop(item))
+        {
+            std::this_thread::yield();
+            continue;
+        }
+        ordered = ordered && item.second == next[item.first];
+        next[item.first] = item.second + 1;
+        received++;
+    }
+    for (auto& producer : producers)
+    {
+        producer.join();
+    }
+
+    NS_TEST_ASSERT_MSG_EQ(ordered, true, "Items of a producer not popped in order");
+    NS_TEST_ASSERT_MSG_EQ(m_queue.IsEmpty(), true, "Items left in the queue");
+}
+
+/**
+ * \ingroup mpsc-queue-tests
+ * MpscQueue test suite.
+ */
+class MpscQueueTestSuite : public TestSuite
+{
+  public:
+    /** Constructor. */
+    MpscQueueTestSuite()
+        : TestSuite("mpsc-queue")
+    {
+        AddTestCase(new MpscQueueSingleThreadTestCase());
+        AddTestCase(new MpscQueueThreadsTestCase());
+    }
+};
+
+/**
+ * \ingroup mpsc-queue-tests
+ * MpscQueueTestSuite instance variable.
+ */
+static MpscQueueTestSuite g_mpscQueueTestSuite;
+
+} // namespace tests
+
+} // namespace ns3
@@ -158,10 +158,38 @@ class DerivedB : public BaseB
     }
 };
 
+/**
+ * \ingroup object-tests
+ * Class derived from BaseA, whose TypeId does not declare BaseA as parent.
+ */
+class UnlistedA : public BaseA
+{
+  public:
+    /**
+     * Register this type.
+     * \return The TypeId.
+     */
+    static ns3::TypeId GetTypeId()
+    {
+        static ns3::TypeId tid = ns3::TypeId("ObjectTest:UnlistedA")
+                                     .SetParent<Object>()
+                                     .SetGroupName("Core")
+                                     .HideFromDocumentation()
+                                     .AddConstructor<UnlistedA>();
+        return tid;
+    }
+
+    /** Constructor. */
+    UnlistedA()
+    {
+    }
+};
+
 NS_OBJECT_ENSURE_REGISTERED(BaseA);
 NS_OBJECT_ENSURE_REGISTERED(DerivedA);
 NS_OBJECT_ENSURE_REGISTERED(BaseB);
 NS_OBJECT_ENSURE_REGISTERED(DerivedB);
+NS_OBJECT_ENSURE_REGISTERED(UnlistedA);
 
 } // unnamed namespace
 
@@ -462,6 +490,45 @@ AggregateObjectTestCase::DoRun()
 
     baseA = baseB->GetObject<BaseA>();
     NS_TEST_ASSERT_MSG_NE(baseA, nullptr, "Unable to GetObject on released object");
+
+    //
+    // The lookups are cached, including those which find nothing: make sure
+    // that the cached results follow the later aggregations, and that repeated
+    // lookups keep returning the same Objects.
+    //
+    Ptr<DerivedA> derivedA = CreateObject<DerivedA>();
+    NS_TEST_ASSERT_MSG_EQ(derivedA->GetObject<BaseB>(), nullptr, "Unexpectedly found a BaseB");
+    NS_TEST_ASSERT_MSG_EQ(derivedA->GetObject<DerivedB>(), nullptr, "Unexpectedly found a DerivedB");
+
+    Ptr<DerivedB> derivedB = CreateObject<DerivedB>();
+    derivedA->AggregateObject(derivedB);
+    for (uint32_t i = 0; i < 3; i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(derivedA->GetObject<BaseB>(),
+                              derivedB,
+                              "Cannot GetObject (through derivedA) for BaseB Object");
+        NS_TEST_ASSERT_MSG_EQ(derivedA->GetObject<DerivedB>(),
+                              derivedB,
+                              "Cannot GetObject (through derivedA) for DerivedB Object");
+        NS_TEST_ASSERT_MSG_EQ(derivedB->GetObject<BaseA>(DerivedA::GetTypeId()),
+                              derivedA,
+                              "Cannot GetObject (through derivedB) for DerivedA Object");
+        NS_TEST_ASSERT_MSG_EQ(derivedB->GetObject<BaseA>(),
+                              derivedA,
+                              "Cannot GetObject (through derivedB) for BaseA Object");
+    }
+
+    //
+    // The base classes missing from the TypeId hierarchy are still found.
+    //
+    Ptr<UnlistedA> unlistedA = CreateObject<UnlistedA>();
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(unlistedA->GetObject<BaseA>(),
+                              unlistedA,
+                              "Cannot GetObject for the C++ base class of UnlistedA");
+        NS_TEST_ASSERT_MSG_EQ(unlistedA->GetObject<BaseB>(), nullptr, "Unexpectedly found a BaseB");
+    }
 }
 
 /**
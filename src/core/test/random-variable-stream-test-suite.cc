@@ -2565,6 +2565,57 @@ NormalCachingTestCase::DoRun()
     NS_TEST_ASSERT_MSG_GT(v2, 0, "Incorrect value returned, expected > 0");
 }
 
+/**
+ * \ingroup rng-tests
+ * Test case for the substreams of the stream of a random variable
+ */
+class SubstreamTestCase : public TestCaseBase
+{
+  public:
+    // Constructor
+    SubstreamTestCase();
+
+  private:
+    // Inherited
+    void DoRun() override;
+};
+
+SubstreamTestCase::SubstreamTestCase()
+    : TestCaseBase("RandomVariableStream substreams")
+{
+}
+
+void
+SubstreamTestCase::DoRun()
+{
+    NS_LOG_FUNCTION(this);
+    uint64_t run = RngSeedManager::GetRun();
+    const int64_t stream = 7;
+    const std::size_t nValues = 10;
+
+    RngSeedManager::SetRun(0);
+    Ptr<UniformRandomVariable> rv = CreateObject<UniformRandomVariable>();
+    rv->SetStream(stream);
+    Ptr<UniformRandomVariable> substream = CreateObject<UniformRandomVariable>();
+    substream->SetSubstream(rv, 1);
+    Ptr<UniformRandomVariable> again = CreateObject<UniformRandomVariable>();
+    again->SetSubstream(rv, 1);
+
+    RngSeedManager::SetRun(1);
+    Ptr<UniformRandomVariable> plain = CreateObject<UniformRandomVariable>();
+    plain->SetStream(stream);
+    RngSeedManager::SetRun(run);
+
+    std::size_t nEqual = 0;
+    for (std::size_t i = 0; i < nValues; i++)
+    {
+        double value = substream->GetValue();
+        NS_TEST_ASSERT_MSG_EQ(again->GetValue(), value, "Substream 1 of run 0 not reproducible");
+        nEqual += (value == plain->GetValue());
+    }
+    NS_TEST_ASSERT_MSG_EQ(nEqual, 0, "Substream 1 of run 0 draws the values of run 1");
+}
+
 /**
  * \ingroup rng-tests
  * RandomVariableStream test suite, covering all random number variable
@@ -2617,6 +2668,7 @@ RandomVariableSuite::RandomVariableSuite()
     AddTestCase(new EmpiricalAntitheticTestCase);
     /// Issue #302:  NormalRandomVariable produces stale values
     AddTestCase(new NormalCachingTestCase);
+    AddTestCase(new SubstreamTestCase);
 }
 
 static RandomVariableSuite randomVariableSuite; //!< Static variable for test initialization
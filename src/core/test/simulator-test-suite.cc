@@ -17,13 +17,22 @@
  * Author: Mathieu Lacage <mathieu.lacage@sophia.inria.fr>
  */
 #include "ns3/calendar-scheduler.h"
+#include "ns3/config.h"
+#include "ns3/event-impl.h"
 #include "ns3/heap-scheduler.h"
+#include "ns3/ladder-scheduler.h"
 #include "ns3/list-scheduler.h"
 #include "ns3/map-scheduler.h"
 #include "ns3/priority-queue-scheduler.h"
+#include "ns3/random-variable-stream.h"
+#include "ns3/realtime-simulator-impl.h"
 #include "ns3/simulator.h"
+#include "ns3/string.h"
 #include "ns3/test.h"
 
+#include <set>
+#include <vector>
+
 using namespace ns3;
 
 /**
@@ -717,6 +726,290 @@ SimulatorTemplateTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check the order of the events of a scheduler under random
+ * insertions and removals.
+ */
+class SchedulerOrderTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param schedulerFactory Scheduler factory.
+     */
+    SchedulerOrderTestCase(ObjectFactory schedulerFactory);
+
+  private:
+    void DoRun() override;
+
+    ObjectFactory m_schedulerFactory; //!< Scheduler factory.
+};
+
+SchedulerOrderTestCase::SchedulerOrderTestCase(ObjectFactory schedulerFactory)
+    : TestCase("Check the order of random events with " +
+               schedulerFactory.GetTypeId().GetName()),
+      m_schedulerFactory(schedulerFactory)
+{
+}
+
+void
+SchedulerOrderTestCase::DoRun()
+{
+    Ptr<Scheduler> scheduler = m_schedulerFactory.Create<Scheduler>();
+    Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable>();
+    rng->SetStream(1);
+
+    // The reference, ordered like the scheduler.
+    std::set<Scheduler::Event> pending;
+    uint64_t now = 0;
+    uint32_t uid = 0;
+    for (uint32_t i = 0; i < 20000; ++i)
+    {
+        uint32_t action = rng->GetInteger(0, 9);
+        if (action < 5 || pending.empty())
+        {
+            // Mix of simultaneous, near and far events
+            uint64_t delay = 0;
+            uint32_t kind = rng->GetInteger(0, 3);
+            if (kind == 1)
+            {
+                delay = rng->GetInteger(0, 100);
+            }
+            else if (kind == 2)
+            {
+                delay = rng->GetInteger(0, 1000000);
+            }
+            else if (kind == 3)
+            {
+                delay = 1000 * rng->GetInteger(1, 3);
+            }
+            Scheduler::Event ev = {nullptr, {now + delay, uid++, 0}};
+            scheduler->Insert(ev);
+            pending.insert(ev);
+        }
+        else if (action < 8)
+        {
+            Scheduler::Event expected = *pending.begin();
+            NS_TEST_ASSERT_MSG_EQ(scheduler->PeekNext().key.m_uid,
+                                  expected.key.m_uid,
+                                  "Wrong next event");
+            Scheduler::Event ev = scheduler->RemoveNext();
+            NS_TEST_ASSERT_MSG_EQ(ev.key.m_uid, expected.key.m_uid, "Wrong event removed");
+            NS_TEST_ASSERT_MSG_EQ(ev.key.m_ts, expected.key.m_ts, "Wrong event time");
+            now = ev.key.m_ts;
+            pending.erase(pending.begin());
+        }
+        else
+        {
+            auto it = pending.begin();
+            std::advance(it, rng->GetInteger(0, pending.size() - 1));
+            scheduler->Remove(*it);
+            pending.erase(it);
+        }
+        NS_TEST_ASSERT_MSG_EQ(scheduler->IsEmpty(), pending.empty(), "Wrong emptiness");
+    }
+    while (!pending.empty())
+    {
+        Scheduler::Event ev = scheduler->RemoveNext();
+        NS_TEST_ASSERT_MSG_EQ(ev.key.m_uid, pending.begin()->key.m_uid, "Wrong event removed");
+        pending.erase(pending.begin());
+    }
+    NS_TEST_ASSERT_MSG_EQ(scheduler->IsEmpty(), true, "Scheduler not empty");
+}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check that the memory of the events is reused.
+ */
+class SimulatorEventMemoryTestCase : public TestCase
+{
+  public:
+    SimulatorEventMemoryTestCase();
+
+  private:
+    void DoRun() override;
+    /**
+     * Schedule events with closures of several sizes, then run them.
+     */
+    void ScheduleAndRun();
+    /**
+     * Test event.
+     * \param value Event parameter.
+     */
+    void Event1(int value);
+    /**
+     * Test event.
+     * \param value Event parameter.
+     * \param time Event parameter.
+     */
+    void Event2(int value, Time time);
+};
+
+SimulatorEventMemoryTestCase::SimulatorEventMemoryTestCase()
+    : TestCase("Check that scheduling events in steady state does not allocate memory")
+{
+}
+
+void
+SimulatorEventMemoryTestCase::Event1(int value)
+{
+}
+
+void
+SimulatorEventMemoryTestCase::Event2(int value, Time time)
+{
+}
+
+void
+SimulatorEventMemoryTestCase::ScheduleAndRun()
+{
+    for (int i = 0; i < 1000; ++i)
+    {
+        Simulator::Schedule(NanoSeconds(i), &SimulatorEventMemoryTestCase::Event1, this, i);
+        Simulator::Schedule(NanoSeconds(i),
+                            &SimulatorEventMemoryTestCase::Event2,
+                            this,
+                            i,
+                            Seconds(i));
+    }
+    Simulator::Run();
+}
+
+void
+SimulatorEventMemoryTestCase::DoRun()
+{
+    ScheduleAndRun();
+    uint64_t heapAllocations = EventImpl::GetHeapAllocations();
+    ScheduleAndRun();
+    NS_TEST_EXPECT_MSG_EQ(EventImpl::GetHeapAllocations(),
+                          heapAllocations,
+                          "The memory of the events executed was not reused");
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup simulator-tests
+ *
+ * \brief Check the lateness traces of the realtime simulator.
+ */
+class RealtimeLatenessTestCase : public TestCase
+{
+  public:
+    RealtimeLatenessTestCase();
+
+  private:
+    void DoSetup() override;
+    void DoRun() override;
+    void DoTeardown() override;
+    /**
+     * Lateness trace sink.
+     * \param lateness The lateness of the event.
+     */
+    void Lateness(Time lateness);
+    /**
+     * Lateness histogram trace sink.
+     * \param histogram The histogram of the last second.
+     */
+    void LatenessHistogram(const RealtimeSimulatorImpl::LatenessHistogram& histogram);
+    /** Test event. */
+    void Event();
+
+    /** Number of events executed. */
+    uint32_t m_events;
+    /** Number of lateness traces. */
+    uint32_t m_lateness;
+    /** Histograms traced. */
+    std::vector<RealtimeSimulatorImpl::LatenessHistogram> m_histograms;
+};
+
+RealtimeLatenessTestCase::RealtimeLatenessTestCase()
+    : TestCase("Check the lateness traces of the realtime simulator")
+{
+}
+
+void
+RealtimeLatenessTestCase::DoSetup()
+{
+    Config::SetGlobal("SimulatorImplementationType", StringValue("ns3::RealtimeSimulatorImpl"));
+    m_events = 0;
+    m_lateness = 0;
+    m_histograms.clear();
+}
+
+void
+RealtimeLatenessTestCase::DoTeardown()
+{
+    Config::SetGlobal("SimulatorImplementationType", StringValue("ns3::DefaultSimulatorImpl"));
+}
+
+void
+RealtimeLatenessTestCase::Lateness(Time lateness)
+{
+    m_lateness++;
+}
+
+void
+RealtimeLatenessTestCase::LatenessHistogram(
+    const RealtimeSimulatorImpl::LatenessHistogram& histogram)
+{
+    m_histograms.push_back(histogram);
+}
+
+void
+RealtimeLatenessTestCase::Event()
+{
+    m_events++;
+}
+
+void
+RealtimeLatenessTestCase::DoRun()
+{
+    Ptr<SimulatorImpl> impl = Simulator::GetImplementation();
+    impl->SetAttribute("BusyPollWindow", TimeValue(MilliSeconds(1)));
+    impl->TraceConnectWithoutContext("Lateness",
+                                     MakeCallback(&RealtimeLatenessTestCase::Lateness, this));
+    impl->TraceConnectWithoutContext(
+        "LatenessHistogram",
+        MakeCallback(&RealtimeLatenessTestCase::LatenessHistogram, this));
+
+    // events in the seconds 0 and 1 of the simulation, then a Stop event
+    for (int i = 0; i < 13; ++i)
+    {
+        Simulator::Schedule(MilliSeconds(100 * i), &RealtimeLatenessTestCase::Event, this);
+    }
+    Simulator::Stop(MilliSeconds(1250));
+    Simulator::Run();
+
+    NS_TEST_ASSERT_MSG_EQ(m_events, 13, "Events not executed");
+    NS_TEST_EXPECT_MSG_EQ(m_lateness, m_events + 1, "Lateness not traced for each event");
+    NS_TEST_ASSERT_MSG_EQ(m_histograms.size(), 2, "Histogram not traced for each second");
+    NS_TEST_EXPECT_MSG_EQ(m_histograms[0].start, Seconds(0), "Wrong start of the first second");
+    NS_TEST_EXPECT_MSG_EQ(m_histograms[0].count, 10, "Wrong event count in the first second");
+    NS_TEST_EXPECT_MSG_EQ(m_histograms[1].start, Seconds(1), "Wrong start of the second second");
+    NS_TEST_EXPECT_MSG_EQ(m_histograms[1].count, 4, "Wrong event count in the second second");
+    for (const auto& histogram : m_histograms)
+    {
+        uint64_t count = 0;
+        for (auto bucketCount : histogram.buckets)
+        {
+            count += bucketCount;
+        }
+        NS_TEST_EXPECT_MSG_EQ(count, histogram.count, "Events missing from the buckets");
+        NS_TEST_EXPECT_MSG_LT_OR_EQ(histogram.max,
+                                    histogram.total,
+                                    "Maximum lateness above the total");
+    }
+
+    Ptr<RealtimeSimulatorImpl> realtime = DynamicCast<RealtimeSimulatorImpl>(impl);
+    NS_TEST_EXPECT_MSG_EQ(realtime->GetLatenessHistogram().count,
+                          m_events + 1,
+                          "Wrong event count in the overall histogram");
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup simulator-tests
  *
@@ -740,6 +1033,20 @@ class SimulatorTestSuite : public TestSuite
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
         factory.SetTypeId(PriorityQueueScheduler::GetTypeId());
         AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+        factory.SetTypeId(LadderScheduler::GetTypeId());
+        AddTestCase(new SimulatorEventsTestCase(factory), TestCase::QUICK);
+
+        for (const auto& tid : {MapScheduler::GetTypeId(),
+                                HeapScheduler::GetTypeId(),
+                                CalendarScheduler::GetTypeId(),
+                                PriorityQueueScheduler::GetTypeId(),
+                                LadderScheduler::GetTypeId()})
+        {
+            factory.SetTypeId(tid);
+            AddTestCase(new SchedulerOrderTestCase(factory), TestCase::QUICK);
+        }
+        AddTestCase(new SimulatorEventMemoryTestCase(), TestCase::QUICK);
+        AddTestCase(new RealtimeLatenessTestCase(), TestCase::QUICK);
     }
 };
 
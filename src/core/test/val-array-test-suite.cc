@@ -0,0 +1,129 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/test.h"
+#include "ns3/val-array.h"
+
+#include <complex>
+
+/**
+ * \file
+ * \ingroup core-tests
+ * \ingroup val-array-tests
+ * ValArray test suite
+ */
+
+/**
+ * \ingroup core-tests
+ * \defgroup val-array-tests ValArray test suite
+ */
+
+namespace ns3
+{
+
+namespace tests
+{
+
+/**
+ * \ingroup val-array-tests
+ *
+ * Check the dimensions, the layout and the comparison of ValArray.
+ */
+class ValArrayTestCase : public TestCase
+{
+  public:
+    ValArrayTestCase();
+
+  private:
+    void DoRun() override;
+};
+
+ValArrayTestCase::ValArrayTestCase()
+    : TestCase("Check the dimensions, the layout and the comparison of ValArray")
+{
+}
+
+void
+ValArrayTestCase::DoRun()
+{
+    ValArray<std::complex<double>> empty;
+    NS_TEST_EXPECT_MSG_EQ(empty.GetSize(), 0, "An empty array has no elements");
+
+    ValArray<std::complex<double>> a(2, 3, 4);
+    NS_TEST_ASSERT_MSG_EQ(a.GetNumRows(), 2, "Wrong number of rows");
+    NS_TEST_ASSERT_MSG_EQ(a.GetNumCols(), 3, "Wrong number of columns");
+    NS_TEST_ASSERT_MSG_EQ(a.GetNumPages(), 4, "Wrong number of pages");
+    NS_TEST_ASSERT_MSG_EQ(a.GetSize(), 24, "Wrong number of elements");
+    for (std::size_t p = 0; p < 4; p++)
+    {
+        for (std::size_t c = 0; c < 3; c++)
+        {
+            for (std::size_t r = 0; r < 2; r++)
+            {
+                NS_TEST_EXPECT_MSG_EQ(a(r, c, p),
+                                      std::complex<double>(0),
+                                      "The elements are value-initialized");
+                a(r, c, p) = std::complex<double>(r + 10 * c, p);
+            }
+        }
+    }
+
+    // The rows of a column, then the columns of a page, are contiguous
+    for (std::size_t p = 0; p < 4; p++)
+    {
+        const std::complex<double>* page = a.GetPagePtr(p);
+        NS_TEST_EXPECT_MSG_EQ(page, a.GetPagePtr(0) + 6 * p, "The pages are contiguous");
+        for (std::size_t c = 0; c < 3; c++)
+        {
+            for (std::size_t r = 0; r < 2; r++)
+            {
+                NS_TEST_EXPECT_MSG_EQ(page[r + 2 * c],
+                                      std::complex<double>(r + 10 * c, p),
+                                      "Wrong layout of the elements");
+            }
+        }
+    }
+
+    ValArray<std::complex<double>> b = a;
+    NS_TEST_EXPECT_MSG_EQ((b == a), true, "A copy is equal to the array");
+    b(1, 2, 3) += 1.0;
+    NS_TEST_EXPECT_MSG_EQ((b != a), true, "The arrays differ by one element");
+    NS_TEST_EXPECT_MSG_EQ((ValArray<std::complex<double>>(6, 1, 4) != a),
+                          true,
+                          "The arrays differ by their dimensions");
+}
+
+/**
+ * \ingroup val-array-tests
+ *
+ * ValArray test suite.
+ */
+class ValArrayTestSuite : public TestSuite
+{
+  public:
+    ValArrayTestSuite();
+};
+
+ValArrayTestSuite::ValArrayTestSuite()
+    : TestSuite("val-array", UNIT)
+{
+    AddTestCase(new ValArrayTestCase(), TestCase::QUICK);
+}
+
+static ValArrayTestSuite g_valArrayTestSuite; //!< Static variable for test initialization
+
+} // namespace tests
+
+} // namespace ns3
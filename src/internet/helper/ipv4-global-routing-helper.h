@@ -86,6 +86,8 @@ class Ipv4GlobalRoutingHelper : public Ipv4RoutingHelper
      * Users must first call PopulateRoutingTables() and then may subsequently
      * call RecomputeRoutingTables() at any later time in the simulation.
      *
+     * Only the routes of the routers connected to a part of the topology that
+     * changed are removed and computed again; the other routes are kept.
      */
     static void RecomputeRoutingTables();
 };
@@ -0,0 +1,75 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#include "ipv4-next-hop-routing-helper.h"
+
+#include "ns3/global-route-manager.h"
+#include "ns3/global-router-interface.h"
+#include "ns3/ipv4-next-hop-routing.h"
+#include "ns3/log.h"
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("NextHopRoutingHelper");
+
+Ipv4NextHopRoutingHelper::Ipv4NextHopRoutingHelper()
+    : m_table(ns3::Create<Ipv4NextHopTable>())
+{
+}
+
+Ipv4NextHopRoutingHelper::Ipv4NextHopRoutingHelper(Ptr<Ipv4NextHopTable> table)
+    : m_table(table)
+{
+}
+
+Ipv4NextHopRoutingHelper::Ipv4NextHopRoutingHelper(const Ipv4NextHopRoutingHelper& o)
+    : m_table(o.m_table)
+{
+}
+
+Ipv4NextHopRoutingHelper*
+Ipv4NextHopRoutingHelper::Copy() const
+{
+    return new Ipv4NextHopRoutingHelper(*this);
+}
+
+Ptr<Ipv4RoutingProtocol>
+Ipv4NextHopRoutingHelper::Create(Ptr<Node> node) const
+{
+    NS_LOG_LOGIC("Adding GlobalRouter interface to node " << node->GetId());
+    // the router exports the Link State Advertisements the table is computed from
+    Ptr<GlobalRouter> globalRouter = CreateObject<GlobalRouter>();
+    node->AggregateObject(globalRouter);
+
+    NS_LOG_LOGIC("Adding NextHopRouting Protocol to node " << node->GetId());
+    Ptr<Ipv4NextHopRouting> nextHopRouting = CreateObject<Ipv4NextHopRouting>();
+    nextHopRouting->SetTable(m_table);
+    return nextHopRouting;
+}
+
+void
+Ipv4NextHopRoutingHelper::PopulateRoutingTables() const
+{
+    GlobalRouteManager::BuildGlobalRoutingDatabase();
+    GlobalRouteManager::ComputeNextHopTable(m_table);
+}
+
+Ptr<Ipv4NextHopTable>
+Ipv4NextHopRoutingHelper::GetTable() const
+{
+    return m_table;
+}
+
+} // namespace ns3
@@ -0,0 +1,92 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+#ifndef IPV4_NEXT_HOP_ROUTING_HELPER_H
+#define IPV4_NEXT_HOP_ROUTING_HELPER_H
+
+#include "ns3/ipv4-next-hop-table.h"
+#include "ns3/ipv4-routing-helper.h"
+
+namespace ns3
+{
+
+/**
+ * \ingroup ipv4Helpers
+ *
+ * \brief Helper class that adds ns3::Ipv4NextHopRouting objects sharing a
+ * next hop table
+ *
+ * The copies of a helper share its next hop table.
+ */
+class Ipv4NextHopRoutingHelper : public Ipv4RoutingHelper
+{
+  public:
+    /**
+     * \brief Construct a helper with a new, empty, next hop table.
+     */
+    Ipv4NextHopRoutingHelper();
+
+    /**
+     * \brief Construct a helper using a given next hop table (e.g., loaded
+     * from a file).
+     * \param table the next hop table
+     */
+    Ipv4NextHopRoutingHelper(Ptr<Ipv4NextHopTable> table);
+
+    /**
+     * \brief Construct an Ipv4NextHopRoutingHelper from another previously
+     * initialized instance (Copy Constructor).
+     * \param o object to be copied
+     */
+    Ipv4NextHopRoutingHelper(const Ipv4NextHopRoutingHelper& o);
+
+    // Delete assignment operator to avoid misuse
+    Ipv4NextHopRoutingHelper& operator=(const Ipv4NextHopRoutingHelper&) = delete;
+
+    /**
+     * \returns pointer to clone of this Ipv4NextHopRoutingHelper
+     *
+     * This method is mainly for internal use by the other helpers;
+     * clients are expected to free the dynamic memory allocated by this method
+     */
+    Ipv4NextHopRoutingHelper* Copy() const override;
+
+    /**
+     * \param node the node on which the routing protocol will run
+     * \returns a newly-created routing protocol
+     *
+     * This method will be called by ns3::InternetStackHelper::Install
+     */
+    Ptr<Ipv4RoutingProtocol> Create(Ptr<Node> node) const override;
+
+    /**
+     * \brief Build the global routing database and compute the next hop
+     * table of the helper from it.
+     *
+     * This is not needed when the table was loaded from a file.
+     */
+    void PopulateRoutingTables() const;
+
+    /**
+     * \returns the next hop table of the helper
+     */
+    Ptr<Ipv4NextHopTable> GetTable() const;
+
+  private:
+    Ptr<Ipv4NextHopTable> m_table; //!< the next hop table
+};
+
+} // namespace ns3
+
+#endif /* IPV4_NEXT_HOP_ROUTING_HELPER_H */
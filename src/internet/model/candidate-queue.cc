@@ -58,22 +58,23 @@ operator<<(std::ostream& os, const SPFVertex::VertexType& t)
 std::ostream&
 operator<<(std::ostream& os, const CandidateQueue& q)
 {
-    typedef CandidateQueue::CandidateList_t List_t;
-    typedef List_t::const_iterator CIter_t;
-    const CandidateQueue::CandidateList_t& list = q.m_candidates;
+    CandidateQueue::CandidateList_t list = q.m_candidates;
+    std::sort(list.begin(), list.end(), &CandidateQueue::Before);
 
     os << "*** CandidateQueue Begin (<id, distance, LSA-type>) ***" << std::endl;
-    for (CIter_t iter = list.begin(); iter != list.end(); iter++)
+    for (const auto& candidate : list)
     {
-        os << "<" << (*iter)->GetVertexId() << ", " << (*iter)->GetDistanceFromRoot() << ", "
-           << (*iter)->GetVertexType() << ">" << std::endl;
+        os << "<" << candidate.vertex->GetVertexId() << ", "
+           << candidate.vertex->GetDistanceFromRoot() << ", " << candidate.vertex->GetVertexType()
+           << ">" << std::endl;
     }
     os << "*** CandidateQueue End ***";
     return os;
 }
 
 CandidateQueue::CandidateQueue()
-    : m_candidates()
+    : m_candidates(),
+      m_nextOrder(0)
 {
     NS_LOG_FUNCTION(this);
 }
@@ -101,11 +102,10 @@ CandidateQueue::Push(SPFVertex* vNew)
 {
     NS_LOG_FUNCTION(this << vNew);
 
-    CandidateList_t::iterator i = std::upper_bound(m_candidates.begin(),
-                                                   m_candidates.end(),
-                                                   vNew,
-                                                   &CandidateQueue::CompareSPFVertex);
-    m_candidates.insert(i, vNew);
+    m_candidates.push_back({vNew, m_nextOrder++});
+    m_positions[vNew] = m_candidates.size() - 1;
+    m_vertices.emplace(vNew->GetVertexId(), vNew);
+    SiftUp(m_candidates.size() - 1);
 }
 
 SPFVertex*
@@ -117,8 +117,20 @@ CandidateQueue::Pop()
         return nullptr;
     }
 
-    SPFVertex* v = m_candidates.front();
-    m_candidates.pop_front();
+    SPFVertex* v = m_candidates.front().vertex;
+    m_positions.erase(v);
+    auto vertex = m_vertices.find(v->GetVertexId());
+    if (vertex != m_vertices.end() && vertex->second == v)
+    {
+        m_vertices.erase(vertex);
+    }
+    Candidate last = m_candidates.back();
+    m_candidates.pop_back();
+    if (!m_candidates.empty())
+    {
+        Place(0, last);
+        SiftDown(0);
+    }
     return v;
 }
 
@@ -131,7 +143,7 @@ CandidateQueue::Top() const
         return nullptr;
     }
 
-    return m_candidates.front();
+    return m_candidates.front().vertex;
 }
 
 bool
@@ -152,18 +164,12 @@ SPFVertex*
 CandidateQueue::Find(const Ipv4Address addr) const
 {
     NS_LOG_FUNCTION(this);
-    CandidateList_t::const_iterator i = m_candidates.begin();
-
-    for (; i != m_candidates.end(); i++)
+    auto vertex = m_vertices.find(addr);
+    if (vertex == m_vertices.end())
     {
-        SPFVertex* v = *i;
-        if (v->GetVertexId() == addr)
-        {
-            return v;
-        }
+        return nullptr;
     }
-
-    return nullptr;
+    return vertex->second;
 }
 
 void
@@ -171,11 +177,96 @@ CandidateQueue::Reorder()
 {
     NS_LOG_FUNCTION(this);
 
-    m_candidates.sort(&CandidateQueue::CompareSPFVertex);
+    std::make_heap(m_candidates.begin(),
+                   m_candidates.end(),
+                   [](const Candidate& c1, const Candidate& c2) { return Before(c2, c1); });
+    for (std::size_t i = 0; i < m_candidates.size(); i++)
+    {
+        m_positions[m_candidates[i].vertex] = i;
+    }
     NS_LOG_LOGIC("After reordering the CandidateQueue");
     NS_LOG_LOGIC(*this);
 }
 
+void
+CandidateQueue::Reorder(SPFVertex* v)
+{
+    NS_LOG_FUNCTION(this << v);
+
+    auto position = m_positions.find(v);
+    NS_ASSERT_MSG(position != m_positions.end(), "Vertex " << v << " not in the queue");
+    std::size_t i = position->second;
+    // the vertex is now behind the vertices already at its new distance
+    m_candidates[i].order = m_nextOrder++;
+    SiftUp(i);
+    NS_LOG_LOGIC("After reordering the CandidateQueue");
+    NS_LOG_LOGIC(*this);
+}
+
+void
+CandidateQueue::SiftUp(std::size_t i)
+{
+    Candidate c = m_candidates[i];
+    while (i > 0)
+    {
+        std::size_t parent = (i - 1) / 2;
+        if (!Before(c, m_candidates[parent]))
+        {
+            break;
+        }
+        Place(i, m_candidates[parent]);
+        i = parent;
+    }
+    Place(i, c);
+}
+
+void
+CandidateQueue::SiftDown(std::size_t i)
+{
+    Candidate c = m_candidates[i];
+    std::size_t n = m_candidates.size();
+    for (;;)
+    {
+        std::size_t child = 2 * i + 1;
+        if (child >= n)
+        {
+            break;
+        }
+        if (child + 1 < n && Before(m_candidates[child + 1], m_candidates[child]))
+        {
+            child++;
+        }
+        if (!Before(m_candidates[child], c))
+        {
+            break;
+        }
+        Place(i, m_candidates[child]);
+        i = child;
+    }
+    Place(i, c);
+}
+
+void
+CandidateQueue::Place(std::size_t i, const Candidate& c)
+{
+    m_candidates[i] = c;
+    m_positions[c.vertex] = i;
+}
+
+bool
+CandidateQueue::Before(const Candidate& c1, const Candidate& c2)
+{
+    if (CompareSPFVertex(c1.vertex, c2.vertex))
+    {
+        return true;
+    }
+    if (CompareSPFVertex(c2.vertex, c1.vertex))
+    {
+        return false;
+    }
+    return c1.order < c2.order;
+}
+
 /*
  * In this implementation, SPFVertex follows the ordering where
  * a vertex is ranked first if its GetDistanceFromRoot () is smaller;
@@ -22,8 +22,9 @@
 
 #include "ns3/ipv4-address.h"
 
-#include <list>
 #include <stdint.h>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -47,7 +48,11 @@ class SPFVertex;
  * Although a STL priority_queue almost does what we want, the requirement
  * for a Find () operation, the dynamic nature of the data and the derived
  * requirement for a Reorder () operation led us to implement this simple
- * enhanced priority queue.
+ * enhanced priority queue.  It is a binary heap whose vertices are also
+ * indexed by address, so that Push (), Pop () and Reorder () of a vertex
+ * take a logarithmic time and Find () a constant time.  The vertices at the
+ * same distance and of the same type are popped in the order they were
+ * pushed or reordered.
  */
 class CandidateQueue
 {
@@ -159,6 +164,18 @@ class CandidateQueue
      */
     void Reorder();
 
+    /**
+     * @brief Moves a Shortest Path First Vertex pointer to its place in the
+     * Candidate Queue after the value of its field m_distanceFromRoot decreased.
+     *
+     * This is equivalent to, but faster than, Reorder () when the distance of
+     * a single vertex changed.
+     *
+     * @see SPFVertex
+     * @param v The Shortest Path First Vertex whose distance decreased.
+     */
+    void Reorder(SPFVertex* v);
+
   private:
     /**
      * \brief return true if v1 < v2
@@ -173,8 +190,46 @@ class CandidateQueue
      */
     static bool CompareSPFVertex(const SPFVertex* v1, const SPFVertex* v2);
 
-    typedef std::list<SPFVertex*> CandidateList_t; //!< container of SPFVertex pointers
-    CandidateList_t m_candidates;                  //!< SPFVertex candidates
+    /// A vertex in the heap
+    struct Candidate
+    {
+        SPFVertex* vertex; //!< the vertex
+        uint64_t order;    //!< rank of the vertex among the vertices pushed or reordered
+    };
+
+    /**
+     * \param c1 first operand
+     * \param c2 second operand
+     * \return True if c1 should be popped before c2; false otherwise
+     */
+    static bool Before(const Candidate& c1, const Candidate& c2);
+
+    /**
+     * \brief Move a candidate towards the top of the heap until it is in place
+     * \param i the index of the candidate
+     */
+    void SiftUp(std::size_t i);
+
+    /**
+     * \brief Move a candidate towards the bottom of the heap until it is in place
+     * \param i the index of the candidate
+     */
+    void SiftDown(std::size_t i);
+
+    /**
+     * \brief Put a candidate at an index of the heap
+     * \param i the index
+     * \param c the candidate
+     */
+    void Place(std::size_t i, const Candidate& c);
+
+    typedef std::vector<Candidate> CandidateList_t; //!< container of SPFVertex pointers
+    CandidateList_t m_candidates;                   //!< SPFVertex candidates, as a binary heap
+    std::unordered_map<const SPFVertex*, std::size_t>
+        m_positions; //!< index of the candidates in the heap
+    std::unordered_map<Ipv4Address, SPFVertex*, Ipv4AddressHash>
+        m_vertices;       //!< candidates by vertex ID
+    uint64_t m_nextOrder; //!< rank of the next vertex pushed or reordered
 
     /**
      * \brief Stream insertion operator.
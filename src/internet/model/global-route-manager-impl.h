@@ -31,6 +31,8 @@
 #include <map>
 #include <queue>
 #include <stdint.h>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 namespace ns3
@@ -39,7 +41,10 @@ namespace ns3
 const uint32_t SPF_INFINITY = 0xffffffff; //!< "infinite" distance between nodes
 
 class CandidateQueue;
+class Ipv4;
 class Ipv4GlobalRouting;
+class Ipv4NextHopTable;
+class Node;
 
 /**
  * \ingroup globalrouting
@@ -600,7 +605,8 @@ class GlobalRouteManagerLSDB
      * State Database.
      *
      * The IPV4 address and the GlobalRoutingLSA given as parameters are converted
-     * to an STL pair and are inserted into the database map.
+     * to an STL pair and are inserted into the database map.  The database
+     * indexes the link records of the LSA, which must not change afterwards.
      *
      * @see GlobalRoutingLSA
      * @see Ipv4Address
@@ -643,9 +649,10 @@ class GlobalRouteManagerLSDB
      * @brief Set all LSA flags to an initialized state, for SPF computation
      *
      * This function walks the database and resets the status flags of all of the
-     * contained Link State Advertisements to LSA_SPF_NOT_EXPLORED.  This is done
-     * prior to each SPF calculation to reset the state of the SPFVertex structures
-     * that will reference the LSAs during the calculation.
+     * contained Link State Advertisements to LSA_SPF_NOT_EXPLORED.  The SPF
+     * calculations of GlobalRouteManagerImpl do not use these flags: they keep
+     * the status of the LSAs themselves, so that several calculations can share
+     * the database.
      *
      * @see GlobalRoutingLSA
      * @see SPFVertex
@@ -672,6 +679,31 @@ class GlobalRouteManagerLSDB
      */
     uint32_t GetNumExtLSAs() const;
 
+    /**
+     * @brief Get the Link State Advertisements of the database, except the
+     * External ones, in the order of their Link State ID.
+     *
+     * @see GlobalRoutingLSA
+     * @returns the Link State Advertisements.
+     */
+    std::vector<GlobalRoutingLSA*> GetLSAs() const;
+
+    /**
+     * @brief Get the routers whose routes may differ when they are computed
+     * from this Link State Database and from another one.
+     *
+     * The routes of a router depend on all the Link State Advertisements it
+     * is connected to.  A router is thus affected if it is connected, in
+     * either database, to an LSA which is not in both databases or which
+     * differs between them.  All the routers are affected if the External
+     * Link State Advertisements differ.
+     *
+     * @param lsdb the other Link State Database
+     * @returns the IDs of the affected routers of both databases
+     */
+    std::unordered_set<Ipv4Address, Ipv4AddressHash> GetAffectedRouters(
+        const GlobalRouteManagerLSDB& lsdb) const;
+
   private:
     typedef std::map<Ipv4Address, GlobalRoutingLSA*>
         LSDBMap_t; //!< container of IPv4 addresses / Link State Advertisements
@@ -681,6 +713,8 @@ class GlobalRouteManagerLSDB
     LSDBMap_t m_database; //!< database of IPv4 addresses / Link State Advertisements
     std::vector<GlobalRoutingLSA*>
         m_extdatabase; //!< database of External Link State Advertisements
+    std::unordered_map<Ipv4Address, GlobalRoutingLSA*, Ipv4AddressHash>
+        m_linkDataIndex; //!< LSAs by the link data of their TransitNetwork link records
 };
 
 /**
@@ -725,6 +759,35 @@ class GlobalRouteManagerImpl
      */
     virtual void InitializeRoutes();
 
+    /**
+     * @brief Rebuild the routing database, and compute again the routes of the
+     * routers affected by the changes since the database was last built.
+     *
+     * This is equivalent to calling DeleteGlobalRoutes (),
+     * BuildGlobalRoutingDatabase () and InitializeRoutes (), except that the
+     * routes of the routers that are not connected to any changed Link State
+     * Advertisement are kept as they are.
+     */
+    virtual void RecomputeRoutes();
+
+    /**
+     * @brief Set the number of threads computing the routes of the routers
+     *
+     * The routes are computed by a single thread unless built with NS3_MTP.
+     *
+     * @param threads the number of threads
+     */
+    void SetNumThreads(uint32_t threads);
+
+    /**
+     * @brief Compute the next hops of all the routers to all the destinations
+     * from the routing database, and store them in a next hop table instead of
+     * the per-node forwarding tables.
+     *
+     * @param table the next hop table, whose previous content is removed
+     */
+    void ComputeNextHopTable(Ptr<Ipv4NextHopTable> table);
+
     /**
      * @brief Debugging routine; allow client code to supply a pre-built LSDB
      * @param lsdb the pre-built LSDB
@@ -738,8 +801,98 @@ class GlobalRouteManagerImpl
     void DebugSPFCalculate(Ipv4Address root);
 
   private:
+    /// A router at the root of the SPF calculations
+    struct SPFRoot
+    {
+        Ipv4Address routerId;           //!< the router ID
+        Ptr<Node> node;                 //!< the node
+        Ptr<Ipv4> ipv4;                 //!< the IPv4 stack of the node
+        Ptr<Ipv4GlobalRouting> routing; //!< the global routing protocol of the node
+        Ptr<Ipv4NextHopTable> table;    //!< the next hop table to fill instead, if any
+    };
+
+    /**
+     * \brief Construct a Global Route Manager computing the routes from the
+     * LSDB of another one
+     *
+     * \param lsdb the LSDB, which is not owned
+     */
+    GlobalRouteManagerImpl(GlobalRouteManagerLSDB* lsdb);
+
     SPFVertex* m_spfroot;           //!< the root node
     GlobalRouteManagerLSDB* m_lsdb; //!< the Link State DataBase (LSDB) of the Global Route Manager
+    bool m_ownsLsdb;                //!< whether the LSDB is deleted with the manager
+    SPFRoot m_root;                 //!< the router at the root of the SPF calculation
+    std::unordered_map<const GlobalRoutingLSA*, GlobalRoutingLSA::SPFStatus>
+        m_lsaStatus;    //!< status of the LSAs in the SPF calculation, if not LSA_SPF_NOT_EXPLORED
+    uint32_t m_threads; //!< number of threads computing the routes
+
+    /**
+     * \brief Get the routers for which routes are computed, i.e., the nodes of
+     * this system that export Link State Advertisements.
+     *
+     * \returns the routers
+     */
+    std::vector<SPFRoot> GetSPFRoots() const;
+
+    /**
+     * \brief Compute the routes of some routers, on m_threads threads.
+     *
+     * \param roots the routers
+     */
+    void SPFCalculate(const std::vector<SPFRoot>& roots);
+
+    /**
+     * \brief Delete all the routes of a router.
+     *
+     * \param routing the global routing protocol of the router
+     */
+    static void DeleteGlobalRoutes(Ptr<Ipv4GlobalRouting> routing);
+
+    /**
+     * \brief Add a host route to the router in m_root.
+     *
+     * \param dest the destination address
+     * \param nextHop the next hop
+     * \param outIf the output interface
+     */
+    void AddHostRoute(Ipv4Address dest, Ipv4Address nextHop, uint32_t outIf);
+
+    /**
+     * \brief Add a network route to the router in m_root.
+     *
+     * \param network the destination network
+     * \param mask the mask of the destination network
+     * \param nextHop the next hop
+     * \param outIf the output interface
+     */
+    void AddNetworkRoute(Ipv4Address network, Ipv4Mask mask, Ipv4Address nextHop, uint32_t outIf);
+
+    /**
+     * \brief Add an AS external route to the router in m_root.
+     *
+     * \param network the destination network
+     * \param mask the mask of the destination network
+     * \param nextHop the next hop
+     * \param outIf the output interface
+     */
+    void AddASExternalRoute(Ipv4Address network,
+                            Ipv4Mask mask,
+                            Ipv4Address nextHop,
+                            uint32_t outIf);
+
+    /**
+     * \param lsa an LSA
+     * \returns the status of the LSA in the SPF calculation
+     */
+    GlobalRoutingLSA::SPFStatus GetStatus(const GlobalRoutingLSA* lsa) const;
+
+    /**
+     * \brief Set the status of an LSA in the SPF calculation
+     * \param lsa the LSA
+     * \param status the status
+     */
+    void SetStatus(const GlobalRoutingLSA* lsa, GlobalRoutingLSA::SPFStatus status);
 
     /**
      * \brief Test if a node is a stub, from an OSPF sense.
@@ -761,6 +914,11 @@ class GlobalRouteManagerImpl
      */
     void SPFCalculate(Ipv4Address root);
 
+    /**
+     * \brief Calculate the shortest path first (SPF) tree of the router in m_root
+     */
+    void SPFCalculate();
+
     /**
      * \brief Process Stub nodes
      *
@@ -20,6 +20,7 @@
 #include "global-route-manager.h"
 
 #include "global-route-manager-impl.h"
+#include "ipv4-next-hop-table.h"
 
 #include "ns3/assert.h"
 #include "ns3/log.h"
@@ -57,6 +58,27 @@ GlobalRouteManager::InitializeRoutes()
     SimulationSingleton<GlobalRouteManagerImpl>::Get()->InitializeRoutes();
 }
 
+void
+GlobalRouteManager::RecomputeRoutes()
+{
+    NS_LOG_FUNCTION_NOARGS();
+    SimulationSingleton<GlobalRouteManagerImpl>::Get()->RecomputeRoutes();
+}
+
+void
+GlobalRouteManager::SetNumThreads(uint32_t threads)
+{
+    NS_LOG_FUNCTION(threads);
+    SimulationSingleton<GlobalRouteManagerImpl>::Get()->SetNumThreads(threads);
+}
+
+void
+GlobalRouteManager::ComputeNextHopTable(Ptr<Ipv4NextHopTable> table)
+{
+    NS_LOG_FUNCTION(table);
+    SimulationSingleton<GlobalRouteManagerImpl>::Get()->ComputeNextHopTable(table);
+}
+
 uint32_t
 GlobalRouteManager::AllocateRouterId()
 {
@@ -21,11 +21,15 @@
 #ifndef GLOBAL_ROUTE_MANAGER_H
 #define GLOBAL_ROUTE_MANAGER_H
 
+#include "ns3/ptr.h"
+
 #include <cstdint>
 
 namespace ns3
 {
 
+class Ipv4NextHopTable;
+
 /**
  * \ingroup globalrouting
  *
@@ -70,6 +74,39 @@ class GlobalRouteManager
      * per-node forwarding tables
      */
     static void InitializeRoutes();
+
+    /**
+     * @brief Rebuild the routing database, and compute again the routes of
+     * the routers affected by the changes since it was last built.
+     *
+     * This is equivalent to calling DeleteGlobalRoutes (),
+     * BuildGlobalRoutingDatabase () and InitializeRoutes (), except that the
+     * routes of the routers that are not connected to a changed part of the
+     * topology are kept.
+     */
+    static void RecomputeRoutes();
+
+    /**
+     * @brief Set the number of threads computing the routes of the routers.
+     *
+     * The routes of several routers are only computed concurrently when
+     * built with NS3_MTP; otherwise a single thread is used.  The default is
+     * a single thread.
+     *
+     * @param threads the number of threads
+     */
+    static void SetNumThreads(uint32_t threads);
+
+    /**
+     * @brief Compute the next hops of all the routers from the routing
+     * database, and store them in a next hop table instead of the per-node
+     * forwarding tables.
+     *
+     * BuildGlobalRoutingDatabase () must be called first.
+     *
+     * @param table the next hop table, whose previous content is removed
+     */
+    static void ComputeNextHopTable(Ptr<Ipv4NextHopTable> table);
 };
 
 } // namespace ns3
@@ -24,6 +24,8 @@
 
 #include "ns3/log.h"
 
+#include <algorithm>
+
 namespace ns3
 {
 
@@ -49,27 +51,133 @@ Ipv4EndPointDemux::~Ipv4EndPointDemux()
 }
 
 bool
-Ipv4EndPointDemux::LookupPortLocal(uint16_t port)
+Ipv4EndPointDemux::FourTuple::operator==(const FourTuple& other) const
 {
-    NS_LOG_FUNCTION(this << port);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    return localAddress == other.localAddress && peerAddress == other.peerAddress &&
+           localPort == other.localPort && peerPort == other.peerPort;
+}
+
+std::size_t
+Ipv4EndPointDemux::FourTupleHash::operator()(const FourTuple& tuple) const
+{
+    Ipv4AddressHash addressHash;
+    std::size_t hash = addressHash(tuple.localAddress);
+    hash = hash * 1000003 ^ addressHash(tuple.peerAddress);
+    hash = hash * 1000003 ^ ((static_cast<std::size_t>(tuple.localPort) << 16) | tuple.peerPort);
+    return hash;
+}
+
+Ipv4EndPointDemux::FourTuple
+Ipv4EndPointDemux::GetFourTuple(Ipv4EndPoint* endPoint)
+{
+    return {endPoint->GetLocalAddress(),
+            endPoint->GetPeerAddress(),
+            endPoint->GetLocalPort(),
+            endPoint->GetPeerPort()};
+}
+
+bool
+Ipv4EndPointDemux::IsWildcard(const FourTuple& tuple)
+{
+    return tuple.localAddress == Ipv4Address::GetAny() ||
+           tuple.peerAddress == Ipv4Address::GetAny() || tuple.peerPort == 0;
+}
+
+void
+Ipv4EndPointDemux::Register(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    Position& position = m_positions[endPoint];
+    position.endPoint = m_endPoints.insert(m_endPoints.end(), endPoint);
+    uint16_t localPort = endPoint->GetLocalPort();
+    EndPoints& portEndPoints = m_ports[localPort].endPoints;
+    if (portEndPoints.empty())
     {
-        if ((*i)->GetLocalPort() == port)
+        SetEphemeralPortUsed(localPort, true);
+    }
+    position.port = portEndPoints.insert(portEndPoints.end(), endPoint);
+    endPoint->m_demux = this;
+    Index(endPoint);
+}
+
+void
+Ipv4EndPointDemux::Unregister(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    Unindex(endPoint);
+    endPoint->m_demux = nullptr;
+    auto position = m_positions.find(endPoint);
+    uint16_t localPort = endPoint->GetLocalPort();
+    auto port = m_ports.find(localPort);
+    port->second.endPoints.erase(position->second.port);
+    if (port->second.endPoints.empty())
+    {
+        m_ports.erase(port);
+        SetEphemeralPortUsed(localPort, false);
+    }
+    m_endPoints.erase(position->second.endPoint);
+    m_positions.erase(position);
+}
+
+void
+Ipv4EndPointDemux::Index(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    Position& position = m_positions.find(endPoint)->second;
+    FourTuple tuple = GetFourTuple(endPoint);
+    position.isWildcard = IsWildcard(tuple);
+    if (position.isWildcard)
+    {
+        EndPoints& wildcards = m_ports.find(tuple.localPort)->second.wildcards;
+        position.wildcard = wildcards.insert(wildcards.end(), endPoint);
+    }
+    else
+    {
+        m_fourTuples.emplace(tuple, endPoint);
+    }
+}
+
+void
+Ipv4EndPointDemux::Unindex(Ipv4EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    const Position& position = m_positions.find(endPoint)->second;
+    if (position.isWildcard)
+    {
+        m_ports.find(endPoint->GetLocalPort())->second.wildcards.erase(position.wildcard);
+        return;
+    }
+    auto range = m_fourTuples.equal_range(GetFourTuple(endPoint));
+    for (auto i = range.first; i != range.second; i++)
+    {
+        if (i->second == endPoint)
         {
-            return true;
+            m_fourTuples.erase(i);
+            return;
         }
     }
-    return false;
+    NS_ASSERT_MSG(false, "Endpoint " << endPoint << " not found in the four-tuple table");
+}
+
+bool
+Ipv4EndPointDemux::LookupPortLocal(uint16_t port)
+{
+    NS_LOG_FUNCTION(this << port);
+    return m_ports.find(port) != m_ports.end();
 }
 
 bool
 Ipv4EndPointDemux::LookupLocal(Ptr<NetDevice> boundNetDevice, Ipv4Address addr, uint16_t port)
 {
     NS_LOG_FUNCTION(this << addr << port);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto portI = m_ports.find(port);
+    if (portI == m_ports.end())
+    {
+        return false;
+    }
+    for (Ipv4EndPoint* endPoint : portI->second.endPoints)
     {
-        if ((*i)->GetLocalPort() == port && (*i)->GetLocalAddress() == addr &&
-            (*i)->GetBoundNetDevice() == boundNetDevice)
+        if (endPoint->GetLocalAddress() == addr && endPoint->GetBoundNetDevice() == boundNetDevice)
         {
             return true;
         }
@@ -88,7 +196,7 @@ Ipv4EndPointDemux::Allocate()
         return nullptr;
     }
     Ipv4EndPoint* endPoint = new Ipv4EndPoint(Ipv4Address::GetAny(), port);
-    m_endPoints.push_back(endPoint);
+    Register(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -104,7 +212,7 @@ Ipv4EndPointDemux::Allocate(Ipv4Address address)
         return nullptr;
     }
     Ipv4EndPoint* endPoint = new Ipv4EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
+    Register(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -127,7 +235,7 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice, Ipv4Address address,
         return nullptr;
     }
     Ipv4EndPoint* endPoint = new Ipv4EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
+    Register(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -140,11 +248,24 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
                             uint16_t peerPort)
 {
     NS_LOG_FUNCTION(this << localAddress << localPort << peerAddress << peerPort << boundNetDevice);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    FourTuple tuple{localAddress, peerAddress, localPort, peerPort};
+    EndPoints candidates;
+    if (!IsWildcard(tuple))
     {
-        if ((*i)->GetLocalPort() == localPort && (*i)->GetLocalAddress() == localAddress &&
-            (*i)->GetPeerPort() == peerPort && (*i)->GetPeerAddress() == peerAddress &&
-            ((*i)->GetBoundNetDevice() == boundNetDevice || !(*i)->GetBoundNetDevice()))
+        auto range = m_fourTuples.equal_range(tuple);
+        for (auto i = range.first; i != range.second; i++)
+        {
+            candidates.push_back(i->second);
+        }
+    }
+    else if (auto port = m_ports.find(localPort); port != m_ports.end())
+    {
+        candidates = port->second.wildcards;
+    }
+    for (Ipv4EndPoint* endP : candidates)
+    {
+        if (GetFourTuple(endP) == tuple &&
+            (endP->GetBoundNetDevice() == boundNetDevice || !endP->GetBoundNetDevice()))
         {
             NS_LOG_WARN("Duplicated endpoint.");
             return nullptr;
@@ -152,7 +273,7 @@ Ipv4EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
     }
     Ipv4EndPoint* endPoint = new Ipv4EndPoint(localAddress, localPort);
     endPoint->SetPeer(peerAddress, peerPort);
-    m_endPoints.push_back(endPoint);
+    Register(endPoint);
 
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
 
@@ -163,14 +284,10 @@ void
 Ipv4EndPointDemux::DeAllocate(Ipv4EndPoint* endPoint)
 {
     NS_LOG_FUNCTION(this << endPoint);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    if (m_positions.find(endPoint) != m_positions.end())
     {
-        if (*i == endPoint)
-        {
-            delete endPoint;
-            m_endPoints.erase(i);
-            break;
-        }
+        Unregister(endPoint);
+        delete endPoint;
     }
 }
 
@@ -191,6 +308,139 @@ Ipv4EndPointDemux::GetAllEndPoints()
     return ret;
 }
 
+void
+Ipv4EndPointDemux::Match(Ipv4EndPoint* endP,
+                         Ipv4Address daddr,
+                         uint16_t dport,
+                         Ipv4Address saddr,
+                         uint16_t sport,
+                         Ptr<Ipv4Interface> incomingInterface,
+                         EndPoints& retval1,
+                         EndPoints& retval2,
+                         EndPoints& retval3,
+                         EndPoints& retval4)
+{
+    NS_LOG_DEBUG("Looking at endpoint dport="
+                 << endP->GetLocalPort() << " daddr=" << endP->GetLocalAddress()
+                 << " sport=" << endP->GetPeerPort() << " saddr=" << endP->GetPeerAddress());
+
+    if (!endP->IsRxEnabled())
+    {
+        NS_LOG_LOGIC("Skipping endpoint " << &endP << " because endpoint can not receive packets");
+        return;
+    }
+
+    if (endP->GetLocalPort() != dport)
+    {
+        NS_LOG_LOGIC("Skipping endpoint " << &endP << " because endpoint dport "
+                                          << endP->GetLocalPort()
+                                          << " does not match packet dport " << dport);
+        return;
+    }
+    if (endP->GetBoundNetDevice())
+    {
+        if (endP->GetBoundNetDevice() != incomingInterface->GetDevice())
+        {
+            NS_LOG_LOGIC("Skipping endpoint "
+                         << &endP << " because endpoint is bound to specific device and"
+                         << endP->GetBoundNetDevice() << " does not match packet device "
+                         << incomingInterface->GetDevice());
+            return;
+        }
+    }
+
+    bool localAddressMatchesExact = false;
+    bool localAddressIsAny = false;
+    bool localAddressIsSubnetAny = false;
+
+    // We have 3 cases:
+    // 1) Exact local / destination address match
+    // 2) Local endpoint bound to Any -> matches anything
+    // 3) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g.,
+    // x.y.z.255 in a /24 net) and direct destination match.
+
+    if (endP->GetLocalAddress() == daddr)
+    {
+        // Case 1:
+        localAddressMatchesExact = true;
+    }
+    else if (endP->GetLocalAddress() == Ipv4Address::GetAny())
+    {
+        // Case 2:
+        localAddressIsAny = true;
+    }
+    else
+    {
+        // Case 3:
+        for (uint32_t i = 0; i < incomingInterface->GetNAddresses(); i++)
+        {
+            Ipv4InterfaceAddress addr = incomingInterface->GetAddress(i);
+
+            Ipv4Address addrNetpart = addr.GetLocal().CombineMask(addr.GetMask());
+            if (endP->GetLocalAddress() == addrNetpart)
+            {
+                NS_LOG_LOGIC("Endpoint is SubnetDirectedAny " << endP->GetLocalAddress() << "/"
+                                                              << addr.GetMask().GetPrefixLength());
+
+                Ipv4Address daddrNetPart = daddr.CombineMask(addr.GetMask());
+                if (addrNetpart == daddrNetPart)
+                {
+                    localAddressIsSubnetAny = true;
+                }
+            }
+        }
+
+        // if no match here, keep looking
+        if (!localAddressIsSubnetAny)
+        {
+            return;
+        }
+    }
+
+    bool remotePortMatchesExact = endP->GetPeerPort() == sport;
+    bool remotePortMatchesWildCard = endP->GetPeerPort() == 0;
+    bool remoteAddressMatchesExact = endP->GetPeerAddress() == saddr;
+    bool remoteAddressMatchesWildCard = endP->GetPeerAddress() == Ipv4Address::GetAny();
+
+    // If remote does not match either with exact or wildcard,
+    // skip this one
+    if (!(remotePortMatchesExact || remotePortMatchesWildCard))
+    {
+        return;
+    }
+    if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
+    {
+        return;
+    }
+
+    bool localAddressMatchesWildCard = localAddressIsAny || localAddressIsSubnetAny;
+
+    if (localAddressMatchesExact && remoteAddressMatchesExact && remotePortMatchesExact)
+    { // All 4 match - this is the case of an open TCP connection, for example.
+        NS_LOG_LOGIC("Found an endpoint for case 4, adding " << endP->GetLocalAddress() << ":"
+                                                             << endP->GetLocalPort());
+        retval4.push_back(endP);
+    }
+    if (localAddressMatchesWildCard && remoteAddressMatchesExact && remotePortMatchesExact)
+    { // All but local address - no idea what this case could be.
+        NS_LOG_LOGIC("Found an endpoint for case 3, adding " << endP->GetLocalAddress() << ":"
+                                                             << endP->GetLocalPort());
+        retval3.push_back(endP);
+    }
+    if (localAddressMatchesExact && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
+    { // Only local port and local address matches exactly - Not yet opened connection
+        NS_LOG_LOGIC("Found an endpoint for case 2, adding " << endP->GetLocalAddress() << ":"
+                                                             << endP->GetLocalPort());
+        retval2.push_back(endP);
+    }
+    if (localAddressMatchesWildCard && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
+    { // Only local port matches exactly - Endpoint open to "any" connection
+        NS_LOG_LOGIC("Found an endpoint for case 1, adding " << endP->GetLocalAddress() << ":"
+                                                             << endP->GetLocalPort());
+        retval1.push_back(endP);
+    }
+}
+
 /*
  * If we have an exact match, we return it.
  * Otherwise, if we find a generic match, we return it.
@@ -211,133 +461,61 @@ Ipv4EndPointDemux::Lookup(Ipv4Address daddr,
     EndPoints retval4; // Exact match on all 4
 
     NS_LOG_DEBUG("Looking up endpoint for destination address " << daddr << ":" << dport);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto port = m_ports.find(dport);
+    if (port == m_ports.end())
     {
-        Ipv4EndPoint* endP = *i;
-
-        NS_LOG_DEBUG("Looking at endpoint dport="
-                     << endP->GetLocalPort() << " daddr=" << endP->GetLocalAddress()
-                     << " sport=" << endP->GetPeerPort() << " saddr=" << endP->GetPeerAddress());
-
-        if (!endP->IsRxEnabled())
-        {
-            NS_LOG_LOGIC("Skipping endpoint " << &endP
-                                              << " because endpoint can not receive packets");
-            continue;
-        }
-
-        if (endP->GetLocalPort() != dport)
-        {
-            NS_LOG_LOGIC("Skipping endpoint " << &endP << " because endpoint dport "
-                                              << endP->GetLocalPort()
-                                              << " does not match packet dport " << dport);
-            continue;
-        }
-        if (endP->GetBoundNetDevice())
-        {
-            if (endP->GetBoundNetDevice() != incomingInterface->GetDevice())
-            {
-                NS_LOG_LOGIC("Skipping endpoint "
-                             << &endP << " because endpoint is bound to specific device and"
-                             << endP->GetBoundNetDevice() << " does not match packet device "
-                             << incomingInterface->GetDevice());
-                continue;
-            }
-        }
-
-        bool localAddressMatchesExact = false;
-        bool localAddressIsAny = false;
-        bool localAddressIsSubnetAny = false;
-
-        // We have 3 cases:
-        // 1) Exact local / destination address match
-        // 2) Local endpoint bound to Any -> matches anything
-        // 3) Local endpoint bound to x.y.z.0 -> matches Subnet-directed broadcast packet (e.g.,
-        // x.y.z.255 in a /24 net) and direct destination match.
+        NS_LOG_LOGIC("No endpoint on port " << dport);
+        return retval1;
+    }
 
-        if (endP->GetLocalAddress() == daddr)
-        {
-            // Case 1:
-            localAddressMatchesExact = true;
-        }
-        else if (endP->GetLocalAddress() == Ipv4Address::GetAny())
-        {
-            // Case 2:
-            localAddressIsAny = true;
-        }
-        else
+    // The endpoints without wildcard can only match the packet on their
+    // four-tuple, with the destination address or with the network part of
+    // an address of the incoming interface (subnet-directed broadcast).
+    std::vector<Ipv4Address> localAddresses(1, daddr);
+    if (incomingInterface)
+    {
+        for (uint32_t i = 0; i < incomingInterface->GetNAddresses(); i++)
         {
-            // Case 3:
-            for (uint32_t i = 0; i < incomingInterface->GetNAddresses(); i++)
-            {
-                Ipv4InterfaceAddress addr = incomingInterface->GetAddress(i);
-
-                Ipv4Address addrNetpart = addr.GetLocal().CombineMask(addr.GetMask());
-                if (endP->GetLocalAddress() == addrNetpart)
-                {
-                    NS_LOG_LOGIC("Endpoint is SubnetDirectedAny "
-                                 << endP->GetLocalAddress() << "/"
-                                 << addr.GetMask().GetPrefixLength());
-
-                    Ipv4Address daddrNetPart = daddr.CombineMask(addr.GetMask());
-                    if (addrNetpart == daddrNetPart)
-                    {
-                        localAddressIsSubnetAny = true;
-                    }
-                }
-            }
-
-            // if no match here, keep looking
-            if (!localAddressIsSubnetAny)
+            Ipv4InterfaceAddress addr = incomingInterface->GetAddress(i);
+            Ipv4Address addrNetpart = addr.GetLocal().CombineMask(addr.GetMask());
+            if (addrNetpart == daddr.CombineMask(addr.GetMask()) &&
+                std::find(localAddresses.begin(), localAddresses.end(), addrNetpart) ==
+                    localAddresses.end())
             {
-                continue;
+                localAddresses.push_back(addrNetpart);
             }
         }
-
-        bool remotePortMatchesExact = endP->GetPeerPort() == sport;
-        bool remotePortMatchesWildCard = endP->GetPeerPort() == 0;
-        bool remoteAddressMatchesExact = endP->GetPeerAddress() == saddr;
-        bool remoteAddressMatchesWildCard = endP->GetPeerAddress() == Ipv4Address::GetAny();
-
-        // If remote does not match either with exact or wildcard,
-        // skip this one
-        if (!(remotePortMatchesExact || remotePortMatchesWildCard))
-        {
-            continue;
-        }
-        if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
+    }
+    for (const Ipv4Address& localAddress : localAddresses)
+    {
+        auto range = m_fourTuples.equal_range({localAddress, saddr, dport, sport});
+        for (auto i = range.first; i != range.second; i++)
         {
-            continue;
-        }
-
-        bool localAddressMatchesWildCard = localAddressIsAny || localAddressIsSubnetAny;
-
-        if (localAddressMatchesExact && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All 4 match - this is the case of an open TCP connection, for example.
-            NS_LOG_LOGIC("Found an endpoint for case 4, adding " << endP->GetLocalAddress() << ":"
-                                                                 << endP->GetLocalPort());
-            retval4.push_back(endP);
-        }
-        if (localAddressMatchesWildCard && remoteAddressMatchesExact && remotePortMatchesExact)
-        { // All but local address - no idea what this case could be.
-            NS_LOG_LOGIC("Found an endpoint for case 3, adding " << endP->GetLocalAddress() << ":"
-                                                                 << endP->GetLocalPort());
-            retval3.push_back(endP);
-        }
-        if (localAddressMatchesExact && remoteAddressMatchesWildCard && remotePortMatchesWildCard)
-        { // Only local port and local address matches exactly - Not yet opened connection
-            NS_LOG_LOGIC("Found an endpoint for case 2, adding " << endP->GetLocalAddress() << ":"
-                                                                 << endP->GetLocalPort());
-            retval2.push_back(endP);
-        }
-        if (localAddressMatchesWildCard && remoteAddressMatchesWildCard &&
-            remotePortMatchesWildCard)
-        { // Only local port matches exactly - Endpoint open to "any" connection
-            NS_LOG_LOGIC("Found an endpoint for case 1, adding " << endP->GetLocalAddress() << ":"
-                                                                 << endP->GetLocalPort());
-            retval1.push_back(endP);
+            Match(i->second,
+                  daddr,
+                  dport,
+                  saddr,
+                  sport,
+                  incomingInterface,
+                  retval1,
+                  retval2,
+                  retval3,
+                  retval4);
         }
     }
+    for (Ipv4EndPoint* endP : port->second.wildcards)
+    {
+        Match(endP,
+              daddr,
+              dport,
+              saddr,
+              sport,
+              incomingInterface,
+              retval1,
+              retval2,
+              retval3,
+              retval4);
+    }
 
     // Here we find the most exact match
     EndPoints retval;
@@ -372,16 +550,18 @@ Ipv4EndPointDemux::SimpleLookup(Ipv4Address daddr,
 {
     NS_LOG_FUNCTION(this << daddr << dport << saddr << sport);
 
+    auto port = m_ports.find(dport);
+    if (port == m_ports.end())
+    {
+        return nullptr;
+    }
+
     // this code is a copy/paste version of an old BSD ip stack lookup
     // function.
     uint32_t genericity = 3;
     Ipv4EndPoint* generic = nullptr;
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    for (EndPointsI i = port->second.endPoints.begin(); i != port->second.endPoints.end(); i++)
     {
-        if ((*i)->GetLocalPort() != dport)
-        {
-            continue;
-        }
         if ((*i)->GetLocalAddress() == daddr && (*i)->GetPeerPort() == sport &&
             (*i)->GetPeerAddress() == saddr)
         {
@@ -406,27 +586,68 @@ Ipv4EndPointDemux::SimpleLookup(Ipv4Address daddr,
     return generic;
 }
 
+void
+Ipv4EndPointDemux::SetEphemeralPortUsed(uint16_t port, bool used)
+{
+    if (m_usedEphemeralPorts.empty() || port < m_portFirst || port > m_portLast)
+    {
+        return;
+    }
+    uint32_t offset = port - m_portFirst;
+    uint64_t bit = uint64_t(1) << (offset % 64);
+    if (used)
+    {
+        m_usedEphemeralPorts[offset / 64] |= bit;
+    }
+    else
+    {
+        m_usedEphemeralPorts[offset / 64] &= ~bit;
+    }
+}
+
 uint16_t
 Ipv4EndPointDemux::AllocateEphemeralPort()
 {
     // Similar to counting up logic in netinet/in_pcb.c
     NS_LOG_FUNCTION(this);
-    uint16_t port = m_ephemeral;
-    int count = m_portLast - m_portFirst;
-    do
+    uint32_t nPorts = m_portLast - m_portFirst + 1;
+    if (m_usedEphemeralPorts.empty())
     {
-        if (count-- < 0)
+        m_usedEphemeralPorts.resize((nPorts + 63) / 64, 0);
+        for (const auto& port : m_ports)
         {
-            return 0;
+            SetEphemeralPortUsed(port.first, true);
         }
-        ++port;
-        if (port < m_portFirst || port > m_portLast)
+    }
+    uint32_t start = m_ephemeral + 1;
+    if (start < m_portFirst || start > m_portLast)
+    {
+        start = m_portFirst;
+    }
+    // Search from the port after the last allocated one up to the last port,
+    // then from the first port, skipping the words of used ports
+    uint32_t first = start - m_portFirst;
+    for (uint32_t pass = 0; pass < 2; pass++)
+    {
+        uint32_t offset = pass == 0 ? first : 0;
+        uint32_t end = pass == 0 ? nPorts : first;
+        while (offset < end)
         {
-            port = m_portFirst;
+            uint64_t word = m_usedEphemeralPorts[offset / 64];
+            if (offset % 64 == 0 && offset + 64 <= end && word == ~uint64_t(0))
+            {
+                offset += 64;
+                continue;
+            }
+            if (!(word & (uint64_t(1) << (offset % 64))))
+            {
+                m_ephemeral = m_portFirst + offset;
+                return m_ephemeral;
+            }
+            offset++;
         }
-    } while (LookupPortLocal(port));
-    m_ephemeral = port;
-    return port;
+    }
+    return 0;
 }
 
 } // namespace ns3
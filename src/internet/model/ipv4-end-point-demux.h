@@ -26,6 +26,8 @@
 
 #include <list>
 #include <stdint.h>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -42,6 +44,12 @@ class Ipv4EndPoint;
  * of endpoints, and has APIs to add and find endpoints in this demux.  This
  * code is shared in common to TCP and UDP protocols in ns3.  This demux
  * sits between ns3's layer four and the socket layer
+ *
+ * The endpoints whose local address, peer address and peer port are all
+ * specified (e.g., the TCP connections) are indexed by their four-tuple in a
+ * hash table, and the other ones (e.g., the listening sockets) are listed by
+ * local port, so that a lookup does not depend on the number of connections.
+ * The endpoints notify their demux when their addresses change.
  */
 
 class Ipv4EndPointDemux
@@ -171,6 +179,119 @@ class Ipv4EndPointDemux
     void DeAllocate(Ipv4EndPoint* endPoint);
 
   private:
+    friend class Ipv4EndPoint;
+
+    /// The four-tuple of an endpoint
+    struct FourTuple
+    {
+        Ipv4Address localAddress; //!< the local address
+        Ipv4Address peerAddress;  //!< the peer address
+        uint16_t localPort;       //!< the local port
+        uint16_t peerPort;        //!< the peer port
+
+        /**
+         * \param other another four-tuple
+         * \return true if the four-tuples are equal
+         */
+        bool operator==(const FourTuple& other) const;
+    };
+
+    /// Hash function of the four-tuples
+    struct FourTupleHash
+    {
+        /**
+         * \param tuple a four-tuple
+         * \return the hash of the four-tuple
+         */
+        std::size_t operator()(const FourTuple& tuple) const;
+    };
+
+    /// The endpoints bound to a local port
+    struct Port
+    {
+        EndPoints endPoints; //!< all the endpoints, in allocation order
+        EndPoints wildcards; //!< the endpoints which are not in the four-tuple table
+    };
+
+    /// The positions of an endpoint in the lists of the demux
+    struct Position
+    {
+        EndPointsI endPoint; //!< the position in the list of all the endpoints
+        EndPointsI port;     //!< the position in the list of the endpoints of the port
+        EndPointsI wildcard; //!< the position in the wildcards of the port, if a wildcard
+        bool isWildcard;     //!< whether the endpoint is not in the four-tuple table
+    };
+
+    /**
+     * \param endPoint an endpoint
+     * \return the four-tuple of the endpoint
+     */
+    static FourTuple GetFourTuple(Ipv4EndPoint* endPoint);
+
+    /**
+     * \param tuple a four-tuple
+     * \return true if a field of the four-tuple is a wildcard
+     */
+    static bool IsWildcard(const FourTuple& tuple);
+
+    /**
+     * \brief Add an endpoint to the lists of the demux.
+     * \param endPoint the endpoint
+     */
+    void Register(Ipv4EndPoint* endPoint);
+
+    /**
+     * \brief Remove an endpoint from the lists of the demux.
+     * \param endPoint the endpoint
+     */
+    void Unregister(Ipv4EndPoint* endPoint);
+
+    /**
+     * \brief Add an endpoint to the four-tuple table or to the wildcards of
+     * its port, according to its current four-tuple.
+     * \param endPoint the endpoint
+     */
+    void Index(Ipv4EndPoint* endPoint);
+
+    /**
+     * \brief Remove an endpoint from the four-tuple table or from the
+     * wildcards of its port, before its four-tuple changes.
+     * \param endPoint the endpoint
+     */
+    void Unindex(Ipv4EndPoint* endPoint);
+
+    /**
+     * \brief Add an endpoint to the list of its match with a packet, if any.
+     *
+     * \param endP the endpoint
+     * \param daddr destination address to test
+     * \param dport destination port to test
+     * \param saddr source address to test
+     * \param sport source port to test
+     * \param incomingInterface the incoming interface
+     * \param retval1 the endpoints matching on the local port only
+     * \param retval2 the endpoints matching on the local port and address only
+     * \param retval3 the endpoints matching on all but the local address
+     * \param retval4 the endpoints matching on all the four-tuple
+     */
+    void Match(Ipv4EndPoint* endP,
+               Ipv4Address daddr,
+               uint16_t dport,
+               Ipv4Address saddr,
+               uint16_t sport,
+               Ptr<Ipv4Interface> incomingInterface,
+               EndPoints& retval1,
+               EndPoints& retval2,
+               EndPoints& retval3,
+               EndPoints& retval4);
+
+    /**
+     * \brief Mark an ephemeral port as used or free.
+     * \param port the port (nothing is done outside of the ephemeral ports)
+     * \param used whether the port is used
+     */
+    void SetEphemeralPortUsed(uint16_t port, bool used);
+
     /**
      * \brief Allocate an ephemeral port.
      * \returns the ephemeral port
@@ -196,6 +317,27 @@ class Ipv4EndPointDemux
      * \brief A list of IPv4 end points.
      */
     EndPoints m_endPoints;
+
+    /**
+     * \brief The endpoints of each local port in use.
+     */
+    std::unordered_map<uint16_t, Port> m_ports;
+
+    /**
+     * \brief The endpoints whose four-tuple has no wildcard.
+     */
+    std::unordered_multimap<FourTuple, Ipv4EndPoint*, FourTupleHash> m_fourTuples;
+
+    /**
+     * \brief The positions of the endpoints in the lists.
+     */
+    std::unordered_map<Ipv4EndPoint*, Position> m_positions;
+
+    /**
+     * \brief The bitmap of the used ephemeral ports, allocated at the first
+     * ephemeral port allocation.
+     */
+    std::vector<uint64_t> m_usedEphemeralPorts;
 };
 
 } // namespace ns3
@@ -31,6 +31,8 @@
 namespace ns3
 {
 
+class Ipv4EndPointDemux;
+
 class Header;
 class Packet;
 
@@ -190,6 +192,13 @@ class Ipv4EndPoint
     bool IsRxEnabled();
 
   private:
+    friend class Ipv4EndPointDemux;
+
+    /**
+     * \brief The demux the endpoint was allocated by (if any).
+     */
+    Ipv4EndPointDemux* m_demux;
+
     /**
      * \brief The local address.
      */
@@ -83,6 +83,7 @@ Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, Ipv4Address nextHop, uint32_
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, nextHop, interface);
     m_hostRoutes.push_back(route);
+    m_hostRouteIndex.Add(route->GetDestNetwork(), route->GetDestNetworkMask(), route);
 }
 
 void
@@ -92,6 +93,7 @@ Ipv4GlobalRouting::AddHostRouteTo(Ipv4Address dest, uint32_t interface)
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateHostRouteTo(dest, interface);
     m_hostRoutes.push_back(route);
+    m_hostRouteIndex.Add(route->GetDestNetwork(), route->GetDestNetworkMask(), route);
 }
 
 void
@@ -104,6 +106,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network,
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_networkRoutes.push_back(route);
+    m_networkRouteIndex.Add(route->GetDestNetwork(), route->GetDestNetworkMask(), route);
 }
 
 void
@@ -113,6 +116,7 @@ Ipv4GlobalRouting::AddNetworkRouteTo(Ipv4Address network, Ipv4Mask networkMask,
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, interface);
     m_networkRoutes.push_back(route);
+    m_networkRouteIndex.Add(route->GetDestNetwork(), route->GetDestNetworkMask(), route);
 }
 
 void
@@ -125,6 +129,7 @@ Ipv4GlobalRouting::AddASExternalRouteTo(Ipv4Address network,
     Ipv4RoutingTableEntry* route = new Ipv4RoutingTableEntry();
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, nextHop, interface);
     m_ASexternalRoutes.push_back(route);
+    m_ASexternalRouteIndex.Add(route->GetDestNetwork(), route->GetDestNetworkMask(), route);
 }
 
 Ptr<Ipv4Route>
@@ -138,65 +143,52 @@ Ipv4GlobalRouting::LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif)
     RouteVec_t allRoutes;
 
     NS_LOG_LOGIC("Number of m_hostRoutes = " << m_hostRoutes.size());
-    for (HostRoutesCI i = m_hostRoutes.begin(); i != m_hostRoutes.end(); i++)
+    for (Ipv4RoutingTableEntry* route : m_hostRouteIndex.Lookup(dest))
     {
-        NS_ASSERT((*i)->IsHost());
-        if ((*i)->GetDest() == dest)
+        NS_ASSERT(route->IsHost());
+        if (oif)
         {
-            if (oif)
+            if (oif != m_ipv4->GetNetDevice(route->GetInterface()))
             {
-                if (oif != m_ipv4->GetNetDevice((*i)->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
+                NS_LOG_LOGIC("Not on requested interface, skipping");
+                continue;
             }
-            allRoutes.push_back(*i);
-            NS_LOG_LOGIC(allRoutes.size() << "Found global host route" << *i);
         }
+        allRoutes.push_back(route);
+        NS_LOG_LOGIC(allRoutes.size() << "Found global host route" << route);
     }
     if (allRoutes.size() == 0) // if no host route is found
     {
         NS_LOG_LOGIC("Number of m_networkRoutes" << m_networkRoutes.size());
-        for (NetworkRoutesI j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+        for (Ipv4RoutingTableEntry* route : m_networkRouteIndex.Lookup(dest))
         {
-            Ipv4Mask mask = (*j)->GetDestNetworkMask();
-            Ipv4Address entry = (*j)->GetDestNetwork();
-            if (mask.IsMatch(dest, entry))
+            if (oif)
             {
-                if (oif)
+                if (oif != m_ipv4->GetNetDevice(route->GetInterface()))
                 {
-                    if (oif != m_ipv4->GetNetDevice((*j)->GetInterface()))
-                    {
-                        NS_LOG_LOGIC("Not on requested interface, skipping");
-                        continue;
-                    }
+                    NS_LOG_LOGIC("Not on requested interface, skipping");
+                    continue;
                 }
-                allRoutes.push_back(*j);
-                NS_LOG_LOGIC(allRoutes.size() << "Found global network route" << *j);
             }
+            allRoutes.push_back(route);
+            NS_LOG_LOGIC(allRoutes.size() << "Found global network route" << route);
         }
     }
     if (allRoutes.size() == 0) // consider external if no host/network found
     {
-        for (ASExternalRoutesI k = m_ASexternalRoutes.begin(); k != m_ASexternalRoutes.end(); k++)
+        for (Ipv4RoutingTableEntry* route : m_ASexternalRouteIndex.Lookup(dest))
         {
-            Ipv4Mask mask = (*k)->GetDestNetworkMask();
-            Ipv4Address entry = (*k)->GetDestNetwork();
-            if (mask.IsMatch(dest, entry))
+            NS_LOG_LOGIC("Found external route" << route);
+            if (oif)
             {
-                NS_LOG_LOGIC("Found external route" << *k);
-                if (oif)
+                if (oif != m_ipv4->GetNetDevice(route->GetInterface()))
                 {
-                    if (oif != m_ipv4->GetNetDevice((*k)->GetInterface()))
-                    {
-                        NS_LOG_LOGIC("Not on requested interface, skipping");
-                        continue;
-                    }
+                    NS_LOG_LOGIC("Not on requested interface, skipping");
+                    continue;
                 }
-                allRoutes.push_back(*k);
-                break;
             }
+            allRoutes.push_back(route);
+            break;
         }
     }
     if (allRoutes.size() > 0) // if route(s) is found
@@ -297,6 +289,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
             if (tmp == index)
             {
                 NS_LOG_LOGIC("Removing route " << index << "; size = " << m_hostRoutes.size());
+                Unindex(*i, m_hostRouteIndex);
                 delete *i;
                 m_hostRoutes.erase(i);
                 NS_LOG_LOGIC("Done removing host route "
@@ -313,6 +306,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
         if (tmp == index)
         {
             NS_LOG_LOGIC("Removing route " << index << "; size = " << m_networkRoutes.size());
+            Unindex(*j, m_networkRouteIndex);
             delete *j;
             m_networkRoutes.erase(j);
             NS_LOG_LOGIC("Done removing network route "
@@ -328,6 +322,7 @@ Ipv4GlobalRouting::RemoveRoute(uint32_t index)
         if (tmp == index)
         {
             NS_LOG_LOGIC("Removing route " << index << "; size = " << m_ASexternalRoutes.size());
+            Unindex(*k, m_ASexternalRouteIndex);
             delete *k;
             m_ASexternalRoutes.erase(k);
             NS_LOG_LOGIC("Done removing network route "
@@ -347,6 +342,12 @@ Ipv4GlobalRouting::AssignStreams(int64_t stream)
     return 1;
 }
 
+void
+Ipv4GlobalRouting::Unindex(Ipv4RoutingTableEntry* route, RouteIndex& index)
+{
+    index.Remove(route->GetDestNetwork(), route->GetDestNetworkMask(), route);
+}
+
 void
 Ipv4GlobalRouting::DoDispose()
 {
@@ -365,6 +366,9 @@ Ipv4GlobalRouting::DoDispose()
     {
         delete (*l);
     }
+    m_hostRouteIndex.Clear();
+    m_networkRouteIndex.Clear();
+    m_ASexternalRouteIndex.Clear();
 
     Ipv4RoutingProtocol::DoDispose();
 }
@@ -533,9 +537,7 @@ Ipv4GlobalRouting::NotifyInterfaceUp(uint32_t i)
     NS_LOG_FUNCTION(this << i);
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
-        GlobalRouteManager::DeleteGlobalRoutes();
-        GlobalRouteManager::BuildGlobalRoutingDatabase();
-        GlobalRouteManager::InitializeRoutes();
+        GlobalRouteManager::RecomputeRoutes();
     }
 }
 
@@ -545,9 +547,7 @@ Ipv4GlobalRouting::NotifyInterfaceDown(uint32_t i)
     NS_LOG_FUNCTION(this << i);
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
-        GlobalRouteManager::DeleteGlobalRoutes();
-        GlobalRouteManager::BuildGlobalRoutingDatabase();
-        GlobalRouteManager::InitializeRoutes();
+        GlobalRouteManager::RecomputeRoutes();
     }
 }
 
@@ -557,9 +557,7 @@ Ipv4GlobalRouting::NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress add
     NS_LOG_FUNCTION(this << interface << address);
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
-        GlobalRouteManager::DeleteGlobalRoutes();
-        GlobalRouteManager::BuildGlobalRoutingDatabase();
-        GlobalRouteManager::InitializeRoutes();
+        GlobalRouteManager::RecomputeRoutes();
     }
 }
 
@@ -569,9 +567,7 @@ Ipv4GlobalRouting::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress
     NS_LOG_FUNCTION(this << interface << address);
     if (m_respondToInterfaceEvents && Simulator::Now().GetSeconds() > 0) // avoid startup events
     {
-        GlobalRouteManager::DeleteGlobalRoutes();
-        GlobalRouteManager::BuildGlobalRoutingDatabase();
-        GlobalRouteManager::InitializeRoutes();
+        GlobalRouteManager::RecomputeRoutes();
     }
 }
 
@@ -25,6 +25,7 @@
 #include "ns3/ipv4.h"
 #include "ns3/ptr.h"
 #include "ns3/random-variable-stream.h"
+#include "ns3/routing-table-index.h"
 
 #include <list>
 #include <stdint.h>
@@ -265,6 +266,10 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
     /// iterator of container of Ipv4RoutingTableEntry (routes to external AS)
     typedef std::list<Ipv4RoutingTableEntry*>::iterator ASExternalRoutesI;
 
+    /// index of Ipv4RoutingTableEntry by destination
+    typedef RoutingTableIndex<Ipv4Address, Ipv4Mask, Ipv4AddressHash, Ipv4RoutingTableEntry*>
+        RouteIndex;
+
     /**
      * \brief Lookup in the forwarding table for destination.
      * \param dest destination address
@@ -273,10 +278,21 @@ class Ipv4GlobalRouting : public Ipv4RoutingProtocol
      */
     Ptr<Ipv4Route> LookupGlobal(Ipv4Address dest, Ptr<NetDevice> oif = nullptr);
 
+    /**
+     * \brief Remove a route from the index of its container.
+     * \param route the route
+     * \param index the index of the container of the route
+     */
+    static void Unindex(Ipv4RoutingTableEntry* route, RouteIndex& index);
+
     HostRoutes m_hostRoutes;             //!< Routes to hosts
     NetworkRoutes m_networkRoutes;       //!< Routes to networks
     ASExternalRoutes m_ASexternalRoutes; //!< External routes imported
 
+    RouteIndex m_hostRouteIndex;       //!< Routes to hosts, by destination
+    RouteIndex m_networkRouteIndex;    //!< Routes to networks, by destination
+    RouteIndex m_ASexternalRouteIndex; //!< External routes imported, by destination
+
     Ptr<Ipv4> m_ipv4; //!< associated IPv4 instance
 };
 
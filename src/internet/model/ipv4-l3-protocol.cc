@@ -28,6 +28,7 @@
 
 #include "ns3/boolean.h"
 #include "ns3/callback.h"
+#include "ns3/hash.h"
 #include "ns3/ipv4-address.h"
 #include "ns3/ipv4-header.h"
 #include "ns3/ipv4-route.h"
@@ -43,6 +44,9 @@
 #include "ns3/traffic-control-layer.h"
 #include "ns3/uinteger.h"
 
+#include <ostream>
+#include <streambuf>
+
 namespace ns3
 {
 
@@ -1551,11 +1555,6 @@ Ipv4L3Protocol::DoFragmentation(Ptr<Packet> packet,
         NS_LOG_LOGIC("Fragment check - " << fragmentHeader.GetFragmentOffset());
 
         NS_LOG_LOGIC("New fragment Header " << fragmentHeader);
-
-        std::ostringstream oss;
-        oss << fragmentHeader;
-        fragment->Print(oss);
-
         NS_LOG_LOGIC("New fragment " << *fragment);
 
         listFragments.emplace_back(fragment, fragmentHeader);
@@ -1784,6 +1783,55 @@ Ipv4L3Protocol::HandleFragmentsTimeout(FragmentKey_t key, Ipv4Header& ipHeader,
     m_fragments.erase(key);
 }
 
+namespace
+{
+
+/**
+ * \ingroup ipv4
+ * A stream buffer which hashes the bytes written to it rather than
+ * store them.
+ *
+ * The bytes are hashed by chunks of a multiple of four bytes, so the
+ * hash is the one of Hash32() on all the bytes at once.
+ */
+class HashStreamBuf : public std::streambuf
+{
+  public:
+    /** Constructor. */
+    HashStreamBuf()
+    {
+        setp(m_chunk, m_chunk + sizeof(m_chunk));
+    }
+
+    /**
+     * Get the hash of the bytes written so far.
+     * \return The 32-bit hash.
+     */
+    uint32_t GetHash32()
+    {
+        return m_hasher.GetHash32(pbase(), pptr() - pbase());
+    }
+
+  protected:
+    int_type overflow(int_type c) override
+    {
+        m_hasher.GetHash32(pbase(), pptr() - pbase());
+        setp(m_chunk, m_chunk + sizeof(m_chunk));
+        if (!traits_type::eq_int_type(c, traits_type::eof()))
+        {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+  private:
+    Hasher m_hasher;    //!< The hasher, fed incrementally.
+    char m_chunk[1024]; //!< The bytes not hashed yet.
+};
+
+} // namespace
+
 bool
 Ipv4L3Protocol::UpdateDuplicate(Ptr<const Packet> p, const Ipv4Header& header)
 {
@@ -1806,13 +1854,12 @@ Ipv4L3Protocol::UpdateDuplicate(Ptr<const Packet> p, const Ipv4Header& header)
     {
         // use H-DPD (RFC 6621, Sec 6.2.2)
 
-        // serialize packet
-        Ptr<Packet> pkt = p->Copy();
-        pkt->AddHeader(header);
-
-        std::ostringstream oss(std::ios_base::binary);
-        pkt->CopyData(&oss, pkt->GetSize());
-        std::string bytes = oss.str();
+        // serialize header
+        Buffer headerBuffer;
+        headerBuffer.AddAtStart(header.GetSerializedSize());
+        header.Serialize(headerBuffer.Begin());
+        std::string bytes(headerBuffer.GetSize(), '\0');
+        headerBuffer.CopyData(reinterpret_cast<uint8_t*>(&bytes[0]), bytes.size());
 
         NS_ASSERT_MSG(bytes.size() >= 20, "Degenerate header serialization");
 
@@ -1826,8 +1873,14 @@ Ipv4L3Protocol::UpdateDuplicate(Ptr<const Packet> p, const Ipv4Header& header)
             std::fill_n(bytes.begin() + 20, header.GetSerializedSize() - 20, 0);
         }
 
+        // hash the header and the payload, without copying the payload
+        HashStreamBuf hashBuf;
+        std::ostream os(&hashBuf);
+        os.write(bytes.data(), bytes.size());
+        p->CopyData(&os, p->GetSize());
+
         // concat hash onto ID
-        hash |= (uint64_t)Hash32(bytes);
+        hash |= (uint64_t)hashBuf.GetHash32();
     }
 
     // set cleanup job for new duplicate entries
@@ -0,0 +1,235 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ipv4-next-hop-routing.h"
+
+#include "ns3/ipv4-route.h"
+#include "ns3/log.h"
+#include "ns3/net-device.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simulator.h"
+
+#include <iomanip>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("Ipv4NextHopRouting");
+
+NS_OBJECT_ENSURE_REGISTERED(Ipv4NextHopRouting);
+
+/// The node ID before the node is known
+static const uint32_t UNKNOWN_NODE_ID = 0xffffffff;
+
+TypeId
+Ipv4NextHopRouting::GetTypeId()
+{
+    static TypeId tid = TypeId("ns3::Ipv4NextHopRouting")
+                            .SetParent<Ipv4RoutingProtocol>()
+                            .SetGroupName("Internet")
+                            .AddConstructor<Ipv4NextHopRouting>();
+    return tid;
+}
+
+Ipv4NextHopRouting::Ipv4NextHopRouting()
+    : m_nodeId(UNKNOWN_NODE_ID)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+Ipv4NextHopRouting::~Ipv4NextHopRouting()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+Ipv4NextHopRouting::SetTable(Ptr<Ipv4NextHopTable> table)
+{
+    NS_LOG_FUNCTION(this << table);
+    m_table = table;
+}
+
+Ptr<Ipv4NextHopTable>
+Ipv4NextHopRouting::GetTable() const
+{
+    return m_table;
+}
+
+void
+Ipv4NextHopRouting::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    m_table = nullptr;
+    m_ipv4 = nullptr;
+    Ipv4RoutingProtocol::DoDispose();
+}
+
+Ptr<Ipv4Route>
+Ipv4NextHopRouting::LookupNextHop(Ipv4Address dest, Ptr<NetDevice> oif)
+{
+    NS_LOG_FUNCTION(this << dest << oif);
+    if (!m_table)
+    {
+        return nullptr;
+    }
+    if (m_nodeId == UNKNOWN_NODE_ID)
+    {
+        // the node is not known yet when the protocol is given its IPv4 stack
+        m_nodeId = m_ipv4->GetObject<Node>()->GetId();
+    }
+    const Ipv4NextHopTable::NextHop* nextHop = m_table->Lookup(m_nodeId, dest);
+    if (!nextHop)
+    {
+        NS_LOG_LOGIC("No next hop to " << dest);
+        return nullptr;
+    }
+    Ptr<NetDevice> device = m_ipv4->GetNetDevice(nextHop->interface);
+    if (oif && oif != device)
+    {
+        NS_LOG_LOGIC("Not on requested interface");
+        return nullptr;
+    }
+    Ptr<Ipv4Route> rtentry = Create<Ipv4Route>();
+    rtentry->SetDestination(dest);
+    /// \todo handle multi-address case
+    rtentry->SetSource(m_ipv4->GetAddress(nextHop->interface, 0).GetLocal());
+    rtentry->SetGateway(nextHop->gateway);
+    rtentry->SetOutputDevice(device);
+    return rtentry;
+}
+
+Ptr<Ipv4Route>
+Ipv4NextHopRouting::RouteOutput(Ptr<Packet> p,
+                                const Ipv4Header& header,
+                                Ptr<NetDevice> oif,
+                                Socket::SocketErrno& sockerr)
+{
+    NS_LOG_FUNCTION(this << p << &header << oif << &sockerr);
+    if (header.GetDestination().IsMulticast())
+    {
+        NS_LOG_LOGIC("Multicast destination-- returning false");
+        return nullptr; // Let other routing protocols try to handle this
+    }
+    Ptr<Ipv4Route> rtentry = LookupNextHop(header.GetDestination(), oif);
+    sockerr = rtentry ? Socket::ERROR_NOTERROR : Socket::ERROR_NOROUTETOHOST;
+    return rtentry;
+}
+
+bool
+Ipv4NextHopRouting::RouteInput(Ptr<const Packet> p,
+                               const Ipv4Header& header,
+                               Ptr<const NetDevice> idev,
+                               UnicastForwardCallback ucb,
+                               MulticastForwardCallback mcb,
+                               LocalDeliverCallback lcb,
+                               ErrorCallback ecb)
+{
+    NS_LOG_FUNCTION(this << p << header << header.GetSource() << header.GetDestination() << idev
+                         << &lcb << &ecb);
+    // Check if input device supports IP
+    NS_ASSERT(m_ipv4->GetInterfaceForDevice(idev) >= 0);
+    uint32_t iif = m_ipv4->GetInterfaceForDevice(idev);
+
+    if (m_ipv4->IsDestinationAddress(header.GetDestination(), iif))
+    {
+        if (!lcb.IsNull())
+        {
+            NS_LOG_LOGIC("Local delivery to " << header.GetDestination());
+            lcb(p, header, iif);
+            return true;
+        }
+        // The local delivery callback is null.  This may be a multicast
+        // or broadcast packet, so return false so that another
+        // multicast routing protocol can handle it.
+        return false;
+    }
+
+    // Check if input device supports IP forwarding
+    if (!m_ipv4->IsForwarding(iif))
+    {
+        NS_LOG_LOGIC("Forwarding disabled for this interface");
+        ecb(p, header, Socket::ERROR_NOROUTETOHOST);
+        return true;
+    }
+    Ptr<Ipv4Route> rtentry = LookupNextHop(header.GetDestination());
+    if (rtentry)
+    {
+        NS_LOG_LOGIC("Found unicast destination- calling unicast callback");
+        ucb(rtentry, p, header);
+        return true;
+    }
+    NS_LOG_LOGIC("Did not find unicast destination- returning false");
+    return false; // Let other routing protocols try to handle this route request.
+}
+
+void
+Ipv4NextHopRouting::NotifyInterfaceUp(uint32_t i)
+{
+    NS_LOG_FUNCTION(this << i);
+}
+
+void
+Ipv4NextHopRouting::NotifyInterfaceDown(uint32_t i)
+{
+    NS_LOG_FUNCTION(this << i);
+}
+
+void
+Ipv4NextHopRouting::NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address)
+{
+    NS_LOG_FUNCTION(this << interface << address);
+}
+
+void
+Ipv4NextHopRouting::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address)
+{
+    NS_LOG_FUNCTION(this << interface << address);
+}
+
+void
+Ipv4NextHopRouting::SetIpv4(Ptr<Ipv4> ipv4)
+{
+    NS_LOG_FUNCTION(this << ipv4);
+    NS_ASSERT(!m_ipv4 && ipv4);
+    m_ipv4 = ipv4;
+}
+
+// Formatted like output of "route -n" command
+void
+Ipv4NextHopRouting::PrintRoutingTable(Ptr<OutputStreamWrapper> stream, Time::Unit unit) const
+{
+    NS_LOG_FUNCTION(this << stream);
+    std::ostream* os = stream->GetStream();
+    // Copy the current ostream state
+    std::ios oldState(nullptr);
+    oldState.copyfmt(*os);
+
+    *os << std::resetiosflags(std::ios::adjustfield) << std::setiosflags(std::ios::left);
+
+    Ptr<Node> node = m_ipv4->GetObject<Node>();
+    *os << "Node: " << node->GetId() << ", Time: " << Now().As(unit)
+        << ", Local time: " << node->GetLocalTime().As(unit) << ", Ipv4NextHopRouting table"
+        << std::endl;
+    if (m_table)
+    {
+        m_table->PrintRoutes(*os, node->GetId());
+    }
+    *os << std::endl;
+    // Restore the previous ostream state
+    (*os).copyfmt(oldState);
+}
+
+} // namespace ns3
@@ -0,0 +1,116 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_NEXT_HOP_ROUTING_H
+#define IPV4_NEXT_HOP_ROUTING_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv4-header.h"
+#include "ns3/ipv4-next-hop-table.h"
+#include "ns3/ipv4-routing-protocol.h"
+#include "ns3/ipv4.h"
+#include "ns3/ptr.h"
+
+#include <stdint.h>
+
+namespace ns3
+{
+
+/**
+ * \ingroup ipv4
+ *
+ * \brief Routing protocol for IPv4 stacks routing through a next hop table
+ * shared by all the nodes.
+ *
+ * This is a lightweight alternative to Ipv4GlobalRouting for large static
+ * topologies: instead of storing a routing table entry per destination, the
+ * node looks up the next hop of its row in an Ipv4NextHopTable, which holds
+ * the next hops of all the routers to all the destinations and is computed
+ * by GlobalRouteManager::ComputeNextHopTable.
+ *
+ * The table is not updated when the topology changes (e.g., when an
+ * interface goes down), and the routes of the table use a single next hop
+ * per destination, i.e., there is no ECMP.
+ *
+ * This class deals with Ipv4 unicast routes only.
+ *
+ * \see Ipv4NextHopTable
+ * \see Ipv4NextHopRoutingHelper
+ */
+class Ipv4NextHopRouting : public Ipv4RoutingProtocol
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    Ipv4NextHopRouting();
+    ~Ipv4NextHopRouting() override;
+
+    // These methods inherited from base class
+    Ptr<Ipv4Route> RouteOutput(Ptr<Packet> p,
+                               const Ipv4Header& header,
+                               Ptr<NetDevice> oif,
+                               Socket::SocketErrno& sockerr) override;
+
+    bool RouteInput(Ptr<const Packet> p,
+                    const Ipv4Header& header,
+                    Ptr<const NetDevice> idev,
+                    UnicastForwardCallback ucb,
+                    MulticastForwardCallback mcb,
+                    LocalDeliverCallback lcb,
+                    ErrorCallback ecb) override;
+    void NotifyInterfaceUp(uint32_t interface) override;
+    void NotifyInterfaceDown(uint32_t interface) override;
+    void NotifyAddAddress(uint32_t interface, Ipv4InterfaceAddress address) override;
+    void NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress address) override;
+    void SetIpv4(Ptr<Ipv4> ipv4) override;
+    void PrintRoutingTable(Ptr<OutputStreamWrapper> stream,
+                           Time::Unit unit = Time::S) const override;
+
+    /**
+     * \brief Set the next hop table of the node.
+     *
+     * \param table the next hop table
+     */
+    void SetTable(Ptr<Ipv4NextHopTable> table);
+
+    /**
+     * \return the next hop table of the node
+     */
+    Ptr<Ipv4NextHopTable> GetTable() const;
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    /**
+     * \brief Lookup in the next hop table for a route.
+     * \param dest destination address
+     * \param oif output interface if any (put 0 otherwise)
+     * \return Ipv4Route to route the packet to reach dest address
+     */
+    Ptr<Ipv4Route> LookupNextHop(Ipv4Address dest, Ptr<NetDevice> oif = nullptr);
+
+    Ptr<Ipv4> m_ipv4;              //!< associated IPv4 instance
+    Ptr<Ipv4NextHopTable> m_table; //!< the next hop table
+    uint32_t m_nodeId;             //!< the ID of the node, once known
+};
+
+} // namespace ns3
+
+#endif /* IPV4_NEXT_HOP_ROUTING_H */
@@ -0,0 +1,472 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ipv4-next-hop-table.h"
+
+#include "ns3/abort.h"
+#include "ns3/assert.h"
+#include "ns3/fatal-error.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+
+#ifndef __WIN32__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("Ipv4NextHopTable");
+
+namespace
+{
+
+/// The first bytes of a saved table
+const char NEXT_HOP_TABLE_MAGIC[8] = {'n', 's', '3', 'n', 'h', 't', '0', '1'};
+
+/**
+ * \brief Sort mask groups from the longest mask.
+ * \param groups the mask groups
+ */
+template <typename Group>
+void
+SortGroups(std::vector<Group>& groups)
+{
+    std::stable_sort(groups.begin(), groups.end(), [](const Group& a, const Group& b) {
+        return a.mask.GetPrefixLength() > b.mask.GetPrefixLength();
+    });
+}
+
+/**
+ * \param os the output stream
+ * \param value the value to write
+ */
+void
+WriteU32(std::ostream& os, uint32_t value)
+{
+    os.write(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+/**
+ * \param is the input stream
+ * \return the value read
+ */
+uint32_t
+ReadU32(std::istream& is)
+{
+    uint32_t value = 0;
+    is.read(reinterpret_cast<char*>(&value), sizeof(value));
+    return value;
+}
+
+} // namespace
+
+Ipv4NextHopTable::Ipv4NextHopTable()
+    : m_cells(nullptr),
+      m_mapping(nullptr),
+      m_mappingSize(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+Ipv4NextHopTable::~Ipv4NextHopTable()
+{
+    NS_LOG_FUNCTION(this);
+    ReleaseCells();
+}
+
+void
+Ipv4NextHopTable::Clear()
+{
+    NS_LOG_FUNCTION(this);
+    ReleaseCells();
+    m_destinations.clear();
+    m_groups.clear();
+    m_externalGroups.clear();
+    m_rows.clear();
+    m_routers.clear();
+    m_nextHops.clear();
+    m_nextHopIndex.clear();
+}
+
+void
+Ipv4NextHopTable::ReleaseCells()
+{
+#ifndef __WIN32__
+    if (m_mapping)
+    {
+        munmap(m_mapping, m_mappingSize);
+    }
+#endif
+    m_mapping = nullptr;
+    m_mappingSize = 0;
+    m_storage.clear();
+    m_storage.shrink_to_fit();
+    m_cells = nullptr;
+}
+
+void
+Ipv4NextHopTable::AddDestination(Ipv4Address network, Ipv4Mask mask, bool external)
+{
+    NS_LOG_FUNCTION(this << network << mask << external);
+    NS_ASSERT_MSG(!m_cells, "The destinations must be added before allocating the table");
+    network = network.CombineMask(mask);
+    std::vector<MaskGroup>& groups = external ? m_externalGroups : m_groups;
+    auto group = std::find_if(groups.begin(), groups.end(), [&mask](const MaskGroup& g) {
+        return g.mask == mask;
+    });
+    if (group == groups.end())
+    {
+        group = groups.insert(groups.end(), MaskGroup{mask, {}});
+    }
+    if (group->columns.emplace(network, m_destinations.size()).second)
+    {
+        m_destinations.push_back({network, mask, external});
+    }
+}
+
+void
+Ipv4NextHopTable::AddRouter(uint32_t nodeId)
+{
+    NS_LOG_FUNCTION(this << nodeId);
+    NS_ASSERT_MSG(!m_cells, "The routers must be added before allocating the table");
+    if (nodeId >= m_rows.size())
+    {
+        m_rows.resize(nodeId + 1, NO_ROW);
+    }
+    if (m_rows[nodeId] == NO_ROW)
+    {
+        m_rows[nodeId] = m_routers.size();
+        m_routers.push_back(nodeId);
+    }
+}
+
+void
+Ipv4NextHopTable::Allocate()
+{
+    NS_LOG_FUNCTION(this);
+    ReleaseCells();
+    SortGroups(m_groups);
+    SortGroups(m_externalGroups);
+    m_nextHops.assign(m_routers.size(), {});
+    m_nextHopIndex.assign(m_routers.size(), {});
+    m_storage.assign(m_routers.size() * m_destinations.size(), NO_NEXT_HOP);
+    m_cells = m_storage.data();
+    NS_LOG_INFO("Allocated " << m_routers.size() << " routers x " << m_destinations.size()
+                             << " destinations");
+}
+
+uint32_t
+Ipv4NextHopTable::FindColumn(Ipv4Address network, Ipv4Mask mask, bool external) const
+{
+    const std::vector<MaskGroup>& groups = external ? m_externalGroups : m_groups;
+    for (const auto& group : groups)
+    {
+        if (group.mask == mask)
+        {
+            auto column = group.columns.find(network.CombineMask(mask));
+            return column == group.columns.end() ? NO_COLUMN : column->second;
+        }
+    }
+    return NO_COLUMN;
+}
+
+uint32_t
+Ipv4NextHopTable::FindRow(uint32_t nodeId) const
+{
+    return nodeId < m_rows.size() ? m_rows[nodeId] : NO_ROW;
+}
+
+bool
+Ipv4NextHopTable::SetNextHop(uint32_t nodeId,
+                             Ipv4Address network,
+                             Ipv4Mask mask,
+                             bool external,
+                             Ipv4Address gateway,
+                             uint32_t interface)
+{
+    NS_LOG_FUNCTION(this << nodeId << network << mask << external << gateway << interface);
+    NS_ASSERT_MSG(m_cells && !m_mapping, "The table is not allocated, or was loaded from a file");
+    uint32_t row = FindRow(nodeId);
+    uint32_t column = FindColumn(network, mask, external);
+    NS_ASSERT_MSG(row != NO_ROW, "Node " << nodeId << " is not in the table");
+    NS_ASSERT_MSG(column != NO_COLUMN, "Destination " << network << "/" << mask << " not found");
+    uint16_t& cell = m_cells[static_cast<std::size_t>(row) * m_destinations.size() + column];
+    if (cell != NO_NEXT_HOP)
+    {
+        return false;
+    }
+    uint64_t key = (static_cast<uint64_t>(interface) << 32) | gateway.Get();
+    auto index = m_nextHopIndex[row].find(key);
+    if (index == m_nextHopIndex[row].end())
+    {
+        NS_ABORT_MSG_IF(m_nextHops[row].size() >= NO_NEXT_HOP,
+                        "Too many next hops for node " << nodeId);
+        index = m_nextHopIndex[row].emplace(key, m_nextHops[row].size()).first;
+        m_nextHops[row].push_back({gateway, interface});
+    }
+    cell = index->second;
+    return true;
+}
+
+const Ipv4NextHopTable::NextHop*
+Ipv4NextHopTable::Lookup(uint32_t nodeId, Ipv4Address dest) const
+{
+    NS_LOG_FUNCTION(this << nodeId << dest);
+    uint32_t row = FindRow(nodeId);
+    if (row == NO_ROW || !m_cells)
+    {
+        return nullptr;
+    }
+    const uint16_t* cells = m_cells + static_cast<std::size_t>(row) * m_destinations.size();
+    for (const auto* groups : {&m_groups, &m_externalGroups})
+    {
+        for (const auto& group : *groups)
+        {
+            auto column = group.columns.find(dest.CombineMask(group.mask));
+            if (column != group.columns.end() && cells[column->second] != NO_NEXT_HOP)
+            {
+                return &m_nextHops[row][cells[column->second]];
+            }
+        }
+    }
+    return nullptr;
+}
+
+uint32_t
+Ipv4NextHopTable::GetNDestinations() const
+{
+    return m_destinations.size();
+}
+
+bool
+Ipv4NextHopTable::HasRouter(uint32_t nodeId) const
+{
+    return FindRow(nodeId) != NO_ROW;
+}
+
+void
+Ipv4NextHopTable::PrintRoutes(std::ostream& os, uint32_t nodeId) const
+{
+    uint32_t row = FindRow(nodeId);
+    if (row == NO_ROW || !m_cells)
+    {
+        return;
+    }
+    const uint16_t* cells = m_cells + static_cast<std::size_t>(row) * m_destinations.size();
+    bool header = false;
+    for (std::size_t column = 0; column < m_destinations.size(); column++)
+    {
+        if (cells[column] == NO_NEXT_HOP)
+        {
+            continue;
+        }
+        if (!header)
+        {
+            os << "Destination     Gateway         Genmask         Flags Iface" << std::endl;
+            header = true;
+        }
+        const Destination& destination = m_destinations[column];
+        const NextHop& nextHop = m_nextHops[row][cells[column]];
+        std::ostringstream dest;
+        std::ostringstream gw;
+        std::ostringstream mask;
+        std::ostringstream flags;
+        dest << destination.network;
+        gw << nextHop.gateway;
+        mask << destination.mask;
+        flags << "U";
+        if (destination.mask == Ipv4Mask::GetOnes())
+        {
+            flags << "H";
+        }
+        else if (nextHop.gateway != Ipv4Address::GetZero())
+        {
+            flags << "G";
+        }
+        os << std::setw(16) << dest.str() << std::setw(16) << gw.str() << std::setw(16)
+           << mask.str() << std::setw(6) << flags.str() << nextHop.interface << std::endl;
+    }
+}
+
+void
+Ipv4NextHopTable::Save(const std::string& filename) const
+{
+    NS_LOG_FUNCTION(this << filename);
+    std::ofstream os(filename, std::ios::binary | std::ios::trunc);
+    if (!os)
+    {
+        NS_FATAL_ERROR("Can not open " << filename);
+    }
+    os.write(NEXT_HOP_TABLE_MAGIC, sizeof(NEXT_HOP_TABLE_MAGIC));
+    WriteU32(os, m_destinations.size());
+    WriteU32(os, m_routers.size());
+    for (const auto& destination : m_destinations)
+    {
+        WriteU32(os, destination.network.Get());
+        WriteU32(os, destination.mask.Get());
+        WriteU32(os, destination.external);
+    }
+    for (std::size_t row = 0; row < m_routers.size(); row++)
+    {
+        WriteU32(os, m_routers[row]);
+        const std::vector<NextHop> noNextHops;
+        const auto& nextHops = row < m_nextHops.size() ? m_nextHops[row] : noNextHops;
+        WriteU32(os, nextHops.size());
+        for (const auto& nextHop : nextHops)
+        {
+            WriteU32(os, nextHop.gateway.Get());
+            WriteU32(os, nextHop.interface);
+        }
+    }
+    std::size_t nCells = m_routers.size() * m_destinations.size();
+    if (m_cells)
+    {
+        os.write(reinterpret_cast<const char*>(m_cells), nCells * sizeof(uint16_t));
+    }
+    else
+    {
+        std::vector<uint16_t> empty(nCells, NO_NEXT_HOP);
+        os.write(reinterpret_cast<const char*>(empty.data()), nCells * sizeof(uint16_t));
+    }
+    if (!os)
+    {
+        NS_FATAL_ERROR("Can not write " << filename);
+    }
+}
+
+void
+Ipv4NextHopTable::Load(const std::string& filename)
+{
+    NS_LOG_FUNCTION(this << filename);
+    Clear();
+    std::ifstream is(filename, std::ios::binary);
+    if (!is)
+    {
+        NS_FATAL_ERROR("Can not open " << filename);
+    }
+    char magic[sizeof(NEXT_HOP_TABLE_MAGIC)];
+    is.read(magic, sizeof(magic));
+    if (!is || std::memcmp(magic, NEXT_HOP_TABLE_MAGIC, sizeof(magic)) != 0)
+    {
+        NS_FATAL_ERROR(filename << " is not a next hop table");
+    }
+    uint32_t nDestinations = ReadU32(is);
+    uint32_t nRouters = ReadU32(is);
+    std::size_t offset = is.tellg();
+    std::size_t cellsSize = static_cast<std::size_t>(nRouters) * nDestinations * sizeof(uint16_t);
+    is.seekg(0, std::ios::end);
+    std::size_t fileSize = is.tellg();
+    is.seekg(offset);
+    // a destination takes three words, a router at least two words and its row of cells
+    NS_ABORT_MSG_IF(!is || fileSize < offset + 12ULL * nDestinations + 8ULL * nRouters + cellsSize,
+                    filename << " is too short for " << nRouters << " routers and "
+                             << nDestinations << " destinations");
+    for (uint32_t i = 0; is && i < nDestinations; i++)
+    {
+        Ipv4Address network(ReadU32(is));
+        Ipv4Mask mask(ReadU32(is));
+        bool external = ReadU32(is);
+        AddDestination(network, mask, external);
+    }
+    m_nextHops.resize(nRouters);
+    m_nextHopIndex.resize(nRouters);
+    for (uint32_t row = 0; is && row < nRouters; row++)
+    {
+        AddRouter(ReadU32(is));
+        uint32_t nNextHops = ReadU32(is);
+        NS_ABORT_MSG_IF(nNextHops > NO_NEXT_HOP || !is ||
+                            fileSize - static_cast<std::size_t>(is.tellg()) <
+                                8ULL * nNextHops + cellsSize,
+                        filename << " is too short for the " << nNextHops
+                                 << " next hops of router " << row);
+        for (uint32_t i = 0; is && i < nNextHops; i++)
+        {
+            Ipv4Address gateway(ReadU32(is));
+            uint32_t interface = ReadU32(is);
+            uint64_t key = (static_cast<uint64_t>(interface) << 32) | gateway.Get();
+            m_nextHopIndex[row].emplace(key, m_nextHops[row].size());
+            m_nextHops[row].push_back({gateway, interface});
+        }
+    }
+    if (!is || m_destinations.size() != nDestinations || m_routers.size() != nRouters)
+    {
+        NS_FATAL_ERROR(filename << " is not a valid next hop table");
+    }
+    SortGroups(m_groups);
+    SortGroups(m_externalGroups);
+
+    offset = is.tellg();
+    NS_ABORT_MSG_IF(fileSize != offset + cellsSize,
+                    filename << " has " << fileSize - offset << " bytes of cells instead of "
+                             << cellsSize);
+#ifndef __WIN32__
+    if (cellsSize > 0)
+    {
+        int fd = open(filename.c_str(), O_RDONLY);
+        if (fd >= 0)
+        {
+            void* mapping = mmap(nullptr, offset + cellsSize, PROT_READ, MAP_SHARED, fd, 0);
+            close(fd);
+            if (mapping != MAP_FAILED)
+            {
+                m_mapping = mapping;
+                m_mappingSize = offset + cellsSize;
+                m_cells = reinterpret_cast<uint16_t*>(static_cast<char*>(mapping) + offset);
+                NS_LOG_INFO("Mapped " << nRouters << " routers x " << nDestinations
+                                      << " destinations from " << filename);
+            }
+        }
+        if (!m_cells)
+        {
+            NS_LOG_WARN("Can not map " << filename << ", reading it");
+        }
+    }
+#endif
+    if (!m_cells)
+    {
+        m_storage.resize(cellsSize / sizeof(uint16_t));
+        is.seekg(offset);
+        is.read(reinterpret_cast<char*>(m_storage.data()), cellsSize);
+        if (!is)
+        {
+            NS_FATAL_ERROR("Can not read " << filename);
+        }
+        m_cells = m_storage.data();
+    }
+
+    // the lookups index the next hops of a row with its cells without any check
+    for (uint32_t row = 0; row < nRouters; row++)
+    {
+        const uint16_t* cells = m_cells + static_cast<std::size_t>(row) * nDestinations;
+        for (uint32_t column = 0; column < nDestinations; column++)
+        {
+            NS_ABORT_MSG_IF(cells[column] != NO_NEXT_HOP && cells[column] >= m_nextHops[row].size(),
+                            filename << ": next hop " << cells[column] << " of router " << row
+                                     << " to destination " << column << " out of the "
+                                     << m_nextHops[row].size() << " next hops of the router");
+        }
+    }
+}
+
+} // namespace ns3
@@ -0,0 +1,229 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef IPV4_NEXT_HOP_TABLE_H
+#define IPV4_NEXT_HOP_TABLE_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/simple-ref-count.h"
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup ipv4
+ *
+ * \brief Compact table of the next hops of all the routers to all the
+ * destinations of a static topology.
+ *
+ * The table is a matrix with a row per router (identified by the ID of its
+ * node) and a column per destination prefix, whose cells are 16-bit indexes
+ * in the list of the next hops (gateway and interface) of the router.  A
+ * single table is shared by the Ipv4NextHopRouting protocols of all the
+ * nodes, so that the routes to N destinations of M routers cost 2 * M * N
+ * bytes, instead of M * N routing table entries.
+ *
+ * The table is filled by GlobalRouteManager::ComputeNextHopTable, from the
+ * link state database of the global routing, and keeps a single next hop per
+ * router and destination: the first route that Ipv4GlobalRouting would have
+ * (without random ECMP routing).  A destination address is routed through the
+ * longest matching destination prefix for which the router has a next hop,
+ * the AS external destinations coming after the others.
+ *
+ * The table can be saved to a file, and loaded from it by another simulation
+ * of the same topology (same node IDs and addresses).  The matrix of a loaded
+ * table is memory-mapped from the file when the platform allows it, so that
+ * it is shared by the simulations running on the same host and only paged in
+ * as needed.
+ */
+class Ipv4NextHopTable : public SimpleRefCount<Ipv4NextHopTable>
+{
+  public:
+    /// The next hop of a route
+    struct NextHop
+    {
+        Ipv4Address gateway; //!< the gateway (0.0.0.0 for a directly connected destination)
+        uint32_t interface;  //!< the index of the output interface
+    };
+
+    Ipv4NextHopTable();
+    ~Ipv4NextHopTable();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    Ipv4NextHopTable(const Ipv4NextHopTable&) = delete;
+    Ipv4NextHopTable& operator=(const Ipv4NextHopTable&) = delete;
+
+    /**
+     * \brief Remove all the destinations, routers and next hops.
+     */
+    void Clear();
+
+    /**
+     * \brief Add a destination prefix (a column of the table).
+     *
+     * Nothing is done if the destination is already in the table.  The
+     * destinations must be added before calling Allocate().
+     *
+     * \param network the destination network
+     * \param mask the mask of the destination network
+     * \param external whether the destination is an AS external destination
+     */
+    void AddDestination(Ipv4Address network, Ipv4Mask mask, bool external);
+
+    /**
+     * \brief Add a router (a row of the table).
+     *
+     * Nothing is done if the router is already in the table.  The routers must
+     * be added before calling Allocate().
+     *
+     * \param nodeId the ID of the node of the router
+     */
+    void AddRouter(uint32_t nodeId);
+
+    /**
+     * \brief Allocate the matrix of the table, without any next hop.
+     */
+    void Allocate();
+
+    /**
+     * \brief Set the next hop of a router to a destination, if the router has
+     * no next hop to this destination yet.
+     *
+     * Concurrent calls are allowed for different routers.
+     *
+     * \param nodeId the ID of the node of the router
+     * \param network the destination network
+     * \param mask the mask of the destination network
+     * \param external whether the destination is an AS external destination
+     * \param gateway the gateway of the route
+     * \param interface the output interface of the route
+     * \return true if the next hop was set
+     */
+    bool SetNextHop(uint32_t nodeId,
+                    Ipv4Address network,
+                    Ipv4Mask mask,
+                    bool external,
+                    Ipv4Address gateway,
+                    uint32_t interface);
+
+    /**
+     * \brief Find the next hop of a router to a destination address.
+     *
+     * \param nodeId the ID of the node of the router
+     * \param dest the destination address
+     * \return the next hop, or nullptr if the router has no route to the address
+     */
+    const NextHop* Lookup(uint32_t nodeId, Ipv4Address dest) const;
+
+    /**
+     * \return the number of destination prefixes (columns) of the table
+     */
+    uint32_t GetNDestinations() const;
+
+    /**
+     * \param nodeId the ID of the node of a router
+     * \return true if the router is in the table
+     */
+    bool HasRouter(uint32_t nodeId) const;
+
+    /**
+     * \brief Print the routes of a router.
+     *
+     * \param os the output stream
+     * \param nodeId the ID of the node of the router
+     */
+    void PrintRoutes(std::ostream& os, uint32_t nodeId) const;
+
+    /**
+     * \brief Save the table to a file.
+     *
+     * The file is in the byte order of the host.
+     *
+     * \param filename the name of the file
+     */
+    void Save(const std::string& filename) const;
+
+    /**
+     * \brief Replace the content of the table with a table saved to a file.
+     *
+     * The next hops of a memory-mapped table cannot be changed. The simulation
+     * is aborted if the size of the file does not match the dimensions it
+     * declares, or if a cell refers to a next hop its router does not have.
+     *
+     * \param filename the name of the file
+     */
+    void Load(const std::string& filename);
+
+  private:
+    /// The destinations with a given mask
+    struct MaskGroup
+    {
+        Ipv4Mask mask;                                                      //!< the mask
+        std::unordered_map<Ipv4Address, uint32_t, Ipv4AddressHash> columns; //!< columns by network
+    };
+
+    /// The destination prefixes
+    struct Destination
+    {
+        Ipv4Address network; //!< the destination network
+        Ipv4Mask mask;       //!< the mask of the destination network
+        bool external;       //!< whether the destination is an AS external destination
+    };
+
+    /**
+     * \param network a destination network
+     * \param mask the mask of the destination network
+     * \param external whether the destination is an AS external destination
+     * \return the column of the destination, or NO_COLUMN if not found
+     */
+    uint32_t FindColumn(Ipv4Address network, Ipv4Mask mask, bool external) const;
+
+    /**
+     * \param nodeId the ID of the node of a router
+     * \return the row of the router, or NO_ROW if not found
+     */
+    uint32_t FindRow(uint32_t nodeId) const;
+
+    /**
+     * \brief Release the memory (or the mapping) of the matrix.
+     */
+    void ReleaseCells();
+
+    static constexpr uint16_t NO_NEXT_HOP = 0xffff;   //!< the cell of a destination without route
+    static constexpr uint32_t NO_ROW = 0xffffffff;    //!< a router that is not in the table
+    static constexpr uint32_t NO_COLUMN = 0xffffffff; //!< a destination that is not in the table
+
+    std::vector<Destination> m_destinations;      //!< the destinations, by column
+    std::vector<MaskGroup> m_groups;              //!< the internal destinations, by mask
+    std::vector<MaskGroup> m_externalGroups;      //!< the AS external destinations, by mask
+    std::vector<uint32_t> m_rows;                 //!< the rows, by node ID
+    std::vector<uint32_t> m_routers;              //!< the node IDs of the routers, by row
+    std::vector<std::vector<NextHop>> m_nextHops; //!< the next hops of each router
+    /// the index of the next hops of each router, by interface and gateway
+    std::vector<std::unordered_map<uint64_t, uint16_t>> m_nextHopIndex;
+    uint16_t* m_cells;               //!< the matrix, row by row
+    std::vector<uint16_t> m_storage; //!< the matrix, when allocated in memory
+    void* m_mapping;                 //!< the mapped file, when memory-mapped
+    std::size_t m_mappingSize;       //!< the size of the mapped file
+};
+
+} // namespace ns3
+
+#endif /* IPV4_NEXT_HOP_TABLE_H */
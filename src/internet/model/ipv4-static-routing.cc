@@ -78,8 +78,7 @@ Ipv4StaticRouting::AddNetworkRouteTo(Ipv4Address network,
 
     if (!LookupRoute(route, metric))
     {
-        Ipv4RoutingTableEntry* routePtr = new Ipv4RoutingTableEntry(route);
-        m_networkRoutes.emplace_back(routePtr, metric);
+        AddRoute(new Ipv4RoutingTableEntry(route), metric);
     }
 }
 
@@ -95,9 +94,7 @@ Ipv4StaticRouting::AddNetworkRouteTo(Ipv4Address network,
         Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, interface);
     if (!LookupRoute(route, metric))
     {
-        Ipv4RoutingTableEntry* routePtr = new Ipv4RoutingTableEntry(route);
-
-        m_networkRoutes.emplace_back(routePtr, metric);
+        AddRoute(new Ipv4RoutingTableEntry(route), metric);
     }
 }
 
@@ -152,7 +149,7 @@ Ipv4StaticRouting::SetDefaultMulticastRoute(uint32_t outputInterface)
     Ipv4Address network = Ipv4Address("224.0.0.0");
     Ipv4Mask networkMask = Ipv4Mask("240.0.0.0");
     *route = Ipv4RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, outputInterface);
-    m_networkRoutes.emplace_back(route, 0);
+    AddRoute(route, 0);
 }
 
 uint32_t
@@ -224,14 +221,14 @@ Ipv4StaticRouting::RemoveMulticastRoute(uint32_t index)
 bool
 Ipv4StaticRouting::LookupRoute(const Ipv4RoutingTableEntry& route, uint32_t metric)
 {
-    for (NetworkRoutesI j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+    for (const auto& j : m_networkRoutesIndex.Find(route.GetDest(), route.GetDestNetworkMask()))
     {
-        Ipv4RoutingTableEntry* rtentry = j->first;
+        Ipv4RoutingTableEntry* rtentry = j.first;
 
         if (rtentry->GetDest() == route.GetDest() &&
             rtentry->GetDestNetworkMask() == route.GetDestNetworkMask() &&
             rtentry->GetGateway() == route.GetGateway() &&
-            rtentry->GetInterface() == route.GetInterface() && j->second == metric)
+            rtentry->GetInterface() == route.GetInterface() && j.second == metric)
         {
             return true;
         }
@@ -239,6 +236,23 @@ Ipv4StaticRouting::LookupRoute(const Ipv4RoutingTableEntry& route, uint32_t metr
     return false;
 }
 
+void
+Ipv4StaticRouting::AddRoute(Ipv4RoutingTableEntry* route, uint32_t metric)
+{
+    m_networkRoutes.emplace_back(route, metric);
+    m_networkRoutesIndex.Add(route->GetDestNetwork(),
+                             route->GetDestNetworkMask(),
+                             m_networkRoutes.back());
+}
+
+void
+Ipv4StaticRouting::Unindex(const std::pair<Ipv4RoutingTableEntry*, uint32_t>& route)
+{
+    m_networkRoutesIndex.Remove(route.first->GetDestNetwork(),
+                                route.first->GetDestNetworkMask(),
+                                route);
+}
+
 Ptr<Ipv4Route>
 Ipv4StaticRouting::LookupStatic(Ipv4Address dest, Ptr<NetDevice> oif)
 {
@@ -261,54 +275,53 @@ Ipv4StaticRouting::LookupStatic(Ipv4Address dest, Ptr<NetDevice> oif)
         return rtentry;
     }
 
-    for (NetworkRoutesI i = m_networkRoutes.begin(); i != m_networkRoutes.end(); i++)
+    // the index returns the routes matching the destination, in the order of the table
+    for (const auto& i : m_networkRoutesIndex.Lookup(dest))
     {
-        Ipv4RoutingTableEntry* j = i->first;
-        uint32_t metric = i->second;
+        Ipv4RoutingTableEntry* j = i.first;
+        uint32_t metric = i.second;
         Ipv4Mask mask = (j)->GetDestNetworkMask();
         uint16_t masklen = mask.GetPrefixLength();
-        Ipv4Address entry = (j)->GetDestNetwork();
+        Ipv4Address entry [[maybe_unused]] = (j)->GetDestNetwork();
         NS_LOG_LOGIC("Searching for route to " << dest << ", checking against route to " << entry
                                                << "/" << masklen);
-        if (mask.IsMatch(dest, entry))
+        NS_ASSERT(mask.IsMatch(dest, entry));
+        NS_LOG_LOGIC("Found global network route " << j << ", mask length " << masklen
+                                                   << ", metric " << metric);
+        if (oif)
         {
-            NS_LOG_LOGIC("Found global network route " << j << ", mask length " << masklen
-                                                       << ", metric " << metric);
-            if (oif)
+            if (oif != m_ipv4->GetNetDevice(j->GetInterface()))
             {
-                if (oif != m_ipv4->GetNetDevice(j->GetInterface()))
-                {
-                    NS_LOG_LOGIC("Not on requested interface, skipping");
-                    continue;
-                }
-            }
-            if (masklen < longest_mask) // Not interested if got shorter mask
-            {
-                NS_LOG_LOGIC("Previous match longer, skipping");
+                NS_LOG_LOGIC("Not on requested interface, skipping");
                 continue;
             }
-            if (masklen > longest_mask) // Reset metric if longer masklen
-            {
-                shortest_metric = 0xffffffff;
-            }
-            longest_mask = masklen;
-            if (metric > shortest_metric)
-            {
-                NS_LOG_LOGIC("Equal mask length, but previous metric shorter, skipping");
-                continue;
-            }
-            shortest_metric = metric;
-            Ipv4RoutingTableEntry* route = (j);
-            uint32_t interfaceIdx = route->GetInterface();
-            rtentry = Create<Ipv4Route>();
-            rtentry->SetDestination(route->GetDest());
-            rtentry->SetSource(m_ipv4->SourceAddressSelection(interfaceIdx, route->GetDest()));
-            rtentry->SetGateway(route->GetGateway());
-            rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
-            if (masklen == 32)
-            {
-                break;
-            }
+        }
+        if (masklen < longest_mask) // Not interested if got shorter mask
+        {
+            NS_LOG_LOGIC("Previous match longer, skipping");
+            continue;
+        }
+        if (masklen > longest_mask) // Reset metric if longer masklen
+        {
+            shortest_metric = 0xffffffff;
+        }
+        longest_mask = masklen;
+        if (metric > shortest_metric)
+        {
+            NS_LOG_LOGIC("Equal mask length, but previous metric shorter, skipping");
+            continue;
+        }
+        shortest_metric = metric;
+        Ipv4RoutingTableEntry* route = (j);
+        uint32_t interfaceIdx = route->GetInterface();
+        rtentry = Create<Ipv4Route>();
+        rtentry->SetDestination(route->GetDest());
+        rtentry->SetSource(m_ipv4->SourceAddressSelection(interfaceIdx, route->GetDest()));
+        rtentry->SetGateway(route->GetGateway());
+        rtentry->SetOutputDevice(m_ipv4->GetNetDevice(interfaceIdx));
+        if (masklen == 32)
+        {
+            break;
         }
     }
     if (rtentry)
@@ -457,6 +470,7 @@ Ipv4StaticRouting::RemoveRoute(uint32_t index)
     {
         if (tmp == index)
         {
+            Unindex(*j);
             delete j->first;
             m_networkRoutes.erase(j);
             return;
@@ -593,6 +607,7 @@ Ipv4StaticRouting::DoDispose()
     {
         delete (j->first);
     }
+    m_networkRoutesIndex.Clear();
     for (MulticastRoutesI i = m_multicastRoutes.begin(); i != m_multicastRoutes.end();
          i = m_multicastRoutes.erase(i))
     {
@@ -632,6 +647,7 @@ Ipv4StaticRouting::NotifyInterfaceDown(uint32_t i)
     {
         if (it->first->GetInterface() == i)
         {
+            Unindex(*it);
             delete it->first;
             it = m_networkRoutes.erase(it);
         }
@@ -677,6 +693,7 @@ Ipv4StaticRouting::NotifyRemoveAddress(uint32_t interface, Ipv4InterfaceAddress
             it->first->GetDestNetwork() == networkAddress &&
             it->first->GetDestNetworkMask() == networkMask)
         {
+            Unindex(*it);
             delete it->first;
             it = m_networkRoutes.erase(it);
         }
@@ -26,6 +26,7 @@
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4.h"
 #include "ns3/ptr.h"
+#include "ns3/routing-table-index.h"
 #include "ns3/socket.h"
 
 #include <list>
@@ -371,6 +372,13 @@ class Ipv4StaticRouting : public Ipv4RoutingProtocol
     /// Iterator for container for the network routes
     typedef std::list<std::pair<Ipv4RoutingTableEntry*, uint32_t>>::iterator NetworkRoutesI;
 
+    /// Index of the network routes by destination
+    typedef RoutingTableIndex<Ipv4Address,
+                              Ipv4Mask,
+                              Ipv4AddressHash,
+                              std::pair<Ipv4RoutingTableEntry*, uint32_t>>
+        NetworkRoutesIndex;
+
     /// Container for the multicast routes
     typedef std::list<Ipv4MulticastRoutingTableEntry*> MulticastRoutes;
 
@@ -388,6 +396,19 @@ class Ipv4StaticRouting : public Ipv4RoutingProtocol
      */
     bool LookupRoute(const Ipv4RoutingTableEntry& route, uint32_t metric);
 
+    /**
+     * \brief Add a network route to the forwarding table.
+     * \param route the route
+     * \param metric metric of route
+     */
+    void AddRoute(Ipv4RoutingTableEntry* route, uint32_t metric);
+
+    /**
+     * \brief Remove a network route from the index of the forwarding table.
+     * \param route the route and its metric
+     */
+    void Unindex(const std::pair<Ipv4RoutingTableEntry*, uint32_t>& route);
+
     /**
      * \brief Lookup in the forwarding table for destination.
      * \param dest destination address
@@ -410,6 +431,11 @@ class Ipv4StaticRouting : public Ipv4RoutingProtocol
      */
     NetworkRoutes m_networkRoutes;
 
+    /**
+     * \brief the forwarding table for network, by destination.
+     */
+    NetworkRoutesIndex m_networkRoutesIndex;
+
     /**
      * \brief the forwarding table for multicast.
      */
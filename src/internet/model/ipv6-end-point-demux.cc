@@ -48,27 +48,133 @@ Ipv6EndPointDemux::~Ipv6EndPointDemux()
 }
 
 bool
-Ipv6EndPointDemux::LookupPortLocal(uint16_t port)
+Ipv6EndPointDemux::FourTuple::operator==(const FourTuple& other) const
 {
-    NS_LOG_FUNCTION(this << port);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    return localAddress == other.localAddress && peerAddress == other.peerAddress &&
+           localPort == other.localPort && peerPort == other.peerPort;
+}
+
+std::size_t
+Ipv6EndPointDemux::FourTupleHash::operator()(const FourTuple& tuple) const
+{
+    Ipv6AddressHash addressHash;
+    std::size_t hash = addressHash(tuple.localAddress);
+    hash = hash * 1000003 ^ addressHash(tuple.peerAddress);
+    hash = hash * 1000003 ^ ((static_cast<std::size_t>(tuple.localPort) << 16) | tuple.peerPort);
+    return hash;
+}
+
+Ipv6EndPointDemux::FourTuple
+Ipv6EndPointDemux::GetFourTuple(Ipv6EndPoint* endPoint)
+{
+    return {endPoint->GetLocalAddress(),
+            endPoint->GetPeerAddress(),
+            endPoint->GetLocalPort(),
+            endPoint->GetPeerPort()};
+}
+
+bool
+Ipv6EndPointDemux::IsWildcard(const FourTuple& tuple)
+{
+    return tuple.localAddress == Ipv6Address::GetAny() ||
+           tuple.peerAddress == Ipv6Address::GetAny() || tuple.peerPort == 0;
+}
+
+void
+Ipv6EndPointDemux::Register(Ipv6EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    Position& position = m_positions[endPoint];
+    position.endPoint = m_endPoints.insert(m_endPoints.end(), endPoint);
+    uint16_t localPort = endPoint->GetLocalPort();
+    EndPoints& portEndPoints = m_ports[localPort].endPoints;
+    if (portEndPoints.empty())
     {
-        if ((*i)->GetLocalPort() == port)
+        SetEphemeralPortUsed(localPort, true);
+    }
+    position.port = portEndPoints.insert(portEndPoints.end(), endPoint);
+    endPoint->m_demux = this;
+    Index(endPoint);
+}
+
+void
+Ipv6EndPointDemux::Unregister(Ipv6EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    Unindex(endPoint);
+    endPoint->m_demux = nullptr;
+    auto position = m_positions.find(endPoint);
+    uint16_t localPort = endPoint->GetLocalPort();
+    auto port = m_ports.find(localPort);
+    port->second.endPoints.erase(position->second.port);
+    if (port->second.endPoints.empty())
+    {
+        m_ports.erase(port);
+        SetEphemeralPortUsed(localPort, false);
+    }
+    m_endPoints.erase(position->second.endPoint);
+    m_positions.erase(position);
+}
+
+void
+Ipv6EndPointDemux::Index(Ipv6EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    Position& position = m_positions.find(endPoint)->second;
+    FourTuple tuple = GetFourTuple(endPoint);
+    position.isWildcard = IsWildcard(tuple);
+    if (position.isWildcard)
+    {
+        EndPoints& wildcards = m_ports.find(tuple.localPort)->second.wildcards;
+        position.wildcard = wildcards.insert(wildcards.end(), endPoint);
+    }
+    else
+    {
+        m_fourTuples.emplace(tuple, endPoint);
+    }
+}
+
+void
+Ipv6EndPointDemux::Unindex(Ipv6EndPoint* endPoint)
+{
+    NS_LOG_FUNCTION(this << endPoint);
+    const Position& position = m_positions.find(endPoint)->second;
+    if (position.isWildcard)
+    {
+        m_ports.find(endPoint->GetLocalPort())->second.wildcards.erase(position.wildcard);
+        return;
+    }
+    auto range = m_fourTuples.equal_range(GetFourTuple(endPoint));
+    for (auto i = range.first; i != range.second; i++)
+    {
+        if (i->second == endPoint)
         {
-            return true;
+            m_fourTuples.erase(i);
+            return;
         }
     }
-    return false;
+    NS_ASSERT_MSG(false, "Endpoint " << endPoint << " not found in the four-tuple table");
+}
+
+bool
+Ipv6EndPointDemux::LookupPortLocal(uint16_t port)
+{
+    NS_LOG_FUNCTION(this << port);
+    return m_ports.find(port) != m_ports.end();
 }
 
 bool
 Ipv6EndPointDemux::LookupLocal(Ptr<NetDevice> boundNetDevice, Ipv6Address addr, uint16_t port)
 {
     NS_LOG_FUNCTION(this << addr << port);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto portI = m_ports.find(port);
+    if (portI == m_ports.end())
     {
-        if ((*i)->GetLocalPort() == port && (*i)->GetLocalAddress() == addr &&
-            (*i)->GetBoundNetDevice() == boundNetDevice)
+        return false;
+    }
+    for (Ipv6EndPoint* endPoint : portI->second.endPoints)
+    {
+        if (endPoint->GetLocalAddress() == addr && endPoint->GetBoundNetDevice() == boundNetDevice)
         {
             return true;
         }
@@ -76,6 +182,7 @@ Ipv6EndPointDemux::LookupLocal(Ptr<NetDevice> boundNetDevice, Ipv6Address addr,
     return false;
 }
 
+
 Ipv6EndPoint*
 Ipv6EndPointDemux::Allocate()
 {
@@ -87,7 +194,7 @@ Ipv6EndPointDemux::Allocate()
         return nullptr;
     }
     Ipv6EndPoint* endPoint = new Ipv6EndPoint(Ipv6Address::GetAny(), port);
-    m_endPoints.push_back(endPoint);
+    Register(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -103,7 +210,7 @@ Ipv6EndPointDemux::Allocate(Ipv6Address address)
         return nullptr;
     }
     Ipv6EndPoint* endPoint = new Ipv6EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
+    Register(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -126,7 +233,7 @@ Ipv6EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice, Ipv6Address address,
         return nullptr;
     }
     Ipv6EndPoint* endPoint = new Ipv6EndPoint(address, port);
-    m_endPoints.push_back(endPoint);
+    Register(endPoint);
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
     return endPoint;
 }
@@ -139,11 +246,24 @@ Ipv6EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
                             uint16_t peerPort)
 {
     NS_LOG_FUNCTION(this << boundNetDevice << localAddress << localPort << peerAddress << peerPort);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    FourTuple tuple{localAddress, peerAddress, localPort, peerPort};
+    EndPoints candidates;
+    if (!IsWildcard(tuple))
+    {
+        auto range = m_fourTuples.equal_range(tuple);
+        for (auto i = range.first; i != range.second; i++)
+        {
+            candidates.push_back(i->second);
+        }
+    }
+    else if (auto port = m_ports.find(localPort); port != m_ports.end())
+    {
+        candidates = port->second.wildcards;
+    }
+    for (Ipv6EndPoint* endP : candidates)
     {
-        if ((*i)->GetLocalPort() == localPort && (*i)->GetLocalAddress() == localAddress &&
-            (*i)->GetPeerPort() == peerPort && (*i)->GetPeerAddress() == peerAddress &&
-            ((*i)->GetBoundNetDevice() == boundNetDevice || !(*i)->GetBoundNetDevice()))
+        if (GetFourTuple(endP) == tuple &&
+            (endP->GetBoundNetDevice() == boundNetDevice || !endP->GetBoundNetDevice()))
         {
             NS_LOG_WARN("Duplicated endpoint.");
             return nullptr;
@@ -151,7 +271,7 @@ Ipv6EndPointDemux::Allocate(Ptr<NetDevice> boundNetDevice,
     }
     Ipv6EndPoint* endPoint = new Ipv6EndPoint(localAddress, localPort);
     endPoint->SetPeer(peerAddress, peerPort);
-    m_endPoints.push_back(endPoint);
+    Register(endPoint);
 
     NS_LOG_DEBUG("Now have >>" << m_endPoints.size() << "<< endpoints.");
 
@@ -162,15 +282,106 @@ void
 Ipv6EndPointDemux::DeAllocate(Ipv6EndPoint* endPoint)
 {
     NS_LOG_FUNCTION(this);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    if (m_positions.find(endPoint) != m_positions.end())
+    {
+        Unregister(endPoint);
+        delete endPoint;
+    }
+}
+
+void
+Ipv6EndPointDemux::Match(Ipv6EndPoint* endP,
+                         Ipv6Address daddr,
+                         uint16_t dport,
+                         Ipv6Address saddr,
+                         uint16_t sport,
+                         Ptr<Ipv6Interface> incomingInterface,
+                         EndPoints& retval1,
+                         EndPoints& retval2,
+                         EndPoints& retval3,
+                         EndPoints& retval4)
+{
+    NS_LOG_DEBUG("Looking at endpoint dport="
+                 << endP->GetLocalPort() << " daddr=" << endP->GetLocalAddress()
+                 << " sport=" << endP->GetPeerPort() << " saddr=" << endP->GetPeerAddress());
+
+    if (!endP->IsRxEnabled())
     {
-        if (*i == endPoint)
+        NS_LOG_LOGIC("Skipping endpoint " << &endP << " because endpoint can not receive packets");
+        return;
+    }
+
+    if (endP->GetLocalPort() != dport)
+    {
+        NS_LOG_LOGIC("Skipping endpoint " << &endP << " because endpoint dport "
+                                          << endP->GetLocalPort()
+                                          << " does not match packet dport " << dport);
+        return;
+    }
+
+    if (endP->GetBoundNetDevice())
+    {
+        if (!incomingInterface)
+        {
+            return;
+        }
+        if (endP->GetBoundNetDevice() != incomingInterface->GetDevice())
         {
-            delete endPoint;
-            m_endPoints.erase(i);
-            break;
+            NS_LOG_LOGIC("Skipping endpoint "
+                         << &endP << " because endpoint is bound to specific device and"
+                         << endP->GetBoundNetDevice() << " does not match packet device "
+                         << incomingInterface->GetDevice());
+            return;
         }
     }
+
+    /*    Ipv6Address incomingInterfaceAddr = incomingInterface->GetAddress (); */
+    NS_LOG_DEBUG("dest addr " << daddr);
+
+    bool localAddressMatchesWildCard = endP->GetLocalAddress() == Ipv6Address::GetAny();
+    bool localAddressMatchesExact = endP->GetLocalAddress() == daddr;
+    bool localAddressMatchesAllRouters =
+        endP->GetLocalAddress() == Ipv6Address::GetAllRoutersMulticast();
+
+    /* if no match here, keep looking */
+    if (!(localAddressMatchesExact || localAddressMatchesWildCard))
+    {
+        return;
+    }
+    bool remotePeerMatchesExact = endP->GetPeerPort() == sport;
+    bool remotePeerMatchesWildCard = endP->GetPeerPort() == 0;
+    bool remoteAddressMatchesExact = endP->GetPeerAddress() == saddr;
+    bool remoteAddressMatchesWildCard = endP->GetPeerAddress() == Ipv6Address::GetAny();
+
+    /* If remote does not match either with exact or wildcard,i
+       skip this one */
+    if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
+    {
+        return;
+    }
+    if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
+    {
+        return;
+    }
+
+    /* Now figure out which return list to add this one to */
+    if (localAddressMatchesWildCard && remotePeerMatchesWildCard && remoteAddressMatchesWildCard)
+    { /* Only local port matches exactly */
+        retval1.push_back(endP);
+    }
+    if ((localAddressMatchesExact || (localAddressMatchesAllRouters)) &&
+        remotePeerMatchesWildCard && remoteAddressMatchesWildCard)
+    { /* Only local port and local address matches exactly */
+        retval2.push_back(endP);
+    }
+    if (localAddressMatchesWildCard && remotePeerMatchesExact && remoteAddressMatchesExact)
+    { /* All but local address */
+        retval3.push_back(endP);
+    }
+    if (localAddressMatchesExact && remotePeerMatchesExact && remoteAddressMatchesExact)
+    { /* All 4 match */
+        retval4.push_back(endP);
+    }
 }
 
 /*
@@ -193,93 +404,41 @@ Ipv6EndPointDemux::Lookup(Ipv6Address daddr,
     EndPoints retval4; /* Exact match on all 4 */
 
     NS_LOG_DEBUG("Looking up endpoint for destination address " << daddr);
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    auto port = m_ports.find(dport);
+    if (port == m_ports.end())
     {
-        Ipv6EndPoint* endP = *i;
-
-        NS_LOG_DEBUG("Looking at endpoint dport="
-                     << endP->GetLocalPort() << " daddr=" << endP->GetLocalAddress()
-                     << " sport=" << endP->GetPeerPort() << " saddr=" << endP->GetPeerAddress());
-
-        if (!endP->IsRxEnabled())
-        {
-            NS_LOG_LOGIC("Skipping endpoint " << &endP
-                                              << " because endpoint can not receive packets");
-            continue;
-        }
-
-        if (endP->GetLocalPort() != dport)
-        {
-            NS_LOG_LOGIC("Skipping endpoint " << &endP << " because endpoint dport "
-                                              << endP->GetLocalPort()
-                                              << " does not match packet dport " << dport);
-            continue;
-        }
-
-        if (endP->GetBoundNetDevice())
-        {
-            if (!incomingInterface)
-            {
-                continue;
-            }
-            if (endP->GetBoundNetDevice() != incomingInterface->GetDevice())
-            {
-                NS_LOG_LOGIC("Skipping endpoint "
-                             << &endP << " because endpoint is bound to specific device and"
-                             << endP->GetBoundNetDevice() << " does not match packet device "
-                             << incomingInterface->GetDevice());
-                continue;
-            }
-        }
-
-        /*    Ipv6Address incomingInterfaceAddr = incomingInterface->GetAddress (); */
-        NS_LOG_DEBUG("dest addr " << daddr);
-
-        bool localAddressMatchesWildCard = endP->GetLocalAddress() == Ipv6Address::GetAny();
-        bool localAddressMatchesExact = endP->GetLocalAddress() == daddr;
-        bool localAddressMatchesAllRouters =
-            endP->GetLocalAddress() == Ipv6Address::GetAllRoutersMulticast();
-
-        /* if no match here, keep looking */
-        if (!(localAddressMatchesExact || localAddressMatchesWildCard))
-        {
-            continue;
-        }
-        bool remotePeerMatchesExact = endP->GetPeerPort() == sport;
-        bool remotePeerMatchesWildCard = endP->GetPeerPort() == 0;
-        bool remoteAddressMatchesExact = endP->GetPeerAddress() == saddr;
-        bool remoteAddressMatchesWildCard = endP->GetPeerAddress() == Ipv6Address::GetAny();
-
-        /* If remote does not match either with exact or wildcard,i
-           skip this one */
-        if (!(remotePeerMatchesExact || remotePeerMatchesWildCard))
-        {
-            continue;
-        }
-        if (!(remoteAddressMatchesExact || remoteAddressMatchesWildCard))
-        {
-            continue;
-        }
+        NS_LOG_LOGIC("No endpoint on port " << dport);
+        return retval1;
+    }
 
-        /* Now figure out which return list to add this one to */
-        if (localAddressMatchesWildCard && remotePeerMatchesWildCard &&
-            remoteAddressMatchesWildCard)
-        { /* Only local port matches exactly */
-            retval1.push_back(endP);
-        }
-        if ((localAddressMatchesExact || (localAddressMatchesAllRouters)) &&
-            remotePeerMatchesWildCard && remoteAddressMatchesWildCard)
-        { /* Only local port and local address matches exactly */
-            retval2.push_back(endP);
-        }
-        if (localAddressMatchesWildCard && remotePeerMatchesExact && remoteAddressMatchesExact)
-        { /* All but local address */
-            retval3.push_back(endP);
-        }
-        if (localAddressMatchesExact && remotePeerMatchesExact && remoteAddressMatchesExact)
-        { /* All 4 match */
-            retval4.push_back(endP);
-        }
+    // The endpoints without wildcard can only match the packet on their
+    // four-tuple.
+    auto range = m_fourTuples.equal_range({daddr, saddr, dport, sport});
+    for (auto i = range.first; i != range.second; i++)
+    {
+        Match(i->second,
+              daddr,
+              dport,
+              saddr,
+              sport,
+              incomingInterface,
+              retval1,
+              retval2,
+              retval3,
+              retval4);
+    }
+    for (Ipv6EndPoint* endP : port->second.wildcards)
+    {
+        Match(endP,
+              daddr,
+              dport,
+              saddr,
+              sport,
+              incomingInterface,
+              retval1,
+              retval2,
+              retval3,
+              retval4);
     }
 
     // Here we find the most exact match
@@ -310,18 +469,19 @@ Ipv6EndPointDemux::Lookup(Ipv6Address daddr,
 Ipv6EndPoint*
 Ipv6EndPointDemux::SimpleLookup(Ipv6Address dst, uint16_t dport, Ipv6Address src, uint16_t sport)
 {
+    auto port = m_ports.find(dport);
+    if (port == m_ports.end())
+    {
+        return nullptr;
+    }
+
     uint32_t genericity = 3;
     Ipv6EndPoint* generic = nullptr;
 
-    for (EndPointsI i = m_endPoints.begin(); i != m_endPoints.end(); i++)
+    for (EndPointsI i = port->second.endPoints.begin(); i != port->second.endPoints.end(); i++)
     {
         uint32_t tmp = 0;
 
-        if ((*i)->GetLocalPort() != dport)
-        {
-            continue;
-        }
-
         if ((*i)->GetLocalAddress() == dst && (*i)->GetPeerPort() == sport &&
             (*i)->GetPeerAddress() == src)
         {
@@ -348,26 +508,67 @@ Ipv6EndPointDemux::SimpleLookup(Ipv6Address dst, uint16_t dport, Ipv6Address src
     return generic;
 }
 
+void
+Ipv6EndPointDemux::SetEphemeralPortUsed(uint16_t port, bool used)
+{
+    if (m_usedEphemeralPorts.empty() || port < m_portFirst || port > m_portLast)
+    {
+        return;
+    }
+    uint32_t offset = port - m_portFirst;
+    uint64_t bit = uint64_t(1) << (offset % 64);
+    if (used)
+    {
+        m_usedEphemeralPorts[offset / 64] |= bit;
+    }
+    else
+    {
+        m_usedEphemeralPorts[offset / 64] &= ~bit;
+    }
+}
+
 uint16_t
 Ipv6EndPointDemux::AllocateEphemeralPort()
 {
     NS_LOG_FUNCTION(this);
-    uint16_t port = m_ephemeral;
-    int count = m_portLast - m_portFirst;
-    do
+    uint32_t nPorts = m_portLast - m_portFirst + 1;
+    if (m_usedEphemeralPorts.empty())
     {
-        if (count-- < 0)
+        m_usedEphemeralPorts.resize((nPorts + 63) / 64, 0);
+        for (const auto& port : m_ports)
         {
-            return 0;
+            SetEphemeralPortUsed(port.first, true);
         }
-        ++port;
-        if (port < m_portFirst || port > m_portLast)
+    }
+    uint32_t start = m_ephemeral + 1;
+    if (start < m_portFirst || start > m_portLast)
+    {
+        start = m_portFirst;
+    }
+    // Search from the port after the last allocated one up to the last port,
+    // then from the first port, skipping the words of used ports
+    uint32_t first = start - m_portFirst;
+    for (uint32_t pass = 0; pass < 2; pass++)
+    {
+        uint32_t offset = pass == 0 ? first : 0;
+        uint32_t end = pass == 0 ? nPorts : first;
+        while (offset < end)
         {
-            port = m_portFirst;
+            uint64_t word = m_usedEphemeralPorts[offset / 64];
+            if (offset % 64 == 0 && offset + 64 <= end && word == ~uint64_t(0))
+            {
+                offset += 64;
+                continue;
+            }
+            if (!(word & (uint64_t(1) << (offset % 64))))
+            {
+                m_ephemeral = m_portFirst + offset;
+                return m_ephemeral;
+            }
+            offset++;
         }
-    } while (LookupPortLocal(port));
-    m_ephemeral = port;
-    return port;
+    }
+    return 0;
 }
 
 Ipv6EndPointDemux::EndPoints
@@ -32,6 +32,7 @@ namespace ns3
 {
 
 class Header;
+class Ipv6EndPointDemux;
 class Packet;
 
 /**
@@ -194,6 +195,13 @@ class Ipv6EndPoint
     bool IsRxEnabled();
 
   private:
+    friend class Ipv6EndPointDemux;
+
+    /**
+     * \brief The demux the endpoint was allocated by (if any).
+     */
+    Ipv6EndPointDemux* m_demux;
+
     /**
      * \brief The local address.
      */
@@ -181,8 +181,7 @@ Ipv6StaticRouting::AddNetworkRouteTo(Ipv6Address network,
 
     if (!LookupRoute(route, metric))
     {
-        Ipv6RoutingTableEntry* routePtr = new Ipv6RoutingTableEntry(route);
-        m_networkRoutes.emplace_back(routePtr, metric);
+        AddRoute(new Ipv6RoutingTableEntry(route), metric);
     }
 }
 
@@ -208,8 +207,7 @@ Ipv6StaticRouting::AddNetworkRouteTo(Ipv6Address network,
                                                                               prefixToUse);
     if (!LookupRoute(route, metric))
     {
-        Ipv6RoutingTableEntry* routePtr = new Ipv6RoutingTableEntry(route);
-        m_networkRoutes.emplace_back(routePtr, metric);
+        AddRoute(new Ipv6RoutingTableEntry(route), metric);
     }
 }
 
@@ -225,8 +223,7 @@ Ipv6StaticRouting::AddNetworkRouteTo(Ipv6Address network,
         Ipv6RoutingTableEntry::CreateNetworkRouteTo(network, networkPrefix, interface);
     if (!LookupRoute(route, metric))
     {
-        Ipv6RoutingTableEntry* routePtr = new Ipv6RoutingTableEntry(route);
-        m_networkRoutes.emplace_back(routePtr, metric);
+        AddRoute(new Ipv6RoutingTableEntry(route), metric);
     }
 }
 
@@ -268,7 +265,7 @@ Ipv6StaticRouting::SetDefaultMulticastRoute(uint32_t outputInterface)
     Ipv6Address network = Ipv6Address("ff00::"); /* RFC 3513 */
     Ipv6Prefix networkMask = Ipv6Prefix(8);
     *route = Ipv6RoutingTableEntry::CreateNetworkRouteTo(network, networkMask, outputInterface);
-    m_networkRoutes.emplace_back(route, 0);
+    AddRoute(route, 0);
 }
 
 uint32_t
@@ -344,13 +341,9 @@ Ipv6StaticRouting::HasNetworkDest(Ipv6Address network, uint32_t interfaceIndex)
     NS_LOG_FUNCTION(this << network << interfaceIndex);
 
     /* in the network table */
-    for (NetworkRoutesI j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+    for (const auto& j : m_networkRoutesIndex.Lookup(network))
     {
-        Ipv6RoutingTableEntry* rtentry = j->first;
-        Ipv6Prefix prefix = rtentry->GetDestNetworkPrefix();
-        Ipv6Address entry = rtentry->GetDestNetwork();
-
-        if (prefix.IsMatch(network, entry) && rtentry->GetInterface() == interfaceIndex)
+        if (j.first->GetInterface() == interfaceIndex)
         {
             return true;
         }
@@ -363,15 +356,15 @@ Ipv6StaticRouting::HasNetworkDest(Ipv6Address network, uint32_t interfaceIndex)
 bool
 Ipv6StaticRouting::LookupRoute(const Ipv6RoutingTableEntry& route, uint32_t metric)
 {
-    for (NetworkRoutesI j = m_networkRoutes.begin(); j != m_networkRoutes.end(); j++)
+    for (const auto& j : m_networkRoutesIndex.Find(route.GetDest(), route.GetDestNetworkPrefix()))
     {
-        Ipv6RoutingTableEntry* rtentry = j->first;
+        Ipv6RoutingTableEntry* rtentry = j.first;
 
         if (rtentry->GetDest() == route.GetDest() &&
             rtentry->GetDestNetworkPrefix() == route.GetDestNetworkPrefix() &&
             rtentry->GetGateway() == route.GetGateway() &&
             rtentry->GetInterface() == route.GetInterface() &&
-            rtentry->GetPrefixToUse() == route.GetPrefixToUse() && j->second == metric)
+            rtentry->GetPrefixToUse() == route.GetPrefixToUse() && j.second == metric)
         {
             return true;
         }
@@ -379,6 +372,23 @@ Ipv6StaticRouting::LookupRoute(const Ipv6RoutingTableEntry& route, uint32_t metr
     return false;
 }
 
+void
+Ipv6StaticRouting::AddRoute(Ipv6RoutingTableEntry* route, uint32_t metric)
+{
+    m_networkRoutes.emplace_back(route, metric);
+    m_networkRoutesIndex.Add(route->GetDestNetwork(),
+                             route->GetDestNetworkPrefix(),
+                             m_networkRoutes.back());
+}
+
+void
+Ipv6StaticRouting::Unindex(const std::pair<Ipv6RoutingTableEntry*, uint32_t>& route)
+{
+    m_networkRoutesIndex.Remove(route.first->GetDestNetwork(),
+                                route.first->GetDestNetworkPrefix(),
+                                route);
+}
+
 Ptr<Ipv6Route>
 Ipv6StaticRouting::LookupStatic(Ipv6Address dst, Ptr<NetDevice> interface)
 {
@@ -402,72 +412,69 @@ Ipv6StaticRouting::LookupStatic(Ipv6Address dst, Ptr<NetDevice> interface)
         return rtentry;
     }
 
-    for (NetworkRoutesI it = m_networkRoutes.begin(); it != m_networkRoutes.end(); it++)
+    // the index returns the routes matching the destination, in the order of the table
+    for (const auto& it : m_networkRoutesIndex.Lookup(dst))
     {
-        Ipv6RoutingTableEntry* j = it->first;
-        uint32_t metric = it->second;
+        Ipv6RoutingTableEntry* j = it.first;
+        uint32_t metric = it.second;
         Ipv6Prefix mask = j->GetDestNetworkPrefix();
         uint16_t maskLen = mask.GetPrefixLength();
-        Ipv6Address entry = j->GetDestNetwork();
 
         NS_LOG_LOGIC("Searching for route to " << dst << ", mask length " << maskLen << ", metric "
                                                << metric);
+        NS_ASSERT(mask.IsMatch(dst, j->GetDestNetwork()));
 
-        if (mask.IsMatch(dst, entry))
-        {
-            NS_LOG_LOGIC("Found global network route " << *j << ", mask length " << maskLen
-                                                       << ", metric " << metric);
+        NS_LOG_LOGIC("Found global network route " << *j << ", mask length " << maskLen
+                                                   << ", metric " << metric);
 
-            /* if interface is given, check the route will output on this interface */
-            if (!interface || interface == m_ipv6->GetNetDevice(j->GetInterface()))
+        /* if interface is given, check the route will output on this interface */
+        if (!interface || interface == m_ipv6->GetNetDevice(j->GetInterface()))
+        {
+            if (maskLen < longestMask)
             {
-                if (maskLen < longestMask)
-                {
-                    NS_LOG_LOGIC("Previous match longer, skipping");
-                    continue;
-                }
+                NS_LOG_LOGIC("Previous match longer, skipping");
+                continue;
+            }
 
-                if (maskLen > longestMask)
-                {
-                    shortestMetric = 0xffffffff;
-                }
+            if (maskLen > longestMask)
+            {
+                shortestMetric = 0xffffffff;
+            }
 
-                longestMask = maskLen;
-                if (metric > shortestMetric)
-                {
-                    NS_LOG_LOGIC("Equal mask length, but previous metric shorter, skipping");
-                    continue;
-                }
+            longestMask = maskLen;
+            if (metric > shortestMetric)
+            {
+                NS_LOG_LOGIC("Equal mask length, but previous metric shorter, skipping");
+                continue;
+            }
 
-                shortestMetric = metric;
-                Ipv6RoutingTableEntry* route = j;
-                uint32_t interfaceIdx = route->GetInterface();
-                rtentry = Create<Ipv6Route>();
+            shortestMetric = metric;
+            Ipv6RoutingTableEntry* route = j;
+            uint32_t interfaceIdx = route->GetInterface();
+            rtentry = Create<Ipv6Route>();
 
-                if (route->GetGateway().IsAny())
-                {
-                    rtentry->SetSource(
-                        m_ipv6->SourceAddressSelection(interfaceIdx, route->GetDest()));
-                }
-                else if (route->GetDest().IsAny()) /* default route */
-                {
-                    rtentry->SetSource(m_ipv6->SourceAddressSelection(
-                        interfaceIdx,
-                        route->GetPrefixToUse().IsAny() ? dst : route->GetPrefixToUse()));
-                }
-                else
-                {
-                    rtentry->SetSource(
-                        m_ipv6->SourceAddressSelection(interfaceIdx, route->GetGateway()));
-                }
+            if (route->GetGateway().IsAny())
+            {
+                rtentry->SetSource(m_ipv6->SourceAddressSelection(interfaceIdx, route->GetDest()));
+            }
+            else if (route->GetDest().IsAny()) /* default route */
+            {
+                rtentry->SetSource(m_ipv6->SourceAddressSelection(
+                    interfaceIdx,
+                    route->GetPrefixToUse().IsAny() ? dst : route->GetPrefixToUse()));
+            }
+            else
+            {
+                rtentry->SetSource(
+                    m_ipv6->SourceAddressSelection(interfaceIdx, route->GetGateway()));
+            }
 
-                rtentry->SetDestination(route->GetDest());
-                rtentry->SetGateway(route->GetGateway());
-                rtentry->SetOutputDevice(m_ipv6->GetNetDevice(interfaceIdx));
-                if (maskLen == 128)
-                {
-                    break;
-                }
+            rtentry->SetDestination(route->GetDest());
+            rtentry->SetGateway(route->GetGateway());
+            rtentry->SetOutputDevice(m_ipv6->GetNetDevice(interfaceIdx));
+            if (maskLen == 128)
+            {
+                break;
             }
         }
     }
@@ -491,6 +498,7 @@ Ipv6StaticRouting::DoDispose()
         delete j->first;
     }
     m_networkRoutes.clear();
+    m_networkRoutesIndex.Clear();
 
     for (MulticastRoutesI i = m_multicastRoutes.begin(); i != m_multicastRoutes.end();
          i = m_multicastRoutes.erase(i))
@@ -648,6 +656,7 @@ Ipv6StaticRouting::RemoveRoute(uint32_t index)
     {
         if (tmp == index)
         {
+            Unindex(*it);
             delete it->first;
             m_networkRoutes.erase(it);
             return;
@@ -671,6 +680,7 @@ Ipv6StaticRouting::RemoveRoute(Ipv6Address network,
         if (network == rtentry->GetDest() && rtentry->GetInterface() == ifIndex &&
             rtentry->GetPrefixToUse() == prefixToUse)
         {
+            Unindex(*it);
             delete it->first;
             m_networkRoutes.erase(it);
             return;
@@ -813,6 +823,7 @@ Ipv6StaticRouting::NotifyInterfaceDown(uint32_t i)
     {
         if (it->first->GetInterface() == i)
         {
+            Unindex(*it);
             delete it->first;
             it = m_networkRoutes.erase(it);
         }
@@ -851,6 +862,7 @@ Ipv6StaticRouting::NotifyRemoveAddress(uint32_t interface, Ipv6InterfaceAddress
             it->first->GetDestNetwork() == networkAddress &&
             it->first->GetDestNetworkPrefix() == networkMask)
         {
+            Unindex(*it);
             delete it->first;
             it = m_networkRoutes.erase(it);
         }
@@ -909,6 +921,7 @@ Ipv6StaticRouting::NotifyRemoveRoute(Ipv6Address dst,
 
             if (dst == entry && prefix == mask && rtentry->GetInterface() == interface)
             {
+                Unindex(*j);
                 delete j->first;
                 j = m_networkRoutes.erase(j);
             }
@@ -25,6 +25,7 @@
 #include "ns3/ipv6-routing-protocol.h"
 #include "ns3/ipv6.h"
 #include "ns3/ptr.h"
+#include "ns3/routing-table-index.h"
 
 #include <list>
 #include <stdint.h>
@@ -296,6 +297,13 @@ class Ipv6StaticRouting : public Ipv6RoutingProtocol
     /// Iterator for container for the network routes
     typedef std::list<std::pair<Ipv6RoutingTableEntry*, uint32_t>>::iterator NetworkRoutesI;
 
+    /// Index of the network routes by destination
+    typedef RoutingTableIndex<Ipv6Address,
+                              Ipv6Prefix,
+                              Ipv6AddressHash,
+                              std::pair<Ipv6RoutingTableEntry*, uint32_t>>
+        NetworkRoutesIndex;
+
     /// Container for the multicast routes
     typedef std::list<Ipv6MulticastRoutingTableEntry*> MulticastRoutes;
 
@@ -313,6 +321,19 @@ class Ipv6StaticRouting : public Ipv6RoutingProtocol
      */
     bool LookupRoute(const Ipv6RoutingTableEntry& route, uint32_t metric);
 
+    /**
+     * \brief Add a network route to the forwarding table.
+     * \param route the route
+     * \param metric metric of route
+     */
+    void AddRoute(Ipv6RoutingTableEntry* route, uint32_t metric);
+
+    /**
+     * \brief Remove a network route from the index of the forwarding table.
+     * \param route the route and its metric
+     */
+    void Unindex(const std::pair<Ipv6RoutingTableEntry*, uint32_t>& route);
+
     /**
      * \brief Lookup in the forwarding table for destination.
      * \param dest destination address
@@ -335,6 +356,11 @@ class Ipv6StaticRouting : public Ipv6RoutingProtocol
      */
     NetworkRoutes m_networkRoutes;
 
+    /**
+     * \brief the forwarding table for network, by destination.
+     */
+    NetworkRoutesIndex m_networkRoutesIndex;
+
     /**
      * \brief the forwarding table for multicast.
      */
@@ -0,0 +1,230 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef ROUTING_TABLE_INDEX_H
+#define ROUTING_TABLE_INDEX_H
+
+#include "ns3/ipv4-address.h"
+#include "ns3/ipv6-address.h"
+
+#include <algorithm>
+#include <stdint.h>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup internet
+ *
+ * \brief Index of the routes of a routing table by destination prefix.
+ *
+ * The routing protocols keep their routes in lists, which define the order
+ * of the routes (e.g., to choose among equal cost routes), and index them
+ * here to find the routes matching a destination without walking the lists.
+ *
+ * The routes are grouped by mask (or prefix), and within a group by
+ * destination network, so the routes sharing a prefix (e.g., the equal cost
+ * routes to a host) form a single entry.  Finding the routes matching a
+ * destination costs one hash table lookup per distinct mask in the index,
+ * i.e., a few lookups in practice (host routes, subnets and default route),
+ * whatever the number of routes.  Any mask is supported, not only the
+ * contiguous ones.
+ *
+ * \tparam Address the address type (Ipv4Address or Ipv6Address)
+ * \tparam Mask the mask type (Ipv4Mask or Ipv6Prefix)
+ * \tparam AddressHash the hash function of the addresses
+ * \tparam Route the type identifying a route in the routing table
+ */
+template <typename Address, typename Mask, typename AddressHash, typename Route>
+class RoutingTableIndex
+{
+  public:
+    /**
+     * Add a route, after the routes already in the index.
+     *
+     * \param network the destination network of the route
+     * \param mask the mask of the destination network
+     * \param route the route
+     */
+    void Add(Address network, Mask mask, Route route)
+    {
+        auto group = std::find_if(m_groups.begin(), m_groups.end(), [&mask](const MaskGroup& g) {
+            return g.mask == mask;
+        });
+        if (group == m_groups.end())
+        {
+            group = m_groups.insert(m_groups.end(), MaskGroup{mask, {}});
+        }
+        group->routes[Combine(network, mask)].push_back({m_nextOrder++, route});
+    }
+
+    /**
+     * Remove a route.  Nothing is done if the route is not in the index.
+     *
+     * \param network the destination network of the route
+     * \param mask the mask of the destination network
+     * \param route the route
+     */
+    void Remove(Address network, Mask mask, Route route)
+    {
+        auto group = std::find_if(m_groups.begin(), m_groups.end(), [&mask](const MaskGroup& g) {
+            return g.mask == mask;
+        });
+        if (group == m_groups.end())
+        {
+            return;
+        }
+        auto prefix = group->routes.find(Combine(network, mask));
+        if (prefix == group->routes.end())
+        {
+            return;
+        }
+        auto& entries = prefix->second;
+        auto entry = std::find_if(entries.begin(), entries.end(), [&route](const Entry& e) {
+            return e.route == route;
+        });
+        if (entry == entries.end())
+        {
+            return;
+        }
+        entries.erase(entry);
+        if (entries.empty())
+        {
+            group->routes.erase(prefix);
+            if (group->routes.empty())
+            {
+                m_groups.erase(group);
+            }
+        }
+    }
+
+    /**
+     * Remove all the routes.
+     */
+    void Clear()
+    {
+        m_groups.clear();
+        m_matches.clear();
+        m_result.clear();
+    }
+
+    /**
+     * Get the routes to a given destination network, in the order they were added.
+     *
+     * \param network the destination network
+     * \param mask the mask of the destination network
+     * \return the routes to that network, valid until the next call to a method of the index
+     */
+    const std::vector<Route>& Find(Address network, Mask mask) const
+    {
+        m_result.clear();
+        for (const auto& group : m_groups)
+        {
+            if (group.mask == mask)
+            {
+                auto prefix = group.routes.find(Combine(network, mask));
+                if (prefix != group.routes.end())
+                {
+                    for (const auto& entry : prefix->second)
+                    {
+                        m_result.push_back(entry.route);
+                    }
+                }
+                break;
+            }
+        }
+        return m_result;
+    }
+
+    /**
+     * Get the routes whose destination network matches an address, whatever
+     * the length of their mask, in the order they were added.
+     *
+     * The returned vector is valid until the next call to a method of the index.
+     *
+     * \param dest the address
+     * \return the routes matching the address
+     */
+    const std::vector<Route>& Lookup(Address dest) const
+    {
+        m_matches.clear();
+        uint32_t nGroups = 0;
+        for (const auto& group : m_groups)
+        {
+            auto prefix = group.routes.find(Combine(dest, group.mask));
+            if (prefix != group.routes.end())
+            {
+                m_matches.insert(m_matches.end(), prefix->second.begin(), prefix->second.end());
+                nGroups++;
+            }
+        }
+        if (nGroups > 1)
+        {
+            std::sort(m_matches.begin(), m_matches.end(), [](const Entry& a, const Entry& b) {
+                return a.order < b.order;
+            });
+        }
+        m_result.clear();
+        for (const auto& entry : m_matches)
+        {
+            m_result.push_back(entry.route);
+        }
+        return m_result;
+    }
+
+  private:
+    /**
+     * \param address an address
+     * \param mask a mask
+     * \return the address masked by the mask
+     */
+    static Address Combine(Address address, const Mask& mask)
+    {
+        if constexpr (std::is_same_v<Address, Ipv4Address>)
+        {
+            return address.CombineMask(mask);
+        }
+        else
+        {
+            return address.CombinePrefix(mask);
+        }
+    }
+
+    /// A route and its rank in the order the routes were added
+    struct Entry
+    {
+        uint64_t order; //!< rank of the route
+        Route route;    //!< the route
+    };
+
+    /// The routes whose destination network has a given mask
+    struct MaskGroup
+    {
+        Mask mask;                                                           //!< the mask
+        std::unordered_map<Address, std::vector<Entry>, AddressHash> routes; //!< routes by network
+    };
+
+    std::vector<MaskGroup> m_groups;      //!< the routes, by mask
+    uint64_t m_nextOrder{0};              //!< rank of the next route added
+    mutable std::vector<Entry> m_matches; //!< the routes found by the last lookup
+    mutable std::vector<Route> m_result;  //!< the result of the last lookup
+};
+
+} // namespace ns3
+
+#endif /* ROUTING_TABLE_INDEX_H */
@@ -0,0 +1,214 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/ipv4-end-point-demux.h"
+#include "ns3/ipv4-end-point.h"
+#include "ns3/ipv4-interface-address.h"
+#include "ns3/ipv4-interface.h"
+#include "ns3/ipv6-end-point-demux.h"
+#include "ns3/ipv6-end-point.h"
+#include "ns3/test.h"
+
+using namespace ns3;
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief Ipv4EndPointDemux lookup and allocation test.
+ */
+class Ipv4EndPointDemuxTest : public TestCase
+{
+  public:
+    Ipv4EndPointDemuxTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Lookup a packet and check the endpoint it is demultiplexed to.
+     * \param demux the demux
+     * \param daddr the destination address of the packet
+     * \param saddr the source address of the packet
+     * \param sport the source port of the packet
+     * \param interface the incoming interface
+     * \param expected the expected endpoint (nullptr if none)
+     */
+    void CheckLookup(Ipv4EndPointDemux& demux,
+                     Ipv4Address daddr,
+                     Ipv4Address saddr,
+                     uint16_t sport,
+                     Ptr<Ipv4Interface> interface,
+                     Ipv4EndPoint* expected);
+};
+
+Ipv4EndPointDemuxTest::Ipv4EndPointDemuxTest()
+    : TestCase("Ipv4EndPointDemux lookup and allocation")
+{
+}
+
+void
+Ipv4EndPointDemuxTest::CheckLookup(Ipv4EndPointDemux& demux,
+                                   Ipv4Address daddr,
+                                   Ipv4Address saddr,
+                                   uint16_t sport,
+                                   Ptr<Ipv4Interface> interface,
+                                   Ipv4EndPoint* expected)
+{
+    Ipv4EndPointDemux::EndPoints endPoints = demux.Lookup(daddr, 80, saddr, sport, interface);
+    NS_TEST_ASSERT_MSG_EQ(endPoints.size(), (expected ? 1 : 0), "Wrong number of endpoints");
+    if (expected)
+    {
+        NS_TEST_ASSERT_MSG_EQ(endPoints.front(), expected, "Wrong endpoint");
+    }
+}
+
+void
+Ipv4EndPointDemuxTest::DoRun()
+{
+    Ptr<Ipv4Interface> interface = CreateObject<Ipv4Interface>();
+    interface->AddAddress(Ipv4InterfaceAddress("10.0.0.1", "255.255.255.0"));
+    Ipv4Address local("10.0.0.1");
+    Ipv4Address peer("10.0.0.2");
+    Ipv4Address other("10.0.0.3");
+
+    Ipv4EndPointDemux demux;
+    Ipv4EndPoint* any = demux.Allocate(nullptr, 80);
+    Ipv4EndPoint* bound = demux.Allocate(nullptr, local, 80);
+    Ipv4EndPoint* connected = demux.Allocate(nullptr, local, 80, peer, 1000);
+    NS_TEST_ASSERT_MSG_NE(connected, nullptr, "Connected endpoint not allocated");
+    NS_TEST_ASSERT_MSG_EQ(demux.Allocate(nullptr, local, 80, peer, 1000),
+                          nullptr,
+                          "Duplicated endpoint allocated");
+    NS_TEST_ASSERT_MSG_EQ(demux.Allocate(nullptr, local, 80), nullptr, "Duplicated endpoint");
+
+    // the most specific endpoint wins
+    CheckLookup(demux, local, peer, 1000, interface, connected);
+    CheckLookup(demux, local, peer, 1001, interface, bound);
+    CheckLookup(demux, local, other, 1000, interface, bound);
+    CheckLookup(demux, "10.0.1.1", peer, 1000, interface, any);
+
+    // endpoint bound to the network part of the address of the interface
+    Ipv4EndPoint* subnet = demux.Allocate(nullptr, "10.0.0.0", 80, other, 2000);
+    CheckLookup(demux, "10.0.0.255", other, 2000, interface, subnet);
+    CheckLookup(demux, "10.0.0.255", other, 2001, interface, any);
+
+    // the endpoint is found again after its peer changed
+    Ipv4EndPoint* client = demux.Allocate(local);
+    NS_TEST_ASSERT_MSG_EQ(client->GetLocalPort(), 49153, "Wrong first ephemeral port");
+    client->SetPeer(other, 80);
+    Ipv4EndPointDemux::EndPoints endPoints =
+        demux.Lookup(local, client->GetLocalPort(), other, 80, interface);
+    NS_TEST_ASSERT_MSG_EQ(endPoints.size(), 1, "Connected endpoint not found");
+    NS_TEST_ASSERT_MSG_EQ(endPoints.front(), client, "Wrong connected endpoint");
+    NS_TEST_ASSERT_MSG_EQ(demux.SimpleLookup(local, client->GetLocalPort(), other, 80),
+                          client,
+                          "Wrong endpoint of an ICMP error");
+
+    demux.DeAllocate(connected);
+    CheckLookup(demux, local, peer, 1000, interface, bound);
+    demux.DeAllocate(bound);
+    CheckLookup(demux, local, peer, 1000, interface, any);
+    demux.DeAllocate(subnet);
+    demux.DeAllocate(any);
+    CheckLookup(demux, local, peer, 1000, interface, nullptr);
+    NS_TEST_ASSERT_MSG_EQ(demux.LookupPortLocal(80), false, "Port 80 still in use");
+    NS_TEST_ASSERT_MSG_EQ(demux.GetAllEndPoints().size(), 1, "Wrong number of endpoints");
+
+    // the ephemeral ports are allocated in sequence, skipping the ports in use
+    NS_TEST_ASSERT_MSG_NE(demux.Allocate(nullptr, 49155), nullptr, "Port 49155 not allocated");
+    NS_TEST_ASSERT_MSG_EQ(demux.Allocate()->GetLocalPort(), 49154, "Wrong ephemeral port");
+    NS_TEST_ASSERT_MSG_EQ(demux.Allocate()->GetLocalPort(), 49156, "Wrong ephemeral port");
+    demux.DeAllocate(client);
+    for (uint32_t port = 49157; port <= 65535; port++)
+    {
+        NS_TEST_ASSERT_MSG_EQ(demux.Allocate()->GetLocalPort(), port, "Wrong ephemeral port");
+    }
+    NS_TEST_ASSERT_MSG_EQ(demux.Allocate()->GetLocalPort(), 49152, "Ephemeral ports not wrapped");
+    NS_TEST_ASSERT_MSG_EQ(demux.Allocate()->GetLocalPort(), 49153, "Free port not reused");
+    NS_TEST_ASSERT_MSG_EQ(demux.Allocate(), nullptr, "Ephemeral port allocated twice");
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief Ipv6EndPointDemux lookup and allocation test.
+ */
+class Ipv6EndPointDemuxTest : public TestCase
+{
+  public:
+    Ipv6EndPointDemuxTest();
+
+  private:
+    void DoRun() override;
+};
+
+Ipv6EndPointDemuxTest::Ipv6EndPointDemuxTest()
+    : TestCase("Ipv6EndPointDemux lookup and allocation")
+{
+}
+
+void
+Ipv6EndPointDemuxTest::DoRun()
+{
+    Ipv6Address local("2001:db8::1");
+    Ipv6Address peer("2001:db8::2");
+
+    Ipv6EndPointDemux demux;
+    Ipv6EndPoint* any = demux.Allocate(nullptr, 80);
+    Ipv6EndPoint* connected = demux.Allocate(nullptr, local, 80, peer, 1000);
+
+    Ipv6EndPointDemux::EndPoints endPoints = demux.Lookup(local, 80, peer, 1000, nullptr);
+    NS_TEST_ASSERT_MSG_EQ(endPoints.size(), 1, "Connected endpoint not found");
+    NS_TEST_ASSERT_MSG_EQ(endPoints.front(), connected, "Wrong connected endpoint");
+    endPoints = demux.Lookup(local, 80, peer, 1001, nullptr);
+    NS_TEST_ASSERT_MSG_EQ(endPoints.size(), 1, "Listening endpoint not found");
+    NS_TEST_ASSERT_MSG_EQ(endPoints.front(), any, "Wrong listening endpoint");
+
+    // the endpoint is found again after its port and peer changed
+    connected->SetLocalPort(8080);
+    connected->SetPeer(peer, 1001);
+    NS_TEST_ASSERT_MSG_EQ(demux.LookupPortLocal(8080), true, "Port 8080 not in use");
+    endPoints = demux.Lookup(local, 8080, peer, 1001, nullptr);
+    NS_TEST_ASSERT_MSG_EQ(endPoints.size(), 1, "Connected endpoint not found");
+    NS_TEST_ASSERT_MSG_EQ(endPoints.front(), connected, "Wrong connected endpoint");
+    endPoints = demux.Lookup(local, 80, peer, 1001, nullptr);
+    NS_TEST_ASSERT_MSG_EQ(endPoints.front(), any, "Wrong listening endpoint");
+
+    demux.DeAllocate(any);
+    NS_TEST_ASSERT_MSG_EQ(demux.LookupPortLocal(80), false, "Port 80 still in use");
+    NS_TEST_ASSERT_MSG_EQ(demux.Lookup(local, 80, peer, 1001, nullptr).size(),
+                          0,
+                          "Endpoint found on a free port");
+    NS_TEST_ASSERT_MSG_EQ(demux.Allocate()->GetLocalPort(), 49153, "Wrong ephemeral port");
+    NS_TEST_ASSERT_MSG_EQ(demux.GetEndPoints().size(), 2, "Wrong number of endpoints");
+}
+
+/**
+ * \ingroup internet-test
+ *
+ * \brief Endpoint demultiplexer TestSuite
+ */
+class EndPointDemuxTestSuite : public TestSuite
+{
+  public:
+    EndPointDemuxTestSuite()
+        : TestSuite("end-point-demux", UNIT)
+    {
+        AddTestCase(new Ipv4EndPointDemuxTest(), TestCase::QUICK);
+        AddTestCase(new Ipv6EndPointDemuxTest(), TestCase::QUICK);
+    }
+};
+
+static EndPointDemuxTestSuite g_endPointDemuxTestSuite; //!< Static variable for test initialization
@@ -16,12 +16,15 @@
 #include "ns3/boolean.h"
 #include "ns3/bridge-helper.h"
 #include "ns3/config.h"
+#include "ns3/global-route-manager.h"
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
 #include "ns3/ipv4-global-routing-helper.h"
 #include "ns3/ipv4-global-routing.h"
 #include "ns3/ipv4-l3-protocol.h"
+#include "ns3/ipv4-next-hop-routing.h"
+#include "ns3/ipv4-next-hop-table.h"
 #include "ns3/ipv4-packet-info-tag.h"
 #include "ns3/ipv4-routing-protocol.h"
 #include "ns3/ipv4-routing-table-entry.h"
@@ -41,6 +44,8 @@
 #include "ns3/udp-socket-factory.h"
 #include "ns3/uinteger.h"
 
+#include <sstream>
+#include <string>
 #include <vector>
 
 using namespace ns3;
@@ -1321,6 +1326,284 @@ Ipv4GlobalRoutingSlash32TestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 GlobalRouting recomputation test
+ *
+ * Computes the routes of a ring of 6 routers and of a separate line of 3
+ * routers, with several threads, and checks that they are the routes computed
+ * by a single thread.  Then takes a link of the ring down and checks that
+ * RecomputeRoutingTables () computes the routes of the ring as a full
+ * computation does, and keeps the routes of the line.
+ */
+class Ipv4GlobalRoutingRecomputeTestCase : public TestCase
+{
+  public:
+    Ipv4GlobalRoutingRecomputeTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Describe the routes of the global routing tables of some nodes
+     * \param nodes the nodes
+     * \returns the routes of each node
+     */
+    std::vector<std::vector<std::string>> GetRoutes(const NodeContainer& nodes) const;
+
+    /**
+     * \brief Compute all the routes again, without RecomputeRoutingTables ()
+     */
+    void ComputeAllRoutes() const;
+};
+
+Ipv4GlobalRoutingRecomputeTestCase::Ipv4GlobalRoutingRecomputeTestCase()
+    : TestCase("Global routing recomputation")
+{
+}
+
+std::vector<std::vector<std::string>>
+Ipv4GlobalRoutingRecomputeTestCase::GetRoutes(const NodeContainer& nodes) const
+{
+    std::vector<std::vector<std::string>> routes;
+    for (auto node = nodes.Begin(); node != nodes.End(); node++)
+    {
+        Ptr<Ipv4GlobalRouting> routing =
+            (*node)->GetObject<Ipv4>()->GetRoutingProtocol()->GetObject<Ipv4GlobalRouting>();
+        routes.emplace_back();
+        for (uint32_t i = 0; i < routing->GetNRoutes(); i++)
+        {
+            std::ostringstream oss;
+            oss << *routing->GetRoute(i);
+            routes.back().push_back(oss.str());
+        }
+    }
+    return routes;
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::ComputeAllRoutes() const
+{
+    GlobalRouteManager::DeleteGlobalRoutes();
+    GlobalRouteManager::BuildGlobalRoutingDatabase();
+    GlobalRouteManager::InitializeRoutes();
+}
+
+void
+Ipv4GlobalRoutingRecomputeTestCase::DoRun()
+{
+    NodeContainer ring;
+    ring.Create(6);
+    NodeContainer line;
+    line.Create(3);
+
+    InternetStackHelper internet;
+    Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+    internet.SetRoutingHelper(ipv4RoutingHelper);
+    internet.Install(ring);
+    internet.Install(line);
+
+    SimpleNetDeviceHelper simpleHelper;
+    simpleHelper.SetNetDevicePointToPointMode(true);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.1.0.0", "255.255.255.252");
+    for (uint32_t i = 0; i < ring.GetN(); i++)
+    {
+        NodeContainer link(ring.Get(i), ring.Get((i + 1) % ring.GetN()));
+        ipv4.Assign(simpleHelper.Install(link, CreateObject<SimpleChannel>()));
+        ipv4.NewNetwork();
+    }
+    ipv4.SetBase("10.2.0.0", "255.255.255.252");
+    for (uint32_t i = 0; i + 1 < line.GetN(); i++)
+    {
+        NodeContainer link(line.Get(i), line.Get(i + 1));
+        ipv4.Assign(simpleHelper.Install(link, CreateObject<SimpleChannel>()));
+        ipv4.NewNetwork();
+    }
+
+    GlobalRouteManager::SetNumThreads(4);
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    auto ringRoutes = GetRoutes(ring);
+    auto lineRoutes = GetRoutes(line);
+    // each router of the ring has host routes to the 2 addresses of each other
+    // router and routes to its 2 links, through both neighbors for the
+    // opposite router
+    NS_TEST_ASSERT_MSG_EQ(ringRoutes[0].size(), 24, "Wrong number of routes");
+
+    GlobalRouteManager::SetNumThreads(1);
+    ComputeAllRoutes();
+    NS_TEST_ASSERT_MSG_EQ((GetRoutes(ring) == ringRoutes),
+                          true,
+                          "The routes depend on the number of threads");
+    NS_TEST_ASSERT_MSG_EQ((GetRoutes(line) == lineRoutes),
+                          true,
+                          "The routes depend on the number of threads");
+
+    Ptr<Ipv4GlobalRouting> lineRouting =
+        line.Get(1)->GetObject<Ipv4>()->GetRoutingProtocol()->GetObject<Ipv4GlobalRouting>();
+    Ipv4RoutingTableEntry* lineRoute = lineRouting->GetRoute(0);
+
+    // take the link between the routers 0 and 1 down
+    ring.Get(0)->GetObject<Ipv4>()->SetDown(1);
+    ring.Get(1)->GetObject<Ipv4>()->SetDown(1);
+    Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+    auto recomputedRoutes = GetRoutes(ring);
+    NS_TEST_ASSERT_MSG_EQ((recomputedRoutes == ringRoutes),
+                          false,
+                          "The routes of the ring were not recomputed");
+    NS_TEST_ASSERT_MSG_EQ(lineRouting->GetRoute(0),
+                          lineRoute,
+                          "The routes of the line were recomputed");
+    NS_TEST_ASSERT_MSG_EQ((GetRoutes(line) == lineRoutes), true, "The routes of the line changed");
+
+    ComputeAllRoutes();
+    NS_TEST_ASSERT_MSG_EQ((GetRoutes(ring) == recomputedRoutes),
+                          true,
+                          "The recomputed routes differ from the computed ones");
+
+    // nothing changed since the last computation
+    Ptr<Ipv4GlobalRouting> ringRouting =
+        ring.Get(3)->GetObject<Ipv4>()->GetRoutingProtocol()->GetObject<Ipv4GlobalRouting>();
+    Ipv4RoutingTableEntry* ringRoute = ringRouting->GetRoute(0);
+    Ipv4GlobalRoutingHelper::RecomputeRoutingTables();
+    NS_TEST_ASSERT_MSG_EQ(ringRouting->GetRoute(0),
+                          ringRoute,
+                          "The routes were recomputed without changes");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief Check that the next hop table routes like the global routing
+ */
+class Ipv4NextHopTableTestCase : public TestCase
+{
+  public:
+    Ipv4NextHopTableTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Check that a routing protocol of a node routes to an address
+     * like the global routing of the node
+     * \param node the node
+     * \param routing the routing protocol
+     * \param dest the destination address
+     */
+    void CheckRoute(Ptr<Node> node, Ptr<Ipv4RoutingProtocol> routing, Ipv4Address dest);
+};
+
+Ipv4NextHopTableTestCase::Ipv4NextHopTableTestCase()
+    : TestCase("Next hop table")
+{
+}
+
+void
+Ipv4NextHopTableTestCase::CheckRoute(Ptr<Node> node,
+                                     Ptr<Ipv4RoutingProtocol> routing,
+                                     Ipv4Address dest)
+{
+    Ipv4Header header;
+    header.SetDestination(dest);
+    Socket::SocketErrno sockerr;
+    Ptr<Ipv4Route> expected =
+        node->GetObject<Ipv4>()->GetRoutingProtocol()->RouteOutput(nullptr,
+                                                                   header,
+                                                                   nullptr,
+                                                                   sockerr);
+    Ptr<Ipv4Route> route = routing->RouteOutput(nullptr, header, nullptr, sockerr);
+    NS_TEST_ASSERT_MSG_EQ(bool(route),
+                          bool(expected),
+                          "Wrong route of node " << node->GetId() << " to " << dest);
+    if (route && expected)
+    {
+        NS_TEST_ASSERT_MSG_EQ(route->GetGateway(),
+                              expected->GetGateway(),
+                              "Wrong gateway of node " << node->GetId() << " to " << dest);
+        NS_TEST_ASSERT_MSG_EQ(route->GetOutputDevice(),
+                              expected->GetOutputDevice(),
+                              "Wrong device of node " << node->GetId() << " to " << dest);
+        NS_TEST_ASSERT_MSG_EQ(route->GetSource(),
+                              expected->GetSource(),
+                              "Wrong source of node " << node->GetId() << " to " << dest);
+    }
+}
+
+void
+Ipv4NextHopTableTestCase::DoRun()
+{
+    NodeContainer ring;
+    ring.Create(6);
+    Ptr<Node> host = CreateObject<Node>();
+    NodeContainer nodes(ring, NodeContainer(host));
+
+    InternetStackHelper internet;
+    Ipv4GlobalRoutingHelper ipv4RoutingHelper;
+    internet.SetRoutingHelper(ipv4RoutingHelper);
+    internet.Install(nodes);
+
+    SimpleNetDeviceHelper simpleHelper;
+    simpleHelper.SetNetDevicePointToPointMode(true);
+    Ipv4AddressHelper ipv4;
+    ipv4.SetBase("10.1.0.0", "255.255.255.252");
+    for (uint32_t i = 0; i < ring.GetN(); i++)
+    {
+        NodeContainer link(ring.Get(i), ring.Get((i + 1) % ring.GetN()));
+        ipv4.Assign(simpleHelper.Install(link, CreateObject<SimpleChannel>()));
+        ipv4.NewNetwork();
+    }
+    // a LAN between two opposite routers of the ring and a host
+    simpleHelper.SetNetDevicePointToPointMode(false);
+    ipv4.SetBase("10.2.0.0", "255.255.255.0");
+    NodeContainer lan(ring.Get(0), ring.Get(3), host);
+    ipv4.Assign(simpleHelper.Install(lan, CreateObject<SimpleChannel>()));
+
+    Ipv4GlobalRoutingHelper::PopulateRoutingTables();
+    Ptr<Ipv4NextHopTable> table = Create<Ipv4NextHopTable>();
+    GlobalRouteManager::ComputeNextHopTable(table);
+    NS_TEST_ASSERT_MSG_EQ(table->HasRouter(host->GetId()), true, "The host is not in the table");
+    Ipv4Address farAddress = ring.Get(1)->GetObject<Ipv4>()->GetAddress(1, 0).GetLocal();
+    NS_TEST_ASSERT_MSG_NE(table->Lookup(host->GetId(), farAddress),
+                          nullptr,
+                          "No next hop from the host to " << farAddress);
+
+    std::string filename = CreateTempDirFilename("next-hop-table");
+    table->Save(filename);
+    Ptr<Ipv4NextHopTable> loaded = Create<Ipv4NextHopTable>();
+    loaded->Load(filename);
+    NS_TEST_ASSERT_MSG_EQ(loaded->GetNDestinations(),
+                          table->GetNDestinations(),
+                          "Wrong number of destinations of the loaded table");
+
+    for (auto node = nodes.Begin(); node != nodes.End(); node++)
+    {
+        for (const auto& nextHops : {table, loaded})
+        {
+            Ptr<Ipv4NextHopRouting> routing = CreateObject<Ipv4NextHopRouting>();
+            routing->SetTable(nextHops);
+            routing->SetIpv4((*node)->GetObject<Ipv4>());
+            for (auto other = nodes.Begin(); other != nodes.End(); other++)
+            {
+                Ptr<Ipv4> otherIpv4 = (*other)->GetObject<Ipv4>();
+                for (uint32_t i = 1; i < otherIpv4->GetNInterfaces(); i++)
+                {
+                    CheckRoute(*node, routing, otherIpv4->GetAddress(i, 0).GetLocal());
+                }
+            }
+            CheckRoute(*node, routing, Ipv4Address("10.3.0.1"));
+            routing->Dispose();
+        }
+    }
+
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -1344,6 +1627,8 @@ Ipv4GlobalRoutingTestSuite::Ipv4GlobalRoutingTestSuite()
     AddTestCase(new TwoBridgeTest, TestCase::QUICK);
     AddTestCase(new Ipv4DynamicGlobalRoutingTestCase, TestCase::QUICK);
     AddTestCase(new Ipv4GlobalRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase(new Ipv4GlobalRoutingRecomputeTestCase, TestCase::QUICK);
+    AddTestCase(new Ipv4NextHopTableTestCase, TestCase::QUICK);
 }
 
 static Ipv4GlobalRoutingTestSuite
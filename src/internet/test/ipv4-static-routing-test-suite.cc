@@ -20,6 +20,8 @@
 #include "ns3/inet-socket-address.h"
 #include "ns3/internet-stack-helper.h"
 #include "ns3/ipv4-address-helper.h"
+#include "ns3/ipv4-route.h"
+#include "ns3/ipv4-routing-table-entry.h"
 #include "ns3/ipv4-static-routing-helper.h"
 #include "ns3/node-container.h"
 #include "ns3/node.h"
@@ -208,6 +210,155 @@ Ipv4StaticRoutingSlash32TestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup internet-test
+ * \ingroup tests
+ *
+ * \brief IPv4 StaticRouting route selection Test
+ *
+ * Checks that the route chosen for a destination is the one with the longest
+ * mask and then with the lowest metric, among many host routes, and that the
+ * removed routes are no longer chosen.
+ */
+class Ipv4StaticRoutingLookupTestCase : public TestCase
+{
+  public:
+    Ipv4StaticRoutingLookupTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * \brief Get the gateway of the route to a destination.
+     * \param dest The destination.
+     * \param oif The output device, if any.
+     * \return The gateway, or 255.255.255.255 if there is no route.
+     */
+    Ipv4Address GetGateway(Ipv4Address dest, Ptr<NetDevice> oif = nullptr);
+
+    Ptr<Ipv4StaticRouting> m_routing; //!< Routing protocol under test
+};
+
+Ipv4StaticRoutingLookupTestCase::Ipv4StaticRoutingLookupTestCase()
+    : TestCase("Static routing route selection")
+{
+}
+
+Ipv4Address
+Ipv4StaticRoutingLookupTestCase::GetGateway(Ipv4Address dest, Ptr<NetDevice> oif)
+{
+    Ipv4Header header;
+    header.SetDestination(dest);
+    Socket::SocketErrno sockerr;
+    Ptr<Ipv4Route> route = m_routing->RouteOutput(nullptr, header, oif, sockerr);
+    return route ? route->GetGateway() : Ipv4Address::GetBroadcast();
+}
+
+void
+Ipv4StaticRoutingLookupTestCase::DoRun()
+{
+    Ptr<Node> node = CreateObject<Node>();
+    InternetStackHelper internet;
+    internet.Install(node);
+    Ptr<Ipv4> ipv4 = node->GetObject<Ipv4>();
+
+    std::vector<Ptr<NetDevice>> devices;
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        Ptr<SimpleNetDevice> device = CreateObject<SimpleNetDevice>();
+        device->SetAddress(Mac48Address::Allocate());
+        node->AddDevice(device);
+        int32_t ifIndex = ipv4->AddInterface(device);
+        ipv4->AddAddress(ifIndex,
+                         Ipv4InterfaceAddress(Ipv4Address(0x0a000001 + (i << 8)), Ipv4Mask("/24")));
+        ipv4->SetUp(ifIndex);
+        devices.push_back(device);
+    }
+
+    Ipv4StaticRoutingHelper ipv4RoutingHelper;
+    m_routing = ipv4RoutingHelper.GetStaticRouting(ipv4);
+    m_routing->SetDefaultRoute(Ipv4Address("10.0.0.2"), 1);
+    m_routing->AddNetworkRouteTo(Ipv4Address("192.168.0.0"),
+                                 Ipv4Mask("/16"),
+                                 Ipv4Address("10.0.0.3"),
+                                 1);
+    m_routing->AddNetworkRouteTo(Ipv4Address("192.168.1.0"),
+                                 Ipv4Mask("/24"),
+                                 Ipv4Address("10.0.1.2"),
+                                 2,
+                                 10);
+    m_routing->AddNetworkRouteTo(Ipv4Address("192.168.1.0"),
+                                 Ipv4Mask("/24"),
+                                 Ipv4Address("10.0.1.3"),
+                                 2,
+                                 5);
+    m_routing->AddHostRouteTo(Ipv4Address("192.168.1.7"), Ipv4Address("10.0.0.9"), 1);
+    for (uint32_t i = 0; i < 2000; i++)
+    {
+        // the hosts 172.16.0.0 to 172.16.7.207, through 10.0.1.10 to 10.0.1.19
+        m_routing->AddHostRouteTo(Ipv4Address(0xac100000 + i),
+                                  Ipv4Address(0x0a00010a + i % 10),
+                                  2);
+    }
+
+    NS_TEST_EXPECT_MSG_EQ(GetGateway(Ipv4Address("8.8.8.8")),
+                          Ipv4Address("10.0.0.2"),
+                          "The default route was not chosen");
+    NS_TEST_EXPECT_MSG_EQ(GetGateway(Ipv4Address("10.0.1.5")),
+                          Ipv4Address::GetZero(),
+                          "The route to the network of the interface was not chosen");
+    NS_TEST_EXPECT_MSG_EQ(GetGateway(Ipv4Address("192.168.2.1")),
+                          Ipv4Address("10.0.0.3"),
+                          "The /16 route was not chosen");
+    NS_TEST_EXPECT_MSG_EQ(GetGateway(Ipv4Address("192.168.1.1")),
+                          Ipv4Address("10.0.1.3"),
+                          "The /24 route with the lowest metric was not chosen");
+    NS_TEST_EXPECT_MSG_EQ(GetGateway(Ipv4Address("192.168.1.7")),
+                          Ipv4Address("10.0.0.9"),
+                          "The host route was not chosen");
+    NS_TEST_EXPECT_MSG_EQ(GetGateway(Ipv4Address("192.168.1.1"), devices[0]),
+                          Ipv4Address("10.0.0.3"),
+                          "The route through the requested device was not chosen");
+    NS_TEST_EXPECT_MSG_EQ(GetGateway(Ipv4Address("172.16.3.235")),
+                          Ipv4Address("10.0.1.13"),
+                          "The host route was not chosen");
+    NS_TEST_EXPECT_MSG_EQ(GetGateway(Ipv4Address("172.16.7.208")),
+                          Ipv4Address("10.0.0.2"),
+                          "The default route was not chosen");
+
+    // remove the /24 route with the lowest metric and the first host route
+    for (uint32_t i = 0; i < m_routing->GetNRoutes(); i++)
+    {
+        Ipv4RoutingTableEntry route = m_routing->GetRoute(i);
+        if ((route.GetDestNetworkMask() == Ipv4Mask("/24") && m_routing->GetMetric(i) == 5) ||
+            route.GetDest() == Ipv4Address("172.16.0.0"))
+        {
+            m_routing->RemoveRoute(i--);
+        }
+    }
+    NS_TEST_EXPECT_MSG_EQ(GetGateway(Ipv4Address("192.168.1.1")),
+                          Ipv4Address("10.0.1.2"),
+                          "The remaining /24 route was not chosen");
+    NS_TEST_EXPECT_MSG_EQ(GetGateway(Ipv4Address("172.16.0.0")),
+                          Ipv4Address("10.0.0.2"),
+                          "A removed host route was chosen");
+    NS_TEST_EXPECT_MSG_EQ(GetGateway(Ipv4Address("172.16.0.1")),
+                          Ipv4Address("10.0.1.11"),
+                          "The host route was not chosen");
+
+    // the routes through an interface are removed when it goes down
+    ipv4->SetDown(2);
+    NS_TEST_EXPECT_MSG_EQ(GetGateway(Ipv4Address("172.16.0.1")),
+                          Ipv4Address("10.0.0.2"),
+                          "A route through an interface down was chosen");
+    NS_TEST_EXPECT_MSG_EQ(GetGateway(Ipv4Address("192.168.1.1")),
+                          Ipv4Address("10.0.0.3"),
+                          "A route through an interface down was chosen");
+
+    m_routing = nullptr;
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup internet-test
  * \ingroup tests
@@ -224,6 +375,7 @@ Ipv4StaticRoutingTestSuite::Ipv4StaticRoutingTestSuite()
     : TestSuite("ipv4-static-routing", UNIT)
 {
     AddTestCase(new Ipv4StaticRoutingSlash32TestCase, TestCase::QUICK);
+    AddTestCase(new Ipv4StaticRoutingLookupTestCase, TestCase::QUICK);
 }
 
 static Ipv4StaticRoutingTestSuite
@@ -0,0 +1,232 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "spatial-grid.h"
+
+#include "mobility-model.h"
+
+#include "ns3/assert.h"
+#include "ns3/log.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3
+{
+
+NS_LOG_COMPONENT_DEFINE("SpatialGrid");
+
+SpatialGrid::SpatialGrid(double cellSize)
+    : m_cellSize(cellSize)
+{
+    NS_LOG_FUNCTION(this << cellSize);
+    NS_ASSERT_MSG(cellSize > 0, "The cells of a SpatialGrid must have a positive size");
+}
+
+SpatialGrid::~SpatialGrid()
+{
+    NS_LOG_FUNCTION(this);
+    Clear();
+}
+
+uint32_t
+SpatialGrid::Add(Ptr<MobilityModel> mobility)
+{
+    NS_LOG_FUNCTION(this << mobility);
+    auto index = static_cast<uint32_t>(m_items.size());
+    m_items.push_back({mobility, false, false, 0, Vector()});
+    if (mobility)
+    {
+        std::vector<uint32_t>& indices = m_indices[mobility];
+        if (indices.empty())
+        {
+            mobility->TraceConnectWithoutContext(
+                "CourseChange",
+                MakeCallback(&SpatialGrid::CourseChanged, this));
+        }
+        indices.push_back(index);
+    }
+    Insert(index);
+    return index;
+}
+
+void
+SpatialGrid::Clear()
+{
+    NS_LOG_FUNCTION(this);
+    for (auto& [mobility, indices] : m_indices)
+    {
+        ConstCast<MobilityModel>(mobility)->TraceDisconnectWithoutContext(
+            "CourseChange",
+            MakeCallback(&SpatialGrid::CourseChanged, this));
+    }
+    m_indices.clear();
+    m_items.clear();
+    m_cells.clear();
+    m_outside.clear();
+    m_changed.clear();
+}
+
+uint32_t
+SpatialGrid::GetN() const
+{
+    return m_items.size();
+}
+
+void
+SpatialGrid::GetWithinDistance(const Vector& position,
+                               double distance,
+                               std::vector<uint32_t>& indices)
+{
+    NS_LOG_FUNCTION(this << position << distance);
+    Update();
+    indices.clear();
+    auto addWithinDistance = [&](const std::vector<uint32_t>& cell) {
+        for (uint32_t index : cell)
+        {
+            if (CalculateDistance(position, m_items[index].position) <= distance)
+            {
+                indices.push_back(index);
+            }
+        }
+    };
+    // The cells are checked around the point when they are fewer than the
+    // cells of the grid, and all the cells of the grid are checked otherwise.
+    double k = std::ceil(distance / m_cellSize);
+    if ((2 * k + 1) * (2 * k + 1) < m_cells.size())
+    {
+        auto x = static_cast<int64_t>(std::floor(position.x / m_cellSize));
+        auto y = static_cast<int64_t>(std::floor(position.y / m_cellSize));
+        auto n = static_cast<int64_t>(k);
+        for (int64_t i = x - n; i <= x + n; i++)
+        {
+            for (int64_t j = y - n; j <= y + n; j++)
+            {
+                auto it = m_cells.find(GetCell(i, j));
+                if (it != m_cells.end())
+                {
+                    addWithinDistance(it->second);
+                }
+            }
+        }
+    }
+    else
+    {
+        for (const auto& [key, cell] : m_cells)
+        {
+            addWithinDistance(cell);
+        }
+    }
+    // Looking up the position of a MobilityModel may notify a course change,
+    // which is applied at the next lookup.
+    for (uint32_t index : m_outside)
+    {
+        const Ptr<MobilityModel>& mobility = m_items[index].mobility;
+        if (!mobility || CalculateDistance(position, mobility->GetPosition()) <= distance)
+        {
+            indices.push_back(index);
+        }
+    }
+    std::sort(indices.begin(), indices.end());
+}
+
+void
+SpatialGrid::CourseChanged(Ptr<const MobilityModel> mobility)
+{
+    NS_LOG_FUNCTION(this << mobility);
+    auto it = m_indices.find(mobility);
+    NS_ASSERT(it != m_indices.end());
+    for (uint32_t index : it->second)
+    {
+        if (!m_items[index].changed)
+        {
+            m_items[index].changed = true;
+            m_changed.push_back(index);
+        }
+    }
+}
+
+void
+SpatialGrid::Update()
+{
+    NS_LOG_FUNCTION(this);
+    // Moving a MobilityModel may notify other course changes, which are
+    // appended to m_changed and hence applied by this loop too.
+    for (std::size_t i = 0; i < m_changed.size(); i++)
+    {
+        uint32_t index = m_changed[i];
+        m_items[index].changed = false;
+        Erase(index);
+        Insert(index);
+    }
+    m_changed.clear();
+}
+
+uint64_t
+SpatialGrid::GetCell(double x, double y) const
+{
+    return GetCell(static_cast<int64_t>(std::floor(x / m_cellSize)),
+                   static_cast<int64_t>(std::floor(y / m_cellSize)));
+}
+
+uint64_t
+SpatialGrid::GetCell(int64_t i, int64_t j)
+{
+    // Distant cells may share a key: the lookups check the distance of the
+    // MobilityModels found anyway.
+    return (static_cast<uint64_t>(i) << 32) ^ (static_cast<uint64_t>(j) & 0xffffffff);
+}
+
+void
+SpatialGrid::Insert(uint32_t index)
+{
+    NS_LOG_FUNCTION(this << index);
+    Item& item = m_items[index];
+    if (item.mobility && item.mobility->GetVelocity() == Vector())
+    {
+        item.inGrid = true;
+        item.position = item.mobility->GetPosition();
+        item.cell = GetCell(item.position.x, item.position.y);
+        m_cells[item.cell].push_back(index);
+    }
+    else
+    {
+        item.inGrid = false;
+        m_outside.push_back(index);
+    }
+}
+
+void
+SpatialGrid::Erase(uint32_t index)
+{
+    NS_LOG_FUNCTION(this << index);
+    Item& item = m_items[index];
+    if (item.inGrid)
+    {
+        auto it = m_cells.find(item.cell);
+        NS_ASSERT(it != m_cells.end());
+        it->second.erase(std::find(it->second.begin(), it->second.end(), index));
+        if (it->second.empty())
+        {
+            m_cells.erase(it);
+        }
+    }
+    else
+    {
+        m_outside.erase(std::find(m_outside.begin(), m_outside.end(), index));
+    }
+}
+
+} // namespace ns3
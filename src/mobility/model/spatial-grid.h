@@ -0,0 +1,160 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include "ns3/ptr.h"
+#include "ns3/simple-ref-count.h"
+#include "ns3/vector.h"
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace ns3
+{
+
+class MobilityModel;
+
+/**
+ * \ingroup mobility
+ * \brief An index of the positions of a set of MobilityModels, to find
+ * those which are within some distance of a point.
+ *
+ * The MobilityModels which do not move are stored in the square cells
+ * of a grid of the x-y plane, according to their position. The
+ * MobilityModels which move, and the missing ones, are not stored in the
+ * grid: they are always checked by the lookups. The grid follows the
+ * course changes of the MobilityModels, which it applies at the next lookup,
+ * so that a MobilityModel which stops moving is stored in the grid, and one
+ * which starts moving is taken out of it. The MobilityModels which move are
+ * thus expected to report a non-zero velocity and to notify their course
+ * changes, as those of ns-3 do.
+ *
+ * The channels use it to find the receivers within their range in a time
+ * which depends on the number of receivers near the transmitter, rather
+ * than on the number of receivers attached to the channel.
+ */
+class SpatialGrid : public SimpleRefCount<SpatialGrid>
+{
+  public:
+    /**
+     * Create an empty grid.
+     *
+     * \param cellSize The size of the side of the cells of the grid, in meters,
+     *        best set to the distance of the lookups.
+     */
+    SpatialGrid(double cellSize);
+    ~SpatialGrid();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    SpatialGrid(const SpatialGrid&) = delete;
+    SpatialGrid& operator=(const SpatialGrid&) = delete;
+
+    /**
+     * Add a MobilityModel to the grid.
+     *
+     * \param mobility The MobilityModel, or nullptr if there is none.
+     * \return The index of the MobilityModel, that is the number of
+     *         MobilityModels added before it.
+     */
+    uint32_t Add(Ptr<MobilityModel> mobility);
+    /**
+     * Remove all the MobilityModels from the grid.
+     */
+    void Clear();
+    /**
+     * \return The number of MobilityModels added to the grid.
+     */
+    uint32_t GetN() const;
+    /**
+     * Find the MobilityModels which are within some distance of a point.
+     *
+     * The missing MobilityModels are always found.
+     *
+     * \param [in] position The point.
+     * \param [in] distance The distance, in meters.
+     * \param [out] indices The indices of the MobilityModels found, in
+     *              increasing order.
+     */
+    void GetWithinDistance(const Vector& position,
+                           double distance,
+                           std::vector<uint32_t>& indices);
+
+  private:
+    /**
+     * Record the course change of a MobilityModel, to be applied at the
+     * next lookup.
+     *
+     * \param mobility The MobilityModel whose course changed.
+     */
+    void CourseChanged(Ptr<const MobilityModel> mobility);
+    /**
+     * Move the MobilityModels whose course changed to the cells of their
+     * positions, or out of the grid if they move.
+     */
+    void Update();
+    /**
+     * \param x The x coordinate of a point.
+     * \param y The y coordinate of a point.
+     * \return The key of the cell containing the point.
+     */
+    uint64_t GetCell(double x, double y) const;
+    /**
+     * \param i The index of a coordinate of a cell.
+     * \param j The index of the other coordinate of the cell.
+     * \return The key of the cell.
+     */
+    static uint64_t GetCell(int64_t i, int64_t j);
+    /**
+     * Store a MobilityModel in the cell of its position, or in the list of
+     * MobilityModels which are checked by every lookup.
+     *
+     * \param index The index of the MobilityModel.
+     */
+    void Insert(uint32_t index);
+    /**
+     * Remove a MobilityModel from its cell, or from the list of
+     * MobilityModels which are checked by every lookup.
+     *
+     * \param index The index of the MobilityModel.
+     */
+    void Erase(uint32_t index);
+
+    /// A MobilityModel added to the grid.
+    struct Item
+    {
+        Ptr<MobilityModel> mobility; //!< The MobilityModel
+        bool inGrid;                 //!< Whether it is stored in a cell
+        bool changed;                //!< Whether its course changed since the last lookup
+        uint64_t cell;               //!< The key of its cell, if it is stored in one
+        Vector position;             //!< Its position, if it is stored in a cell
+    };
+
+    /// The indices of each MobilityModel, which can be added several times.
+    typedef std::unordered_map<Ptr<const MobilityModel>, std::vector<uint32_t>> IndexMap;
+
+    double m_cellSize;                                           //!< The size of the cells
+    std::vector<Item> m_items;                                   //!< The MobilityModels
+    IndexMap m_indices;                                          //!< Their indices
+    std::unordered_map<uint64_t, std::vector<uint32_t>> m_cells; //!< The cells of the grid
+    std::vector<uint32_t> m_outside; //!< The MobilityModels which are not in the grid
+    std::vector<uint32_t> m_changed; //!< The MobilityModels whose course changed
+};
+
+} // namespace ns3
+
+#endif /* SPATIAL_GRID_H */
@@ -0,0 +1,148 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
+#include "ns3/simulator.h"
+#include "ns3/spatial-grid.h"
+#include "ns3/test.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief Check that a SpatialGrid finds the MobilityModels within some
+ * distance of a point, while they are moved.
+ */
+class SpatialGridTestCase : public TestCase
+{
+  public:
+    SpatialGridTestCase();
+
+  private:
+    void DoRun() override;
+    /**
+     * Check the MobilityModels found by a lookup.
+     *
+     * \param grid The grid.
+     * \param position The point looked up.
+     * \param distance The distance looked up.
+     * \param expected The indices of the MobilityModels expected.
+     */
+    void Check(Ptr<SpatialGrid> grid,
+               const Vector& position,
+               double distance,
+               const std::vector<uint32_t>& expected);
+};
+
+SpatialGridTestCase::SpatialGridTestCase()
+    : TestCase("Check the MobilityModels found by a SpatialGrid")
+{
+}
+
+void
+SpatialGridTestCase::Check(Ptr<SpatialGrid> grid,
+                           const Vector& position,
+                           double distance,
+                           const std::vector<uint32_t>& expected)
+{
+    std::vector<uint32_t> indices;
+    grid->GetWithinDistance(position, distance, indices);
+    NS_TEST_ASSERT_MSG_EQ(indices.size(), expected.size(), "Wrong number of MobilityModels found");
+    for (std::size_t i = 0; i < indices.size() && i < expected.size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(indices[i], expected[i], "Wrong MobilityModel found");
+    }
+}
+
+void
+SpatialGridTestCase::DoRun()
+{
+    Ptr<SpatialGrid> grid = Create<SpatialGrid>(100);
+    std::vector<Ptr<ConstantPositionMobilityModel>> models;
+    for (Vector position : {Vector(0, 0, 0),
+                            Vector(50, 0, 0),
+                            Vector(150, 0, 0),
+                            Vector(0, -99, 10),
+                            Vector(1000, 1000, 0),
+                            Vector(-70, -70, 0)})
+    {
+        Ptr<ConstantPositionMobilityModel> model = CreateObject<ConstantPositionMobilityModel>();
+        model->SetPosition(position);
+        models.push_back(model);
+        NS_TEST_EXPECT_MSG_EQ(grid->Add(model), models.size() - 1, "Wrong index");
+    }
+    // A missing MobilityModel is always found
+    NS_TEST_EXPECT_MSG_EQ(grid->Add(nullptr), 6, "Wrong index");
+    // A MobilityModel may be added several times
+    NS_TEST_EXPECT_MSG_EQ(grid->Add(models[1]), 7, "Wrong index");
+    NS_TEST_EXPECT_MSG_EQ(grid->GetN(), 8, "Wrong number of MobilityModels");
+
+    Check(grid, Vector(0, 0, 0), 100, {0, 1, 3, 5, 6, 7});
+    Check(grid, Vector(0, 0, 0), 99, {0, 1, 5, 6, 7});
+    Check(grid, Vector(100, 0, 0), 50, {1, 2, 6, 7});
+    Check(grid, Vector(0, 0, 0), 2000, {0, 1, 2, 3, 4, 5, 6, 7});
+    Check(grid, Vector(-5000, 0, 0), 100, {6});
+
+    // The course changes are followed
+    models[2]->SetPosition(Vector(10, 10, 0));
+    models[1]->SetPosition(Vector(500, 0, 0));
+    Check(grid, Vector(0, 0, 0), 100, {0, 2, 3, 5, 6});
+    Check(grid, Vector(450, 0, 0), 100, {1, 6, 7});
+
+    // The MobilityModels which move are found where they are
+    Ptr<ConstantVelocityMobilityModel> moving = CreateObject<ConstantVelocityMobilityModel>();
+    moving->SetPosition(Vector(500, 0, 0));
+    moving->SetVelocity(Vector(-10, 0, 0));
+    NS_TEST_EXPECT_MSG_EQ(grid->Add(moving), 8, "Wrong index");
+    Check(grid, Vector(0, 0, 0), 100, {0, 2, 3, 5, 6});
+    Simulator::Stop(Seconds(45));
+    Simulator::Run();
+    Check(grid, Vector(0, 0, 0), 100, {0, 2, 3, 5, 6, 8});
+    moving->SetVelocity(Vector(0, 0, 0));
+    Check(grid, Vector(0, 0, 0), 100, {0, 2, 3, 5, 6, 8});
+    Check(grid, Vector(50, 0, 0), 0, {6, 8});
+    Simulator::Destroy();
+
+    grid->Clear();
+    NS_TEST_EXPECT_MSG_EQ(grid->GetN(), 0, "The grid is not empty");
+    Check(grid, Vector(0, 0, 0), 100, {});
+    models[0]->SetPosition(Vector(1, 0, 0));
+    Check(grid, Vector(0, 0, 0), 100, {});
+}
+
+/**
+ * \ingroup mobility-test
+ * \ingroup tests
+ *
+ * \brief SpatialGrid test suite.
+ */
+class SpatialGridTestSuite : public TestSuite
+{
+  public:
+    SpatialGridTestSuite();
+};
+
+SpatialGridTestSuite::SpatialGridTestSuite()
+    : TestSuite("spatial-grid", UNIT)
+{
+    AddTestCase(new SpatialGridTestCase, TestCase::QUICK);
+}
+
+static SpatialGridTestSuite g_spatialGridTestSuite; ///< the test suite
@@ -137,6 +137,8 @@ class DistributedSimulatorImpl : public SimulatorImpl
     void SetScheduler(ObjectFactory schedulerFactory) override;
     uint32_t GetSystemId() const override;
     uint32_t GetContext() const override;
+    void SetContext(uint32_t context) override;
+    bool IsLocalContext(uint32_t context) const override;
     uint64_t GetEventCount() const override;
 
     /**
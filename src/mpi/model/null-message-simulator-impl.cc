@@ -36,6 +36,7 @@
 #include <ns3/event-impl.h>
 #include <ns3/log.h>
 #include <ns3/node-container.h>
+#include <ns3/node-list.h>
 #include <ns3/pointer.h>
 #include <ns3/ptr.h>
 #include <ns3/scheduler.h>
@@ -558,6 +559,24 @@ NullMessageSimulatorImpl::GetContext() const
     return m_currentContext;
 }
 
+void
+NullMessageSimulatorImpl::SetContext(uint32_t context)
+{
+    m_currentContext = context;
+}
+
+bool
+NullMessageSimulatorImpl::IsLocalContext(uint32_t context) const
+{
+    // the context of an event is the id of its node, whose events only run
+    // on the rank of its system id
+    if (context >= NodeList::GetNNodes())
+    {
+        return true;
+    }
+    return NodeList::GetNode(context)->GetSystemId() == m_myId;
+}
+
 uint64_t
 NullMessageSimulatorImpl::GetEventCount() const
 {
@@ -0,0 +1,253 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "logical-process.h"
+
+#include <ns3/assert.h>
+#include <ns3/event-impl.h>
+#include <ns3/log.h>
+#include <ns3/simulator.h>
+
+#include <algorithm>
+
+/**
+ * \file
+ * \ingroup mtp
+ * Implementation of class ns3::LogicalProcess.
+ */
+
+namespace ns3
+{
+
+// Logging in the per-event paths is avoided, as in DefaultSimulatorImpl.
+NS_LOG_COMPONENT_DEFINE("LogicalProcess");
+
+LogicalProcess::LogicalProcess(uint32_t id, ObjectFactory schedulerFactory)
+    : m_id(id),
+      m_events(schedulerFactory.Create<Scheduler>()),
+      m_uid(EventId::UID::VALID),
+      m_currentUid(EventId::UID::INVALID),
+      m_currentTs(0),
+      m_currentContext(Simulator::NO_CONTEXT),
+      m_eventCount(0),
+      m_sequence(0)
+{
+    NS_LOG_FUNCTION(this << id);
+}
+
+LogicalProcess::~LogicalProcess()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+uint32_t
+LogicalProcess::GetId() const
+{
+    return m_id;
+}
+
+void
+LogicalProcess::SetScheduler(ObjectFactory schedulerFactory)
+{
+    NS_LOG_FUNCTION(this << schedulerFactory);
+    Ptr<Scheduler> scheduler = schedulerFactory.Create<Scheduler>();
+    while (!m_events->IsEmpty())
+    {
+        scheduler->Insert(m_events->RemoveNext());
+    }
+    m_events = scheduler;
+}
+
+EventId
+LogicalProcess::Insert(uint64_t ts, uint32_t context, EventImpl* event)
+{
+    NS_ASSERT_MSG(ts >= m_currentTs, "LogicalProcess::Insert(): event in the past");
+    Scheduler::Event ev;
+    ev.impl = event;
+    ev.key.m_ts = ts;
+    ev.key.m_context = context;
+    ev.key.m_uid = m_uid;
+    m_uid++;
+    m_events->Insert(ev);
+    return EventId(event, ev.key.m_ts, ev.key.m_context, ev.key.m_uid);
+}
+
+void
+LogicalProcess::Adopt(const Scheduler::Event& ev)
+{
+    m_uid = std::max(m_uid, ev.key.m_uid + 1);
+    m_events->Insert(ev);
+}
+
+void
+LogicalProcess::Post(uint64_t ts,
+                     uint32_t context,
+                     EventImpl* event,
+                     uint32_t source,
+                     uint64_t sequence)
+{
+    std::unique_lock lock{m_messagesMutex};
+    m_messages.push_back({ts, context, source, sequence, event});
+}
+
+void
+LogicalProcess::ReceiveMessages()
+{
+    // Only called between rounds, when no thread posts to this mailbox.
+    if (m_messages.empty())
+    {
+        return;
+    }
+    // The arrival order depends on thread scheduling: sort the messages
+    // so that the uids, hence the order of simultaneous events, do not.
+    std::sort(m_messages.begin(), m_messages.end(), [](const Message& a, const Message& b) {
+        if (a.ts != b.ts)
+        {
+            return a.ts < b.ts;
+        }
+        if (a.source != b.source)
+        {
+            return a.source < b.source;
+        }
+        return a.sequence < b.sequence;
+    });
+    for (const auto& message : m_messages)
+    {
+        Insert(message.ts, message.context, message.event);
+    }
+    m_messages.clear();
+}
+
+uint64_t
+LogicalProcess::NextSequence()
+{
+    return m_sequence++;
+}
+
+bool
+LogicalProcess::IsEmpty() const
+{
+    return m_events->IsEmpty();
+}
+
+uint64_t
+LogicalProcess::GetNextTs() const
+{
+    NS_ASSERT(!m_events->IsEmpty());
+    return m_events->PeekNext().key.m_ts;
+}
+
+Scheduler::Event
+LogicalProcess::RemoveNext()
+{
+    return m_events->RemoveNext();
+}
+
+void
+LogicalProcess::ProcessOneEvent()
+{
+    Scheduler::Event next = m_events->RemoveNext();
+
+    NS_ASSERT(next.key.m_ts >= m_currentTs);
+    m_eventCount++;
+
+    m_currentTs = next.key.m_ts;
+    m_currentContext = next.key.m_context;
+    m_currentUid = next.key.m_uid;
+    next.impl->Invoke();
+    next.impl->Unref();
+}
+
+void
+LogicalProcess::ProcessEventsUntil(uint64_t end, const std::atomic<bool>& stop)
+{
+    while (!m_events->IsEmpty() && m_events->PeekNext().key.m_ts < end &&
+           !stop.load(std::memory_order_relaxed))
+    {
+        ProcessOneEvent();
+    }
+}
+
+void
+LogicalProcess::Remove(const EventId& id)
+{
+    if (IsExpired(id))
+    {
+        return;
+    }
+    Scheduler::Event event;
+    event.impl = id.PeekEventImpl();
+    event.key.m_ts = id.GetTs();
+    event.key.m_context = id.GetContext();
+    event.key.m_uid = id.GetUid();
+    m_events->Remove(event);
+    event.impl->Cancel();
+    // whenever we remove an event from the event list, we have to unref it.
+    event.impl->Unref();
+}
+
+bool
+LogicalProcess::IsExpired(const EventId& id) const
+{
+    return id.PeekEventImpl() == nullptr || id.GetTs() < m_currentTs ||
+           (id.GetTs() == m_currentTs && id.GetUid() <= m_currentUid) ||
+           id.PeekEventImpl()->IsCancelled();
+}
+
+uint64_t
+LogicalProcess::GetCurrentTs() const
+{
+    return m_currentTs;
+}
+
+void
+LogicalProcess::SetCurrentTs(uint64_t ts)
+{
+    NS_ASSERT(ts >= m_currentTs);
+    m_currentTs = ts;
+}
+
+uint32_t
+LogicalProcess::GetContext() const
+{
+    return m_currentContext;
+}
+
+void
+LogicalProcess::SetContext(uint32_t context)
+{
+    m_currentContext = context;
+}
+
+uint64_t
+LogicalProcess::GetEventCount() const
+{
+    return m_eventCount;
+}
+
+void
+LogicalProcess::Dispose()
+{
+    NS_LOG_FUNCTION(this);
+    ReceiveMessages();
+    while (!m_events->IsEmpty())
+    {
+        Scheduler::Event next = m_events->RemoveNext();
+        next.impl->Unref();
+    }
+    m_events = nullptr;
+}
+
+} // namespace ns3
@@ -0,0 +1,195 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef LOGICAL_PROCESS_H
+#define LOGICAL_PROCESS_H
+
+#include <ns3/event-id.h>
+#include <ns3/object-factory.h>
+#include <ns3/ptr.h>
+#include <ns3/scheduler.h>
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp
+ * Declaration of class ns3::LogicalProcess.
+ */
+
+namespace ns3
+{
+
+/**
+ * \ingroup mtp
+ *
+ * \brief One partition of a multithreaded simulation.
+ *
+ * A logical process owns the event list of a set of nodes and its own
+ * notion of the current time.  During a parallel round it is executed
+ * by exactly one thread; events destined to nodes owned by other logical
+ * processes are posted to their mailbox and merged into their event list
+ * between rounds, in a deterministic order.
+ */
+class LogicalProcess
+{
+  public:
+    /**
+     * Constructor.
+     *
+     * \param [in] id The index of this logical process.
+     * \param [in] schedulerFactory Factory for the event list.
+     */
+    LogicalProcess(uint32_t id, ObjectFactory schedulerFactory);
+    /** Destructor. */
+    ~LogicalProcess();
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    LogicalProcess(const LogicalProcess&) = delete;
+    LogicalProcess& operator=(const LogicalProcess&) = delete;
+
+    /** \return The index of this logical process. */
+    uint32_t GetId() const;
+
+    /**
+     * Replace the event list, moving the pending events to the new one.
+     *
+     * \param [in] schedulerFactory Factory for the new event list.
+     */
+    void SetScheduler(ObjectFactory schedulerFactory);
+
+    /**
+     * Schedule an event at an absolute time.
+     *
+     * \param [in] ts The absolute timestamp of the event.
+     * \param [in] context The execution context of the event.
+     * \param [in] event The event to schedule.
+     * \return The id of the scheduled event.
+     */
+    EventId Insert(uint64_t ts, uint32_t context, EventImpl* event);
+    /**
+     * Move an already keyed event into this logical process.
+     *
+     * The event keeps its key, so that previously returned EventIds
+     * remain valid.
+     *
+     * \param [in] ev The event to adopt.
+     */
+    void Adopt(const Scheduler::Event& ev);
+    /**
+     * Post an event from another thread.
+     *
+     * \param [in] ts The absolute timestamp of the event.
+     * \param [in] context The execution context of the event.
+     * \param [in] event The event to schedule.
+     * \param [in] source The index of the sending logical process.
+     * \param [in] sequence The per-sender sequence number of the event.
+     */
+    void Post(uint64_t ts, uint32_t context, EventImpl* event, uint32_t source, uint64_t sequence);
+    /** Merge the posted events into the event list. */
+    void ReceiveMessages();
+    /** \return The next sequence number to use when posting an event. */
+    uint64_t NextSequence();
+
+    /** \return \c true if no event is pending. */
+    bool IsEmpty() const;
+    /** \return The timestamp of the next pending event. */
+    uint64_t GetNextTs() const;
+    /** \return The next pending event, which is removed from the event list. */
+    Scheduler::Event RemoveNext();
+
+    /** Process the next event. */
+    void ProcessOneEvent();
+    /**
+     * Process all the events strictly earlier than \p end.
+     *
+     * \param [in] end The exclusive end of the time window.
+     * \param [in] stop Flag checked between events to stop early.
+     */
+    void ProcessEventsUntil(uint64_t end, const std::atomic<bool>& stop);
+
+    /**
+     * Remove an event from the event list.
+     *
+     * \param [in] id The event to remove.
+     */
+    void Remove(const EventId& id);
+    /**
+     * \param [in] id The event to check.
+     * \return \c true if the event has run or has been cancelled.
+     */
+    bool IsExpired(const EventId& id) const;
+
+    /** \return The timestamp of the current event. */
+    uint64_t GetCurrentTs() const;
+    /**
+     * Advance the current time without running an event.
+     *
+     * \param [in] ts The new current timestamp.
+     */
+    void SetCurrentTs(uint64_t ts);
+    /** \return The context of the current event. */
+    uint32_t GetContext() const;
+    /**
+     * Change the context of the current event.
+     *
+     * \param [in] context The new context.
+     */
+    void SetContext(uint32_t context);
+    /** \return The number of events executed. */
+    uint64_t GetEventCount() const;
+
+    /** Release all the pending events. */
+    void Dispose();
+
+  private:
+    /** An event posted by another logical process. */
+    struct Message
+    {
+        uint64_t ts;       //!< Absolute timestamp.
+        uint32_t context;  //!< Execution context.
+        uint32_t source;   //!< Sending logical process.
+        uint64_t sequence; //!< Per-sender sequence number.
+        EventImpl* event;  //!< The event implementation.
+    };
+
+    /** The index of this logical process. */
+    uint32_t m_id;
+    /** The event priority queue. */
+    Ptr<Scheduler> m_events;
+    /** Next event unique id. */
+    uint32_t m_uid;
+    /** Unique id of the current event. */
+    uint32_t m_currentUid;
+    /** Timestamp of the current event. */
+    uint64_t m_currentTs;
+    /** Execution context of the current event. */
+    uint32_t m_currentContext;
+    /** The event count. */
+    uint64_t m_eventCount;
+    /** Sequence number of the next event posted by this logical process. */
+    uint64_t m_sequence;
+
+    /** Events posted by other logical processes. */
+    std::vector<Message> m_messages;
+    /** Mutex to control access to the posted events. */
+    std::mutex m_messagesMutex;
+};
+
+} // namespace ns3
+
+#endif /* LOGICAL_PROCESS_H */
@@ -0,0 +1,707 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "multithreaded-simulator-impl.h"
+
+#include "logical-process.h"
+
+#include <ns3/abort.h>
+#include <ns3/assert.h>
+#include <ns3/channel-list.h>
+#include <ns3/channel.h>
+#include <ns3/log.h>
+#include <ns3/make-event.h>
+#include <ns3/net-device.h>
+#include <ns3/node-list.h>
+#include <ns3/node.h>
+#include <ns3/simulator.h>
+#include <ns3/string.h>
+#include <ns3/uinteger.h>
+
+#include <algorithm>
+#include <limits>
+#include <numeric>
+#include <sstream>
+
+/**
+ * \file
+ * \ingroup mtp
+ * Implementation of class ns3::MultithreadedSimulatorImpl.
+ */
+
+namespace ns3
+{
+
+// Note:  Logging in this file is largely avoided due to the
+// number of calls that are made to these functions and the possibility
+// of causing recursions leading to stack overflow
+NS_LOG_COMPONENT_DEFINE("MultithreadedSimulatorImpl");
+
+NS_OBJECT_ENSURE_REGISTERED(MultithreadedSimulatorImpl);
+
+namespace
+{
+
+/**
+ * \ingroup mtp
+ * The logical process executed by the calling thread, or null for the
+ * main thread outside of the parallel rounds.
+ */
+thread_local LogicalProcess* g_currentLp = nullptr;
+
+/** Timestamp used for an infinite lookahead. */
+const uint64_t INFINITE_TS = std::numeric_limits<uint64_t>::max();
+
+} // unnamed namespace
+
+TypeId
+MultithreadedSimulatorImpl::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::MultithreadedSimulatorImpl")
+            .SetParent<SimulatorImpl>()
+            .SetGroupName("Mtp")
+            .AddConstructor<MultithreadedSimulatorImpl>()
+            .AddAttribute("MaxThreads",
+                          "The maximum number of threads, and of partitions of the nodes. "
+                          "Zero selects the number of hardware threads.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&MultithreadedSimulatorImpl::m_maxThreads),
+                          MakeUintegerChecker<uint32_t>())
+            .AddAttribute("MinLookahead",
+                          "Links whose delay is smaller than this value are never cut "
+                          "by the partition, which trades parallelism for longer rounds.",
+                          TimeValue(Seconds(0)),
+                          MakeTimeAccessor(&MultithreadedSimulatorImpl::m_minLookahead),
+                          MakeTimeChecker(Seconds(0)))
+            .AddAttribute("PartitionableChannels",
+                          "Comma-separated names of the channel types whose ends can be "
+                          "executed by different threads.  These channels must only reach "
+                          "the other devices through events delayed by their Delay attribute.",
+                          StringValue("ns3::PointToPointChannel,ns3::SimpleChannel"),
+                          MakeStringAccessor(&MultithreadedSimulatorImpl::m_partitionableChannels),
+                          MakeStringChecker());
+    return tid;
+}
+
+MultithreadedSimulatorImpl::MultithreadedSimulatorImpl()
+    : m_partitioned(false),
+      m_lookahead(INFINITE_TS),
+      m_stop(false),
+      m_parallel(false),
+      m_windowEnd(0),
+      m_mainThreadId(std::this_thread::get_id()),
+      m_round(0),
+      m_exit(false),
+      m_nextLp(0),
+      m_busyThreads(0)
+{
+    NS_LOG_FUNCTION(this);
+}
+
+MultithreadedSimulatorImpl::~MultithreadedSimulatorImpl()
+{
+    NS_LOG_FUNCTION(this);
+}
+
+void
+MultithreadedSimulatorImpl::DoDispose()
+{
+    NS_LOG_FUNCTION(this);
+    StopThreads();
+    for (auto lp : m_lps)
+    {
+        lp->Dispose();
+        delete lp;
+    }
+    m_lps.clear();
+    m_nodeLp.clear();
+    SimulatorImpl::DoDispose();
+}
+
+void
+MultithreadedSimulatorImpl::Destroy()
+{
+    NS_LOG_FUNCTION(this);
+    while (!m_destroyEvents.empty())
+    {
+        Ptr<EventImpl> ev = m_destroyEvents.front().PeekEventImpl();
+        m_destroyEvents.pop_front();
+        NS_LOG_LOGIC("handle destroy " << ev);
+        if (!ev->IsCancelled())
+        {
+            ev->Invoke();
+        }
+    }
+}
+
+void
+MultithreadedSimulatorImpl::SetScheduler(ObjectFactory schedulerFactory)
+{
+    NS_LOG_FUNCTION(this << schedulerFactory);
+    m_schedulerFactory = schedulerFactory;
+    if (m_lps.empty())
+    {
+        m_lps.push_back(new LogicalProcess(0, m_schedulerFactory));
+        return;
+    }
+    for (auto lp : m_lps)
+    {
+        lp->SetScheduler(m_schedulerFactory);
+    }
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetSystemId() const
+{
+    return 0;
+}
+
+LogicalProcess*
+MultithreadedSimulatorImpl::GetLogicalProcess(uint32_t context) const
+{
+    if (context < m_nodeLp.size())
+    {
+        return m_lps[m_nodeLp[context]];
+    }
+    return m_lps[0];
+}
+
+LogicalProcess*
+MultithreadedSimulatorImpl::GetCurrentLogicalProcess() const
+{
+    return g_currentLp != nullptr ? g_currentLp : m_lps[0];
+}
+
+void
+MultithreadedSimulatorImpl::Partition()
+{
+    NS_LOG_FUNCTION(this);
+
+    uint32_t nNodes = NodeList::GetNNodes();
+    std::vector<uint32_t> parent(nNodes);
+    std::iota(parent.begin(), parent.end(), 0);
+    auto find = [&parent](uint32_t node) {
+        while (parent[node] != node)
+        {
+            parent[node] = parent[parent[node]];
+            node = parent[node];
+        }
+        return node;
+    };
+    auto merge = [&parent, &find](uint32_t a, uint32_t b) {
+        a = find(a);
+        b = find(b);
+        // keep the smallest node id as root, for determinism
+        parent[std::max(a, b)] = std::min(a, b);
+    };
+
+    std::vector<TypeId> partitionable;
+    std::istringstream names(m_partitionableChannels);
+    std::string name;
+    while (std::getline(names, name, ','))
+    {
+        TypeId tid;
+        if (TypeId::LookupByNameFailSafe(name, &tid))
+        {
+            partitionable.push_back(tid);
+        }
+    }
+
+    /** A link which may be cut by the partition. */
+    struct Link
+    {
+        uint32_t a;     //!< First node.
+        uint32_t b;     //!< Second node.
+        uint64_t delay; //!< Delay, in time steps.
+    };
+
+    std::vector<Link> links;
+    for (auto i = ChannelList::Begin(); i != ChannelList::End(); ++i)
+    {
+        Ptr<Channel> channel = *i;
+        std::vector<uint32_t> nodes;
+        for (std::size_t j = 0; j < channel->GetNDevices(); ++j)
+        {
+            Ptr<NetDevice> device = channel->GetDevice(j);
+            if (device && device->GetNode())
+            {
+                nodes.push_back(device->GetNode()->GetId());
+            }
+        }
+
+        TypeId tid = channel->GetInstanceTypeId();
+        bool cut = std::any_of(partitionable.begin(),
+                               partitionable.end(),
+                               [&tid](TypeId other) { return tid == other || tid.IsChildOf(other); });
+        TimeValue delay;
+        if (cut && channel->GetAttributeFailSafe("Delay", delay) && delay.Get().IsStrictlyPositive() &&
+            delay.Get() >= m_minLookahead)
+        {
+            for (std::size_t a = 0; a < nodes.size(); ++a)
+            {
+                for (std::size_t b = a + 1; b < nodes.size(); ++b)
+                {
+                    links.push_back(
+                        {nodes[a], nodes[b], static_cast<uint64_t>(delay.Get().GetTimeStep())});
+                }
+            }
+        }
+        else
+        {
+            for (std::size_t a = 1; a < nodes.size(); ++a)
+            {
+                merge(nodes[0], nodes[a]);
+            }
+        }
+    }
+
+    // Group the nodes, then balance the groups over the threads, biggest first
+    std::vector<std::vector<uint32_t>> groups;
+    std::vector<uint32_t> groupOfRoot(nNodes, 0);
+    for (uint32_t node = 0; node < nNodes; ++node)
+    {
+        uint32_t root = find(node);
+        if (root == node)
+        {
+            groupOfRoot[root] = groups.size();
+            groups.emplace_back();
+        }
+        groups[groupOfRoot[root]].push_back(node);
+    }
+    std::stable_sort(groups.begin(),
+                     groups.end(),
+                     [](const std::vector<uint32_t>& a, const std::vector<uint32_t>& b) {
+                         return a.size() > b.size();
+                     });
+
+    uint32_t nThreads = m_maxThreads;
+    if (nThreads == 0)
+    {
+        nThreads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    uint32_t nPartitions = std::max<uint32_t>(1, std::min<std::size_t>(nThreads, groups.size()));
+    std::vector<std::size_t> load(nPartitions, 0);
+    m_nodeLp.assign(nNodes, 1);
+    for (const auto& group : groups)
+    {
+        auto lightest = std::min_element(load.begin(), load.end()) - load.begin();
+        load[lightest] += group.size();
+        for (auto node : group)
+        {
+            m_nodeLp[node] = 1 + lightest;
+        }
+    }
+
+    m_lookahead = INFINITE_TS;
+    for (const auto& link : links)
+    {
+        if (m_nodeLp[link.a] != m_nodeLp[link.b])
+        {
+            m_lookahead = std::min(m_lookahead, link.delay);
+        }
+    }
+
+    LogicalProcess* global = m_lps[0];
+    for (uint32_t i = 1; i <= nPartitions; ++i)
+    {
+        m_lps.push_back(new LogicalProcess(i, m_schedulerFactory));
+        m_lps.back()->SetCurrentTs(global->GetCurrentTs());
+    }
+    m_partitioned = true;
+
+    // Move the events scheduled so far to the logical process of their context
+    std::vector<Scheduler::Event> events;
+    while (!global->IsEmpty())
+    {
+        events.push_back(global->RemoveNext());
+    }
+    for (const auto& ev : events)
+    {
+        GetLogicalProcess(ev.key.m_context)->Adopt(ev);
+    }
+
+    NS_LOG_INFO(nNodes << " nodes in " << groups.size() << " groups partitioned over "
+                       << nPartitions << " logical processes, lookahead "
+                       << (m_lookahead == INFINITE_TS ? GetMaximumSimulationTime()
+                                                      : TimeStep(m_lookahead)));
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetNPartitions() const
+{
+    return m_lps.empty() ? 0 : m_lps.size() - 1;
+}
+
+Time
+MultithreadedSimulatorImpl::GetLookahead() const
+{
+    return m_lookahead == INFINITE_TS ? GetMaximumSimulationTime() : TimeStep(m_lookahead);
+}
+
+void
+MultithreadedSimulatorImpl::StartThreads()
+{
+    NS_LOG_FUNCTION(this);
+    m_exit = false;
+    for (std::size_t i = 2; i < m_lps.size(); ++i)
+    {
+        m_threads.emplace_back(&MultithreadedSimulatorImpl::Worker, this, m_round.load());
+    }
+}
+
+void
+MultithreadedSimulatorImpl::StopThreads()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_threads.empty())
+    {
+        return;
+    }
+    {
+        std::unique_lock lock{m_roundMutex};
+        m_exit = true;
+        m_round++;
+    }
+    m_roundCondition.notify_all();
+    for (auto& thread : m_threads)
+    {
+        thread.join();
+    }
+    m_threads.clear();
+}
+
+void
+MultithreadedSimulatorImpl::Worker(uint32_t round)
+{
+    while (true)
+    {
+        // Rounds are often short: spin a little before sleeping
+        for (uint32_t spin = 0; spin < 1000 && m_round.load() == round; ++spin)
+        {
+            std::this_thread::yield();
+        }
+        {
+            std::unique_lock lock{m_roundMutex};
+            m_roundCondition.wait(lock, [this, round]() { return m_round.load() != round; });
+        }
+        round = m_round.load();
+        if (m_exit)
+        {
+            return;
+        }
+        ProcessLogicalProcesses();
+        m_busyThreads--;
+    }
+}
+
+void
+MultithreadedSimulatorImpl::ProcessLogicalProcesses()
+{
+    uint32_t i;
+    while ((i = m_nextLp++) < m_lps.size())
+    {
+        g_currentLp = m_lps[i];
+        m_lps[i]->ProcessEventsUntil(m_windowEnd, m_stop);
+    }
+    g_currentLp = nullptr;
+}
+
+void
+MultithreadedSimulatorImpl::ProcessRound()
+{
+    m_parallel = true;
+    m_nextLp = 1;
+    m_busyThreads = m_threads.size();
+    {
+        std::unique_lock lock{m_roundMutex};
+        m_round++;
+    }
+    m_roundCondition.notify_all();
+    ProcessLogicalProcesses();
+    while (m_busyThreads.load() != 0)
+    {
+        std::this_thread::yield();
+    }
+    m_parallel = false;
+}
+
+bool
+MultithreadedSimulatorImpl::IsFinished() const
+{
+    if (m_stop)
+    {
+        return true;
+    }
+    // An event of a round, e.g., a DeliveryBatch, can not read the event
+    // lists of the logical processes run by the other threads
+    if (g_currentLp != nullptr)
+    {
+        return g_currentLp->IsEmpty();
+    }
+    return std::all_of(m_lps.begin(), m_lps.end(), [](const LogicalProcess* lp) {
+        return lp->IsEmpty();
+    });
+}
+
+void
+MultithreadedSimulatorImpl::Run()
+{
+    NS_LOG_FUNCTION(this);
+    // Set the current threadId as the main threadId
+    m_mainThreadId = std::this_thread::get_id();
+    if (!m_partitioned)
+    {
+        Partition();
+    }
+    m_stop = false;
+    StartThreads();
+
+    LogicalProcess* global = m_lps[0];
+    while (!m_stop)
+    {
+        uint64_t next = INFINITE_TS;
+        for (auto lp : m_lps)
+        {
+            lp->ReceiveMessages();
+            if (lp != global && !lp->IsEmpty())
+            {
+                next = std::min(next, lp->GetNextTs());
+            }
+        }
+        if (global->IsEmpty() && next == INFINITE_TS)
+        {
+            break;
+        }
+        if (!global->IsEmpty() && global->GetNextTs() <= next)
+        {
+            // the global events run alone, before the node events at the same time
+            global->ProcessOneEvent();
+            continue;
+        }
+        m_windowEnd = next > INFINITE_TS - m_lookahead ? INFINITE_TS : next + m_lookahead;
+        if (!global->IsEmpty())
+        {
+            m_windowEnd = std::min(m_windowEnd, global->GetNextTs());
+        }
+        ProcessRound();
+    }
+
+    StopThreads();
+
+    // Simulator::Now() outside of the events returns the time of the last event
+    uint64_t last = global->GetCurrentTs();
+    for (auto lp : m_lps)
+    {
+        last = std::max(last, lp->GetCurrentTs());
+    }
+    global->SetCurrentTs(last);
+}
+
+void
+MultithreadedSimulatorImpl::Stop()
+{
+    NS_LOG_FUNCTION(this);
+    m_stop = true;
+}
+
+void
+MultithreadedSimulatorImpl::Stop(const Time& delay)
+{
+    NS_LOG_FUNCTION(this << delay.GetTimeStep());
+    NS_ASSERT_MSG(delay.IsPositive(), "MultithreadedSimulatorImpl::Stop(): Negative delay");
+    // The stop event runs in the calling logical process: when called from
+    // a node, the other partitions stop at most one round later.
+    LogicalProcess* current = GetCurrentLogicalProcess();
+    current->Insert(current->GetCurrentTs() + delay.GetTimeStep(),
+                    current->GetContext(),
+                    MakeEvent(static_cast<void (*)()>(&Simulator::Stop)));
+}
+
+EventId
+MultithreadedSimulatorImpl::Schedule(const Time& delay, EventImpl* event)
+{
+    NS_ASSERT_MSG(g_currentLp != nullptr || m_mainThreadId == std::this_thread::get_id(),
+                  "Simulator::Schedule Thread-unsafe invocation!");
+    NS_ASSERT_MSG(delay.IsPositive(), "MultithreadedSimulatorImpl::Schedule(): Negative delay");
+
+    LogicalProcess* current = GetCurrentLogicalProcess();
+    Time tAbsolute = delay + TimeStep(current->GetCurrentTs());
+    return current->Insert(tAbsolute.GetTimeStep(), current->GetContext(), event);
+}
+
+void
+MultithreadedSimulatorImpl::ScheduleWithContext(uint32_t context,
+                                                const Time& delay,
+                                                EventImpl* event)
+{
+    NS_LOG_FUNCTION(this << context << delay.GetTimeStep() << event);
+    NS_ASSERT_MSG(g_currentLp != nullptr || m_mainThreadId == std::this_thread::get_id(),
+                  "Simulator::ScheduleWithContext Thread-unsafe invocation!");
+
+    LogicalProcess* current = GetCurrentLogicalProcess();
+    LogicalProcess* target = GetLogicalProcess(context);
+    Time tAbsolute = delay + TimeStep(current->GetCurrentTs());
+    uint64_t ts = tAbsolute.GetTimeStep();
+    if (!m_parallel || target == current)
+    {
+        target->Insert(ts, context, event);
+        return;
+    }
+    NS_ABORT_MSG_IF(ts < m_windowEnd,
+                    "MultithreadedSimulatorImpl: event for context "
+                        << context << " scheduled with delay " << delay
+                        << " from another partition, below the lookahead " << GetLookahead()
+                        << "; the channel connecting them should not be partitionable");
+    target->Post(ts, context, event, current->GetId(), current->NextSequence());
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleNow(EventImpl* event)
+{
+    return Schedule(Time(0), event);
+}
+
+EventId
+MultithreadedSimulatorImpl::ScheduleDestroy(EventImpl* event)
+{
+    NS_ASSERT_MSG(m_mainThreadId == std::this_thread::get_id() && !m_parallel,
+                  "Simulator::ScheduleDestroy Thread-unsafe invocation!");
+
+    EventId id(Ptr<EventImpl>(event, false),
+               GetCurrentLogicalProcess()->GetCurrentTs(),
+               0xffffffff,
+               EventId::UID::DESTROY);
+    m_destroyEvents.push_back(id);
+    return id;
+}
+
+Time
+MultithreadedSimulatorImpl::Now() const
+{
+    // Do not add function logging here, to avoid stack overflow
+    return TimeStep(GetCurrentLogicalProcess()->GetCurrentTs());
+}
+
+Time
+MultithreadedSimulatorImpl::GetDelayLeft(const EventId& id) const
+{
+    if (IsExpired(id))
+    {
+        return TimeStep(0);
+    }
+    return TimeStep(id.GetTs() - GetCurrentLogicalProcess()->GetCurrentTs());
+}
+
+void
+MultithreadedSimulatorImpl::Remove(const EventId& id)
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        // destroy events.
+        for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                m_destroyEvents.erase(i);
+                break;
+            }
+        }
+        return;
+    }
+    LogicalProcess* lp = GetLogicalProcess(id.GetContext());
+    NS_ASSERT_MSG(!m_parallel || lp == g_currentLp,
+                  "Simulator::Remove of an event of another partition");
+    lp->Remove(id);
+}
+
+void
+MultithreadedSimulatorImpl::Cancel(const EventId& id)
+{
+    NS_ASSERT_MSG(!m_parallel || id.GetUid() == EventId::UID::DESTROY ||
+                      GetLogicalProcess(id.GetContext()) == g_currentLp,
+                  "Simulator::Cancel of an event of another partition");
+    if (!IsExpired(id))
+    {
+        id.PeekEventImpl()->Cancel();
+    }
+}
+
+bool
+MultithreadedSimulatorImpl::IsExpired(const EventId& id) const
+{
+    if (id.GetUid() == EventId::UID::DESTROY)
+    {
+        if (id.PeekEventImpl() == nullptr || id.PeekEventImpl()->IsCancelled())
+        {
+            return true;
+        }
+        // destroy events.
+        for (auto i = m_destroyEvents.begin(); i != m_destroyEvents.end(); i++)
+        {
+            if (*i == id)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+    return GetLogicalProcess(id.GetContext())->IsExpired(id);
+}
+
+Time
+MultithreadedSimulatorImpl::GetMaximumSimulationTime() const
+{
+    return TimeStep(0x7fffffffffffffffLL);
+}
+
+uint32_t
+MultithreadedSimulatorImpl::GetContext() const
+{
+    return GetCurrentLogicalProcess()->GetContext();
+}
+
+void
+MultithreadedSimulatorImpl::SetContext(uint32_t context)
+{
+    NS_ASSERT_MSG(!m_partitioned || IsLocalContext(context),
+                  "Simulator::SetContext to a context of another partition");
+    GetCurrentLogicalProcess()->SetContext(context);
+}
+
+bool
+MultithreadedSimulatorImpl::IsLocalContext(uint32_t context) const
+{
+    // Before the partition, the events scheduled are moved to the logical
+    // process of their context, so no other context is local.
+    if (!m_partitioned)
+    {
+        return context == GetContext();
+    }
+    return GetLogicalProcess(context) == GetCurrentLogicalProcess();
+}
+
+uint64_t
+MultithreadedSimulatorImpl::GetEventCount() const
+{
+    uint64_t count = 0;
+    for (auto lp : m_lps)
+    {
+        count += lp->GetEventCount();
+    }
+    return count;
+}
+
+} // namespace ns3
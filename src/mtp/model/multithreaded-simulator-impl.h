@@ -0,0 +1,199 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef MULTITHREADED_SIMULATOR_IMPL_H
+#define MULTITHREADED_SIMULATOR_IMPL_H
+
+#include <ns3/nstime.h>
+#include <ns3/simulator-impl.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * \file
+ * \ingroup mtp
+ * Declaration of class ns3::MultithreadedSimulatorImpl.
+ */
+
+namespace ns3
+{
+
+class LogicalProcess;
+
+/**
+ * \ingroup mtp
+ *
+ * \brief Conservative parallel simulator running on several threads
+ * of a single process.
+ *
+ * On the first call to Run() the nodes are partitioned into logical
+ * processes: the nodes attached to a channel are kept together unless
+ * the channel is one of the \c PartitionableChannels, which only
+ * interact with the other end through events delayed by the channel
+ * \c Delay attribute.  The resulting groups are balanced over at most
+ * \c MaxThreads logical processes, and the smallest delay of the links
+ * cut by the partition becomes the lookahead.
+ *
+ * The simulation then proceeds in rounds: all the logical processes
+ * execute, in parallel, the events earlier than the smallest pending
+ * timestamp plus the lookahead, exchanging the events scheduled for
+ * the nodes of other logical processes through mailboxes merged at the
+ * end of the round.  Events without a node context (e.g., scheduled
+ * during the configuration of the simulation with Simulator::Schedule)
+ * belong to a global logical process whose events are executed alone,
+ * between rounds.
+ *
+ * The results do not depend on the number of threads.  The models
+ * executed concurrently must not share unprotected state: trace sinks
+ * connected to several nodes, for example, may be called from several
+ * threads.
+ */
+class MultithreadedSimulatorImpl : public SimulatorImpl
+{
+  public:
+    /**
+     *  Register this type.
+     *  \return The object TypeId.
+     */
+    static TypeId GetTypeId();
+
+    /** Constructor. */
+    MultithreadedSimulatorImpl();
+    /** Destructor. */
+    ~MultithreadedSimulatorImpl() override;
+
+    // Inherited
+    void Destroy() override;
+    bool IsFinished() const override;
+    void Stop() override;
+    void Stop(const Time& delay) override;
+    EventId Schedule(const Time& delay, EventImpl* event) override;
+    void ScheduleWithContext(uint32_t context, const Time& delay, EventImpl* event) override;
+    EventId ScheduleNow(EventImpl* event) override;
+    EventId ScheduleDestroy(EventImpl* event) override;
+    void Remove(const EventId& id) override;
+    void Cancel(const EventId& id) override;
+    bool IsExpired(const EventId& id) const override;
+    void Run() override;
+    Time Now() const override;
+    Time GetDelayLeft(const EventId& id) const override;
+    Time GetMaximumSimulationTime() const override;
+    void SetScheduler(ObjectFactory schedulerFactory) override;
+    uint32_t GetSystemId() const override;
+    uint32_t GetContext() const override;
+    void SetContext(uint32_t context) override;
+    bool IsLocalContext(uint32_t context) const override;
+    uint64_t GetEventCount() const override;
+
+    /**
+     * Get the number of logical processes the nodes are partitioned into,
+     * not counting the global one.
+     *
+     * \return The number of partitions, zero before the first Run().
+     */
+    uint32_t GetNPartitions() const;
+    /**
+     * Get the lookahead of the partition.
+     *
+     * \return The minimum delay of the links between partitions.
+     */
+    Time GetLookahead() const;
+
+  private:
+    void DoDispose() override;
+
+    /** Partition the nodes and move their events to their logical process. */
+    void Partition();
+    /**
+     * Get the logical process executing the events of a context.
+     *
+     * \param [in] context The context.
+     * \return The logical process.
+     */
+    LogicalProcess* GetLogicalProcess(uint32_t context) const;
+    /** \return The logical process of the calling thread. */
+    LogicalProcess* GetCurrentLogicalProcess() const;
+
+    /** Start the worker threads. */
+    void StartThreads();
+    /** Stop and join the worker threads. */
+    void StopThreads();
+    /**
+     * Body of the worker threads.
+     *
+     * \param [in] round The round already processed at thread creation.
+     */
+    void Worker(uint32_t round);
+    /** Execute a parallel round, up to m_windowEnd. */
+    void ProcessRound();
+    /** Execute the logical processes not yet claimed in the current round. */
+    void ProcessLogicalProcesses();
+
+    /** The global logical process, followed by the partitions. */
+    std::vector<LogicalProcess*> m_lps;
+    /** The logical process index of each node. */
+    std::vector<uint32_t> m_nodeLp;
+    /** Flag \c true once the nodes have been partitioned. */
+    bool m_partitioned;
+    /** Lookahead of the partition, in time steps. */
+    uint64_t m_lookahead;
+    /** Factory of the event lists of the logical processes. */
+    ObjectFactory m_schedulerFactory;
+
+    /** Maximum number of threads. */
+    uint32_t m_maxThreads;
+    /** Links with smaller delays are never cut. */
+    Time m_minLookahead;
+    /** Channel types which can be cut by the partition. */
+    std::string m_partitionableChannels;
+
+    /** Container type for the events to run at Simulator::Destroy() */
+    typedef std::list<EventId> DestroyEvents;
+    /** The container of events to run at Destroy. */
+    DestroyEvents m_destroyEvents;
+
+    /** Flag calling for the end of the simulation. */
+    std::atomic<bool> m_stop;
+    /** Flag \c true while a parallel round is executed. */
+    bool m_parallel;
+    /** Exclusive end of the time window of the current round. */
+    uint64_t m_windowEnd;
+
+    /** The worker threads. */
+    std::vector<std::thread> m_threads;
+    /** Main execution thread. */
+    std::thread::id m_mainThreadId;
+    /** Index of the current round, incremented to start a round. */
+    std::atomic<uint32_t> m_round;
+    /** Flag asking the worker threads to exit. */
+    std::atomic<bool> m_exit;
+    /** Index of the next logical process to execute in the current round. */
+    std::atomic<uint32_t> m_nextLp;
+    /** Number of worker threads still busy in the current round. */
+    std::atomic<uint32_t> m_busyThreads;
+    /** Mutex protecting the round start notifications. */
+    std::mutex m_roundMutex;
+    /** Condition signaled at the start of each round. */
+    std::condition_variable m_roundCondition;
+};
+
+} // namespace ns3
+
+#endif /* MULTITHREADED_SIMULATOR_IMPL_H */
@@ -0,0 +1,327 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/config.h"
+#include "ns3/multithreaded-simulator-impl.h"
+#include "ns3/node-container.h"
+#include "ns3/node.h"
+#include "ns3/packet.h"
+#include "ns3/simple-net-device-helper.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
+#include "ns3/test.h"
+#include "ns3/uinteger.h"
+
+#include <sstream>
+
+using namespace ns3;
+
+/**
+ * \file
+ * \ingroup mtp-tests
+ * Multithreaded simulator test suite
+ */
+
+/**
+ * \ingroup mtp
+ * \defgroup mtp-tests Multithreaded simulator tests
+ */
+
+/**
+ * \ingroup mtp-tests
+ *
+ * \brief Base class building a ring of nodes forwarding packets to each other.
+ */
+class MtpRingTestCase : public TestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param name Test case name.
+     */
+    MtpRingTestCase(std::string name);
+
+  protected:
+    /**
+     * Create the ring and schedule the first transmission of each node.
+     * \param nNodes Number of nodes.
+     * \param delay Delay of the links.
+     */
+    void BuildRing(uint32_t nNodes, Time delay);
+    /**
+     * Run the simulation and get the log of the receptions.
+     * \return The receptions of each node, in order.
+     */
+    std::string RunRing();
+    /** \return The total number of receptions in the last run. */
+    uint32_t GetReceptions() const;
+
+  private:
+    /**
+     * Send a packet.
+     * \param device The device to send on.
+     * \param origin The node which sent the first copy of the packet.
+     * \param hops The number of hops done so far.
+     */
+    void Send(Ptr<NetDevice> device, uint8_t origin, uint8_t hops);
+    /**
+     * Protocol handler of the nodes.
+     * \param device The receiving device.
+     * \param packet The packet.
+     * \param protocol The protocol number.
+     * \param from The sender address.
+     * \param to The destination address.
+     * \param packetType The packet type.
+     */
+    void Receive(Ptr<NetDevice> device,
+                 Ptr<const Packet> packet,
+                 uint16_t protocol,
+                 const Address& from,
+                 const Address& to,
+                 NetDevice::PacketType packetType);
+
+    std::vector<std::ostringstream> m_logs; //!< Receptions of each node.
+    std::vector<uint32_t> m_receptions;     //!< Number of receptions of each node.
+};
+
+MtpRingTestCase::MtpRingTestCase(std::string name)
+    : TestCase(name)
+{
+}
+
+void
+MtpRingTestCase::BuildRing(uint32_t nNodes, Time delay)
+{
+    NodeContainer nodes;
+    nodes.Create(nNodes);
+    SimpleNetDeviceHelper helper;
+    helper.SetChannelAttribute("Delay", TimeValue(delay));
+    helper.SetDeviceAttribute("DataRate", StringValue("10Mbps"));
+    for (uint32_t i = 0; i < nNodes; ++i)
+    {
+        helper.Install(NodeContainer(nodes.Get(i), nodes.Get((i + 1) % nNodes)));
+    }
+    m_logs = std::vector<std::ostringstream>(nNodes);
+    m_receptions = std::vector<uint32_t>(nNodes, 0);
+    for (uint32_t i = 0; i < nNodes; ++i)
+    {
+        Ptr<Node> node = nodes.Get(i);
+        node->RegisterProtocolHandler(MakeCallback(&MtpRingTestCase::Receive, this), 0, nullptr);
+        Simulator::ScheduleWithContext(i,
+                                       MicroSeconds(100 * i),
+                                       &MtpRingTestCase::Send,
+                                       this,
+                                       node->GetDevice(i % 2),
+                                       i,
+                                       0);
+    }
+}
+
+std::string
+MtpRingTestCase::RunRing()
+{
+    Simulator::Stop(MilliSeconds(50));
+    Simulator::Run();
+    std::ostringstream oss;
+    oss << "now " << Simulator::Now() << " events " << Simulator::GetEventCount() << std::endl;
+    for (uint32_t i = 0; i < m_logs.size(); ++i)
+    {
+        oss << "node " << i << ": " << m_logs[i].str() << std::endl;
+    }
+    return oss.str();
+}
+
+uint32_t
+MtpRingTestCase::GetReceptions() const
+{
+    uint32_t receptions = 0;
+    for (auto n : m_receptions)
+    {
+        receptions += n;
+    }
+    return receptions;
+}
+
+void
+MtpRingTestCase::Send(Ptr<NetDevice> device, uint8_t origin, uint8_t hops)
+{
+    uint8_t payload[100] = {origin, hops};
+    device->Send(Create<Packet>(payload, sizeof(payload)), device->GetBroadcast(), 0x88B5);
+}
+
+void
+MtpRingTestCase::Receive(Ptr<NetDevice> device,
+                         Ptr<const Packet> packet,
+                         uint16_t protocol,
+                         const Address& from,
+                         const Address& to,
+                         NetDevice::PacketType packetType)
+{
+    uint8_t payload[2];
+    packet->CopyData(payload, sizeof(payload));
+    Ptr<Node> node = device->GetNode();
+    m_receptions[node->GetId()]++;
+    m_logs[node->GetId()] << Simulator::Now().GetNanoSeconds() << "/" << int(payload[0]) << "/"
+                          << int(payload[1]) << " ";
+    // forward to the device on the other side of the node, after some processing
+    Ptr<NetDevice> next = node->GetDevice(device == node->GetDevice(0) ? 1 : 0);
+    Simulator::Schedule(MicroSeconds(10),
+                        &MtpRingTestCase::Send,
+                        this,
+                        next,
+                        payload[0],
+                        payload[1] + 1);
+}
+
+/**
+ * \ingroup mtp-tests
+ *
+ * \brief Check that the multithreaded simulator gives the same results as
+ * the default one, whatever the number of threads.
+ */
+class MtpEquivalenceTestCase : public MtpRingTestCase
+{
+  public:
+    /**
+     * Constructor.
+     * \param threads Number of threads.
+     */
+    MtpEquivalenceTestCase(uint32_t threads);
+
+  private:
+    void DoRun() override;
+    void DoTeardown() override;
+
+    uint32_t m_threads; //!< Number of threads.
+};
+
+MtpEquivalenceTestCase::MtpEquivalenceTestCase(uint32_t threads)
+    : MtpRingTestCase("Check that " + std::to_string(threads) +
+                      " threads give the results of the default simulator"),
+      m_threads(threads)
+{
+}
+
+void
+MtpEquivalenceTestCase::DoRun()
+{
+    BuildRing(16, MicroSeconds(300));
+    std::string expected = RunRing();
+    // each of the 16 packets goes round the ring several times
+    NS_TEST_ASSERT_MSG_GT(GetReceptions(), 16 * 100, "Too few receptions");
+    Simulator::Destroy();
+
+    Config::SetGlobal("SimulatorImplementationType",
+                      StringValue("ns3::MultithreadedSimulatorImpl"));
+    Config::SetDefault("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue(m_threads));
+    BuildRing(16, MicroSeconds(300));
+    std::string actual = RunRing();
+    NS_TEST_ASSERT_MSG_EQ(actual, expected, "Multithreaded simulation differs");
+    Simulator::Destroy();
+}
+
+void
+MtpEquivalenceTestCase::DoTeardown()
+{
+    Config::SetGlobal("SimulatorImplementationType", StringValue("ns3::DefaultSimulatorImpl"));
+    Config::Reset();
+}
+
+/**
+ * \ingroup mtp-tests
+ *
+ * \brief Check the partition of the nodes and the resulting lookahead.
+ */
+class MtpPartitionTestCase : public MtpRingTestCase
+{
+  public:
+    MtpPartitionTestCase();
+
+  private:
+    void DoRun() override;
+    void DoTeardown() override;
+};
+
+MtpPartitionTestCase::MtpPartitionTestCase()
+    : MtpRingTestCase("Check the partition of the nodes")
+{
+}
+
+void
+MtpPartitionTestCase::DoRun()
+{
+    Config::SetGlobal("SimulatorImplementationType",
+                      StringValue("ns3::MultithreadedSimulatorImpl"));
+    Config::SetDefault("ns3::MultithreadedSimulatorImpl::MaxThreads", UintegerValue(3));
+
+    BuildRing(8, MicroSeconds(300));
+    RunRing();
+    Ptr<MultithreadedSimulatorImpl> impl =
+        DynamicCast<MultithreadedSimulatorImpl>(Simulator::GetImplementation());
+    NS_TEST_ASSERT_MSG_NE(impl, nullptr, "Wrong simulator implementation");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetNPartitions(), 3, "Wrong number of partitions");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetLookahead(), MicroSeconds(300), "Wrong lookahead");
+    Simulator::Destroy();
+
+    // links below the minimum lookahead are never cut
+    Config::SetDefault("ns3::MultithreadedSimulatorImpl::MinLookahead",
+                       TimeValue(MilliSeconds(1)));
+    BuildRing(8, MicroSeconds(300));
+    RunRing();
+    impl = DynamicCast<MultithreadedSimulatorImpl>(Simulator::GetImplementation());
+    NS_TEST_EXPECT_MSG_EQ(impl->GetNPartitions(), 1, "Wrong number of partitions");
+    NS_TEST_EXPECT_MSG_EQ(impl->GetLookahead(),
+                          Simulator::GetMaximumSimulationTime(),
+                          "Wrong lookahead");
+    Simulator::Destroy();
+
+    // neither are the channels which are not partitionable
+    Config::SetDefault("ns3::MultithreadedSimulatorImpl::MinLookahead", TimeValue(Seconds(0)));
+    Config::SetDefault("ns3::MultithreadedSimulatorImpl::PartitionableChannels",
+                       StringValue("ns3::PointToPointChannel"));
+    BuildRing(8, MicroSeconds(300));
+    RunRing();
+    impl = DynamicCast<MultithreadedSimulatorImpl>(Simulator::GetImplementation());
+    NS_TEST_EXPECT_MSG_EQ(impl->GetNPartitions(), 1, "Wrong number of partitions");
+    Simulator::Destroy();
+}
+
+void
+MtpPartitionTestCase::DoTeardown()
+{
+    Config::SetGlobal("SimulatorImplementationType", StringValue("ns3::DefaultSimulatorImpl"));
+    Config::Reset();
+}
+
+/**
+ * \ingroup mtp-tests
+ *
+ * \brief The multithreaded simulator Test Suite.
+ */
+class MtpTestSuite : public TestSuite
+{
+  public:
+    MtpTestSuite()
+        : TestSuite("mtp")
+    {
+        AddTestCase(new MtpPartitionTestCase(), TestCase::QUICK);
+        for (uint32_t threads : {1, 2, 4})
+        {
+            AddTestCase(new MtpEquivalenceTestCase(threads), TestCase::QUICK);
+        }
+    }
+};
+
+static MtpTestSuite g_mtpTestSuite; //!< Static variable for test initialization
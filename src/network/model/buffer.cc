@@ -47,6 +47,13 @@ struct Zeroes
     const uint32_t size; //!< buffer size
 } g_zeroes;              //!< Zero-filled buffer
 
+/**
+ * \ingroup packet
+ * Largest number of real bytes copied to add bytes to a Buffer
+ * whose data is shared: larger buffers are chained instead.
+ */
+const uint32_t g_maxCopySize = 128;
+
 } // namespace
 
 namespace ns3
@@ -54,7 +61,11 @@ namespace ns3
 
 NS_LOG_COMPONENT_DEFINE("Buffer");
 
+#ifdef NS3_MTP
+thread_local uint32_t Buffer::g_recommendedStart = 0;
+#else
 uint32_t Buffer::g_recommendedStart = 0;
+#endif
 #ifdef BUFFER_FREE_LIST
 /* The following macros are pretty evil but they are needed to allow us to
  * keep track of 3 possible states for the g_freeList variable:
@@ -79,9 +90,15 @@ uint32_t Buffer::g_recommendedStart = 0;
 #define IS_INITIALIZED(x) (!IS_UNINITIALIZED(x) && !IS_DESTROYED(x))
 #define DESTROYED ((Buffer::FreeList*)MAGIC_DESTROYED)
 #define UNINITIALIZED ((Buffer::FreeList*)0)
+#ifdef NS3_MTP
+thread_local uint32_t Buffer::g_maxSize = 0;
+thread_local Buffer::FreeList* Buffer::g_freeList = nullptr;
+thread_local struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
+#else
 uint32_t Buffer::g_maxSize = 0;
 Buffer::FreeList* Buffer::g_freeList = nullptr;
 struct Buffer::LocalStaticDestructor Buffer::g_localStaticDestructor;
+#endif
 
 Buffer::LocalStaticDestructor::~LocalStaticDestructor()
 {
@@ -187,18 +204,24 @@ Buffer::Deallocate(struct Buffer::Data* data)
 }
 
 Buffer::Buffer()
+    : m_chain(nullptr),
+      m_chainSize(0)
 {
     NS_LOG_FUNCTION(this);
     Initialize(0);
 }
 
 Buffer::Buffer(uint32_t dataSize)
+    : m_chain(nullptr),
+      m_chainSize(0)
 {
     NS_LOG_FUNCTION(this << dataSize);
     Initialize(dataSize);
 }
 
 Buffer::Buffer(uint32_t dataSize, bool initialize)
+    : m_chain(nullptr),
+      m_chainSize(0)
 {
     NS_LOG_FUNCTION(this << dataSize << initialize);
     if (initialize == true)
@@ -227,13 +250,31 @@ Buffer::CheckInternalState() const
     m_start <= m_data->m_size &&
     m_zeroAreaStart <= m_data->m_size;
 
-  bool ok = m_data->m_count > 0 && offsetsOk && dirtyOk && internalSizeOk;
+  bool chainOk = true;
+  if (m_chain != 0)
+    {
+      uint32_t chainSize = 0;
+      for (const Buffer &part : m_chain->m_parts)
+        {
+          chainOk = chainOk && part.m_chain == 0 && part.GetSize () > 0;
+          chainSize += part.GetSize ();
+        }
+      chainOk = chainOk && m_chain->m_count > 0 && !m_chain->m_parts.empty () &&
+        chainSize == m_chainSize && m_end > m_start;
+    }
+  else
+    {
+      chainOk = m_chainSize == 0;
+    }
+
+  bool ok = m_data->m_count > 0 && offsetsOk && dirtyOk && internalSizeOk && chainOk;
   if (!ok)
     {
       LOG_INTERNAL_STATE ("check " << this <<
                           ", " << (offsetsOk ? "true" : "false") <<
                           ", " << (dirtyOk ? "true" : "false") <<
-                          ", " << (internalSizeOk ? "true" : "false") << " ");
+                          ", " << (internalSizeOk ? "true" : "false") <<
+                          ", " << (chainOk ? "true" : "false") << " ");
     }
   return ok;
 #else
@@ -256,6 +297,21 @@ Buffer::Initialize(uint32_t zeroSize)
     NS_ASSERT(CheckInternalState());
 }
 
+void
+Buffer::Initialize(uint32_t dataStart, uint32_t zeroSize, uint32_t dataEnd)
+{
+    NS_LOG_FUNCTION(this << dataStart << zeroSize << dataEnd);
+    m_data = Buffer::Create(dataStart + dataEnd);
+    m_start = 0;
+    m_maxZeroAreaStart = dataStart;
+    m_zeroAreaStart = dataStart;
+    m_zeroAreaEnd = m_zeroAreaStart + zeroSize;
+    m_end = m_zeroAreaEnd + dataEnd;
+    m_data->m_dirtyStart = m_start;
+    m_data->m_dirtyEnd = m_end;
+    NS_ASSERT(CheckInternalState());
+}
+
 Buffer&
 Buffer::operator=(const Buffer& o)
 {
@@ -263,20 +319,31 @@ Buffer::operator=(const Buffer& o)
     if (m_data != o.m_data)
     {
         // not assignment to self.
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (--m_data->m_count == 0)
         {
             Recycle(m_data);
         }
         m_data = o.m_data;
         m_data->m_count++;
     }
+    // o may be a part of the chain released here, so release it last.
+    Chain* chain = m_chain;
+    m_chain = o.m_chain;
+    if (m_chain != nullptr)
+    {
+        Ref(m_chain);
+    }
     g_recommendedStart = std::max(g_recommendedStart, m_maxZeroAreaStart);
     m_maxZeroAreaStart = o.m_maxZeroAreaStart;
     m_zeroAreaStart = o.m_zeroAreaStart;
     m_zeroAreaEnd = o.m_zeroAreaEnd;
     m_start = o.m_start;
     m_end = o.m_end;
+    m_chainSize = o.m_chainSize;
+    if (chain != nullptr)
+    {
+        Unref(chain);
+    }
     NS_ASSERT(CheckInternalState());
     return *this;
 }
@@ -286,11 +353,80 @@ Buffer::~Buffer()
     NS_LOG_FUNCTION(this);
     NS_ASSERT(CheckInternalState());
     g_recommendedStart = std::max(g_recommendedStart, m_maxZeroAreaStart);
-    m_data->m_count--;
-    if (m_data->m_count == 0)
+    if (--m_data->m_count == 0)
     {
         Recycle(m_data);
     }
+    if (m_chain != nullptr)
+    {
+        Unref(m_chain);
+    }
+}
+
+void
+Buffer::Ref(Chain* chain)
+{
+    chain->m_count++;
+}
+
+void
+Buffer::Unref(Chain* chain)
+{
+    if (--chain->m_count == 0)
+    {
+        delete chain;
+    }
+}
+
+std::vector<Buffer>&
+Buffer::GetWritableParts()
+{
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(m_chain != nullptr);
+    if (m_chain->m_count > 1)
+    {
+        Chain* chain = new Chain;
+        chain->m_count = 1;
+        chain->m_parts = m_chain->m_parts;
+        Unref(m_chain);
+        m_chain = chain;
+    }
+    return m_chain->m_parts;
+}
+
+void
+Buffer::ReleaseChain()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_chain != nullptr)
+    {
+        Unref(m_chain);
+        m_chain = nullptr;
+        m_chainSize = 0;
+    }
+}
+
+void
+Buffer::SetHead(const Buffer& head)
+{
+    NS_LOG_FUNCTION(this << &head);
+    NS_ASSERT(head.m_chain == nullptr);
+    Chain* chain = m_chain;
+    uint32_t chainSize = m_chainSize;
+    m_chain = nullptr;
+    m_chainSize = 0;
+    *this = head;
+    m_chain = chain;
+    m_chainSize = chainSize;
+}
+
+Buffer
+Buffer::GetHead() const
+{
+    NS_LOG_FUNCTION(this);
+    Buffer head = *this;
+    head.ReleaseChain();
+    return head;
 }
 
 uint32_t
@@ -312,7 +448,16 @@ Buffer::AddAtStart(uint32_t start)
 {
     NS_LOG_FUNCTION(this << start);
     NS_ASSERT(CheckInternalState());
+#ifdef NS3_MTP
+    // A buffer sharing its data with buffers owned by other threads may
+    // extend the dirty area only if it wins the race to claim it.
+    uint32_t dirtyStart = m_start;
+    bool isDirty = m_data->m_count > 1 &&
+                   (m_start < start ||
+                    !m_data->m_dirtyStart.compare_exchange_strong(dirtyStart, m_start - start));
+#else
     bool isDirty = m_data->m_count > 1 && m_start > m_data->m_dirtyStart;
+#endif
     if (m_start >= start && !isDirty)
     {
         /* enough space in the buffer and not dirty.
@@ -320,18 +465,28 @@ Buffer::AddAtStart(uint32_t start)
          * Before: |*****---------***|
          * After:  |***..---------***|
          */
+#ifndef NS3_MTP
         NS_ASSERT(m_data->m_count == 1 || m_start == m_data->m_dirtyStart);
+#endif
         m_start -= start;
         // update dirty area
         m_data->m_dirtyStart = m_start;
     }
+    else if (GetInternalSize() > g_maxCopySize)
+    {
+        /* too many bytes to copy: chain them behind a new head.
+         * To add:  |..|
+         * Before:  |*****---------***|
+         * After:   |**..| -> |*****---------***|
+         */
+        ChainAtStart(start);
+    }
     else
     {
         uint32_t newSize = GetInternalSize() + start;
         struct Buffer::Data* newData = Buffer::Create(newSize);
         memcpy(newData->m_data + start, m_data->m_data + m_start, GetInternalSize());
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (--m_data->m_count == 0)
         {
             Buffer::Recycle(m_data);
         }
@@ -358,7 +513,33 @@ Buffer::AddAtEnd(uint32_t end)
 {
     NS_LOG_FUNCTION(this << end);
     NS_ASSERT(CheckInternalState());
+    if (m_chain != nullptr)
+    {
+        // add the bytes to the last part, which has no chain
+        std::vector<Buffer>& parts = GetWritableParts();
+        Buffer& last = parts.back();
+        last.AddAtEnd(end);
+        if (last.m_chain != nullptr)
+        {
+            // the last part chained the bytes rather than copy itself
+            Buffer part = last.m_chain->m_parts.front();
+            last.ReleaseChain();
+            parts.push_back(part);
+        }
+        m_chainSize += end;
+        LOG_INTERNAL_STATE("add end=" << end << ", ");
+        NS_ASSERT(CheckInternalState());
+        return;
+    }
+#ifdef NS3_MTP
+    // See AddAtStart: claim the dirty area before writing into shared data.
+    uint32_t dirtyEnd = m_end;
+    bool isDirty = m_data->m_count > 1 &&
+                   (GetInternalEnd() + end > m_data->m_size ||
+                    !m_data->m_dirtyEnd.compare_exchange_strong(dirtyEnd, m_end + end));
+#else
     bool isDirty = m_data->m_count > 1 && m_end < m_data->m_dirtyEnd;
+#endif
     if (GetInternalEnd() + end <= m_data->m_size && !isDirty)
     {
         /* enough space in buffer and not dirty
@@ -366,18 +547,28 @@ Buffer::AddAtEnd(uint32_t end)
          * Before: |**----*****|
          * After:  |**----...**|
          */
+#ifndef NS3_MTP
         NS_ASSERT(m_data->m_count == 1 || m_end == m_data->m_dirtyEnd);
+#endif
         m_end += end;
         // update dirty area.
         m_data->m_dirtyEnd = m_end;
     }
+    else if (GetInternalSize() > g_maxCopySize)
+    {
+        /* too many bytes to copy: chain the new bytes.
+         * Add:    |...|
+         * Before: |**----*****|
+         * After:  |**----*****| -> |...|
+         */
+        ChainAtEnd(end);
+    }
     else
     {
         uint32_t newSize = GetInternalSize() + end;
         struct Buffer::Data* newData = Buffer::Create(newSize);
         memcpy(newData->m_data, m_data->m_data + m_start, GetInternalSize());
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        if (--m_data->m_count == 0)
         {
             Buffer::Recycle(m_data);
         }
@@ -404,6 +595,12 @@ Buffer::AddAtEnd(const Buffer& o)
 {
     NS_LOG_FUNCTION(this << &o);
 
+    if (m_chain != nullptr || o.m_chain != nullptr)
+    {
+        ChainAtEnd(o);
+        return;
+    }
+
     if (m_data->m_count == 1 && (m_end == m_zeroAreaEnd || m_zeroAreaStart == m_zeroAreaEnd) &&
         m_end == m_data->m_dirtyEnd && o.m_start == o.m_zeroAreaStart &&
         o.m_zeroAreaEnd - o.m_zeroAreaStart > 0)
@@ -432,6 +629,32 @@ Buffer::AddAtEnd(const Buffer& o)
         return;
     }
 
+    if ((m_end == m_zeroAreaEnd || m_zeroAreaStart == m_zeroAreaEnd) &&
+        o.m_start == o.m_zeroAreaStart && o.m_zeroAreaEnd - o.m_zeroAreaStart > 0 &&
+        GetInternalSize() + o.GetInternalSize() <= g_maxCopySize)
+    {
+        /**
+         * The zero areas are adjacent but the data is shared: merge them
+         * in a new buffer, which copies only the bytes around them.
+         */
+        uint32_t zeroSize = m_zeroAreaEnd - m_zeroAreaStart + o.m_zeroAreaEnd - o.m_zeroAreaStart;
+        uint32_t dataStart = GetInternalSize();
+        uint32_t dataEnd = o.m_end - o.m_zeroAreaEnd;
+        Buffer tmp(0, false);
+        tmp.Initialize(dataStart, zeroSize, dataEnd);
+        memcpy(tmp.m_data->m_data, m_data->m_data + m_start, dataStart);
+        memcpy(tmp.m_data->m_data + dataStart, o.m_data->m_data + o.m_zeroAreaStart, dataEnd);
+        *this = tmp;
+        NS_ASSERT(CheckInternalState());
+        return;
+    }
+
+    if (GetSize() + o.GetSize() > g_maxCopySize)
+    {
+        ChainAtEnd(o);
+        return;
+    }
+
     *this = CreateFullCopy();
     AddAtEnd(o.GetSize());
     Buffer::Iterator destStart = End();
@@ -440,11 +663,124 @@ Buffer::AddAtEnd(const Buffer& o)
     NS_ASSERT(CheckInternalState());
 }
 
+void
+Buffer::ChainAtStart(uint32_t start)
+{
+    NS_LOG_FUNCTION(this << start);
+    if (start == 0)
+    {
+        return;
+    }
+    Buffer head = GetHead();
+    if (m_chain == nullptr)
+    {
+        m_chain = new Chain;
+        m_chain->m_count = 1;
+    }
+    std::vector<Buffer>& parts = GetWritableParts();
+    parts.insert(parts.begin(), head);
+    m_chainSize += head.GetSize();
+
+    // the new head holds the new bytes before its zero area,
+    // which starts where the heuristic places it in new buffers.
+    if (--m_data->m_count == 0)
+    {
+        Buffer::Recycle(m_data);
+    }
+    m_end = std::max(start, g_recommendedStart);
+    m_data = Buffer::Create(m_end);
+    m_start = m_end - start;
+    m_zeroAreaStart = m_end;
+    m_zeroAreaEnd = m_end;
+    m_maxZeroAreaStart = m_zeroAreaStart;
+    m_data->m_dirtyStart = m_start;
+    m_data->m_dirtyEnd = m_end;
+}
+
+void
+Buffer::ChainAtEnd(uint32_t end)
+{
+    NS_LOG_FUNCTION(this << end);
+    NS_ASSERT(m_chain == nullptr);
+    if (end == 0)
+    {
+        return;
+    }
+    Buffer part;
+    part.AddAtEnd(end);
+    m_chain = new Chain;
+    m_chain->m_count = 1;
+    m_chain->m_parts.push_back(part);
+    m_chainSize = end;
+}
+
+void
+Buffer::ChainAtEnd(const Buffer& o)
+{
+    NS_LOG_FUNCTION(this << &o);
+    if (o.GetSize() == 0)
+    {
+        return;
+    }
+    // o may be this buffer, or share its chain
+    Buffer other = o;
+    if (GetSize() == 0)
+    {
+        *this = other;
+        return;
+    }
+    if (m_chain == nullptr)
+    {
+        m_chain = new Chain;
+        m_chain->m_count = 1;
+    }
+    std::vector<Buffer>& parts = GetWritableParts();
+    parts.push_back(other.GetHead());
+    if (other.m_chain != nullptr)
+    {
+        parts.insert(parts.end(), other.m_chain->m_parts.begin(), other.m_chain->m_parts.end());
+    }
+    m_chainSize += other.GetSize();
+    LOG_INTERNAL_STATE("chain end=" << other.GetSize() << ", ");
+    NS_ASSERT(CheckInternalState());
+}
+
 void
 Buffer::RemoveAtStart(uint32_t start)
 {
     NS_LOG_FUNCTION(this << start);
     NS_ASSERT(CheckInternalState());
+    if (m_chain != nullptr && start >= m_end - m_start)
+    {
+        /* remove the head, and maybe more parts: the first part
+         * left becomes the head.
+         */
+        start -= m_end - m_start;
+        std::vector<Buffer>& parts = GetWritableParts();
+        std::size_t i = 0;
+        while (i + 1 < parts.size() && start >= parts[i].GetSize())
+        {
+            start -= parts[i].GetSize();
+            i++;
+        }
+        Buffer head = parts[i];
+        parts.erase(parts.begin(), parts.begin() + i + 1);
+        if (parts.empty())
+        {
+            ReleaseChain();
+        }
+        else
+        {
+            m_chainSize = 0;
+            for (const auto& part : parts)
+            {
+                m_chainSize += part.GetSize();
+            }
+        }
+        SetHead(head);
+        RemoveAtStart(start);
+        return;
+    }
     uint32_t newStart = m_start + start;
     if (newStart <= m_zeroAreaStart)
     {
@@ -491,6 +827,36 @@ Buffer::RemoveAtEnd(uint32_t end)
 {
     NS_LOG_FUNCTION(this << end);
     NS_ASSERT(CheckInternalState());
+    if (m_chain != nullptr)
+    {
+        /* remove the parts before the head */
+        std::vector<Buffer>& parts = GetWritableParts();
+        while (end > 0 && !parts.empty())
+        {
+            uint32_t partSize = parts.back().GetSize();
+            if (end < partSize)
+            {
+                parts.back().RemoveAtEnd(end);
+                m_chainSize -= end;
+                end = 0;
+            }
+            else
+            {
+                parts.pop_back();
+                m_chainSize -= partSize;
+                end -= partSize;
+            }
+        }
+        if (parts.empty())
+        {
+            ReleaseChain();
+        }
+        if (end == 0)
+        {
+            NS_ASSERT(CheckInternalState());
+            return;
+        }
+    }
     uint32_t newEnd = m_end - std::min(end, m_end - m_start);
     if (newEnd > m_zeroAreaEnd)
     {
@@ -539,32 +905,95 @@ Buffer::CreateFullCopy() const
 {
     NS_LOG_FUNCTION(this);
     NS_ASSERT(CheckInternalState());
-    if (m_zeroAreaEnd - m_zeroAreaStart != 0)
-    {
-        Buffer tmp;
-        tmp.AddAtStart(m_zeroAreaEnd - m_zeroAreaStart);
-        tmp.Begin().WriteU8(0, m_zeroAreaEnd - m_zeroAreaStart);
-        uint32_t dataStart = m_zeroAreaStart - m_start;
-        tmp.AddAtStart(dataStart);
-        tmp.Begin().Write(m_data->m_data + m_start, dataStart);
-        uint32_t dataEnd = m_end - m_zeroAreaEnd;
-        tmp.AddAtEnd(dataEnd);
-        Buffer::Iterator i = tmp.End();
-        i.Prev(dataEnd);
-        i.Write(m_data->m_data + m_zeroAreaStart, dataEnd);
-        NS_ASSERT(tmp.CheckInternalState());
-        return tmp;
+    if (m_chain != nullptr || m_zeroAreaEnd - m_zeroAreaStart != 0)
+    {
+        return CreateMergedCopy(false);
     }
-    NS_ASSERT(CheckInternalState());
     return *this;
 }
 
+Buffer
+Buffer::CreateMergedCopy(bool keepZeroArea) const
+{
+    NS_LOG_FUNCTION(this << keepZeroArea);
+    NS_ASSERT(CheckInternalState());
+    uint32_t zeroStart = 0;
+    uint32_t zeroSize = 0;
+    if (keepZeroArea)
+    {
+        FindZeroArea(zeroStart, zeroSize);
+    }
+
+    Buffer tmp(0, false);
+    tmp.Initialize(zeroStart, zeroSize, GetSize() - zeroStart - zeroSize);
+
+    // copy the bytes before and after the zero area
+    Buffer::Iterator start = Begin();
+    Buffer::Iterator end = Begin();
+    end.Next(zeroStart);
+    tmp.Begin().Write(start, end);
+    start = end;
+    start.Next(zeroSize);
+    Buffer::Iterator dst = tmp.Begin();
+    dst.Next(zeroStart + zeroSize);
+    dst.Write(start, End());
+    NS_ASSERT(tmp.CheckInternalState());
+    return tmp;
+}
+
+void
+Buffer::FindZeroArea(uint32_t& zeroStart, uint32_t& zeroSize) const
+{
+    NS_LOG_FUNCTION(this);
+    zeroStart = 0;
+    zeroSize = 0;
+    // find the longest run of virtual zero bytes, across the parts
+    uint32_t runStart = 0;
+    uint32_t runSize = 0;
+    uint32_t position = 0;
+    Buffer::Iterator i = Begin();
+    while (position < GetSize())
+    {
+        uint32_t size = GetSize() - position;
+        if (i.GetReadSpan(size) != nullptr)
+        {
+            runStart = position + size;
+            runSize = 0;
+        }
+        else
+        {
+            runSize += size;
+            if (runSize > zeroSize)
+            {
+                zeroStart = runStart;
+                zeroSize = runSize;
+            }
+        }
+        i.m_current += size;
+        position += size;
+    }
+}
+
 uint32_t
 Buffer::GetSerializedSize() const
 {
     NS_LOG_FUNCTION(this);
-    uint32_t dataStart = (m_zeroAreaStart - m_start + 3) & (~0x3);
-    uint32_t dataEnd = (m_end - m_zeroAreaEnd + 3) & (~0x3);
+    uint32_t dataStart;
+    uint32_t dataEnd;
+    if (m_chain != nullptr)
+    {
+        // the size of the serialization of the merged copy
+        uint32_t zeroStart;
+        uint32_t zeroSize;
+        FindZeroArea(zeroStart, zeroSize);
+        dataStart = (zeroStart + 3) & (~0x3);
+        dataEnd = (GetSize() - zeroStart - zeroSize + 3) & (~0x3);
+    }
+    else
+    {
+        dataStart = (m_zeroAreaStart - m_start + 3) & (~0x3);
+        dataEnd = (m_end - m_zeroAreaEnd + 3) & (~0x3);
+    }
 
     // total size 4-bytes for dataStart length
     // + X number of bytes for dataStart
@@ -579,6 +1008,10 @@ uint32_t
 Buffer::Serialize(uint8_t* buffer, uint32_t maxSize) const
 {
     NS_LOG_FUNCTION(this << &buffer << maxSize);
+    if (m_chain != nullptr)
+    {
+        return SerializeChain(buffer, maxSize);
+    }
     uint32_t* p = reinterpret_cast<uint32_t*>(buffer);
     uint32_t size = 0;
 
@@ -647,6 +1080,32 @@ Buffer::Serialize(uint8_t* buffer, uint32_t maxSize) const
     return 1;
 }
 
+uint32_t
+Buffer::SerializeChain(uint8_t* buffer, uint32_t maxSize) const
+{
+    NS_LOG_FUNCTION(this << &buffer << maxSize);
+    // the layout of Serialize, with the zero area of the merged copy, whose
+    // bytes are read through the parts
+    uint32_t zeroStart;
+    uint32_t zeroSize;
+    FindZeroArea(zeroStart, zeroSize);
+    uint32_t dataEndLength = GetSize() - zeroStart - zeroSize;
+    if (3 * sizeof(uint32_t) + ((zeroStart + 3) & (~3)) + dataEndLength > maxSize)
+    {
+        return 0;
+    }
+    uint32_t* p = reinterpret_cast<uint32_t*>(buffer);
+    *p++ = zeroSize;
+    *p++ = zeroStart;
+    Buffer::Iterator i = Begin();
+    i.Read(reinterpret_cast<uint8_t*>(p), zeroStart);
+    p += ((zeroStart + 3) & (~3)) / 4;
+    *p++ = dataEndLength;
+    i.Next(zeroSize);
+    i.Read(reinterpret_cast<uint8_t*>(p), dataEndLength);
+    return 1;
+}
+
 uint32_t
 Buffer::Deserialize(const uint8_t* buffer, uint32_t size)
 {
@@ -658,30 +1117,25 @@ Buffer::Deserialize(const uint8_t* buffer, uint32_t size)
     uint32_t zeroDataLength = *p++;
     sizeCheck -= 4;
 
-    // Create zero bytes
-    Initialize(zeroDataLength);
-
-    // Add start data
+    // Start data
     NS_ASSERT(sizeCheck >= 4);
     uint32_t dataStartLength = *p++;
     sizeCheck -= 4;
-    AddAtStart(dataStartLength);
-
     NS_ASSERT(sizeCheck >= dataStartLength);
-    Begin().Write(reinterpret_cast<uint8_t*>(const_cast<uint32_t*>(p)), dataStartLength);
+    const uint32_t* dataStart = p;
     p += (((dataStartLength + 3) & (~3)) / 4); // Advance p, insuring 4 byte boundary
     sizeCheck -= ((dataStartLength + 3) & (~3));
 
-    // Add end data
+    // End data
     NS_ASSERT(sizeCheck >= 4);
     uint32_t dataEndLength = *p++;
     sizeCheck -= 4;
-    AddAtEnd(dataEndLength);
-
     NS_ASSERT(sizeCheck >= dataEndLength);
-    Buffer::Iterator tmp = End();
-    tmp.Prev(dataEndLength);
-    tmp.Write(reinterpret_cast<uint8_t*>(const_cast<uint32_t*>(p)), dataEndLength);
+
+    // Create the zero bytes, surrounded by the data
+    Initialize(dataStartLength, zeroDataLength, dataEndLength);
+    memcpy(m_data->m_data, dataStart, dataStartLength);
+    memcpy(m_data->m_data + m_zeroAreaStart, p, dataEndLength);
     // The following line is unnecessary.
     // p += (((dataEndLength+3)&(~3))/4); // Advance p, insuring 4 byte boundary
     sizeCheck -= ((dataEndLength + 3) & (~3));
@@ -716,6 +1170,21 @@ void
 Buffer::CopyData(std::ostream* os, uint32_t size) const
 {
     NS_LOG_FUNCTION(this << &os << size);
+    if (m_chain != nullptr)
+    {
+        // write the bytes span by span, and the zero areas from g_zeroes
+        Buffer::Iterator i = Begin();
+        size = std::min(size, GetSize());
+        while (size > 0)
+        {
+            uint32_t toWrite = std::min(size, g_zeroes.size);
+            const uint8_t* span = i.GetReadSpan(toWrite);
+            os->write(span != nullptr ? (const char*)span : g_zeroes.buffer, toWrite);
+            i.m_current += toWrite;
+            size -= toWrite;
+        }
+        return;
+    }
     if (size > 0)
     {
         uint32_t tmpsize = std::min(m_zeroAreaStart - m_start, size);
@@ -745,6 +1214,12 @@ uint32_t
 Buffer::CopyData(uint8_t* buffer, uint32_t size) const
 {
     NS_LOG_FUNCTION(this << &buffer << size);
+    if (m_chain != nullptr)
+    {
+        size = std::min(size, GetSize());
+        Begin().Read(buffer, size);
+        return size;
+    }
     uint32_t originalSize = size;
     if (size > 0)
     {
@@ -783,6 +1258,13 @@ uint32_t
 Buffer::Iterator::GetDistanceFrom(const Iterator& o) const
 {
     NS_LOG_FUNCTION(this << &o);
+    if (m_chain != nullptr)
+    {
+        NS_ASSERT(m_chain == o.m_chain && m_head.data == o.m_head.data);
+        uint32_t position = GetPosition();
+        uint32_t otherPosition = o.GetPosition();
+        return position > otherPosition ? position - otherPosition : otherPosition - position;
+    }
     NS_ASSERT(m_data == o.m_data);
     int32_t diff = m_current - o.m_current;
     if (diff < 0)
@@ -799,6 +1281,11 @@ bool
 Buffer::Iterator::IsEnd() const
 {
     NS_LOG_FUNCTION(this);
+    if (m_chain != nullptr && m_part < m_chain->m_parts.size())
+    {
+        // the next parts are not empty
+        return false;
+    }
     return m_current == m_dataEnd;
 }
 
@@ -806,13 +1293,236 @@ bool
 Buffer::Iterator::IsStart() const
 {
     NS_LOG_FUNCTION(this);
-    return m_current == m_dataStart;
+    return m_part == 0 && m_current == m_dataStart;
+}
+
+uint32_t
+Buffer::Iterator::GetPosition() const
+{
+    NS_LOG_FUNCTION(this);
+    return m_partStart + m_current - m_dataStart;
+}
+
+void
+Buffer::Iterator::SetPart(uint32_t part)
+{
+    NS_LOG_FUNCTION(this << part);
+    NS_ASSERT(m_chain != nullptr && part <= m_chain->m_parts.size());
+    if (part == 0)
+    {
+        m_zeroStart = m_head.zeroStart;
+        m_zeroEnd = m_head.zeroEnd;
+        m_dataStart = m_head.start;
+        m_dataEnd = m_head.end;
+        m_data = m_head.data;
+    }
+    else
+    {
+        const Buffer& buffer = m_chain->m_parts[part - 1];
+        m_zeroStart = buffer.m_zeroAreaStart;
+        m_zeroEnd = buffer.m_zeroAreaEnd;
+        m_dataStart = buffer.m_start;
+        m_dataEnd = buffer.m_end;
+        m_data = buffer.m_data->m_data;
+    }
+    m_part = part;
+}
+
+bool
+Buffer::Iterator::NextPart()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_chain == nullptr || m_part == m_chain->m_parts.size())
+    {
+        return false;
+    }
+    m_partStart += m_dataEnd - m_dataStart;
+    SetPart(m_part + 1);
+    m_current = m_dataStart;
+    return true;
+}
+
+bool
+Buffer::Iterator::PrevPart()
+{
+    NS_LOG_FUNCTION(this);
+    if (m_chain == nullptr || m_part == 0)
+    {
+        return false;
+    }
+    SetPart(m_part - 1);
+    m_partStart -= m_dataEnd - m_dataStart;
+    m_current = m_dataEnd;
+    return true;
+}
+
+void
+Buffer::Iterator::SetLastPart()
+{
+    NS_LOG_FUNCTION(this);
+    SetPart(m_chain->m_parts.size());
+    m_partStart = m_size - (m_dataEnd - m_dataStart);
+}
+
+void
+Buffer::Iterator::SlowNext(uint32_t delta)
+{
+    NS_LOG_FUNCTION(this << delta);
+    while (m_current + delta > m_dataEnd)
+    {
+        uint32_t left = m_dataEnd - m_current;
+        if (!NextPart())
+        {
+            break;
+        }
+        delta -= left;
+    }
+    NS_ASSERT(m_current + delta <= m_dataEnd);
+    m_current += delta;
+}
+
+void
+Buffer::Iterator::SlowPrev(uint32_t delta)
+{
+    NS_LOG_FUNCTION(this << delta);
+    while (m_current < m_dataStart + delta)
+    {
+        uint32_t left = m_current - m_dataStart;
+        if (!PrevPart())
+        {
+            break;
+        }
+        delta -= left;
+    }
+    NS_ASSERT(m_current >= delta);
+    m_current -= delta;
+}
+
+uint8_t
+Buffer::Iterator::SlowPeekU8()
+{
+    NS_LOG_FUNCTION(this);
+    if (NextPart())
+    {
+        return PeekU8();
+    }
+    NS_ASSERT_MSG(m_current < m_dataEnd, GetReadErrorMessage());
+    return m_data[m_current - (m_zeroEnd - m_zeroStart)];
+}
+
+void
+Buffer::Iterator::SlowWriteU8(uint8_t data)
+{
+    NS_LOG_FUNCTION(this << data);
+    if (NextPart())
+    {
+        WriteU8(data);
+        return;
+    }
+    NS_ASSERT_MSG(m_current < m_dataEnd, GetWriteErrorMessage());
+    m_data[m_current - (m_zeroEnd - m_zeroStart)] = data;
+    m_current++;
+}
+
+void
+Buffer::Iterator::SlowWriteU8(uint8_t data, uint32_t len)
+{
+    NS_LOG_FUNCTION(this << data << len);
+    if (m_chain == nullptr)
+    {
+        uint8_t* buffer;
+        if (m_current <= m_zeroStart)
+        {
+            buffer = &m_data[m_current];
+        }
+        else
+        {
+            buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+        }
+        std::memset(buffer, data, len);
+        m_current += len;
+        return;
+    }
+    while (len > 0)
+    {
+        uint32_t toWrite = len;
+        uint8_t* buffer = GetWriteSpan(toWrite);
+        if (toWrite == 0)
+        {
+            break;
+        }
+        std::memset(buffer, data, toWrite);
+        m_current += toWrite;
+        len -= toWrite;
+    }
+}
+
+const uint8_t*
+Buffer::Iterator::GetReadSpan(uint32_t& size)
+{
+    NS_LOG_FUNCTION(this << size);
+    if (m_current == m_dataEnd)
+    {
+        NextPart();
+    }
+    const uint8_t* span;
+    uint32_t end;
+    if (m_current < m_zeroStart)
+    {
+        span = &m_data[m_current];
+        end = m_zeroStart;
+    }
+    else if (m_current < m_zeroEnd)
+    {
+        span = nullptr;
+        end = m_zeroEnd;
+    }
+    else
+    {
+        span = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+        end = m_dataEnd;
+    }
+    NS_ASSERT_MSG(m_current >= m_dataStart && m_current < end, GetReadErrorMessage());
+    size = m_current < end ? std::min(size, end - m_current) : 0;
+    return span;
+}
+
+uint8_t*
+Buffer::Iterator::GetWriteSpan(uint32_t& size)
+{
+    NS_LOG_FUNCTION(this << size);
+    if (m_current == m_dataEnd)
+    {
+        NextPart();
+    }
+    uint8_t* span;
+    uint32_t end;
+    if (m_current < m_zeroStart)
+    {
+        span = &m_data[m_current];
+        end = m_zeroStart == m_zeroEnd ? m_dataEnd : m_zeroStart;
+    }
+    else
+    {
+        NS_ASSERT_MSG(m_current >= m_zeroEnd, GetWriteErrorMessage());
+        span = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
+        end = m_dataEnd;
+    }
+    NS_ASSERT_MSG(m_current >= m_dataStart && m_current < end, GetWriteErrorMessage());
+    size = m_current < end ? std::min(size, end - m_current) : 0;
+    return span;
 }
 
 bool
 Buffer::Iterator::CheckNoZero(uint32_t start, uint32_t end) const
 {
     NS_LOG_FUNCTION(this << &start << &end);
+    if (m_chain != nullptr)
+    {
+        // the bytes beyond this part are checked when writing them
+        end = std::min(end, m_dataEnd);
+        start = std::min(start, end);
+    }
     return !(start < m_dataStart || end > m_dataEnd ||
              (end > m_zeroStart && start < m_zeroEnd && m_zeroEnd != m_zeroStart && start != end));
 }
@@ -828,6 +1538,33 @@ void
 Buffer::Iterator::Write(Iterator start, Iterator end)
 {
     NS_LOG_FUNCTION(this << &start << &end);
+    if (m_chain != nullptr || start.m_chain != nullptr)
+    {
+        // copy the bytes span by span, across the parts of the buffers
+        uint32_t size = end.GetDistanceFrom(start);
+        while (size > 0)
+        {
+            uint32_t toCopy = size;
+            const uint8_t* from = start.GetReadSpan(toCopy);
+            uint8_t* to = GetWriteSpan(toCopy);
+            if (toCopy == 0)
+            {
+                break;
+            }
+            if (from != nullptr)
+            {
+                memcpy(to, from, toCopy);
+            }
+            else
+            {
+                memset(to, 0, toCopy);
+            }
+            start.m_current += toCopy;
+            m_current += toCopy;
+            size -= toCopy;
+        }
+        return;
+    }
     NS_ASSERT(start.m_data == end.m_data);
     NS_ASSERT(start.m_current <= end.m_current);
     NS_ASSERT(start.m_zeroStart == end.m_zeroStart);
@@ -951,6 +1688,23 @@ void
 Buffer::Iterator::Write(const uint8_t* buffer, uint32_t size)
 {
     NS_LOG_FUNCTION(this << &buffer << size);
+    if (m_chain != nullptr)
+    {
+        while (size > 0)
+        {
+            uint32_t toCopy = size;
+            uint8_t* to = GetWriteSpan(toCopy);
+            if (toCopy == 0)
+            {
+                break;
+            }
+            memcpy(to, buffer, toCopy);
+            m_current += toCopy;
+            buffer += toCopy;
+            size -= toCopy;
+        }
+        return;
+    }
     NS_ASSERT_MSG(CheckNoZero(m_current, size), GetWriteErrorMessage());
     uint8_t* to;
     if (m_current <= m_zeroStart)
@@ -1128,6 +1882,30 @@ void
 Buffer::Iterator::Read(uint8_t* buffer, uint32_t size)
 {
     NS_LOG_FUNCTION(this << &buffer << size);
+    if (m_chain != nullptr)
+    {
+        while (size > 0)
+        {
+            uint32_t toCopy = size;
+            const uint8_t* from = GetReadSpan(toCopy);
+            if (toCopy == 0)
+            {
+                break;
+            }
+            if (from != nullptr)
+            {
+                memcpy(buffer, from, toCopy);
+            }
+            else
+            {
+                memset(buffer, 0, toCopy);
+            }
+            m_current += toCopy;
+            buffer += toCopy;
+            size -= toCopy;
+        }
+        return;
+    }
     for (uint32_t i = 0; i < size; i++)
     {
         buffer[i] = ReadU8();
@@ -1169,6 +1947,10 @@ uint32_t
 Buffer::Iterator::GetSize() const
 {
     NS_LOG_FUNCTION(this);
+    if (m_chain != nullptr)
+    {
+        return m_size;
+    }
     return m_dataEnd - m_dataStart;
 }
 
@@ -1176,6 +1958,10 @@ uint32_t
 Buffer::Iterator::GetRemainingSize() const
 {
     NS_LOG_FUNCTION(this);
+    if (m_chain != nullptr)
+    {
+        return m_size - GetPosition();
+    }
     return m_dataEnd - m_current;
 }
 
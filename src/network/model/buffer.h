@@ -25,6 +25,10 @@
 #include <stdint.h>
 #include <vector>
 
+#ifdef NS3_MTP
+#include <atomic>
+#endif
+
 #define BUFFER_FREE_LIST 1
 
 namespace ns3
@@ -89,9 +93,29 @@ namespace ns3
  * \endverbatim
  *
  * A simple state invariant is that m_start <= m_zeroStart <= m_zeroEnd <= m_end
+ *
+ * The bytes described above make up the "head" of the Buffer, which
+ * may be followed by a chain of other parts. When bytes are added to
+ * a Buffer whose data cannot be written in place, because the
+ * BufferData is shared and the new bytes would fall inside its dirty
+ * area, the real bytes of the head are copied to a new BufferData only
+ * if they are few. Otherwise, the head is moved to the front of the
+ * chain, behind a new small head, or the new bytes are appended as a new
+ * part. Appending a Buffer to another one also chains the parts of the
+ * appended Buffer unless both are small. Hence, fragmenting, aggregating
+ * and adding headers to shared packets never copy their payload.
+ *
+ * The parts are themselves Buffers without chain, never empty, and they
+ * are never modified in place once shared: the Buffer::Chain which holds
+ * them is refcounted and copied on write. The parts are merged into a
+ * single real byte buffer only by the few methods which need contiguous
+ * bytes, such as PeekData.
  */
 class Buffer
 {
+  private:
+    struct Chain;
+
   public:
     /**
      * \brief iterator in a Buffer instance
@@ -439,6 +463,98 @@ class Buffer
          * \warning this is the slow version, please use ReadNtohU32 ()
          */
         uint32_t SlowReadNtohU32();
+        /**
+         * \return the byte read in the buffer.
+         *
+         * Read data, but do not advance the Iterator read.
+         *
+         * \warning this is the slow version, used at the end of a part,
+         * please use PeekU8 ()
+         */
+        uint8_t SlowPeekU8();
+        /**
+         * \param data data to write in buffer
+         *
+         * Write the data in buffer and advance the iterator position
+         * by one byte.
+         *
+         * \warning this is the slow version, used at the end of a part,
+         * please use WriteU8 ()
+         */
+        void SlowWriteU8(uint8_t data);
+        /**
+         * \param data data to write in buffer
+         * \param len number of times data must be written in buffer
+         *
+         * Write the data in buffer len times and advance the iterator position
+         * by len byte.
+         *
+         * \warning this is the slow version, used when the bytes span
+         * several parts, please use WriteU8 ()
+         */
+        void SlowWriteU8(uint8_t data, uint32_t len);
+        /**
+         * \param delta number of bytes to go forward
+         *
+         * \warning this is the slow version, used when leaving the current
+         * part, please use Next ()
+         */
+        void SlowNext(uint32_t delta);
+        /**
+         * \param delta number of bytes to go backward
+         *
+         * \warning this is the slow version, used when leaving the current
+         * part, please use Prev ()
+         */
+        void SlowPrev(uint32_t delta);
+        /**
+         * Point to a part of a chained buffer, the head being part 0.
+         *
+         * The offset of the start of the part must be updated by the caller.
+         *
+         * \param part the index of the part
+         */
+        void SetPart(uint32_t part);
+        /**
+         * Go to the start of the next part of a chained buffer.
+         *
+         * \returns false if there is no next part.
+         */
+        bool NextPart();
+        /**
+         * Go to the end of the previous part of a chained buffer.
+         *
+         * \returns false if there is no previous part.
+         */
+        bool PrevPart();
+        /**
+         * Go to the end of the last part of a chained buffer.
+         */
+        void SetLastPart();
+        /**
+         * \returns the offset of the current position from the start of
+         * the buffer.
+         */
+        uint32_t GetPosition() const;
+        /**
+         * Get the bytes which can be read contiguously from the current
+         * position, going to the next part first if at the end of a part.
+         *
+         * \param [in,out] size the number of bytes wanted, reduced to the
+         *             number of contiguous bytes.
+         * \returns a pointer to the bytes, or a null pointer if they
+         * are in the "virtual zero area".
+         */
+        const uint8_t* GetReadSpan(uint32_t& size);
+        /**
+         * Get the bytes which can be written contiguously from the current
+         * position, going to the next part first if at the end of a part.
+         *
+         * \param [in,out] size the number of bytes wanted, reduced to the
+         *             number of contiguous bytes.
+         * \returns a pointer to the bytes.
+         */
+        uint8_t* GetWriteSpan(uint32_t& size);
         /**
          * \brief Returns an appropriate message indicating a read error
          * \returns the error message
@@ -483,6 +599,42 @@ class Buffer
          * to this pointer.
          */
         uint8_t* m_data;
+        /// The head of a chained buffer
+        struct Head
+        {
+            uint8_t* data;      //!< the byte buffer of the head
+            uint32_t zeroStart; //!< the start of the zero area of the head
+            uint32_t zeroEnd;   //!< the end of the zero area of the head
+            uint32_t start;     //!< the start of the data of the head
+            uint32_t end;       //!< the end of the data of the head
+        };
+
+        /**
+         * the refcounted chain of the buffer this iterator refers to if
+         * it is chained, in which case the offsets above describe its
+         * current part, or a null pointer otherwise. The iterator does not
+         * refer to the Buffer itself, which may be destroyed while its
+         * chain is shared by other buffers.
+         */
+        const Chain* m_chain;
+        /**
+         * the head of a chained buffer.
+         */
+        Head m_head;
+        /**
+         * the number of bytes of a chained buffer.
+         */
+        uint32_t m_size;
+        /**
+         * the index of the current part of a chained buffer, the head
+         * being part 0.
+         */
+        uint32_t m_part;
+        /**
+         * offset in bytes from the start of a chained buffer to the start
+         * of its current part.
+         */
+        uint32_t m_partStart;
     };
 
     /**
@@ -665,11 +817,29 @@ class Buffer
          * The reference count of an instance of this data structure.
          * Each buffer which references an instance holds a count.
          */
+#ifdef NS3_MTP
+        std::atomic<uint32_t> m_count;
+#else
         uint32_t m_count;
+#endif
         /**
          * the size of the m_data field below.
          */
         uint32_t m_size;
+#ifdef NS3_MTP
+        /**
+         * offset from the start of the m_data field below to the
+         * start of the area in which user bytes were written.
+         * Buffers in different threads may race to extend it.
+         */
+        std::atomic<uint32_t> m_dirtyStart;
+        /**
+         * offset from the start of the m_data field below to the
+         * end of the area in which user bytes were written.
+         * Buffers in different threads may race to extend it.
+         */
+        std::atomic<uint32_t> m_dirtyEnd;
+#else
         /**
          * offset from the start of the m_data field below to the
          * start of the area in which user bytes were written.
@@ -680,6 +850,7 @@ class Buffer
          * end of the area in which user bytes were written.
          */
         uint32_t m_dirtyEnd;
+#endif
         /**
          * The real data buffer holds _at least_ one byte.
          * Its real size is stored in the m_size field.
@@ -687,6 +858,29 @@ class Buffer
         uint8_t m_data[1];
     };
 
+    /**
+     * The parts which follow the head of a chained buffer.
+     *
+     * A chain is shared by the copies of a buffer, and copied before
+     * being modified if it is shared.
+     */
+    struct Chain
+    {
+        /**
+         * The reference count of an instance of this data structure.
+         * Each buffer which references an instance holds a count.
+         */
+#ifdef NS3_MTP
+        std::atomic<uint32_t> m_count;
+#else
+        uint32_t m_count;
+#endif
+        /**
+         * The parts, which have no chain and are not empty.
+         */
+        std::vector<Buffer> m_parts;
+    };
+
     /**
      * \brief Create a full copy of the buffer, including
      * all the internal structures.
@@ -715,6 +909,19 @@ class Buffer
      */
     void Initialize(uint32_t zeroSize);
 
+    /**
+     * \brief Initializes the buffer with real bytes around a number
+     * of zeroes.
+     *
+     * The real bytes are allocated in a single data area, and must be
+     * written by the caller.
+     *
+     * \param dataStart the number of bytes before the zeroes
+     * \param zeroSize the zeroes size
+     * \param dataEnd the number of bytes after the zeroes
+     */
+    void Initialize(uint32_t dataStart, uint32_t zeroSize, uint32_t dataEnd);
+
     /**
      * \brief Get the buffer real size.
      * \warning The real size is the actual memory used by the buffer.
@@ -728,6 +935,95 @@ class Buffer
      */
     uint32_t GetInternalEnd() const;
 
+    /**
+     * \brief Get the parts which follow the head, to modify them.
+     *
+     * The chain is copied first if it is shared.
+     *
+     * \returns the parts, which the caller must not leave empty.
+     */
+    std::vector<Buffer>& GetWritableParts();
+
+    /**
+     * \brief Release the chain, and with it all the parts which
+     * follow the head.
+     */
+    void ReleaseChain();
+
+    /**
+     * \brief Replace the head, keeping the chain.
+     * \param head the new head, which has no chain.
+     */
+    void SetHead(const Buffer& head);
+
+    /**
+     * \brief Get the head of the buffer, without the chain.
+     * \returns the head.
+     */
+    Buffer GetHead() const;
+
+    /**
+     * \brief Add bytes at the start by moving the head to the front
+     * of the chain, behind a new head holding the new bytes.
+     * \param start size to reserve
+     */
+    void ChainAtStart(uint32_t start);
+
+    /**
+     * \brief Add bytes at the end of a buffer without chain, as a
+     * new part.
+     * \param end size to reserve
+     */
+    void ChainAtEnd(uint32_t end);
+
+    /**
+     * \brief Add the bytes of a buffer at the end as new parts.
+     * \param o the buffer to append to the end of this buffer.
+     */
+    void ChainAtEnd(const Buffer& o);
+
+    /**
+     * \brief Merge the parts of a buffer in a new buffer without chain.
+     *
+     * \param keepZeroArea whether the longest run of zero bytes of the
+     * zero areas of the parts is kept as the zero area of the new
+     * buffer, rather than written in memory.
+     * \returns the merged buffer
+     */
+    Buffer CreateMergedCopy(bool keepZeroArea) const;
+
+    /**
+     * \brief Find the longest run of zero bytes of the zero areas of the
+     * parts of a buffer, which its merged copy keeps as zero area.
+     *
+     * \param [out] zeroStart the offset of the run
+     * \param [out] zeroSize the size of the run
+     */
+    void FindZeroArea(uint32_t& zeroStart, uint32_t& zeroSize) const;
+
+    /**
+     * \brief Serialize a chained buffer, as its merged copy would be, without
+     * merging it.
+     *
+     * \param [out] buffer the serialization buffer
+     * \param [in] maxSize the size of the serialization buffer
+     * \returns 1 if the buffer fits in the serialization buffer, 0 otherwise
+     */
+    uint32_t SerializeChain(uint8_t* buffer, uint32_t maxSize) const;
+
+    /**
+     * \brief Increment the reference count of a chain.
+     * \param chain the chain
+     */
+    static void Ref(Chain* chain);
+
+    /**
+     * \brief Decrement the reference count of a chain, and delete it
+     * if it was the last reference.
+     * \param chain the chain
+     */
+    static void Unref(Chain* chain);
+
     /**
      * \brief Recycle the buffer memory
      * \param data the buffer data storage
@@ -769,7 +1065,11 @@ class Buffer
      * writing data. i.e., m_start should be initialized to this
      * value.
      */
+#ifdef NS3_MTP
+    static thread_local uint32_t g_recommendedStart;
+#else
     static uint32_t g_recommendedStart;
+#endif
 
     /**
      * offset to the start of the virtual zero area from the start
@@ -792,6 +1092,16 @@ class Buffer
      */
     uint32_t m_end;
 
+    /**
+     * the parts which follow the head, or a null pointer if the buffer
+     * is made of its head only.
+     */
+    Chain* m_chain;
+    /**
+     * the number of bytes in the parts of the chain.
+     */
+    uint32_t m_chainSize;
+
 #ifdef BUFFER_FREE_LIST
     /// Container for buffer data
     typedef std::vector<struct Buffer::Data*> FreeList;
@@ -802,10 +1112,18 @@ class Buffer
         ~LocalStaticDestructor();
     };
 
+#ifdef NS3_MTP
+    // Each simulation thread keeps its own free list.
+    static thread_local uint32_t g_maxSize;   //!< Max observed data size
+    static thread_local FreeList* g_freeList; //!< Buffer data container
+    static thread_local struct LocalStaticDestructor
+        g_localStaticDestructor; //!< Local static destructor
+#else
     static uint32_t g_maxSize;                                   //!< Max observed data size
     static FreeList* g_freeList;                                 //!< Buffer data container
     static struct LocalStaticDestructor g_localStaticDestructor; //!< Local static destructor
 #endif
+#endif
 };
 
 } // namespace ns3
@@ -823,7 +1141,12 @@ Buffer::Iterator::Iterator()
       m_dataStart(0),
       m_dataEnd(0),
       m_current(0),
-      m_data(nullptr)
+      m_data(nullptr),
+      m_chain(nullptr),
+      m_head{nullptr, 0, 0, 0, 0},
+      m_size(0),
+      m_part(0),
+      m_partStart(0)
 {
 }
 
@@ -836,6 +1159,10 @@ Buffer::Iterator::Iterator(const Buffer* buffer)
 Buffer::Iterator::Iterator(const Buffer* buffer, bool dummy)
 {
     Construct(buffer);
+    if (m_chain != nullptr)
+    {
+        SetLastPart();
+    }
     m_current = m_dataEnd;
 }
 
@@ -847,34 +1174,66 @@ Buffer::Iterator::Construct(const Buffer* buffer)
     m_dataStart = buffer->m_start;
     m_dataEnd = buffer->m_end;
     m_data = buffer->m_data->m_data;
+    m_chain = buffer->m_chain;
+    if (m_chain != nullptr)
+    {
+        m_head = {m_data, m_zeroStart, m_zeroEnd, m_dataStart, m_dataEnd};
+        m_size = buffer->GetSize();
+    }
+    m_part = 0;
+    m_partStart = 0;
 }
 
 void
 Buffer::Iterator::Next()
 {
-    NS_ASSERT(m_current + 1 <= m_dataEnd);
-    m_current++;
+    if (m_current < m_dataEnd)
+    {
+        m_current++;
+    }
+    else
+    {
+        SlowNext(1);
+    }
 }
 
 void
 Buffer::Iterator::Prev()
 {
-    NS_ASSERT(m_current >= 1);
-    m_current--;
+    if (m_current > m_dataStart)
+    {
+        m_current--;
+    }
+    else
+    {
+        SlowPrev(1);
+    }
 }
 
 void
 Buffer::Iterator::Next(uint32_t delta)
 {
-    NS_ASSERT(m_current + delta <= m_dataEnd);
-    m_current += delta;
+    if (m_current + delta <= m_dataEnd)
+    {
+        m_current += delta;
+    }
+    else
+    {
+        SlowNext(delta);
+    }
 }
 
 void
 Buffer::Iterator::Prev(uint32_t delta)
 {
-    NS_ASSERT(m_current >= delta);
-    m_current -= delta;
+    if (m_current >= m_dataStart + delta)
+    {
+        m_current -= delta;
+    }
+    else
+    {
+        SlowPrev(delta);
+    }
 }
 
 void
@@ -887,28 +1246,36 @@ Buffer::Iterator::WriteU8(uint8_t data)
         m_data[m_current] = data;
         m_current++;
     }
-    else
+    else if (m_current < m_dataEnd)
     {
         m_data[m_current - (m_zeroEnd - m_zeroStart)] = data;
         m_current++;
     }
+    else
+    {
+        SlowWriteU8(data);
+    }
 }
 
 void
 Buffer::Iterator::WriteU8(uint8_t data, uint32_t len)
 {
     NS_ASSERT_MSG(CheckNoZero(m_current, m_current + len), GetWriteErrorMessage());
-    if (m_current <= m_zeroStart)
+    if (m_current + len <= m_zeroStart)
     {
         std::memset(&(m_data[m_current]), data, len);
         m_current += len;
     }
-    else
+    else if (m_current >= m_zeroEnd && m_current + len <= m_dataEnd)
     {
         uint8_t* buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
         std::memset(buffer, data, len);
         m_current += len;
     }
+    else
+    {
+        SlowWriteU8(data, len);
+    }
 }
 
 void
@@ -920,10 +1287,16 @@ Buffer::Iterator::WriteHtonU16(uint16_t data)
     {
         buffer = &m_data[m_current];
     }
-    else
+    else if (m_current + 2 <= m_dataEnd)
     {
         buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
     }
+    else
+    {
+        WriteU8((data >> 8) & 0xff);
+        WriteU8((data >> 0) & 0xff);
+        return;
+    }
     buffer[0] = (data >> 8) & 0xff;
     buffer[1] = (data >> 0) & 0xff;
     m_current += 2;
@@ -939,10 +1312,18 @@ Buffer::Iterator::WriteHtonU32(uint32_t data)
     {
         buffer = &m_data[m_current];
     }
-    else
+    else if (m_current + 4 <= m_dataEnd)
     {
         buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
     }
+    else
+    {
+        WriteU8((data >> 24) & 0xff);
+        WriteU8((data >> 16) & 0xff);
+        WriteU8((data >> 8) & 0xff);
+        WriteU8((data >> 0) & 0xff);
+        return;
+    }
     buffer[0] = (data >> 24) & 0xff;
     buffer[1] = (data >> 16) & 0xff;
     buffer[2] = (data >> 8) & 0xff;
@@ -958,7 +1339,7 @@ Buffer::Iterator::ReadNtohU16()
     {
         buffer = &m_data[m_current];
     }
-    else if (m_current >= m_zeroEnd)
+    else if (m_current >= m_zeroEnd && m_current + 2 <= m_dataEnd)
     {
         buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
     }
@@ -982,7 +1363,7 @@ Buffer::Iterator::ReadNtohU32()
     {
         buffer = &m_data[m_current];
     }
-    else if (m_current >= m_zeroEnd)
+    else if (m_current >= m_zeroEnd && m_current + 4 <= m_dataEnd)
     {
         buffer = &m_data[m_current - (m_zeroEnd - m_zeroStart)];
     }
@@ -1005,7 +1386,7 @@ Buffer::Iterator::ReadNtohU32()
 uint8_t
 Buffer::Iterator::PeekU8()
 {
-    NS_ASSERT_MSG(m_current >= m_dataStart && m_current < m_dataEnd, GetReadErrorMessage());
+    NS_ASSERT_MSG(m_current >= m_dataStart, GetReadErrorMessage());
 
     if (m_current < m_zeroStart)
     {
@@ -1016,11 +1397,15 @@ Buffer::Iterator::PeekU8()
     {
         return 0;
     }
-    else
+    else if (m_current < m_dataEnd)
     {
         uint8_t data = m_data[m_current - (m_zeroEnd - m_zeroStart)];
         return data;
     }
+    else
+    {
+        return SlowPeekU8();
+    }
 }
 
 uint8_t
@@ -1058,16 +1443,22 @@ Buffer::Buffer(const Buffer& o)
       m_zeroAreaStart(o.m_zeroAreaStart),
       m_zeroAreaEnd(o.m_zeroAreaEnd),
       m_start(o.m_start),
-      m_end(o.m_end)
+      m_end(o.m_end),
+      m_chain(o.m_chain),
+      m_chainSize(o.m_chainSize)
 {
     m_data->m_count++;
+    if (m_chain != nullptr)
+    {
+        Ref(m_chain);
+    }
     NS_ASSERT(CheckInternalState());
 }
 
 uint32_t
 Buffer::GetSize() const
 {
-    return m_end - m_start;
+    return m_end - m_start + m_chainSize;
 }
 
 Buffer::Iterator
@@ -24,6 +24,10 @@
 #include <limits>
 #include <vector>
 
+#ifdef NS3_MTP
+#include <atomic>
+#endif
+
 #define USE_FREE_LIST 1
 #define FREE_LIST_SIZE 1000
 #define OFFSET_MAX (std::numeric_limits<int32_t>::max())
@@ -42,9 +46,14 @@ NS_LOG_COMPONENT_DEFINE("ByteTagList");
  */
 struct ByteTagListData
 {
-    uint32_t size;   //!< size of the data
-    uint32_t count;  //!< use counter (for smart deallocation)
-    uint32_t dirty;  //!< number of bytes actually in use
+    uint32_t size; //!< size of the data
+#ifdef NS3_MTP
+    std::atomic<uint32_t> count; //!< use counter (for smart deallocation)
+    std::atomic<uint32_t> dirty; //!< number of bytes actually in use
+#else
+    uint32_t count; //!< use counter (for smart deallocation)
+    uint32_t dirty; //!< number of bytes actually in use
+#endif
     uint8_t data[4]; //!< data
 };
 
@@ -56,13 +65,23 @@ struct ByteTagListData
  *
  * Internal use only.
  */
-static class ByteTagListDataFreeList : public std::vector<struct ByteTagListData*>
+class ByteTagListDataFreeList : public std::vector<struct ByteTagListData*>
 {
   public:
     ~ByteTagListDataFreeList();
-} g_freeList; //!< Container for struct ByteTagListData
+};
 
-static uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+#ifdef NS3_MTP
+// Each simulation thread keeps its own free list.
+static thread_local ByteTagListDataFreeList g_freeList; //!< Container for struct ByteTagListData
+static thread_local uint32_t g_maxSize = 0; //!< maximum data size (used for allocation)
+/** The free list was destroyed, at the exit of the thread. */
+static thread_local bool g_freeListDestroyed = false;
+#else
+static ByteTagListDataFreeList g_freeList; //!< Container for struct ByteTagListData
+static uint32_t g_maxSize = 0;             //!< maximum data size (used for allocation)
+static bool g_freeListDestroyed = false;   //!< The free list was destroyed, at exit.
+#endif
 
 ByteTagListDataFreeList::~ByteTagListDataFreeList()
 {
@@ -72,6 +91,8 @@ ByteTagListDataFreeList::~ByteTagListDataFreeList()
         uint8_t* buffer = (uint8_t*)(*i);
         delete[] buffer;
     }
+    // packets destroyed later, e.g. by static objects, must not use it
+    g_freeListDestroyed = true;
 }
 #endif /* USE_FREE_LIST */
 
@@ -169,6 +190,10 @@ ByteTagList::ByteTagList(const ByteTagList& o)
     {
         m_data->count++;
     }
+    else
+    {
+        std::memcpy(m_inline, o.m_inline, m_used);
+    }
 }
 
 ByteTagList&
@@ -189,6 +214,10 @@ ByteTagList::operator=(const ByteTagList& o)
     {
         m_data->count++;
     }
+    else
+    {
+        std::memcpy(m_inline, o.m_inline, m_used);
+    }
     return *this;
 }
 
@@ -208,17 +237,35 @@ ByteTagList::Add(TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
     NS_ASSERT(m_used <= spaceNeeded);
     if (m_data == nullptr)
     {
-        m_data = Allocate(spaceNeeded);
-        m_used = 0;
+        if (spaceNeeded > INLINE_SIZE)
+        {
+            // the tags do not fit in the list anymore
+            m_data = Allocate(spaceNeeded);
+            std::memcpy(&m_data->data, m_inline, m_used);
+        }
     }
-    else if (m_data->size < spaceNeeded || (m_data->count != 1 && m_data->dirty != m_used))
+    else
     {
-        struct ByteTagListData* newData = Allocate(spaceNeeded);
-        std::memcpy(&newData->data, &m_data->data, m_used);
-        Deallocate(m_data);
-        m_data = newData;
+#ifdef NS3_MTP
+        // Lists sharing the data may live in other threads: claim the bytes
+        // past m_used before writing into them.
+        uint32_t dirty = m_used;
+        bool isDirty = m_data->count != 1 &&
+                       (m_data->size < spaceNeeded ||
+                        !m_data->dirty.compare_exchange_strong(dirty, spaceNeeded));
+#else
+        bool isDirty = m_data->count != 1 && m_data->dirty != m_used;
+#endif
+        if (m_data->size < spaceNeeded || isDirty)
+        {
+            struct ByteTagListData* newData = Allocate(spaceNeeded);
+            std::memcpy(&newData->data, &m_data->data, m_used);
+            Deallocate(m_data);
+            m_data = newData;
+        }
     }
-    TagBuffer tag = TagBuffer(&m_data->data[m_used], &m_data->data[spaceNeeded]);
+    uint8_t* data = GetData();
+    TagBuffer tag = TagBuffer(&data[m_used], &data[spaceNeeded]);
     tag.WriteU32(tid.GetUid());
     tag.WriteU32(bufferSize);
     tag.WriteU32(start - m_adjustment);
@@ -232,7 +279,10 @@ ByteTagList::Add(TypeId tid, uint32_t bufferSize, int32_t start, int32_t end)
         m_maxEnd = end - m_adjustment;
     }
     m_used = spaceNeeded;
-    m_data->dirty = m_used;
+    if (m_data != nullptr)
+    {
+        m_data->dirty = m_used;
+    }
     return tag;
 }
 
@@ -261,6 +311,12 @@ ByteTagList::RemoveAll()
     m_used = 0;
 }
 
+uint8_t*
+ByteTagList::GetData() const
+{
+    return m_data != nullptr ? m_data->data : const_cast<uint8_t*>(m_inline);
+}
+
 ByteTagList::Iterator
 ByteTagList::BeginAll() const
 {
@@ -274,13 +330,13 @@ ByteTagList::Iterator
 ByteTagList::Begin(int32_t offsetStart, int32_t offsetEnd) const
 {
     NS_LOG_FUNCTION(this << offsetStart << offsetEnd);
-    if (m_data == nullptr)
+    if (m_used == 0)
     {
         return Iterator(nullptr, nullptr, offsetStart, offsetEnd, 0);
     }
     else
     {
-        return Iterator(m_data->data, &m_data->data[m_used], offsetStart, offsetEnd, m_adjustment);
+        return Iterator(GetData(), GetData() + m_used, offsetStart, offsetEnd, m_adjustment);
     }
 }
 
@@ -355,7 +411,7 @@ struct ByteTagListData*
 ByteTagList::Allocate(uint32_t size)
 {
     NS_LOG_FUNCTION(this << size);
-    while (!g_freeList.empty())
+    while (!g_freeListDestroyed && !g_freeList.empty())
     {
         struct ByteTagListData* data = g_freeList.back();
         g_freeList.pop_back();
@@ -386,10 +442,10 @@ ByteTagList::Deallocate(struct ByteTagListData* data)
         return;
     }
     g_maxSize = std::max(g_maxSize, data->size);
-    data->count--;
-    if (data->count == 0)
+    if (--data->count == 0)
     {
-        if (g_freeList.size() > FREE_LIST_SIZE || data->size < g_maxSize)
+        if (g_freeListDestroyed || g_freeList.size() > FREE_LIST_SIZE ||
+            data->size < g_maxSize)
         {
             uint8_t* buffer = (uint8_t*)data;
             delete[] buffer;
@@ -423,8 +479,7 @@ ByteTagList::Deallocate(struct ByteTagListData* data)
     {
         return;
     }
-    data->count--;
-    if (data->count == 0)
+    if (--data->count == 0)
     {
         uint8_t* buffer = (uint8_t*)data;
         delete[] buffer;
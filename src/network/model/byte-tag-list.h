@@ -51,6 +51,11 @@ struct ByteTagListData;
  *     is shared and, thus, reference-counted. This data structure is unshared
  *     as-needed to emulate COW semantics.
  *
+ *   - As long as the tags fit in INLINE_SIZE bytes, which is the case of
+ *     one to three small tags, the tag byte buffer is stored in the
+ *     ByteTagList itself and copied with it, and no ByteTagListData is
+ *     allocated.
+ *
  *   - Each tag tags a unique set of bytes identified by the pair of offsets
  *     (start,end). These offsets are relative to the start of the packet
  *     Whenever the origin of the offset changes, the Packet adjusts all
@@ -283,11 +288,22 @@ class ByteTagList
      */
     void Deallocate(struct ByteTagListData* data);
 
+    /**
+     * \brief Get the tag byte buffer
+     * \returns the bytes of the ByteTagListData, or the inline bytes
+     */
+    uint8_t* GetData() const;
+
+    /// Size of the tag byte buffer stored in the ByteTagList itself
+    static constexpr uint32_t INLINE_SIZE = 64;
+
     int32_t m_minStart;             //!< minimal start offset
     int32_t m_maxEnd;               //!< maximal end offset
     int32_t m_adjustment;           //!< adjustment to byte tag offsets
     uint32_t m_used;                //!< the number of used bytes in the buffer
     struct ByteTagListData* m_data; //!< the ByteTagListData structure
+    /// the tag byte buffer, while it fits and there is no ByteTagListData
+    uint8_t m_inline[INLINE_SIZE];
 };
 
 void
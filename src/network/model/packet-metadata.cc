@@ -26,7 +26,7 @@
 #include "ns3/fatal-error.h"
 #include "ns3/log.h"
 
-#include <list>
+#include <algorithm>
 #include <utility>
 
 namespace ns3
@@ -36,19 +36,46 @@ NS_LOG_COMPONENT_DEFINE("PacketMetadata");
 
 bool PacketMetadata::m_enable = false;
 bool PacketMetadata::m_enableChecking = false;
+#ifdef NS3_MTP
+std::atomic<bool> PacketMetadata::m_metadataSkipped = false;
+std::atomic<uint16_t> PacketMetadata::m_chunkUid = 0;
+std::atomic<uint32_t> PacketMetadata::m_nData = 0;
+thread_local PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+/** The free lists were destroyed, at the exit of the thread. */
+static thread_local bool g_freeListDestroyed = false;
+#else
 bool PacketMetadata::m_metadataSkipped = false;
-uint32_t PacketMetadata::m_maxSize = 0;
 uint16_t PacketMetadata::m_chunkUid = 0;
+uint32_t PacketMetadata::m_nData = 0;
 PacketMetadata::DataFreeList PacketMetadata::m_freeList;
+static bool g_freeListDestroyed = false; //!< The free lists were destroyed, at exit.
+#endif
 
 PacketMetadata::DataFreeList::~DataFreeList()
 {
     NS_LOG_FUNCTION(this);
-    for (iterator i = begin(); i != end(); i++)
+    Trim(0);
+    // packets destroyed later, e.g. by static objects, must not use them
+    g_freeListDestroyed = true;
+#ifndef NS3_MTP
+    // With multithreading this runs whenever a simulation thread exits,
+    // which must not disable the metadata of the remaining threads.
+    PacketMetadata::m_enable = false;
+#endif
+}
+
+void
+PacketMetadata::DataFreeList::Trim(std::size_t n)
+{
+    NS_LOG_FUNCTION(this << n);
+    for (auto& blocks : m_blocks)
     {
-        PacketMetadata::Deallocate(*i);
+        while (blocks.size() > n)
+        {
+            PacketMetadata::Deallocate(blocks.back());
+            blocks.pop_back();
+        }
     }
-    PacketMetadata::m_enable = false;
 }
 
 void
@@ -74,539 +101,155 @@ PacketMetadata::EnableChecking()
 }
 
 void
-PacketMetadata::ReserveCopy(uint32_t size)
+PacketMetadata::ReserveCopy(uint32_t start, uint32_t end)
 {
-    NS_LOG_FUNCTION(this << size);
-    struct PacketMetadata::Data* newData = PacketMetadata::Create(m_used + size);
-    memcpy(newData->m_data, m_data->m_data, m_used);
-    newData->m_dirtyEnd = m_used;
-    m_data->m_count--;
-    if (m_data->m_count == 0)
-    {
-        PacketMetadata::Recycle(m_data);
-    }
+    NS_LOG_FUNCTION(this << start << end);
+    // leave as many free records before and after the items, at least
+    // as many as needed, in a block twice as large as needed so that
+    // the blocks grow geometrically.
+    uint32_t n = GetNRecords();
+    struct PacketMetadata::Data* newData = PacketMetadata::Create(2 * (n + start + end));
+    uint32_t head = (newData->m_size - n) / 2;
+    NS_ASSERT(head >= start && newData->m_size - head - n >= end);
+    if (n > 0)
+    {
+        memcpy(&newData->m_records[head], &m_data->m_records[m_head], n * sizeof(Record));
+    }
+    newData->m_dirtyStart = head;
+    newData->m_dirtyEnd = head + n;
+    Unref(m_data);
     m_data = newData;
-    if (m_head != 0xffff)
-    {
-        uint8_t* start;
-        NS_ASSERT(m_tail != 0xffff);
-        // clear the next field of the tail
-        start = &m_data->m_data[m_tail];
-        Append16(0xffff, start);
-        // clear the prev field of the head
-        start = &m_data->m_data[m_head] + 2;
-        Append16(0xffff, start);
-    }
+    m_head = head;
+    m_tail = head + n;
 }
 
-void
-PacketMetadata::Reserve(uint32_t size)
-{
-    NS_LOG_FUNCTION(this << size);
-    NS_ASSERT(m_data != nullptr);
-    if (m_data->m_size >= m_used + size &&
-        (m_head == 0xffff || m_data->m_count == 1 || m_data->m_dirtyEnd == m_used))
-    {
-        /* enough room, not dirty. */
-    }
-    else
-    {
-        /* (enough room and dirty) or (not enough room) */
-        ReserveCopy(size);
-    }
-}
-
-bool
-PacketMetadata::IsSharedPointerOk(uint16_t pointer) const
-{
-    NS_LOG_FUNCTION(this << pointer);
-    bool ok = pointer == 0xffff || pointer <= m_data->m_size;
-    return ok;
-}
-
-bool
-PacketMetadata::IsPointerOk(uint16_t pointer) const
-{
-    NS_LOG_FUNCTION(this << pointer);
-    bool ok = pointer == 0xffff || pointer <= m_used;
-    return ok;
-}
-
-bool
-PacketMetadata::IsStateOk() const
+PacketMetadata::Record*
+PacketMetadata::PrependRecord()
 {
     NS_LOG_FUNCTION(this);
-    bool ok = m_used <= m_data->m_size;
-    ok &= IsPointerOk(m_head);
-    ok &= IsPointerOk(m_tail);
-    uint16_t current = m_head;
-    while (ok && current != 0xffff)
-    {
-        struct PacketMetadata::SmallItem item;
-        PacketMetadata::ExtraItem extraItem;
-        ReadItems(current, &item, &extraItem);
-        ok &= IsSharedPointerOk(item.next);
-        ok &= IsSharedPointerOk(item.prev);
-        if (current != m_head)
-        {
-            ok &= IsPointerOk(item.prev);
-        }
-        if (current != m_tail)
-        {
-            ok &= IsPointerOk(item.next);
-        }
-        if (current == m_tail)
-        {
-            break;
-        }
-        current = item.next;
-    }
-    return ok;
-}
-
-uint32_t
-PacketMetadata::GetUleb128Size(uint32_t value) const
-{
-    NS_LOG_FUNCTION(this << value);
-    if (value < 0x80)
-    {
-        return 1;
-    }
-    if (value < 0x4000)
-    {
-        return 2;
-    }
-    if (value < 0x200000)
-    {
-        return 3;
-    }
-    if (value < 0x10000000)
-    {
-        return 4;
-    }
-    return 5;
-}
-
-uint32_t
-PacketMetadata::ReadUleb128(const uint8_t** pBuffer) const
-{
-    NS_LOG_FUNCTION(this << &pBuffer);
-    const uint8_t* buffer = *pBuffer;
-    uint32_t result;
-    uint8_t byte;
-
-    byte = buffer[0];
-    result = (byte & (~0x80));
-    if (!(byte & 0x80))
-    {
-        *pBuffer = buffer + 1;
-        return result;
-    }
-    byte = buffer[1];
-    result |= (byte & (~0x80)) << 7;
-    if (!(byte & 0x80))
-    {
-        *pBuffer = buffer + 2;
-        return result;
-    }
-    byte = buffer[2];
-    result |= (byte & (~0x80)) << 14;
-    if (!(byte & 0x80))
-    {
-        *pBuffer = buffer + 3;
-        return result;
-    }
-    byte = buffer[3];
-    result |= (byte & (~0x80)) << 21;
-    if (!(byte & 0x80))
-    {
-        *pBuffer = buffer + 4;
-        return result;
-    }
-    byte = buffer[4];
-    result |= (byte & (~0x80)) << 28;
-    if (!(byte & 0x80))
-    {
-        *pBuffer = buffer + 5;
-        return result;
-    }
-    /* This means that the LEB128 number was not valid.
-     * ie: the last (5th) byte did not have the high-order bit zeroed.
-     */
-    NS_ASSERT(false);
-    return 0;
-}
-
-void
-PacketMetadata::Append16(uint16_t value, uint8_t* buffer)
-{
-    NS_LOG_FUNCTION(this << value << &buffer);
-    buffer[0] = value & 0xff;
-    value >>= 8;
-    buffer[1] = value;
-}
-
-void
-PacketMetadata::Append32(uint32_t value, uint8_t* buffer)
-{
-    NS_LOG_FUNCTION(this << value << &buffer);
-    buffer[0] = value & 0xff;
-    buffer[1] = (value >> 8) & 0xff;
-    buffer[2] = (value >> 16) & 0xff;
-    buffer[3] = (value >> 24) & 0xff;
-}
-
-void
-PacketMetadata::AppendValueExtra(uint32_t value, uint8_t* buffer)
-{
-    NS_LOG_FUNCTION(this << value << &buffer);
-    if (value < 0x200000)
-    {
-        uint8_t byte = value & (~0x80);
-        buffer[0] = 0x80 | byte;
-        value >>= 7;
-        byte = value & (~0x80);
-        buffer[1] = 0x80 | byte;
-        value >>= 7;
-        buffer[2] = value;
-        return;
-    }
-    if (value < 0x10000000)
-    {
-        uint8_t byte = value & (~0x80);
-        buffer[0] = 0x80 | byte;
-        value >>= 7;
-        byte = value & (~0x80);
-        buffer[1] = 0x80 | byte;
-        value >>= 7;
-        byte = value & (~0x80);
-        buffer[2] = 0x80 | byte;
-        value >>= 7;
-        buffer[3] = value;
-        return;
-    }
-    {
-        uint8_t byte = value & (~0x80);
-        buffer[0] = 0x80 | byte;
-        value >>= 7;
-        byte = value & (~0x80);
-        buffer[1] = 0x80 | byte;
-        value >>= 7;
-        byte = value & (~0x80);
-        buffer[2] = 0x80 | byte;
-        value >>= 7;
-        byte = value & (~0x80);
-        buffer[3] = 0x80 | byte;
-        value >>= 7;
-        buffer[4] = value;
-    }
-}
-
-void
-PacketMetadata::AppendValue(uint32_t value, uint8_t* buffer)
-{
-    NS_LOG_FUNCTION(this << value << &buffer);
-    if (value < 0x80)
-    {
-        buffer[0] = value;
-        return;
-    }
-    if (value < 0x4000)
-    {
-        uint8_t byte = value & (~0x80);
-        buffer[0] = 0x80 | byte;
-        value >>= 7;
-        buffer[1] = value;
-        return;
-    }
-    AppendValueExtra(value, buffer);
-}
-
-void
-PacketMetadata::UpdateTail(uint16_t written)
-{
-    NS_LOG_FUNCTION(this << written);
-    if (m_head == 0xffff)
-    {
-        NS_ASSERT(m_tail == 0xffff);
-        m_head = m_used;
-        m_tail = m_used;
-    }
-    else
+    if (m_data == nullptr || m_head == 0 || IsHeadDirty())
     {
-        NS_ASSERT(m_tail != 0xffff);
-        // overwrite the next field of the previous tail of the list.
-        uint8_t* previousTail = &m_data->m_data[m_tail];
-        Append16(m_used, previousTail);
-        // update the tail of the list to the new node.
-        m_tail = m_used;
+        ReserveCopy(1, 0);
     }
-    NS_ASSERT(m_tail != 0xffff);
-    NS_ASSERT(m_head != 0xffff);
-    NS_ASSERT(written >= 8);
-    m_used += written;
-    m_data->m_dirtyEnd = m_used;
+    m_head--;
+    m_data->m_dirtyStart = m_head;
+    return &m_data->m_records[m_head];
 }
 
-void
-PacketMetadata::UpdateHead(uint16_t written)
+PacketMetadata::Record*
+PacketMetadata::AppendRecords(uint32_t n)
 {
-    NS_LOG_FUNCTION(this << written);
-    if (m_head == 0xffff)
+    NS_LOG_FUNCTION(this << n);
+    if (m_data == nullptr || m_tail + n > m_data->m_size || IsTailDirty())
     {
-        NS_ASSERT(m_tail == 0xffff);
-        m_head = m_used;
-        m_tail = m_used;
+        ReserveCopy(0, n);
     }
-    else
-    {
-        NS_ASSERT(m_head != 0xffff);
-        // overwrite the prev field of the previous head of the list.
-        uint8_t* previousHead = &m_data->m_data[m_head + 2];
-        Append16(m_used, previousHead);
-        // update the head of list to the new node.
-        m_head = m_used;
-    }
-    NS_ASSERT(m_tail != 0xffff);
-    NS_ASSERT(m_head != 0xffff);
-    NS_ASSERT(written >= 8);
-    m_used += written;
-    m_data->m_dirtyEnd = m_used;
+    Record* records = &m_data->m_records[m_tail];
+    m_tail += n;
+    m_data->m_dirtyEnd = m_tail;
+    return records;
 }
 
-uint16_t
-PacketMetadata::AddSmall(const struct PacketMetadata::SmallItem* item)
+PacketMetadata::Record*
+PacketMetadata::GetWritableHead()
 {
-    NS_LOG_FUNCTION(this << item->next << item->prev << item->typeUid << item->size
-                         << item->chunkUid);
-    NS_ASSERT(m_data != nullptr);
-    NS_ASSERT(m_used != item->prev && m_used != item->next);
-    uint32_t typeUidSize = GetUleb128Size(item->typeUid);
-    uint32_t sizeSize = GetUleb128Size(item->size);
-    uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2;
-    if (m_used + n > m_data->m_size ||
-        (m_head != 0xffff && m_data->m_count != 1 && m_used != m_data->m_dirtyEnd))
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(GetNRecords() > 0);
+    if (m_data->m_count != 1)
     {
-        ReserveCopy(n);
+        ReserveCopy(0, 0);
     }
-    uint8_t* buffer = &m_data->m_data[m_used];
-    Append16(item->next, buffer);
-    buffer += 2;
-    Append16(item->prev, buffer);
-    buffer += 2;
-    AppendValue(item->typeUid, buffer);
-    buffer += typeUidSize;
-    AppendValue(item->size, buffer);
-    buffer += sizeSize;
-    Append16(item->chunkUid, buffer);
-    return n;
+    return &m_data->m_records[m_head];
 }
 
-uint16_t
-PacketMetadata::AddBig(uint32_t next,
-                       uint32_t prev,
-                       const PacketMetadata::SmallItem* item,
-                       const PacketMetadata::ExtraItem* extraItem)
+PacketMetadata::Record*
+PacketMetadata::GetWritableTail()
 {
-    NS_LOG_FUNCTION(this << next << prev << item->next << item->prev << item->typeUid << item->size
-                         << item->chunkUid << extraItem->fragmentStart << extraItem->fragmentEnd
-                         << extraItem->packetUid);
-    NS_ASSERT(m_data != nullptr);
-    uint32_t typeUid = ((item->typeUid & 0x1) == 0x1) ? item->typeUid : item->typeUid + 1;
-    NS_ASSERT(m_used != prev && m_used != next);
-
-    uint32_t typeUidSize = GetUleb128Size(typeUid);
-    uint32_t sizeSize = GetUleb128Size(item->size);
-    uint32_t fragStartSize = GetUleb128Size(extraItem->fragmentStart);
-    uint32_t fragEndSize = GetUleb128Size(extraItem->fragmentEnd);
-    uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
-
-    if (m_used + n > m_data->m_size ||
-        (m_head != 0xffff && m_data->m_count != 1 && m_used != m_data->m_dirtyEnd))
+    NS_LOG_FUNCTION(this);
+    NS_ASSERT(GetNRecords() > 0);
+    if (m_data->m_count != 1)
     {
-        ReserveCopy(n);
+        ReserveCopy(0, 0);
     }
-
-    uint8_t* buffer = &m_data->m_data[m_used];
-
-    Append16(next, buffer);
-    buffer += 2;
-    Append16(prev, buffer);
-    buffer += 2;
-    AppendValue(typeUid, buffer);
-    buffer += typeUidSize;
-    AppendValue(item->size, buffer);
-    buffer += sizeSize;
-    Append16(item->chunkUid, buffer);
-    buffer += 2;
-    AppendValue(extraItem->fragmentStart, buffer);
-    buffer += fragStartSize;
-    AppendValue(extraItem->fragmentEnd, buffer);
-    buffer += fragEndSize;
-    Append32(extraItem->packetUid, buffer);
-
-    return n;
+    return &m_data->m_records[m_tail - 1];
 }
 
-void
-PacketMetadata::ReplaceTail(PacketMetadata::SmallItem* item,
-                            PacketMetadata::ExtraItem* extraItem,
-                            uint32_t available)
+bool
+PacketMetadata::IsStateOk() const
 {
-    NS_LOG_FUNCTION(this << item->next << item->prev << item->typeUid << item->size
-                         << item->chunkUid << extraItem->fragmentStart << extraItem->fragmentEnd
-                         << extraItem->packetUid << available);
-
-    NS_ASSERT(m_data != nullptr);
-    /* If the tail we want to replace is located at the end of the data array,
-     * and if there is extra room at the end of this array, then,
-     * we can try to use that extra space to avoid falling in the slow
-     * path below.
-     */
-    if (m_tail + available == m_used && m_used == m_data->m_dirtyEnd)
-    {
-        available = m_data->m_size - m_tail;
-    }
-
-    uint32_t typeUid = ((item->typeUid & 0x1) == 0x1) ? item->typeUid : item->typeUid + 1;
-    uint32_t typeUidSize = GetUleb128Size(typeUid);
-    uint32_t sizeSize = GetUleb128Size(item->size);
-    uint32_t fragStartSize = GetUleb128Size(extraItem->fragmentStart);
-    uint32_t fragEndSize = GetUleb128Size(extraItem->fragmentEnd);
-    uint32_t n = 2 + 2 + typeUidSize + sizeSize + 2 + fragStartSize + fragEndSize + 4;
-
-    if (available >= n && m_data->m_count == 1)
+    NS_LOG_FUNCTION(this);
+    if (m_data == nullptr)
     {
-        uint8_t* buffer = &m_data->m_data[m_tail];
-        Append16(item->next, buffer);
-        buffer += 2;
-        Append16(item->prev, buffer);
-        buffer += 2;
-        AppendValue(typeUid, buffer);
-        buffer += typeUidSize;
-        AppendValue(item->size, buffer);
-        buffer += sizeSize;
-        Append16(item->chunkUid, buffer);
-        buffer += 2;
-        AppendValue(extraItem->fragmentStart, buffer);
-        buffer += fragStartSize;
-        AppendValue(extraItem->fragmentEnd, buffer);
-        buffer += fragEndSize;
-        Append32(extraItem->packetUid, buffer);
-        m_used = std::max(m_used, (uint16_t)(buffer - &m_data->m_data[0]));
-        m_data->m_dirtyEnd = m_used;
-        return;
+        return m_head == 0 && m_tail == 0;
     }
-
-    /* Below is the slow path which is hit if the new tail we want
-     * to append is bigger than the previous tail.
-     */
-
-    // create a copy of the packet without its tail.
-    PacketMetadata h(m_packetUid, 0);
-    uint16_t current = m_head;
-    while (current != 0xffff && current != m_tail)
+    bool ok = m_head <= m_tail && m_tail <= m_data->m_size;
+    for (uint32_t i = 0; ok && i < GetNRecords(); i++)
     {
-        struct PacketMetadata::SmallItem tmpItem;
-        PacketMetadata::ExtraItem tmpExtraItem;
-        ReadItems(current, &tmpItem, &tmpExtraItem);
-        uint16_t written = h.AddBig(0xffff, h.m_tail, &tmpItem, &tmpExtraItem);
-        h.UpdateTail(written);
-        current = tmpItem.next;
+        const Record& record = GetRecord(i);
+        ok &= record.fragmentStart <= record.fragmentEnd && record.fragmentEnd <= record.size;
     }
-    // append new tail.
-    uint16_t written = h.AddBig(0xffff, h.m_tail, item, extraItem);
-    h.UpdateTail(written);
-
-    *this = h;
+    return ok;
 }
 
 uint32_t
-PacketMetadata::ReadItems(uint16_t current,
-                          struct PacketMetadata::SmallItem* item,
-                          struct PacketMetadata::ExtraItem* extraItem) const
+PacketMetadata::GetSizeIndex(uint32_t n)
 {
-    NS_LOG_FUNCTION(this << current << item->chunkUid << item->prev << item->next << item->size
-                         << item->typeUid << extraItem->fragmentEnd << extraItem->fragmentStart
-                         << extraItem->packetUid);
-    NS_ASSERT(current <= m_data->m_size);
-    const uint8_t* buffer = &m_data->m_data[current];
-    item->next = buffer[0];
-    item->next |= (buffer[1]) << 8;
-    item->prev = buffer[2];
-    item->prev |= (buffer[3]) << 8;
-    buffer += 4;
-    item->typeUid = ReadUleb128(&buffer);
-    item->size = ReadUleb128(&buffer);
-    item->chunkUid = buffer[0];
-    item->chunkUid |= (buffer[1]) << 8;
-    buffer += 2;
-
-    bool isExtra = (item->typeUid & 0x1) == 0x1;
-    if (isExtra)
-    {
-        extraItem->fragmentStart = ReadUleb128(&buffer);
-        extraItem->fragmentEnd = ReadUleb128(&buffer);
-        extraItem->packetUid = buffer[0];
-        extraItem->packetUid |= buffer[1] << 8;
-        extraItem->packetUid |= buffer[2] << 16;
-        extraItem->packetUid |= buffer[3] << 24;
-        buffer += 4;
-    }
-    else
+    NS_LOG_FUNCTION(n);
+    uint32_t index = 0;
+    for (uint32_t size = MIN_DATA_SIZE; size < n && index < DATA_SIZES; size *= 2)
     {
-        extraItem->fragmentStart = 0;
-        extraItem->fragmentEnd = item->size;
-        extraItem->packetUid = m_packetUid;
+        index++;
     }
-    NS_ASSERT(buffer <= &m_data->m_data[m_data->m_size]);
-    return buffer - &m_data->m_data[current];
+    return index;
 }
 
 struct PacketMetadata::Data*
 PacketMetadata::Create(uint32_t size)
 {
     NS_LOG_FUNCTION(size);
-    NS_LOG_LOGIC("create size=" << size << ", max=" << m_maxSize);
-    if (size > m_maxSize)
+    uint32_t n = MIN_DATA_SIZE;
+    while (n < size)
     {
-        m_maxSize = size;
+        n *= 2;
     }
-    while (!m_freeList.empty())
+    m_nData++;
+    uint32_t index = GetSizeIndex(n);
+    if (!g_freeListDestroyed && index < DATA_SIZES && !m_freeList.m_blocks[index].empty())
     {
-        struct PacketMetadata::Data* data = m_freeList.back();
-        m_freeList.pop_back();
-        if (data->m_size >= size)
-        {
-            NS_LOG_LOGIC("create found size=" << data->m_size);
-            data->m_count = 1;
-            return data;
-        }
-        NS_LOG_LOGIC("create dealloc size=" << data->m_size);
-        PacketMetadata::Deallocate(data);
+        struct PacketMetadata::Data* data = m_freeList.m_blocks[index].back();
+        m_freeList.m_blocks[index].pop_back();
+        NS_LOG_LOGIC("create found size=" << data->m_size);
+        NS_ASSERT(data->m_size == n);
+        data->m_count = 1;
+        return data;
     }
-    NS_LOG_LOGIC("create alloc size=" << m_maxSize);
-    return PacketMetadata::Allocate(m_maxSize);
+    NS_LOG_LOGIC("create alloc size=" << n);
+    return PacketMetadata::Allocate(n);
 }
 
 void
 PacketMetadata::Recycle(struct PacketMetadata::Data* data)
 {
     NS_LOG_FUNCTION(data);
-    if (!m_enable)
-    {
-        PacketMetadata::Deallocate(data);
-        return;
-    }
-    NS_LOG_LOGIC("recycle size=" << data->m_size << ", list=" << m_freeList.size());
     NS_ASSERT(data->m_count == 0);
-    if (m_freeList.size() > 1000 || data->m_size < m_maxSize)
+    uint32_t index = GetSizeIndex(data->m_size);
+    if (!m_enable || g_freeListDestroyed || index == DATA_SIZES ||
+        m_freeList.m_blocks[index].size() > 1000)
     {
         PacketMetadata::Deallocate(data);
     }
     else
     {
-        m_freeList.push_back(data);
+        NS_LOG_LOGIC("recycle size=" << data->m_size
+                                     << ", list=" << m_freeList.m_blocks[index].size());
+        m_freeList.m_blocks[index].push_back(data);
+    }
+    if (--m_nData == 0 && !g_freeListDestroyed)
+    {
+        // no metadata is alive anymore, as at the end of a simulation:
+        // release the blocks kept for the packets of a busy simulation.
+        NS_LOG_LOGIC("recycle last block, trim the free lists");
+        m_freeList.Trim(MIN_FREE_BLOCKS);
     }
 }
 
@@ -614,16 +257,13 @@ struct PacketMetadata::Data*
 PacketMetadata::Allocate(uint32_t n)
 {
     NS_LOG_FUNCTION(n);
-    uint32_t size = sizeof(struct Data);
-    if (n <= PACKET_METADATA_DATA_M_DATA_SIZE)
-    {
-        n = PACKET_METADATA_DATA_M_DATA_SIZE;
-    }
-    size += n - PACKET_METADATA_DATA_M_DATA_SIZE;
+    NS_ASSERT(n >= 1);
+    uint32_t size = sizeof(struct Data) + (n - 1) * sizeof(Record);
     uint8_t* buf = new uint8_t[size];
     struct PacketMetadata::Data* data = (struct PacketMetadata::Data*)buf;
     data->m_size = n;
     data->m_count = 1;
+    data->m_dirtyStart = 0;
     data->m_dirtyEnd = 0;
     return data;
 }
@@ -651,7 +291,7 @@ PacketMetadata::AddHeader(const Header& header, uint32_t size)
 {
     NS_LOG_FUNCTION(this << &header << size);
     NS_ASSERT(IsStateOk());
-    uint32_t uid = header.GetInstanceTypeId().GetUid() << 1;
+    uint32_t uid = header.GetInstanceTypeId().GetUid();
     DoAddHeader(uid, size);
     NS_ASSERT(IsStateOk());
 }
@@ -666,21 +306,19 @@ PacketMetadata::DoAddHeader(uint32_t uid, uint32_t size)
         return;
     }
 
-    struct PacketMetadata::SmallItem item;
-    item.next = m_head;
-    item.prev = 0xffff;
-    item.typeUid = uid;
-    item.size = size;
-    item.chunkUid = m_chunkUid;
-    m_chunkUid++;
-    uint16_t written = AddSmall(&item);
-    UpdateHead(written);
+    Record* record = PrependRecord();
+    record->packetUid = m_packetUid;
+    record->size = size;
+    record->fragmentStart = 0;
+    record->fragmentEnd = size;
+    record->typeUid = uid;
+    record->chunkUid = m_chunkUid++;
 }
 
 void
 PacketMetadata::RemoveHeader(const Header& header, uint32_t size)
 {
-    uint32_t uid = header.GetInstanceTypeId().GetUid() << 1;
+    uint32_t uid = header.GetInstanceTypeId().GetUid();
     NS_LOG_FUNCTION(this << &header << size);
     NS_ASSERT(IsStateOk());
     if (!m_enable)
@@ -688,10 +326,7 @@ PacketMetadata::RemoveHeader(const Header& header, uint32_t size)
         m_metadataSkipped = true;
         return;
     }
-    struct PacketMetadata::SmallItem item;
-    struct PacketMetadata::ExtraItem extraItem;
-    uint32_t read = ReadItems(m_head, &item, &extraItem);
-    if ((item.typeUid & 0xfffffffe) != uid || item.size != size)
+    if (GetNRecords() == 0)
     {
         if (m_enableChecking)
         {
@@ -699,34 +334,31 @@ PacketMetadata::RemoveHeader(const Header& header, uint32_t size)
         }
         return;
     }
-    else if (item.typeUid != uid && (extraItem.fragmentStart != 0 || extraItem.fragmentEnd != size))
+    const Record& record = GetRecord(0);
+    if (record.typeUid != uid || record.size != size)
     {
         if (m_enableChecking)
         {
-            NS_FATAL_ERROR("Removing incomplete header.");
+            NS_FATAL_ERROR("Removing unexpected header.");
         }
         return;
     }
-    if (m_head + read == m_used)
-    {
-        m_used = m_head;
-    }
-    if (m_head == m_tail)
+    else if (record.fragmentStart != 0 || record.fragmentEnd != size)
     {
-        m_head = 0xffff;
-        m_tail = 0xffff;
-    }
-    else
-    {
-        m_head = item.next;
+        if (m_enableChecking)
+        {
+            NS_FATAL_ERROR("Removing incomplete header.");
+        }
+        return;
     }
+    m_head++;
     NS_ASSERT(IsStateOk());
 }
 
 void
 PacketMetadata::AddTrailer(const Trailer& trailer, uint32_t size)
 {
-    uint32_t uid = trailer.GetInstanceTypeId().GetUid() << 1;
+    uint32_t uid = trailer.GetInstanceTypeId().GetUid();
     NS_LOG_FUNCTION(this << &trailer << size);
     NS_ASSERT(IsStateOk());
     if (!m_enable)
@@ -734,22 +366,20 @@ PacketMetadata::AddTrailer(const Trailer& trailer, uint32_t size)
         m_metadataSkipped = true;
         return;
     }
-    struct PacketMetadata::SmallItem item;
-    item.next = 0xffff;
-    item.prev = m_tail;
-    item.typeUid = uid;
-    item.size = size;
-    item.chunkUid = m_chunkUid;
-    m_chunkUid++;
-    uint16_t written = AddSmall(&item);
-    UpdateTail(written);
+    Record* record = AppendRecords(1);
+    record->packetUid = m_packetUid;
+    record->size = size;
+    record->fragmentStart = 0;
+    record->fragmentEnd = size;
+    record->typeUid = uid;
+    record->chunkUid = m_chunkUid++;
     NS_ASSERT(IsStateOk());
 }
 
 void
 PacketMetadata::RemoveTrailer(const Trailer& trailer, uint32_t size)
 {
-    uint32_t uid = trailer.GetInstanceTypeId().GetUid() << 1;
+    uint32_t uid = trailer.GetInstanceTypeId().GetUid();
     NS_LOG_FUNCTION(this << &trailer << size);
     NS_ASSERT(IsStateOk());
     if (!m_enable)
@@ -757,10 +387,7 @@ PacketMetadata::RemoveTrailer(const Trailer& trailer, uint32_t size)
         m_metadataSkipped = true;
         return;
     }
-    struct PacketMetadata::SmallItem item;
-    struct PacketMetadata::ExtraItem extraItem;
-    uint32_t read = ReadItems(m_tail, &item, &extraItem);
-    if ((item.typeUid & 0xfffffffe) != uid || item.size != size)
+    if (GetNRecords() == 0)
     {
         if (m_enableChecking)
         {
@@ -768,27 +395,24 @@ PacketMetadata::RemoveTrailer(const Trailer& trailer, uint32_t size)
         }
         return;
     }
-    else if (item.typeUid != uid && (extraItem.fragmentStart != 0 || extraItem.fragmentEnd != size))
+    const Record& record = GetRecord(GetNRecords() - 1);
+    if (record.typeUid != uid || record.size != size)
     {
         if (m_enableChecking)
         {
-            NS_FATAL_ERROR("Removing incomplete trailer.");
+            NS_FATAL_ERROR("Removing unexpected trailer.");
         }
         return;
     }
-    if (m_tail + read == m_used)
+    else if (record.fragmentStart != 0 || record.fragmentEnd != size)
     {
-        m_used = m_tail;
-    }
-    if (m_head == m_tail)
-    {
-        m_head = 0xffff;
-        m_tail = 0xffff;
-    }
-    else
-    {
-        m_tail = item.prev;
+        if (m_enableChecking)
+        {
+            NS_FATAL_ERROR("Removing incomplete trailer.");
+        }
+        return;
     }
+    m_tail--;
     NS_ASSERT(IsStateOk());
 }
 
@@ -802,7 +426,7 @@ PacketMetadata::AddAtEnd(const PacketMetadata& o)
         m_metadataSkipped = true;
         return;
     }
-    if (m_tail == 0xffff)
+    if (GetNRecords() == 0)
     {
         // We have no items so 'AddAtEnd' is
         // equivalent to self-assignment.
@@ -810,61 +434,43 @@ PacketMetadata::AddAtEnd(const PacketMetadata& o)
         NS_ASSERT(IsStateOk());
         return;
     }
-    if (o.m_head == 0xffff)
+    if (o.GetNRecords() == 0)
     {
-        NS_ASSERT(o.m_tail == 0xffff);
         // we have nothing to append.
         return;
     }
-    NS_ASSERT(m_head != 0xffff && m_tail != 0xffff);
-
-    // We read the current tail because we are going to append
-    // after this item.
-    struct PacketMetadata::SmallItem tailItem;
-    PacketMetadata::ExtraItem tailExtraItem;
-    uint32_t tailSize = ReadItems(m_tail, &tailItem, &tailExtraItem);
-
-    uint16_t current;
-    struct PacketMetadata::SmallItem item;
-    PacketMetadata::ExtraItem extraItem;
-    o.ReadItems(o.m_head, &item, &extraItem);
-    if (extraItem.packetUid == tailExtraItem.packetUid && item.typeUid == tailItem.typeUid &&
-        item.chunkUid == tailItem.chunkUid && item.size == tailItem.size &&
-        extraItem.fragmentStart == tailExtraItem.fragmentEnd)
+    if (&o == this)
+    {
+        PacketMetadata copy = o;
+        AddAtEnd(copy);
+        return;
+    }
+
+    uint32_t first = 0;
+    const Record& tail = GetRecord(GetNRecords() - 1);
+    const Record& head = o.GetRecord(0);
+    if (head.packetUid == tail.packetUid && head.typeUid == tail.typeUid &&
+        head.chunkUid == tail.chunkUid && head.size == tail.size &&
+        head.fragmentStart == tail.fragmentEnd)
     {
         /* If the previous tail came from the same header as
          * the next item we want to append to our array, then,
-         * we merge them and attempt to reuse the previous tail's
-         * location.
+         * we merge them.
          */
-        tailExtraItem.fragmentEnd = extraItem.fragmentEnd;
-        ReplaceTail(&tailItem, &tailExtraItem, tailSize);
-        if (o.m_head == o.m_tail)
-        {
-            // there is only one item to append to self from other.
-            return;
-        }
-        current = item.next;
-    }
-    else
-    {
-        current = o.m_head;
+        uint32_t fragmentEnd = head.fragmentEnd;
+        GetWritableTail()->fragmentEnd = fragmentEnd;
+        first = 1;
     }
 
     /* Now that we have merged our current tail with the head of the
      * next packet, we just append all items from the next packet
      * to the current packet.
      */
-    while (current != 0xffff)
+    uint32_t n = o.GetNRecords() - first;
+    if (n > 0)
     {
-        o.ReadItems(current, &item, &extraItem);
-        uint16_t written = AddBig(0xffff, m_tail, &item, &extraItem);
-        UpdateTail(written);
-        if (current == o.m_tail)
-        {
-            break;
-        }
-        current = item.next;
+        Record* records = AppendRecords(n);
+        memcpy(records, &o.GetRecord(first), n * sizeof(Record));
     }
     NS_ASSERT(IsStateOk());
 }
@@ -890,53 +496,23 @@ PacketMetadata::RemoveAtStart(uint32_t start)
         m_metadataSkipped = true;
         return;
     }
-    NS_ASSERT(m_data != nullptr);
     uint32_t leftToRemove = start;
-    uint16_t current = m_head;
-    while (current != 0xffff && leftToRemove > 0)
+    while (GetNRecords() > 0 && leftToRemove > 0)
     {
-        struct PacketMetadata::SmallItem item;
-        PacketMetadata::ExtraItem extraItem;
-        ReadItems(current, &item, &extraItem);
-        uint32_t itemRealSize = extraItem.fragmentEnd - extraItem.fragmentStart;
-        if (itemRealSize <= leftToRemove)
+        const Record& record = GetRecord(0);
+        uint32_t recordRealSize = record.fragmentEnd - record.fragmentStart;
+        if (recordRealSize <= leftToRemove)
         {
             // remove from list.
-            if (m_head == m_tail)
-            {
-                m_head = 0xffff;
-                m_tail = 0xffff;
-            }
-            else
-            {
-                m_head = item.next;
-            }
-            leftToRemove -= itemRealSize;
+            m_head++;
+            leftToRemove -= recordRealSize;
         }
         else
         {
-            // fragment the list item.
-            PacketMetadata fragment(m_packetUid, 0);
-            extraItem.fragmentStart += leftToRemove;
+            // fragment the item.
+            GetWritableHead()->fragmentStart += leftToRemove;
             leftToRemove = 0;
-            uint16_t written = fragment.AddBig(0xffff, fragment.m_tail, &item, &extraItem);
-            fragment.UpdateTail(written);
-            while (current != 0xffff && current != m_tail)
-            {
-                current = item.next;
-                ReadItems(current, &item, &extraItem);
-                written = fragment.AddBig(0xffff, fragment.m_tail, &item, &extraItem);
-                fragment.UpdateTail(written);
-            }
-            *this = fragment;
         }
-        NS_ASSERT(item.size >= extraItem.fragmentEnd - extraItem.fragmentStart &&
-                  extraItem.fragmentStart <= extraItem.fragmentEnd);
-        if (current == m_tail)
-        {
-            break;
-        }
-        current = item.next;
     }
     NS_ASSERT(leftToRemove == 0);
     NS_ASSERT(IsStateOk());
@@ -952,55 +528,23 @@ PacketMetadata::RemoveAtEnd(uint32_t end)
         m_metadataSkipped = true;
         return;
     }
-    NS_ASSERT(m_data != nullptr);
-
     uint32_t leftToRemove = end;
-    uint16_t current = m_tail;
-    while (current != 0xffff && leftToRemove > 0)
+    while (GetNRecords() > 0 && leftToRemove > 0)
     {
-        struct PacketMetadata::SmallItem item;
-        PacketMetadata::ExtraItem extraItem;
-        ReadItems(current, &item, &extraItem);
-        uint32_t itemRealSize = extraItem.fragmentEnd - extraItem.fragmentStart;
-        if (itemRealSize <= leftToRemove)
+        const Record& record = GetRecord(GetNRecords() - 1);
+        uint32_t recordRealSize = record.fragmentEnd - record.fragmentStart;
+        if (recordRealSize <= leftToRemove)
         {
             // remove from list.
-            if (m_head == m_tail)
-            {
-                m_head = 0xffff;
-                m_tail = 0xffff;
-            }
-            else
-            {
-                m_tail = item.prev;
-            }
-            leftToRemove -= itemRealSize;
+            m_tail--;
+            leftToRemove -= recordRealSize;
         }
         else
         {
-            // fragment the list item.
-            PacketMetadata fragment(m_packetUid, 0);
-            NS_ASSERT(extraItem.fragmentEnd > leftToRemove);
-            extraItem.fragmentEnd -= leftToRemove;
+            // fragment the item.
+            GetWritableTail()->fragmentEnd -= leftToRemove;
             leftToRemove = 0;
-            uint16_t written = fragment.AddBig(fragment.m_head, 0xffff, &item, &extraItem);
-            fragment.UpdateHead(written);
-            while (current != 0xffff && current != m_head)
-            {
-                current = item.prev;
-                ReadItems(current, &item, &extraItem);
-                written = fragment.AddBig(fragment.m_head, 0xffff, &item, &extraItem);
-                fragment.UpdateHead(written);
-            }
-            *this = fragment;
-        }
-        NS_ASSERT(item.size >= extraItem.fragmentEnd - extraItem.fragmentStart &&
-                  extraItem.fragmentStart <= extraItem.fragmentEnd);
-        if (current == m_head)
-        {
-            break;
         }
-        current = item.prev;
     }
     NS_ASSERT(leftToRemove == 0);
     NS_ASSERT(IsStateOk());
@@ -1011,20 +555,10 @@ PacketMetadata::GetTotalSize() const
 {
     NS_LOG_FUNCTION(this);
     uint32_t totalSize = 0;
-    uint16_t current = m_head;
-    uint16_t tail = m_tail;
-    while (current != 0xffff)
+    for (uint32_t i = 0; i < GetNRecords(); i++)
     {
-        struct PacketMetadata::SmallItem item;
-        PacketMetadata::ExtraItem extraItem;
-        ReadItems(current, &item, &extraItem);
-        totalSize += extraItem.fragmentEnd - extraItem.fragmentStart;
-        if (current == tail)
-        {
-            break;
-        }
-        NS_ASSERT(current != item.next);
-        current = item.next;
+        const Record& record = GetRecord(i);
+        totalSize += record.fragmentEnd - record.fragmentStart;
     }
     return totalSize;
 }
@@ -1046,9 +580,8 @@ PacketMetadata::BeginItem(Buffer buffer) const
 PacketMetadata::ItemIterator::ItemIterator(const PacketMetadata* metadata, Buffer buffer)
     : m_metadata(metadata),
       m_buffer(buffer),
-      m_current(metadata->m_head),
-      m_offset(0),
-      m_hasReadTail(false)
+      m_current(0),
+      m_offset(0)
 {
     NS_LOG_FUNCTION(this << metadata << &buffer);
 }
@@ -1057,15 +590,7 @@ bool
 PacketMetadata::ItemIterator::HasNext() const
 {
     NS_LOG_FUNCTION(this);
-    if (m_current == 0xffff)
-    {
-        return false;
-    }
-    if (m_hasReadTail)
-    {
-        return false;
-    }
-    return true;
+    return m_current < m_metadata->GetNRecords();
 }
 
 PacketMetadata::Item
@@ -1073,20 +598,14 @@ PacketMetadata::ItemIterator::Next()
 {
     NS_LOG_FUNCTION(this);
     struct PacketMetadata::Item item;
-    struct PacketMetadata::SmallItem smallItem;
-    struct PacketMetadata::ExtraItem extraItem;
-    m_metadata->ReadItems(m_current, &smallItem, &extraItem);
-    if (m_current == m_metadata->m_tail)
-    {
-        m_hasReadTail = true;
-    }
-    m_current = smallItem.next;
-    uint32_t uid = (smallItem.typeUid & 0xfffffffe) >> 1;
+    const Record& record = m_metadata->GetRecord(m_current);
+    m_current++;
+    uint32_t uid = record.typeUid;
     item.tid.SetUid(uid);
-    item.currentTrimedFromStart = extraItem.fragmentStart;
-    item.currentTrimedFromEnd = extraItem.fragmentEnd - smallItem.size;
-    item.currentSize = extraItem.fragmentEnd - extraItem.fragmentStart;
-    if (extraItem.fragmentStart != 0 || extraItem.fragmentEnd != smallItem.size)
+    item.currentTrimedFromStart = record.fragmentStart;
+    item.currentTrimedFromEnd = record.fragmentEnd - record.size;
+    item.currentSize = record.fragmentEnd - record.fragmentStart;
+    if (record.fragmentStart != 0 || record.fragmentEnd != record.size)
     {
         item.isFragment = true;
     }
@@ -1115,14 +634,14 @@ PacketMetadata::ItemIterator::Next()
         if (!item.isFragment)
         {
             item.current = m_buffer.End();
-            item.current.Prev(m_buffer.GetSize() - (m_offset + smallItem.size));
+            item.current.Prev(m_buffer.GetSize() - (m_offset + record.size));
         }
     }
     else
     {
         NS_ASSERT(false);
     }
-    m_offset += extraItem.fragmentEnd - extraItem.fragmentStart;
+    m_offset += record.fragmentEnd - record.fragmentStart;
     return item;
 }
 
@@ -1143,30 +662,20 @@ PacketMetadata::GetSerializedSize() const
         return totalSize;
     }
 
-    struct PacketMetadata::SmallItem item;
-    struct PacketMetadata::ExtraItem extraItem;
-    uint32_t current = m_head;
-    while (current != 0xffff)
+    for (uint32_t i = 0; i < GetNRecords(); i++)
     {
-        ReadItems(current, &item, &extraItem);
-        uint32_t uid = (item.typeUid & 0xfffffffe) >> 1;
-        if (uid == 0)
+        const Record& record = GetRecord(i);
+        if (record.typeUid == 0)
         {
             totalSize += 4;
         }
         else
         {
             TypeId tid;
-            tid.SetUid(uid);
+            tid.SetUid(record.typeUid);
             totalSize += 4 + tid.GetName().size();
         }
         totalSize += 1 + 4 + 2 + 4 + 4 + 8;
-        if (current == m_tail)
-        {
-            break;
-        }
-        NS_ASSERT(current != item.next);
-        current = item.next;
     }
     return totalSize;
 }
@@ -1183,24 +692,20 @@ PacketMetadata::Serialize(uint8_t* buffer, uint32_t maxSize) const
         return 0;
     }
 
-    struct PacketMetadata::SmallItem item;
-    struct PacketMetadata::ExtraItem extraItem;
-    uint32_t current = m_head;
-    while (current != 0xffff)
+    for (uint32_t i = 0; i < GetNRecords(); i++)
     {
-        ReadItems(current, &item, &extraItem);
+        const Record& record = GetRecord(i);
         NS_LOG_LOGIC("bytesWritten=" << static_cast<uint32_t>(buffer - start)
-                                     << ", typeUid=" << item.typeUid << ", size=" << item.size
-                                     << ", chunkUid=" << item.chunkUid
-                                     << ", fragmentStart=" << extraItem.fragmentStart
-                                     << ", fragmentEnd=" << extraItem.fragmentEnd
-                                     << ", packetUid=" << extraItem.packetUid);
-
-        uint32_t uid = (item.typeUid & 0xfffffffe) >> 1;
-        if (uid != 0)
+                                     << ", typeUid=" << record.typeUid << ", size=" << record.size
+                                     << ", chunkUid=" << record.chunkUid
+                                     << ", fragmentStart=" << record.fragmentStart
+                                     << ", fragmentEnd=" << record.fragmentEnd
+                                     << ", packetUid=" << record.packetUid);
+
+        if (record.typeUid != 0)
         {
             TypeId tid;
-            tid.SetUid(uid);
+            tid.SetUid(record.typeUid);
             std::string uidString = tid.GetName();
             uint32_t uidStringSize = uidString.size();
             buffer = AddToRawU32(uidStringSize, start, buffer, maxSize);
@@ -1227,50 +732,44 @@ PacketMetadata::Serialize(uint8_t* buffer, uint32_t maxSize) const
             }
         }
 
-        uint8_t isBig = item.typeUid & 0x1;
+        // whether the record is a fragment, or comes from another packet
+        uint8_t isBig = record.fragmentStart != 0 || record.fragmentEnd != record.size ||
+                        record.packetUid != m_packetUid;
         buffer = AddToRawU8(isBig, start, buffer, maxSize);
         if (buffer == nullptr)
         {
             return 0;
         }
 
-        buffer = AddToRawU32(item.size, start, buffer, maxSize);
+        buffer = AddToRawU32(record.size, start, buffer, maxSize);
         if (buffer == nullptr)
         {
             return 0;
         }
 
-        buffer = AddToRawU16(item.chunkUid, start, buffer, maxSize);
+        buffer = AddToRawU16(record.chunkUid, start, buffer, maxSize);
         if (buffer == nullptr)
         {
             return 0;
         }
 
-        buffer = AddToRawU32(extraItem.fragmentStart, start, buffer, maxSize);
+        buffer = AddToRawU32(record.fragmentStart, start, buffer, maxSize);
         if (buffer == nullptr)
         {
             return 0;
         }
 
-        buffer = AddToRawU32(extraItem.fragmentEnd, start, buffer, maxSize);
+        buffer = AddToRawU32(record.fragmentEnd, start, buffer, maxSize);
         if (buffer == nullptr)
         {
             return 0;
         }
 
-        buffer = AddToRawU64(extraItem.packetUid, start, buffer, maxSize);
+        buffer = AddToRawU64(record.packetUid, start, buffer, maxSize);
         if (buffer == nullptr)
         {
             return 0;
         }
-
-        if (current == m_tail)
-        {
-            break;
-        }
-
-        NS_ASSERT(current != item.next);
-        current = item.next;
     }
 
     NS_ASSERT(static_cast<uint32_t>(buffer - start) == maxSize);
@@ -1287,18 +786,16 @@ PacketMetadata::Deserialize(const uint8_t* buffer, uint32_t size)
     buffer = ReadFromRawU64(m_packetUid, start, buffer, size);
     desSize -= 8;
 
-    struct PacketMetadata::SmallItem item = {0};
-    struct PacketMetadata::ExtraItem extraItem = {0};
+    Record record = {};
     while (desSize > 0)
     {
         uint32_t uidStringSize = 0;
         buffer = ReadFromRawU32(uidStringSize, start, buffer, size);
         desSize -= 4;
-        uint32_t uid;
         if (uidStringSize == 0)
         {
             // uid zero for payload.
-            uid = 0;
+            record.typeUid = 0;
         }
         else
         {
@@ -1311,28 +808,27 @@ PacketMetadata::Deserialize(const uint8_t* buffer, uint32_t size)
                 desSize--;
             }
             TypeId tid = TypeId::LookupByName(uidString);
-            uid = tid.GetUid();
+            record.typeUid = tid.GetUid();
         }
+        // the records hold all the fields, whether the item is big or not
         uint8_t isBig = 0;
         buffer = ReadFromRawU8(isBig, start, buffer, size);
         desSize--;
-        item.typeUid = (uid << 1) | isBig;
-        buffer = ReadFromRawU32(item.size, start, buffer, size);
+        buffer = ReadFromRawU32(record.size, start, buffer, size);
         desSize -= 4;
-        buffer = ReadFromRawU16(item.chunkUid, start, buffer, size);
+        buffer = ReadFromRawU16(record.chunkUid, start, buffer, size);
         desSize -= 2;
-        buffer = ReadFromRawU32(extraItem.fragmentStart, start, buffer, size);
+        buffer = ReadFromRawU32(record.fragmentStart, start, buffer, size);
         desSize -= 4;
-        buffer = ReadFromRawU32(extraItem.fragmentEnd, start, buffer, size);
+        buffer = ReadFromRawU32(record.fragmentEnd, start, buffer, size);
         desSize -= 4;
-        buffer = ReadFromRawU64(extraItem.packetUid, start, buffer, size);
+        buffer = ReadFromRawU64(record.packetUid, start, buffer, size);
         desSize -= 8;
-        NS_LOG_LOGIC("size=" << size << ", typeUid=" << item.typeUid << ", size=" << item.size
-                             << ", chunkUid=" << item.chunkUid << ", fragmentStart="
-                             << extraItem.fragmentStart << ", fragmentEnd=" << extraItem.fragmentEnd
-                             << ", packetUid=" << extraItem.packetUid);
-        uint32_t tmp = AddBig(0xffff, m_tail, &item, &extraItem);
-        UpdateTail(tmp);
+        NS_LOG_LOGIC("size=" << size << ", typeUid=" << record.typeUid << ", size=" << record.size
+                             << ", chunkUid=" << record.chunkUid << ", fragmentStart="
+                             << record.fragmentStart << ", fragmentEnd=" << record.fragmentEnd
+                             << ", packetUid=" << record.packetUid);
+        *AppendRecords(1) = record;
     }
     NS_ASSERT(desSize == 0);
     return (desSize != 0) ? 0 : 1;
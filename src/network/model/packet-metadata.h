@@ -29,6 +29,10 @@
 #include <stdint.h>
 #include <vector>
 
+#ifdef NS3_MTP
+#include <atomic>
+#endif
+
 namespace ns3
 {
 
@@ -46,14 +50,9 @@ class Trailer;
  * an implementation of the Packet::Print methods which uses
  * the metadata to analyse the content of the packet's buffer.
  *
- * To achieve this, this class maintains a linked list of so-called
+ * To achieve this, this class maintains a list of so-called
  * "items", each of which represents a header or a trailer, or
- * payload, or a fragment of any of these. Each item contains a "next"
- * and a "prev" field which point to the next and previous entries
- * in the linked list. The PacketMetadata class maintains a pair
- * of pointers to the head and the tail of the linked list.
- *
- * Each entry in the list also maintains:
+ * payload, or a fragment of any of these. Each item records:
  *   - its native size (the size it had when it was first added
  *     to the packet)
  *   - its type: identifies what kind of header, what kind of trailer,
@@ -62,20 +61,22 @@ class Trailer;
  *   - the start and end of the area represented by a fragment
  *     if it is one.
  *
- * This linked list is flattened in a byte buffer stored in
- * struct PacketMetadata::Data. Each entry of the linked list is
- * identified by an offset which identifies the first byte of the
- * entry from the start of the data buffer. The size of this data
- * buffer is 2^16-1 bytes maximum which somewhat limits the number
- * of entries which can be stored in this linked list but it is
- * quite unlikely to hit this limit in practice.
+ * The items are fixed-size records stored contiguously, from the
+ * first header to the last trailer, in a block of records which is
+ * shared by the copies of a packet and copied on write. The block
+ * keeps free records on both sides of the items, so that adding or
+ * removing a header or a trailer only writes or drops one record,
+ * without walking the other items. Like Buffer, the block records
+ * which records have been written by any of the packets sharing it,
+ * so that these packets can add items in place as long as they do
+ * not overwrite the items of another packet.
  *
- * Each item of the linked list is a variable-sized byte buffer
- * made of a number of fields. Some of these fields are stored
- * as fixed-size 32 bit integers, others as fixed-size 16 bit
- * integers, and some others as variable-size 32-bit integers.
- * The variable-size 32 bit integers are stored using the uleb128
- * encoding.
+ * The blocks have a capacity which is a power of two and are
+ * recycled through per-size free lists. These free lists are
+ * trimmed down to a few blocks when no packet metadata is alive
+ * anymore, such as after the destruction of a simulation, so that
+ * the blocks needed by a busy simulation are not kept for the next
+ * ones. No block is allocated while the metadata is disabled.
  */
 class PacketMetadata
 {
@@ -151,9 +152,8 @@ class PacketMetadata
       private:
         const PacketMetadata* m_metadata; //!< pointer to the metadata
         Buffer m_buffer;                  //!< buffer the metadata refers to
-        uint16_t m_current;               //!< current position
+        uint32_t m_current;               //!< index of the next item
         uint32_t m_offset;                //!< offset
-        bool m_hasReadTail;               //!< true if the metadata tail has been read
     };
 
     /**
@@ -410,107 +410,88 @@ class PacketMetadata
                                    uint32_t maxSize);
 
     /**
-     * the size of PacketMetadata::Data::m_data such that the total size
-     * of PacketMetadata::Data is 16 bytes
+     * \brief Record of an item: a header, a trailer or payload, or a
+     * fragment of one of them.
      */
-#define PACKET_METADATA_DATA_M_DATA_SIZE 8
-
-    /**
-     * Data structure
-     */
-    struct Data
+    struct Record
     {
-        /** number of references to this struct Data instance. */
-        uint32_t m_count;
-        /** size (in bytes) of m_data buffer below */
-        uint16_t m_size;
-        /** max of the m_used field over all objects which reference this struct Data instance */
-        uint16_t m_dirtyEnd;
-        /** variable-sized buffer of bytes */
-        uint8_t m_data[PACKET_METADATA_DATA_M_DATA_SIZE];
-    };
-
-    /* Note that since the next and prev fields are 16 bit integers
-       and since the value 0xffff is reserved to identify the
-       fact that the end or the start of the list is reached,
-       only a limited number of elements can be stored in
-       a m_data byte buffer.
-     */
-    /**
-     * \brief SmallItem structure
-     */
-    struct SmallItem
-    {
-        /** offset (in bytes) from start of m_data buffer
-            to next element in linked list. value is 0xffff
-            if next element does not exist.
-            stored as a fixed-size 16 bit integer.
-        */
-        uint16_t next;
-        /** offset (in bytes) from start of m_data buffer
-            to previous element in linked list. value is 0xffff
-            if previous element does not exist.
-            stored as a fixed-size 16 bit integer.
-         */
-        uint16_t prev;
-        /** the high 31 bits of this field identify the
-            type of the header or trailer represented by
-            this item: the value zero represents payload.
-            If the low bit of this uid is one, an ExtraItem
-            structure follows this SmallItem structure.
-            stored as a variable-size 32 bit integer.
+        /** the packetUid of the packet in which this header or trailer
+            was first added. It could be different from the m_packetUid
+            field if the user has aggregated multiple packets into one.
          */
-        uint32_t typeUid;
+        uint64_t packetUid;
         /** the size (in bytes) of the header or trailer represented
-            by this element.
-            stored as a variable-size 32 bit integer.
+            by this record.
          */
         uint32_t size;
+        /** offset (in bytes) from start of original header to
+            the start of the fragment still present.
+         */
+        uint32_t fragmentStart;
+        /** offset (in bytes) from start of original header to
+            the end of the fragment still present.
+         */
+        uint32_t fragmentEnd;
+        /** the uid of the TypeId of the header or trailer represented
+            by this record: the value zero represents payload.
+         */
+        uint16_t typeUid;
         /** this field tries to uniquely identify each header or
             trailer _instance_ while the typeUid field uniquely
             identifies each header or trailer _type_. This field
-            is used to test whether two items are equal in the sense
+            is used to test whether two records are equal in the sense
             that they represent the same header or trailer instance.
             That equality test is based on the typeUid and chunkUid
             fields so, the likelihood that two header instances
             share the same chunkUid _and_ typeUid is very small
             unless they are really representations of the same header
             instance.
-            stored as a fixed-size 16 bit integer.
          */
         uint16_t chunkUid;
     };
 
     /**
-     * \brief ExtraItem structure
+     * \brief Block of records, shared by the copies of a packet.
      */
-    struct ExtraItem
+    struct Data
     {
-        /** offset (in bytes) from start of original header to
-            the start of the fragment still present.
-            stored as a variable-size 32 bit integer.
-         */
-        uint32_t fragmentStart;
-        /** offset (in bytes) from start of original header to
-            the end of the fragment still present.
-            stored as a variable-size 32 bit integer.
-         */
-        uint32_t fragmentEnd;
-        /** the packetUid of the packet in which this header or trailer
-            was first added. It could be different from the m_packetUid
-            field if the user has aggregated multiple packets into one.
-            stored as a fixed-size 64 bit integer.
-         */
-        uint64_t packetUid;
+        /** number of references to this struct Data instance. */
+#ifdef NS3_MTP
+        std::atomic<uint32_t> m_count;
+#else
+        uint32_t m_count;
+#endif
+        /** number of records of the m_records array below */
+        uint32_t m_size;
+        /** min of the m_head field over all objects which reference this struct Data instance */
+        uint32_t m_dirtyStart;
+        /** max of the m_tail field over all objects which reference this struct Data instance */
+        uint32_t m_dirtyEnd;
+        /** variable-sized array of records */
+        Record m_records[1];
     };
 
+    /// Number of sizes of blocks which are recycled, from MIN_DATA_SIZE records
+    static constexpr uint32_t DATA_SIZES = 12;
+    /// Number of records of the smallest blocks
+    static constexpr uint32_t MIN_DATA_SIZE = 16;
+    /// Number of blocks of each size kept when no metadata is alive
+    static constexpr std::size_t MIN_FREE_BLOCKS = 16;
+
     /**
-     * \brief Class to hold all the metadata
+     * \brief Free lists of blocks, one per block size
      */
-    class DataFreeList : public std::vector<struct Data*>
+    class DataFreeList
     {
       public:
         ~DataFreeList();
+        /**
+         * \brief Deallocate the blocks of the free lists, but a few.
+         * \param n the number of blocks kept in each free list
+         */
+        void Trim(std::size_t n);
+        /// The free blocks, by size
+        std::vector<struct Data*> m_blocks[DATA_SIZES];
     };
 
     friend DataFreeList::~DataFreeList();
@@ -518,94 +499,44 @@ class PacketMetadata
     friend class ItemIterator;
 
     /**
-     * \brief Add a SmallItem
-     * \param item the SmallItem to add
-     * \return added size
+     * \brief Get the number of records of the items.
+     * \returns the number of items
      */
-    inline uint16_t AddSmall(const PacketMetadata::SmallItem* item);
+    inline uint32_t GetNRecords() const;
     /**
-     * \brief Add a "Big" Item (a SmallItem plus an ExtraItem)
-     * \param head the head
-     * \param tail the tail
-     * \param item the SmallItem to add
-     * \param extraItem the ExtraItem to add
-     * \return added size
+     * \brief Get the record of an item.
+     * \param i the index of the item, from the first header
+     * \returns the record
      */
-    uint16_t AddBig(uint32_t head,
-                    uint32_t tail,
-                    const PacketMetadata::SmallItem* item,
-                    const PacketMetadata::ExtraItem* extraItem);
+    inline const Record& GetRecord(uint32_t i) const;
     /**
-     * \brief Replace the tail
-     * \param item the item data to write
-     * \param extraItem the extra item data to write
-     * \param available the number of bytes which can
-     *        be written without having to rewrite the buffer entirely.
+     * \brief Add a record before the first item.
+     * \returns the record added, to fill
      */
-    void ReplaceTail(PacketMetadata::SmallItem* item,
-                     PacketMetadata::ExtraItem* extraItem,
-                     uint32_t available);
+    Record* PrependRecord();
     /**
-     * \brief Update the head
-     * \param written the used bytes
+     * \brief Add records after the last item.
+     * \param n the number of records to add
+     * \returns the first record added, to fill
      */
-    inline void UpdateHead(uint16_t written);
+    Record* AppendRecords(uint32_t n);
     /**
-     * \brief Update the tail
-     * \param written the used bytes
+     * \brief Get the record of the first item, to modify it.
+     * \returns the record
      */
-    inline void UpdateTail(uint16_t written);
-
+    Record* GetWritableHead();
     /**
-     * \brief Get the ULEB128 (Unsigned Little Endian Base 128) size
-     * \param value the value
-     * \returns the value's ULEB128 size
+     * \brief Get the record of the last item, to modify it.
+     * \returns the record
      */
-    inline uint32_t GetUleb128Size(uint32_t value) const;
+    Record* GetWritableTail();
     /**
-     * \brief Read a ULEB128 (Unsigned Little Endian Base 128) coded number
-     * \param pBuffer the buffer to read from
-     * \returns the value
+     * \brief Copy the items in a new block which has free records
+     * before and after them.
+     * \param start the number of free records needed before the items
+     * \param end the number of free records needed after the items
      */
-    uint32_t ReadUleb128(const uint8_t** pBuffer) const;
-    /**
-     * \brief Append a 16-bit value to the buffer
-     * \param value the value to add
-     * \param buffer the buffer to write to
-     */
-    inline void Append16(uint16_t value, uint8_t* buffer);
-    /**
-     * \brief Append a 32-bit value to the buffer
-     * \param value the value to add
-     * \param buffer the buffer to write to
-     */
-    inline void Append32(uint32_t value, uint8_t* buffer);
-    /**
-     * \brief Append a value to the buffer
-     * \param value the value to add
-     * \param buffer the buffer to write to
-     */
-    inline void AppendValue(uint32_t value, uint8_t* buffer);
-    /**
-     * \brief Append a value to the buffer - extra
-     *
-     * This function is called by AppendValue
-     *
-     * \param value the value to add
-     * \param buffer the buffer to write to
-     */
-    void AppendValueExtra(uint32_t value, uint8_t* buffer);
-
-    /**
-     * \brief Reserve space
-     * \param n space to reserve
-     */
-    inline void Reserve(uint32_t n);
-    /**
-     * \brief Reserve space and make a metadata copy
-     * \param n space to reserve
-     */
-    void ReserveCopy(uint32_t n);
+    void ReserveCopy(uint32_t start, uint32_t end);
 
     /**
      * \brief Get the total size used by the metadata
@@ -613,16 +544,6 @@ class PacketMetadata
      */
     uint32_t GetTotalSize() const;
 
-    /**
-     * \brief Read items
-     * \param current the offset we should start reading the data from
-     * \param item pointer to where we should store the data to return to the caller
-     * \param extraItem pointer to where we should store the data to return to the caller
-     * \returns the number of bytes read.
-     */
-    uint32_t ReadItems(uint16_t current,
-                       struct PacketMetadata::SmallItem* item,
-                       struct PacketMetadata::ExtraItem* extraItem) const;
     /**
      * \brief Add an header
      * \param uid header's uid to add
@@ -634,65 +555,86 @@ class PacketMetadata
      * \returns true if the internal state is ok
      */
     bool IsStateOk() const;
+
     /**
-     * \brief Check if the position is valid
-     * \param pointer the position to check
-     * \returns true if the position is valid
+     * \brief Check whether the records before the first item may be
+     * used by another PacketMetadata instance which shares the block
+     * \returns true if adding a record before the first item could
+     *          overwrite a record of another instance
      */
-    bool IsPointerOk(uint16_t pointer) const;
+    inline bool IsHeadDirty() const;
     /**
-     * \brief Check if the position is valid
-     * \param pointer the position to check
-     * \returns true if the position is valid
+     * \brief Check whether the records after the last item may be
+     * used by another PacketMetadata instance which shares the block
+     * \returns true if adding a record after the last item could
+     *          overwrite a record of another instance
      */
-    bool IsSharedPointerOk(uint16_t pointer) const;
+    inline bool IsTailDirty() const;
 
     /**
-     * \brief Recycle the buffer memory
-     * \param data the buffer data storage
+     * \brief Release a reference to a block
+     * \param data the block
+     */
+    static inline void Unref(struct PacketMetadata::Data* data);
+    /**
+     * \brief Recycle a block of records
+     * \param data the block
      */
     static void Recycle(struct PacketMetadata::Data* data);
     /**
-     * \brief Create a buffer data storage
-     * \param size the storage size to create
-     * \returns a pointer to the created buffer storage
+     * \brief Create a block of records
+     * \param size the minimum number of records
+     * \returns the block
      */
     static struct PacketMetadata::Data* Create(uint32_t size);
     /**
-     * \brief Allocate a buffer data storage
-     * \param n the storage size to create
-     * \returns a pointer to the allocated buffer storage
+     * \brief Allocate a block of records
+     * \param n the number of records
+     * \returns the block
      */
     static struct PacketMetadata::Data* Allocate(uint32_t n);
     /**
-     * \brief Deallocate the buffer memory
-     * \param data the buffer data storage
+     * \brief Deallocate a block of records
+     * \param data the block
      */
     static void Deallocate(struct PacketMetadata::Data* data);
+    /**
+     * \brief Get the free list of the blocks of a number of records
+     * \param n the number of records, a power of two
+     * \returns the free list index, or DATA_SIZES if the blocks are
+     *          not recycled
+     */
+    static uint32_t GetSizeIndex(uint32_t n);
 
+#ifdef NS3_MTP
+    // Each simulation thread keeps its own free list.
+    static thread_local DataFreeList m_freeList; //!< the metadata data storage
+#else
     static DataFreeList m_freeList; //!< the metadata data storage
-    static bool m_enable;           //!< Enable the packet metadata
-    static bool m_enableChecking;   //!< Enable the packet metadata checking
+#endif
+    static bool m_enable;         //!< Enable the packet metadata
+    static bool m_enableChecking; //!< Enable the packet metadata checking
 
     /**
      * Set to true when adding metadata to a packet is skipped because
      * m_enable is false; used to detect enabling of metadata in the
      * middle of a simulation, which isn't allowed.
      */
+#ifdef NS3_MTP
+    static std::atomic<bool> m_metadataSkipped;
+
+    static std::atomic<uint16_t> m_chunkUid; //!< Chunk Uid
+    static std::atomic<uint32_t> m_nData;    //!< Number of blocks in use
+#else
     static bool m_metadataSkipped;
 
-    static uint32_t m_maxSize;  //!< maximum metadata size
     static uint16_t m_chunkUid; //!< Chunk Uid
+    static uint32_t m_nData;    //!< Number of blocks in use
+#endif
 
-    struct Data* m_data; //!< Metadata storage
-    /*
-       head -(next)-> tail
-         ^             |
-          \---(prev)---|
-     */
-    uint16_t m_head;      //!< list head
-    uint16_t m_tail;      //!< list tail
-    uint16_t m_used;      //!< used portion
+    struct Data* m_data;  //!< Metadata storage, null if there has been no item
+    uint32_t m_head;      //!< index of the record of the first item
+    uint32_t m_tail;      //!< index after the record of the last item
     uint64_t m_packetUid; //!< packet Uid
 };
 
@@ -701,14 +643,55 @@ class PacketMetadata
 namespace ns3
 {
 
+uint32_t
+PacketMetadata::GetNRecords() const
+{
+    return m_tail - m_head;
+}
+
+const PacketMetadata::Record&
+PacketMetadata::GetRecord(uint32_t i) const
+{
+    NS_ASSERT(i < GetNRecords());
+    return m_data->m_records[m_head + i];
+}
+
+bool
+PacketMetadata::IsHeadDirty() const
+{
+#ifdef NS3_MTP
+    // Instances sharing the block may add records concurrently from other threads
+    return m_data->m_count != 1;
+#else
+    return m_data->m_count != 1 && m_head != m_data->m_dirtyStart;
+#endif
+}
+
+bool
+PacketMetadata::IsTailDirty() const
+{
+#ifdef NS3_MTP
+    return m_data->m_count != 1;
+#else
+    return m_data->m_count != 1 && m_tail != m_data->m_dirtyEnd;
+#endif
+}
+
+void
+PacketMetadata::Unref(struct PacketMetadata::Data* data)
+{
+    if (data != nullptr && --data->m_count == 0)
+    {
+        PacketMetadata::Recycle(data);
+    }
+}
+
 PacketMetadata::PacketMetadata(uint64_t uid, uint32_t size)
-    : m_data(PacketMetadata::Create(10)),
-      m_head(0xffff),
-      m_tail(0xffff),
-      m_used(0),
+    : m_data(nullptr),
+      m_head(0),
+      m_tail(0),
       m_packetUid(uid)
 {
-    memset(m_data->m_data, 0xff, 4);
     if (size > 0)
     {
         DoAddHeader(0, size);
@@ -719,12 +702,13 @@ PacketMetadata::PacketMetadata(const PacketMetadata& o)
     : m_data(o.m_data),
       m_head(o.m_head),
       m_tail(o.m_tail),
-      m_used(o.m_used),
       m_packetUid(o.m_packetUid)
 {
-    NS_ASSERT(m_data != nullptr);
-    NS_ASSERT(m_data->m_count < std::numeric_limits<uint32_t>::max());
-    m_data->m_count++;
+    if (m_data != nullptr)
+    {
+        NS_ASSERT(m_data->m_count < std::numeric_limits<uint32_t>::max());
+        m_data->m_count++;
+    }
 }
 
 PacketMetadata&
@@ -733,31 +717,22 @@ PacketMetadata::operator=(const PacketMetadata& o)
     if (m_data != o.m_data)
     {
         // not self assignment
-        NS_ASSERT(m_data != nullptr);
-        m_data->m_count--;
-        if (m_data->m_count == 0)
+        Unref(m_data);
+        m_data = o.m_data;
+        if (m_data != nullptr)
         {
-            PacketMetadata::Recycle(m_data);
+            m_data->m_count++;
         }
-        m_data = o.m_data;
-        NS_ASSERT(m_data != nullptr);
-        m_data->m_count++;
     }
     m_head = o.m_head;
     m_tail = o.m_tail;
-    m_used = o.m_used;
     m_packetUid = o.m_packetUid;
     return *this;
 }
 
 PacketMetadata::~PacketMetadata()
 {
-    NS_ASSERT(m_data != nullptr);
-    m_data->m_count--;
-    if (m_data->m_count == 0)
-    {
-        PacketMetadata::Recycle(m_data);
-    }
+    Unref(m_data);
 }
 
 } // namespace ns3
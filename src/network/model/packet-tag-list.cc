@@ -52,6 +52,27 @@ PacketTagList::CreateTagData(size_t dataSize)
     return tag;
 }
 
+uint32_t
+PacketTagList::FindInline(TypeId tid) const
+{
+    for (uint32_t i = 0; i < m_nInline; i++)
+    {
+        if (m_inline[i].tid == tid)
+        {
+            return i;
+        }
+    }
+    return INLINE_TAGS;
+}
+
+void
+PacketTagList::RemoveInline(uint32_t i)
+{
+    NS_ASSERT(i < m_nInline);
+    std::copy(m_inline + i + 1, m_inline + m_nInline, m_inline + i);
+    m_nInline--;
+}
+
 bool
 PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
 {
@@ -175,6 +196,13 @@ PacketTagList::COWTraverse(Tag& tag, PacketTagList::COWWriter Writer)
 bool
 PacketTagList::Remove(Tag& tag)
 {
+    uint32_t i = FindInline(tag.GetInstanceTypeId());
+    if (i < m_nInline)
+    {
+        tag.Deserialize(TagBuffer(m_inline[i].data, m_inline[i].data + m_inline[i].size));
+        RemoveInline(i);
+        return true;
+    }
     return COWTraverse(tag, &PacketTagList::RemoveWriter);
 }
 
@@ -215,6 +243,21 @@ PacketTagList::RemoveWriter(Tag& tag,
 bool
 PacketTagList::Replace(Tag& tag)
 {
+    uint32_t i = FindInline(tag.GetInstanceTypeId());
+    if (i < m_nInline)
+    {
+        uint32_t size = tag.GetSerializedSize();
+        if (size <= INLINE_TAG_SIZE)
+        {
+            m_inline[i].size = size;
+            tag.Serialize(TagBuffer(m_inline[i].data, m_inline[i].data + size));
+            return true;
+        }
+        // the new value does not fit anymore
+        RemoveInline(i);
+        Add(tag);
+        return true;
+    }
     bool found = COWTraverse(tag, &PacketTagList::ReplaceWriter);
     if (!found)
     {
@@ -263,12 +306,24 @@ PacketTagList::Add(const Tag& tag) const
 {
     NS_LOG_FUNCTION(this << tag.GetInstanceTypeId());
     // ensure this id was not yet added
+    NS_ASSERT_MSG(FindInline(tag.GetInstanceTypeId()) == INLINE_TAGS,
+                  "Error: cannot add the same kind of tag twice.");
     for (struct TagData* cur = m_next; cur != nullptr; cur = cur->next)
     {
         NS_ASSERT_MSG(cur->tid != tag.GetInstanceTypeId(),
                       "Error: cannot add the same kind of tag twice.");
     }
-    struct TagData* head = CreateTagData(tag.GetSerializedSize());
+    uint32_t size = tag.GetSerializedSize();
+    if (m_nInline < INLINE_TAGS && size <= INLINE_TAG_SIZE)
+    {
+        auto self = const_cast<PacketTagList*>(this);
+        struct InlineTag& inlineTag = self->m_inline[self->m_nInline++];
+        inlineTag.tid = tag.GetInstanceTypeId();
+        inlineTag.size = size;
+        tag.Serialize(TagBuffer(inlineTag.data, inlineTag.data + size));
+        return;
+    }
+    struct TagData* head = CreateTagData(size);
     head->count = 1;
     head->next = nullptr;
     head->tid = tag.GetInstanceTypeId();
@@ -283,6 +338,13 @@ PacketTagList::Peek(Tag& tag) const
 {
     NS_LOG_FUNCTION(this << tag.GetInstanceTypeId());
     TypeId tid = tag.GetInstanceTypeId();
+    uint32_t i = FindInline(tid);
+    if (i < m_nInline)
+    {
+        tag.Deserialize(TagBuffer(const_cast<uint8_t*>(m_inline[i].data),
+                                  const_cast<uint8_t*>(m_inline[i].data) + m_inline[i].size));
+        return true;
+    }
     for (struct TagData* cur = m_next; cur != nullptr; cur = cur->next)
     {
         if (cur->tid == tid)
@@ -311,12 +373,16 @@ PacketTagList::GetSerializedSize() const
 
     size = 4; // numberOfTags
 
+    // TypeId hash and tag size; ensure size is multiple of 4 bytes
+    uint32_t hashSize = (sizeof(TypeId::hash_t) + 3) & (~3);
+    for (uint32_t i = 0; i < m_nInline; i++)
+    {
+        size += 4 + hashSize + ((m_inline[i].size + 3) & (~3));
+    }
     for (struct TagData* cur = m_next; cur != nullptr; cur = cur->next)
     {
         size += 4; // TagData -> size
 
-        // TypeId hash; ensure size is multiple of 4 bytes
-        uint32_t hashSize = (sizeof(TypeId::hash_t) + 3) & (~3);
         size += hashSize;
 
         // TagData -> data; ensure size is multiple of 4 bytes
@@ -327,6 +393,55 @@ PacketTagList::GetSerializedSize() const
     return size;
 }
 
+bool
+PacketTagList::SerializeTag(TypeId tid,
+                            const uint8_t* data,
+                            uint32_t dataSize,
+                            uint32_t*& p,
+                            uint32_t& size,
+                            uint32_t maxSize)
+{
+    if (size + 4 <= maxSize)
+    {
+        *p++ = dataSize;
+        size += 4;
+    }
+    else
+    {
+        return false;
+    }
+
+    NS_LOG_INFO("Serializing tag id " << tid);
+
+    // ensure size is multiple of 4 bytes for 4 byte boundaries
+    uint32_t hashSize = (sizeof(TypeId::hash_t) + 3) & (~3);
+    if (size + hashSize <= maxSize)
+    {
+        TypeId::hash_t hash = tid.GetHash();
+        memcpy(p, &hash, sizeof(TypeId::hash_t));
+        p += hashSize / 4;
+        size += hashSize;
+    }
+    else
+    {
+        return false;
+    }
+
+    // ensure size is multiple of 4 bytes for 4 byte boundaries
+    uint32_t tagWordSize = (dataSize + 3) & (~3);
+    if (size + tagWordSize <= maxSize)
+    {
+        memcpy(p, data, dataSize);
+        size += tagWordSize;
+        p += tagWordSize / 4;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
 uint32_t
 PacketTagList::Serialize(uint32_t* buffer, uint32_t maxSize) const
 {
@@ -348,47 +463,20 @@ PacketTagList::Serialize(uint32_t* buffer, uint32_t maxSize) const
         return 0;
     }
 
-    for (struct TagData* cur = m_next; cur != nullptr; cur = cur->next)
+    for (uint32_t i = 0; i < m_nInline; i++)
     {
-        if (size + 4 <= maxSize)
-        {
-            *p++ = cur->size;
-            size += 4;
-        }
-        else
+        if (!SerializeTag(m_inline[i].tid, m_inline[i].data, m_inline[i].size, p, size, maxSize))
         {
             return 0;
         }
-
-        NS_LOG_INFO("Serializing tag id " << cur->tid);
-
-        // ensure size is multiple of 4 bytes for 4 byte boundaries
-        uint32_t hashSize = (sizeof(TypeId::hash_t) + 3) & (~3);
-        if (size + hashSize <= maxSize)
-        {
-            TypeId::hash_t tid = cur->tid.GetHash();
-            memcpy(p, &tid, sizeof(TypeId::hash_t));
-            p += hashSize / 4;
-            size += hashSize;
-        }
-        else
-        {
-            return 0;
-        }
-
-        // ensure size is multiple of 4 bytes for 4 byte boundaries
-        uint32_t tagWordSize = (cur->size + 3) & (~3);
-        if (size + tagWordSize <= maxSize)
-        {
-            memcpy(p, cur->data, cur->size);
-            size += tagWordSize;
-            p += tagWordSize / 4;
-        }
-        else
+        (*numberOfTags)++;
+    }
+    for (struct TagData* cur = m_next; cur != nullptr; cur = cur->next)
+    {
+        if (!SerializeTag(cur->tid, cur->data, cur->size, p, size, maxSize))
         {
             return 0;
         }
-
         (*numberOfTags)++;
     }
 
@@ -427,6 +515,19 @@ PacketTagList::Deserialize(const uint32_t* buffer, uint32_t size)
 
         NS_LOG_INFO("Deserializing tag of type " << tid);
 
+        NS_ASSERT(sizeCheck >= tagSize);
+        if (m_nInline < INLINE_TAGS && tagSize <= INLINE_TAG_SIZE)
+        {
+            struct InlineTag& inlineTag = m_inline[m_nInline++];
+            inlineTag.tid = tid;
+            inlineTag.size = tagSize;
+            memcpy(inlineTag.data, p, tagSize);
+            uint32_t tagWordSize = (tagSize + 3) & (~3);
+            p += tagWordSize / 4;
+            sizeCheck -= tagWordSize;
+            continue;
+        }
+
         struct TagData* newTag = CreateTagData(tagSize);
         newTag->count = 1;
         newTag->next = nullptr;
@@ -441,7 +542,7 @@ PacketTagList::Deserialize(const uint32_t* buffer, uint32_t size)
         sizeCheck -= tagWordSize;
 
         // Set link list pointers.
-        if (i == 0)
+        if (prevTag == nullptr)
         {
             m_next = newTag;
         }
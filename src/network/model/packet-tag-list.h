@@ -26,9 +26,14 @@
 
 #include "ns3/type-id.h"
 
+#include <algorithm>
 #include <ostream>
 #include <stdint.h>
 
+#ifdef NS3_MTP
+#include <atomic>
+#endif
+
 namespace ns3
 {
 
@@ -120,6 +125,16 @@ class Tag;
  *       The portion of the list between the first branch and the target is
  *       shared. This portion is copied before the #Remove or #Replace is
  *       performed.
+ *
+ * \par <b> Inline tags </b>
+ *
+ *   - Most packets carry only a few small tags.  The first
+ *     #INLINE_TAGS tags whose serialized size is at most
+ *     #INLINE_TAG_SIZE bytes are stored in the PacketTagList itself,
+ *     as InlineTag, rather than in TagData allocated on the heap.
+ *
+ *   - The inline tags are copied with the PacketTagList, and the other
+ *     tags follow them in the tree of TagData described above.
  */
 class PacketTagList
 {
@@ -142,12 +157,34 @@ class PacketTagList
     struct TagData
     {
         struct TagData* next; //!< Pointer to next in list
-        uint32_t count;       //!< Number of incoming links
+#ifdef NS3_MTP
+        std::atomic<uint32_t> count; //!< Number of incoming links
+#else
+        uint32_t count; //!< Number of incoming links
+#endif
         TypeId tid;           //!< Type of the tag serialized into #data
         uint32_t size;        //!< Size of the \c data buffer
         uint8_t data[1];      //!< Serialization buffer
     };
 
+    /// Maximum number of tags stored in the PacketTagList itself.
+    static constexpr uint32_t INLINE_TAGS = 3;
+    /// Maximum serialized size of the tags stored in the PacketTagList itself.
+    static constexpr uint32_t INLINE_TAG_SIZE = 21;
+
+    /**
+     * Small tag stored in the PacketTagList itself.
+     *
+     * \internal
+     * This has to be public for the same reason as TagData.
+     */
+    struct InlineTag
+    {
+        TypeId tid;                    //!< Type of the tag serialized into #data
+        uint8_t size;                  //!< Size of the serialized tag
+        uint8_t data[INLINE_TAG_SIZE]; //!< Serialization buffer
+    };
+
     /**
      * Create a new PacketTagList.
      */
@@ -158,7 +195,8 @@ class PacketTagList
      * \param [in] o The PacketTagList to copy.
      *
      * This makes a light-weight copy by #RemoveAll, then
-     * pointing to the same \ref TagData as \pname{o}.
+     * pointing to the same \ref TagData as \pname{o} and
+     * copying its inline tags.
      */
     inline PacketTagList(const PacketTagList& o);
     /**
@@ -168,7 +206,8 @@ class PacketTagList
      * \returns the copied object
      *
      * This makes a light-weight copy by #RemoveAll, then
-     * pointing to the same \ref TagData as \pname{o}.
+     * pointing to the same \ref TagData as \pname{o} and
+     * copying its inline tags.
      */
     inline PacketTagList& operator=(const PacketTagList& o);
     /**
@@ -215,9 +254,18 @@ class PacketTagList
      */
     inline void RemoveAll();
     /**
-     * \returns pointer to head of tag list
+     * \returns pointer to head of tag list, after the inline tags
      */
     const struct PacketTagList::TagData* Head() const;
+    /**
+     * \returns the number of tags stored in the PacketTagList itself
+     */
+    inline uint32_t GetNInlineTags() const;
+    /**
+     * \param [in] i The index of the tag, lower than GetNInlineTags()
+     * \returns a tag stored in the PacketTagList itself
+     */
+    inline const struct PacketTagList::InlineTag& GetInlineTag(uint32_t i) const;
     /**
      * Returns number of bytes required for packet serialization.
      *
@@ -253,6 +301,38 @@ class PacketTagList
      */
     static TagData* CreateTagData(size_t dataSize);
 
+    /**
+     * Serialize a tag into a byte buffer.
+     *
+     * \param [in] tid The type of the tag.
+     * \param [in] data The serialized tag.
+     * \param [in] dataSize The size of the serialized tag.
+     * \param [in,out] p The position in the byte buffer.
+     * \param [in,out] size The number of bytes already written.
+     * \param [in] maxSize The max size of the byte buffer.
+     * \returns false if the tag does not fit in the byte buffer.
+     */
+    static bool SerializeTag(TypeId tid,
+                             const uint8_t* data,
+                             uint32_t dataSize,
+                             uint32_t*& p,
+                             uint32_t& size,
+                             uint32_t maxSize);
+    /**
+     * Find a tag stored in the PacketTagList itself.
+     *
+     * \param [in] tid The type of the tag.
+     * \returns The index of the tag, or #INLINE_TAGS if not found.
+     */
+    uint32_t FindInline(TypeId tid) const;
+    /**
+     * Remove a tag stored in the PacketTagList itself, keeping
+     * the order of the others.
+     *
+     * \param [in] i The index of the tag.
+     */
+    void RemoveInline(uint32_t i);
+
     /**
      * Typedef of method function pointer for copy-on-write operations
      *
@@ -301,6 +381,14 @@ class PacketTagList
      */
     bool ReplaceWriter(Tag& tag, bool preMerge, struct TagData* cur, struct TagData** prevNext);
 
+    /**
+     * The tags stored in the PacketTagList itself.
+     */
+    struct InlineTag m_inline[INLINE_TAGS];
+    /**
+     * The number of tags in #m_inline
+     */
+    uint8_t m_nInline;
     /**
      * Pointer to first \ref TagData on the list
      */
@@ -317,13 +405,16 @@ namespace ns3
 {
 
 PacketTagList::PacketTagList()
-    : m_next()
+    : m_nInline(0),
+      m_next()
 {
 }
 
 PacketTagList::PacketTagList(const PacketTagList& o)
-    : m_next(o.m_next)
+    : m_nInline(o.m_nInline),
+      m_next(o.m_next)
 {
+    std::copy(o.m_inline, o.m_inline + m_nInline, m_inline);
     if (m_next != nullptr)
     {
         m_next->count++;
@@ -334,16 +425,21 @@ PacketTagList&
 PacketTagList::operator=(const PacketTagList& o)
 {
     // self assignment
-    if (m_next == o.m_next)
+    if (this == &o)
     {
         return *this;
     }
-    RemoveAll();
-    m_next = o.m_next;
-    if (m_next != nullptr)
+    if (m_next != o.m_next)
     {
-        m_next->count++;
+        RemoveAll();
+        m_next = o.m_next;
+        if (m_next != nullptr)
+        {
+            m_next->count++;
+        }
     }
+    m_nInline = o.m_nInline;
+    std::copy(o.m_inline, o.m_inline + m_nInline, m_inline);
     return *this;
 }
 
@@ -352,14 +448,26 @@ PacketTagList::~PacketTagList()
     RemoveAll();
 }
 
+uint32_t
+PacketTagList::GetNInlineTags() const
+{
+    return m_nInline;
+}
+
+const struct PacketTagList::InlineTag&
+PacketTagList::GetInlineTag(uint32_t i) const
+{
+    return m_inline[i];
+}
+
 void
 PacketTagList::RemoveAll()
 {
+    m_nInline = 0;
     struct TagData* prev = nullptr;
     for (struct TagData* cur = m_next; cur != nullptr; cur = cur->next)
     {
-        cur->count--;
-        if (cur->count > 0)
+        if (--cur->count > 0)
         {
             break;
         }
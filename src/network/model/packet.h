@@ -36,6 +36,10 @@
 
 #include <stdint.h>
 
+#ifdef NS3_MTP
+#include <atomic>
+#endif
+
 namespace ns3
 {
 
@@ -161,10 +165,14 @@ class PacketTagIterator
         friend class PacketTagIterator;
         /**
          * Constructor
-         * \param data the data to copy.
+         * \param tid the type of the tag.
+         * \param data the serialized tag.
+         * \param size the size of the serialized tag.
          */
-        Item(const struct PacketTagList::TagData* data);
-        const struct PacketTagList::TagData* m_data; //!< the tag data
+        Item(TypeId tid, const uint8_t* data, uint32_t size);
+        TypeId m_tid;          //!< the type of the tag
+        const uint8_t* m_data; //!< the tag data
+        uint32_t m_size;       //!< the size of the tag data
     };
 
     /**
@@ -181,11 +189,13 @@ class PacketTagIterator
     friend class Packet;
     /**
      * Constructor
-     * \param head head of the items
+     * \param list the tags
      */
-    PacketTagIterator(const struct PacketTagList::TagData* head);
+    PacketTagIterator(const PacketTagList& list);
+    const PacketTagList* m_list; //!< the tags
+    uint32_t m_inline;           //!< index of the next inline tag of the list
     const struct PacketTagList::TagData*
-        m_current; //!< actual position over the set of tags in a packet
+        m_current; //!< actual position over the set of tags in a packet, after the inline tags
 };
 
 /**
@@ -797,7 +807,11 @@ class Packet : public SimpleRefCount<Packet>
     /* Please see comments above about nix-vector */
     mutable Ptr<NixVector> m_nixVector; //!< the packet's Nix vector
 
+#ifdef NS3_MTP
+    static std::atomic<uint32_t> m_globalUid; //!< Global counter of packets Uid
+#else
     static uint32_t m_globalUid; //!< Global counter of packets Uid
+#endif
 };
 
 /**
@@ -396,6 +396,249 @@ BufferTest::DoRun()
     NS_TEST_ASSERT_MSG_EQ(val1, val2, "Bad ReadNtohU16()");
 }
 
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * Buffer unit tests with chained parts: adding bytes to buffers whose
+ * data is shared, fragmenting and aggregating them.
+ */
+class BufferChainTest : public TestCase
+{
+  public:
+    BufferChainTest();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Create a buffer of real bytes.
+     * \param size The number of bytes
+     * \param first The value of the first byte, incremented for the next ones
+     * \returns the buffer
+     */
+    Buffer CreateBuffer(uint32_t size, uint8_t first);
+
+    /**
+     * Checks the buffer content, read with an iterator and with CopyData.
+     * \param b The buffer to check
+     * \param expected The bytes that should be in the buffer
+     * \param msg The message printed in case of failure
+     */
+    void CheckBytes(const Buffer& b, const std::vector<uint8_t>& expected, std::string msg);
+
+    /**
+     * Get the bytes of a buffer.
+     * \param b The buffer
+     * \returns the bytes
+     */
+    std::vector<uint8_t> GetBytes(const Buffer& b);
+};
+
+BufferChainTest::BufferChainTest()
+    : TestCase("Buffer with chained parts")
+{
+}
+
+Buffer
+BufferChainTest::CreateBuffer(uint32_t size, uint8_t first)
+{
+    Buffer b;
+    b.AddAtStart(size);
+    Buffer::Iterator i = b.Begin();
+    for (uint32_t j = 0; j < size; j++)
+    {
+        i.WriteU8(first + j);
+    }
+    return b;
+}
+
+std::vector<uint8_t>
+BufferChainTest::GetBytes(const Buffer& b)
+{
+    std::vector<uint8_t> bytes(b.GetSize());
+    b.CopyData(bytes.data(), bytes.size());
+    return bytes;
+}
+
+void
+BufferChainTest::CheckBytes(const Buffer& b,
+                            const std::vector<uint8_t>& expected,
+                            std::string msg)
+{
+    NS_TEST_ASSERT_MSG_EQ(b.GetSize(), expected.size(), msg << ": bad size");
+    NS_TEST_ASSERT_MSG_EQ((GetBytes(b) == expected), true, msg << ": bad bytes copied");
+    Buffer::Iterator i = b.Begin();
+    NS_TEST_ASSERT_MSG_EQ(i.GetSize(), expected.size(), msg << ": bad iterator size");
+    bool same = true;
+    for (uint32_t j = 0; j < expected.size(); j++)
+    {
+        same = same && i.ReadU8() == expected[j];
+    }
+    NS_TEST_ASSERT_MSG_EQ(same, true, msg << ": bad bytes read");
+    NS_TEST_ASSERT_MSG_EQ(i.IsEnd(), true, msg << ": iterator not at end");
+    NS_TEST_ASSERT_MSG_EQ(i.GetDistanceFrom(b.Begin()), expected.size(), msg << ": bad distance");
+    Buffer copy = b;
+    const uint8_t* data = copy.PeekData();
+    NS_TEST_ASSERT_MSG_EQ((std::vector<uint8_t>(data, data + copy.GetSize()) == expected),
+                          true,
+                          msg << ": bad flattened bytes");
+}
+
+void
+BufferChainTest::DoRun()
+{
+    Buffer payload = CreateBuffer(1000, 0);
+    std::vector<uint8_t> bytes = GetBytes(payload);
+
+    // a header added to a shared fragment goes in front of the payload
+    Buffer fragment = payload.CreateFragment(100, 500);
+    Buffer other = payload.CreateFragment(100, 500);
+    fragment.AddAtStart(4);
+    fragment.Begin().WriteHtonU32(0xaabbccdd);
+    std::vector<uint8_t> expected = {0xaa, 0xbb, 0xcc, 0xdd};
+    expected.insert(expected.end(), bytes.begin() + 100, bytes.begin() + 600);
+    CheckBytes(fragment, expected, "Header on a fragment");
+    CheckBytes(other, std::vector<uint8_t>(bytes.begin() + 100, bytes.begin() + 600), "Fragment");
+    CheckBytes(payload, bytes, "Payload");
+
+    // more headers go in the head, a trailer in a new part
+    fragment.AddAtStart(2);
+    fragment.Begin().WriteU16(0x1122);
+    fragment.AddAtEnd(3);
+    Buffer::Iterator i = fragment.End();
+    i.Prev(3);
+    i.WriteU8(0xee, 3);
+    expected.insert(expected.begin(), {0x22, 0x11});
+    expected.insert(expected.end(), {0xee, 0xee, 0xee});
+    CheckBytes(fragment, expected, "Headers and trailer");
+
+    // values read and written across the parts
+    i = fragment.Begin();
+    i.Next(4);
+    NS_TEST_ASSERT_MSG_EQ(i.ReadNtohU32(), 0xccdd6465, "Bad value read across parts");
+    i.Prev(5);
+    NS_TEST_ASSERT_MSG_EQ(i.ReadU8(), 0xbb, "Bad value read after going back");
+    // a value written across two parts
+    Buffer joined = CreateBuffer(100, 0);
+    joined.AddAtEnd(CreateBuffer(100, 100));
+    i = joined.End();
+    i.Prev(102);
+    i.WriteHtonU32(0x01020304);
+    std::vector<uint8_t> joinedBytes = GetBytes(CreateBuffer(200, 0));
+    joinedBytes[98] = 0x01;
+    joinedBytes[99] = 0x02;
+    joinedBytes[100] = 0x03;
+    joinedBytes[101] = 0x04;
+    CheckBytes(joined, joinedBytes, "Value written across parts");
+    NS_TEST_ASSERT_MSG_EQ(i.GetRemainingSize(), 98, "Bad remaining size");
+
+    // aggregation
+    Buffer aggregate = CreateBuffer(200, 0x80);
+    std::vector<uint8_t> aggregateBytes = GetBytes(aggregate);
+    aggregate.AddAtEnd(fragment);
+    aggregate.AddAtEnd(payload);
+    aggregate.AddAtEnd(aggregate);
+    aggregateBytes.insert(aggregateBytes.end(), expected.begin(), expected.end());
+    aggregateBytes.insert(aggregateBytes.end(), bytes.begin(), bytes.end());
+    std::vector<uint8_t> firstHalf = aggregateBytes;
+    aggregateBytes.insert(aggregateBytes.end(), firstHalf.begin(), firstHalf.end());
+    CheckBytes(aggregate, aggregateBytes, "Aggregate");
+    CheckBytes(fragment, expected, "Aggregated fragment");
+
+    // an iterator outlives the copy it was taken from, whose parts are still shared
+    Buffer::Iterator fromCopy;
+    {
+        Buffer copy = aggregate;
+        fromCopy = copy.Begin();
+    }
+    fromCopy.Next(1300);
+    NS_TEST_ASSERT_MSG_EQ(fromCopy.ReadU8(), aggregateBytes[1300], "Bad byte of a destroyed copy");
+    NS_TEST_ASSERT_MSG_EQ(fromCopy.GetRemainingSize(),
+                          aggregateBytes.size() - 1301,
+                          "Bad remaining size of a destroyed copy");
+
+    // fragments and removals across parts
+    for (uint32_t start : {0, 150, 200, 206, 900, 1500})
+    {
+        for (uint32_t length : {0, 1, 10, 700, 1000})
+        {
+            Buffer f = aggregate.CreateFragment(start, length);
+            std::vector<uint8_t> fBytes(aggregateBytes.begin() + start,
+                                        aggregateBytes.begin() + start + length);
+            std::ostringstream oss;
+            oss << "Fragment " << start << " " << length;
+            CheckBytes(f, fBytes, oss.str());
+        }
+    }
+    Buffer b = aggregate;
+    b.RemoveAtStart(1300);
+    b.RemoveAtEnd(1300);
+    CheckBytes(b,
+               std::vector<uint8_t>(aggregateBytes.begin() + 1300, aggregateBytes.end() - 1300),
+               "Removed at start and end");
+    b.RemoveAtStart(b.GetSize() + 10);
+    NS_TEST_ASSERT_MSG_EQ(b.GetSize(), 0, "Buffer not emptied");
+
+    // a copy written with iterators, and the serialized buffer
+    b.AddAtStart(aggregate.GetSize());
+    b.Begin().Write(aggregate.Begin(), aggregate.End());
+    CheckBytes(b, aggregateBytes, "Iterator copy");
+    std::vector<uint32_t> serialized(aggregate.GetSerializedSize() / 4);
+    NS_TEST_ASSERT_MSG_EQ(
+        aggregate.Serialize(reinterpret_cast<uint8_t*>(serialized.data()), serialized.size() * 4),
+        1,
+        "Buffer not serialized");
+    NS_TEST_ASSERT_MSG_EQ(aggregate.Serialize(reinterpret_cast<uint8_t*>(serialized.data()),
+                                              serialized.size() * 4 - 4),
+                          0,
+                          "Buffer serialized in too small a buffer");
+    Buffer deserialized(0, false);
+    // the size given to Deserialize includes the length field written by Packet
+    deserialized.Deserialize(reinterpret_cast<uint8_t*>(serialized.data()),
+                             serialized.size() * 4 + 4);
+    CheckBytes(deserialized, aggregateBytes, "Deserialized");
+
+    // virtual zero bytes are chained too
+    Buffer zeroes(2000);
+    zeroes.AddAtStart(1);
+    zeroes.Begin().WriteU8(0x42);
+    Buffer zeroesCopy = zeroes;
+    zeroesCopy.RemoveAtStart(1);
+    zeroesCopy.AddAtStart(1);
+    zeroesCopy.Begin().WriteU8(0x43);
+    zeroesCopy.AddAtEnd(payload);
+    std::vector<uint8_t> zeroesBytes(2001, 0);
+    zeroesBytes[0] = 0x43;
+    zeroesBytes.insert(zeroesBytes.end(), bytes.begin(), bytes.end());
+    CheckBytes(zeroesCopy, zeroesBytes, "Zero area");
+    NS_TEST_ASSERT_MSG_EQ(zeroes.Begin().PeekU8(), 0x42, "Shared header modified");
+    // and are not written in memory when serialized
+    serialized.resize(zeroesCopy.GetSerializedSize() / 4);
+    NS_TEST_ASSERT_MSG_LT(serialized.size() * 4, 1100, "Zero area serialized");
+    zeroesCopy.Serialize(reinterpret_cast<uint8_t*>(serialized.data()), serialized.size() * 4);
+    Buffer deserializedZeroes(0, false);
+    deserializedZeroes.Deserialize(reinterpret_cast<uint8_t*>(serialized.data()),
+                                   serialized.size() * 4 + 4);
+    CheckBytes(deserializedZeroes, zeroesBytes, "Deserialized zero area");
+
+    // the zero areas of shared fragments are merged when aggregated
+    Buffer virtualPayload(3000);
+    Buffer merged = virtualPayload.CreateFragment(1000, 1000);
+    merged.AddAtEnd(virtualPayload.CreateFragment(2000, 1000));
+    NS_TEST_ASSERT_MSG_EQ(merged.GetSerializedSize(), 12, "Zero areas not merged");
+    Buffer first = virtualPayload.CreateFragment(0, 1000);
+    first.AddAtStart(8);
+    first.Begin().WriteU8(0x44, 8);
+    Buffer firstCopy = first;
+    first.AddAtEnd(merged);
+    merged = first;
+    NS_TEST_ASSERT_MSG_EQ(merged.GetSerializedSize(), 20, "Zero areas not merged");
+    std::vector<uint8_t> mergedBytes(3008, 0);
+    std::fill_n(mergedBytes.begin(), 8, 0x44);
+    CheckBytes(merged, mergedBytes, "Merged zero areas");
+}
+
 /**
  * \ingroup network-test
  * \ingroup tests
@@ -412,6 +655,7 @@ BufferTestSuite::BufferTestSuite()
     : TestSuite("buffer", UNIT)
 {
     AddTestCase(new BufferTest, TestCase::QUICK);
+    AddTestCase(new BufferChainTest, TestCase::QUICK);
 }
 
 static BufferTestSuite g_bufferTestSuite; //!< Static variable for test initialization
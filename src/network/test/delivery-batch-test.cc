@@ -0,0 +1,202 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/delivery-batch.h"
+#include "ns3/simulator.h"
+#include "ns3/test.h"
+
+#include <vector>
+
+using namespace ns3;
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that the deliveries of a DeliveryBatch run at the time, in
+ * the order and in the context of separate events.
+ */
+class DeliveryBatchTestCase : public TestCase
+{
+  public:
+    DeliveryBatchTestCase();
+
+  private:
+    void DoRun() override;
+
+    /// A delivery which ran.
+    struct Record
+    {
+        uint32_t id;      //!< The id of the delivery
+        uint32_t context; //!< The context it ran in
+        Time time;        //!< The time it ran at
+    };
+
+    /**
+     * Record a delivery, and schedule an event in its context.
+     *
+     * \param test The test.
+     * \param id The id of the delivery.
+     */
+    static void Deliver(DeliveryBatchTestCase* test, uint32_t id);
+    /**
+     * Record the context of an event scheduled by a delivery.
+     *
+     * \param test The test.
+     */
+    static void Scheduled(DeliveryBatchTestCase* test);
+
+    std::vector<Record> m_runs;        //!< The deliveries which ran
+    std::vector<uint32_t> m_scheduled; //!< The contexts of the events scheduled by them
+};
+
+DeliveryBatchTestCase::DeliveryBatchTestCase()
+    : TestCase("Check the deliveries of a DeliveryBatch")
+{
+}
+
+void
+DeliveryBatchTestCase::Deliver(DeliveryBatchTestCase* test, uint32_t id)
+{
+    test->m_runs.push_back({id, Simulator::GetContext(), Simulator::Now()});
+    Simulator::ScheduleNow(&DeliveryBatchTestCase::Scheduled, test);
+}
+
+void
+DeliveryBatchTestCase::Scheduled(DeliveryBatchTestCase* test)
+{
+    test->m_scheduled.push_back(Simulator::GetContext());
+}
+
+void
+DeliveryBatchTestCase::DoRun()
+{
+    DeliveryBatch<DeliveryBatchTestCase*, uint32_t> batch(&DeliveryBatchTestCase::Deliver);
+    // id, context and delay in ms of the deliveries
+    const std::vector<std::vector<uint32_t>> deliveries =
+        {{0, 10, 2}, {1, 11, 1}, {2, 12, 2}, {3, 13, 1}, {4, 14, 3}, {5, 15, 2}};
+    for (const auto& delivery : deliveries)
+    {
+        batch.Add(delivery[1], MilliSeconds(delivery[2]), this, delivery[0]);
+    }
+    batch.Schedule();
+    // The batch is empty once scheduled
+    batch.Schedule();
+    uint64_t events = Simulator::GetEventCount();
+    Simulator::Run();
+
+    // One event per distinct delay, plus the events scheduled by the deliveries
+    NS_TEST_EXPECT_MSG_EQ(Simulator::GetEventCount() - events, 3 + 6, "Wrong number of events");
+    const std::vector<uint32_t> order = {1, 3, 0, 2, 5, 4};
+    NS_TEST_ASSERT_MSG_EQ(m_runs.size(), order.size(), "Wrong number of deliveries");
+    NS_TEST_ASSERT_MSG_EQ(m_scheduled.size(), order.size(), "Wrong number of events scheduled");
+    for (std::size_t i = 0; i < order.size(); i++)
+    {
+        const auto& delivery = deliveries[order[i]];
+        NS_TEST_EXPECT_MSG_EQ(m_runs[i].id, delivery[0], "Wrong order of the deliveries");
+        NS_TEST_EXPECT_MSG_EQ(m_runs[i].context, delivery[1], "Wrong context");
+        NS_TEST_EXPECT_MSG_EQ(m_runs[i].time, MilliSeconds(delivery[2]), "Wrong time");
+        // The events scheduled by the deliveries run in their context, once
+        // the deliveries with the same delay have run.
+        NS_TEST_EXPECT_MSG_EQ(m_scheduled[i], delivery[1], "Wrong context of scheduled event");
+    }
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief Check that the deliveries of a DeliveryBatch following a delivery
+ * which stops the simulation only run once it resumes, as separate events.
+ */
+class DeliveryBatchStopTestCase : public TestCase
+{
+  public:
+    DeliveryBatchStopTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Record a delivery, and stop the simulation if it is the second one.
+     *
+     * \param test The test.
+     * \param id The id of the delivery.
+     */
+    static void Deliver(DeliveryBatchStopTestCase* test, uint32_t id);
+
+    std::vector<uint32_t> m_runs;     //!< The ids of the deliveries which ran
+    std::vector<uint32_t> m_contexts; //!< The contexts they ran in
+};
+
+DeliveryBatchStopTestCase::DeliveryBatchStopTestCase()
+    : TestCase("Check the deliveries of a DeliveryBatch which stops the simulation")
+{
+}
+
+void
+DeliveryBatchStopTestCase::Deliver(DeliveryBatchStopTestCase* test, uint32_t id)
+{
+    test->m_runs.push_back(id);
+    test->m_contexts.push_back(Simulator::GetContext());
+    if (id == 1)
+    {
+        Simulator::Stop();
+    }
+}
+
+void
+DeliveryBatchStopTestCase::DoRun()
+{
+    DeliveryBatch<DeliveryBatchStopTestCase*, uint32_t> batch(&DeliveryBatchStopTestCase::Deliver);
+    for (uint32_t id = 0; id < 3; id++)
+    {
+        batch.Add(10 + id, MilliSeconds(1), this, id);
+    }
+    batch.Schedule();
+
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_EQ(m_runs.size(), 2, "Deliveries run after the simulation stopped");
+    NS_TEST_EXPECT_MSG_EQ(m_runs[1], 1, "Wrong order of the deliveries");
+
+    Simulator::Run();
+    NS_TEST_ASSERT_MSG_EQ(m_runs.size(), 3, "Delivery not run once the simulation resumed");
+    NS_TEST_EXPECT_MSG_EQ(m_runs[2], 2, "Wrong order of the deliveries");
+    NS_TEST_EXPECT_MSG_EQ(m_contexts[2], 12, "Wrong context");
+    NS_TEST_EXPECT_MSG_EQ(Simulator::Now(), MilliSeconds(1), "Wrong time");
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup network-test
+ * \ingroup tests
+ *
+ * \brief DeliveryBatch TestSuite
+ */
+class DeliveryBatchTestSuite : public TestSuite
+{
+  public:
+    DeliveryBatchTestSuite();
+};
+
+DeliveryBatchTestSuite::DeliveryBatchTestSuite()
+    : TestSuite("delivery-batch", UNIT)
+{
+    AddTestCase(new DeliveryBatchTestCase(), TestCase::QUICK);
+    AddTestCase(new DeliveryBatchStopTestCase(), TestCase::QUICK);
+}
+
+static DeliveryBatchTestSuite g_deliveryBatchTestSuite; //!< Static variable for test initialization
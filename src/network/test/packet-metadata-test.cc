@@ -879,6 +879,36 @@ PacketMetadataTest::DoRun()
     NS_TEST_EXPECT_MSG_EQ(msg,
                           std::string("hello world"),
                           "Could not find original data in received packet");
+
+    // copies sharing their items add their own headers and trailers,
+    // and many items make the records grow at both ends
+    p = Create<Packet>(10);
+    ADD_HEADER(p, 4);
+    ADD_TRAILER(p, 2);
+    p1 = p->Copy();
+    p2 = p->Copy();
+    ADD_HEADER(p1, 8);
+    ADD_HEADER(p2, 1);
+    ADD_TRAILER(p1, 3);
+    CHECK_HISTORY(p, 3, 4, 10, 2);
+    CHECK_HISTORY(p1, 5, 8, 4, 10, 2, 3);
+    CHECK_HISTORY(p2, 4, 1, 4, 10, 2);
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        ADD_HEADER(p1, 5);
+        ADD_TRAILER(p1, 6);
+    }
+    NS_TEST_EXPECT_MSG_EQ(p1->GetSize(), 27 + 20 * 11, "Correct size");
+    for (uint32_t i = 0; i < 20; i++)
+    {
+        REM_HEADER(p1, 5);
+        REM_TRAILER(p1, 6);
+    }
+    CHECK_HISTORY(p1, 5, 8, 4, 10, 2, 3);
+    CHECK_HISTORY(p2, 4, 1, 4, 10, 2);
+    CHECK_HISTORY(p, 3, 4, 10, 2);
+    p1->AddAtEnd(p1->Copy());
+    CHECK_HISTORY(p1, 10, 8, 4, 10, 2, 3, 8, 4, 10, 2, 3);
 }
 
 /**
@@ -26,6 +26,7 @@
 #include <iostream>
 #include <limits> // std:numeric_limits
 #include <string>
+#include <vector>
 
 using namespace ns3;
 
@@ -956,6 +957,66 @@ PacketTest::DoRun()
         ALargeTestTag a;
         tmp->AddPacketTag(a);
     }
+
+    /* Test the byte tags stored in the list itself, then in a buffer. */
+    {
+        Ptr<Packet> tmp = Create<Packet>(100);
+        tmp->AddByteTag(ATestTag<2>());
+        Ptr<Packet> copy = tmp->Copy();
+        copy->AddByteTag(ATestTag<3>(), 0, 50);
+        CHECK(tmp, 1, E(2, 0, 100));
+        CHECK(copy, 2, E(2, 0, 100), E(3, 0, 50));
+        copy->AddByteTag(ATestTag<20>(), 50, 100);
+        CHECK(tmp, 1, E(2, 0, 100));
+        CHECK(copy, 3, E(2, 0, 100), E(3, 0, 50), E(20, 50, 100));
+        tmp = copy->Copy();
+        copy->AddByteTag(ATestTag<4>());
+        CHECK(tmp, 3, E(2, 0, 100), E(3, 0, 50), E(20, 50, 100));
+        CHECK(copy, 4, E(2, 0, 100), E(3, 0, 50), E(20, 50, 100), E(4, 0, 100));
+    }
+
+    /* Test the packet tags stored in the list itself, and the others. */
+    {
+        Ptr<Packet> tmp = Create<Packet>(100);
+        tmp->AddPacketTag(ATestTag<1>(1));
+        tmp->AddPacketTag(ALargeTestTag());
+        tmp->AddPacketTag(ATestTag<2>(2));
+        tmp->AddPacketTag(ATestTag<3>(3));
+        tmp->AddPacketTag(ATestTag<4>(4));
+        Ptr<Packet> copy = tmp->Copy();
+        ATestTag<2> t2(5);
+        copy->ReplacePacketTag(t2);
+        ATestTag<1> t1;
+        NS_TEST_EXPECT_MSG_EQ(copy->RemovePacketTag(t1), true, "Could not remove inline tag");
+        NS_TEST_EXPECT_MSG_EQ(t1.GetData(), 1, "Wrong inline tag removed");
+        NS_TEST_EXPECT_MSG_EQ(copy->PeekPacketTag(t1), false, "Inline tag not removed");
+        copy->AddPacketTag(ATestTag<5>(6));
+
+        uint32_t n = 0;
+        PacketTagIterator i = tmp->GetPacketTagIterator();
+        while (i.HasNext())
+        {
+            i.Next();
+            n++;
+        }
+        NS_TEST_EXPECT_MSG_EQ(n, 5, "Wrong number of packet tags");
+        NS_TEST_EXPECT_MSG_EQ(tmp->PeekPacketTag(t2), true, "Missing inline tag");
+        NS_TEST_EXPECT_MSG_EQ(t2.GetData(), 2, "Inline tag of the original changed");
+
+        uint32_t size = copy->GetSerializedSize();
+        std::vector<uint8_t> buffer(size);
+        copy->Serialize(buffer.data(), size);
+        Ptr<Packet> deserialized = Create<Packet>(buffer.data(), size, true);
+        ATestTag<4> t4;
+        ATestTag<5> t5;
+        NS_TEST_EXPECT_MSG_EQ(deserialized->PeekPacketTag(t2), true, "Missing inline tag");
+        NS_TEST_EXPECT_MSG_EQ(t2.GetData(), 5, "Inline tag not replaced");
+        NS_TEST_EXPECT_MSG_EQ(deserialized->PeekPacketTag(t4), true, "Missing tag");
+        NS_TEST_EXPECT_MSG_EQ(t4.GetData(), 4, "Wrong tag");
+        NS_TEST_EXPECT_MSG_EQ(deserialized->PeekPacketTag(t5), true, "Missing added tag");
+        NS_TEST_EXPECT_MSG_EQ(t5.GetData(), 6, "Wrong added tag");
+        NS_TEST_EXPECT_MSG_EQ(deserialized->PeekPacketTag(t1), false, "Removed tag present");
+    }
 }
 
 /**
@@ -0,0 +1,220 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#ifndef DELIVERY_BATCH_H
+#define DELIVERY_BATCH_H
+
+#include "ns3/make-event.h"
+#include "ns3/nstime.h"
+#include "ns3/simulator.h"
+
+#include <algorithm>
+#include <memory>
+#include <tuple>
+#include <vector>
+
+namespace ns3
+{
+
+/**
+ * \ingroup network
+ * \brief The deliveries of a transmission to the receivers of a channel,
+ * scheduled with a single event per distinct delay.
+ *
+ * A channel which delivers a transmission to several receivers adds the
+ * delivery to each receiver to a batch, with the context of the receiver,
+ * the delay of the delivery and the arguments of the function which
+ * delivers it, then schedules the batch. The deliveries which have the
+ * same delay are run by a single event, in the order in which they were
+ * added and each in the context of its receiver, which is the order in
+ * which separate events scheduled with Simulator::ScheduleWithContext()
+ * would have run. The event queue hence holds one event per distinct
+ * delay rather than one per receiver. As the simulator checks whether it
+ * is stopped between its events, an event checks it between its
+ * deliveries: once a delivery stops the simulation, the next ones are
+ * scheduled again, and only run if the simulation resumes.
+ *
+ * The deliveries to the receivers whose context is not local, whose
+ * events run on another thread with the multithreaded simulator, are
+ * scheduled as separate events when they are added.
+ *
+ * \tparam Args \deduced The types of the arguments of the delivery function.
+ */
+template <typename... Args>
+class DeliveryBatch
+{
+  public:
+    /** The function delivering a transmission to a receiver. */
+    typedef void (*Function)(Args...);
+
+    /**
+     * Create an empty batch.
+     *
+     * \param [in] function The function delivering a transmission to a receiver.
+     */
+    explicit DeliveryBatch(Function function);
+
+    /**
+     * Add a delivery to the batch.
+     *
+     * \param [in] context The context of the receiver.
+     * \param [in] delay The delay of the delivery.
+     * \param [in] args The arguments of the delivery function.
+     */
+    void Add(uint32_t context, const Time& delay, Args... args);
+
+    /**
+     * Schedule the deliveries added to the batch, and empty it.
+     */
+    void Schedule();
+
+  private:
+    /** A delivery to a receiver. */
+    struct Delivery
+    {
+        uint32_t context;         //!< The context of the receiver
+        Time delay;               //!< The delay of the delivery
+        std::tuple<Args...> args; //!< The arguments of the delivery function
+    };
+
+    /** The deliveries of a batch, shared by the events which run them. */
+    typedef std::vector<Delivery> Deliveries;
+
+    /**
+     * Run a delivery in the context of its receiver.
+     *
+     * \param [in] function The delivery function.
+     * \param [in,out] delivery The delivery, whose arguments are moved.
+     */
+    static void Run(Function function, Delivery& delivery);
+
+    /**
+     * Run the deliveries of a range, until the simulation is finished.
+     *
+     * \param [in] function The delivery function.
+     * \param [in,out] deliveries The deliveries of the batch.
+     * \param [in] begin The index of the first delivery of the range.
+     * \param [in] end The index following the last delivery of the range.
+     */
+    static void RunRange(Function function,
+                         std::shared_ptr<Deliveries> deliveries,
+                         std::size_t begin,
+                         std::size_t end);
+
+    Function m_function;     //!< The delivery function
+    Deliveries m_deliveries; //!< The deliveries added to the batch
+};
+
+/*************************************************************************
+ *  Implementation of the templates declared above.
+ *************************************************************************/
+
+template <typename... Args>
+DeliveryBatch<Args...>::DeliveryBatch(Function function)
+    : m_function(function)
+{
+}
+
+template <typename... Args>
+void
+DeliveryBatch<Args...>::Add(uint32_t context, const Time& delay, Args... args)
+{
+    if (!Simulator::IsLocalContext(context))
+    {
+        Simulator::ScheduleWithContext(context, delay, m_function, args...);
+        return;
+    }
+    m_deliveries.push_back({context, delay, std::tuple<Args...>(std::move(args)...)});
+}
+
+template <typename... Args>
+void
+DeliveryBatch<Args...>::Schedule()
+{
+    if (m_deliveries.empty())
+    {
+        return;
+    }
+    Function function = m_function;
+    if (m_deliveries.size() == 1)
+    {
+        Delivery& delivery = m_deliveries.front();
+        Simulator::ScheduleWithContext(delivery.context,
+                                       delivery.delay,
+                                       MakeEvent([function, delivery]() mutable {
+                                           Run(function, delivery);
+                                       }));
+        m_deliveries.clear();
+        return;
+    }
+    // The deliveries with the same delay keep the order in which they were added
+    auto byDelay = [](const Delivery& a, const Delivery& b) { return a.delay < b.delay; };
+    if (!std::is_sorted(m_deliveries.begin(), m_deliveries.end(), byDelay))
+    {
+        std::stable_sort(m_deliveries.begin(), m_deliveries.end(), byDelay);
+    }
+    auto deliveries = std::make_shared<Deliveries>();
+    deliveries->swap(m_deliveries);
+    std::size_t n = deliveries->size();
+    for (std::size_t begin = 0; begin < n;)
+    {
+        std::size_t end = begin + 1;
+        while (end < n && (*deliveries)[end].delay == (*deliveries)[begin].delay)
+        {
+            end++;
+        }
+        Simulator::ScheduleWithContext((*deliveries)[begin].context,
+                                       (*deliveries)[begin].delay,
+                                       MakeEvent([function, deliveries, begin, end]() {
+                                           RunRange(function, deliveries, begin, end);
+                                       }));
+        begin = end;
+    }
+}
+
+template <typename... Args>
+void
+DeliveryBatch<Args...>::Run(Function function, Delivery& delivery)
+{
+    Simulator::SetContext(delivery.context);
+    std::apply(function, std::move(delivery.args));
+}
+
+template <typename... Args>
+void
+DeliveryBatch<Args...>::RunRange(Function function,
+                                 std::shared_ptr<Deliveries> deliveries,
+                                 std::size_t begin,
+                                 std::size_t end)
+{
+    for (std::size_t i = begin; i < end; i++)
+    {
+        if (i > begin && Simulator::IsFinished())
+        {
+            // The simulator would not run the event of the next delivery either
+            Simulator::ScheduleWithContext((*deliveries)[i].context,
+                                           Time(0),
+                                           MakeEvent([function, deliveries, i, end]() {
+                                               RunRange(function, deliveries, i, end);
+                                           }));
+            return;
+        }
+        Run(function, (*deliveries)[i]);
+    }
+}
+
+} // namespace ns3
+
+#endif /* DELIVERY_BATCH_H */
@@ -18,6 +18,7 @@
  */
 #include "simple-channel.h"
 
+#include "delivery-batch.h"
 #include "simple-net-device.h"
 
 #include "ns3/log.h"
@@ -62,6 +63,8 @@ SimpleChannel::Send(Ptr<Packet> p,
                     Ptr<SimpleNetDevice> sender)
 {
     NS_LOG_FUNCTION(this << p << protocol << to << from << sender);
+    DeliveryBatch<Ptr<SimpleNetDevice>, Ptr<Packet>, uint16_t, Mac48Address, Mac48Address> batch(
+        &SimpleChannel::Deliver);
     for (std::vector<Ptr<SimpleNetDevice>>::const_iterator i = m_devices.begin();
          i != m_devices.end();
          ++i)
@@ -79,15 +82,19 @@ SimpleChannel::Send(Ptr<Packet> p,
                 continue;
             }
         }
-        Simulator::ScheduleWithContext(tmp->GetNode()->GetId(),
-                                       m_delay,
-                                       &SimpleNetDevice::Receive,
-                                       tmp,
-                                       p->Copy(),
-                                       protocol,
-                                       to,
-                                       from);
+        batch.Add(tmp->GetNode()->GetId(), m_delay, tmp, p->Copy(), protocol, to, from);
     }
+    batch.Schedule();
+}
+
+void
+SimpleChannel::Deliver(Ptr<SimpleNetDevice> device,
+                       Ptr<Packet> p,
+                       uint16_t protocol,
+                       Mac48Address to,
+                       Mac48Address from)
+{
+    device->Receive(p, protocol, to, from);
 }
 
 void
@@ -103,6 +103,21 @@ class SimpleChannel : public Channel
     Ptr<NetDevice> GetDevice(std::size_t i) const override;
 
   private:
+    /**
+     * Deliver a packet to a device.
+     *
+     * \param device the receiving device
+     * \param p the packet
+     * \param protocol the protocol
+     * \param to the destination address
+     * \param from the source address
+     */
+    static void Deliver(Ptr<SimpleNetDevice> device,
+                        Ptr<Packet> p,
+                        uint16_t protocol,
+                        Mac48Address to,
+                        Mac48Address from);
+
     Time m_delay; //!< The assigned speed-of-light delay of the channel
     std::vector<Ptr<SimpleNetDevice>> m_devices; //!< devices connected by the channel
     std::map<Ptr<SimpleNetDevice>, std::vector<Ptr<SimpleNetDevice>>>
@@ -98,6 +98,21 @@ NixVectorHelper<T>::PrintRoute(Ptr<Node> source,
     rp->PrintRoutingPath(source, dest, stream, unit);
 }
 
+template <typename T>
+void
+NixVectorHelper<T>::PrecomputePaths(NodeContainer sources, uint32_t threads)
+{
+    if (sources.GetN() == 0)
+    {
+        return;
+    }
+    Ptr<NixVectorRouting<IpRoutingProtocol>> rp =
+        T::template GetRouting<NixVectorRouting<IpRoutingProtocol>>(
+            sources.Get(0)->GetObject<Ip>()->GetRoutingProtocol());
+    NS_ASSERT(rp);
+    rp->PrecomputePaths(sources, threads);
+}
+
 template class NixVectorHelper<Ipv4RoutingHelper>;
 template class NixVectorHelper<Ipv6RoutingHelper>;
 
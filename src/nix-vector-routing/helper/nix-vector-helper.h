@@ -27,6 +27,7 @@
 
 #include "ns3/ipv4-routing-helper.h"
 #include "ns3/ipv6-routing-helper.h"
+#include "ns3/node-container.h"
 #include "ns3/object-factory.h"
 
 namespace ns3
@@ -115,6 +116,17 @@ class NixVectorHelper : public std::enable_if_t<std::is_same_v<Ipv4RoutingHelper
                             Ptr<OutputStreamWrapper> stream,
                             Time::Unit unit = Time::S);
 
+    /**
+     * \brief precomputes the routing paths from the source nodes to all the nodes.
+     * \param sources the source nodes
+     * \param threads the number of threads computing the paths
+     *
+     * This method calls the PrecomputePaths() method of the
+     * NixVectorRouting of the first source, the paths being stored
+     * in the path store shared by all the nodes.
+     */
+    void PrecomputePaths(NodeContainer sources, uint32_t threads = 1);
+
   private:
     ObjectFactory m_agentFactory; //!< Object factory
 
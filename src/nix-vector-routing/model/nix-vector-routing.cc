@@ -30,8 +30,11 @@
 #include "ns3/loopback-net-device.h"
 #include "ns3/names.h"
 
+#include <algorithm>
+#include <atomic>
 #include <iomanip>
 #include <queue>
+#include <thread>
 
 namespace ns3
 {
@@ -55,6 +58,12 @@ template <typename T>
 typename NixVectorRouting<T>::NetDeviceToIpInterfaceMap
     NixVectorRouting<T>::g_netdeviceToIpInterfaceMap;
 
+template <typename T>
+std::vector<typename NixVectorRouting<T>::GraphNode> NixVectorRouting<T>::g_graph;
+
+template <typename T>
+std::vector<typename NixVectorRouting<T>::PathTree> NixVectorRouting<T>::g_pathTrees;
+
 template <typename T>
 TypeId
 NixVectorRouting<T>::GetTypeId()
@@ -169,6 +178,10 @@ NixVectorRouting<T>::FlushGlobalNixRoutingCache() const
     // IP address to node mapping is potentially invalid so clear it.
     // Will be repopulated in lazy evaluation when mapping is needed.
     g_ipAddressToNodeMap.clear();
+
+    // Same for the graph of the topology and the path store.
+    g_graph.clear();
+    g_pathTrees.clear();
 }
 
 template <typename T>
@@ -214,6 +227,17 @@ NixVectorRouting<T>::GetNixVector(Ptr<Node> source, IpAddress dest, Ptr<NetDevic
         NS_LOG_DEBUG("Do not process packets to self");
         return nullptr;
     }
+    else if (!oif)
+    {
+        // the path is in the shortest path tree of the source
+        const PathTree& tree = GetPathTree(source->GetId());
+        if (BuildNixVector(tree, source->GetId(), destNode->GetId(), nixVector))
+        {
+            return nixVector;
+        }
+        NS_LOG_ERROR("No routing path exists");
+        return nullptr;
+    }
     else
     {
         // otherwise proceed as normal
@@ -359,6 +383,367 @@ NixVectorRouting<T>::BuildNixVector(const std::vector<Ptr<Node>>& parentVector,
     return true;
 }
 
+template <typename T>
+bool
+NixVectorRouting<T>::BuildNixVector(const PathTree& tree,
+                                    uint32_t source,
+                                    uint32_t dest,
+                                    Ptr<NixVector> nixVector) const
+{
+    NS_LOG_FUNCTION(this << source << dest << nixVector);
+
+    if (tree.at(dest) == NO_NODE)
+    {
+        return false;
+    }
+
+    // same nix indexes as the recursion of BuildNixVector, from the
+    // destination up to the source
+    for (uint32_t node = dest; node != source; node = tree[node])
+    {
+        const GraphNode& parentNode = g_graph[tree[node]];
+        NS_LOG_LOGIC("Adding Nix: " << GetNixIndex(parentNode, node) << " with "
+                                    << parentNode.nixBits << " bits, for node " << tree[node]);
+        nixVector->AddNeighborIndex(GetNixIndex(parentNode, node), parentNode.nixBits);
+    }
+    return true;
+}
+
+template <typename T>
+void
+NixVectorRouting<T>::BuildGraph() const
+{
+    uint32_t numberOfNodes = NodeList::GetNNodes();
+    if (g_graph.size() == numberOfNodes)
+    {
+        return;
+    }
+    NS_LOG_FUNCTION(this << numberOfNodes);
+
+    // Populate the lookup tables of the neighbors if needed.
+    if (g_ipAddressToNodeMap.empty())
+    {
+        BuildIpAddressToNodeMap();
+    }
+
+    g_graph.clear();
+    g_graph.reserve(numberOfNodes);
+    for (uint32_t i = 0; i < numberOfNodes; i++)
+    {
+        g_graph.push_back(BuildGraphNode(NodeList::GetNode(i)));
+    }
+    g_pathTrees.assign(numberOfNodes, PathTree());
+}
+
+template <typename T>
+typename NixVectorRouting<T>::GraphNode
+NixVectorRouting<T>::BuildGraphNode(Ptr<Node> node) const
+{
+    NS_LOG_FUNCTION(this << node);
+
+    GraphNode graphNode;
+    Ptr<IpL3Protocol> ip = node->GetObject<IpL3Protocol>();
+    uint32_t totalNeighbors = 0;
+
+    for (uint32_t i = 0; i < node->GetNDevices(); i++)
+    {
+        Ptr<NetDevice> localNetDevice = node->GetDevice(i);
+        Ptr<Channel> channel = localNetDevice->GetChannel();
+        if (!channel)
+        {
+            continue;
+        }
+
+        NetDeviceContainer netDeviceContainer;
+        GetAdjacentNetDevices(localNetDevice, channel, netDeviceContainer);
+        if (netDeviceContainer.GetN() == 0)
+        {
+            continue;
+        }
+
+        // BFS goes through the bridges, but BuildNixVector skips them
+        bool isBridge = localNetDevice->IsBridge();
+        bool isUp = localNetDevice->IsLinkUp();
+        if (ip)
+        {
+            isUp = isUp && ip->IsUp(ip->GetInterfaceForDevice(localNetDevice));
+        }
+        for (uint32_t j = 0; j < netDeviceContainer.GetN(); j++)
+        {
+            graphNode.edges.push_back({netDeviceContainer.Get(j)->GetNode()->GetId(),
+                                       i,
+                                       isBridge ? NO_NIX_INDEX : totalNeighbors + j,
+                                       isUp});
+        }
+        if (!isBridge)
+        {
+            totalNeighbors += netDeviceContainer.GetN();
+        }
+    }
+    graphNode.nixBits = NixVector().BitCount(totalNeighbors);
+    return graphNode;
+}
+
+template <typename T>
+uint32_t
+NixVectorRouting<T>::GetNixIndex(const GraphNode& node, uint32_t neighbor)
+{
+    // the last device leading to the neighbor wins, as in BuildNixVector
+    uint32_t nixIndex = 0;
+    for (const auto& edge : node.edges)
+    {
+        if (edge.neighbor == neighbor && edge.nixIndex != NO_NIX_INDEX)
+        {
+            nixIndex = edge.nixIndex;
+        }
+    }
+    return nixIndex;
+}
+
+template <typename T>
+bool
+NixVectorRouting<T>::IsNeighborUp(const GraphNode& node, uint32_t neighbor)
+{
+    for (const auto& edge : node.edges)
+    {
+        if (edge.neighbor == neighbor && edge.isUp)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+void
+NixVectorRouting<T>::ComputePathTree(uint32_t source, PathTree& tree)
+{
+    tree.assign(g_graph.size(), NO_NODE);
+    tree[source] = source;
+
+    // the nodes are discovered in the same order as BFS
+    std::vector<uint32_t> greyNodeList{source};
+    for (std::size_t head = 0; head < greyNodeList.size(); head++)
+    {
+        uint32_t currNode = greyNodeList[head];
+        for (const auto& edge : g_graph[currNode].edges)
+        {
+            if (edge.isUp && tree[edge.neighbor] == NO_NODE)
+            {
+                tree[edge.neighbor] = currNode;
+                greyNodeList.push_back(edge.neighbor);
+            }
+        }
+    }
+}
+
+template <typename T>
+const typename NixVectorRouting<T>::PathTree&
+NixVectorRouting<T>::GetPathTree(uint32_t source) const
+{
+    NS_LOG_FUNCTION(this << source);
+
+    BuildGraph();
+    PathTree& tree = g_pathTrees.at(source);
+    if (tree.empty())
+    {
+        NS_LOG_LOGIC("Path tree of node " << source << " not in store, build: ");
+        ComputePathTree(source, tree);
+    }
+    return tree;
+}
+
+template <typename T>
+void
+NixVectorRouting<T>::PrecomputePaths(const NodeContainer& sources, uint32_t threads) const
+{
+    NS_LOG_FUNCTION(this << sources.GetN() << threads);
+    NS_ASSERT_MSG(threads > 0, "At least one thread is needed to compute the paths");
+
+    CheckCacheStateAndFlush();
+    BuildGraph();
+
+    std::vector<uint32_t> roots;
+    std::vector<bool> isRoot(g_pathTrees.size(), false);
+    for (NodeContainer::Iterator i = sources.Begin(); i != sources.End(); i++)
+    {
+        uint32_t id = (*i)->GetId();
+        if (g_pathTrees.at(id).empty() && !isRoot[id])
+        {
+            isRoot[id] = true;
+            roots.push_back(id);
+        }
+    }
+
+    // The trees are computed from the graph, without accessing any simulation
+    // object, so that several threads can compute them even without
+    // multithreaded simulation support.  Each thread only writes to the trees
+    // of its own sources.
+    std::size_t nThreads = std::min<std::size_t>(threads, roots.size());
+    if (nThreads <= 1)
+    {
+        for (uint32_t root : roots)
+        {
+            ComputePathTree(root, g_pathTrees[root]);
+        }
+        return;
+    }
+
+    std::atomic<std::size_t> next{0};
+    auto work = [&roots, &next]() {
+        for (std::size_t i = next++; i < roots.size(); i = next++)
+        {
+            ComputePathTree(roots[i], g_pathTrees[roots[i]]);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (std::size_t i = 0; i < nThreads; i++)
+    {
+        workers.emplace_back(work);
+    }
+    for (auto& worker : workers)
+    {
+        worker.join();
+    }
+    NS_LOG_DEBUG("Computed the paths of " << roots.size() << " sources on " << nThreads
+                                          << " threads");
+}
+
+template <typename T>
+bool
+NixVectorRouting<T>::PathCrossesHops(const PathTree& tree,
+                                     uint32_t source,
+                                     uint32_t dest,
+                                     const HopSet& hops)
+{
+    for (uint32_t node = dest; node != source; node = tree[node])
+    {
+        if (tree[node] == NO_NODE || hops.count({tree[node], node}))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+template <typename T>
+void
+NixVectorRouting<T>::InvalidatePaths(uint32_t interface) const
+{
+    NS_LOG_FUNCTION(this << interface);
+
+    if (g_isCacheDirty || !m_node || g_graph.size() != NodeList::GetNNodes())
+    {
+        // nothing cached yet, or all of it has to be flushed anyway
+        g_isCacheDirty = true;
+        return;
+    }
+
+    // The node and its neighbors through the interface lost neighbors, which
+    // may change the nix indexes of their other neighbors
+    uint32_t nodeId = m_node->GetId();
+    uint32_t device = m_ip->GetNetDevice(interface)->GetIfIndex();
+    std::set<uint32_t> changedNodes{nodeId};
+    for (const auto& edge : g_graph[nodeId].edges)
+    {
+        if (edge.device == device)
+        {
+            changedNodes.insert(edge.neighbor);
+        }
+    }
+
+    // The hops which cannot be used any more or whose nix index changed
+    HopSet changedHops;
+    for (uint32_t id : changedNodes)
+    {
+        GraphNode graphNode = BuildGraphNode(NodeList::GetNode(id));
+        const GraphNode& oldGraphNode = g_graph[id];
+        for (const auto& edge : graphNode.edges)
+        {
+            if (edge.isUp && !IsNeighborUp(oldGraphNode, edge.neighbor))
+            {
+                // a new neighbor may shorten any path
+                NS_LOG_LOGIC("New neighbor for node " << id << ", flushing all the paths");
+                g_isCacheDirty = true;
+                return;
+            }
+        }
+        for (const auto& edge : oldGraphNode.edges)
+        {
+            if (graphNode.nixBits != oldGraphNode.nixBits ||
+                !IsNeighborUp(graphNode, edge.neighbor) ||
+                GetNixIndex(graphNode, edge.neighbor) != GetNixIndex(oldGraphNode, edge.neighbor))
+            {
+                changedHops.insert({id, edge.neighbor});
+            }
+        }
+        g_graph[id] = std::move(graphNode);
+    }
+
+    // The nix-vectors of the packets in flight may go through the changed
+    // hops, they are rebuilt on their next hop
+    g_epoch++;
+
+    NodeList::Iterator listEnd = NodeList::End();
+    for (NodeList::Iterator i = NodeList::Begin(); i != listEnd; i++)
+    {
+        Ptr<Node> node = *i;
+        uint32_t id = node->GetId();
+        PathTree& tree = g_pathTrees[id];
+        bool crosses = false;
+        for (const auto& hop : changedHops)
+        {
+            if (!tree.empty() && hop.second != id && tree[hop.second] == hop.first)
+            {
+                crosses = true;
+                break;
+            }
+        }
+
+        Ptr<NixVectorRouting<T>> rp = node->GetObject<NixVectorRouting>();
+        if (rp)
+        {
+            for (auto it = rp->m_nixCache.begin(); it != rp->m_nixCache.end();)
+            {
+                Ptr<Node> destNode = GetNodeByIp(it->first);
+                if (tree.empty() || !destNode ||
+                    (crosses && PathCrossesHops(tree, id, destNode->GetId(), changedHops)))
+                {
+                    NS_LOG_LOGIC("Flushing the path from node " << id << " to " << it->first);
+                    rp->m_ipRouteCache.erase(it->first);
+                    it = rp->m_nixCache.erase(it);
+                }
+                else
+                {
+                    it->second->SetEpoch(g_epoch);
+                    it++;
+                }
+            }
+            for (auto it = rp->m_ipRouteCache.begin(); it != rp->m_ipRouteCache.end();)
+            {
+                Ptr<Node> gatewayNode = GetNodeByIp(it->second->GetGateway());
+                if (!gatewayNode || changedHops.count({id, gatewayNode->GetId()}))
+                {
+                    it = rp->m_ipRouteCache.erase(it);
+                }
+                else
+                {
+                    it++;
+                }
+            }
+            if (changedNodes.count(id))
+            {
+                rp->m_totalNeighbors = 0;
+            }
+        }
+        if (crosses)
+        {
+            NS_LOG_LOGIC("Flushing the path tree of node " << id);
+            tree.clear();
+        }
+    }
+}
+
 template <typename T>
 void
 NixVectorRouting<T>::GetAdjacentNetDevices(Ptr<NetDevice> netDevice,
@@ -945,6 +1330,8 @@ NixVectorRouting<T>::RouteInput(Ptr<const Packet> p,
                                                   << ") - rebuilding it");
         nixVector = GetNixVector(m_node, destAddress, nullptr);
         p->SetNixVector(nixVector);
+        // the cached route may not follow the rebuilt nix-vector
+        m_ipRouteCache.erase(destAddress);
     }
 
     // Get the interface number that we go out of, by extracting
@@ -1087,7 +1474,17 @@ template <typename T>
 void
 NixVectorRouting<T>::NotifyInterfaceDown(uint32_t i)
 {
-    g_isCacheDirty = true;
+    if constexpr (IsIpv4)
+    {
+        // the interface keeps its addresses, only the paths through its
+        // links have to be flushed
+        InvalidatePaths(i);
+    }
+    else
+    {
+        // the interface loses its addresses
+        g_isCacheDirty = true;
+    }
 }
 
 template <typename T>
@@ -1443,6 +1840,12 @@ template void NixVectorRouting<Ipv4RoutingProtocol>::SetNode(Ptr<Node> node);
 template void NixVectorRouting<Ipv6RoutingProtocol>::SetNode(Ptr<Node> node);
 template void NixVectorRouting<Ipv4RoutingProtocol>::FlushGlobalNixRoutingCache() const;
 template void NixVectorRouting<Ipv6RoutingProtocol>::FlushGlobalNixRoutingCache() const;
+template void NixVectorRouting<Ipv4RoutingProtocol>::PrecomputePaths(
+    const NodeContainer& sources,
+    uint32_t threads) const;
+template void NixVectorRouting<Ipv6RoutingProtocol>::PrecomputePaths(
+    const NodeContainer& sources,
+    uint32_t threads) const;
 template void NixVectorRouting<Ipv4RoutingProtocol>::PrintRoutingPath(
     Ptr<Node> source,
     IpAddress dest,
@@ -42,7 +42,9 @@
 #include "ns3/nstime.h"
 
 #include <map>
+#include <set>
 #include <unordered_map>
+#include <vector>
 
 // NOLINTBEGIN(modernize-use-override)
 
@@ -142,6 +144,20 @@ class NixVectorRouting : public std::enable_if_t<std::is_same_v<Ipv4RoutingProto
                           Ptr<OutputStreamWrapper> stream,
                           Time::Unit unit) const;
 
+    /**
+     * @brief Precompute the paths from some source nodes to all the nodes
+     *
+     * The shortest path trees of the sources are computed on several threads
+     * from a compact graph of the topology, and kept in the path store shared
+     * by all the nodes, from which the nix-vectors of the sources are built
+     * without any BFS.  The trees of the other sources are computed (and
+     * stored) on demand.
+     *
+     * \param sources the source nodes
+     * \param threads the number of threads computing the paths
+     */
+    void PrecomputePaths(const NodeContainer& sources, uint32_t threads = 1) const;
+
   private:
     /**
      * Flushes the cache which stores nix-vector based on
@@ -229,6 +245,25 @@ class NixVectorRouting : public std::enable_if_t<std::is_same_v<Ipv4RoutingProto
                         uint32_t dest,
                         Ptr<NixVector> nixVector) const;
 
+    /// Shortest path tree of a source: the parent of each node, by node ID
+    typedef std::vector<uint32_t> PathTree;
+
+    /// Set of hops, as pairs of node IDs
+    typedef std::set<std::pair<uint32_t, uint32_t>> HopSet;
+
+    /**
+     * Builds the nixvector of a path of a shortest path tree
+     * \param [in] tree the shortest path tree of the source
+     * \param [in] source Source Node index
+     * \param [in] dest Destination Node index
+     * \param [out] nixVector the NixVector to be used for routing
+     * \returns true on success, false otherwise.
+     */
+    bool BuildNixVector(const PathTree& tree,
+                        uint32_t source,
+                        uint32_t dest,
+                        Ptr<NixVector> nixVector) const;
+
     /**
      * Simply iterates through the nodes net-devices and determines
      * how many neighbors the node has.
@@ -271,6 +306,86 @@ class NixVectorRouting : public std::enable_if_t<std::is_same_v<Ipv4RoutingProto
              std::vector<Ptr<Node>>& parentVector,
              Ptr<NetDevice> oif) const;
 
+    /// An edge of the graph of the topology, from a node to one of its neighbors
+    struct GraphEdge
+    {
+        uint32_t neighbor; //!< the node ID of the neighbor
+        uint32_t device;   //!< the index of the net device of the node
+        uint32_t nixIndex; //!< the nix index of the neighbor (NO_NIX_INDEX through a bridge)
+        bool isUp;         //!< whether BFS can go through the edge
+    };
+
+    /// A node of the graph of the topology
+    struct GraphNode
+    {
+        std::vector<GraphEdge> edges; //!< the edges to the neighbors, in BFS order
+        uint32_t nixBits;             //!< the number of bits of the nix indexes
+    };
+
+    /**
+     * Builds the graph of the topology, unless already built
+     */
+    void BuildGraph() const;
+
+    /**
+     * Builds a node of the graph of the topology, with the same neighbors
+     * and nix indexes as BFS and BuildNixVector
+     * \param node the node
+     * \returns the node of the graph
+     */
+    GraphNode BuildGraphNode(Ptr<Node> node) const;
+
+    /**
+     * \param node a node of the graph
+     * \param neighbor the node ID of a neighbor
+     * \returns the nix index of the neighbor
+     */
+    static uint32_t GetNixIndex(const GraphNode& node, uint32_t neighbor);
+
+    /**
+     * \param node a node of the graph
+     * \param neighbor the node ID of a neighbor
+     * \returns true if BFS can go from the node to the neighbor
+     */
+    static bool IsNeighborUp(const GraphNode& node, uint32_t neighbor);
+
+    /**
+     * Breadth first search over the graph of the topology, from a source
+     * to all the nodes.  It does not access any simulation object, so that
+     * the trees of several sources can be computed concurrently.
+     * \param [in] source Source node index
+     * \param [out] tree the shortest path tree of the source
+     */
+    static void ComputePathTree(uint32_t source, PathTree& tree);
+
+    /**
+     * Gets the shortest path tree of a source from the path store,
+     * computing it if needed
+     * \param source Source node index
+     * \returns the shortest path tree of the source
+     */
+    const PathTree& GetPathTree(uint32_t source) const;
+
+    /**
+     * \param tree the shortest path tree of the source
+     * \param source Source node index
+     * \param dest Destination node index
+     * \param hops the hops to look for
+     * \returns true if the path to the destination goes through any of the hops
+     */
+    static bool PathCrossesHops(const PathTree& tree,
+                                uint32_t source,
+                                uint32_t dest,
+                                const HopSet& hops);
+
+    /**
+     * Flushes the cached paths going through the links of an interface of
+     * the node which went down, instead of all the paths.  All the paths are
+     * flushed if the graph of the topology was not built yet.
+     * \param interface the index of the interface
+     */
+    void InvalidatePaths(uint32_t interface) const;
+
     /**
      * \sa Ipv4RoutingProtocol::DoInitialize
      * \sa Ipv6RoutingProtocol::DoInitialize
@@ -517,6 +632,18 @@ class NixVectorRouting : public std::enable_if_t<std::is_same_v<Ipv4RoutingProto
     typedef std::unordered_map<Ptr<NetDevice>, Ptr<IpInterface>> NetDeviceToIpInterfaceMap;
     static NetDeviceToIpInterfaceMap
         g_netdeviceToIpInterfaceMap; //!< NetDevice pointer to IpInterface pointer map
+
+    static constexpr uint32_t NO_NODE = 0xffffffff;      //!< the parent of an unreachable node
+    static constexpr uint32_t NO_NIX_INDEX = 0xffffffff; //!< a neighbor without nix index
+
+    /// Graph of the topology, by node ID
+    static std::vector<GraphNode> g_graph;
+
+    /**
+     * Path store shared by the nodes: the shortest path trees of the
+     * sources, by node ID (empty if not computed yet).
+     */
+    static std::vector<PathTree> g_pathTrees;
 };
 
 /**
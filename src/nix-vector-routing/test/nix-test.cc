@@ -393,6 +393,183 @@ NixVectorRoutingTest::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup nix-vector-routing-test
+ * \ingroup tests
+ *
+ * The topology is the same as in NixVectorRoutingTest.
+ *
+ * Following are the tests in this test case:
+ * - Test the routing from nSrc to nDst with precomputed paths.
+ * - Test if the path taken is the shortest path.
+ * (Set down the interface of nB on nB-nC channel.)
+ * - Test that only the paths through nC are flushed from the NixCache.
+ * - Test the routing from nSrc to nDst again.
+ *
+ * \brief IPv4 Nix-Vector Routing Precomputed Paths Test
+ */
+class NixVectorRoutingPrecomputeTest : public TestCase
+{
+    /**
+     * \brief Send data immediately after being called.
+     * \param socket The sending socket.
+     * \param to IPv4 Destination address.
+     */
+    void DoSendData(Ptr<Socket> socket, Ipv4Address to);
+
+    /**
+     * \brief Schedules the DoSendData () function to send the data.
+     * \param delay The scheduled time to send data.
+     * \param socket The sending socket.
+     * \param to IPv4 Destination address.
+     */
+    void SendData(Time delay, Ptr<Socket> socket, Ipv4Address to);
+
+    /**
+     * \brief Receive data.
+     * \param socket The receiving socket.
+     */
+    void ReceivePkt(Ptr<Socket> socket);
+
+    uint32_t m_receivedPackets; //!< Number of received packets
+
+  public:
+    void DoRun() override;
+    NixVectorRoutingPrecomputeTest();
+};
+
+NixVectorRoutingPrecomputeTest::NixVectorRoutingPrecomputeTest()
+    : TestCase("three router, precomputed paths test"),
+      m_receivedPackets(0)
+{
+}
+
+void
+NixVectorRoutingPrecomputeTest::ReceivePkt(Ptr<Socket> socket)
+{
+    while (socket->Recv())
+    {
+        m_receivedPackets++;
+    }
+}
+
+void
+NixVectorRoutingPrecomputeTest::DoSendData(Ptr<Socket> socket, Ipv4Address to)
+{
+    Address realTo = InetSocketAddress(to, 1234);
+    socket->SendTo(Create<Packet>(123), 0, realTo);
+}
+
+void
+NixVectorRoutingPrecomputeTest::SendData(Time delay, Ptr<Socket> socket, Ipv4Address to)
+{
+    Simulator::ScheduleWithContext(socket->GetNode()->GetId(),
+                                   delay,
+                                   &NixVectorRoutingPrecomputeTest::DoSendData,
+                                   this,
+                                   socket,
+                                   to);
+}
+
+void
+NixVectorRoutingPrecomputeTest::DoRun()
+{
+    // Create topology
+    NodeContainer nodes;
+    nodes.Create(5);
+    Ptr<Node> nSrc = nodes.Get(0);
+    Ptr<Node> nA = nodes.Get(1);
+    Ptr<Node> nB = nodes.Get(2);
+    Ptr<Node> nC = nodes.Get(3);
+    Ptr<Node> nDst = nodes.Get(4);
+
+    SimpleNetDeviceHelper devHelper;
+    devHelper.SetNetDevicePointToPointMode(true);
+
+    Ipv4NixVectorHelper ipv4NixRouting;
+    InternetStackHelper stack;
+    stack.SetRoutingHelper(ipv4NixRouting);
+    stack.SetIpv6StackInstall(false);
+    stack.Install(nodes);
+
+    NetDeviceContainer dSrcdA = devHelper.Install(NodeContainer(nSrc, nA));
+    NetDeviceContainer dAdB = devHelper.Install(NodeContainer(nA, nB));
+    NetDeviceContainer dBdC = devHelper.Install(NodeContainer(nB, nC));
+    NetDeviceContainer dCdDst = devHelper.Install(NodeContainer(nC, nDst));
+    NetDeviceContainer dAdC = devHelper.Install(NodeContainer(nA, nC));
+
+    Ipv4AddressHelper address;
+    address.SetBase("10.1.0.0", "255.255.255.0");
+    address.Assign(dSrcdA);
+    address.SetBase("10.1.1.0", "255.255.255.0");
+    Ipv4InterfaceContainer iAiB = address.Assign(dAdB);
+    address.SetBase("10.1.2.0", "255.255.255.0");
+    address.Assign(dBdC);
+    address.SetBase("10.1.3.0", "255.255.255.0");
+    Ipv4InterfaceContainer iCiDst = address.Assign(dCdDst);
+    address.SetBase("10.1.4.0", "255.255.255.0");
+    address.Assign(dAdC);
+
+    // Precompute the paths of all the nodes
+    ipv4NixRouting.PrecomputePaths(nodes, 2);
+
+    std::ostringstream pathStream;
+    Ptr<OutputStreamWrapper> routingStream = Create<OutputStreamWrapper>(&pathStream);
+    std::ostringstream cacheStream;
+    Ptr<OutputStreamWrapper> cacheStreamWrapper = Create<OutputStreamWrapper>(&cacheStream);
+
+    Ptr<Socket> rxSocket = nDst->GetObject<UdpSocketFactory>()->CreateSocket();
+    NS_TEST_EXPECT_MSG_EQ(rxSocket->Bind(InetSocketAddress(iCiDst.GetAddress(1), 1234)),
+                          0,
+                          "trivial");
+    rxSocket->SetRecvCallback(MakeCallback(&NixVectorRoutingPrecomputeTest::ReceivePkt, this));
+
+    Ptr<Socket> txSocket = nSrc->GetObject<UdpSocketFactory>()->CreateSocket();
+    SendData(Seconds(2), txSocket, iCiDst.GetAddress(1));
+    SendData(Seconds(2), txSocket, iAiB.GetAddress(0));
+
+    ipv4NixRouting.PrintRoutingPathAt(Seconds(3), nSrc, iCiDst.GetAddress(1), routingStream);
+
+    // Set the nB interface on nB - nC channel down: nC has one neighbor
+    // less, which changes its nix indexes, but not the path to nA.
+    Ptr<Ipv4> ipv4 = nB->GetObject<Ipv4>();
+    int32_t ifIndex = ipv4->GetInterfaceForDevice(dBdC.Get(0));
+    Simulator::Schedule(Seconds(5), &Ipv4::SetDown, ipv4, ifIndex);
+
+    Ptr<Ipv4RoutingProtocol> srcRouting = nSrc->GetObject<Ipv4>()->GetRoutingProtocol();
+    Simulator::Schedule(Seconds(7),
+                        &Ipv4RoutingProtocol::PrintRoutingTable,
+                        srcRouting,
+                        cacheStreamWrapper,
+                        Time::S);
+
+    SendData(Seconds(8), txSocket, iCiDst.GetAddress(1));
+
+    Simulator::Stop(Seconds(66));
+    Simulator::Run();
+
+    NS_TEST_EXPECT_MSG_EQ(m_receivedPackets, 2, "IPv4 Nix-Vector Routing should work.");
+
+    const std::string p_nSrcnAnCnDst =
+        "Time: +3s, Nix Routing\n"
+        "Route path from Node 0 to Node 4, Nix Vector: 01001 (5 bits left)\n"
+        "10.1.0.1                 (Node 0)  ---->   10.1.0.2                 (Node 1)\n"
+        "10.1.4.1                 (Node 1)  ---->   10.1.4.2                 (Node 3)\n"
+        "10.1.3.1                 (Node 3)  ---->   10.1.3.2                 (Node 4)\n\n";
+    NS_TEST_EXPECT_MSG_EQ(pathStream.str(), p_nSrcnAnCnDst, "Routing Path is incorrect.");
+
+    std::string cache = cacheStream.str();
+    std::string nixCache = cache.substr(0, cache.find("IpRouteCache:"));
+    NS_TEST_EXPECT_MSG_NE(nixCache.find("10.1.1.1"),
+                          std::string::npos,
+                          "The path to nA should have been kept.");
+    NS_TEST_EXPECT_MSG_EQ(nixCache.find("10.1.3.2"),
+                          std::string::npos,
+                          "The path to nDst should have been flushed.");
+
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup nix-vector-routing-test
  * \ingroup tests
@@ -406,6 +583,7 @@ class NixVectorRoutingTestSuite : public TestSuite
         : TestSuite("nix-vector-routing", UNIT)
     {
         AddTestCase(new NixVectorRoutingTest(), TestCase::QUICK);
+        AddTestCase(new NixVectorRoutingPrecomputeTest(), TestCase::QUICK);
     }
 };
 
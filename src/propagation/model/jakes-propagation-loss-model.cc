@@ -21,6 +21,7 @@
 
 #include "ns3/double.h"
 #include "ns3/log.h"
+#include "ns3/uinteger.h"
 
 namespace ns3
 {
@@ -46,7 +47,22 @@ JakesPropagationLossModel::GetTypeId()
     static TypeId tid = TypeId("ns3::JakesPropagationLossModel")
                             .SetParent<PropagationLossModel>()
                             .SetGroupName("Propagation")
-                            .AddConstructor<JakesPropagationLossModel>();
+                            .AddConstructor<JakesPropagationLossModel>()
+                            .AddAttribute("ProcessCacheSize",
+                                          "The maximum number of paths whose Jakes process is "
+                                          "kept; the least recently used one is discarded when a "
+                                          "new path is added to a full cache. Zero means no limit.",
+                                          UintegerValue(0),
+                                          MakeUintegerAccessor(
+                                              &JakesPropagationLossModel::SetProcessCacheSize),
+                                          MakeUintegerChecker<uint32_t>())
+                            .AddAttribute("ProcessCacheTimeout",
+                                          "The Jakes process of a path that has not been used "
+                                          "for this time is discarded. Zero means no limit.",
+                                          TimeValue(Seconds(0)),
+                                          MakeTimeAccessor(
+                                              &JakesPropagationLossModel::SetProcessCacheTimeout),
+                                          MakeTimeChecker());
     return tid;
 }
 
@@ -79,6 +95,18 @@ JakesPropagationLossModel::DoCalcRxPower(double txPowerDbm,
     return txPowerDbm + pathData->GetChannelGainDb();
 }
 
+void
+JakesPropagationLossModel::SetProcessCacheSize(uint32_t size)
+{
+    m_propagationCache.SetMaxSize(size);
+}
+
+void
+JakesPropagationLossModel::SetProcessCacheTimeout(Time timeout)
+{
+    m_propagationCache.SetMaxAge(timeout);
+}
+
 Ptr<UniformRandomVariable>
 JakesPropagationLossModel::GetUniformRandomVariable() const
 {
@@ -30,6 +30,10 @@ namespace ns3
  *
  * \brief a  Jakes narrowband propagation model.
  * Symmetrical cache for JakesProcess
+ *
+ * The processes are kept for every path by default. In scenarios with many
+ * mobile nodes, the ProcessCacheSize and ProcessCacheTimeout attributes bound
+ * the cache; a new process is drawn for a path whose process was discarded.
  */
 
 class JakesPropagationLossModel : public PropagationLossModel
@@ -59,6 +63,18 @@ class JakesPropagationLossModel : public PropagationLossModel
 
     int64_t DoAssignStreams(int64_t stream) override;
 
+    /**
+     * Set the maximum number of paths whose process is kept.
+     * \param size the maximum number of paths (zero for no limit)
+     */
+    void SetProcessCacheSize(uint32_t size);
+
+    /**
+     * Set the time after which the process of an unused path is discarded.
+     * \param timeout the timeout (zero for no limit)
+     */
+    void SetProcessCacheTimeout(Time timeout);
+
     /**
      * Get the underlying RNG stream
      * \return the RNG stream
@@ -20,16 +20,33 @@
 #define PROPAGATION_CACHE_H_
 
 #include "ns3/mobility-model.h"
+#include "ns3/nstime.h"
+#include "ns3/object.h"
+#include "ns3/simulator.h"
 
-#include <map>
+#include <functional>
+#include <list>
+#include <type_traits>
+#include <unordered_map>
 
 namespace ns3
 {
 /**
  * \ingroup propagation
  * \brief Constructs a cache of objects, where each object is responsible for a single propagation
- * path loss calculations. Propagation path a-->b and b-->a is the same thing. Propagation path is
- * identified by a couple of MobilityModels and a spectrum model UID
+ * path loss calculations. Propagation path a-->b and b-->a is the same thing, unless the cache
+ * is made asymmetric. Propagation path is identified by a couple of MobilityModels and a spectrum
+ * model UID
+ *
+ * The cache is a hash table, hence lookups take constant time. By default, it keeps every path
+ * until Cleanup is called. It can additionally be bounded:
+ * - by size: when a path is added to a full cache, the least recently used path is evicted;
+ * - by age: a path that has not been used for longer than the maximum age is evicted;
+ * - by mobility: a path is evicted as soon as one of its nodes is not found anymore at the
+ *   position it had when the path was added, which allows caching the results of calculations
+ *   that only depend on the positions of the nodes.
+ *
+ * Evicted objects are disposed of if they are Objects, as done by Cleanup.
  */
 template <class T>
 class PropagationCache
@@ -38,22 +55,84 @@ class PropagationCache
     PropagationCache(){};
     ~PropagationCache(){};
 
+    /**
+     * Set the maximum number of paths in the cache. Zero (the default) means no limit.
+     * \param maxSize the maximum number of paths
+     */
+    void SetMaxSize(std::size_t maxSize)
+    {
+        m_maxSize = maxSize;
+        while (m_maxSize > 0 && m_pathCache.size() > m_maxSize)
+        {
+            Evict(m_pathCache.find(m_lru.back()));
+        }
+    }
+
+    /**
+     * Set the maximum time a path can stay in the cache without being used. Zero (the
+     * default) means no limit.
+     * \param maxAge the maximum age
+     */
+    void SetMaxAge(Time maxAge)
+    {
+        m_maxAge = maxAge;
+    }
+
+    /**
+     * Set whether a path is evicted when one of its nodes moves (false by default).
+     * \param invalidate whether a path is evicted when one of its nodes moves
+     */
+    void SetInvalidateOnMove(bool invalidate)
+    {
+        NS_ASSERT_MSG(m_pathCache.empty(), "Cannot change the invalidation of a non-empty cache");
+        m_invalidateOnMove = invalidate;
+    }
+
+    /**
+     * Set whether the paths a-->b and b-->a are the same (true by default).
+     * \param symmetric whether the paths a-->b and b-->a are the same
+     */
+    void SetSymmetric(bool symmetric)
+    {
+        NS_ASSERT_MSG(m_pathCache.empty(), "Cannot change the symmetry of a non-empty cache");
+        m_symmetric = symmetric;
+    }
+
+    /**
+     * \return the number of paths in the cache
+     */
+    std::size_t GetSize() const
+    {
+        return m_pathCache.size();
+    }
+
     /**
      * Get the model associated with the path
      * \param a 1st node mobility model
      * \param b 2nd node mobility model
      * \param modelUid model UID
-     * \return the model
+     * \return the model, or a null pointer if the path is not (or no longer) in the cache
      */
     Ptr<T> GetPathData(Ptr<const MobilityModel> a, Ptr<const MobilityModel> b, uint32_t modelUid)
     {
-        PropagationPathIdentifier key = PropagationPathIdentifier(a, b, modelUid);
+        PropagationPathIdentifier key = PropagationPathIdentifier(a, b, modelUid, m_symmetric);
         typename PathCache::iterator it = m_pathCache.find(key);
         if (it == m_pathCache.end())
         {
             return nullptr;
         }
-        return it->second;
+        PathData& path = it->second;
+        if ((m_maxAge.IsStrictlyPositive() && Simulator::Now() - path.m_lastUse > m_maxAge) ||
+            (m_invalidateOnMove &&
+             (key.m_srcMobility->GetPosition() != path.m_srcPosition ||
+              key.m_dstMobility->GetPosition() != path.m_dstPosition)))
+        {
+            Evict(it);
+            return nullptr;
+        }
+        path.m_lastUse = Simulator::Now();
+        m_lru.splice(m_lru.begin(), m_lru, path.m_lruIt);
+        return path.m_data;
     };
 
     /**
@@ -68,9 +147,27 @@ class PropagationCache
                      Ptr<const MobilityModel> b,
                      uint32_t modelUid)
     {
-        PropagationPathIdentifier key = PropagationPathIdentifier(a, b, modelUid);
+        PropagationPathIdentifier key = PropagationPathIdentifier(a, b, modelUid, m_symmetric);
         NS_ASSERT(m_pathCache.find(key) == m_pathCache.end());
-        m_pathCache.insert(std::make_pair(key, data));
+        // the least recently used paths are the first ones to expire
+        while (!m_lru.empty() &&
+               ((m_maxSize > 0 && m_pathCache.size() >= m_maxSize) ||
+                (m_maxAge.IsStrictlyPositive() &&
+                 Simulator::Now() - m_pathCache.find(m_lru.back())->second.m_lastUse > m_maxAge)))
+        {
+            Evict(m_pathCache.find(m_lru.back()));
+        }
+        m_lru.push_front(key);
+        PathData path;
+        path.m_data = data;
+        if (m_invalidateOnMove)
+        {
+            path.m_srcPosition = key.m_srcMobility->GetPosition();
+            path.m_dstPosition = key.m_dstMobility->GetPosition();
+        }
+        path.m_lastUse = Simulator::Now();
+        path.m_lruIt = m_lru.begin();
+        m_pathCache.insert(std::make_pair(key, path));
     };
 
     /**
@@ -78,11 +175,12 @@ class PropagationCache
      */
     void Cleanup()
     {
-        for (auto i : m_pathCache)
+        for (auto& i : m_pathCache)
         {
-            i.second->Dispose();
+            Dispose(i.second.m_data);
         }
         m_pathCache.clear();
+        m_lru.clear();
     }
 
   private:
@@ -94,57 +192,106 @@ class PropagationCache
          * @param a 1st node mobility model
          * @param b 2nd node mobility model
          * @param modelUid model UID
+         * @param symmetric whether the paths a-->b and b-->a are the same
          */
         PropagationPathIdentifier(Ptr<const MobilityModel> a,
                                   Ptr<const MobilityModel> b,
-                                  uint32_t modelUid)
+                                  uint32_t modelUid,
+                                  bool symmetric)
             : m_srcMobility(a),
               m_dstMobility(b),
-              m_spectrumModelUid(modelUid){};
+              m_spectrumModelUid(modelUid)
+        {
+            /// Symmetrical links are identified by the ordered couple of mobility models
+            if (symmetric && m_dstMobility < m_srcMobility)
+            {
+                std::swap(m_srcMobility, m_dstMobility);
+            }
+        };
+
         Ptr<const MobilityModel> m_srcMobility; //!< 1st node mobility model
         Ptr<const MobilityModel> m_dstMobility; //!< 2nd node mobility model
         uint32_t m_spectrumModelUid;            //!< model UID
 
         /**
-         * Less-than operator.
-         *
-         * The goal of this operator is just to provide a stable comparison
-         * to be used in containers requiring a order (of any kind).
-         *
-         * If the models are different, the comparison is based on their Uid.
-         * Otherwise, the comparison is based on the pointers of the Mobility models.
+         * Equality operator.
          *
          * \param other Right value of the operator.
-         * \returns True if the Left value is less than the Right value.
+         * \returns True if both values identify the same path.
          */
-        bool operator<(const PropagationPathIdentifier& other) const
+        bool operator==(const PropagationPathIdentifier& other) const
         {
-            if (m_spectrumModelUid != other.m_spectrumModelUid)
-            {
-                return m_spectrumModelUid < other.m_spectrumModelUid;
-            }
-            /// Links are supposed to be symmetrical!
-            if (std::min(m_dstMobility, m_srcMobility) !=
-                std::min(other.m_dstMobility, other.m_srcMobility))
-            {
-                return std::min(m_dstMobility, m_srcMobility) <
-                       std::min(other.m_dstMobility, other.m_srcMobility);
-            }
-            if (std::max(m_dstMobility, m_srcMobility) !=
-                std::max(other.m_dstMobility, other.m_srcMobility))
-            {
-                return std::max(m_dstMobility, m_srcMobility) <
-                       std::max(other.m_dstMobility, other.m_srcMobility);
-            }
-            return false;
+            return m_spectrumModelUid == other.m_spectrumModelUid &&
+                   m_srcMobility == other.m_srcMobility && m_dstMobility == other.m_dstMobility;
         }
     };
 
-    /// Typedef: PropagationPathIdentifier, Ptr<T>
-    typedef std::map<PropagationPathIdentifier, Ptr<T>> PathCache;
+    /// Hash function of the path identifiers
+    struct PropagationPathIdentifierHash
+    {
+        /**
+         * \param key the path identifier
+         * \return the hash of the path identifier
+         */
+        std::size_t operator()(const PropagationPathIdentifier& key) const
+        {
+            std::size_t h = std::hash<const MobilityModel*>()(PeekPointer(key.m_srcMobility));
+            h ^= std::hash<const MobilityModel*>()(PeekPointer(key.m_dstMobility)) + 0x9e3779b9 +
+                 (h << 6) + (h >> 2);
+            h ^= std::hash<uint32_t>()(key.m_spectrumModelUid) + 0x9e3779b9 + (h << 6) + (h >> 2);
+            return h;
+        }
+    };
+
+    /// Typedef: list of the paths from the most to the least recently used
+    typedef std::list<PropagationPathIdentifier> LruList;
+
+    /// The data cached for a path
+    struct PathData
+    {
+        Ptr<T> m_data;                      //!< the model
+        Vector m_srcPosition;               //!< 1st node position when the path was added
+        Vector m_dstPosition;               //!< 2nd node position when the path was added
+        Time m_lastUse;                     //!< the last time the path was used
+        typename LruList::iterator m_lruIt; //!< the position of the path in the LRU list
+    };
+
+    /// Typedef: PropagationPathIdentifier, PathData
+    typedef std::unordered_map<PropagationPathIdentifier, PathData, PropagationPathIdentifierHash>
+        PathCache;
+
+    /**
+     * Remove a path from the cache
+     * \param it the iterator pointing to the path
+     */
+    void Evict(typename PathCache::iterator it)
+    {
+        NS_ASSERT(it != m_pathCache.end());
+        Ptr<T> data = it->second.m_data;
+        m_lru.erase(it->second.m_lruIt);
+        m_pathCache.erase(it);
+        Dispose(data);
+    }
+
+    /**
+     * Dispose of a model, if it is an Object
+     * \param data the model
+     */
+    static void Dispose(Ptr<T> data)
+    {
+        if constexpr (std::is_base_of_v<Object, T>)
+        {
+            data->Dispose();
+        }
+    }
 
   private:
-    PathCache m_pathCache; //!< Path cache
+    PathCache m_pathCache;          //!< Path cache
+    LruList m_lru;                  //!< Paths from the most to the least recently used
+    std::size_t m_maxSize{0};       //!< Maximum number of paths (zero for no limit)
+    Time m_maxAge{0};               //!< Maximum time a path is kept unused (zero for no limit)
+    bool m_invalidateOnMove{false}; //!< Whether a path is evicted when a node moves
+    bool m_symmetric{true};         //!< Whether the paths a-->b and b-->a are the same
 };
 } // namespace ns3
 
@@ -22,14 +22,20 @@
 
 #include "propagation-loss-model.h"
 
+#include "ns3/abort.h"
 #include "ns3/boolean.h"
 #include "ns3/double.h"
 #include "ns3/log.h"
 #include "ns3/mobility-model.h"
+#include "ns3/node.h"
 #include "ns3/pointer.h"
 #include "ns3/string.h"
+#include "ns3/uinteger.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
+#include <thread>
 
 namespace ns3
 {
@@ -44,13 +50,26 @@ TypeId
 PropagationLossModel::GetTypeId()
 {
     static TypeId tid =
-        TypeId("ns3::PropagationLossModel").SetParent<Object>().SetGroupName("Propagation");
+        TypeId("ns3::PropagationLossModel")
+            .SetParent<Object>()
+            .SetGroupName("Propagation")
+            .AddAttribute("LossCacheSize",
+                          "The maximum number of (source, destination) couples whose loss "
+                          "computed by this model is cached until one of the nodes moves. "
+                          "Zero disables the cache. Only models whose loss is a deterministic "
+                          "function of the node positions may enable it.",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&PropagationLossModel::SetLossCacheSize),
+                          MakeUintegerChecker<uint32_t>());
     return tid;
 }
 
 PropagationLossModel::PropagationLossModel()
-    : m_next(nullptr)
+    : m_next(nullptr),
+      m_lossCacheSize(0)
 {
+    m_lossCache.SetSymmetric(false);
+    m_lossCache.SetInvalidateOnMove(true);
 }
 
 PropagationLossModel::~PropagationLossModel()
@@ -69,12 +88,39 @@ PropagationLossModel::GetNext()
     return m_next;
 }
 
+void
+PropagationLossModel::SetLossCacheSize(uint32_t size)
+{
+    NS_LOG_FUNCTION(this << size);
+    m_lossCacheSize = size;
+    if (m_lossCacheSize == 0)
+    {
+        m_lossCache.Cleanup();
+    }
+    m_lossCache.SetMaxSize(m_lossCacheSize);
+}
+
 double
 PropagationLossModel::CalcRxPower(double txPowerDbm,
                                   Ptr<MobilityModel> a,
                                   Ptr<MobilityModel> b) const
 {
-    double self = DoCalcRxPower(txPowerDbm, a, b);
+    double self;
+    if (m_lossCacheSize > 0)
+    {
+        Ptr<CachedLoss> loss = m_lossCache.GetPathData(a, b, 0);
+        if (!loss)
+        {
+            loss = Create<CachedLoss>();
+            loss->m_gainDb = DoCalcRxPower(txPowerDbm, a, b) - txPowerDbm;
+            m_lossCache.AddPathData(loss, a, b, 0);
+        }
+        self = txPowerDbm + loss->m_gainDb;
+    }
+    else
+    {
+        self = DoCalcRxPower(txPowerDbm, a, b);
+    }
     if (m_next)
     {
         self = m_next->CalcRxPower(self, a, b);
@@ -911,6 +957,221 @@ MatrixPropagationLossModel::DoAssignStreams(int64_t stream)
 
 // ------------------------------------------------------------------------- //
 
+NS_OBJECT_ENSURE_REGISTERED(PrecomputedPropagationLossModel);
+
+TypeId
+PrecomputedPropagationLossModel::GetTypeId()
+{
+    static TypeId tid =
+        TypeId("ns3::PrecomputedPropagationLossModel")
+            .SetParent<PropagationLossModel>()
+            .SetGroupName("Propagation")
+            .AddConstructor<PrecomputedPropagationLossModel>()
+            .AddAttribute("Model",
+                          "The chain of models computing the losses.",
+                          PointerValue(),
+                          MakePointerAccessor(&PrecomputedPropagationLossModel::m_model),
+                          MakePointerChecker<PropagationLossModel>())
+            .AddAttribute("Symmetric",
+                          "Whether the loss from a node to another is the same as the loss "
+                          "from the latter to the former, in which case it is computed and "
+                          "stored once.",
+                          BooleanValue(true),
+                          MakeBooleanAccessor(&PrecomputedPropagationLossModel::m_symmetric),
+                          MakeBooleanChecker())
+            .AddAttribute("Threads",
+                          "The number of threads computing the losses. Only used with "
+                          "multithreaded simulation support, and a StatelessModel chain.",
+                          UintegerValue(1),
+                          MakeUintegerAccessor(&PrecomputedPropagationLossModel::m_threads),
+                          MakeUintegerChecker<uint32_t>(1))
+            .AddAttribute("StatelessModel",
+                          "Whether the chain of models is stateless and deterministic, i.e., "
+                          "none of them draws random values nor caches losses, in which case "
+                          "the losses are computed by Threads threads. Otherwise they are "
+                          "computed by a single thread.",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&PrecomputedPropagationLossModel::m_statelessModel),
+                          MakeBooleanChecker());
+    return tid;
+}
+
+PrecomputedPropagationLossModel::PrecomputedPropagationLossModel()
+    : PropagationLossModel(),
+      m_symmetric(true),
+      m_threads(1),
+      m_statelessModel(false)
+{
+}
+
+PrecomputedPropagationLossModel::~PrecomputedPropagationLossModel()
+{
+}
+
+void
+PrecomputedPropagationLossModel::DoDispose()
+{
+    Clear();
+    m_model = nullptr;
+    PropagationLossModel::DoDispose();
+}
+
+void
+PrecomputedPropagationLossModel::Clear()
+{
+    for (const auto& mobility : m_mobilities)
+    {
+        mobility->TraceDisconnectWithoutContext(
+            "CourseChange",
+            MakeCallback(&PrecomputedPropagationLossModel::CourseChanged, this));
+    }
+    m_mobilities.clear();
+    m_indices.clear();
+    m_static.clear();
+    m_gains.clear();
+}
+
+void
+PrecomputedPropagationLossModel::Precompute(const NodeContainer& nodes)
+{
+    std::vector<Ptr<MobilityModel>> mobilities;
+    for (auto it = nodes.Begin(); it != nodes.End(); ++it)
+    {
+        Ptr<MobilityModel> mobility = (*it)->GetObject<MobilityModel>();
+        NS_ABORT_MSG_IF(!mobility, "Node " << (*it)->GetId() << " has no mobility model");
+        mobilities.push_back(mobility);
+    }
+    Precompute(mobilities);
+}
+
+void
+PrecomputedPropagationLossModel::Precompute(const std::vector<Ptr<MobilityModel>>& mobilities)
+{
+    NS_LOG_FUNCTION(this << mobilities.size());
+    NS_ABORT_MSG_IF(!m_model, "The Model attribute is not set");
+
+    Clear();
+    m_mobilities = mobilities;
+    std::size_t n = m_mobilities.size();
+    for (uint32_t i = 0; i < n; i++)
+    {
+        NS_ASSERT(m_mobilities[i]);
+        bool inserted = m_indices.emplace(PeekPointer(m_mobilities[i]), i).second;
+        NS_ABORT_MSG_IF(!inserted, "Mobility model " << m_mobilities[i] << " given twice");
+        // a node can only move through a course change once it has no velocity
+        m_static.push_back(m_mobilities[i]->GetVelocity() == Vector());
+        m_mobilities[i]->TraceConnectWithoutContext(
+            "CourseChange",
+            MakeCallback(&PrecomputedPropagationLossModel::CourseChanged, this));
+    }
+    m_gains.assign(m_symmetric ? n * (n - 1) / 2 : n * n, 0);
+
+    // Compute the gains from a node to the nodes after it (and from the nodes after it to
+    // the node if the gains are not symmetric)
+    auto computeRow = [this, n](uint32_t a) {
+        if (!m_static[a])
+        {
+            return;
+        }
+        for (uint32_t b = a + 1; b < n; b++)
+        {
+            if (!m_static[b])
+            {
+                continue;
+            }
+            m_gains[GetGainIndex(a, b)] = m_model->CalcRxPower(0, m_mobilities[a], m_mobilities[b]);
+            if (!m_symmetric)
+            {
+                m_gains[GetGainIndex(b, a)] =
+                    m_model->CalcRxPower(0, m_mobilities[b], m_mobilities[a]);
+            }
+        }
+    };
+
+    // Each row writes its own gains, but all the rows call the Model chain, whose random
+    // variables and loss caches (LossCacheSize, or the PropagationCache of models such as
+    // JakesPropagationLossModel) every call may update, and whose random values would not
+    // be drawn in the sequential order. The rows also copy the Ptr to the mobility models
+    // of the other rows, which is only thread-safe with multithreaded simulation.
+    std::size_t nThreads = 1;
+#ifdef NS3_MTP
+    if (m_statelessModel)
+    {
+        nThreads = std::min<std::size_t>(m_threads, n);
+    }
+#endif
+    std::atomic<uint32_t> next{0};
+    auto work = [n, &next, &computeRow]() {
+        for (uint32_t a = next++; a < n; a = next++)
+        {
+            computeRow(a);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < nThreads; i++)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+    NS_LOG_DEBUG("Precomputed the losses between " << n << " nodes on " << nThreads
+                                                   << " threads");
+}
+
+std::size_t
+PrecomputedPropagationLossModel::GetGainIndex(uint32_t a, uint32_t b) const
+{
+    NS_ASSERT(a != b);
+    if (m_symmetric)
+    {
+        if (a < b)
+        {
+            std::swap(a, b);
+        }
+        return static_cast<std::size_t>(a) * (a - 1) / 2 + b;
+    }
+    return static_cast<std::size_t>(a) * m_mobilities.size() + b;
+}
+
+void
+PrecomputedPropagationLossModel::CourseChanged(Ptr<const MobilityModel> mobility)
+{
+    auto it = m_indices.find(PeekPointer(mobility));
+    NS_ASSERT(it != m_indices.end());
+    if (m_static[it->second])
+    {
+        NS_LOG_DEBUG("Mobility model " << mobility << " moved, its losses are not precomputed");
+        m_static[it->second] = false;
+    }
+}
+
+double
+PrecomputedPropagationLossModel::DoCalcRxPower(double txPowerDbm,
+                                               Ptr<MobilityModel> a,
+                                               Ptr<MobilityModel> b) const
+{
+    auto aIt = m_indices.find(PeekPointer(a));
+    auto bIt = m_indices.find(PeekPointer(b));
+    if (aIt != m_indices.end() && bIt != m_indices.end() && aIt->second != bIt->second &&
+        m_static[aIt->second] && m_static[bIt->second])
+    {
+        return txPowerDbm + m_gains[GetGainIndex(aIt->second, bIt->second)];
+    }
+    NS_ABORT_MSG_IF(!m_model, "The Model attribute is not set");
+    return m_model->CalcRxPower(txPowerDbm, a, b);
+}
+
+int64_t
+PrecomputedPropagationLossModel::DoAssignStreams(int64_t stream)
+{
+    return m_model ? m_model->AssignStreams(stream) : 0;
+}
+
+// ------------------------------------------------------------------------- //
+
 NS_OBJECT_ENSURE_REGISTERED(RangePropagationLossModel);
 
 TypeId
@@ -24,10 +24,14 @@
 #ifndef PROPAGATION_LOSS_MODEL_H
 #define PROPAGATION_LOSS_MODEL_H
 
+#include "ns3/node-container.h"
 #include "ns3/object.h"
+#include "ns3/propagation-cache.h"
 #include "ns3/random-variable-stream.h"
 
 #include <map>
+#include <unordered_map>
+#include <vector>
 
 namespace ns3
 {
@@ -51,6 +55,13 @@ class MobilityModel;
  *
  * Calculate the receive power (dbm) from a transmit power (dbm)
  * and a mobility model for the source and destination positions.
+ *
+ * When the LossCacheSize attribute is non-zero, the loss computed by this
+ * model (not by the models chained to it) is cached for the given number of
+ * (source, destination) couples and reused as long as both nodes stay at the
+ * same position. This is only correct for models whose loss is a deterministic
+ * function of the positions of the nodes and does not depend on the transmit
+ * power, e.g., LogDistancePropagationLossModel, but not NakagamiPropagationLossModel.
  */
 class PropagationLossModel : public Object
 {
@@ -139,7 +150,22 @@ class PropagationLossModel : public Object
                                  Ptr<MobilityModel> a,
                                  Ptr<MobilityModel> b) const = 0;
 
-    Ptr<PropagationLossModel> m_next; //!< Next propagation loss model in the list
+    /**
+     * Set the maximum number of (source, destination) couples whose loss is cached.
+     *
+     * \param size the maximum number of cached couples (zero disables the cache)
+     */
+    void SetLossCacheSize(uint32_t size);
+
+    /// The loss cached for a (source, destination) couple
+    struct CachedLoss : public SimpleRefCount<CachedLoss>
+    {
+        double m_gainDb; //!< the gain (opposite of the loss) in dB
+    };
+
+    Ptr<PropagationLossModel> m_next;                 //!< Next propagation loss model in the list
+    uint32_t m_lossCacheSize;                         //!< Maximum number of cached couples
+    mutable PropagationCache<CachedLoss> m_lossCache; //!< The losses of the cached couples
 };
 
 /**
@@ -747,6 +773,99 @@ class MatrixPropagationLossModel : public PropagationLossModel
     std::map<MobilityPair, double> m_loss; //!< Propagation loss between pair of nodes
 };
 
+/**
+ * \ingroup propagation
+ *
+ * \brief The propagation loss between static nodes is precomputed by another model.
+ *
+ * The Precompute method computes, through the chain of models set by the Model
+ * attribute, the loss between all the pairs of the given nodes which do not move,
+ * and stores it in a matrix of floats (a triangular one if the Symmetric attribute
+ * is true). The loss between two of these nodes is then looked up in the matrix, until
+ * one of them moves, i.e., until its mobility model notifies a course change. The loss
+ * between the other pairs of nodes is computed by the Model chain, as if this model
+ * was not used.
+ *
+ * This is only correct if the loss of the Model chain is a deterministic function of
+ * the node positions that does not depend on the transmit power, e.g., with a
+ * LogDistancePropagationLossModel, to which this model can chain a fast fading model
+ * such as NakagamiPropagationLossModel. With multithreaded simulation support, the
+ * losses are computed by Threads threads if the StatelessModel attribute declares that
+ * the Model chain neither draws random values nor caches losses, since these would be
+ * written concurrently, and drawn in another order than on a single thread.
+ */
+class PrecomputedPropagationLossModel : public PropagationLossModel
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return the object TypeId
+     */
+    static TypeId GetTypeId();
+
+    PrecomputedPropagationLossModel();
+    ~PrecomputedPropagationLossModel() override;
+
+    // Delete copy constructor and assignment operator to avoid misuse
+    PrecomputedPropagationLossModel(const PrecomputedPropagationLossModel&) = delete;
+    PrecomputedPropagationLossModel& operator=(const PrecomputedPropagationLossModel&) = delete;
+
+    /**
+     * \brief Compute the loss between all the pairs of the given nodes which do not move,
+     * replacing the losses computed by a previous call.
+     *
+     * \param mobilities the mobility models of the nodes
+     */
+    void Precompute(const std::vector<Ptr<MobilityModel>>& mobilities);
+
+    /**
+     * \brief Compute the loss between all the pairs of the given nodes which do not move,
+     * replacing the losses computed by a previous call.
+     *
+     * \param nodes the nodes, which must have a mobility model
+     */
+    void Precompute(const NodeContainer& nodes);
+
+  protected:
+    void DoDispose() override;
+
+  private:
+    double DoCalcRxPower(double txPowerDbm,
+                         Ptr<MobilityModel> a,
+                         Ptr<MobilityModel> b) const override;
+
+    int64_t DoAssignStreams(int64_t stream) override;
+
+    /**
+     * Get the index of the gain from a node to another in the matrix
+     *
+     * \param a the index of the source node
+     * \param b the index of the destination node
+     * \return the index of the gain in m_gains
+     */
+    std::size_t GetGainIndex(uint32_t a, uint32_t b) const;
+
+    /**
+     * Notify that a node of the matrix changed its course
+     *
+     * \param mobility the mobility model of the node
+     */
+    void CourseChanged(Ptr<const MobilityModel> mobility);
+
+    /// Disconnect from the course changes of the nodes of the matrix and clear it
+    void Clear();
+
+    Ptr<PropagationLossModel> m_model; //!< Model chain computing the losses
+    bool m_symmetric;                  //!< Whether the loss is the same in both directions
+    uint32_t m_threads;                //!< Number of threads computing the losses
+    bool m_statelessModel;             //!< Whether the Model chain supports concurrent calls
+
+    std::vector<Ptr<MobilityModel>> m_mobilities; //!< Mobility models of the nodes of the matrix
+    std::unordered_map<const MobilityModel*, uint32_t> m_indices; //!< Indices of the nodes
+    std::vector<bool> m_static; //!< Whether each node is still at its initial position
+    std::vector<float> m_gains; //!< Gains (opposite of the losses) between the nodes, in dB
+};
+
 /**
  * \ingroup propagation
  *
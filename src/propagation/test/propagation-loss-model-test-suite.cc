@@ -16,13 +16,18 @@
  */
 
 #include "ns3/abort.h"
+#include "ns3/boolean.h"
 #include "ns3/config.h"
 #include "ns3/constant-position-mobility-model.h"
 #include "ns3/double.h"
 #include "ns3/log.h"
+#include "ns3/pointer.h"
+#include "ns3/propagation-cache.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/simulator.h"
+#include "ns3/string.h"
 #include "ns3/test.h"
+#include "ns3/uinteger.h"
 
 using namespace ns3;
 
@@ -444,6 +449,170 @@ MatrixPropagationLossModelTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup propagation-tests
+ *
+ * \brief PrecomputedPropagationLossModel Test
+ */
+class PrecomputedPropagationLossModelTestCase : public TestCase
+{
+  public:
+    PrecomputedPropagationLossModelTestCase();
+    ~PrecomputedPropagationLossModelTestCase() override;
+
+  private:
+    void DoRun() override;
+};
+
+PrecomputedPropagationLossModelTestCase::PrecomputedPropagationLossModelTestCase()
+    : TestCase("Test PrecomputedPropagationLossModel")
+{
+}
+
+PrecomputedPropagationLossModelTestCase::~PrecomputedPropagationLossModelTestCase()
+{
+}
+
+void
+PrecomputedPropagationLossModelTestCase::DoRun()
+{
+    Ptr<MobilityModel> m[4];
+    for (int i = 0; i < 4; ++i)
+    {
+        m[i] = CreateObject<ConstantPositionMobilityModel>();
+        m[i]->SetPosition(Vector(10.0 * i, 0, 0));
+    }
+
+    // symmetric losses, depending on the positions
+    Ptr<LogDistancePropagationLossModel> logDistance =
+        CreateObject<LogDistancePropagationLossModel>();
+    Ptr<PrecomputedPropagationLossModel> loss = CreateObject<PrecomputedPropagationLossModel>();
+    loss->SetAttribute("Model", PointerValue(logDistance));
+    loss->Precompute({m[0], m[1], m[2]});
+
+    double tolerance = 1e-4; // losses are stored as floats
+    // m[2] moves, m[3] is not in the matrix
+    m[2]->SetPosition(Vector(20.0, 5.0, 0));
+    for (int i = 0; i < 4; ++i)
+    {
+        for (int j = 0; j < 4; ++j)
+        {
+            if (i != j)
+            {
+                NS_TEST_EXPECT_MSG_EQ_TOL(loss->CalcRxPower(20, m[i], m[j]),
+                                          logDistance->CalcRxPower(20, m[i], m[j]),
+                                          tolerance,
+                                          "Wrong loss from " << i << " to " << j);
+            }
+        }
+    }
+
+    // asymmetric losses, which do not depend on the positions
+    Ptr<MatrixPropagationLossModel> matrix = CreateObject<MatrixPropagationLossModel>();
+    matrix->SetDefaultLoss(0);
+    matrix->SetLoss(m[0], m[1], 30, /*symmetric = */ false);
+    matrix->SetLoss(m[1], m[0], 100, /*symmetric = */ false);
+    loss->SetAttribute("Model", PointerValue(matrix));
+    loss->SetAttribute("Symmetric", BooleanValue(false));
+    loss->Precompute({m[0], m[1], m[2], m[3]});
+    // the matrix is only looked up between static nodes
+    matrix->SetLoss(m[0], m[1], 50, /*symmetric = */ false);
+    NS_TEST_EXPECT_MSG_EQ_TOL(loss->CalcRxPower(0, m[0], m[1]), -30, tolerance, "Loss 0 -> 1");
+    NS_TEST_EXPECT_MSG_EQ_TOL(loss->CalcRxPower(0, m[1], m[0]), -100, tolerance, "Loss 1 -> 0");
+    m[0]->SetPosition(Vector(0, 1, 0));
+    NS_TEST_EXPECT_MSG_EQ_TOL(loss->CalcRxPower(0, m[0], m[1]), -50, tolerance, "Loss 0 -> 1");
+    NS_TEST_EXPECT_MSG_EQ_TOL(loss->CalcRxPower(0, m[1], m[0]), -100, tolerance, "Loss 1 -> 0");
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup propagation-tests
+ *
+ * \brief PrecomputedPropagationLossModel Test, computing the losses on several threads
+ */
+class PrecomputedPropagationLossModelThreadsTestCase : public TestCase
+{
+  public:
+    PrecomputedPropagationLossModelThreadsTestCase();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Check that the losses precomputed by several threads are those computed by one
+     *
+     * \param model the chain of models
+     * \param stateless whether the chain is declared stateless
+     */
+    void CheckThreads(Ptr<PropagationLossModel> model, bool stateless);
+
+    std::vector<Ptr<MobilityModel>> m_mobilities; //!< the mobility models of the nodes
+};
+
+PrecomputedPropagationLossModelThreadsTestCase::PrecomputedPropagationLossModelThreadsTestCase()
+    : TestCase("Test PrecomputedPropagationLossModel with several threads")
+{
+}
+
+void
+PrecomputedPropagationLossModelThreadsTestCase::CheckThreads(Ptr<PropagationLossModel> model,
+                                                             bool stateless)
+{
+    std::vector<double> losses[2];
+    for (uint32_t threads : {1, 4})
+    {
+        Ptr<PrecomputedPropagationLossModel> loss =
+            CreateObject<PrecomputedPropagationLossModel>();
+        loss->SetAttribute("Model", PointerValue(model));
+        loss->SetAttribute("Symmetric", BooleanValue(false));
+        loss->SetAttribute("Threads", UintegerValue(threads));
+        loss->SetAttribute("StatelessModel", BooleanValue(stateless));
+        loss->AssignStreams(1);
+        loss->Precompute(m_mobilities);
+        for (const auto& a : m_mobilities)
+        {
+            for (const auto& b : m_mobilities)
+            {
+                if (a != b)
+                {
+                    losses[threads > 1].push_back(loss->CalcRxPower(0, a, b));
+                }
+            }
+        }
+        loss->Dispose();
+    }
+    for (std::size_t i = 0; i < losses[0].size(); i++)
+    {
+        NS_TEST_EXPECT_MSG_EQ(losses[1][i], losses[0][i], "Wrong loss " << i);
+    }
+}
+
+void
+PrecomputedPropagationLossModelThreadsTestCase::DoRun()
+{
+    for (int i = 0; i < 32; ++i)
+    {
+        Ptr<MobilityModel> mobility = CreateObject<ConstantPositionMobilityModel>();
+        mobility->SetPosition(Vector(10.0 * (i % 8), 10.0 * (i / 8), 0));
+        m_mobilities.push_back(mobility);
+    }
+
+    // a deterministic chain, computed by the threads
+    Ptr<LogDistancePropagationLossModel> logDistance =
+        CreateObject<LogDistancePropagationLossModel>();
+    CheckThreads(logDistance, true);
+
+    // a random chain, whose values are drawn in the same order as on a single thread
+    Ptr<RandomPropagationLossModel> random = CreateObject<RandomPropagationLossModel>();
+    random->SetAttribute("Variable", StringValue("ns3::UniformRandomVariable[Min=0|Max=10]"));
+    logDistance->SetNext(random);
+    CheckThreads(logDistance, false);
+
+    m_mobilities.clear();
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup propagation-tests
  *
@@ -489,6 +658,163 @@ RangePropagationLossModelTestCase::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup propagation-tests
+ *
+ * \brief PropagationCache Test
+ */
+class PropagationCacheTestCase : public TestCase
+{
+  public:
+    PropagationCacheTestCase();
+    ~PropagationCacheTestCase() override;
+
+  private:
+    void DoRun() override;
+
+    /// Data cached for a path
+    struct PathData : public SimpleRefCount<PathData>
+    {
+    };
+
+    PropagationCache<PathData> m_cache; //!< the cache under test
+};
+
+PropagationCacheTestCase::PropagationCacheTestCase()
+    : TestCase("Test PropagationCache")
+{
+}
+
+PropagationCacheTestCase::~PropagationCacheTestCase()
+{
+}
+
+void
+PropagationCacheTestCase::DoRun()
+{
+    Ptr<MobilityModel> m[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        m[i] = CreateObject<ConstantPositionMobilityModel>();
+    }
+    Ptr<PathData> d01 = Create<PathData>();
+    Ptr<PathData> d02 = Create<PathData>();
+    Ptr<PathData> d12 = Create<PathData>();
+
+    // symmetric paths, evicted in LRU order
+    m_cache.SetMaxSize(2);
+    m_cache.AddPathData(d01, m[0], m[1], 0);
+    m_cache.AddPathData(d02, m[0], m[2], 0);
+    NS_TEST_EXPECT_MSG_EQ(m_cache.GetPathData(m[1], m[0], 0), d01, "Path 1 -> 0 not found");
+    NS_TEST_EXPECT_MSG_EQ(m_cache.GetPathData(m[0], m[1], 1), nullptr, "Wrong model UID found");
+    m_cache.AddPathData(d12, m[1], m[2], 0);
+    NS_TEST_EXPECT_MSG_EQ(m_cache.GetSize(), 2, "Cache size exceeded");
+    NS_TEST_EXPECT_MSG_EQ(m_cache.GetPathData(m[0], m[2], 0),
+                          nullptr,
+                          "Least recently used path not evicted");
+    NS_TEST_EXPECT_MSG_EQ(m_cache.GetPathData(m[0], m[1], 0), d01, "Path 0 -> 1 evicted");
+    NS_TEST_EXPECT_MSG_EQ(m_cache.GetPathData(m[2], m[1], 0), d12, "Path 2 -> 1 evicted");
+    m_cache.Cleanup();
+
+    // asymmetric paths, evicted when a node moves
+    m_cache.SetMaxSize(0);
+    m_cache.SetSymmetric(false);
+    m_cache.SetInvalidateOnMove(true);
+    m_cache.AddPathData(d01, m[0], m[1], 0);
+    NS_TEST_EXPECT_MSG_EQ(m_cache.GetPathData(m[1], m[0], 0), nullptr, "Path 1 -> 0 found");
+    m_cache.AddPathData(d02, m[0], m[2], 0);
+    m[2]->SetPosition(Vector(1, 0, 0));
+    NS_TEST_EXPECT_MSG_EQ(m_cache.GetPathData(m[0], m[1], 0), d01, "Path 0 -> 1 evicted");
+    NS_TEST_EXPECT_MSG_EQ(m_cache.GetPathData(m[0], m[2], 0), nullptr, "Path 0 -> 2 not evicted");
+    m_cache.Cleanup();
+
+    // paths evicted when unused for too long
+    m_cache.SetMaxAge(Seconds(1));
+    m_cache.AddPathData(d01, m[0], m[1], 0);
+    m_cache.AddPathData(d02, m[0], m[2], 0);
+    Simulator::Schedule(Seconds(0.75), [&]() {
+        NS_TEST_EXPECT_MSG_EQ(m_cache.GetPathData(m[0], m[1], 0), d01, "Path 0 -> 1 evicted");
+    });
+    Simulator::Schedule(Seconds(1.5), [&]() {
+        NS_TEST_EXPECT_MSG_EQ(m_cache.GetPathData(m[0], m[1], 0), d01, "Path 0 -> 1 evicted");
+        m_cache.AddPathData(d12, m[1], m[2], 0);
+        NS_TEST_EXPECT_MSG_EQ(m_cache.GetSize(), 2, "Path 0 -> 2 not evicted");
+    });
+    Simulator::Run();
+    m_cache.Cleanup();
+
+    Simulator::Destroy();
+}
+
+/**
+ * \ingroup propagation-tests
+ *
+ * \brief Test of the cache of the losses of a PropagationLossModel
+ */
+class PropagationLossModelCacheTestCase : public TestCase
+{
+  public:
+    PropagationLossModelCacheTestCase();
+    ~PropagationLossModelCacheTestCase() override;
+
+  private:
+    void DoRun() override;
+};
+
+PropagationLossModelCacheTestCase::PropagationLossModelCacheTestCase()
+    : TestCase("Test the cache of the losses of a PropagationLossModel")
+{
+}
+
+PropagationLossModelCacheTestCase::~PropagationLossModelCacheTestCase()
+{
+}
+
+void
+PropagationLossModelCacheTestCase::DoRun()
+{
+    Ptr<MobilityModel> m[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        m[i] = CreateObject<ConstantPositionMobilityModel>();
+        m[i]->SetPosition(Vector(10.0 * i, 0, 0));
+    }
+
+    // the same chain with and without cache
+    Ptr<LogDistancePropagationLossModel> reference =
+        CreateObject<LogDistancePropagationLossModel>();
+    reference->SetNext(CreateObject<FriisPropagationLossModel>());
+    Ptr<LogDistancePropagationLossModel> cached = CreateObject<LogDistancePropagationLossModel>();
+    cached->SetAttribute("LossCacheSize", UintegerValue(2));
+    Ptr<FriisPropagationLossModel> next = CreateObject<FriisPropagationLossModel>();
+    next->SetAttribute("LossCacheSize", UintegerValue(2));
+    cached->SetNext(next);
+
+    double tolerance = 1e-12;
+    for (int round = 0; round < 3; ++round)
+    {
+        for (int i = 0; i < 3; ++i)
+        {
+            for (int j = 0; j < 3; ++j)
+            {
+                if (i == j)
+                {
+                    continue;
+                }
+                double txPowerDbm = 10.0 * (i - j);
+                NS_TEST_EXPECT_MSG_EQ_TOL(cached->CalcRxPower(txPowerDbm, m[i], m[j]),
+                                          reference->CalcRxPower(txPowerDbm, m[i], m[j]),
+                                          tolerance,
+                                          "Wrong cached loss from " << i << " to " << j
+                                                                    << " in round " << round);
+            }
+        }
+        m[round]->SetPosition(Vector(10.0 * round, 5.0, 0));
+    }
+
+    Simulator::Destroy();
+}
+
 /**
  * \ingroup propagation-tests
  *
@@ -499,7 +825,10 @@ RangePropagationLossModelTestCase::DoRun()
  *   - TwoRayGroundPropagationLossModel
  *   - LogDistancePropagationLossModel
  *   - MatrixPropagationLossModel
+ *   - PrecomputedPropagationLossModel, on one and several threads
  *   - RangePropagationLossModel
+ *   - PropagationCache
+ *   - the cache of the losses of a PropagationLossModel
  */
 class PropagationLossModelsTestSuite : public TestSuite
 {
@@ -514,7 +843,11 @@ PropagationLossModelsTestSuite::PropagationLossModelsTestSuite()
     AddTestCase(new TwoRayGroundPropagationLossModelTestCase, TestCase::QUICK);
     AddTestCase(new LogDistancePropagationLossModelTestCase, TestCase::QUICK);
     AddTestCase(new MatrixPropagationLossModelTestCase, TestCase::QUICK);
+    AddTestCase(new PrecomputedPropagationLossModelTestCase, TestCase::QUICK);
+    AddTestCase(new PrecomputedPropagationLossModelThreadsTestCase, TestCase::QUICK);
     AddTestCase(new RangePropagationLossModelTestCase, TestCase::QUICK);
+    AddTestCase(new PropagationCacheTestCase, TestCase::QUICK);
+    AddTestCase(new PropagationLossModelCacheTestCase, TestCase::QUICK);
 }
 
 /// Static variable for test initialization
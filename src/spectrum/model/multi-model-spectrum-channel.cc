@@ -125,6 +125,7 @@ MultiModelSpectrumChannel::RemoveRx(Ptr<SpectrumPhy> phy)
         if (phyIt != rxInfoIterator->second.m_rxPhys.end())
         {
             rxInfoIterator->second.m_rxPhys.erase(phyIt);
+            rxInfoIterator->second.m_grid = nullptr;
             --m_numDevices;
             break; // there should be at most one entry
         }
@@ -186,6 +187,7 @@ MultiModelSpectrumChannel::AddRx(Ptr<SpectrumPhy> phy)
     {
         // spectrum model is already known, just add the device to the corresponding list
         rxInfoIterator->second.m_rxPhys.push_back(phy);
+        rxInfoIterator->second.m_grid = nullptr;
     }
 }
 
@@ -265,7 +267,8 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
     NS_LOG_LOGIC("converter map first element: "
                  << txInfoIteratorerator->second.m_spectrumConverterMap.begin()->first);
 
-    for (RxSpectrumModelInfoMap_t::const_iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin();
+    std::vector<uint32_t> inRange;
+    for (RxSpectrumModelInfoMap_t::iterator rxInfoIterator = m_rxSpectrumModelInfoMap.begin();
          rxInfoIterator != m_rxSpectrumModelInfoMap.end();
          ++rxInfoIterator)
     {
@@ -292,17 +295,20 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
             convertedTxPowerSpectrum = rxConverterIterator->second.Convert(txParams->psd);
         }
 
-        for (auto rxPhyIterator = rxInfoIterator->second.m_rxPhys.begin();
-             rxPhyIterator != rxInfoIterator->second.m_rxPhys.end();
-             ++rxPhyIterator)
+        const std::vector<Ptr<SpectrumPhy>>& rxPhys = rxInfoIterator->second.m_rxPhys;
+        bool culled =
+            GetRxPhysInRange(rxPhys, rxInfoIterator->second.m_grid, txMobility, inRange);
+        std::size_t nRx = culled ? inRange.size() : rxPhys.size();
+        for (std::size_t k = 0; k < nRx; ++k)
         {
-            NS_ASSERT_MSG((*rxPhyIterator)->GetRxSpectrumModel()->GetUid() == rxSpectrumModelUid,
+            Ptr<SpectrumPhy> rxPhy = rxPhys[culled ? inRange[k] : k];
+            NS_ASSERT_MSG(rxPhy->GetRxSpectrumModel()->GetUid() == rxSpectrumModelUid,
                           "SpectrumModel change was not notified to MultiModelSpectrumChannel "
                           "(i.e., AddRx should be called again after model is changed)");
 
-            if ((*rxPhyIterator) != txParams->txPhy)
+            if (rxPhy != txParams->txPhy)
             {
-                Ptr<NetDevice> rxNetDevice = (*rxPhyIterator)->GetDevice();
+                Ptr<NetDevice> rxNetDevice = rxPhy->GetDevice();
                 Ptr<NetDevice> txNetDevice = txParams->txPhy->GetDevice();
 
                 if (rxNetDevice && txNetDevice)
@@ -322,7 +328,7 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                 rxParams->psd = Copy<SpectrumValue>(convertedTxPowerSpectrum);
                 Time delay = MicroSeconds(0);
 
-                Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility();
+                Ptr<MobilityModel> receiverMobility = rxPhy->GetMobility();
 
                 if (txMobility && receiverMobility)
                 {
@@ -338,7 +344,7 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                         pathLossDb -= txAntennaGain;
                     }
                     Ptr<AntennaModel> rxAntenna =
-                        DynamicCast<AntennaModel>((*rxPhyIterator)->GetAntenna());
+                        DynamicCast<AntennaModel>(rxPhy->GetAntenna());
                     if (rxAntenna)
                     {
                         Angles rxAngles(txMobility->GetPosition(), receiverMobility->GetPosition());
@@ -362,7 +368,7 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                                 propagationGainDb,
                                 pathLossDb);
                     // Pathloss trace
-                    m_pathLossTrace(txParams->txPhy, *rxPhyIterator, pathLossDb);
+                    m_pathLossTrace(txParams->txPhy, rxPhy, pathLossDb);
                     if (pathLossDb > m_maxLossDb)
                     {
                         // beyond range
@@ -386,7 +392,7 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                                                    &MultiModelSpectrumChannel::StartRx,
                                                    this,
                                                    rxParams,
-                                                   *rxPhyIterator);
+                                                   rxPhy);
                 }
                 else
                 {
@@ -396,7 +402,7 @@ MultiModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                                         &MultiModelSpectrumChannel::StartRx,
                                         this,
                                         rxParams,
-                                        *rxPhyIterator);
+                                        rxPhy);
                 }
             }
         }
@@ -78,6 +78,7 @@ class RxSpectrumModelInfo
 
     Ptr<const SpectrumModel> m_rxSpectrumModel; //!< Rx Spectrum model.
     std::vector<Ptr<SpectrumPhy>> m_rxPhys;     //!< Container of the Rx Spectrum phy objects.
+    Ptr<SpatialGrid> m_grid; //!< Positions of the Rx Spectrum phy objects, when MaxRange is set.
 };
 
 /**
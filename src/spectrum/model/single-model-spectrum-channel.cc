@@ -21,6 +21,7 @@
 
 #include <ns3/angles.h>
 #include <ns3/antenna-model.h>
+#include <ns3/delivery-batch.h>
 #include <ns3/double.h>
 #include <ns3/log.h>
 #include <ns3/mobility-model.h>
@@ -54,6 +55,7 @@ SingleModelSpectrumChannel::DoDispose()
 {
     NS_LOG_FUNCTION(this);
     m_phyList.clear();
+    m_grid = nullptr;
     m_spectrumModel = nullptr;
     SpectrumChannel::DoDispose();
 }
@@ -77,6 +79,7 @@ SingleModelSpectrumChannel::RemoveRx(Ptr<SpectrumPhy> phy)
     if (it != std::end(m_phyList))
     {
         m_phyList.erase(it);
+        m_grid = nullptr;
     }
 }
 
@@ -85,6 +88,7 @@ SingleModelSpectrumChannel::AddRx(Ptr<SpectrumPhy> phy)
 {
     NS_LOG_FUNCTION(this << phy);
     m_phyList.push_back(phy);
+    m_grid = nullptr;
 }
 
 void
@@ -114,11 +118,15 @@ SingleModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
 
     Ptr<MobilityModel> senderMobility = txParams->txPhy->GetMobility();
 
-    for (PhyList::const_iterator rxPhyIterator = m_phyList.begin();
-         rxPhyIterator != m_phyList.end();
-         ++rxPhyIterator)
+    DeliveryBatch<SingleModelSpectrumChannel*, Ptr<SpectrumSignalParameters>, Ptr<SpectrumPhy>>
+        batch(&SingleModelSpectrumChannel::DeliverRx);
+    std::vector<uint32_t> inRange;
+    bool culled = GetRxPhysInRange(m_phyList, m_grid, senderMobility, inRange);
+    std::size_t nRx = culled ? inRange.size() : m_phyList.size();
+    for (std::size_t k = 0; k < nRx; ++k)
     {
-        Ptr<NetDevice> rxNetDevice = (*rxPhyIterator)->GetDevice();
+        Ptr<SpectrumPhy> rxPhy = m_phyList[culled ? inRange[k] : k];
+        Ptr<NetDevice> rxNetDevice = rxPhy->GetDevice();
         Ptr<NetDevice> txNetDevice = txParams->txPhy->GetDevice();
 
         if (rxNetDevice && txNetDevice)
@@ -132,11 +140,11 @@ SingleModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
             }
         }
 
-        if ((*rxPhyIterator) != txParams->txPhy)
+        if (rxPhy != txParams->txPhy)
         {
             Time delay = MicroSeconds(0);
 
-            Ptr<MobilityModel> receiverMobility = (*rxPhyIterator)->GetMobility();
+            Ptr<MobilityModel> receiverMobility = rxPhy->GetMobility();
             NS_LOG_LOGIC("copying signal parameters " << txParams);
             Ptr<SpectrumSignalParameters> rxParams = txParams->Copy();
 
@@ -154,7 +162,7 @@ SingleModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                     pathLossDb -= txAntennaGain;
                 }
                 Ptr<AntennaModel> rxAntenna =
-                    DynamicCast<AntennaModel>((*rxPhyIterator)->GetAntenna());
+                    DynamicCast<AntennaModel>(rxPhy->GetAntenna());
                 if (rxAntenna)
                 {
                     Angles rxAngles(senderMobility->GetPosition(), receiverMobility->GetPosition());
@@ -178,7 +186,7 @@ SingleModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
                             propagationGainDb,
                             pathLossDb);
                 // Pathloss trace
-                m_pathLossTrace(txParams->txPhy, *rxPhyIterator, pathLossDb);
+                m_pathLossTrace(txParams->txPhy, rxPhy, pathLossDb);
                 if (pathLossDb > m_maxLossDb)
                 {
                     // beyond range
@@ -197,25 +205,25 @@ SingleModelSpectrumChannel::StartTx(Ptr<SpectrumSignalParameters> txParams)
             {
                 // the receiver has a NetDevice, so we expect that it is attached to a Node
                 uint32_t dstNode = rxNetDevice->GetNode()->GetId();
-                Simulator::ScheduleWithContext(dstNode,
-                                               delay,
-                                               &SingleModelSpectrumChannel::StartRx,
-                                               this,
-                                               rxParams,
-                                               *rxPhyIterator);
+                batch.Add(dstNode, delay, this, rxParams, rxPhy);
             }
             else
             {
                 // the receiver is not attached to a NetDevice, so we cannot assume that it is
                 // attached to a node
-                Simulator::Schedule(delay,
-                                    &SingleModelSpectrumChannel::StartRx,
-                                    this,
-                                    rxParams,
-                                    *rxPhyIterator);
+                batch.Add(Simulator::GetContext(), delay, this, rxParams, rxPhy);
             }
         }
     }
+    batch.Schedule();
+}
+
+void
+SingleModelSpectrumChannel::DeliverRx(SingleModelSpectrumChannel* channel,
+                                      Ptr<SpectrumSignalParameters> params,
+                                      Ptr<SpectrumPhy> receiver)
+{
+    channel->StartRx(params, receiver);
 }
 
 void
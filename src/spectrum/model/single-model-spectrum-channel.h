@@ -33,6 +33,9 @@ namespace ns3
  * \brief SpectrumChannel implementation which handles a single spectrum model
  *
  * All SpectrumPhy layers attached to this SpectrumChannel
+ *
+ * The receptions of a signal which have the same propagation delay are
+ * scheduled as a single event, through a DeliveryBatch.
  */
 class SingleModelSpectrumChannel : public SpectrumChannel
 {
@@ -67,12 +70,27 @@ class SingleModelSpectrumChannel : public SpectrumChannel
      * \param receiver
      */
     void StartRx(Ptr<SpectrumSignalParameters> params, Ptr<SpectrumPhy> receiver);
+    /**
+     * Call StartRx on a channel, for the DeliveryBatch of the receptions of a signal.
+     *
+     * \param channel the channel
+     * \param params the signal parameters
+     * \param receiver the receiving SpectrumPhy
+     */
+    static void DeliverRx(SingleModelSpectrumChannel* channel,
+                          Ptr<SpectrumSignalParameters> params,
+                          Ptr<SpectrumPhy> receiver);
 
     /**
      * List of SpectrumPhy instances attached to the channel.
      */
     PhyList m_phyList;
 
+    /**
+     * The positions of the SpectrumPhy instances, indexed when MaxRange is set.
+     */
+    Ptr<SpatialGrid> m_grid;
+
     /**
      * SpectrumModel that this channel instance is supporting.
      */
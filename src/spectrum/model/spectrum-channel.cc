@@ -69,6 +69,21 @@ SpectrumChannel::GetTypeId()
                           DoubleValue(1.0e9),
                           MakeDoubleAccessor(&SpectrumChannel::m_maxLossDb),
                           MakeDoubleChecker<double>())
+            .AddAttribute("MaxRange",
+                          "If positive, the maximum distance in meters between "
+                          "the transmitter and the receiving PHYs to which "
+                          "transmissions are passed. The other PHYs are not "
+                          "evaluated at all: their propagation loss is not "
+                          "calculated and the Gain and PathLoss traces are not "
+                          "fired for them. The positions of the PHYs which do not "
+                          "move are indexed in a grid, so that the cost of a "
+                          "transmission depends on the number of PHYs within "
+                          "this range. Note that the default value corresponds to "
+                          "considering all PHYs, and that random propagation "
+                          "loss models draw different values when it is set.",
+                          DoubleValue(0),
+                          MakeDoubleAccessor(&SpectrumChannel::m_maxRange),
+                          MakeDoubleChecker<double>(0))
 
             .AddAttribute("PropagationLossModel",
                           "A pointer to the propagation loss model attached to this channel.",
@@ -173,4 +188,28 @@ SpectrumChannel::GetPropagationLossModel()
     return m_propagationLoss;
 }
 
+bool
+SpectrumChannel::GetRxPhysInRange(const std::vector<Ptr<SpectrumPhy>>& rxPhys,
+                                  Ptr<SpatialGrid>& grid,
+                                  Ptr<MobilityModel> txMobility,
+                                  std::vector<uint32_t>& indices) const
+{
+    NS_LOG_FUNCTION(this << txMobility);
+    if (m_maxRange <= 0 || !txMobility)
+    {
+        return false;
+    }
+    if (!grid)
+    {
+        grid = Create<SpatialGrid>(m_maxRange);
+        for (const auto& rxPhy : rxPhys)
+        {
+            grid->Add(rxPhy->GetMobility());
+        }
+    }
+    NS_ASSERT(grid->GetN() == rxPhys.size());
+    grid->GetWithinDistance(txMobility->GetPosition(), m_maxRange, indices);
+    return true;
+}
+
 } // namespace ns3
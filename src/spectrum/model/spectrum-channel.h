@@ -27,6 +27,7 @@
 #include <ns3/phased-array-spectrum-propagation-loss-model.h>
 #include <ns3/propagation-delay-model.h>
 #include <ns3/propagation-loss-model.h>
+#include <ns3/spatial-grid.h>
 #include <ns3/spectrum-phy.h>
 #include <ns3/spectrum-propagation-loss-model.h>
 #include <ns3/spectrum-signal-parameters.h>
@@ -187,6 +188,23 @@ class SpectrumChannel : public Channel
     typedef void (*SignalParametersTracedCallback)(Ptr<SpectrumSignalParameters> params);
 
   protected:
+    /**
+     * Find the receivers within MaxRange of a transmitter.
+     *
+     * \param [in] rxPhys The receivers.
+     * \param [in,out] grid The index of the positions of the receivers,
+     *        created if it is null.
+     * \param [in] txMobility The mobility model of the transmitter.
+     * \param [out] indices The indices in rxPhys of the receivers found, in
+     *        increasing order, including those without mobility model.
+     * \return \c false if all the receivers are to be considered, because
+     *         MaxRange is not set or the transmitter has no mobility model.
+     */
+    bool GetRxPhysInRange(const std::vector<Ptr<SpectrumPhy>>& rxPhys,
+                          Ptr<SpatialGrid>& grid,
+                          Ptr<MobilityModel> txMobility,
+                          std::vector<uint32_t>& indices) const;
+
     /**
      * The `PathLoss` trace source. Exporting the pointers to the Tx and Rx
      * SpectrumPhy and a pathloss value, in dB.
@@ -218,6 +236,14 @@ class SpectrumChannel : public Channel
      */
     double m_maxLossDb;
 
+    /**
+     * Maximum range [m].
+     *
+     * Any device beyond this distance is considered out of range,
+     * unless it is 0.
+     */
+    double m_maxRange;
+
     /**
      * Single-frequency propagation loss model to be used with this channel.
      */
@@ -22,6 +22,8 @@
 #include <ns3/math.h>
 #include <ns3/spectrum-value.h>
 
+#include <utility>
+
 namespace ns3
 {
 
@@ -100,46 +102,41 @@ SpectrumValue::ConstBandsEnd() const
 void
 SpectrumValue::Add(const SpectrumValue& x)
 {
-    Values::iterator it1 = m_values.begin();
-    Values::const_iterator it2 = x.m_values.begin();
-
     NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
     NS_ASSERT(m_values.size() == x.m_values.size());
 
-    while (it1 != m_values.end())
+    double* v = m_values.data();
+    const double* w = x.m_values.data();
+    const std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 += *it2;
-        ++it1;
-        ++it2;
+        v[i] += w[i];
     }
 }
 
 void
 SpectrumValue::Add(double s)
 {
-    Values::iterator it1 = m_values.begin();
-
-    while (it1 != m_values.end())
+    double* v = m_values.data();
+    const std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 += s;
-        ++it1;
+        v[i] += s;
     }
 }
 
 void
 SpectrumValue::Subtract(const SpectrumValue& x)
 {
-    Values::iterator it1 = m_values.begin();
-    Values::const_iterator it2 = x.m_values.begin();
-
     NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
     NS_ASSERT(m_values.size() == x.m_values.size());
 
-    while (it1 != m_values.end())
+    double* v = m_values.data();
+    const double* w = x.m_values.data();
+    const std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 -= *it2;
-        ++it1;
-        ++it2;
+        v[i] -= w[i];
     }
 }
 
@@ -152,46 +149,41 @@ SpectrumValue::Subtract(double s)
 void
 SpectrumValue::Multiply(const SpectrumValue& x)
 {
-    Values::iterator it1 = m_values.begin();
-    Values::const_iterator it2 = x.m_values.begin();
-
     NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
     NS_ASSERT(m_values.size() == x.m_values.size());
 
-    while (it1 != m_values.end())
+    double* v = m_values.data();
+    const double* w = x.m_values.data();
+    const std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 *= *it2;
-        ++it1;
-        ++it2;
+        v[i] *= w[i];
     }
 }
 
 void
 SpectrumValue::Multiply(double s)
 {
-    Values::iterator it1 = m_values.begin();
-
-    while (it1 != m_values.end())
+    double* v = m_values.data();
+    const std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 *= s;
-        ++it1;
+        v[i] *= s;
     }
 }
 
 void
 SpectrumValue::Divide(const SpectrumValue& x)
 {
-    Values::iterator it1 = m_values.begin();
-    Values::const_iterator it2 = x.m_values.begin();
-
     NS_ASSERT(m_spectrumModel == x.m_spectrumModel);
     NS_ASSERT(m_values.size() == x.m_values.size());
 
-    while (it1 != m_values.end())
+    double* v = m_values.data();
+    const double* w = x.m_values.data();
+    const std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 /= *it2;
-        ++it1;
-        ++it2;
+        v[i] /= w[i];
     }
 }
 
@@ -199,24 +191,22 @@ void
 SpectrumValue::Divide(double s)
 {
     NS_LOG_FUNCTION(this << s);
-    Values::iterator it1 = m_values.begin();
-
-    while (it1 != m_values.end())
+    double* v = m_values.data();
+    const std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 /= s;
-        ++it1;
+        v[i] /= s;
     }
 }
 
 void
 SpectrumValue::ChangeSign()
 {
-    Values::iterator it1 = m_values.begin();
-
-    while (it1 != m_values.end())
+    double* v = m_values.data();
+    const std::size_t n = m_values.size();
+    for (std::size_t i = 0; i < n; ++i)
     {
-        *it1 = -(*it1);
-        ++it1;
+        v[i] = -v[i];
     }
 }
 
@@ -429,9 +419,8 @@ operator+(double lhs, const SpectrumValue& rhs)
 SpectrumValue
 operator-(const SpectrumValue& lhs, const SpectrumValue& rhs)
 {
-    SpectrumValue res = rhs;
-    res.ChangeSign();
-    res.Add(lhs);
+    SpectrumValue res = lhs;
+    res.Subtract(rhs);
     return res;
 }
 
@@ -513,6 +502,83 @@ operator-(const SpectrumValue& rhs)
     return res;
 }
 
+SpectrumValue
+operator+(SpectrumValue&& lhs, const SpectrumValue& rhs)
+{
+    lhs.Add(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator+(SpectrumValue&& lhs, double rhs)
+{
+    lhs.Add(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator+(double lhs, SpectrumValue&& rhs)
+{
+    rhs.Add(lhs);
+    return std::move(rhs);
+}
+
+SpectrumValue
+operator-(SpectrumValue&& lhs, const SpectrumValue& rhs)
+{
+    lhs.Subtract(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator-(SpectrumValue&& lhs, double rhs)
+{
+    lhs.Subtract(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator*(SpectrumValue&& lhs, const SpectrumValue& rhs)
+{
+    lhs.Multiply(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator*(SpectrumValue&& lhs, double rhs)
+{
+    lhs.Multiply(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator*(double lhs, SpectrumValue&& rhs)
+{
+    rhs.Multiply(lhs);
+    return std::move(rhs);
+}
+
+SpectrumValue
+operator/(SpectrumValue&& lhs, const SpectrumValue& rhs)
+{
+    lhs.Divide(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator/(SpectrumValue&& lhs, double rhs)
+{
+    lhs.Divide(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+operator-(SpectrumValue&& rhs)
+{
+    rhs.ChangeSign();
+    return std::move(rhs);
+}
+
 SpectrumValue
 Pow(double lhs, const SpectrumValue& rhs)
 {
@@ -553,6 +619,41 @@ Log(const SpectrumValue& arg)
     return res;
 }
 
+SpectrumValue
+Pow(double lhs, SpectrumValue&& rhs)
+{
+    rhs.Exp(lhs);
+    return std::move(rhs);
+}
+
+SpectrumValue
+Pow(SpectrumValue&& lhs, double rhs)
+{
+    lhs.Pow(rhs);
+    return std::move(lhs);
+}
+
+SpectrumValue
+Log10(SpectrumValue&& arg)
+{
+    arg.Log10();
+    return std::move(arg);
+}
+
+SpectrumValue
+Log2(SpectrumValue&& arg)
+{
+    arg.Log2();
+    return std::move(arg);
+}
+
+SpectrumValue
+Log(SpectrumValue&& arg)
+{
+    arg.Log();
+    return std::move(arg);
+}
+
 SpectrumValue&
 SpectrumValue::operator+=(const SpectrumValue& rhs)
 {
@@ -55,6 +55,14 @@ typedef std::vector<double> Values;
  * The intended use of this class is to represent frequency-dependent
  * things, such as power spectral densities, frequency-dependent
  * propagation losses, spectral masks, etc.
+ *
+ * The values are stored contiguously, and the operations run over
+ * them in plain loops which the compiler can vectorize (e.g., GCC
+ * from -O3, as in the release builds). The operators
+ * whose operand is a temporary, such as the result of another
+ * operator, compute their result in the storage of that temporary:
+ * an expression such as a - b + c hence copies a single SpectrumValue,
+ * and makes a single pass over the values for each operator.
  */
 class SpectrumValue : public SimpleRefCount<SpectrumValue>
 {
@@ -301,6 +309,114 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue operator-(const SpectrumValue& rhs);
 
+    /**
+     *  addition operator, computed in the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator, a temporary
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs + rhs
+     */
+    friend SpectrumValue operator+(SpectrumValue&& lhs, const SpectrumValue& rhs);
+
+    /**
+     *  addition operator, computed in the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator, a temporary
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs + rhs
+     */
+    friend SpectrumValue operator+(SpectrumValue&& lhs, double rhs);
+
+    /**
+     *  addition operator, computed in the storage of rhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator, a temporary
+     *
+     * @return the value of lhs + rhs
+     */
+    friend SpectrumValue operator+(double lhs, SpectrumValue&& rhs);
+
+    /**
+     *  subtraction operator, computed in the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator, a temporary
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs - rhs
+     */
+    friend SpectrumValue operator-(SpectrumValue&& lhs, const SpectrumValue& rhs);
+
+    /**
+     *  subtraction operator, computed in the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator, a temporary
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs - rhs
+     */
+    friend SpectrumValue operator-(SpectrumValue&& lhs, double rhs);
+
+    /**
+     *  multiplication operator, computed in the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator, a temporary
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs * rhs
+     */
+    friend SpectrumValue operator*(SpectrumValue&& lhs, const SpectrumValue& rhs);
+
+    /**
+     *  multiplication operator, computed in the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator, a temporary
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs * rhs
+     */
+    friend SpectrumValue operator*(SpectrumValue&& lhs, double rhs);
+
+    /**
+     *  multiplication operator, computed in the storage of rhs
+     *
+     * @param lhs Left Hand Side of the operator
+     * @param rhs Right Hand Side of the operator, a temporary
+     *
+     * @return the value of lhs * rhs
+     */
+    friend SpectrumValue operator*(double lhs, SpectrumValue&& rhs);
+
+    /**
+     *  division operator, computed in the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator, a temporary
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs / rhs
+     */
+    friend SpectrumValue operator/(SpectrumValue&& lhs, const SpectrumValue& rhs);
+
+    /**
+     *  division operator, computed in the storage of lhs
+     *
+     * @param lhs Left Hand Side of the operator, a temporary
+     * @param rhs Right Hand Side of the operator
+     *
+     * @return the value of lhs / rhs
+     */
+    friend SpectrumValue operator/(SpectrumValue&& lhs, double rhs);
+
+    /**
+     * unary minus operator, computed in the storage of rhs
+     *
+     * @param rhs Right Hand Side of the operator, a temporary
+     * @return the value of - rhs
+     */
+    friend SpectrumValue operator-(SpectrumValue&& rhs);
+
     /**
      * left shift operator
      *
@@ -445,6 +561,14 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue Pow(const SpectrumValue& lhs, double rhs);
 
+    /**
+     * @param lhs the base, a temporary in whose storage the result is computed
+     * @param rhs the exponent
+     *
+     * @return each value in base raised to the exponent
+     */
+    friend SpectrumValue Pow(SpectrumValue&& lhs, double rhs);
+
     /**
      *
      * @param lhs the base
@@ -454,6 +578,14 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue Pow(double lhs, const SpectrumValue& rhs);
 
+    /**
+     * @param lhs the base
+     * @param rhs the exponent, a temporary in whose storage the result is computed
+     *
+     * @return the value in base raised to each value in the exponent
+     */
+    friend SpectrumValue Pow(double lhs, SpectrumValue&& rhs);
+
     /**
      *
      *
@@ -463,6 +595,13 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue Log10(const SpectrumValue& arg);
 
+    /**
+     * @param arg the argument, a temporary in whose storage the result is computed
+     *
+     * @return the logarithm in base 10 of all values in the argument
+     */
+    friend SpectrumValue Log10(SpectrumValue&& arg);
+
     /**
      *
      *
@@ -472,6 +611,13 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue Log2(const SpectrumValue& arg);
 
+    /**
+     * @param arg the argument, a temporary in whose storage the result is computed
+     *
+     * @return the logarithm in base 2 of all values in the argument
+     */
+    friend SpectrumValue Log2(SpectrumValue&& arg);
+
     /**
      *
      *
@@ -481,6 +627,13 @@ class SpectrumValue : public SimpleRefCount<SpectrumValue>
      */
     friend SpectrumValue Log(const SpectrumValue& arg);
 
+    /**
+     * @param arg the argument, a temporary in whose storage the result is computed
+     *
+     * @return the logarithm in base e of all values in the argument
+     */
+    friend SpectrumValue Log(SpectrumValue&& arg);
+
     /**
      *
      *
@@ -605,10 +758,15 @@ double Norm(const SpectrumValue& x);
 double Sum(const SpectrumValue& x);
 double Prod(const SpectrumValue& x);
 SpectrumValue Pow(const SpectrumValue& lhs, double rhs);
+SpectrumValue Pow(SpectrumValue&& lhs, double rhs);
 SpectrumValue Pow(double lhs, const SpectrumValue& rhs);
+SpectrumValue Pow(double lhs, SpectrumValue&& rhs);
 SpectrumValue Log10(const SpectrumValue& arg);
+SpectrumValue Log10(SpectrumValue&& arg);
 SpectrumValue Log2(const SpectrumValue& arg);
+SpectrumValue Log2(SpectrumValue&& arg);
 SpectrumValue Log(const SpectrumValue& arg);
+SpectrumValue Log(SpectrumValue&& arg);
 double Integral(const SpectrumValue& arg);
 
 } // namespace ns3
@@ -29,10 +29,13 @@
 #include "ns3/phased-array-model.h"
 #include "ns3/pointer.h"
 #include "ns3/string.h"
+#include "ns3/uinteger.h"
 #include <ns3/simulator.h>
 
 #include <algorithm>
+#include <atomic>
 #include <random>
+#include <thread>
 
 namespace ns3
 {
@@ -271,6 +274,9 @@ ThreeGppChannelModel::DoDispose()
     m_channelMatrixMap.clear();
     m_channelParamsMap.clear();
     m_channelConditionModel = nullptr;
+    m_precomputeEvent.Cancel();
+    m_links.clear();
+    m_linkRvs.clear();
 }
 
 TypeId
@@ -305,6 +311,15 @@ ThreeGppChannelModel::GetTypeId()
                           TimeValue(MilliSeconds(0)),
                           MakeTimeAccessor(&ThreeGppChannelModel::m_updatePeriod),
                           MakeTimeChecker())
+            .AddAttribute("PrecomputeThreads",
+                          "The number of threads generating again, at the end of each "
+                          "UpdatePeriod, the channels of the links which were looked up during "
+                          "it, or 0 to generate each channel when it is looked up. When it is "
+                          "not 0, each pair of nodes draws from its own substreams of the random "
+                          "variables, so that the channels do not depend on the number of threads",
+                          UintegerValue(0),
+                          MakeUintegerAccessor(&ThreeGppChannelModel::m_precomputeThreads),
+                          MakeUintegerChecker<uint32_t>())
             // attributes for the blockage model
             .AddAttribute("Blockage",
                           "Enable blockage model A (sec 7.6.4.1)",
@@ -1110,6 +1125,21 @@ ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
     Ptr<const ChannelCondition> condition =
         m_channelConditionModel->GetChannelCondition(aMob, bMob);
 
+    if (m_precomputeThreads > 0)
+    {
+        auto link = m_links.find(channelMatrixKey);
+        if (link != m_links.end())
+        {
+            link->second.m_active = true;
+        }
+        if (!m_updatePeriod.IsZero() && !m_precomputeEvent.IsRunning())
+        {
+            m_precomputeEvent = Simulator::Schedule(m_updatePeriod,
+                                                    &ThreeGppChannelModel::PrecomputeChannels,
+                                                    this);
+        }
+    }
+
     // Check if the channel is present in the map and return it, otherwise
     // generate a new channel
     bool updateParams = false;
@@ -1131,17 +1161,10 @@ ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
         notFoundParams = true;
     }
 
-    double x = aMob->GetPosition().x - bMob->GetPosition().x;
-    double y = aMob->GetPosition().y - bMob->GetPosition().y;
-    double distance2D = sqrt(x * x + y * y);
-
-    // NOTE we assume hUT = min (height(a), height(b)) and
-    // hBS = max (height (a), height (b))
-    double hUt = std::min(aMob->GetPosition().z, bMob->GetPosition().z);
-    double hBs = std::max(aMob->GetPosition().z, bMob->GetPosition().z);
+    LinkNodes nodes = GetLinkNodes(aMob, bMob);
 
     // get the 3GPP parameters
-    Ptr<const ParamsTable> table3gpp = GetThreeGppTable(condition, hBs, hUt, distance2D);
+    Ptr<const ParamsTable> table3gpp = GetThreeGppTable(condition, nodes);
 
     if (notFoundParams || updateParams)
     {
@@ -1153,7 +1176,10 @@ ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
         // shuffle all the arrays to perform random coupling
         // Step 9: Generate the cross polarization power ratios
         // Step 10: Draw initial phases
-        channelParams = GenerateChannelParameters(condition, table3gpp, aMob, bMob);
+        channelParams = GenerateChannelParameters(condition,
+                                                  table3gpp,
+                                                  nodes,
+                                                  GetRandomVariables(channelParamsKey));
         // store or replace the channel parameters
         m_channelParamsMap[channelParamsKey] = channelParams;
     }
@@ -1176,7 +1202,7 @@ ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
     if (notFoundMatrix || updateMatrix)
     {
         // channel matrix not found or has to be updated, generate a new one
-        channelMatrix = GetNewChannel(channelParams, table3gpp, aMob, bMob, aAntenna, bAntenna);
+        channelMatrix = GetNewChannel(channelParams, table3gpp, nodes, aAntenna, bAntenna);
         channelMatrix->m_antennaPair =
             std::make_pair(aAntenna->GetId(),
                            bAntenna->GetId()); // save antenna pair, with the exact order of s and u
@@ -1184,11 +1210,187 @@ ThreeGppChannelModel::GetChannel(Ptr<const MobilityModel> aMob,
 
         // store or replace the channel matrix in the channel map
         m_channelMatrixMap[channelMatrixKey] = channelMatrix;
+
+        if (m_precomputeThreads > 0)
+        {
+            // precompute the next channels in the same direction
+            m_links[channelMatrixKey] = {aMob, bMob, aAntenna, bAntenna, channelParamsKey, true};
+        }
     }
 
     return channelMatrix;
 }
 
+ThreeGppChannelModel::LinkNodes
+ThreeGppChannelModel::GetLinkNodes(Ptr<const MobilityModel> aMob, Ptr<const MobilityModel> bMob)
+{
+    return {aMob->GetObject<Node>()->GetId(),
+            bMob->GetObject<Node>()->GetId(),
+            aMob->GetPosition(),
+            bMob->GetPosition(),
+            Simulator::Now()};
+}
+
+Ptr<const ThreeGppChannelModel::ParamsTable>
+ThreeGppChannelModel::GetThreeGppTable(Ptr<const ChannelCondition> channelCondition,
+                                       const LinkNodes& nodes) const
+{
+    double x = nodes.m_aPos.x - nodes.m_bPos.x;
+    double y = nodes.m_aPos.y - nodes.m_bPos.y;
+    double distance2D = sqrt(x * x + y * y);
+
+    // NOTE we assume hUT = min (height(a), height(b)) and
+    // hBS = max (height (a), height (b))
+    double hUt = std::min(nodes.m_aPos.z, nodes.m_bPos.z);
+    double hBs = std::max(nodes.m_aPos.z, nodes.m_bPos.z);
+
+    return GetThreeGppTable(channelCondition, hBs, hUt, distance2D);
+}
+
+ThreeGppChannelModel::RandomVariables
+ThreeGppChannelModel::GetRandomVariables(uint64_t channelParamsKey)
+{
+    if (m_precomputeThreads == 0)
+    {
+        return {m_normalRv, m_uniformRv, m_uniformRvShuffle, m_uniformRvDoppler};
+    }
+    auto it = m_linkRvs.find(channelParamsKey);
+    if (it == m_linkRvs.end())
+    {
+        // the pairs of nodes get the substreams in the order in which they are first seen
+        uint64_t substream = m_linkRvs.size() + 1;
+        RandomVariables rvs{CreateObject<NormalRandomVariable>(),
+                            CreateObject<UniformRandomVariable>(),
+                            CreateObject<UniformRandomVariable>(),
+                            CreateObject<UniformRandomVariable>()};
+        rvs.m_normalRv->SetAttribute("Mean", DoubleValue(0.0));
+        rvs.m_normalRv->SetAttribute("Variance", DoubleValue(1.0));
+        rvs.m_normalRv->SetSubstream(m_normalRv, substream);
+        rvs.m_uniformRv->SetSubstream(m_uniformRv, substream);
+        rvs.m_uniformRvShuffle->SetSubstream(m_uniformRvShuffle, substream);
+        rvs.m_uniformRvDoppler->SetSubstream(m_uniformRvDoppler, substream);
+        it = m_linkRvs.emplace(channelParamsKey, rvs).first;
+    }
+    return it->second;
+}
+
+void
+ThreeGppChannelModel::PrecomputeChannels()
+{
+    NS_LOG_FUNCTION(this);
+
+    // The work of a pair of nodes: its channel params, and the channel
+    // matrices of its active links
+    struct Pair
+    {
+        uint64_t channelParamsKey;
+        Ptr<const ChannelCondition> condition;
+        LinkNodes nodes;
+        RandomVariables rvs;
+        Ptr<ThreeGppChannelParams> channelParams;
+        std::vector<std::pair<uint64_t, const Link*>> links;
+        std::vector<LinkNodes> linkNodes;
+        std::vector<Ptr<ChannelMatrix>> channelMatrices;
+    };
+
+    // The channel condition and mobility models are looked up on this thread,
+    // in the order of the keys of the links
+    std::vector<Pair> pairs;
+    std::unordered_map<uint64_t, std::size_t> pairIndex;
+    for (auto& [channelMatrixKey, link] : m_links)
+    {
+        if (!link.m_active)
+        {
+            continue;
+        }
+        link.m_active = false;
+        auto params = m_channelParamsMap.find(link.m_channelParamsKey);
+        if (params != m_channelParamsMap.end() &&
+            params->second->m_generatedTime == Simulator::Now())
+        {
+            continue;
+        }
+        auto it = pairIndex.find(link.m_channelParamsKey);
+        if (it == pairIndex.end())
+        {
+            Pair pair;
+            pair.channelParamsKey = link.m_channelParamsKey;
+            pair.condition = m_channelConditionModel->GetChannelCondition(link.m_aMob, link.m_bMob);
+            pair.nodes = GetLinkNodes(link.m_aMob, link.m_bMob);
+            pair.rvs = GetRandomVariables(link.m_channelParamsKey);
+            it = pairIndex.emplace(link.m_channelParamsKey, pairs.size()).first;
+            pairs.push_back(std::move(pair));
+        }
+        Pair& pair = pairs[it->second];
+        pair.links.emplace_back(channelMatrixKey, &link);
+        pair.linkNodes.push_back(GetLinkNodes(link.m_aMob, link.m_bMob));
+    }
+    if (pairs.empty())
+    {
+        // no link was looked up during the last period, the next lookup restarts the updates
+        return;
+    }
+
+    // Generate the channels of a pair of nodes, from its own random variables
+    auto generate = [this](Pair& pair) {
+        Ptr<const ParamsTable> table3gpp = GetThreeGppTable(pair.condition, pair.nodes);
+        pair.channelParams =
+            GenerateChannelParameters(pair.condition, table3gpp, pair.nodes, pair.rvs);
+        for (std::size_t i = 0; i < pair.links.size(); i++)
+        {
+            const Link* link = pair.links[i].second;
+            Ptr<ChannelMatrix> channelMatrix = GetNewChannel(pair.channelParams,
+                                                             table3gpp,
+                                                             pair.linkNodes[i],
+                                                             link->m_aAntenna,
+                                                             link->m_bAntenna);
+            channelMatrix->m_antennaPair =
+                std::make_pair(link->m_aAntenna->GetId(), link->m_bAntenna->GetId());
+            pair.channelMatrices.push_back(channelMatrix);
+        }
+    };
+
+    std::size_t nThreads = 1;
+#ifdef NS3_MTP
+    // a pair writes only its own channel params and matrices, and draws from
+    // its own substreams, but the pairs of a node share its antenna array,
+    // which they read through const methods while copying Ptr to it:
+    // SimpleRefCount only counts atomically in multithreaded builds
+    nThreads = std::min<std::size_t>(m_precomputeThreads, pairs.size());
+#endif
+    std::atomic<std::size_t> next{0};
+    auto work = [&pairs, &next, &generate]() {
+        for (std::size_t i = next++; i < pairs.size(); i = next++)
+        {
+            generate(pairs[i]);
+        }
+    };
+    std::vector<std::thread> threads;
+    for (std::size_t i = 1; i < nThreads; i++)
+    {
+        threads.emplace_back(work);
+    }
+    work();
+    for (auto& thread : threads)
+    {
+        thread.join();
+    }
+
+    for (const auto& pair : pairs)
+    {
+        m_channelParamsMap[pair.channelParamsKey] = pair.channelParams;
+        for (std::size_t i = 0; i < pair.links.size(); i++)
+        {
+            m_channelMatrixMap[pair.links[i].first] = pair.channelMatrices[i];
+        }
+    }
+    NS_LOG_DEBUG("Generated the channels of " << pairs.size() << " pairs of nodes on "
+                                              << nThreads << " threads");
+
+    m_precomputeEvent =
+        Simulator::Schedule(m_updatePeriod, &ThreeGppChannelModel::PrecomputeChannels, this);
+}
+
 Ptr<const MatrixBasedChannelModel::ChannelParams>
 ThreeGppChannelModel::GetParams(Ptr<const MobilityModel> aMob, Ptr<const MobilityModel> bMob) const
 {
@@ -1212,15 +1414,14 @@ ThreeGppChannelModel::GetParams(Ptr<const MobilityModel> aMob, Ptr<const Mobilit
 Ptr<ThreeGppChannelModel::ThreeGppChannelParams>
 ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition> channelCondition,
                                                 const Ptr<const ParamsTable> table3gpp,
-                                                const Ptr<const MobilityModel> aMob,
-                                                const Ptr<const MobilityModel> bMob) const
+                                                const LinkNodes& nodes,
+                                                const RandomVariables& rvs) const
 {
     NS_LOG_FUNCTION(this);
     // create a channel matrix instance
     Ptr<ThreeGppChannelParams> channelParams = Create<ThreeGppChannelParams>();
-    channelParams->m_generatedTime = Simulator::Now();
-    channelParams->m_nodeIds =
-        std::make_pair(aMob->GetObject<Node>()->GetId(), bMob->GetObject<Node>()->GetId());
+    channelParams->m_generatedTime = nodes.m_now;
+    channelParams->m_nodeIds = std::make_pair(nodes.m_aId, nodes.m_bId);
     channelParams->m_losCondition = channelCondition->GetLosCondition();
     channelParams->m_o2iCondition = channelCondition->GetO2iCondition();
 
@@ -1236,7 +1437,7 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
     // Generate paramNum independent LSPs.
     for (uint8_t iter = 0; iter < paramNum; iter++)
     {
-        LSPsIndep.push_back(m_normalRv->GetValue());
+        LSPsIndep.push_back(rvs.m_normalRv->GetValue());
     }
     for (uint8_t row = 0; row < paramNum; row++)
     {
@@ -1289,7 +1490,7 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
     double minTau = 100.0;
     for (uint8_t cIndex = 0; cIndex < table3gpp->m_numOfCluster; cIndex++)
     {
-        double tau = -1 * table3gpp->m_rTau * DS * log(m_uniformRv->GetValue(0, 1)); //(7.5-1)
+        double tau = -1 * table3gpp->m_rTau * DS * log(rvs.m_uniformRv->GetValue(0, 1)); //(7.5-1)
         if (minTau > tau)
         {
             minTau = tau;
@@ -1314,7 +1515,8 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
         double power =
             exp(-1 * clusterDelay[cIndex] * (table3gpp->m_rTau - 1) / table3gpp->m_rTau / DS) *
             pow(10,
-                -1 * m_normalRv->GetValue() * table3gpp->m_perClusterShadowingStd / 10); //(7.5-5)
+                -1 * rvs.m_normalRv->GetValue() * table3gpp->m_perClusterShadowingStd /
+                    10); //(7.5-5)
         powerSum += power;
         clusterPower.push_back(power);
     }
@@ -1492,31 +1694,31 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
         clusterZod.push_back(ZSD * angle);
     }
 
-    Angles sAngle(bMob->GetPosition(), aMob->GetPosition());
-    Angles uAngle(aMob->GetPosition(), bMob->GetPosition());
+    Angles sAngle(nodes.m_bPos, nodes.m_aPos);
+    Angles uAngle(nodes.m_aPos, nodes.m_bPos);
 
     for (uint8_t cIndex = 0; cIndex < channelParams->m_reducedClusterNumber; cIndex++)
     {
         int Xn = 1;
-        if (m_uniformRv->GetValue(0, 1) < 0.5)
+        if (rvs.m_uniformRv->GetValue(0, 1) < 0.5)
         {
             Xn = -1;
         }
-        clusterAoa[cIndex] = clusterAoa[cIndex] * Xn + (m_normalRv->GetValue() * ASA / 7) +
+        clusterAoa[cIndex] = clusterAoa[cIndex] * Xn + (rvs.m_normalRv->GetValue() * ASA / 7) +
                              RadiansToDegrees(uAngle.GetAzimuth()); //(7.5-11)
-        clusterAod[cIndex] = clusterAod[cIndex] * Xn + (m_normalRv->GetValue() * ASD / 7) +
+        clusterAod[cIndex] = clusterAod[cIndex] * Xn + (rvs.m_normalRv->GetValue() * ASD / 7) +
                              RadiansToDegrees(sAngle.GetAzimuth());
         if (channelCondition->IsO2i())
         {
             clusterZoa[cIndex] =
-                clusterZoa[cIndex] * Xn + (m_normalRv->GetValue() * ZSA / 7) + 90; //(7.5-16)
+                clusterZoa[cIndex] * Xn + (rvs.m_normalRv->GetValue() * ZSA / 7) + 90; //(7.5-16)
         }
         else
         {
-            clusterZoa[cIndex] = clusterZoa[cIndex] * Xn + (m_normalRv->GetValue() * ZSA / 7) +
+            clusterZoa[cIndex] = clusterZoa[cIndex] * Xn + (rvs.m_normalRv->GetValue() * ZSA / 7) +
                                  RadiansToDegrees(uAngle.GetInclination()); //(7.5-16)
         }
-        clusterZod[cIndex] = clusterZod[cIndex] * Xn + (m_normalRv->GetValue() * ZSD / 7) +
+        clusterZod[cIndex] = clusterZod[cIndex] * Xn + (rvs.m_normalRv->GetValue() * ZSD / 7) +
                              RadiansToDegrees(sAngle.GetInclination()) +
                              table3gpp->m_offsetZOD; //(7.5-19)
     }
@@ -1602,7 +1804,7 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
     DoubleVector attenuationDb;
     if (m_blockage)
     {
-        attenuationDb = CalcAttenuationOfBlockage(channelParams, clusterAoa, clusterZoa);
+        attenuationDb = CalcAttenuationOfBlockage(channelParams, clusterAoa, clusterZoa, rvs);
         for (uint8_t cInd = 0; cInd < channelParams->m_reducedClusterNumber; cInd++)
         {
             channelParams->m_clusterPower[cInd] =
@@ -1655,10 +1857,18 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
 
     for (uint8_t cIndex = 0; cIndex < channelParams->m_reducedClusterNumber; cIndex++)
     {
-        Shuffle(&rayAodRadian[cIndex][0], &rayAodRadian[cIndex][table3gpp->m_raysPerCluster]);
-        Shuffle(&rayAoaRadian[cIndex][0], &rayAoaRadian[cIndex][table3gpp->m_raysPerCluster]);
-        Shuffle(&rayZodRadian[cIndex][0], &rayZodRadian[cIndex][table3gpp->m_raysPerCluster]);
-        Shuffle(&rayZoaRadian[cIndex][0], &rayZoaRadian[cIndex][table3gpp->m_raysPerCluster]);
+        Shuffle(&rayAodRadian[cIndex][0],
+                &rayAodRadian[cIndex][table3gpp->m_raysPerCluster],
+                rvs.m_uniformRvShuffle);
+        Shuffle(&rayAoaRadian[cIndex][0],
+                &rayAoaRadian[cIndex][table3gpp->m_raysPerCluster],
+                rvs.m_uniformRvShuffle);
+        Shuffle(&rayZodRadian[cIndex][0],
+                &rayZodRadian[cIndex][table3gpp->m_raysPerCluster],
+                rvs.m_uniformRvShuffle);
+        Shuffle(&rayZoaRadian[cIndex][0],
+                &rayZoaRadian[cIndex][table3gpp->m_raysPerCluster],
+                rvs.m_uniformRvShuffle);
     }
 
     // store values
@@ -1682,11 +1892,12 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
             double uXprLinear = pow(10, table3gpp->m_uXpr / 10);     // convert to linear
             double sigXprLinear = pow(10, table3gpp->m_sigXpr / 10); // convert to linear
 
-            temp.push_back(std::pow(10, (m_normalRv->GetValue() * sigXprLinear + uXprLinear) / 10));
+            temp.push_back(
+                std::pow(10, (rvs.m_normalRv->GetValue() * sigXprLinear + uXprLinear) / 10));
             DoubleVector temp3; // used to store the PHI valuse
             for (uint8_t pInd = 0; pInd < 4; pInd++)
             {
-                temp3.push_back(m_uniformRv->GetValue(-1 * M_PI, M_PI));
+                temp3.push_back(rvs.m_uniformRv->GetValue(-1 * M_PI, M_PI));
             }
             temp2.push_back(temp3);
         }
@@ -1814,8 +2025,8 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
         double D = 0;
         if (cIndex != 0)
         {
-            alpha = m_uniformRvDoppler->GetValue(-1, 1);
-            D = m_uniformRvDoppler->GetValue(-m_vScatt, m_vScatt);
+            alpha = rvs.m_uniformRvDoppler->GetValue(-1, 1);
+            D = rvs.m_uniformRvDoppler->GetValue(-m_vScatt, m_vScatt);
         }
         dopplerTermAlpha.push_back(alpha);
         dopplerTermD.push_back(D);
@@ -1829,8 +2040,7 @@ ThreeGppChannelModel::GenerateChannelParameters(const Ptr<const ChannelCondition
 Ptr<MatrixBasedChannelModel::ChannelMatrix>
 ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelParams,
                                     Ptr<const ParamsTable> table3gpp,
-                                    const Ptr<const MobilityModel> sMob,
-                                    const Ptr<const MobilityModel> uMob,
+                                    const LinkNodes& nodes,
                                     Ptr<const PhasedArrayModel> sAntenna,
                                     Ptr<const PhasedArrayModel> uAntenna) const
 {
@@ -1840,10 +2050,9 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
 
     // create a channel matrix instance
     Ptr<ChannelMatrix> channelMatrix = Create<ChannelMatrix>();
-    channelMatrix->m_generatedTime = Simulator::Now();
+    channelMatrix->m_generatedTime = nodes.m_now;
     // save in which order is generated this matrix
-    channelMatrix->m_nodeIds =
-        std::make_pair(sMob->GetObject<Node>()->GetId(), uMob->GetObject<Node>()->GetId());
+    channelMatrix->m_nodeIds = std::make_pair(nodes.m_aId, nodes.m_bId);
     // check if channelParams structure is generated in direction s-to-u or u-to-s
     bool isSameDirection = (channelParams->m_nodeIds == channelMatrix->m_nodeIds);
 
@@ -1873,22 +2082,15 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
 
     // Step 11: Generate channel coefficients for each cluster n and each receiver
     //  and transmitter element pair u,s.
-    Complex3DVector hUsn; // channel coffecient hUsn[u][s][n];
     // where u and s are receive and transmit antenna element, n is cluster index.
     // NOTE Since each of the strongest 2 clusters are divided into 3 sub-clusters,
-    // the total cluster will be numReducedCLuster + 4.
+    // the total cluster will be numReducedCLuster + 4. The sub-clusters 2 and 3 of
+    // the strongest clusters follow the other clusters, in the order of the clusters.
     uint64_t uSize = uAntenna->GetNumberOfElements();
     uint64_t sSize = sAntenna->GetNumberOfElements();
-
-    hUsn.resize(uSize);
-    for (uint64_t uIndex = 0; uIndex < uSize; uIndex++)
-    {
-        hUsn[uIndex].resize(sSize);
-        for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
-        {
-            hUsn[uIndex][sIndex].resize(channelParams->m_reducedClusterNumber);
-        }
-    }
+    uint8_t numSubClusters = (channelParams->m_cluster1st == channelParams->m_cluster2nd) ? 2 : 4;
+    // channel coffecient hUsn(u, s, n);
+    Complex3DVector hUsn(uSize, sSize, channelParams->m_reducedClusterNumber + numSubClusters);
 
     NS_ASSERT(channelParams->m_reducedClusterNumber <= channelParams->m_clusterPhase.size());
     NS_ASSERT(channelParams->m_reducedClusterNumber <= channelParams->m_clusterPower.size());
@@ -1906,134 +2108,136 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
     NS_ASSERT(table3gpp->m_raysPerCluster <= rayAoaRadian[0].size());
     NS_ASSERT(table3gpp->m_raysPerCluster <= rayAodRadian[0].size());
 
-    double x = sMob->GetPosition().x - uMob->GetPosition().x;
-    double y = sMob->GetPosition().y - uMob->GetPosition().y;
+    double x = nodes.m_aPos.x - nodes.m_bPos.x;
+    double y = nodes.m_aPos.y - nodes.m_bPos.y;
     double distance2D = sqrt(x * x + y * y);
     // NOTE we assume hUT = min (height(a), height(b)) and
     // hBS = max (height (a), height (b))
-    double hUt = std::min(sMob->GetPosition().z, uMob->GetPosition().z);
-    double hBs = std::max(sMob->GetPosition().z, uMob->GetPosition().z);
+    double hUt = std::min(nodes.m_aPos.z, nodes.m_bPos.z);
+    double hBs = std::max(nodes.m_aPos.z, nodes.m_bPos.z);
     // compute the 3D distance using eq. 7.4-1
     double distance3D = std::sqrt(distance2D * distance2D + (hBs - hUt) * (hBs - hUt));
 
-    Angles sAngle(uMob->GetPosition(), sMob->GetPosition());
-    Angles uAngle(sMob->GetPosition(), uMob->GetPosition());
+    Angles sAngle(nodes.m_bPos, nodes.m_aPos);
+    Angles uAngle(nodes.m_aPos, nodes.m_bPos);
+
+    // The terms of a ray which only depend on the ray, on the receiver element u or on the
+    // transmitter element s are computed once per cluster, rather than for each pair u,s.
+    // The phases of the rays at the elements are the conjugates of the steering vectors toward
+    // the rays, and the arrays compute the steering vectors and field patterns of all the rays
+    // of a cluster at once.
+    uint8_t numRays = table3gpp->m_raysPerCluster;
+    std::vector<std::complex<double>> rayPolarization(numRays); // per ray
+    PhasedArrayModel::ComplexVector rxPhase;                    // per u element and ray
+    PhasedArrayModel::ComplexVector txPhase;                    // per s element and ray
+    std::vector<Angles> rxRayAngles;
+    std::vector<Angles> txRayAngles;
+    std::vector<Angles> rxFieldAngles;
+    std::vector<Angles> txFieldAngles;
+    rxRayAngles.reserve(numRays);
+    txRayAngles.reserve(numRays);
+    rxFieldAngles.reserve(numRays);
+    txFieldAngles.reserve(numRays);
+    uint8_t subClusterIndex = channelParams->m_reducedClusterNumber;
 
     // The following for loops computes the channel coefficients
-    for (uint64_t uIndex = 0; uIndex < uSize; uIndex++)
+    for (uint8_t nIndex = 0; nIndex < channelParams->m_reducedClusterNumber; nIndex++)
     {
-        Vector uLoc = uAntenna->GetElementLocation(uIndex);
+        // Compute the N-2 weakest cluster, assuming 0 slant angle and a
+        // polarization slant angle configured in the array (7.5-22), and
+        // the strongest clusters as 3 sub-clusters (7.5-28)
+        bool isStrongest =
+            (nIndex == channelParams->m_cluster1st || nIndex == channelParams->m_cluster2nd);
+
+        rxRayAngles.clear();
+        txRayAngles.clear();
+        rxFieldAngles.clear();
+        txFieldAngles.clear();
+        for (uint8_t mIndex = 0; mIndex < numRays; mIndex++)
+        {
+            rxRayAngles.emplace_back(rayAoaRadian[nIndex][mIndex], rayZoaRadian[nIndex][mIndex]);
+            txRayAngles.emplace_back(rayAodRadian[nIndex][mIndex], rayZodRadian[nIndex][mIndex]);
+            if (!isStrongest)
+            {
+                rxFieldAngles.emplace_back(channelParams->m_rayAoaRadian[nIndex][mIndex],
+                                           channelParams->m_rayZoaRadian[nIndex][mIndex]);
+                txFieldAngles.emplace_back(channelParams->m_rayAodRadian[nIndex][mIndex],
+                                           channelParams->m_rayZodRadian[nIndex][mIndex]);
+            }
+        }
+        // ZML:Just remind me that the angle offsets for the 3 subclusters were not
+        // generated correctly.
+        std::vector<std::pair<double, double>> rxFieldPatterns =
+            uAntenna->GetElementFieldPatterns(isStrongest ? rxRayAngles : rxFieldAngles);
+        std::vector<std::pair<double, double>> txFieldPatterns =
+            sAntenna->GetElementFieldPatterns(isStrongest ? txRayAngles : txFieldAngles);
+
+        for (uint8_t mIndex = 0; mIndex < numRays; mIndex++)
+        {
+            const DoubleVector& initialPhase = channelParams->m_clusterPhase[nIndex][mIndex];
+            NS_ASSERT(4 <= initialPhase.size());
+            double k = channelParams->m_crossPolarizationPowerRatios[nIndex][mIndex];
+
+            double rxFieldPatternPhi;
+            double rxFieldPatternTheta;
+            double txFieldPatternPhi;
+            double txFieldPatternTheta;
+            std::tie(rxFieldPatternPhi, rxFieldPatternTheta) = rxFieldPatterns[mIndex];
+            std::tie(txFieldPatternPhi, txFieldPatternTheta) = txFieldPatterns[mIndex];
+            rayPolarization[mIndex] =
+                std::complex<double>(cos(initialPhase[0]), sin(initialPhase[0])) *
+                    rxFieldPatternTheta * txFieldPatternTheta +
+                std::complex<double>(cos(initialPhase[1]), sin(initialPhase[1])) *
+                    std::sqrt(1 / k) * rxFieldPatternTheta * txFieldPatternPhi +
+                std::complex<double>(cos(initialPhase[2]), sin(initialPhase[2])) *
+                    std::sqrt(1 / k) * rxFieldPatternPhi * txFieldPatternTheta +
+                std::complex<double>(cos(initialPhase[3]), sin(initialPhase[3])) *
+                    rxFieldPatternPhi * txFieldPatternPhi;
+        }
 
-        for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
+        // lambda_0 is accounted in the antenna spacing of the arrays.
+        rxPhase = uAntenna->GetSteeringVectors(rxRayAngles);
+        txPhase = sAntenna->GetSteeringVectors(txRayAngles);
+        NS_ASSERT(rxPhase.size() == uSize * numRays && txPhase.size() == sSize * numRays);
+        for (auto& phase : rxPhase)
+        {
+            phase = std::conj(phase);
+        }
+        for (auto& phase : txPhase)
         {
-            Vector sLoc = sAntenna->GetElementLocation(sIndex);
+            phase = std::conj(phase);
+        }
+        // NOTE Doppler is computed in the CalcBeamformingGain function and is
+        // simplified to only account for the center angle of each cluster.
 
-            for (uint8_t nIndex = 0; nIndex < channelParams->m_reducedClusterNumber; nIndex++)
+        double rayAmplitude =
+            sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
+        for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
+        {
+            const std::complex<double>* txRayPhase = &txPhase[sIndex * numRays];
+            for (uint64_t uIndex = 0; uIndex < uSize; uIndex++)
             {
-                // Compute the N-2 weakest cluster, assuming 0 slant angle and a
-                // polarization slant angle configured in the array (7.5-22)
-                if (nIndex != channelParams->m_cluster1st && nIndex != channelParams->m_cluster2nd)
+                const std::complex<double>* rxRayPhase = &rxPhase[uIndex * numRays];
+                if (!isStrongest)
                 {
                     std::complex<double> rays(0, 0);
-                    for (uint8_t mIndex = 0; mIndex < table3gpp->m_raysPerCluster; mIndex++)
+                    for (uint8_t mIndex = 0; mIndex < numRays; mIndex++)
                     {
-                        DoubleVector initialPhase = channelParams->m_clusterPhase[nIndex][mIndex];
-                        double k = channelParams->m_crossPolarizationPowerRatios[nIndex][mIndex];
-                        // lambda_0 is accounted in the antenna spacing uLoc and sLoc.
-                        double rxPhaseDiff = 2 * M_PI *
-                                             (sin(rayZoaRadian[nIndex][mIndex]) *
-                                                  cos(rayAoaRadian[nIndex][mIndex]) * uLoc.x +
-                                              sin(rayZoaRadian[nIndex][mIndex]) *
-                                                  sin(rayAoaRadian[nIndex][mIndex]) * uLoc.y +
-                                              cos(rayZoaRadian[nIndex][mIndex]) * uLoc.z);
-
-                        double txPhaseDiff = 2 * M_PI *
-                                             (sin(rayZodRadian[nIndex][mIndex]) *
-                                                  cos(rayAodRadian[nIndex][mIndex]) * sLoc.x +
-                                              sin(rayZodRadian[nIndex][mIndex]) *
-                                                  sin(rayAodRadian[nIndex][mIndex]) * sLoc.y +
-                                              cos(rayZodRadian[nIndex][mIndex]) * sLoc.z);
-                        // NOTE Doppler is computed in the CalcBeamformingGain function and is
-                        // simplified to only account for the center angle of each cluster.
-
-                        double rxFieldPatternPhi;
-                        double rxFieldPatternTheta;
-                        double txFieldPatternPhi;
-                        double txFieldPatternTheta;
-                        std::tie(rxFieldPatternPhi, rxFieldPatternTheta) =
-                            uAntenna->GetElementFieldPattern(
-                                Angles(channelParams->m_rayAoaRadian[nIndex][mIndex],
-                                       channelParams->m_rayZoaRadian[nIndex][mIndex]));
-                        std::tie(txFieldPatternPhi, txFieldPatternTheta) =
-                            sAntenna->GetElementFieldPattern(
-                                Angles(channelParams->m_rayAodRadian[nIndex][mIndex],
-                                       channelParams->m_rayZodRadian[nIndex][mIndex]));
-                        NS_ASSERT(4 <= initialPhase.size());
-                        rays += (std::complex<double>(cos(initialPhase[0]), sin(initialPhase[0])) *
-                                     rxFieldPatternTheta * txFieldPatternTheta +
-                                 std::complex<double>(cos(initialPhase[1]), sin(initialPhase[1])) *
-                                     std::sqrt(1 / k) * rxFieldPatternTheta * txFieldPatternPhi +
-                                 std::complex<double>(cos(initialPhase[2]), sin(initialPhase[2])) *
-                                     std::sqrt(1 / k) * rxFieldPatternPhi * txFieldPatternTheta +
-                                 std::complex<double>(cos(initialPhase[3]), sin(initialPhase[3])) *
-                                     rxFieldPatternPhi * txFieldPatternPhi) *
-                                std::complex<double>(cos(rxPhaseDiff), sin(rxPhaseDiff)) *
-                                std::complex<double>(cos(txPhaseDiff), sin(txPhaseDiff));
+                        rays += rayPolarization[mIndex] * rxRayPhase[mIndex] * txRayPhase[mIndex];
                     }
-                    rays *=
-                        sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
-                    hUsn[uIndex][sIndex][nIndex] = rays;
+                    rays *= rayAmplitude;
+                    hUsn(uIndex, sIndex, nIndex) = rays;
                 }
-                else //(7.5-28)
+                else
                 {
                     std::complex<double> raysSub1(0, 0);
                     std::complex<double> raysSub2(0, 0);
                     std::complex<double> raysSub3(0, 0);
 
-                    for (uint8_t mIndex = 0; mIndex < table3gpp->m_raysPerCluster; mIndex++)
+                    for (uint8_t mIndex = 0; mIndex < numRays; mIndex++)
                     {
-                        double k = channelParams->m_crossPolarizationPowerRatios[nIndex][mIndex];
-
-                        // ZML:Just remind me that the angle offsets for the 3 subclusters were not
-                        // generated correctly.
-                        DoubleVector initialPhase = channelParams->m_clusterPhase[nIndex][mIndex];
-                        NS_ASSERT(4 <= initialPhase.size());
-
-                        double rxPhaseDiff = 2 * M_PI *
-                                             (sin(rayZoaRadian[nIndex][mIndex]) *
-                                                  cos(rayAoaRadian[nIndex][mIndex]) * uLoc.x +
-                                              sin(rayZoaRadian[nIndex][mIndex]) *
-                                                  sin(rayAoaRadian[nIndex][mIndex]) * uLoc.y +
-                                              cos(rayZoaRadian[nIndex][mIndex]) * uLoc.z);
-                        double txPhaseDiff = 2 * M_PI *
-                                             (sin(rayZodRadian[nIndex][mIndex]) *
-                                                  cos(rayAodRadian[nIndex][mIndex]) * sLoc.x +
-                                              sin(rayZodRadian[nIndex][mIndex]) *
-                                                  sin(rayAodRadian[nIndex][mIndex]) * sLoc.y +
-                                              cos(rayZodRadian[nIndex][mIndex]) * sLoc.z);
-
-                        double rxFieldPatternPhi;
-                        double rxFieldPatternTheta;
-                        double txFieldPatternPhi;
-                        double txFieldPatternTheta;
-                        std::tie(rxFieldPatternPhi, rxFieldPatternTheta) =
-                            uAntenna->GetElementFieldPattern(
-                                Angles(rayAoaRadian[nIndex][mIndex], rayZoaRadian[nIndex][mIndex]));
-                        std::tie(txFieldPatternPhi, txFieldPatternTheta) =
-                            sAntenna->GetElementFieldPattern(
-                                Angles(rayAodRadian[nIndex][mIndex], rayZodRadian[nIndex][mIndex]));
-
                         std::complex<double> raySub =
-                            (std::complex<double>(cos(initialPhase[0]), sin(initialPhase[0])) *
-                                 rxFieldPatternTheta * txFieldPatternTheta +
-                             std::complex<double>(cos(initialPhase[1]), sin(initialPhase[1])) *
-                                 sqrt(1 / k) * rxFieldPatternTheta * txFieldPatternPhi +
-                             std::complex<double>(cos(initialPhase[2]), sin(initialPhase[2])) *
-                                 sqrt(1 / k) * rxFieldPatternPhi * txFieldPatternTheta +
-                             std::complex<double>(cos(initialPhase[3]), sin(initialPhase[3])) *
-                                 rxFieldPatternPhi * txFieldPatternPhi) *
-                            std::complex<double>(cos(rxPhaseDiff), sin(rxPhaseDiff)) *
-                            std::complex<double>(cos(txPhaseDiff), sin(txPhaseDiff));
+                            rayPolarization[mIndex] * rxRayPhase[mIndex] * txRayPhase[mIndex];
 
                         switch (mIndex)
                         {
@@ -2056,80 +2260,79 @@ ThreeGppChannelModel::GetNewChannel(Ptr<const ThreeGppChannelParams> channelPara
                             break;
                         }
                     }
-                    raysSub1 *=
-                        sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
-                    raysSub2 *=
-                        sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
-                    raysSub3 *=
-                        sqrt(channelParams->m_clusterPower[nIndex] / table3gpp->m_raysPerCluster);
-                    hUsn[uIndex][sIndex][nIndex] = raysSub1;
-                    hUsn[uIndex][sIndex].push_back(raysSub2);
-                    hUsn[uIndex][sIndex].push_back(raysSub3);
+                    raysSub1 *= rayAmplitude;
+                    raysSub2 *= rayAmplitude;
+                    raysSub3 *= rayAmplitude;
+                    hUsn(uIndex, sIndex, nIndex) = raysSub1;
+                    hUsn(uIndex, sIndex, subClusterIndex) = raysSub2;
+                    hUsn(uIndex, sIndex, subClusterIndex + 1) = raysSub3;
                 }
             }
+        }
+        if (isStrongest)
+        {
+            subClusterIndex += 2;
+        }
+    }
 
-            if (channelParams->m_losCondition == ChannelCondition::LOS) //(7.5-29) && (7.5-30)
+    if (channelParams->m_losCondition == ChannelCondition::LOS) //(7.5-29) && (7.5-30)
+    {
+        double rxFieldPatternPhi;
+        double rxFieldPatternTheta;
+        double txFieldPatternPhi;
+        double txFieldPatternTheta;
+        std::tie(rxFieldPatternPhi, rxFieldPatternTheta) = uAntenna->GetElementFieldPattern(
+            Angles(uAngle.GetAzimuth(), uAngle.GetInclination()));
+        std::tie(txFieldPatternPhi, txFieldPatternTheta) = sAntenna->GetElementFieldPattern(
+            Angles(sAngle.GetAzimuth(), sAngle.GetInclination()));
+
+        double lambda = 3e8 / m_frequency; // the wavelength of the carrier frequency
+        double kLinear = pow(10, channelParams->m_K_factor / 10);
+
+        // the terms of the LOS ray which do not depend on the elements, and its phases at the
+        // elements, which are the conjugates of the steering vectors toward the other node
+        std::complex<double> losRay =
+            (rxFieldPatternTheta * txFieldPatternTheta - rxFieldPatternPhi * txFieldPatternPhi) *
+            std::complex<double>(cos(-2 * M_PI * distance3D / lambda),
+                                 sin(-2 * M_PI * distance3D / lambda));
+        PhasedArrayModel::ComplexVector rxLosPhase = uAntenna->GetSteeringVector(uAngle);
+        PhasedArrayModel::ComplexVector txLosPhase = sAntenna->GetSteeringVector(sAngle);
+        // the LOS path should be attenuated if blockage is enabled.
+        double losWeight =
+            sqrt(kLinear / (1 + kLinear)) / pow(10, channelParams->m_attenuation_dB[0] / 10);
+        double nlosWeight = sqrt(1 / (kLinear + 1));
+
+        for (uint64_t sIndex = 0; sIndex < sSize; sIndex++)
+        {
+            std::complex<double> txRay = losRay * std::conj(txLosPhase[sIndex]);
+            for (uint64_t uIndex = 0; uIndex < uSize; uIndex++)
             {
-                std::complex<double> ray(0, 0);
-                double rxPhaseDiff =
-                    2 * M_PI *
-                    (sin(uAngle.GetInclination()) * cos(uAngle.GetAzimuth()) * uLoc.x +
-                     sin(uAngle.GetInclination()) * sin(uAngle.GetAzimuth()) * uLoc.y +
-                     cos(uAngle.GetInclination()) * uLoc.z);
-                double txPhaseDiff =
-                    2 * M_PI *
-                    (sin(sAngle.GetInclination()) * cos(sAngle.GetAzimuth()) * sLoc.x +
-                     sin(sAngle.GetInclination()) * sin(sAngle.GetAzimuth()) * sLoc.y +
-                     cos(sAngle.GetInclination()) * sLoc.z);
-
-                double rxFieldPatternPhi;
-                double rxFieldPatternTheta;
-                double txFieldPatternPhi;
-                double txFieldPatternTheta;
-                std::tie(rxFieldPatternPhi, rxFieldPatternTheta) = uAntenna->GetElementFieldPattern(
-                    Angles(uAngle.GetAzimuth(), uAngle.GetInclination()));
-                std::tie(txFieldPatternPhi, txFieldPatternTheta) = sAntenna->GetElementFieldPattern(
-                    Angles(sAngle.GetAzimuth(), sAngle.GetInclination()));
-
-                double lambda = 3e8 / m_frequency; // the wavelength of the carrier frequency
-
-                ray = (rxFieldPatternTheta * txFieldPatternTheta -
-                       rxFieldPatternPhi * txFieldPatternPhi) *
-                      std::complex<double>(cos(-2 * M_PI * distance3D / lambda),
-                                           sin(-2 * M_PI * distance3D / lambda)) *
-                      std::complex<double>(cos(rxPhaseDiff), sin(rxPhaseDiff)) *
-                      std::complex<double>(cos(txPhaseDiff), sin(txPhaseDiff));
-
-                double kLinear = pow(10, channelParams->m_K_factor / 10);
-                // the LOS path should be attenuated if blockage is enabled.
-                hUsn[uIndex][sIndex][0] =
-                    sqrt(1 / (kLinear + 1)) * hUsn[uIndex][sIndex][0] +
-                    sqrt(kLinear / (1 + kLinear)) * ray /
-                        pow(10, channelParams->m_attenuation_dB[0] / 10); //(7.5-30) for tau = tau1
-                double tempSize = hUsn[uIndex][sIndex].size();
-                for (uint8_t nIndex = 1; nIndex < tempSize; nIndex++)
+                std::complex<double> ray = txRay * std::conj(rxLosPhase[uIndex]);
+
+                //(7.5-30) for tau = tau1
+                hUsn(uIndex, sIndex, 0) = nlosWeight * hUsn(uIndex, sIndex, 0) + losWeight * ray;
+                for (std::size_t nIndex = 1; nIndex < hUsn.GetNumPages(); nIndex++)
                 {
-                    hUsn[uIndex][sIndex][nIndex] *=
-                        sqrt(1 / (kLinear + 1)); //(7.5-30) for tau = tau2...taunN
+                    hUsn(uIndex, sIndex, nIndex) *= nlosWeight; //(7.5-30) for tau = tau2...taunN
                 }
             }
         }
     }
 
     NS_LOG_DEBUG("Husn (sAntenna, uAntenna):" << sAntenna->GetId() << ", " << uAntenna->GetId());
-    for (auto& i : hUsn)
+    for (std::size_t uIndex = 0; uIndex < hUsn.GetNumRows(); uIndex++)
     {
-        for (auto& j : i)
+        for (std::size_t sIndex = 0; sIndex < hUsn.GetNumCols(); sIndex++)
         {
-            for (auto& k : j)
+            for (std::size_t nIndex = 0; nIndex < hUsn.GetNumPages(); nIndex++)
             {
-                NS_LOG_DEBUG(" " << k << ",");
+                NS_LOG_DEBUG(" " << hUsn(uIndex, sIndex, nIndex) << ",");
             }
         }
     }
-    NS_LOG_INFO("size of coefficient matrix =[" << hUsn.size() << "][" << hUsn[0].size() << "]["
-                                                << hUsn[0][0].size() << "]");
-    channelMatrix->m_channel = hUsn;
+    NS_LOG_INFO("size of coefficient matrix =[" << hUsn.GetNumRows() << "][" << hUsn.GetNumCols()
+                                                << "][" << hUsn.GetNumPages() << "]");
+    channelMatrix->m_channel = std::move(hUsn);
     return channelMatrix;
 }
 
@@ -2158,7 +2361,8 @@ MatrixBasedChannelModel::DoubleVector
 ThreeGppChannelModel::CalcAttenuationOfBlockage(
     const Ptr<ThreeGppChannelModel::ThreeGppChannelParams> channelParams,
     const DoubleVector& clusterAOA,
-    const DoubleVector& clusterZOA) const
+    const DoubleVector& clusterZOA,
+    const RandomVariables& rvs) const
 {
     NS_LOG_FUNCTION(this);
 
@@ -2193,21 +2397,21 @@ ThreeGppChannelModel::CalcAttenuationOfBlockage(
         {
             // draw value from table 7.6.4.1-2 Blocking region parameters
             DoubleVector table;
-            table.push_back(m_normalRv->GetValue()); // phi_k: store the normal RV that will be
-                                                     // mapped to uniform (0,360) later.
+            table.push_back(rvs.m_normalRv->GetValue()); // phi_k: store the normal RV that will
+                                                         // be mapped to uniform (0,360) later.
             if (m_scenario == "InH-OfficeMixed" || m_scenario == "InH-OfficeOpen")
             {
-                table.push_back(m_uniformRv->GetValue(15, 45)); // x_k
-                table.push_back(90);                            // Theta_k
-                table.push_back(m_uniformRv->GetValue(5, 15));  // y_k
-                table.push_back(2);                             // r
+                table.push_back(rvs.m_uniformRv->GetValue(15, 45)); // x_k
+                table.push_back(90);                                // Theta_k
+                table.push_back(rvs.m_uniformRv->GetValue(5, 15));  // y_k
+                table.push_back(2);                                 // r
             }
             else
             {
-                table.push_back(m_uniformRv->GetValue(5, 15)); // x_k
-                table.push_back(90);                           // Theta_k
-                table.push_back(5);                            // y_k
-                table.push_back(10);                           // r
+                table.push_back(rvs.m_uniformRv->GetValue(5, 15)); // x_k
+                table.push_back(90);                               // Theta_k
+                table.push_back(5);                                // y_k
+                table.push_back(10);                               // r
             }
             channelParams->m_nonSelfBlocking.push_back(table);
         }
@@ -2274,7 +2478,7 @@ ThreeGppChannelModel::CalcAttenuationOfBlockage(
                 // Generate a new correlated normal RV with the following formula
                 channelParams->m_nonSelfBlocking[blockInd][PHI_INDEX] =
                     R * channelParams->m_nonSelfBlocking[blockInd][PHI_INDEX] +
-                    sqrt(1 - R * R) * m_normalRv->GetValue();
+                    sqrt(1 - R * R) * rvs.m_normalRv->GetValue();
             }
         }
     }
@@ -2406,11 +2610,11 @@ ThreeGppChannelModel::CalcAttenuationOfBlockage(
 }
 
 void
-ThreeGppChannelModel::Shuffle(double* first, double* last) const
+ThreeGppChannelModel::Shuffle(double* first, double* last, Ptr<UniformRandomVariable> rv) const
 {
     for (auto i = (last - first) - 1; i > 0; --i)
     {
-        std::swap(first[i], first[m_uniformRvShuffle->GetInteger(0, i)]);
+        std::swap(first[i], first[rv->GetInteger(0, i)]);
     }
 }
 
@@ -2422,6 +2626,8 @@ ThreeGppChannelModel::AssignStreams(int64_t stream)
     m_uniformRv->SetStream(stream + 1);
     m_uniformRvShuffle->SetStream(stream + 2);
     m_uniformRvDoppler->SetStream(stream + 3);
+    // the pairs of nodes draw from the substreams of the new streams
+    m_linkRvs.clear();
     return 4;
 }
 
@@ -24,12 +24,15 @@
 #include "ns3/angles.h"
 #include <ns3/boolean.h>
 #include <ns3/channel-condition-model.h>
+#include <ns3/event-id.h>
 #include <ns3/matrix-based-channel-model.h>
 #include <ns3/nstime.h>
 #include <ns3/object.h>
 #include <ns3/random-variable-stream.h>
+#include <ns3/vector.h>
 
 #include <complex.h>
+#include <map>
 #include <unordered_map>
 
 namespace ns3
@@ -44,6 +47,19 @@ class MobilityModel;
  * The class implements the channel matrix generation procedure
  * described in 3GPP TR 38.901.
  *
+ * By default, the channel of a link is generated when it is looked up by
+ * GetChannel, if it does not exist or it has expired. When the
+ * PrecomputeThreads attribute is set, the channels of the links which
+ * were looked up during an UpdatePeriod are generated again at its end,
+ * by that many threads; each pair of nodes then draws its channels from
+ * its own substreams of the random variables of the model, so that they
+ * do not depend on the number of threads nor on the order in which the
+ * links are generated. The pairs of a node share its antenna array,
+ * which GetNewChannel only reads; since the threads hold it and the
+ * channel conditions by Ptr, they are only used when ns-3 is built with
+ * multithreaded simulation. A subclass overriding GetNewChannel must not
+ * write to the model nor to the antennas either.
+ *
  * \see GetChannel
  */
 class ThreeGppChannelModel : public MatrixBasedChannelModel
@@ -155,12 +171,39 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
      */
     static std::pair<double, double> WrapAngles(double azimuthRad, double inclinationRad);
 
+    /**
+     * The random variables from which the channel of a pair of nodes is drawn
+     */
+    struct RandomVariables
+    {
+        Ptr<NormalRandomVariable> m_normalRv;   //!< normal random variable
+        Ptr<UniformRandomVariable> m_uniformRv; //!< uniform random variable
+        Ptr<UniformRandomVariable>
+            m_uniformRvShuffle; //!< uniform random variable used to shuffle arrays
+        Ptr<UniformRandomVariable>
+            m_uniformRvDoppler; //!< uniform random variable, used to compute the
+                                //!< additional Doppler contribution
+    };
+
+    /**
+     * The nodes of a link at the time its channel is generated
+     */
+    struct LinkNodes
+    {
+        uint32_t m_aId; //!< the id of the a node
+        uint32_t m_bId; //!< the id of the b node
+        Vector m_aPos;  //!< the position of the a node
+        Vector m_bPos;  //!< the position of the b node
+        Time m_now;     //!< the generation time
+    };
+
     /**
      * \brief Shuffle the elements of a simple sequence container of type double
      * \param first Pointer to the first element among the elements to be shuffled
      * \param last Pointer to the last element among the elements to be shuffled
+     * \param rv the uniform random variable drawn to shuffle the elements
      */
-    void Shuffle(double* first, double* last) const;
+    void Shuffle(double* first, double* last, Ptr<UniformRandomVariable> rv) const;
 
     /**
      * Extends the struct ChannelParams by including information that is used
@@ -275,16 +318,16 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
      * which is the return value of this function.
      * \param channelCondition the channel condition
      * \param table3gpp the 3gpp parameters from the table
-     * \param aMob the a node mobility model
-     * \param bMob the b node mobility model
+     * \param nodes the a and b nodes
+     * \param rvs the random variables to draw from
      * \return ThreeGppChannelParams structure with all the channel parameters generated
      * according 38.901 steps from 4 to 10.
      */
     Ptr<ThreeGppChannelParams> GenerateChannelParameters(
         const Ptr<const ChannelCondition> channelCondition,
         const Ptr<const ParamsTable> table3gpp,
-        const Ptr<const MobilityModel> aMob,
-        const Ptr<const MobilityModel> bMob) const;
+        const LinkNodes& nodes,
+        const RandomVariables& rvs) const;
 
     /**
      * Compute the channel matrix between two nodes a and b, and their
@@ -293,8 +336,7 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
      * \param channelParams the channel parameters previously generated for the pair of
      * nodes a and b
      * \param table3gpp the 3gpp parameters table
-     * \param sMob the mobility model of node s
-     * \param uMob the mobility model of node u
+     * \param nodes the s node, as node a, and the u node, as node b
      * \param sAntenna the antenna array of node s
      * \param uAntenna the antenna array of node u
      * \return the channel realization
@@ -302,8 +344,7 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
 
     virtual Ptr<ChannelMatrix> GetNewChannel(Ptr<const ThreeGppChannelParams> channelParams,
                                              Ptr<const ParamsTable> table3gpp,
-                                             const Ptr<const MobilityModel> sMob,
-                                             const Ptr<const MobilityModel> uMob,
+                                             const LinkNodes& nodes,
                                              Ptr<const PhasedArrayModel> sAntenna,
                                              Ptr<const PhasedArrayModel> uAntenna) const;
     /**
@@ -311,12 +352,14 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
      * \param channelParams the channel parameters structure
      * \param clusterAOA vector containing the azimuth angle of arrival for each cluster
      * \param clusterZOA vector containing the zenith angle of arrival for each cluster
+     * \param rvs the random variables to draw from
      * \return vector containing the power attenuation for each cluster
      */
     DoubleVector CalcAttenuationOfBlockage(
         const Ptr<ThreeGppChannelModel::ThreeGppChannelParams> channelParams,
         const DoubleVector& clusterAOA,
-        const DoubleVector& clusterZOA) const;
+        const DoubleVector& clusterZOA,
+        const RandomVariables& rvs) const;
 
     /**
      * Check if the channel params has to be updated
@@ -337,6 +380,38 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
     bool ChannelMatrixNeedsUpdate(Ptr<const ThreeGppChannelParams> channelParams,
                                   Ptr<const ChannelMatrix> channelMatrix);
 
+    /**
+     * Get the nodes of a link, as they are now
+     * \param aMob the mobility model of the a node
+     * \param bMob the mobility model of the b node
+     * \return the a and b nodes
+     */
+    static LinkNodes GetLinkNodes(Ptr<const MobilityModel> aMob, Ptr<const MobilityModel> bMob);
+
+    /**
+     * Get the parameters table of a link
+     * \param channelCondition the channel condition
+     * \param nodes the a and b nodes
+     * \return the parameters table
+     */
+    Ptr<const ParamsTable> GetThreeGppTable(Ptr<const ChannelCondition> channelCondition,
+                                            const LinkNodes& nodes) const;
+
+    /**
+     * Get the random variables from which the channel of a pair of nodes is
+     * drawn: those of the model, or the substreams of the pair if the
+     * channels are precomputed
+     * \param channelParamsKey the key of the pair of nodes
+     * \return the random variables
+     */
+    RandomVariables GetRandomVariables(uint64_t channelParamsKey);
+
+    /**
+     * Generate again the channels of the links which were looked up since
+     * the previous call, and schedule the next call after UpdatePeriod
+     */
+    void PrecomputeChannels();
+
     std::unordered_map<uint64_t, Ptr<ChannelMatrix>>
         m_channelMatrixMap; //!< map containing the channel realizations per pair of
                             //!< PhasedAntennaArray instances, the key of this map is reciprocal
@@ -361,6 +436,29 @@ class ThreeGppChannelModel : public MatrixBasedChannelModel
     Ptr<UniformRandomVariable> m_uniformRvDoppler; //!< uniform random variable, used to compute the
                                                    //!< additional Doppler contribution
 
+    /**
+     * A link whose channel is generated again at the end of each UpdatePeriod,
+     * if it was looked up during it
+     */
+    struct Link
+    {
+        Ptr<const MobilityModel> m_aMob;        //!< the mobility model of the a node
+        Ptr<const MobilityModel> m_bMob;        //!< the mobility model of the b node
+        Ptr<const PhasedArrayModel> m_aAntenna; //!< the antenna of the a node
+        Ptr<const PhasedArrayModel> m_bAntenna; //!< the antenna of the b node
+        uint64_t m_channelParamsKey;            //!< the key of the pair of nodes
+        bool m_active;                          //!< whether it was looked up since the last update
+    };
+
+    uint32_t m_precomputeThreads; //!< the number of threads generating the channels, or 0
+    std::map<uint64_t, Link>
+        m_links; //!< the links whose channel is precomputed, in the direction of their last
+                 //!< generation, indexed by the key of the channel matrix
+    std::map<uint64_t, RandomVariables>
+        m_linkRvs; //!< the substreams of the random variables drawn by each pair of nodes,
+                   //!< indexed by the key of the channel params
+    EventId m_precomputeEvent; //!< the event generating the channels of the active links
+
     // parameters for the blockage model
     bool m_blockage;               //!< enables the blockage model A
     uint16_t m_numNonSelfBlocking; //!< number of non-self-blocking regions
@@ -122,32 +122,41 @@ ThreeGppSpectrumPropagationLossModel::CalcLongTerm(
     uint16_t sAntenna = static_cast<uint16_t>(sW.size());
     uint16_t uAntenna = static_cast<uint16_t>(uW.size());
 
-    NS_ASSERT(uAntenna == params->m_channel.size());
-    NS_ASSERT(sAntenna == params->m_channel.at(0).size());
+    const MatrixBasedChannelModel::Complex3DVector& channel = params->m_channel;
+    NS_ASSERT(uAntenna == channel.GetNumRows());
+    NS_ASSERT(sAntenna == channel.GetNumCols());
 
     NS_LOG_DEBUG("CalcLongTerm with sAntenna " << sAntenna << " uAntenna " << uAntenna);
     // store the long term part to reduce computation load
     // only the small scale fading needs to be updated if the large scale parameters and antenna
     // weights remain unchanged.
-    PhasedArrayModel::ComplexVector longTerm;
-    uint8_t numCluster = static_cast<uint8_t>(params->m_channel[0][0].size());
+    std::size_t numCluster = channel.GetNumPages();
+    PhasedArrayModel::ComplexVector longTerm(numCluster);
 
-    NS_ASSERT(uAntenna == params->m_channel.size());
-    NS_ASSERT(sAntenna == params->m_channel.at(0).size());
-
-    for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+    // The elements of H for a cluster are contiguous, u being the fastest index. The complex
+    // products are expanded so that the loops do not call the library function handling the
+    // infinite and NaN operands.
+    for (std::size_t cIndex = 0; cIndex < numCluster; cIndex++)
     {
-        std::complex<double> txSum(0, 0);
+        const std::complex<double>* h = channel.GetPagePtr(cIndex);
+        double txSumRe = 0;
+        double txSumIm = 0;
         for (uint16_t sIndex = 0; sIndex < sAntenna; sIndex++)
         {
-            std::complex<double> rxSum(0, 0);
+            const std::complex<double>* hs = h + sIndex * uAntenna;
+            double rxSumRe = 0;
+            double rxSumIm = 0;
             for (uint16_t uIndex = 0; uIndex < uAntenna; uIndex++)
             {
-                rxSum = rxSum + uW[uIndex] * params->m_channel[uIndex][sIndex][cIndex];
+                rxSumRe += uW[uIndex].real() * hs[uIndex].real() -
+                           uW[uIndex].imag() * hs[uIndex].imag();
+                rxSumIm += uW[uIndex].real() * hs[uIndex].imag() +
+                           uW[uIndex].imag() * hs[uIndex].real();
             }
-            txSum = txSum + sW[sIndex] * rxSum;
+            txSumRe += sW[sIndex].real() * rxSumRe - sW[sIndex].imag() * rxSumIm;
+            txSumIm += sW[sIndex].real() * rxSumIm + sW[sIndex].imag() * rxSumRe;
         }
-        longTerm.push_back(txSum);
+        longTerm[cIndex] = std::complex<double>(txSumRe, txSumIm);
     }
     return longTerm;
 }
@@ -155,7 +164,7 @@ ThreeGppSpectrumPropagationLossModel::CalcLongTerm(
 Ptr<SpectrumValue>
 ThreeGppSpectrumPropagationLossModel::CalcBeamformingGain(
     Ptr<SpectrumValue> txPsd,
-    PhasedArrayModel::ComplexVector longTerm,
+    const PhasedArrayModel::ComplexVector& longTerm,
     Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix,
     Ptr<const MatrixBasedChannelModel::ChannelParams> channelParams,
     const ns3::Vector& sSpeed,
@@ -165,8 +174,8 @@ ThreeGppSpectrumPropagationLossModel::CalcBeamformingGain(
 
     Ptr<SpectrumValue> tempPsd = Copy<SpectrumValue>(txPsd);
 
-    // channel[rx][tx][cluster]
-    uint8_t numCluster = static_cast<uint8_t>(channelMatrix->m_channel[0][0].size());
+    // channel(rx, tx, cluster)
+    uint8_t numCluster = static_cast<uint8_t>(channelMatrix->m_channel.GetNumPages());
 
     // compute the doppler term
     // NOTE the update of Doppler is simplified by only taking the center angle of
@@ -174,6 +183,7 @@ ThreeGppSpectrumPropagationLossModel::CalcBeamformingGain(
     double slotTime = Simulator::Now().GetSeconds();
     double factor = 2 * M_PI * slotTime * GetFrequency() / 3e8;
     PhasedArrayModel::ComplexVector doppler;
+    doppler.reserve(numCluster);
 
     // The following asserts might seem paranoic, but it is important to
     // make sure that all the structures that are passed to this function
@@ -245,6 +255,18 @@ ThreeGppSpectrumPropagationLossModel::CalcBeamformingGain(
 
     NS_ASSERT(numCluster <= doppler.size());
 
+    // the product of the long term component and of the doppler term of each cluster, and the
+    // delay of each cluster, which do not depend on the sub-band
+    std::vector<double> gainRe(numCluster);
+    std::vector<double> gainIm(numCluster);
+    for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
+    {
+        std::complex<double> gain = longTerm[cIndex] * doppler[cIndex];
+        gainRe[cIndex] = gain.real();
+        gainIm[cIndex] = gain.imag();
+    }
+    const double* clusterDelay = channelParams->m_delay.data();
+
     // apply the doppler term and the propagation delay to the long term component
     // to obtain the beamforming gain
     auto vit = tempPsd->ValuesBegin();      // psd iterator
@@ -253,15 +275,18 @@ ThreeGppSpectrumPropagationLossModel::CalcBeamformingGain(
     {
         if ((*vit) != 0.00)
         {
-            std::complex<double> subsbandGain(0.0, 0.0);
+            double subsbandGainRe = 0;
+            double subsbandGainIm = 0;
             double fsb = (*sbit).fc; // center frequency of the sub-band
             for (uint8_t cIndex = 0; cIndex < numCluster; cIndex++)
             {
-                double delay = -2 * M_PI * fsb * (channelParams->m_delay[cIndex]);
-                subsbandGain = subsbandGain + longTerm[cIndex] * doppler[cIndex] *
-                                                  std::complex<double>(cos(delay), sin(delay));
+                double delay = -2 * M_PI * fsb * clusterDelay[cIndex];
+                double delayRe = cos(delay);
+                double delayIm = sin(delay);
+                subsbandGainRe += gainRe[cIndex] * delayRe - gainIm[cIndex] * delayIm;
+                subsbandGainIm += gainRe[cIndex] * delayIm + gainIm[cIndex] * delayRe;
             }
-            *vit = (*vit) * (norm(subsbandGain));
+            *vit = (*vit) * (subsbandGainRe * subsbandGainRe + subsbandGainIm * subsbandGainIm);
         }
         vit++;
         sbit++;
@@ -280,18 +305,16 @@ ThreeGppSpectrumPropagationLossModel::GetLongTerm(
 
     // check if the channel matrix was generated considering a as the s-node and
     // b as the u-node or viceversa
-    PhasedArrayModel::ComplexVector sW;
-    PhasedArrayModel::ComplexVector uW;
-    if (!channelMatrix->IsReverse(aPhasedArrayModel->GetId(), bPhasedArrayModel->GetId()))
-    {
-        sW = aPhasedArrayModel->GetBeamformingVector();
-        uW = bPhasedArrayModel->GetBeamformingVector();
-    }
-    else
+    Ptr<const PhasedArrayModel> sPhasedArrayModel = aPhasedArrayModel;
+    Ptr<const PhasedArrayModel> uPhasedArrayModel = bPhasedArrayModel;
+    if (channelMatrix->IsReverse(aPhasedArrayModel->GetId(), bPhasedArrayModel->GetId()))
     {
-        sW = bPhasedArrayModel->GetBeamformingVector();
-        uW = aPhasedArrayModel->GetBeamformingVector();
+        std::swap(sPhasedArrayModel, uPhasedArrayModel);
     }
+    // the beamforming vectors are identified by their unique identifiers, rather than
+    // compared with those used to compute the long term
+    uint64_t sWUid = sPhasedArrayModel->GetBeamformingVectorUid();
+    uint64_t uWUid = uPhasedArrayModel->GetBeamformingVectorUid();
 
     bool update = false;   // indicates whether the long term has to be updated
     bool notFound = false; // indicates if the long term has not been computed yet
@@ -301,17 +324,17 @@ ThreeGppSpectrumPropagationLossModel::GetLongTerm(
         MatrixBasedChannelModel::GetKey(aPhasedArrayModel->GetId(), bPhasedArrayModel->GetId());
 
     // look for the long term in the map and check if it is valid
-    if (m_longTermMap.find(longTermId) != m_longTermMap.end())
+    auto it = m_longTermMap.find(longTermId);
+    if (it != m_longTermMap.end())
     {
         NS_LOG_DEBUG("found the long term component in the map");
-        longTerm = m_longTermMap[longTermId]->m_longTerm;
+        longTerm = it->second->m_longTerm;
 
         // check if the channel matrix has been updated
         // or the s beam has been changed
         // or the u beam has been changed
-        update = (m_longTermMap[longTermId]->m_channel->m_generatedTime !=
-                      channelMatrix->m_generatedTime ||
-                  m_longTermMap[longTermId]->m_sW != sW || m_longTermMap[longTermId]->m_uW != uW);
+        update = (it->second->m_channel->m_generatedTime != channelMatrix->m_generatedTime ||
+                  it->second->m_sWUid != sWUid || it->second->m_uWUid != uWUid);
     }
     else
     {
@@ -323,14 +346,16 @@ ThreeGppSpectrumPropagationLossModel::GetLongTerm(
     {
         NS_LOG_DEBUG("compute the long term");
         // compute the long term component
-        longTerm = CalcLongTerm(channelMatrix, sW, uW);
+        longTerm = CalcLongTerm(channelMatrix,
+                                sPhasedArrayModel->GetBeamformingVectorRef(),
+                                uPhasedArrayModel->GetBeamformingVectorRef());
 
         // store the long term
         Ptr<LongTerm> longTermItem = Create<LongTerm>();
         longTermItem->m_longTerm = longTerm;
         longTermItem->m_channel = channelMatrix;
-        longTermItem->m_sW = sW;
-        longTermItem->m_uW = uW;
+        longTermItem->m_sWUid = sWUid;
+        longTermItem->m_uWUid = uWUid;
 
         m_longTermMap[longTermId] = longTermItem;
     }
@@ -135,10 +135,10 @@ class ThreeGppSpectrumPropagationLossModel : public PhasedArraySpectrumPropagati
             m_longTerm; //!< vector containing the long term component for each cluster
         Ptr<const MatrixBasedChannelModel::ChannelMatrix>
             m_channel; //!< pointer to the channel matrix used to compute the long term
-        PhasedArrayModel::ComplexVector
-            m_sW; //!< the beamforming vector for the node s used to compute the long term
-        PhasedArrayModel::ComplexVector
-            m_uW; //!< the beamforming vector for the node u used to compute the long term
+        uint64_t m_sWUid; //!< the identifier of the beamforming vector for the node s used to
+                          //!< compute the long term
+        uint64_t m_uWUid; //!< the identifier of the beamforming vector for the node u used to
+                          //!< compute the long term
     };
 
     /**
@@ -184,7 +184,7 @@ class ThreeGppSpectrumPropagationLossModel : public PhasedArraySpectrumPropagati
      */
     Ptr<SpectrumValue> CalcBeamformingGain(
         Ptr<SpectrumValue> txPsd,
-        PhasedArrayModel::ComplexVector longTerm,
+        const PhasedArrayModel::ComplexVector& longTerm,
         Ptr<const MatrixBasedChannelModel::ChannelMatrix> channelMatrix,
         Ptr<const MatrixBasedChannelModel::ChannelParams> channelParams,
         const Vector& sSpeed,
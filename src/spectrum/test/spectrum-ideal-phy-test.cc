@@ -20,6 +20,7 @@
 #include <ns3/adhoc-aloha-noack-ideal-phy-helper.h>
 #include <ns3/config.h>
 #include <ns3/data-rate.h>
+#include <ns3/double.h>
 #include <ns3/friis-spectrum-propagation-loss.h>
 #include <ns3/log.h>
 #include <ns3/math.h>
@@ -76,11 +77,13 @@ class SpectrumIdealPhyTestCase : public TestCase
      * \param phyRate PHY rate (bps)
      * \param rateIsAchievable Check if the rate is achievable
      * \param channelType Channel type
+     * \param maxRange MaxRange of the channel (m), or 0 to leave it unset
      */
     SpectrumIdealPhyTestCase(double snrLinear,
                              uint64_t phyRate,
                              bool rateIsAchievable,
-                             std::string channelType);
+                             std::string channelType,
+                             double maxRange = 0);
     ~SpectrumIdealPhyTestCase() override;
 
   private:
@@ -90,34 +93,48 @@ class SpectrumIdealPhyTestCase : public TestCase
      * \param channelType Channel type
      * \param snrLinear SNR (linear)
      * \param phyRate PHY rate (bps)
+     * \param maxRange MaxRange of the channel (m)
      * \return the test name
      */
-    static std::string Name(std::string channelType, double snrLinear, uint64_t phyRate);
+    static std::string Name(std::string channelType,
+                            double snrLinear,
+                            uint64_t phyRate,
+                            double maxRange);
 
     double m_snrLinear;        //!< SNR (linear)
     uint64_t m_phyRate;        //!< PHY rate (bps)
     bool m_rateIsAchievable;   //!< Check if the rate is achievable
     std::string m_channelType; //!< Channel type
+    double m_maxRange;         //!< MaxRange of the channel (m)
 };
 
 std::string
-SpectrumIdealPhyTestCase::Name(std::string channelType, double snrLinear, uint64_t phyRate)
+SpectrumIdealPhyTestCase::Name(std::string channelType,
+                               double snrLinear,
+                               uint64_t phyRate,
+                               double maxRange)
 {
     std::ostringstream oss;
     oss << channelType << " snr = " << snrLinear << " (linear), "
         << " phyRate = " << phyRate << " bps";
+    if (maxRange > 0)
+    {
+        oss << ", maxRange = " << maxRange << " m";
+    }
     return oss.str();
 }
 
 SpectrumIdealPhyTestCase::SpectrumIdealPhyTestCase(double snrLinear,
                                                    uint64_t phyRate,
                                                    bool rateIsAchievable,
-                                                   std::string channelType)
-    : TestCase(Name(channelType, snrLinear, phyRate)),
+                                                   std::string channelType,
+                                                   double maxRange)
+    : TestCase(Name(channelType, snrLinear, phyRate, maxRange)),
       m_snrLinear(snrLinear),
       m_phyRate(phyRate),
       m_rateIsAchievable(rateIsAchievable),
-      m_channelType(channelType)
+      m_channelType(channelType),
+      m_maxRange(maxRange)
 {
 }
 
@@ -160,7 +177,14 @@ SpectrumIdealPhyTestCase::DoRun()
     mobility.Install(c);
 
     SpectrumChannelHelper channelHelper;
-    channelHelper.SetChannel(m_channelType);
+    if (m_maxRange > 0)
+    {
+        channelHelper.SetChannel(m_channelType, "MaxRange", DoubleValue(m_maxRange));
+    }
+    else
+    {
+        channelHelper.SetChannel(m_channelType);
+    }
     channelHelper.SetPropagationDelay("ns3::ConstantSpeedPropagationDelayModel");
     Ptr<MatrixPropagationLossModel> propLoss = CreateObject<MatrixPropagationLossModel>();
     propLoss->SetLoss(c.Get(0)->GetObject<MobilityModel>(),
@@ -312,6 +336,25 @@ SpectrumIdealPhyTestSuite::SpectrumIdealPhyTestSuite()
                                                  "ns3::MultiModelSpectrumChannel"),
                     TestCase::QUICK);
     }
+    // The receiver, 5 m away from the transmitter, is culled by a shorter MaxRange
+    for (std::string channelType :
+         {"ns3::SingleModelSpectrumChannel", "ns3::MultiModelSpectrumChannel"})
+    {
+        double snr = 10;
+        double achievableRate = g_bandwidth * log2(1 + snr);
+        AddTestCase(new SpectrumIdealPhyTestCase(snr,
+                                                 static_cast<uint64_t>(achievableRate * 0.5),
+                                                 true,
+                                                 channelType,
+                                                 10),
+                    TestCase::QUICK);
+        AddTestCase(new SpectrumIdealPhyTestCase(snr,
+                                                 static_cast<uint64_t>(achievableRate * 0.5),
+                                                 false,
+                                                 channelType,
+                                                 4),
+                    TestCase::QUICK);
+    }
 }
 
 /// Static variable for test initialization
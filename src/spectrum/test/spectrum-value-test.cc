@@ -254,6 +254,34 @@ SpectrumValueTestSuite::SpectrumValueTestSuite()
     AddTestCase(new SpectrumValueTestCase(tv10b, v10, "tv10b = doubleValue div v1"),
                 TestCase::QUICK);
 
+    // The operators whose operand is a temporary compute their result in it
+    SpectrumValue tv3c = SpectrumValue(v1) + v2;
+    SpectrumValue tv4c = SpectrumValue(v1) - v2;
+    SpectrumValue tv5c = SpectrumValue(v1) * v2;
+    SpectrumValue tv6c = SpectrumValue(v1) / v2;
+    AddTestCase(new SpectrumValueTestCase(tv3c, v3, "tv3c = (v1) + v2"), TestCase::QUICK);
+    AddTestCase(new SpectrumValueTestCase(tv4c, v4, "tv4c = (v1) - v2"), TestCase::QUICK);
+    AddTestCase(new SpectrumValueTestCase(tv5c, v5, "tv5c = (v1) * v2"), TestCase::QUICK);
+    AddTestCase(new SpectrumValueTestCase(tv6c, v6, "tv6c = (v1) div v2"), TestCase::QUICK);
+
+    SpectrumValue tv7c = doubleValue + SpectrumValue(v1);
+    SpectrumValue tv8c = SpectrumValue(v1) - doubleValue;
+    SpectrumValue tv9c = doubleValue * SpectrumValue(v1);
+    SpectrumValue tv10c = SpectrumValue(v1) / doubleValue;
+    AddTestCase(new SpectrumValueTestCase(tv7c, v7, "tv7c = doubleValue + (v1)"), TestCase::QUICK);
+    AddTestCase(new SpectrumValueTestCase(tv8c, v8, "tv8c = (v1) - doubleValue"), TestCase::QUICK);
+    AddTestCase(new SpectrumValueTestCase(tv9c, v9, "tv9c = doubleValue * (v1)"), TestCase::QUICK);
+    AddTestCase(new SpectrumValueTestCase(tv10c, v10, "tv10c = (v1) div doubleValue"),
+                TestCase::QUICK);
+
+    SpectrumValue tv1d = (v1 - v2 + v2) * v2 / v2 - doubleValue + doubleValue;
+    SpectrumValue tv1e = -(-v1);
+    SpectrumValue tv1f = Log(Pow(2.718281828459045, v1 * 1.0));
+    AddTestCase(new SpectrumValueTestCase(tv1d, v1, "tv1d = chain of operators on v1"),
+                TestCase::QUICK);
+    AddTestCase(new SpectrumValueTestCase(tv1e, v1, "tv1e = -(-v1)"), TestCase::QUICK);
+    AddTestCase(new SpectrumValueTestCase(tv1f, v1, "tv1f = Log(Pow(e, v1))"), TestCase::QUICK);
+
     SpectrumValue v1ls3(f);
     SpectrumValue v1rs3(f);
     SpectrumValue tv1ls3(f);
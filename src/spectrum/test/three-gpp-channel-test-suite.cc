@@ -20,6 +20,7 @@
 #include "ns3/channel-condition-model.h"
 #include "ns3/config.h"
 #include "ns3/constant-position-mobility-model.h"
+#include "ns3/constant-velocity-mobility-model.h"
 #include "ns3/double.h"
 #include "ns3/isotropic-antenna-model.h"
 #include "ns3/log.h"
@@ -106,7 +107,7 @@ ThreeGppChannelMatrixComputationTest::DoComputeNorm(Ptr<ThreeGppChannelModel> ch
         channelModel->GetChannel(txMob, rxMob, txAntenna, rxAntenna);
 
     double channelNorm = 0;
-    uint8_t numTotClusters = channelMatrix->m_channel.at(0).at(0).size();
+    uint8_t numTotClusters = channelMatrix->m_channel.GetNumPages();
     for (uint8_t cIndex = 0; cIndex < numTotClusters; cIndex++)
     {
         double clusterNorm = 0;
@@ -115,8 +116,7 @@ ThreeGppChannelMatrixComputationTest::DoComputeNorm(Ptr<ThreeGppChannelModel> ch
             for (uint32_t uIndex = 0; uIndex < rxAntennaElements; uIndex++)
             {
                 clusterNorm +=
-                    std::pow(std::abs(channelMatrix->m_channel.at(uIndex).at(sIndex).at(cIndex)),
-                             2);
+                    std::pow(std::abs(channelMatrix->m_channel(uIndex, sIndex, cIndex)), 2);
             }
         }
         channelNorm += clusterNorm;
@@ -189,11 +189,11 @@ ThreeGppChannelMatrixComputationTest::DoRun()
 
     // check the channel matrix dimensions
     NS_TEST_ASSERT_MSG_EQ(
-        channelMatrix->m_channel.at(0).size(),
+        channelMatrix->m_channel.GetNumCols(),
         txAntennaElements[0] * txAntennaElements[1],
         "The second dimension of H should be equal to the number of tx antenna elements");
     NS_TEST_ASSERT_MSG_EQ(
-        channelMatrix->m_channel.size(),
+        channelMatrix->m_channel.GetNumRows(),
         rxAntennaElements[0] * rxAntennaElements[1],
         "The first dimension of H should be equal to the number of rx antenna elements");
 
@@ -435,6 +435,130 @@ ThreeGppChannelMatrixUpdateTest::DoRun()
     Simulator::Destroy();
 }
 
+/**
+ * \ingroup spectrum-tests
+ *
+ * Test case for the precomputation of the channels of ThreeGppChannelModel.
+ * 1) check if the channels of the links looked up during an update period are
+ *    generated again at its end
+ * 2) check if the channels do not depend on the number of threads generating them
+ */
+class ThreeGppChannelPrecomputeTest : public TestCase
+{
+  public:
+    /**
+     * Constructor
+     */
+    ThreeGppChannelPrecomputeTest();
+
+  private:
+    /**
+     * Build the test scenario
+     */
+    void DoRun() override;
+
+    /**
+     * Look up the channels of the links between a base station and some
+     * moving nodes every 40 ms, with an update period of 100 ms
+     * \param threads the number of threads generating the channels
+     * \return the channel matrices looked up, link by link and time by time
+     */
+    std::vector<Ptr<const ThreeGppChannelModel::ChannelMatrix>> GetChannels(uint32_t threads);
+
+    static const uint32_t N_NODES = 4;    //!< the number of nodes linked to the base station
+    static const uint32_t N_LOOKUPS = 10; //!< the number of lookups of each link
+};
+
+ThreeGppChannelPrecomputeTest::ThreeGppChannelPrecomputeTest()
+    : TestCase("Check the precomputation of the channels of the active links")
+{
+}
+
+std::vector<Ptr<const ThreeGppChannelModel::ChannelMatrix>>
+ThreeGppChannelPrecomputeTest::GetChannels(uint32_t threads)
+{
+    Ptr<ThreeGppChannelModel> channelModel = CreateObject<ThreeGppChannelModel>();
+    channelModel->SetAttribute("Frequency", DoubleValue(28.0e9));
+    channelModel->SetAttribute("Scenario", StringValue("UMi-StreetCanyon"));
+    channelModel->SetAttribute("ChannelConditionModel",
+                               PointerValue(CreateObject<AlwaysLosChannelConditionModel>()));
+    channelModel->SetAttribute("UpdatePeriod", TimeValue(MilliSeconds(100)));
+    channelModel->SetAttribute("PrecomputeThreads", UintegerValue(threads));
+    channelModel->AssignStreams(1);
+
+    NodeContainer nodes;
+    nodes.Create(N_NODES + 1);
+    std::vector<Ptr<MobilityModel>> mobs;
+    std::vector<Ptr<PhasedArrayModel>> antennas;
+    for (uint32_t i = 0; i <= N_NODES; i++)
+    {
+        Ptr<ConstantVelocityMobilityModel> mob = CreateObject<ConstantVelocityMobilityModel>();
+        if (i == 0)
+        {
+            mob->SetPosition(Vector(0.0, 0.0, 10.0));
+        }
+        else
+        {
+            mob->SetPosition(Vector(20.0 * i, 10.0 - 5.0 * i, 1.5));
+            mob->SetVelocity(Vector(i, 10.0 - i, 0.0));
+        }
+        nodes.Get(i)->AggregateObject(mob);
+        mobs.push_back(mob);
+        antennas.push_back(CreateObjectWithAttributes<UniformPlanarArray>(
+            "NumColumns",
+            UintegerValue(2),
+            "NumRows",
+            UintegerValue(i == 0 ? 2 : 1),
+            "AntennaElement",
+            PointerValue(CreateObject<IsotropicAntennaModel>())));
+    }
+
+    std::vector<Ptr<const ThreeGppChannelModel::ChannelMatrix>> channels;
+    for (uint32_t k = 0; k < N_LOOKUPS; k++)
+    {
+        Simulator::Schedule(MilliSeconds(1 + 40 * k), [&]() {
+            for (uint32_t i = 1; i <= N_NODES; i++)
+            {
+                channels.push_back(
+                    channelModel->GetChannel(mobs[0], mobs[i], antennas[0], antennas[i]));
+            }
+        });
+    }
+    Simulator::Run();
+    Simulator::Destroy();
+    return channels;
+}
+
+void
+ThreeGppChannelPrecomputeTest::DoRun()
+{
+    std::vector<Ptr<const ThreeGppChannelModel::ChannelMatrix>> oneThread = GetChannels(1);
+    std::vector<Ptr<const ThreeGppChannelModel::ChannelMatrix>> fourThreads = GetChannels(4);
+    NS_TEST_ASSERT_MSG_EQ(oneThread.size(), N_NODES * N_LOOKUPS, "Wrong number of lookups");
+    NS_TEST_ASSERT_MSG_EQ(fourThreads.size(), N_NODES * N_LOOKUPS, "Wrong number of lookups");
+
+    for (uint32_t k = 0; k < N_LOOKUPS; k++)
+    {
+        // the channel looked up at t was generated at the last end of an
+        // update period before t, at 1 + 100 * n ms
+        int64_t t = 1 + 40 * k;
+        Time generatedTime = MilliSeconds(1 + 100 * ((t - 2) / 100));
+        for (uint32_t i = 0; i < N_NODES; i++)
+        {
+            Ptr<const ThreeGppChannelModel::ChannelMatrix> h = oneThread[k * N_NODES + i];
+            NS_TEST_EXPECT_MSG_EQ(h->m_generatedTime,
+                                  generatedTime,
+                                  "The channel looked up at " << t << " ms was not precomputed");
+            NS_TEST_EXPECT_MSG_EQ(fourThreads[k * N_NODES + i]->m_generatedTime,
+                                  generatedTime,
+                                  "The channel looked up at " << t << " ms was not precomputed");
+            NS_TEST_EXPECT_MSG_EQ((fourThreads[k * N_NODES + i]->m_channel == h->m_channel),
+                                  true,
+                                  "The channel depends on the number of threads");
+        }
+    }
+}
+
 /**
  * \ingroup spectrum-tests
  * \brief A structure that holds the parameters for the function
@@ -702,6 +826,7 @@ ThreeGppChannelTestSuite::ThreeGppChannelTestSuite()
 {
     AddTestCase(new ThreeGppChannelMatrixComputationTest, TestCase::QUICK);
     AddTestCase(new ThreeGppChannelMatrixUpdateTest, TestCase::QUICK);
+    AddTestCase(new ThreeGppChannelPrecomputeTest, TestCase::QUICK);
     AddTestCase(new ThreeGppSpectrumPropagationLossModelTest, TestCase::QUICK);
 }
 
@@ -217,6 +217,18 @@ VisualSimulatorImpl::GetContext() const
     return m_simulator->GetContext();
 }
 
+void
+VisualSimulatorImpl::SetContext(uint32_t context)
+{
+    m_simulator->SetContext(context);
+}
+
+bool
+VisualSimulatorImpl::IsLocalContext(uint32_t context) const
+{
+    return m_simulator->IsLocalContext(context);
+}
+
 uint64_t
 VisualSimulatorImpl::GetEventCount() const
 {
@@ -20,18 +20,78 @@
 #include "error-rate-model.h"
 
 #include "wifi-tx-vector.h"
+#include "wifi-utils.h"
 
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/double.h"
 #include "ns3/dsss-error-rate-model.h"
+#include "ns3/log.h"
+#include "ns3/string.h"
+
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <limits>
+#include <random>
+#include <sstream>
+
+#ifdef NS3_MTP
+#include <mutex>
+#endif
 
 namespace ns3
 {
 
+NS_LOG_COMPONENT_DEFINE("ErrorRateModel");
+
 NS_OBJECT_ENSURE_REGISTERED(ErrorRateModel);
 
+static const double LOOKUP_TABLE_MIN_SNR_DB = -20; //!< lowest SNR of the lookup tables (dB)
+static const double LOOKUP_TABLE_MAX_SNR_DB = 70;  //!< highest SNR of the lookup tables (dB)
+static const double LOOKUP_TABLE_STEP_DB = 0.1;    //!< initial SNR step of the lookup tables (dB)
+static const int LOOKUP_TABLE_MAX_HALVINGS = 6;    //!< maximum number of halvings of the step
+
+/**
+ * \param csr the chunk success rate
+ * \param size the size of the chunk
+ * \return the logarithm of the chunk success rate, divided by the size
+ */
+static double
+LogCsrPerSize(double csr, double size)
+{
+    return std::max(std::log(csr), std::log(std::numeric_limits<double>::min())) / size;
+}
+
 TypeId
 ErrorRateModel::GetTypeId()
 {
-    static TypeId tid = TypeId("ns3::ErrorRateModel").SetParent<Object>().SetGroupName("Wifi");
+    static TypeId tid =
+        TypeId("ns3::ErrorRateModel")
+            .SetParent<Object>()
+            .SetGroupName("Wifi")
+            .AddAttribute("LookupTable",
+                          "Whether to interpolate the chunk success rates of the non-DSSS modes "
+                          "in tables, built at the first use of each mode, coding, number of RX "
+                          "antennas and size bucket, rather than to compute them",
+                          BooleanValue(false),
+                          MakeBooleanAccessor(&ErrorRateModel::m_lookupTable),
+                          MakeBooleanChecker())
+            .AddAttribute("LookupTableAccuracy",
+                          "The maximum absolute error of the interpolated chunk success rate of "
+                          "the reference size of a size bucket, in the middle of each SNR step "
+                          "of its lookup table",
+                          DoubleValue(1e-3),
+                          MakeDoubleAccessor(&ErrorRateModel::m_lookupTableAccuracy),
+                          MakeDoubleChecker<double>(0))
+            .AddAttribute("LookupTableFile",
+                          "The file from which the lookup tables are loaded at first use, and "
+                          "to which the tables built are saved, or empty to build them at every "
+                          "run. The models of a type using the same file share their tables.",
+                          StringValue(""),
+                          MakeStringAccessor(&ErrorRateModel::m_lookupTableFile),
+                          MakeStringChecker());
     return tid;
 }
 
@@ -87,6 +147,26 @@ ErrorRateModel::GetChunkSuccessRate(WifiMode mode,
             NS_ASSERT("undefined DSSS/HR-DSSS datarate");
         }
     }
+    else if (m_lookupTable && nbits > 0)
+    {
+        [[maybe_unused]] auto& tables = GetLookupTables();
+        {
+#ifdef NS3_MTP
+            // the models of other threads may share the tables
+            std::unique_lock lock{tables.mutex};
+#endif
+            const auto& table = GetLookupTable(mode, txVector, nbits, numRxAntennas, field, staId);
+            const auto& entries = table.logCsrPerSize;
+            double pos = (RatioToDb(snr) - table.minSnrDb) / table.stepDb;
+            if (pos >= 0 && pos < entries.size() - 1)
+            {
+                auto i = static_cast<std::size_t>(pos);
+                double logCsrPerSize = entries[i] + (pos - i) * (entries[i + 1] - entries[i]);
+                return std::exp(logCsrPerSize * GetLookupTableSize(mode, txVector, nbits));
+            }
+        }
+        return DoGetChunkSuccessRate(mode, txVector, snr, nbits, numRxAntennas, field, staId);
+    }
     else
     {
         return DoGetChunkSuccessRate(mode, txVector, snr, nbits, numRxAntennas, field, staId);
@@ -94,12 +174,277 @@ ErrorRateModel::GetChunkSuccessRate(WifiMode mode,
     return 0;
 }
 
+ErrorRateModel::LookupTables&
+ErrorRateModel::GetLookupTables() const
+{
+    if (!m_lookupTables)
+    {
+        std::string typeName = GetInstanceTypeId().GetName();
+        if (m_lookupTableFile.empty())
+        {
+            m_lookupTables = std::make_shared<LookupTables>();
+            m_lookupTables->typeName = typeName;
+        }
+        else
+        {
+            static std::map<std::pair<std::string, std::string>, std::weak_ptr<LookupTables>>
+                shared;
+#ifdef NS3_MTP
+            static std::mutex sharedMutex;
+            std::unique_lock lock{sharedMutex};
+#endif
+            auto& sharedTables = shared[{m_lookupTableFile, typeName}];
+            m_lookupTables = sharedTables.lock();
+            if (!m_lookupTables)
+            {
+                m_lookupTables = std::make_shared<LookupTables>();
+                m_lookupTables->typeName = typeName;
+                m_lookupTables->file = m_lookupTableFile;
+                LoadLookupTables(*m_lookupTables);
+                sharedTables = m_lookupTables;
+            }
+        }
+    }
+    return *m_lookupTables;
+}
+
+const ErrorRateModel::LookupTable&
+ErrorRateModel::GetLookupTable(WifiMode mode,
+                               const WifiTxVector& txVector,
+                               uint64_t nbits,
+                               uint8_t numRxAntennas,
+                               WifiPpduField field,
+                               uint16_t staId) const
+{
+    auto [bucket, bucketLast] = GetLookupTableBucket(nbits);
+    LookupTableKey key{mode.GetUid(), txVector.IsLdpc(), numRxAntennas, bucket};
+    auto it = m_lookupTables->tables.find(key);
+    if (it != m_lookupTables->tables.end() && it->second.accuracy <= m_lookupTableAccuracy)
+    {
+        return it->second;
+    }
+
+    LookupTableName name{mode.GetUniqueName(), txVector.IsLdpc(), numRxAntennas, bucket};
+    auto loaded = m_lookupTables->unmatched.find(name);
+    if (loaded != m_lookupTables->unmatched.end() &&
+        loaded->second.accuracy <= m_lookupTableAccuracy)
+    {
+        NS_LOG_DEBUG("Loaded the lookup table of " << mode << " for " << bucket << " bits");
+        auto& table = m_lookupTables->tables[key] = std::move(loaded->second);
+        m_lookupTables->unmatched.erase(loaded);
+        return table;
+    }
+    if (loaded != m_lookupTables->unmatched.end())
+    {
+        m_lookupTables->unmatched.erase(loaded);
+    }
+
+    uint64_t refBits = bucket + (bucketLast - bucket + 1) / 2;
+    auto& table = m_lookupTables->tables[key] =
+        BuildLookupTable(mode, txVector, refBits, numRxAntennas, field, staId);
+    if (!m_lookupTables->file.empty())
+    {
+        SaveLookupTables(*m_lookupTables);
+    }
+    return table;
+}
+
+ErrorRateModel::LookupTable
+ErrorRateModel::BuildLookupTable(WifiMode mode,
+                                 const WifiTxVector& txVector,
+                                 uint64_t refBits,
+                                 uint8_t numRxAntennas,
+                                 WifiPpduField field,
+                                 uint16_t staId) const
+{
+    NS_LOG_FUNCTION(this << mode << refBits << +numRxAntennas);
+    auto getCsr = [&](double snrDb) {
+        return DoGetChunkSuccessRate(mode,
+                                     txVector,
+                                     DbToRatio(snrDb),
+                                     refBits,
+                                     numRxAntennas,
+                                     field,
+                                     staId);
+    };
+
+    double refSize = GetLookupTableSize(mode, txVector, refBits);
+    LookupTable table;
+    table.modeName = mode.GetUniqueName();
+    table.accuracy = m_lookupTableAccuracy;
+    table.minSnrDb = LOOKUP_TABLE_MIN_SNR_DB;
+    table.stepDb = LOOKUP_TABLE_STEP_DB;
+    auto size = static_cast<std::size_t>(
+        std::lround((LOOKUP_TABLE_MAX_SNR_DB - LOOKUP_TABLE_MIN_SNR_DB) / LOOKUP_TABLE_STEP_DB) +
+        1);
+    for (std::size_t i = 0; i < size; i++)
+    {
+        double csr = getCsr(table.minSnrDb + i * table.stepDb);
+        table.logCsrPerSize.push_back(LogCsrPerSize(csr, refSize));
+    }
+
+    for (int halvings = 0;; halvings++)
+    {
+        // check the interpolation in the middle of each step
+        std::vector<double> middles;
+        double error = 0;
+        for (std::size_t i = 0; i + 1 < table.logCsrPerSize.size(); i++)
+        {
+            double csr = getCsr(table.minSnrDb + (i + 0.5) * table.stepDb);
+            double interpolated =
+                std::exp((table.logCsrPerSize[i] + table.logCsrPerSize[i + 1]) / 2 * refSize);
+            error = std::max(error, std::abs(interpolated - csr));
+            middles.push_back(LogCsrPerSize(csr, refSize));
+        }
+        if (error <= m_lookupTableAccuracy)
+        {
+            break;
+        }
+        if (halvings == LOOKUP_TABLE_MAX_HALVINGS)
+        {
+            NS_LOG_WARN("The lookup table of " << mode << " for " << refBits
+                                               << " bits has an error of " << error);
+            break;
+        }
+        // halve the step, the middles becoming entries
+        std::vector<double> entries;
+        for (std::size_t i = 0; i < table.logCsrPerSize.size(); i++)
+        {
+            entries.push_back(table.logCsrPerSize[i]);
+            if (i < middles.size())
+            {
+                entries.push_back(middles[i]);
+            }
+        }
+        table.logCsrPerSize.swap(entries);
+        table.stepDb /= 2;
+    }
+    NS_LOG_DEBUG("Built the lookup table of " << mode << " for " << refBits << " bits with "
+                                              << table.logCsrPerSize.size() << " entries");
+    return table;
+}
+
+void
+ErrorRateModel::LoadLookupTables(LookupTables& tables)
+{
+    std::ifstream is(tables.file);
+    if (!is.is_open())
+    {
+        NS_LOG_DEBUG("No lookup table file " << tables.file);
+        return;
+    }
+    // a line holds the type name, mode name, LDPC, number of RX antennas, lowest
+    // number of bits of the size bucket, accuracy, first SNR, SNR step and size
+    // of a table, then its entries
+    std::string line;
+    while (std::getline(is, line))
+    {
+        std::istringstream ls(line);
+        std::string typeName;
+        ls >> typeName;
+        if (typeName != tables.typeName)
+        {
+            continue;
+        }
+        LookupTable table;
+        bool ldpc;
+        uint16_t numRxAntennas;
+        uint64_t bucket;
+        std::size_t size;
+        ls >> table.modeName >> ldpc >> numRxAntennas >> bucket >> table.accuracy >>
+            table.minSnrDb >> table.stepDb >> size;
+        table.logCsrPerSize.resize(size);
+        for (auto& logCsrPerSize : table.logCsrPerSize)
+        {
+            ls >> logCsrPerSize;
+        }
+        NS_ABORT_MSG_IF(ls.fail() || table.minSnrDb != LOOKUP_TABLE_MIN_SNR_DB,
+                        "Malformed lookup table in " << tables.file << ": " << line);
+        LookupTableName name{table.modeName, ldpc, numRxAntennas, bucket};
+        tables.unmatched[name] = std::move(table);
+    }
+}
+
+void
+ErrorRateModel::SaveLookupTables(const LookupTables& tables)
+{
+#ifdef NS3_MTP
+    // the models of other threads may save the tables of other types to the same file
+    static std::mutex saveMutex;
+    std::unique_lock lock{saveMutex};
+#endif
+    // keep the tables of the other types
+    std::vector<std::string> lines;
+    std::ifstream is(tables.file);
+    std::string line;
+    while (std::getline(is, line))
+    {
+        if (!line.empty() &&
+            line.compare(0, tables.typeName.size() + 1, tables.typeName + " ") != 0)
+        {
+            lines.push_back(line);
+        }
+    }
+    is.close();
+
+    // write a temporary file in the same directory and rename it to the file, so
+    // that other simulations never read a partially written file
+    std::string tmpFile = tables.file + ".tmp." + std::to_string(std::random_device{}());
+    std::ofstream os(tmpFile);
+    NS_ABORT_MSG_IF(!os.is_open(), "Cannot write the lookup tables to " << tmpFile);
+    os << std::setprecision(std::numeric_limits<double>::max_digits10);
+    for (const auto& otherLine : lines)
+    {
+        os << otherLine << std::endl;
+    }
+    auto write = [&os, &tables](bool ldpc,
+                                uint8_t numRxAntennas,
+                                uint64_t bucket,
+                                const LookupTable& table) {
+        os << tables.typeName << " " << table.modeName << " " << ldpc << " " << +numRxAntennas
+           << " " << bucket << " " << table.accuracy << " " << table.minSnrDb << " "
+           << table.stepDb << " " << table.logCsrPerSize.size();
+        for (const auto& logCsrPerSize : table.logCsrPerSize)
+        {
+            os << " " << logCsrPerSize;
+        }
+        os << std::endl;
+    };
+    for (const auto& [key, table] : tables.tables)
+    {
+        write(std::get<1>(key), std::get<2>(key), std::get<3>(key), table);
+    }
+    for (const auto& [name, table] : tables.unmatched)
+    {
+        write(std::get<1>(name), std::get<2>(name), std::get<3>(name), table);
+    }
+    os.close();
+    NS_ABORT_MSG_IF(os.fail(), "Cannot write the lookup tables to " << tmpFile);
+    NS_ABORT_MSG_IF(std::rename(tmpFile.c_str(), tables.file.c_str()) != 0,
+                    "Cannot rename " << tmpFile << " to " << tables.file);
+}
+
 bool
 ErrorRateModel::IsAwgn() const
 {
     return true;
 }
 
+std::pair<uint64_t, uint64_t>
+ErrorRateModel::GetLookupTableBucket(uint64_t nbits) const
+{
+    uint64_t first = 1ULL << std::ilogb(static_cast<double>(nbits));
+    return {first, 2 * first - 1};
+}
+
+double
+ErrorRateModel::GetLookupTableSize(WifiMode mode,
+                                   const WifiTxVector& txVector,
+                                   uint64_t nbits) const
+{
+    return nbits;
+}
+
 int64_t
 ErrorRateModel::AssignStreams(int64_t stream)
 {
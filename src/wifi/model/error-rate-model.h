@@ -24,6 +24,16 @@
 
 #include "ns3/object.h"
 
+#include <map>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <vector>
+
+#ifdef NS3_MTP
+#include <mutex>
+#endif
+
 namespace ns3
 {
 
@@ -31,6 +41,15 @@ namespace ns3
  * \ingroup wifi
  * \brief the interface for Wifi's error models
  *
+ * When the LookupTable attribute is set, the chunk success rates of the
+ * non-DSSS modes are interpolated in tables rather than computed by the
+ * subclass. A table is built at the first use of a mode, coding, number of
+ * RX antennas and size bucket, over a range of SNRs, with a step small
+ * enough for the interpolated chunk success rate of the reference size of
+ * the bucket to be within LookupTableAccuracy of the exact one in the
+ * middle of each step. Within a bucket, the logarithm of the chunk success
+ * rate is taken as proportional to the size of the chunk, which is exact for
+ * the models computing the chunk success rate from a bit error rate.
  */
 class ErrorRateModel : public Object
 {
@@ -102,7 +121,139 @@ class ErrorRateModel : public Object
      */
     virtual int64_t AssignStreams(int64_t stream);
 
+  protected:
+    /**
+     * Get the size bucket of a chunk, whose chunks share a lookup table. The
+     * buckets are [2^b, 2^(b+1)) bits. A subclass whose chunk success rate
+     * changes abruptly at some size splits the bucket of this size.
+     *
+     * \param nbits the number of bits in the chunk
+     * \return the lowest and the highest number of bits of the bucket
+     */
+    virtual std::pair<uint64_t, uint64_t> GetLookupTableBucket(uint64_t nbits) const;
+
+    /**
+     * Get the size of a chunk, to which the logarithm of its chunk success
+     * rate is taken as proportional within its size bucket. It is the number
+     * of bits, unless the subclass computes the chunk success rate from a
+     * coarser size.
+     *
+     * \param mode the Wi-Fi mode applicable to the chunk
+     * \param txVector TXVECTOR of the overall transmission
+     * \param nbits the number of bits in the chunk
+     * \return the size of the chunk
+     */
+    virtual double GetLookupTableSize(WifiMode mode,
+                                      const WifiTxVector& txVector,
+                                      uint64_t nbits) const;
+
   private:
+    /**
+     * The mode UID, whether LDPC is used, the number of RX antennas and the
+     * lowest number of bits of the size bucket of a lookup table
+     */
+    typedef std::tuple<uint32_t, bool, uint8_t, uint64_t> LookupTableKey;
+
+    /**
+     * The mode name, whether LDPC is used, the number of RX antennas and the
+     * lowest number of bits of the size bucket of a lookup table loaded from a file
+     */
+    typedef std::tuple<std::string, bool, uint8_t, uint64_t> LookupTableName;
+
+    /**
+     * The chunk success rates of the reference size of a size bucket,
+     * tabulated over the SNR
+     */
+    struct LookupTable
+    {
+        std::string modeName;             //!< the unique name of the mode
+        double accuracy;                  //!< the accuracy the table was built for
+        double minSnrDb;                  //!< the SNR of the first entry (dB)
+        double stepDb;                    //!< the SNR step between two entries (dB)
+        std::vector<double> logCsrPerSize; //!< the logarithm of the chunk success rate of the
+                                           //!< reference size, divided by this size
+    };
+
+    /**
+     * The lookup tables of a model, shared by the models of the same type
+     * using the same file
+     */
+    struct LookupTables
+    {
+        std::string typeName;                             //!< the name of the type of the model
+        std::string file;                                 //!< the file, or empty
+        std::map<LookupTableKey, LookupTable> tables;     //!< the tables in use
+        std::map<LookupTableName, LookupTable> unmatched; //!< the tables loaded from the file
+                                                          //!< whose mode has not been used yet
+#ifdef NS3_MTP
+        std::mutex mutex; //!< guards the tables, which the models of several threads may share
+#endif
+    };
+
+    /**
+     * Get the lookup tables of the model, loading them from their file or
+     * sharing them with the models of the same type using the same file at
+     * first use.
+     *
+     * \return the lookup tables
+     */
+    LookupTables& GetLookupTables() const;
+
+    /**
+     * Get the lookup table of a chunk, building it if needed. The caller
+     * holds the mutex of the lookup tables in multithreaded simulations.
+     *
+     * \param mode the Wi-Fi mode applicable to this chunk
+     * \param txVector TXVECTOR of the overall transmission
+     * \param nbits the number of bits in this chunk
+     * \param numRxAntennas the number of active RX antennas
+     * \param field the PPDU field to which the chunk belongs to
+     * \param staId the station ID for MU
+     *
+     * \return the lookup table
+     */
+    const LookupTable& GetLookupTable(WifiMode mode,
+                                      const WifiTxVector& txVector,
+                                      uint64_t nbits,
+                                      uint8_t numRxAntennas,
+                                      WifiPpduField field,
+                                      uint16_t staId) const;
+
+    /**
+     * Build the lookup table of a chunk.
+     *
+     * \param mode the Wi-Fi mode applicable to this chunk
+     * \param txVector TXVECTOR of the overall transmission
+     * \param refBits the reference size of the size bucket of the chunk
+     * \param numRxAntennas the number of active RX antennas
+     * \param field the PPDU field to which the chunk belongs to
+     * \param staId the station ID for MU
+     *
+     * \return the lookup table
+     */
+    LookupTable BuildLookupTable(WifiMode mode,
+                                 const WifiTxVector& txVector,
+                                 uint64_t refBits,
+                                 uint8_t numRxAntennas,
+                                 WifiPpduField field,
+                                 uint16_t staId) const;
+
+    /**
+     * Load the lookup tables of the type of a model from their file.
+     *
+     * \param tables the lookup tables
+     */
+    static void LoadLookupTables(LookupTables& tables);
+
+    /**
+     * Save the lookup tables of the type of a model to their file, keeping
+     * the tables of the other types.
+     *
+     * \param tables the lookup tables
+     */
+    static void SaveLookupTables(const LookupTables& tables);
+
+
     /**
      * A pure virtual method that must be implemented in the subclass.
      *
@@ -123,6 +274,12 @@ class ErrorRateModel : public Object
                                          uint8_t numRxAntennas,
                                          WifiPpduField field,
                                          uint16_t staId) const = 0;
+
+    bool m_lookupTable;                           //!< whether to use lookup tables
+    double m_lookupTableAccuracy;                 //!< the accuracy of the lookup tables
+    std::string m_lookupTableFile;                //!< the file of the lookup tables, or empty
+    mutable std::shared_ptr<LookupTables>
+        m_lookupTables; //!< the lookup tables, created at first use
 };
 
 } // namespace ns3
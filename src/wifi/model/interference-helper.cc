@@ -397,7 +397,7 @@ InterferenceHelper::CalculateSnr(double signal,
 
 double
 InterferenceHelper::CalculateNoiseInterferenceW(Ptr<Event> event,
-                                                NiChangesPerBand* nis,
+                                                NiChangesRange* range,
                                                 WifiSpectrumBand band) const
 {
     NS_LOG_FUNCTION(this << band.first << band.second);
@@ -406,25 +406,32 @@ InterferenceHelper::CalculateNoiseInterferenceW(Ptr<Event> event,
     double noiseInterferenceW = firstPower_it->second;
     auto niIt = m_niChangesPerBand.find(band);
     NS_ASSERT(niIt != m_niChangesPerBand.end());
-    auto it = niIt->second.find(event->GetStartTime());
-    for (; it != niIt->second.end() && it->first < Simulator::Now(); ++it)
+    const NiChanges& niChanges = niIt->second;
+    auto it = niChanges.find(event->GetStartTime());
+    NS_ASSERT(it != niChanges.end());
+    if (it->first < Simulator::Now())
     {
-        noiseInterferenceW = it->second.GetPower() - event->GetRxPowerW(band);
+        // the power of the last NiChange before now is the total power until now
+        auto now = niChanges.lower_bound(Simulator::Now());
+        noiseInterferenceW = std::prev(now)->second.GetPower() - event->GetRxPowerW(band);
     }
-    it = niIt->second.find(event->GetStartTime());
-    NS_ASSERT(it != niIt->second.end());
-    for (; it != niIt->second.end() && it->second.GetEvent() != event; ++it)
+    for (; it != niChanges.end() && it->second.GetEvent() != event; ++it)
     {
         ;
     }
-    NiChanges ni;
-    ni.emplace(event->GetStartTime(), NiChange(0, event));
-    while (++it != niIt->second.end() && it->second.GetEvent() != event)
+    NS_ASSERT(it != niChanges.end());
+    range->first = it;
+    // the NiChange at the end of the event follows the one at its start, even
+    // if the event has a zero duration
+    it = (event->GetEndTime() > event->GetStartTime())
+             ? niChanges.lower_bound(event->GetEndTime())
+             : std::next(range->first);
+    for (; it != niChanges.end() && it->second.GetEvent() != event; ++it)
     {
-        ni.insert(*it);
+        ;
     }
-    ni.emplace(event->GetEndTime(), NiChange(0, event));
-    nis->insert({band, ni});
+    NS_ASSERT(it != niChanges.end());
+    range->last = it;
     NS_ASSERT_MSG(noiseInterferenceW >= 0,
                   "CalculateNoiseInterferenceW returns negative value " << noiseInterferenceW);
     return noiseInterferenceW;
@@ -476,7 +483,7 @@ InterferenceHelper::CalculatePayloadChunkSuccessRate(double snir,
 double
 InterferenceHelper::CalculatePayloadPer(Ptr<const Event> event,
                                         uint16_t channelWidth,
-                                        NiChangesPerBand* nis,
+                                        const NiChangesRange& range,
                                         WifiSpectrumBand band,
                                         uint16_t staId,
                                         std::pair<Time, Time> window) const
@@ -484,8 +491,7 @@ InterferenceHelper::CalculatePayloadPer(Ptr<const Event> event,
     NS_LOG_FUNCTION(this << channelWidth << band.first << band.second << staId << window.first
                          << window.second);
     double psr = 1.0; /* Packet Success Rate */
-    const auto& niIt = nis->find(band)->second;
-    auto j = niIt.cbegin();
+    auto j = range.first;
     Time previous = j->first;
     WifiMode payloadMode = event->GetTxVector().GetMode(staId);
     Time phyPayloadStart = j->first;
@@ -500,9 +506,27 @@ InterferenceHelper::CalculatePayloadPer(Ptr<const Event> event,
     Time windowEnd = phyPayloadStart + window.second;
     double noiseInterferenceW = m_firstPowerPerBand.find(band)->second;
     double powerW = event->GetRxPowerW(band);
-    while (++j != niIt.cend())
+    if (windowStart > previous)
+    {
+        // The chunks before the time window do not change the PER: start from the
+        // last NiChange not after the start of the window, whose power is the
+        // noise and interference of the first chunk of the window
+        const auto& niChanges = m_niChangesPerBand.find(band)->second;
+        auto k = std::prev(niChanges.upper_bound(windowStart));
+        if (k->first >= range.last->first)
+        {
+            j = range.last;
+        }
+        else if (k != j)
+        {
+            j = k;
+            noiseInterferenceW = j->second.GetPower() - powerW;
+        }
+        previous = j->first;
+    }
+    while (j != range.last)
     {
-        Time current = j->first;
+        Time current = (++j)->first;
         NS_LOG_DEBUG("previous= " << previous << ", current=" << current);
         NS_ASSERT(current >= previous);
         double snr = CalculateSnr(powerW,
@@ -546,15 +570,14 @@ InterferenceHelper::CalculatePayloadPer(Ptr<const Event> event,
 double
 InterferenceHelper::CalculatePhyHeaderSectionPsr(
     Ptr<const Event> event,
-    NiChangesPerBand* nis,
+    const NiChangesRange& range,
     uint16_t channelWidth,
     WifiSpectrumBand band,
     PhyEntity::PhyHeaderSections phyHeaderSections) const
 {
     NS_LOG_FUNCTION(this << band.first << band.second);
     double psr = 1.0; /* Packet Success Rate */
-    auto niIt = nis->find(band)->second;
-    auto j = niIt.begin();
+    auto j = range.first;
 
     NS_ASSERT(!phyHeaderSections.empty());
     Time stopLastSection = Seconds(0);
@@ -566,9 +589,9 @@ InterferenceHelper::CalculatePhyHeaderSectionPsr(
     Time previous = j->first;
     double noiseInterferenceW = m_firstPowerPerBand.find(band)->second;
     double powerW = event->GetRxPowerW(band);
-    while (++j != niIt.end())
+    while (j != range.last)
     {
-        Time current = j->first;
+        Time current = (++j)->first;
         NS_LOG_DEBUG("previous= " << previous << ", current=" << current);
         NS_ASSERT(current >= previous);
         double snr = CalculateSnr(powerW, noiseInterferenceW, channelWidth, 1);
@@ -608,18 +631,17 @@ InterferenceHelper::CalculatePhyHeaderSectionPsr(
 
 double
 InterferenceHelper::CalculatePhyHeaderPer(Ptr<const Event> event,
-                                          NiChangesPerBand* nis,
+                                          const NiChangesRange& range,
                                           uint16_t channelWidth,
                                           WifiSpectrumBand band,
                                           WifiPpduField header) const
 {
     NS_LOG_FUNCTION(this << band.first << band.second << header);
-    auto niIt = nis->find(band)->second;
     auto phyEntity = WifiPhy::GetStaticPhyEntity(event->GetTxVector().GetModulationClass());
 
     PhyEntity::PhyHeaderSections sections;
     for (const auto& section :
-         phyEntity->GetPhyHeaderSections(event->GetTxVector(), niIt.begin()->first))
+         phyEntity->GetPhyHeaderSections(event->GetTxVector(), range.first->first))
     {
         if (section.first == header)
         {
@@ -630,7 +652,7 @@ InterferenceHelper::CalculatePhyHeaderPer(Ptr<const Event> event,
     double psr = 1.0;
     if (!sections.empty() > 0)
     {
-        psr = CalculatePhyHeaderSectionPsr(event, nis, channelWidth, band, sections);
+        psr = CalculatePhyHeaderSectionPsr(event, range, channelWidth, band, sections);
     }
     return 1 - psr;
 }
@@ -644,8 +666,8 @@ InterferenceHelper::CalculatePayloadSnrPer(Ptr<Event> event,
 {
     NS_LOG_FUNCTION(this << channelWidth << band.first << band.second << staId
                          << relativeMpduStartStop.first << relativeMpduStartStop.second);
-    NiChangesPerBand ni;
-    double noiseInterferenceW = CalculateNoiseInterferenceW(event, &ni, band);
+    NiChangesRange range;
+    double noiseInterferenceW = CalculateNoiseInterferenceW(event, &range, band);
     double snr = CalculateSnr(event->GetRxPowerW(band),
                               noiseInterferenceW,
                               channelWidth,
@@ -654,7 +676,8 @@ InterferenceHelper::CalculatePayloadSnrPer(Ptr<Event> event,
     /* calculate the SNIR at the start of the MPDU (located through windowing) and accumulate
      * all SNIR changes in the SNIR vector.
      */
-    double per = CalculatePayloadPer(event, channelWidth, &ni, band, staId, relativeMpduStartStop);
+    double per =
+        CalculatePayloadPer(event, channelWidth, range, band, staId, relativeMpduStartStop);
 
     return PhyEntity::SnrPer(snr, per);
 }
@@ -665,8 +688,8 @@ InterferenceHelper::CalculateSnr(Ptr<Event> event,
                                  uint8_t nss,
                                  WifiSpectrumBand band) const
 {
-    NiChangesPerBand ni;
-    double noiseInterferenceW = CalculateNoiseInterferenceW(event, &ni, band);
+    NiChangesRange range;
+    double noiseInterferenceW = CalculateNoiseInterferenceW(event, &range, band);
     double snr = CalculateSnr(event->GetRxPowerW(band), noiseInterferenceW, channelWidth, nss);
     return snr;
 }
@@ -678,14 +701,14 @@ InterferenceHelper::CalculatePhyHeaderSnrPer(Ptr<Event> event,
                                              WifiPpduField header) const
 {
     NS_LOG_FUNCTION(this << band.first << band.second << header);
-    NiChangesPerBand ni;
-    double noiseInterferenceW = CalculateNoiseInterferenceW(event, &ni, band);
+    NiChangesRange range;
+    double noiseInterferenceW = CalculateNoiseInterferenceW(event, &range, band);
     double snr = CalculateSnr(event->GetRxPowerW(band), noiseInterferenceW, channelWidth, 1);
 
     /* calculate the SNIR at the start of the PHY header and accumulate
      * all SNIR changes in the SNIR vector.
      */
-    double per = CalculatePhyHeaderPer(event, &ni, channelWidth, band, header);
+    double per = CalculatePhyHeaderPer(event, range, channelWidth, band, header);
 
     return PhyEntity::SnrPer(snr, per);
 }
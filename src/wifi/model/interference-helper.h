@@ -393,6 +393,18 @@ class InterferenceHelper : public Object
      */
     typedef std::map<WifiSpectrumBand, NiChanges> NiChangesPerBand;
 
+    /**
+     * The NiChanges of a band from the start to the end of an event, both
+     * included, with the NiChanges of the other events in between. The power
+     * of a NiChange is the total power from its time on, hence the noise and
+     * interference at any point of the range is known without walking it.
+     */
+    struct NiChangesRange
+    {
+        NiChanges::const_iterator first; //!< the NiChange at the start of the event
+        NiChanges::const_iterator last;  //!< the NiChange at the end of the event
+    };
+
     /**
      * Append the given Event.
      *
@@ -406,13 +418,13 @@ class InterferenceHelper : public Object
      * Calculate noise and interference power in W.
      *
      * \param event the event
-     * \param nis the NiChanges
+     * \param range the NiChanges of the band during the event
      * \param band the band
      *
      * \return noise and interference power
      */
     double CalculateNoiseInterferenceW(Ptr<Event> event,
-                                       NiChangesPerBand* nis,
+                                       NiChangesRange* range,
                                        WifiSpectrumBand band) const;
     /**
      * Calculate the error rate of the given PHY payload only in the provided time
@@ -421,7 +433,7 @@ class InterferenceHelper : public Object
      *
      * \param event the event
      * \param channelWidth the channel width used to transmit the PSDU (in MHz)
-     * \param nis the NiChanges
+     * \param range the NiChanges of the band during the event
      * \param band identify the band used by the PSDU
      * \param staId the station ID of the PSDU (only used for MU)
      * \param window time window (pair of start and end times) of PHY payload to focus on
@@ -430,7 +442,7 @@ class InterferenceHelper : public Object
      */
     double CalculatePayloadPer(Ptr<const Event> event,
                                uint16_t channelWidth,
-                               NiChangesPerBand* nis,
+                               const NiChangesRange& range,
                                WifiSpectrumBand band,
                                uint16_t staId,
                                std::pair<Time, Time> window) const;
@@ -439,7 +451,7 @@ class InterferenceHelper : public Object
      * can be divided into multiple chunks (e.g. due to interference from other transmissions).
      *
      * \param event the event
-     * \param nis the NiChanges
+     * \param range the NiChanges of the band during the event
      * \param channelWidth the channel width (in MHz) for header measurement
      * \param band the band
      * \param header the PHY header to consider
@@ -447,7 +459,7 @@ class InterferenceHelper : public Object
      * \return the error rate of the HT PHY header
      */
     double CalculatePhyHeaderPer(Ptr<const Event> event,
-                                 NiChangesPerBand* nis,
+                                 const NiChangesRange& range,
                                  uint16_t channelWidth,
                                  WifiSpectrumBand band,
                                  WifiPpduField header) const;
@@ -455,7 +467,7 @@ class InterferenceHelper : public Object
      * Calculate the success rate of the PHY header sections for the provided event.
      *
      * \param event the event
-     * \param nis the NiChanges
+     * \param range the NiChanges of the band during the event
      * \param channelWidth the channel width (in MHz) for header measurement
      * \param band the band
      * \param phyHeaderSections the map of PHY header sections (\see PhyEntity::PhyHeaderSections)
@@ -463,7 +475,7 @@ class InterferenceHelper : public Object
      * \return the success rate of the PHY header sections
      */
     double CalculatePhyHeaderSectionPsr(Ptr<const Event> event,
-                                        NiChangesPerBand* nis,
+                                        const NiChangesRange& range,
                                         uint16_t channelWidth,
                                         WifiSpectrumBand band,
                                         PhyEntity::PhyHeaderSections phyHeaderSections) const;
@@ -146,6 +146,41 @@ TableBasedErrorRateModel::GetMcsForMode(WifiMode mode)
     return mcs;
 }
 
+std::pair<uint64_t, uint64_t>
+TableBasedErrorRateModel::GetLookupTableBucket(uint64_t nbits) const
+{
+    // the chunks on both sides of the threshold use different tables
+    auto [first, last] = ErrorRateModel::GetLookupTableBucket(nbits);
+    uint64_t thresholdBits = m_threshold * 8;
+    if (first < thresholdBits && thresholdBits <= last)
+    {
+        return (nbits < thresholdBits) ? std::make_pair(first, thresholdBits - 1)
+                                       : std::make_pair(thresholdBits, last);
+    }
+    return {first, last};
+}
+
+double
+TableBasedErrorRateModel::GetLookupTableSize(WifiMode mode,
+                                             const WifiTxVector& txVector,
+                                             uint64_t nbits) const
+{
+    auto mcs = GetMcsForMode(mode);
+    if (mcs.has_value() && mode.GetModulationClass() == WIFI_MOD_CLASS_HT)
+    {
+        mcs = mcs.value() % 8;
+    }
+    if (!mcs.has_value() ||
+        mcs.value() >=
+            (txVector.IsLdpc() ? ERROR_TABLE_LDPC_MAX_NUM_MCS : ERROR_TABLE_BCC_MAX_NUM_MCS))
+    {
+        // the fallback error rate model computes the PER from the number of bits
+        return nbits;
+    }
+    // the PER is computed from the size in bytes
+    return std::max<uint64_t>(1, (nbits / 8));
+}
+
 double
 TableBasedErrorRateModel::DoGetChunkSuccessRate(WifiMode mode,
                                                 const WifiTxVector& txVector,
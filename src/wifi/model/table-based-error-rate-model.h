@@ -57,6 +57,12 @@ class TableBasedErrorRateModel : public ErrorRateModel
      */
     static std::optional<uint8_t> GetMcsForMode(WifiMode mode);
 
+  protected:
+    std::pair<uint64_t, uint64_t> GetLookupTableBucket(uint64_t nbits) const override;
+    double GetLookupTableSize(WifiMode mode,
+                              const WifiTxVector& txVector,
+                              uint64_t nbits) const override;
+
   private:
     double DoGetChunkSuccessRate(WifiMode mode,
                                  const WifiTxVector& txVector,
@@ -24,6 +24,8 @@
 #include "wifi-utils.h"
 #include "yans-wifi-phy.h"
 
+#include "ns3/delivery-batch.h"
+#include "ns3/double.h"
 #include "ns3/log.h"
 #include "ns3/mobility-model.h"
 #include "ns3/node.h"
@@ -31,6 +33,7 @@
 #include "ns3/propagation-delay-model.h"
 #include "ns3/propagation-loss-model.h"
 #include "ns3/simulator.h"
+#include "ns3/spatial-grid.h"
 #include "ns3/wifi-net-device.h"
 
 namespace ns3
@@ -57,7 +60,19 @@ YansWifiChannel::GetTypeId()
                           "A pointer to the propagation delay model attached to this channel.",
                           PointerValue(),
                           MakePointerAccessor(&YansWifiChannel::m_delay),
-                          MakePointerChecker<PropagationDelayModel>());
+                          MakePointerChecker<PropagationDelayModel>())
+            .AddAttribute("MaxRange",
+                          "If positive, the maximum distance in meters between the sender "
+                          "and the PHYs to which it transmits. The other PHYs are not "
+                          "evaluated at all: their propagation delay and loss are not "
+                          "calculated. The positions of the PHYs which do not move are "
+                          "indexed in a grid, so that the cost of a transmission depends "
+                          "on the number of PHYs within this range. Note that the default "
+                          "value corresponds to considering all PHYs, and that random "
+                          "propagation loss models draw different values when it is set.",
+                          DoubleValue(0),
+                          MakeDoubleAccessor(&YansWifiChannel::m_maxRange),
+                          MakeDoubleChecker<double>(0));
     return tid;
 }
 
@@ -70,6 +85,7 @@ YansWifiChannel::~YansWifiChannel()
 {
     NS_LOG_FUNCTION(this);
     m_phyList.clear();
+    m_grid = nullptr;
 }
 
 void
@@ -92,57 +108,88 @@ YansWifiChannel::Send(Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double
     NS_LOG_FUNCTION(this << sender << ppdu << txPowerDbm);
     Ptr<MobilityModel> senderMobility = sender->GetMobility();
     NS_ASSERT(senderMobility);
-    for (PhyList::const_iterator i = m_phyList.begin(); i != m_phyList.end(); i++)
+    ReceptionBatch batch(&YansWifiChannel::Receive);
+    if (m_maxRange > 0)
     {
-        if (sender != (*i))
+        // only the PHYs within range of the sender are considered
+        if (!m_grid)
         {
-            // For now don't account for inter channel interference nor channel bonding
-            if ((*i)->GetChannelNumber() != sender->GetChannelNumber())
+            m_grid = Create<SpatialGrid>(m_maxRange);
+            for (const auto& phy : m_phyList)
             {
-                continue;
+                m_grid->Add(phy->GetMobility());
             }
-
-            Ptr<MobilityModel> receiverMobility = (*i)->GetMobility()->GetObject<MobilityModel>();
-            Time delay = m_delay->GetDelay(senderMobility, receiverMobility);
-            double rxPowerDbm = m_loss->CalcRxPower(txPowerDbm, senderMobility, receiverMobility);
-            NS_LOG_DEBUG("propagation: txPower="
-                         << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, "
-                         << "distance=" << senderMobility->GetDistanceFrom(receiverMobility)
-                         << "m, delay=" << delay);
-            Ptr<NetDevice> dstNetDevice = (*i)->GetDevice();
-            uint32_t dstNode;
-            if (!dstNetDevice)
-            {
-                dstNode = 0xffffffff;
-            }
-            else
-            {
-                dstNode = dstNetDevice->GetNode()->GetId();
-            }
-
-            Simulator::ScheduleWithContext(dstNode,
-                                           delay,
-                                           &YansWifiChannel::Receive,
-                                           (*i),
-                                           ppdu,
-                                           rxPowerDbm);
+        }
+        std::vector<uint32_t> inRange;
+        m_grid->GetWithinDistance(senderMobility->GetPosition(), m_maxRange, inRange);
+        for (uint32_t i : inRange)
+        {
+            SendTo(sender, senderMobility, m_phyList[i], ppdu, txPowerDbm, batch);
         }
     }
+    else
+    {
+        for (const auto& phy : m_phyList)
+        {
+            SendTo(sender, senderMobility, phy, ppdu, txPowerDbm, batch);
+        }
+    }
+    batch.Schedule();
 }
 
 void
-YansWifiChannel::Receive(Ptr<YansWifiPhy> phy, Ptr<const WifiPpdu> ppdu, double rxPowerDbm)
+YansWifiChannel::SendTo(Ptr<YansWifiPhy> sender,
+                        Ptr<MobilityModel> senderMobility,
+                        Ptr<YansWifiPhy> receiver,
+                        Ptr<const WifiPpdu> ppdu,
+                        double txPowerDbm,
+                        ReceptionBatch& batch) const
 {
-    NS_LOG_FUNCTION(phy << ppdu << rxPowerDbm);
+    if (sender == receiver)
+    {
+        return;
+    }
+    // For now don't account for inter channel interference nor channel bonding
+    if (receiver->GetChannelNumber() != sender->GetChannelNumber())
+    {
+        return;
+    }
+
+    Ptr<MobilityModel> receiverMobility = receiver->GetMobility()->GetObject<MobilityModel>();
+    Time delay = m_delay->GetDelay(senderMobility, receiverMobility);
+    double rxPowerDbm = m_loss->CalcRxPower(txPowerDbm, senderMobility, receiverMobility);
+    NS_LOG_DEBUG("propagation: txPower="
+                 << txPowerDbm << "dbm, rxPower=" << rxPowerDbm << "dbm, "
+                 << "distance=" << senderMobility->GetDistanceFrom(receiverMobility)
+                 << "m, delay=" << delay);
     // Do no further processing if signal is too weak
     // Current implementation assumes constant RX power over the PPDU duration
     // Compare received TX power per MHz to normalized RX sensitivity
     uint16_t txWidth = ppdu->GetTransmissionChannelWidth();
-    if ((rxPowerDbm + phy->GetRxGain()) < phy->GetRxSensitivity() + RatioToDb(txWidth / 20.0))
+    if ((rxPowerDbm + receiver->GetRxGain()) <
+        receiver->GetRxSensitivity() + RatioToDb(txWidth / 20.0))
     {
         NS_LOG_INFO("Received signal too weak to process: " << rxPowerDbm << " dBm");
         return;
     }
+    Ptr<NetDevice> dstNetDevice = receiver->GetDevice();
+    uint32_t dstNode;
+    if (!dstNetDevice)
+    {
+        dstNode = 0xffffffff;
+    }
+    else
+    {
+        dstNode = dstNetDevice->GetNode()->GetId();
+    }
+
+    batch.Add(dstNode, delay, receiver, ppdu, rxPowerDbm);
+}
+
+void
+YansWifiChannel::Receive(Ptr<YansWifiPhy> phy, Ptr<const WifiPpdu> ppdu, double rxPowerDbm)
+{
+    NS_LOG_FUNCTION(phy << ppdu << rxPowerDbm);
     RxPowerWattPerChannelBand rxPowerW;
     rxPowerW.insert(
         {std::make_pair(0, 0), (DbmToW(rxPowerDbm + phy->GetRxGain()))}); // dummy band for YANS
@@ -166,6 +213,7 @@ YansWifiChannel::Add(Ptr<YansWifiPhy> phy)
 {
     NS_LOG_FUNCTION(this << phy);
     m_phyList.push_back(phy);
+    m_grid = nullptr;
 }
 
 int64_t
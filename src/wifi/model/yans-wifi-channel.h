@@ -25,13 +25,17 @@
 namespace ns3
 {
 
+class MobilityModel;
 class NetDevice;
 class PropagationLossModel;
 class PropagationDelayModel;
+class SpatialGrid;
 class YansWifiPhy;
 class Packet;
 class Time;
 class WifiPpdu;
+template <typename... Args>
+class DeliveryBatch;
 
 /**
  * \brief a channel to interconnect ns3::YansWifiPhy objects.
@@ -41,6 +45,13 @@ class WifiPpdu;
  * class and supports an ns3::PropagationLossModel and an
  * ns3::PropagationDelayModel.  By default, no propagation models are set;
  * it is the caller's responsibility to set them before using the channel.
+ *
+ * When the MaxRange attribute is set, the PHYs beyond this distance from
+ * the sender are not evaluated: the channel finds the PHYs within range
+ * through a SpatialGrid of their positions.
+ *
+ * The receptions of a PPDU which have the same propagation delay are
+ * scheduled as a single event, through a DeliveryBatch.
  */
 class YansWifiChannel : public Channel
 {
@@ -81,7 +92,9 @@ class YansWifiChannel : public Channel
      * This method should not be invoked by normal users. It is
      * currently invoked only from YansWifiPhy::StartTx.  The channel
      * attempts to deliver the PPDU to all other YansWifiPhy objects
-     * on the channel (except for the sender).
+     * on the channel (except for the sender) which are within its
+     * MaxRange, and does not schedule the reception of the PPDU by
+     * those which would find it too weak to process.
      */
     void Send(Ptr<YansWifiPhy> sender, Ptr<const WifiPpdu> ppdu, double txPowerDbm) const;
 
@@ -101,6 +114,28 @@ class YansWifiChannel : public Channel
      * A vector of pointers to YansWifiPhy.
      */
     typedef std::vector<Ptr<YansWifiPhy>> PhyList;
+    /**
+     * The receptions of a PPDU, with the arguments of Receive.
+     */
+    typedef DeliveryBatch<Ptr<YansWifiPhy>, Ptr<const WifiPpdu>, double> ReceptionBatch;
+
+    /**
+     * Add the reception of a PPDU by a YansWifiPhy to a batch, unless the
+     * signal is too weak for it to process.
+     *
+     * \param sender the PHY object from which the packet is originating
+     * \param senderMobility the mobility model of the sender
+     * \param receiver the device to which the packet is destined
+     * \param ppdu the PPDU being sent
+     * \param txPowerDbm the TX power associated to the packet, in dBm
+     * \param batch the receptions of the PPDU
+     */
+    void SendTo(Ptr<YansWifiPhy> sender,
+                Ptr<MobilityModel> senderMobility,
+                Ptr<YansWifiPhy> receiver,
+                Ptr<const WifiPpdu> ppdu,
+                double txPowerDbm,
+                ReceptionBatch& batch) const;
 
     /**
      * This method is scheduled by Send for each associated YansWifiPhy.
@@ -116,6 +151,8 @@ class YansWifiChannel : public Channel
     PhyList m_phyList;                  //!< List of YansWifiPhys connected to this YansWifiChannel
     Ptr<PropagationLossModel> m_loss;   //!< Propagation loss model
     Ptr<PropagationDelayModel> m_delay; //!< Propagation delay model
+    double m_maxRange;                  //!< Maximum distance to the receivers, or 0
+    mutable Ptr<SpatialGrid> m_grid;    //!< Positions of the PHYs, when m_maxRange is set
 };
 
 } // namespace ns3
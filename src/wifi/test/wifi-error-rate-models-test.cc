@@ -18,17 +18,25 @@
  *          Sébastien Deronne (sebastien.deronne@gmail.com)
  */
 
+#include "ns3/boolean.h"
 #include "ns3/dsss-error-rate-model.h"
 #include "ns3/he-phy.h" //includes HT and VHT
+#include "ns3/ht-ppdu.h"
 #include "ns3/interference-helper.h"
 #include "ns3/log.h"
 #include "ns3/nist-error-rate-model.h"
+#include "ns3/object-factory.h"
+#include "ns3/simulator.h"
+#include "ns3/string.h"
 #include "ns3/table-based-error-rate-model.h"
 #include "ns3/test.h"
 #include "ns3/wifi-phy.h"
+#include "ns3/wifi-psdu.h"
 #include "ns3/wifi-utils.h"
 #include "ns3/yans-error-rate-model.h"
 
+#include <set>
+
 using namespace ns3;
 
 NS_LOG_COMPONENT_DEFINE("WifiErrorRateModelsTest");
@@ -1032,6 +1040,248 @@ TableBasedErrorRateTestCase::DoRun()
     }
 }
 
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Wifi Error Rate Models Lookup Table Test Case
+ *
+ * Check that the chunk success rates interpolated in the lookup tables of
+ * the error rate models are close to the computed ones, and that the tables
+ * saved to a file are loaded back with the same values.
+ */
+class WifiErrorRateModelsTestCaseLookupTable : public TestCase
+{
+  public:
+    WifiErrorRateModelsTestCaseLookupTable();
+
+  private:
+    void DoRun() override;
+
+    /**
+     * Compare the chunk success rates of a model with and without lookup tables
+     *
+     * \param exact the model without lookup tables
+     * \param tabulated the model with lookup tables
+     * \param sizes the sizes of the chunks to compare, in bits
+     * \param tolerance the maximum difference of the chunk success rates
+     */
+    void Compare(Ptr<ErrorRateModel> exact,
+                 Ptr<ErrorRateModel> tabulated,
+                 const std::vector<uint64_t>& sizes,
+                 double tolerance);
+};
+
+WifiErrorRateModelsTestCaseLookupTable::WifiErrorRateModelsTestCaseLookupTable()
+    : TestCase("WifiErrorRateModel test case lookup table")
+{
+}
+
+void
+WifiErrorRateModelsTestCaseLookupTable::Compare(Ptr<ErrorRateModel> exact,
+                                                Ptr<ErrorRateModel> tabulated,
+                                                const std::vector<uint64_t>& sizes,
+                                                double tolerance)
+{
+    for (const auto& mode : {OfdmPhy::GetOfdmRate6Mbps(),
+                             OfdmPhy::GetOfdmRate54Mbps(),
+                             HtPhy::GetHtMcs3(),
+                             VhtPhy::GetVhtMcs8(),
+                             HePhy::GetHeMcs11()})
+    {
+        WifiTxVector txVector;
+        txVector.SetMode(mode);
+        for (const auto& nbits : sizes)
+        {
+            for (double snr = -5; snr <= 45; snr += 0.37)
+            {
+                double csr = exact->GetChunkSuccessRate(mode, txVector, DbToRatio(snr), nbits);
+                NS_TEST_ASSERT_MSG_EQ_TOL(
+                    tabulated->GetChunkSuccessRate(mode, txVector, DbToRatio(snr), nbits),
+                    csr,
+                    tolerance,
+                    exact->GetInstanceTypeId().GetName()
+                        << " " << mode << " " << nbits << " bits " << snr << " dB");
+            }
+        }
+    }
+}
+
+void
+WifiErrorRateModelsTestCaseLookupTable::DoRun()
+{
+    // the chunk success rates of the NIST and YANS models are exponential in
+    // the size, hence those of the sizes of a bucket are about as accurate as
+    // those of its reference size
+    std::vector<uint64_t> sizes{1, 13, 100, 1000, 2048, 12000, 65535};
+    Compare(CreateObject<NistErrorRateModel>(),
+            CreateObjectWithAttributes<NistErrorRateModel>("LookupTable", BooleanValue(true)),
+            sizes,
+            2e-3);
+    Compare(CreateObject<YansErrorRateModel>(),
+            CreateObjectWithAttributes<YansErrorRateModel>("LookupTable", BooleanValue(true)),
+            sizes,
+            2e-3);
+    // the table-based model rounds the SNR to 0.01 dB, over which its chunk
+    // success rate changes by up to about 1e-2
+    Compare(CreateObject<TableBasedErrorRateModel>(),
+            CreateObjectWithAttributes<TableBasedErrorRateModel>("LookupTable",
+                                                                 BooleanValue(true)),
+            {8, 256, 3192, 3200, 3407, 12000, 65536},
+            1.5e-2);
+
+    // the tables saved to a file are loaded back
+    std::string file = CreateTempDirFilename("wifi-error-rate-lookup-tables.txt");
+    std::remove(file.c_str());
+    Ptr<NistErrorRateModel> saving =
+        CreateObjectWithAttributes<NistErrorRateModel>("LookupTable",
+                                                       BooleanValue(true),
+                                                       "LookupTableFile",
+                                                       StringValue(file));
+    std::vector<double> saved;
+    WifiTxVector txVector;
+    txVector.SetMode(HtPhy::GetHtMcs3());
+    for (double snr = 5; snr <= 20; snr += 0.37)
+    {
+        saved.push_back(
+            saving->GetChunkSuccessRate(HtPhy::GetHtMcs3(), txVector, DbToRatio(snr), 12000));
+    }
+    saving = nullptr;
+    Ptr<NistErrorRateModel> loading =
+        CreateObjectWithAttributes<NistErrorRateModel>("LookupTable",
+                                                       BooleanValue(true),
+                                                       "LookupTableFile",
+                                                       StringValue(file));
+    std::size_t i = 0;
+    for (double snr = 5; snr <= 20; snr += 0.37)
+    {
+        NS_TEST_EXPECT_MSG_EQ(
+            loading->GetChunkSuccessRate(HtPhy::GetHtMcs3(), txVector, DbToRatio(snr), 12000),
+            saved[i++],
+            "The chunk success rate at " << snr << " dB differs once loaded from " << file);
+    }
+    std::remove(file.c_str());
+}
+
+/**
+ * \ingroup wifi-test
+ * \ingroup tests
+ *
+ * \brief Wifi Error Rate Models A-MPDU Interference Test Case
+ *
+ * Check that the PER of each MPDU of an A-MPDU, computed from the time window
+ * of the MPDU only, is the one of the chunks of the PPDU that overlap this
+ * window, when interferers start before the window of an MPDU.
+ */
+class WifiErrorRateModelsTestCaseAmpduInterference : public TestCase
+{
+  public:
+    WifiErrorRateModelsTestCaseAmpduInterference();
+
+  private:
+    void DoRun() override;
+};
+
+WifiErrorRateModelsTestCaseAmpduInterference::WifiErrorRateModelsTestCaseAmpduInterference()
+    : TestCase("WifiErrorRateModel test case A-MPDU interference")
+{
+}
+
+void
+WifiErrorRateModelsTestCaseAmpduInterference::DoRun()
+{
+    Ptr<TestInterferenceHelper> interference = CreateObject<TestInterferenceHelper>();
+    interference->SetNoiseFigure(DbToRatio(7));
+    interference->SetErrorRateModel(CreateObject<NistErrorRateModel>());
+    WifiSpectrumBand band{0, 0};
+    interference->AddBand(band);
+
+    WifiTxVector txVector(HtPhy::GetHtMcs0(), 0, WIFI_PREAMBLE_HT_MF, 800, 1, 1, 0, 20, false);
+    Time payloadStart = WifiPhy::CalculatePhyPreambleAndHeaderDuration(txVector);
+    Time duration = payloadStart + MicroSeconds(600);
+    WifiMacHeader hdr;
+    hdr.SetType(WIFI_MAC_QOSDATA);
+    hdr.SetQosTid(0);
+    Ptr<WifiPpdu> ppdu = Create<HtPpdu>(Create<WifiPsdu>(Create<Packet>(1000), hdr),
+                                        txVector,
+                                        5180,
+                                        duration,
+                                        WIFI_PHY_BAND_5GHZ,
+                                        0);
+    double signalW = 4e-12;
+    RxPowerWattPerChannelBand rxPower{{band, signalW}};
+    Ptr<Event> event = interference->Add(ppdu, txVector, duration, rxPower);
+    interference->NotifyRxStart();
+
+    // the interferers, whose times are relative to the start of the payload
+    struct Interferer
+    {
+        Time start;    //!< the start of the interferer
+        Time end;      //!< the end of the interferer
+        double powerW; //!< the power of the interferer (W)
+    };
+
+    std::vector<Interferer> interferers{{MicroSeconds(100), MicroSeconds(200), 1e-12},
+                                        {MicroSeconds(250), MicroSeconds(500), 1.5e-12}};
+    for (const auto& interferer : interferers)
+    {
+        Simulator::Schedule(payloadStart + interferer.start, [=]() {
+            RxPowerWattPerChannelBand interferencePower{{band, interferer.powerW}};
+            interference->AddForeignSignal(interferer.end - interferer.start, interferencePower);
+        });
+    }
+
+    // the windows of the MPDUs, relative to the start of the payload, the ones
+    // of the second to the fourth MPDUs starting after an interferer
+    std::vector<std::pair<Time, Time>> windows{{MicroSeconds(0), MicroSeconds(150)},
+                                               {MicroSeconds(150), MicroSeconds(300)},
+                                               {MicroSeconds(300), MicroSeconds(450)},
+                                               {MicroSeconds(450), MicroSeconds(600)}};
+    Simulator::Schedule(duration, [&]() {
+        // the chunks of the payload, between two starts or ends of interferers
+        std::set<Time> times{MicroSeconds(0), MicroSeconds(600)};
+        for (const auto& interferer : interferers)
+        {
+            times.insert(interferer.start);
+            times.insert(interferer.end);
+        }
+        for (const auto& window : windows)
+        {
+            double psr = 1;
+            for (auto it = times.begin(); std::next(it) != times.end(); ++it)
+            {
+                Time chunkStart = std::max(*it, window.first);
+                Time chunkEnd = std::min(*std::next(it), window.second);
+                if (chunkStart >= chunkEnd)
+                {
+                    continue;
+                }
+                double interferenceW = 0;
+                for (const auto& interferer : interferers)
+                {
+                    if (interferer.start <= chunkStart && chunkEnd <= interferer.end)
+                    {
+                        interferenceW += interferer.powerW;
+                    }
+                }
+                double snr = interference->CalculateSnr(signalW, interferenceW, 20, 1);
+                psr *= interference->CalculatePayloadChunkSuccessRate(snr,
+                                                                      chunkEnd - chunkStart,
+                                                                      txVector);
+            }
+            auto snrPer = interference->CalculatePayloadSnrPer(event, 20, band, SU_STA_ID, window);
+            NS_TEST_EXPECT_MSG_EQ_TOL(snrPer.per,
+                                      1 - psr,
+                                      1e-12,
+                                      "Wrong PER of the MPDU starting at " << window.first);
+            NS_TEST_EXPECT_MSG_GT(snrPer.per, 0, "The interferers should corrupt the MPDU");
+        }
+    });
+    Simulator::Run();
+    Simulator::Destroy();
+    interference->Dispose();
+}
+
 /**
  * \ingroup wifi-test
  * \ingroup tests
@@ -1050,6 +1300,8 @@ WifiErrorRateModelsTestSuite::WifiErrorRateModelsTestSuite()
     AddTestCase(new WifiErrorRateModelsTestCaseDsss, TestCase::QUICK);
     AddTestCase(new WifiErrorRateModelsTestCaseNist, TestCase::QUICK);
     AddTestCase(new WifiErrorRateModelsTestCaseMimo, TestCase::QUICK);
+    AddTestCase(new WifiErrorRateModelsTestCaseLookupTable, TestCase::QUICK);
+    AddTestCase(new WifiErrorRateModelsTestCaseAmpduInterference, TestCase::QUICK);
     AddTestCase(new TableBasedErrorRateTestCase("DefaultTableBasedHtMcs0-1458bytes",
                                                 HtPhy::GetHtMcs0(),
                                                 1458),
@@ -18,23 +18,82 @@
  */
 
 // This program can be used to benchmark packet serialization/deserialization
-// operations using Headers and Tags, for various numbers of packets 'n'
+// operations using Headers and Tags, for various numbers of packets 'n',
+// and the memory held by 'n' packets in flight with a virtual payload.
 // Sample usage:  ./ns3 run 'bench-packets --n=10000'
 
 #include "ns3/command-line.h"
+#include "ns3/flow-id-tag.h"
 #include "ns3/packet-metadata.h"
 #include "ns3/packet.h"
+#include "ns3/socket.h"
 #include "ns3/system-wall-clock-ms.h"
 
 #include <algorithm>
+#include <cstddef>
+#include <cstdlib>
 #include <iostream>
 #include <limits>
+#include <new>
 #include <sstream>
 #include <stdlib.h> // for exit ()
 #include <string>
+#include <vector>
 
 using namespace ns3;
 
+/// Number of bytes allocated with the global operator new and not deleted yet.
+static std::size_t g_liveBytes = 0;
+
+/**
+ * Allocate memory, counting it in g_liveBytes.
+ * \param size The number of bytes.
+ * \returns The memory allocated.
+ */
+void*
+operator new(std::size_t size)
+{
+    // the size is stored in front of the memory returned, to be counted when deleted
+    auto block = static_cast<std::max_align_t*>(std::malloc(sizeof(std::max_align_t) + size));
+    if (block == nullptr)
+    {
+        throw std::bad_alloc();
+    }
+    *reinterpret_cast<std::size_t*>(block) = size;
+    g_liveBytes += size;
+    return block + 1;
+}
+
+/**
+ * Free memory allocated with operator new, removing it from g_liveBytes.
+ *
+ * Not inlined, so that the compiler does not mistake the size stored in
+ * front of the memory for an access out of the bounds of the object.
+ *
+ * \param p The memory.
+ */
+[[gnu::noinline]] void
+operator delete(void* p) noexcept
+{
+    if (p == nullptr)
+    {
+        return;
+    }
+    auto block = static_cast<std::max_align_t*>(p) - 1;
+    g_liveBytes -= *reinterpret_cast<std::size_t*>(block);
+    std::free(block);
+}
+
+/**
+ * Free memory allocated with operator new, removing it from g_liveBytes.
+ * \param p The memory.
+ */
+void
+operator delete(void* p, std::size_t /* size */) noexcept
+{
+    operator delete(p);
+}
+
 /// BenchHeader class used for benchmarking packet serialization/deserialization
 template <int N>
 class BenchHeader : public Header
@@ -350,6 +409,143 @@ benchByteTags(uint32_t n)
     }
 }
 
+static void
+benchPacketTags(uint32_t n)
+{
+    FlowIdTag flowId(1);
+    SocketPriorityTag priority;
+    priority.SetPriority(6);
+    SocketIpTtlTag ttl;
+    ttl.SetTtl(64);
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<Packet> p = Create<Packet>(1000);
+        p->AddPacketTag(flowId);
+        p->AddPacketTag(priority);
+
+        // each receiver of a broadcast channel gets its own copy, which
+        // it tags and reads before passing it up
+        for (uint32_t j = 0; j < 3; j++)
+        {
+            Ptr<Packet> copy = p->Copy();
+            copy->AddPacketTag(ttl);
+            copy->PeekPacketTag(flowId);
+            copy->RemovePacketTag(priority);
+            copy->RemovePacketTag(ttl);
+        }
+    }
+}
+
+static void
+benchFewByteTags(uint32_t n)
+{
+    FlowIdTag flowId(1);
+
+    for (uint32_t i = 0; i < n; i++)
+    {
+        Ptr<Packet> p = Create<Packet>(2000);
+        p->AddByteTag(flowId);
+
+        Ptr<Packet> frag0 = p->CreateFragment(0, 1000);
+        Ptr<Packet> frag1 = p->CreateFragment(1000, 1000);
+        frag0->AddAtEnd(frag1);
+        frag0->FindFirstMatchingByteTag(flowId);
+    }
+}
+
+/**
+ * Create the packets in flight for a virtual payload.
+ *
+ * \param payloadSize The payload size, in bytes.
+ * \param mode How the packets are processed: 0 to add headers, 1 to
+ *             fragment, 2 to fragment and reassemble, 3 to split the
+ *             payload of two writes in TCP segments.
+ * \param packets The packets in flight.
+ */
+static void
+createInFlight(uint32_t payloadSize, uint32_t mode, std::vector<Ptr<Packet>>& packets)
+{
+    BenchHeader<25> ipv4;
+    BenchHeader<8> udp;
+    const uint32_t fragmentSize = 1480;
+    const uint32_t segmentSize = 1448;
+
+    Ptr<Packet> p = Create<Packet>(payloadSize);
+    if (mode == 3)
+    {
+        // the application writes are merged in the send buffer,
+        // and the segments are cut from the merged bytes
+        Ptr<Packet> buffer = p->Copy();
+        buffer->AddAtEnd(Create<Packet>(payloadSize));
+        for (uint32_t offset = 0; offset < buffer->GetSize(); offset += segmentSize)
+        {
+            Ptr<Packet> segment = buffer->CreateFragment(
+                offset,
+                std::min(segmentSize, buffer->GetSize() - offset));
+            segment->AddHeader(udp);
+            segment->AddHeader(ipv4);
+            packets.push_back(segment);
+        }
+        return;
+    }
+    p->AddHeader(udp);
+    if (mode == 0)
+    {
+        p->AddHeader(ipv4);
+        packets.push_back(p);
+        return;
+    }
+    Ptr<Packet> reassembled;
+    for (uint32_t offset = 0; offset < p->GetSize(); offset += fragmentSize)
+    {
+        Ptr<Packet> fragment =
+            p->CreateFragment(offset, std::min(fragmentSize, p->GetSize() - offset));
+        fragment->AddHeader(ipv4);
+        if (mode == 1)
+        {
+            packets.push_back(fragment);
+            continue;
+        }
+        fragment->RemoveHeader(ipv4);
+        if (!reassembled)
+        {
+            reassembled = fragment;
+        }
+        else
+        {
+            reassembled->AddAtEnd(fragment);
+        }
+    }
+    if (mode == 2)
+    {
+        packets.push_back(reassembled);
+    }
+}
+
+/**
+ * Print the memory held by packets in flight with a virtual payload.
+ *
+ * \param n The number of packets in flight.
+ * \param payloadSize The payload size, in bytes.
+ * \param mode How the packets are processed, see createInFlight().
+ * \param name The name of the benchmark.
+ */
+static void
+runMemoryBench(uint32_t n, uint32_t payloadSize, uint32_t mode, const char* name)
+{
+    std::vector<Ptr<Packet>> packets;
+    packets.reserve(2 * n * (payloadSize / 1448 + 2));
+    std::size_t before = g_liveBytes;
+    for (uint32_t i = 0; i < n; i++)
+    {
+        createInFlight(payloadSize, mode, packets);
+    }
+    std::size_t after = g_liveBytes;
+    std::cout << (after - before) / n << " bytes/packet (" << packets.size() << " packets, payload "
+              << payloadSize << " bytes)\t" << name << std::endl;
+}
+
 static uint64_t
 runBenchOneIteration(void (*bench)(uint32_t), uint32_t n)
 {
@@ -382,6 +578,7 @@ main(int argc, char* argv[])
     uint32_t n = 0;
     uint32_t minIterations = 1;
     bool enablePrinting = false;
+    bool enableChecking = false;
 
     CommandLine cmd(__FILE__);
     cmd.Usage("Benchmark Packet class");
@@ -390,6 +587,7 @@ main(int argc, char* argv[])
                  "number of subiterations to minimize iteration time over",
                  minIterations);
     cmd.AddValue("enable-printing", "enable packet printing", enablePrinting);
+    cmd.AddValue("enable-checking", "enable packet printing and checking", enableChecking);
     cmd.Parse(argc, argv);
 
     if (n == 0)
@@ -398,6 +596,15 @@ main(int argc, char* argv[])
                   << "by command-line argument --n=(number of packets)" << std::endl;
         exit(1);
     }
+    if (enableChecking)
+    {
+        Packet::EnableChecking();
+    }
+    else if (enablePrinting)
+    {
+        Packet::EnablePrinting();
+    }
+
     std::cout << "Running bench-packets with n=" << n << std::endl;
     std::cout << "All tests begin by adding UDP and IPv4 headers." << std::endl;
 
@@ -407,6 +614,17 @@ main(int argc, char* argv[])
     runBench(&benchD, n, minIterations, "Intermixed add/remove headers and tags");
     runBench(&benchFragment, n, minIterations, "Fragmentation and concatenation");
     runBench(&benchByteTags, n, minIterations, "Benchmark byte tags");
+    runBench(&benchPacketTags, n, minIterations, "Add, copy and remove a few packet tags");
+    runBench(&benchFewByteTags, n, minIterations, "Fragment and reassemble a byte tag");
+
+    std::cout << "Memory held by the packets in flight, per application packet." << std::endl;
+    for (uint32_t payloadSize : {512, 1472, 9000, 65000})
+    {
+        runMemoryBench(n, payloadSize, 0, "Headers");
+        runMemoryBench(n, payloadSize, 1, "IPv4 fragments");
+        runMemoryBench(n, payloadSize, 2, "Reassembled fragments");
+        runMemoryBench(n, payloadSize, 3, "TCP segments");
+    }
 
     return 0;
 }
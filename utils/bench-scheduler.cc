@@ -390,25 +390,76 @@ BenchSuite::Log() const
 /**
  *  Create a RandomVariableStream to generate next event delays.
  *
- *  If the \p filename parameter is empty a default exponential time
- *  distribution will be used, with mean delay of 100 ns.
+ *  If the \p filename parameter is empty the \p distribution is used,
+ *  all with a mean delay of about 100 ns:
+ *
+ *  - `exp`: exponential (the default),
+ *  - `uniform`: uniform in [0, 200] ns,
+ *  - `triangular`: triangular in [0, 300] ns, with its mode at 0,
+ *  - `bimodal`: half of the delays uniform in [0, 20] ns, half uniform
+ *    in [180, 200] ns, like short timers mixed with periodic ones,
+ *  - `pareto`: heavy-tailed, with shape 1.5 and no bound.
  *
  *  If the \p filename is `-` standard input will be used.
  *
  *  \param [in] filename The delay interval source file name.
+ *  \param [in] distribution The delay distribution, without \p filename.
  *  \returns The RandomVariableStream.
  */
 Ptr<RandomVariableStream>
-GetRandomStream(std::string filename)
+GetRandomStream(std::string filename, std::string distribution)
 {
     Ptr<RandomVariableStream> stream = nullptr;
 
     if (filename.empty())
     {
-        LOG("  Event time distribution:      default exponential");
-        auto erv = CreateObject<ExponentialRandomVariable>();
-        erv->SetAttribute("Mean", DoubleValue(100));
-        stream = erv;
+        if (distribution == "exp")
+        {
+            LOG("  Event time distribution:      default exponential");
+            auto erv = CreateObject<ExponentialRandomVariable>();
+            erv->SetAttribute("Mean", DoubleValue(100));
+            stream = erv;
+        }
+        else if (distribution == "uniform")
+        {
+            LOG("  Event time distribution:      uniform");
+            auto urv = CreateObject<UniformRandomVariable>();
+            urv->SetAttribute("Min", DoubleValue(0));
+            urv->SetAttribute("Max", DoubleValue(200));
+            stream = urv;
+        }
+        else if (distribution == "triangular")
+        {
+            LOG("  Event time distribution:      triangular");
+            auto trv = CreateObject<TriangularRandomVariable>();
+            trv->SetAttribute("Min", DoubleValue(0));
+            trv->SetAttribute("Max", DoubleValue(300));
+            trv->SetAttribute("Mean", DoubleValue(100));
+            stream = trv;
+        }
+        else if (distribution == "bimodal")
+        {
+            LOG("  Event time distribution:      bimodal");
+            auto erv = CreateObject<EmpiricalRandomVariable>();
+            erv->SetInterpolate(true);
+            erv->CDF(0, 0);
+            erv->CDF(20, 0.5);
+            erv->CDF(180, 0.5);
+            erv->CDF(200, 1);
+            stream = erv;
+        }
+        else if (distribution == "pareto")
+        {
+            LOG("  Event time distribution:      pareto");
+            auto prv = CreateObject<ParetoRandomVariable>();
+            prv->SetAttribute("Scale", DoubleValue(100.0 / 3));
+            prv->SetAttribute("Shape", DoubleValue(1.5));
+            stream = prv;
+        }
+        else
+        {
+            NS_ABORT_MSG("Unknown event time distribution " << distribution);
+        }
     }
     else
     {
@@ -457,6 +508,7 @@ main(int argc, char* argv[])
     bool allSched = false;
     bool schedCal = false;
     bool schedHeap = false;
+    bool schedLadder = false;
     bool schedList = false;
     bool schedMap = false; // default scheduler
     bool schedPQ = false;
@@ -465,13 +517,14 @@ main(int argc, char* argv[])
     uint64_t total = 1000000;
     uint64_t runs = 1;
     std::string filename = "";
+    std::string distribution = "exp";
     bool calRev = false;
 
     CommandLine cmd(__FILE__);
     cmd.Usage("Benchmark the simulator scheduler.\n"
               "\n"
               "Event intervals are taken from one of:\n"
-              "  an exponential distribution, with mean 100 ns,\n"
+              "  a distribution given by the --dist argument, with mean 100 ns,\n"
               "  an ascii file, given by the --file=\"<filename>\" argument,\n"
               "  or standard input, by the argument --file=\"-\"\n"
               "In the case of either --file form, the input is expected\n"
@@ -482,6 +535,7 @@ main(int argc, char* argv[])
     cmd.AddValue("cal", "use CalendarSheduler", schedCal);
     cmd.AddValue("calrev", "reverse ordering in the CalendarScheduler", calRev);
     cmd.AddValue("heap", "use HeapScheduler", schedHeap);
+    cmd.AddValue("ladder", "use LadderScheduler", schedLadder);
     cmd.AddValue("list", "use ListSheduler", schedList);
     cmd.AddValue("map", "use MapScheduler (default)", schedMap);
     cmd.AddValue("pri", "use PriorityQueue", schedPQ);
@@ -490,6 +544,9 @@ main(int argc, char* argv[])
     cmd.AddValue("total", "total number of events to run", total);
     cmd.AddValue("runs", "number of runs", runs);
     cmd.AddValue("file", "file of relative event times", filename);
+    cmd.AddValue("dist",
+                 "event time distribution: exp, uniform, triangular, bimodal or pareto",
+                 distribution);
     cmd.AddValue("prec", "printed output precision", g_fwidth);
     cmd.Parse(argc, argv);
 
@@ -505,15 +562,15 @@ main(int argc, char* argv[])
 
     if (allSched)
     {
-        schedCal = schedHeap = schedList = schedMap = schedPQ = true;
+        schedCal = schedHeap = schedLadder = schedList = schedMap = schedPQ = true;
     }
     // Set the default case if nothing else is set
-    if (!(schedCal || schedHeap || schedList || schedMap || schedPQ))
+    if (!(schedCal || schedHeap || schedLadder || schedList || schedMap || schedPQ))
     {
         schedMap = true;
     }
 
-    auto eventStream = GetRandomStream(filename);
+    auto eventStream = GetRandomStream(filename, distribution);
 
     ObjectFactory factory("ns3::MapScheduler");
     if (schedCal)
@@ -532,6 +589,11 @@ main(int argc, char* argv[])
         factory.SetTypeId("ns3::HeapScheduler");
         BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
     }
+    if (schedLadder)
+    {
+        factory.SetTypeId("ns3::LadderScheduler");
+        BenchSuite(factory, pop, total, runs, eventStream, calRev).Log();
+    }
     if (schedList)
     {
         factory.SetTypeId("ns3::ListScheduler");
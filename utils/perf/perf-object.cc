@@ -0,0 +1,131 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-module.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace ns3;
+
+/**
+ * \ingroup system-tests-perf
+ *
+ * An Object type to aggregate, the N-th of a set of distinct types.
+ *
+ * \tparam N The index of the type.
+ */
+template <int N>
+class PerfObject : public Object
+{
+  public:
+    /**
+     * \brief Get the type ID.
+     * \return The object TypeId.
+     */
+    static TypeId GetTypeId()
+    {
+        static TypeId tid = TypeId("ns3::PerfObject" + std::to_string(N))
+                                .SetParent<Object>()
+                                .SetGroupName("Core")
+                                .template AddConstructor<PerfObject<N>>();
+        return tid;
+    }
+};
+
+/**
+ * \ingroup system-tests-perf
+ *
+ * Check the performance of looking up Objects in an aggregate.
+ *
+ * \param object An Object aggregated to PerfObject<0> through PerfObject<7>.
+ * \param n The number of lookups to perform.
+ * \param found Whether to look up aggregated types, alternating between the
+ *        first and the last Objects aggregated, or types which are not aggregated.
+ * \return The number of Objects found.
+ */
+uint64_t
+PerfGetObject(Ptr<Object> object, uint32_t n, bool found)
+{
+    uint64_t count = 0;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        if (found)
+        {
+            count += (i & 1) ? !!object->GetObject<PerfObject<7>>()
+                             : !!object->GetObject<PerfObject<0>>();
+        }
+        else
+        {
+            count += (i & 1) ? !!object->GetObject<PerfObject<9>>()
+                             : !!object->GetObject<PerfObject<8>>();
+        }
+    }
+    return count;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t n = 1000000;
+    uint32_t iter = 50;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("n", "How many lookups to perform (defaults to 1000000)", n);
+    cmd.AddValue("iter", "How many times to run the test looking for a min (defaults to 50)", iter);
+    cmd.Parse(argc, argv);
+
+    Ptr<Object> object = CreateObject<PerfObject<0>>();
+    object->AggregateObject(CreateObject<PerfObject<1>>());
+    object->AggregateObject(CreateObject<PerfObject<2>>());
+    object->AggregateObject(CreateObject<PerfObject<3>>());
+    object->AggregateObject(CreateObject<PerfObject<4>>());
+    object->AggregateObject(CreateObject<PerfObject<5>>());
+    object->AggregateObject(CreateObject<PerfObject<6>>());
+    object->AggregateObject(CreateObject<PerfObject<7>>());
+
+    for (bool found : {true, false})
+    {
+        auto minResultNs = std::chrono::nanoseconds::max();
+
+        //
+        // This will probably run on a machine doing other things.  Run it some
+        // relatively large number of times and try to find a minimum, which
+        // will hopefully represent a time when it runs free of interference.
+        //
+        for (uint32_t i = 0; i < iter; ++i)
+        {
+            auto start = std::chrono::steady_clock::now();
+            uint64_t count = PerfGetObject(object, n, found);
+            auto end = std::chrono::steady_clock::now();
+            NS_ABORT_MSG_UNLESS(count == (found ? n : 0), "Wrong Objects found");
+            auto resultNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+            minResultNs = std::min(resultNs, minResultNs);
+            std::cout << ".";
+            std::cout.flush();
+        }
+        std::cout << std::endl;
+
+        std::cout << argv[0] << ": " << (found ? "found" : "not found") << ": "
+                  << minResultNs.count() << "ns, " << double(minResultNs.count()) / n
+                  << "ns per GetObject" << std::endl;
+    }
+
+    object->Dispose();
+
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as
+ * published by the Free Software Foundation;
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software
+ * Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/spectrum-value.h"
+#include "ns3/wifi-spectrum-value-helper.h"
+
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <string>
+
+using namespace ns3;
+
+/**
+ * \ingroup system-tests-perf
+ *
+ * Check the performance of the SpectrumValue operations which evaluate the
+ * chunks of a reception, as SpectrumInterference and
+ * ShannonSpectrumErrorModel do.
+ *
+ * \param model The SpectrumModel of the values.
+ * \param n The number of chunks to evaluate.
+ * \param capacity Whether to also compute the Shannon capacity of the chunks,
+ *        rather than their SINR only.
+ * \return The sum of the mean SINR, or of the capacity, of the chunks.
+ */
+double
+PerfChunks(Ptr<const SpectrumModel> model, uint32_t n, bool capacity)
+{
+    SpectrumValue rx(model);
+    SpectrumValue noise(model);
+    SpectrumValue interferer(model);
+    SpectrumValue allSignals(model);
+    for (uint32_t i = 0; i < rx.GetValuesN(); ++i)
+    {
+        rx[i] = 1e-12 * (1 + i % 7);
+        noise[i] = 4e-21;
+        interferer[i] = 1e-14 * (1 + i % 3);
+    }
+    allSignals += rx;
+
+    double sum = 0;
+    for (uint32_t i = 0; i < n; ++i)
+    {
+        allSignals += interferer;
+        SpectrumValue sinr = rx / (allSignals - rx + noise);
+        sum += capacity ? Integral(Log2(1 + sinr)) : Sum(sinr) / sinr.GetValuesN();
+        allSignals -= interferer;
+    }
+    return sum;
+}
+
+int
+main(int argc, char* argv[])
+{
+    uint32_t n = 100000;
+    uint32_t iter = 20;
+
+    CommandLine cmd(__FILE__);
+    cmd.AddValue("n", "How many chunks to evaluate (defaults to 100000)", n);
+    cmd.AddValue("iter", "How many times to run the test looking for a min (defaults to 20)", iter);
+    cmd.Parse(argc, argv);
+
+    // 100 resource blocks of 180 kHz of an LTE carrier at 2120 MHz
+    Bands rbs;
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        BandInfo rb;
+        rb.fl = 2110e6 + i * 180e3;
+        rb.fc = rb.fl + 90e3;
+        rb.fh = rb.fl + 180e3;
+        rbs.push_back(rb);
+    }
+    Ptr<const SpectrumModel> lte = Create<SpectrumModel>(rbs);
+    // 2048 subcarriers of 78.125 kHz of a 160 MHz Wi-Fi channel at 5570 MHz
+    Ptr<const SpectrumModel> wifi = WifiSpectrumValueHelper::GetSpectrumModel(5570, 160, 78125, 0);
+
+    for (const auto& [name, model] : {std::make_pair("LTE 100 RB", lte),
+                                      std::make_pair("Wi-Fi 160 MHz", wifi)})
+    {
+        for (bool capacity : {false, true})
+        {
+            auto minResultNs = std::chrono::nanoseconds::max();
+
+            //
+            // This will probably run on a machine doing other things.  Run it some
+            // relatively large number of times and try to find a minimum, which
+            // will hopefully represent a time when it runs free of interference.
+            //
+            for (uint32_t i = 0; i < iter; ++i)
+            {
+                auto start = std::chrono::steady_clock::now();
+                double sum = PerfChunks(model, n, capacity);
+                auto end = std::chrono::steady_clock::now();
+                NS_ABORT_MSG_UNLESS(sum > 0, "Wrong chunks evaluated");
+                auto resultNs = std::chrono::duration_cast<std::chrono::nanoseconds>(end - start);
+                minResultNs = std::min(resultNs, minResultNs);
+                std::cout << ".";
+                std::cout.flush();
+            }
+            std::cout << std::endl;
+
+            std::cout << argv[0] << ": " << name << " (" << model->GetNumBands() << " bands), "
+                      << (capacity ? "capacity" : "SINR") << ": " << minResultNs.count()
+                      << "ns, " << double(minResultNs.count()) / n << "ns per chunk"
+                      << std::endl;
+        }
+    }
+
+    return 0;
+}